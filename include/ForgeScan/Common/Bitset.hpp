@@ -0,0 +1,409 @@
+#ifndef FORGE_SCAN_COMMON_BITSET_HPP
+#define FORGE_SCAN_COMMON_BITSET_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace forge_scan {
+
+
+/// @brief A fixed-size set of bits, packed into 64-bit words, with a coarse index of which blocks
+///        of bits have been set since the index was last cleared.
+/// @details This stores a flag for each voxel of a Grid, such as the `data_seen` record of
+///          `data::Reconstruction`. Bits are addressed by the same vector index as the voxel data.
+///          Each block of `block_size` bits has a dirty flag which is raised when any bit within it
+///          is set. Consumers may then visit only the dirty blocks with `forEachDirtyBlock` rather
+///          than scanning every bit.
+/// @note  Words are stored as `std::atomic` values. `setAtomic` may be called from any number of
+///        threads. `set` is cheaper but only safe when no other thread writes to bits in the same
+///        64-bit word. Raising a dirty flag is always thread-safe.
+class Bitset
+{
+public:
+    using Word = uint64_t;
+
+    /// @brief Number of bits in a word.
+    static constexpr size_t word_bits = 64;
+
+    /// @brief Number of bits covered by one dirty flag, as a power of two.
+    static constexpr size_t block_bits = 12;
+
+    /// @brief Number of bits covered by one dirty flag.
+    static constexpr size_t block_size = size_t(1) << block_bits;
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Creates a Bitset with every bit cleared and no dirty blocks.
+    /// @param n_bits Number of bits.
+    explicit Bitset(const size_t& n_bits = 0)
+        : n_bits(n_bits),
+          n_blocks((n_bits + block_size - 1) >> block_bits),
+          words((n_bits + word_bits - 1) / word_bits),
+          dirty((this->n_blocks + word_bits - 1) / word_bits)
+    {
+        this->reset();
+    }
+
+
+    /// @brief Copies the bits and dirty flags of another Bitset.
+    /// @param other Bitset to copy.
+    /// @note  The copy is not atomic, so the other Bitset must not be written while it is copied.
+    Bitset(const Bitset& other)
+        : n_bits(other.n_bits),
+          n_blocks(other.n_blocks),
+          words(other.words.size()),
+          dirty(other.dirty.size())
+    {
+        this->copyWords(other);
+    }
+
+
+    /// @brief Copies the bits and dirty flags of another Bitset, reusing this one's storage if it
+    ///        is the same size. See the copy constructor.
+    Bitset& operator=(const Bitset& other)
+    {
+        if (this != &other)
+        {
+            if (this->words.size() != other.words.size())
+            {
+                this->words = std::vector<std::atomic<Word>>(other.words.size());
+            }
+            if (this->dirty.size() != other.dirty.size())
+            {
+                this->dirty = std::vector<std::atomic<Word>>(other.dirty.size());
+            }
+            this->n_bits   = other.n_bits;
+            this->n_blocks = other.n_blocks;
+            this->copyWords(other);
+        }
+        return *this;
+    }
+
+
+    Bitset(Bitset&&) = default;
+    Bitset& operator=(Bitset&&) = default;
+
+
+    /// @brief Number of bits.
+    size_t size() const
+    {
+        return this->n_bits;
+    }
+
+
+    /// @brief Number of 64-bit words the bits are packed into.
+    size_t numWords() const
+    {
+        return this->words.size();
+    }
+
+
+    /// @brief Number of blocks covered by the dirty index.
+    size_t numBlocks() const
+    {
+        return this->n_blocks;
+    }
+
+
+    /// @brief Reads a bit.
+    /// @param i Index of the bit.
+    /// @return True if the bit is set.
+    bool test(const size_t& i) const
+    {
+        return (this->words[i / word_bits].load(std::memory_order_relaxed) >> (i % word_bits)) & 1;
+    }
+
+
+    /// @brief Reads a bit. See `test`.
+    bool operator[](const size_t& i) const
+    {
+        return this->test(i);
+    }
+
+
+    /// @brief Reads the word holding bits `[64 w, 64 w + 64)`. Bits past `size()` are always zero.
+    /// @param w Index of the word.
+    /// @return Value of the word.
+    Word word(const size_t& w) const
+    {
+        return this->words[w].load(std::memory_order_relaxed);
+    }
+
+
+    /// @brief Unpacks the bits `[first, last)` into one byte each.
+    /// @param first Index of the first bit.
+    /// @param last  Index one past the last bit.
+    /// @param [out] out Array with room for `last - first` bytes. Each is set to 1 if its bit is
+    ///                  set, and 0 otherwise.
+    /// @note  Loops over the unpacked bytes have no dependency between iterations, so they
+    ///        vectorize where walking the bits of a word does not.
+    void unpack(const size_t& first, const size_t& last, uint8_t* out) const
+    {
+        for (size_t i = first; i < last; )
+        {
+            const size_t w = i / word_bits;
+            const size_t n = std::min(last, (w + 1) * word_bits) - i;
+            Word bits = this->word(w) >> (i % word_bits);
+
+            // Spreads eight bits at a time, one into the lowest bit of each byte of a word.
+            size_t j = 0;
+            for ( ; j + 8 <= n; j += 8, bits >>= 8)
+            {
+                const Word spread = ((((bits & 0xFF) * 0x0101010101010101) & 0x8040201008040201) +
+                                     0x7F7F7F7F7F7F7F7F) >> 7 & 0x0101010101010101;
+                for (size_t k = 0; k < 8; ++k)
+                {
+                    out[j + k] = static_cast<uint8_t>(spread >> (8 * k));
+                }
+            }
+            for ( ; j < n; ++j, bits >>= 1)
+            {
+                out[j] = static_cast<uint8_t>(bits & 1);
+            }
+            out += n;
+            i   += n;
+        }
+    }
+
+
+    /// @brief Sets a bit and marks its block as dirty.
+    /// @param i Index of the bit.
+    /// @note  Not safe if another thread writes to the same word at the same time. See `setAtomic`.
+    void set(const size_t& i)
+    {
+        std::atomic<Word>& word = this->words[i / word_bits];
+        word.store(word.load(std::memory_order_relaxed) | (Word(1) << (i % word_bits)), std::memory_order_relaxed);
+        this->markDirty(i >> block_bits);
+    }
+
+
+    /// @brief Sets a bit and marks its block as dirty. Safe to call from any number of threads.
+    /// @param i Index of the bit.
+    void setAtomic(const size_t& i)
+    {
+        this->words[i / word_bits].fetch_or(Word(1) << (i % word_bits), std::memory_order_relaxed);
+        this->markDirty(i >> block_bits);
+    }
+
+
+    /// @brief Clears a bit. The dirty index is unchanged.
+    /// @param i Index of the bit.
+    /// @note  Not safe if another thread writes to the same word at the same time.
+    void reset(const size_t& i)
+    {
+        std::atomic<Word>& word = this->words[i / word_bits];
+        word.store(word.load(std::memory_order_relaxed) & ~(Word(1) << (i % word_bits)), std::memory_order_relaxed);
+    }
+
+
+    /// @brief Clears every bit and the dirty index.
+    void reset()
+    {
+        for (auto& word : this->words)
+        {
+            word.store(0, std::memory_order_relaxed);
+        }
+        this->clearDirty();
+    }
+
+
+    /// @brief Counts the set bits.
+    /// @return Number of bits which are set.
+    size_t count() const
+    {
+        size_t n = 0;
+        for (const auto& word : this->words)
+        {
+            n += std::bitset<word_bits>(word.load(std::memory_order_relaxed)).count();
+        }
+        return n;
+    }
+
+
+    /// @brief Returns true if a bit within the block was set since the dirty index was cleared.
+    /// @param b Index of the block. Bit `i` is in block `i >> block_bits`.
+    bool isDirty(const size_t& b) const
+    {
+        return (this->dirty[b / word_bits].load(std::memory_order_relaxed) >> (b % word_bits)) & 1;
+    }
+
+
+    /// @brief Counts the dirty blocks.
+    /// @return Number of blocks with a bit set since the dirty index was cleared.
+    size_t numDirtyBlocks() const
+    {
+        size_t n = 0;
+        for (const auto& word : this->dirty)
+        {
+            n += std::bitset<word_bits>(word.load(std::memory_order_relaxed)).count();
+        }
+        return n;
+    }
+
+
+    /// @brief Clears the dirty index. The bits themselves are unchanged.
+    void clearDirty()
+    {
+        for (auto& word : this->dirty)
+        {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+
+    /// @brief Clears every bit within the dirty blocks, and then the dirty index.
+    /// @note  If every bit was set since the dirty index was last cleared, this resets the Bitset in
+    ///        time proportional to the number of dirty blocks rather than to `size()`.
+    void resetDirtyBlocks()
+    {
+        static constexpr size_t words_per_block = block_size / word_bits;
+        this->forEachDirtyBlock([this](const size_t& first, const size_t&)
+        {
+            const size_t w0 = first / word_bits;
+            const size_t w1 = std::min(w0 + words_per_block, this->words.size());
+            for (size_t w = w0; w < w1; ++w)
+            {
+                this->words[w].store(0, std::memory_order_relaxed);
+            }
+        });
+        this->clearDirty();
+    }
+
+
+    /// @brief Calls a function for each dirty block, in order.
+    /// @param f Callable with the signature `void(const size_t& first, const size_t& last)` for the
+    ///          range of bit indices `[first, last)` the block covers.
+    template <typename Function>
+    void forEachDirtyBlock(Function&& f) const
+    {
+        for (size_t w = 0; w < this->dirty.size(); ++w)
+        {
+            Word word = this->dirty[w].load(std::memory_order_relaxed);
+            for (size_t b = w * word_bits; word != 0; ++b, word >>= 1)
+            {
+                if (word & 1)
+                {
+                    const size_t first = b << block_bits;
+                    f(first, std::min(first + block_size, this->n_bits));
+                }
+            }
+        }
+    }
+
+
+    /// @brief Calls a function for each set bit, in order.
+    /// @param f Callable with the signature `void(const size_t& i)`.
+    template <typename Function>
+    void forEachSet(Function&& f) const
+    {
+        this->forEachSetInWords(0, this->words.size(), f);
+    }
+
+
+    /// @brief Calls a function for each set bit within the dirty blocks, in order.
+    /// @param f Callable with the signature `void(const size_t& i)`.
+    /// @note  If every bit was set since the dirty index was last cleared, this visits them in time
+    ///        proportional to the number of dirty blocks rather than to `size()`.
+    template <typename Function>
+    void forEachSetInDirtyBlocks(Function&& f) const
+    {
+        this->forEachDirtyBlock([this, &f](const size_t& first, const size_t& last)
+        {
+            this->forEachSetInWords(first / word_bits, (last + word_bits - 1) / word_bits, f);
+        });
+    }
+
+
+    /// @brief Number of bytes used by the bits and the dirty index.
+    size_t sizeBytes() const
+    {
+        return sizeof(Word) * (this->words.size() + this->dirty.size());
+    }
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Calls a function for each set bit in the words `[w0, w1)`, in order.
+    template <typename Function>
+    void forEachSetInWords(const size_t& w0, const size_t& w1, Function& f) const
+    {
+        for (size_t w = w0; w < w1; ++w)
+        {
+            Word word = this->words[w].load(std::memory_order_relaxed);
+            while (word != 0)
+            {
+                const Word lowest = word & (~word + 1);
+                f(w * word_bits + std::bitset<word_bits>(lowest - 1).count());
+                word ^= lowest;
+            }
+        }
+    }
+
+
+    /// @brief Raises the dirty flag of a block. Safe to call from any number of threads.
+    /// @param b Index of the block.
+    void markDirty(const size_t& b)
+    {
+        std::atomic<Word>& word = this->dirty[b / word_bits];
+        const Word flag = Word(1) << (b % word_bits);
+
+        // Most bits are set in blocks which are already dirty, so check before the atomic write.
+        if ((word.load(std::memory_order_relaxed) & flag) == 0)
+        {
+            word.fetch_or(flag, std::memory_order_relaxed);
+        }
+    }
+
+
+    /// @brief Copies the words and dirty flags of a Bitset of the same size.
+    /// @param other Bitset to copy.
+    void copyWords(const Bitset& other)
+    {
+        for (size_t w = 0; w < this->words.size(); ++w)
+        {
+            this->words[w].store(other.words[w].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        for (size_t w = 0; w < this->dirty.size(); ++w)
+        {
+            this->dirty[w].store(other.dirty[w].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Number of bits.
+    size_t n_bits;
+
+    /// @brief Number of blocks covered by the dirty index.
+    size_t n_blocks;
+
+    /// @brief Packed bits.
+    std::vector<std::atomic<Word>> words;
+
+    /// @brief Packed dirty flag for each block.
+    std::vector<std::atomic<Word>> dirty;
+};
+
+
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_COMMON_BITSET_HPP
@@ -0,0 +1,377 @@
+#ifndef FORGE_SCAN_COMMON_DBSCAN_HPP
+#define FORGE_SCAN_COMMON_DBSCAN_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Core>
+
+
+namespace forge_scan {
+
+
+/// @brief DBSCAN clustering over a set of points which is updated in place between clusterings.
+/// @details Points are hashed into cubic cells with sides of length `eps`, so every neighbor of a
+///          point is in its own cell or one of the 26 around it. Each point's neighbor count is kept
+///          as points are added and removed, which costs one neighbor query per change. Clustering
+///          then only walks the core points, and is skipped entirely if nothing has changed.
+/// @note  The clusters match `open3d::geometry::PointCloud::ClusterDBSCAN`: a point is a neighbor
+///        of itself, a point with at least `min_points` neighbors is a core point, and the clusters
+///        are found from the core points in ascending key order. Border points join the first
+///        cluster which reaches them.
+/// @tparam T Value stored with each point.
+template <typename T>
+class IncrementalDBSCAN
+{
+public:
+    /// @brief Label for points which are not in any cluster.
+    static constexpr int32_t noise = -1;
+
+
+    /// @brief Point in the set.
+    struct Node
+    {
+        /// @brief Caller's unique identifier for the point.
+        uint64_t key;
+
+        /// @brief Location of the point.
+        Eigen::Vector3d point;
+
+        /// @brief Value stored with the point.
+        T value;
+
+        /// @brief Cluster label, or `noise`. Valid after `cluster`.
+        int32_t label = noise;
+
+        /// @brief Number of points within `eps`, including this one.
+        size_t n_neighbors = 0;
+
+        /// @brief Cell the point is in.
+        uint64_t cell = 0;
+
+        /// @brief Value of `generation` when the point was last updated.
+        size_t generation = 0;
+    };
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Creates an empty set of points.
+    /// @param eps The distance below which two points are considered neighbors.
+    /// @param min_points The minimum number of neighbors for a point to be a core point.
+    IncrementalDBSCAN(const double& eps, const size_t& min_points)
+        : eps_squared(eps * eps),
+          cell_size(std::abs(eps) > 0 ? std::abs(eps) : 1.0),
+          min_points(std::max(min_points, size_t(1)))
+    {
+
+    }
+
+
+    /// @brief Removes every point.
+    void clear()
+    {
+        this->nodes.clear();
+        this->slot_of.clear();
+        this->cells.clear();
+        this->changed = true;
+    }
+
+
+    /// @brief Starts a round of updates. Points which are not updated before `endUpdate` is
+    ///        called are removed.
+    void beginUpdate()
+    {
+        ++this->generation;
+    }
+
+
+    /// @brief Adds a point, or moves it if its key is already in the set.
+    /// @param key Unique identifier for the point.
+    /// @param point Location of the point.
+    /// @param value Value to store with the point.
+    /// @note  Moving a point to the location it already had only updates its value.
+    void update(const uint64_t& key, const Eigen::Vector3d& point, const T& value)
+    {
+        auto iter = this->slot_of.find(key);
+        if (iter != this->slot_of.end())
+        {
+            Node& node = this->nodes[iter->second];
+            node.generation = this->generation;
+            node.value = value;
+            if (node.point == point)
+            {
+                return;
+            }
+            this->erase(iter->second);
+        }
+        this->insert(key, point, value);
+    }
+
+
+    /// @brief Removes every point which was not updated since `beginUpdate`.
+    void endUpdate()
+    {
+        for (size_t slot = this->nodes.size(); slot-- > 0; )
+        {
+            if (this->nodes[slot].generation != this->generation)
+            {
+                this->erase(slot);
+            }
+        }
+    }
+
+
+    /// @brief Labels the points.
+    /// @return Number of clusters. Labels are in the range `[0, n_clusters)`, or `noise`.
+    /// @note  The labels from the last call are kept if no point was added, moved, or removed since.
+    size_t cluster()
+    {
+        if (!this->changed)
+        {
+            return this->n_clusters;
+        }
+
+        // Core points are visited in key order so the labels do not depend on the update history.
+        std::vector<size_t> order(this->nodes.size());
+        for (size_t slot = 0; slot < order.size(); ++slot)
+        {
+            order[slot] = slot;
+            this->nodes[slot].label = unvisited;
+        }
+        std::sort(order.begin(), order.end(),
+                  [this](const size_t& a, const size_t& b) { return this->nodes[a].key < this->nodes[b].key; });
+
+        int32_t label = 0;
+        std::vector<size_t> frontier;
+        for (const size_t& slot : order)
+        {
+            if (this->nodes[slot].label != unvisited || !this->isCore(this->nodes[slot]))
+            {
+                continue;
+            }
+            this->nodes[slot].label = label;
+            frontier.assign(1, slot);
+            while (!frontier.empty())
+            {
+                const size_t current = frontier.back();
+                frontier.pop_back();
+                this->forEachNeighbor(this->nodes[current].point, [&](const size_t& other)
+                {
+                    Node& node = this->nodes[other];
+                    if (node.label == unvisited)
+                    {
+                        node.label = label;
+                        if (this->isCore(node))
+                        {
+                            frontier.push_back(other);
+                        }
+                    }
+                });
+            }
+            ++label;
+        }
+
+        for (auto& node : this->nodes)
+        {
+            if (node.label == unvisited)
+            {
+                node.label = noise;
+            }
+        }
+        this->n_clusters = static_cast<size_t>(label);
+        this->changed = false;
+        return this->n_clusters;
+    }
+
+
+    /// @brief Number of points in the set.
+    size_t size() const
+    {
+        return this->nodes.size();
+    }
+
+
+    /// @brief Points in the set, in no particular order. Labels are valid after `cluster`.
+    const std::vector<Node>& getNodes() const
+    {
+        return this->nodes;
+    }
+
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Label for points not yet reached while clustering.
+    static constexpr int32_t unvisited = -2;
+
+    /// @brief Bits for each axis of a packed cell coordinate.
+    static constexpr uint64_t cell_bits = 21, cell_mask = (uint64_t(1) << cell_bits) - 1;
+
+
+    /// @brief Packs a cell coordinate into a key. Far apart cells may share a key, that only
+    ///        adds points which fail the distance check to a neighbor query.
+    static uint64_t packCell(const int64_t& x, const int64_t& y, const int64_t& z)
+    {
+        return (static_cast<uint64_t>(x) & cell_mask) |
+               (static_cast<uint64_t>(y) & cell_mask) << cell_bits |
+               (static_cast<uint64_t>(z) & cell_mask) << (2 * cell_bits);
+    }
+
+
+    /// @brief Finds the coordinate of the cell a point is in.
+    Eigen::Matrix<int64_t, 3, 1> getCell(const Eigen::Vector3d& point) const
+    {
+        return (point / this->cell_size).array().floor().template cast<int64_t>();
+    }
+
+
+    bool isCore(const Node& node) const
+    {
+        return node.n_neighbors >= this->min_points;
+    }
+
+
+    /// @brief Calls `f(slot)` for every point within `eps` of a location, including any point at it.
+    template <typename F>
+    void forEachNeighbor(const Eigen::Vector3d& point, F&& f) const
+    {
+        const Eigen::Matrix<int64_t, 3, 1> c = this->getCell(point);
+        for (int64_t dz = -1; dz <= 1; ++dz)
+        {
+            for (int64_t dy = -1; dy <= 1; ++dy)
+            {
+                for (int64_t dx = -1; dx <= 1; ++dx)
+                {
+                    auto iter = this->cells.find(packCell(c.x() + dx, c.y() + dy, c.z() + dz));
+                    if (iter == this->cells.end())
+                    {
+                        continue;
+                    }
+                    for (const size_t& slot : iter->second)
+                    {
+                        if ((this->nodes[slot].point - point).squaredNorm() <= this->eps_squared)
+                        {
+                            f(slot);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+
+    /// @brief Adds a point whose key is not in the set.
+    void insert(const uint64_t& key, const Eigen::Vector3d& point, const T& value)
+    {
+        const size_t slot = this->nodes.size();
+
+        Node node;
+        node.key   = key;
+        node.point = point;
+        node.value = value;
+        node.generation = this->generation;
+        const Eigen::Matrix<int64_t, 3, 1> c = this->getCell(point);
+        node.cell = packCell(c.x(), c.y(), c.z());
+        this->nodes.push_back(node);
+
+        this->cells[node.cell].push_back(slot);
+        this->slot_of[key] = slot;
+
+        // The point is its own neighbor, so its count is set by the same query.
+        this->forEachNeighbor(point, [&](const size_t& other)
+        {
+            ++this->nodes[other].n_neighbors;
+            if (other != slot)
+            {
+                ++this->nodes[slot].n_neighbors;
+            }
+        });
+        this->changed = true;
+    }
+
+
+    /// @brief Removes a point. The last point is moved into its slot.
+    void erase(const size_t& slot)
+    {
+        this->forEachNeighbor(this->nodes[slot].point, [&](const size_t& other)
+        {
+            --this->nodes[other].n_neighbors;
+        });
+
+        removeFromCell(this->nodes[slot].cell, slot);
+        this->slot_of.erase(this->nodes[slot].key);
+
+        const size_t last = this->nodes.size() - 1;
+        if (slot != last)
+        {
+            auto& cell = this->cells[this->nodes[last].cell];
+            std::replace(cell.begin(), cell.end(), last, slot);
+            this->slot_of[this->nodes[last].key] = slot;
+            this->nodes[slot] = this->nodes[last];
+        }
+        this->nodes.pop_back();
+        this->changed = true;
+    }
+
+
+    /// @brief Removes a slot from the list of points in a cell, dropping the cell if it is emptied.
+    void removeFromCell(const uint64_t& cell, const size_t& slot)
+    {
+        auto iter = this->cells.find(cell);
+        auto& slots = iter->second;
+        slots.erase(std::find(slots.begin(), slots.end(), slot));
+        if (slots.empty())
+        {
+            this->cells.erase(iter);
+        }
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                 PRIVATE CLASS MEMBERS                                 * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Square of the neighbor distance, and the side length of the cells.
+    const double eps_squared, cell_size;
+
+    /// @brief Minimum number of neighbors for a core point.
+    const size_t min_points;
+
+    /// @brief Points in the set.
+    std::vector<Node> nodes;
+
+    /// @brief Slot in `nodes` for each key.
+    std::unordered_map<uint64_t, size_t> slot_of;
+
+    /// @brief Slots in `nodes` of the points in each cell.
+    std::unordered_map<uint64_t, std::vector<size_t>> cells;
+
+    /// @brief Incremented by `beginUpdate`.
+    size_t generation = 0;
+
+    /// @brief True if the points changed since the last call to `cluster`.
+    bool changed = true;
+
+    /// @brief Number of clusters found by the last call to `cluster`.
+    size_t n_clusters = 0;
+};
+
+
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_COMMON_DBSCAN_HPP
@@ -37,6 +37,9 @@
 // Define the XDMF file extension for this header file only.
 #define FS_XDMF_FILE_EXTENSION ".xdmf"
 
+// Define the PLY file extension for this header file only.
+#define FS_PLY_FILE_EXTENSION ".ply"
+
 /// Group name where all Reconstruction data is stored in an HDF5 file.
 #define FS_HDF5_RECONSTRUCTION_GROUP "Reconstruction"
 
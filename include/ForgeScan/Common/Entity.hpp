@@ -213,7 +213,7 @@ struct Entity
     /// @param x Input Points. Transformed in place.
     void toThisFromWorld(PointMatrix& x) const
     {
-        x = this->getToThisFromWorld() * x.colwise().homogeneous();
+        Entity::transformInPlace(x, this->getToThisFromWorld());
     }
 
 
@@ -221,7 +221,7 @@ struct Entity
     /// @param x Input Point. Transformed in place.
     void toWorldFromThis(PointMatrix& x) const
     {
-        x = this->getToWorldFromThis() * x.colwise().homogeneous();
+        Entity::transformInPlace(x, this->getToWorldFromThis());
     }
 
 
@@ -230,7 +230,7 @@ struct Entity
     /// @param other Extrinsic matrix or reference frame for the other entity.
     void toThisFromOther(PointMatrix& x, const Extrinsic& other) const
     {
-        x = this->getToThisFromOther(other) * x.colwise().homogeneous();
+        Entity::transformInPlace(x, this->getToThisFromOther(other));
     }
 
 
@@ -239,7 +239,7 @@ struct Entity
     /// @param other Extrinsic matrix or reference frame for the other entity.
     void toOtherFromThis(PointMatrix& x, const Extrinsic& other) const
     {
-        x = this->getToOtherFromThis(other) * x.colwise().homogeneous();
+        Entity::transformInPlace(x, this->getToOtherFromThis(other));
     }
 
 
@@ -307,6 +307,21 @@ struct Entity
     static const std::string rotation_help_string, rotation_default_arguments;
 
 protected:
+    /// @brief Transforms each Point of a matrix in place. Unlike multiplying by the homogeneous
+    ///        matrix, this does not allocate a temporary matrix for the result.
+    /// @param x Points to transform.
+    /// @param transform Transformation to apply.
+    static void transformInPlace(PointMatrix& x, const Extrinsic& transform)
+    {
+        const Eigen::Matrix3f rotation    = transform.rotation();
+        const Eigen::Vector3f translation = transform.translation();
+        for (auto point : x.colwise())
+        {
+            point = rotation * point + translation;
+        }
+    }
+
+
     /// @brief Extrinsic transformation from the world coordinates to the entity.
     Extrinsic extr;
 };
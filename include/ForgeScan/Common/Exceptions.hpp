@@ -246,6 +246,36 @@ struct DataVariantError : public Exception
 };
 
 
+
+/// @brief Exception class for allocations that would exceed a memory budget, such as the budget
+///        of a `data::Reconstruction`.
+struct MemoryBudgetError : public Exception
+{
+    /// @brief Constructs a MemoryBudgetError exception.
+    /// @param what Exception message.
+    explicit MemoryBudgetError(const std::string& what)
+        : Exception(what)
+    {
+
+    }
+
+
+    /// @brief Constructor for when an item would need more memory than the budget has left.
+    /// @param name      Name of the item that was not allocated.
+    /// @param requested Number of bytes the item would allocate.
+    /// @param in_use    Number of bytes already used.
+    /// @param budget    Number of bytes the budget allows.
+    /// @return MemoryBudgetError with message.
+    static MemoryBudgetError WouldExceed(const std::string& name, const size_t& requested,
+                                         const size_t& in_use,    const size_t& budget)
+    {
+        std::stringstream ss;
+        ss << "Allocating \"" << name << "\" needs " << requested * 1e-6 << " MB, but "
+           << in_use * 1e-6 << " MB of the " << budget * 1e-6 << " MB memory budget are in use.";
+        return MemoryBudgetError(ss.str());
+    }
+};
+
 } // namespace forge_scan
 
 
@@ -1,8 +1,11 @@
 #ifndef FORGE_SCAN_COMMON_GRID_HPP
 #define FORGE_SCAN_COMMON_GRID_HPP
 
+#include <algorithm>
 #include <memory>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "ForgeScan/Common/Types.hpp"
 #include "ForgeScan/Utilities/ArgParser.hpp"
@@ -14,8 +17,9 @@ namespace forge_scan {
 
 /// @brief Base interface for Grid of uniformly-sized voxels.
 /// @details Derived classes are responsible for providing a vector for the voxel data.
-///          This vector stores data continuously in memory, and is expected to
-///          increment fastest in X, then Y, then Z.
+///          This vector stores data continuously in memory, and by default is expected to
+///          increment fastest in X, then Y, then Z. If the Properties have a `brick_size` greater
+///          than one the vector is instead ordered brick by brick. See `Properties::brick_size`.
 /// @note  The `Grid` class and those derived from it may be treated as axis-aligned bounding box
 ///        (AABB). The AABB's shape is based on the Grid Properties: the lower bound is always at
 ///        (0, 0, 0) while the upper bound is at the Property's `size*resolution`, or `dimension`.
@@ -32,12 +36,24 @@ struct Grid
         /// @brief Constructor based on resolution and Grid size, dimensions is set implicitly
         /// @param resolution Edge length of each voxel in world units. Default 0.02.
         /// @param size       Number of voxels in the Grid in each direction. Default (101, 101, 101)
+        /// @param sparse     If true, VoxelGrids using these Properties store their data sparsely.
+        /// @param brick_size Edge length, in voxels, of the bricks the data vector is ordered by.
+        ///                   Default 1, which is the X-major linear order.
+        /// @param mmap_dir   If not empty, VoxelGrids using these Properties store their data in
+        ///                   memory-mapped files created in this directory.
         /// @note Ensures there is a minimum GridSize of (1, 1, 1).
         /// @note Ensures the resolution is positive.
+        /// @note Ensures the brick size is a supported power of two.
         Properties(const float& resolution = 0.02,
-                   const GridSize& size = GridSize(101, 101, 101))
+                   const GridSize& size = GridSize(101, 101, 101),
+                   const bool& sparse = false,
+                   const size_t& brick_size = 1,
+                   const std::string& mmap_dir = "")
             : resolution(resolution),
-              size(size)
+              size(size),
+              sparse(sparse),
+              brick_size(brick_size),
+              mmap_dir(mmap_dir)
         {
             this->setDimensions();
         }
@@ -51,7 +67,10 @@ struct Grid
             : resolution(parser.get<float>(Properties::parse_resolution, Properties::default_resolution)),
               size(std::max(parser.get<int>(Properties::parse_nx, Properties::default_size), 1),
                    std::max(parser.get<int>(Properties::parse_ny, Properties::default_size), 1),
-                   std::max(parser.get<int>(Properties::parse_nz, Properties::default_size), 1))
+                   std::max(parser.get<int>(Properties::parse_nz, Properties::default_size), 1)),
+              sparse(parser.has(Properties::parse_sparse)),
+              brick_size(std::max(parser.get<int>(Properties::parse_brick_size, Properties::default_brick_size), 1)),
+              mmap_dir(parser.get(Properties::parse_mmap))
         {
             this->setDimensions();
         }
@@ -59,7 +78,10 @@ struct Grid
 
         Properties(const Properties& other)
             : resolution(other.resolution),
-              size(other.size)
+              size(other.size),
+              sparse(other.sparse),
+              brick_size(other.brick_size),
+              mmap_dir(other.mmap_dir)
         {
             this->setDimensions();
         }
@@ -68,12 +90,21 @@ struct Grid
         /// @brief Creates a shared pointer to a constant Grid Properties.
         /// @param resolution Edge length of each voxel in world units.
         /// @param size       Number of voxels in the Grid in each direction. Default (101, 101, 101)
+        /// @param sparse     If true, VoxelGrids using these Properties store their data sparsely.
+        /// @param brick_size Edge length, in voxels, of the bricks the data vector is ordered by.
+        ///                   Default 1, which is the X-major linear order.
+        /// @param mmap_dir   If not empty, VoxelGrids using these Properties store their data in
+        ///                   memory-mapped files created in this directory.
         /// @note Ensures there is a minimum GridSize of (1, 1, 1).
         /// @note Ensures the resolution is positive.
+        /// @note Ensures the brick size is a supported power of two.
         static std::shared_ptr<const Properties> createConst(const float& resolution = 0.02,
-                                                             const GridSize& size = GridSize(101, 101, 101))
+                                                             const GridSize& size = GridSize(101, 101, 101),
+                                                             const bool& sparse = false,
+                                                             const size_t& brick_size = 1,
+                                                             const std::string& mmap_dir = "")
         {
-            return std::shared_ptr<Properties>(new Properties(resolution, size));
+            return std::shared_ptr<Properties>(new Properties(resolution, size, sparse, brick_size, mmap_dir));
         }
 
 
@@ -128,12 +159,16 @@ struct Grid
         /// @brief Compares two Grid Properties to verify that all values are equal.
         /// @param other The Grid Properties to compare against this.
         /// @return True if all values are equal.
+        /// @note  The storage type is not compared. Dense, sparse and mapped data with equal
+        ///        Properties still address the same voxels with the same vector indices.
+        /// @note  The brick size is compared as it changes which vector index a voxel has.
         bool isEqual(const Properties& other) const
         {
             return (this->resolution         == other.resolution        )       &&
                    (this->size.array()       == other.size.array()      ).all() &&
                    (this->dimensions.array() == other.dimensions.array()).all() &&
-                   (this->p2i_scale.array()  == other.p2i_scale.array() ).all();
+                   (this->p2i_scale.array()  == other.p2i_scale.array() ).all() &&
+                   (this->brick_size         == other.brick_size        );
         }
 
 
@@ -149,9 +184,11 @@ struct Grid
         /// @brief Updates the dimensions (and point-to-index scale) to fit the size and resolution.
         /// @note Also ensures that the resolution is positive.
         /// @note Also ensures each dimension has a size of at least 1.
+        /// @note Also ensures the brick size is a supported power of two.
         void setDimensions()
         {
             this->checkMinimumGridSize();
+            this->checkBrickSize();
             this->resolution = std::abs(this->resolution);
             this->dimensions = (size.cast<float>().array() - 1) * this->resolution;
             this->p2i_scale  = (size.cast<float>().array() - 1) / dimensions.array();
@@ -177,6 +214,36 @@ struct Grid
         }
 
 
+        /// @brief Finds the voxel location for the provided vector Index. The inverse of `operator[]`.
+        ///        Does not verify if this position is in the Grid.
+        /// @param i Vector position of the voxel.
+        /// @return Index of the voxel.
+        Index vectorToIndex(const size_t& i) const
+        {
+            const size_t plane = this->size[0] * this->size[1];
+            if (this->isLinear())
+            {
+                return Index(i % this->size[0], (i / this->size[0]) % this->size[1], i / plane);
+            }
+
+            // Undo the steps of `indexToVector`: find the layer of bricks, then the row of bricks
+            // within it, then the brick within the row, then the voxel within the brick.
+            const size_t z0 = (i / plane) & ~this->brick_mask;
+            const size_t wz = std::min(this->brick_size, this->size[2] - z0);
+            size_t r = i - z0 * plane;
+
+            const size_t y0 = (r / (this->size[0] * wz)) & ~this->brick_mask;
+            const size_t wy = std::min(this->brick_size, this->size[1] - y0);
+            r -= y0 * this->size[0] * wz;
+
+            const size_t x0 = (r / (wy * wz)) & ~this->brick_mask;
+            const size_t wx = std::min(this->brick_size, this->size[0] - x0);
+            r -= x0 * wy * wz;
+
+            return Index(x0 + r % wx, y0 + (r / wx) % wy, z0 + r / (wx * wy));
+        }
+
+
         /// @brief Finds the vector Index for the provided voxel location.
         ///        Verifies that this voxel is in the Grid.
         /// @param voxel Index for the desired voxel.
@@ -220,6 +287,217 @@ struct Grid
             return this->size.prod();
         }
 
+
+        /// @brief Returns true if the data vector uses the X-major linear order.
+        bool isLinear() const
+        {
+            return this->brick_bits == 0;
+        }
+
+
+        /// @brief Finds the change in vector index for a one voxel step along each axis.
+        /// @param voxel Index of the voxel to step from.
+        /// @return Stride for a step along X, Y and Z. For a bricked layout these are only valid for
+        ///         steps which stay within the voxel's brick. See `sameBrick`.
+        GridSize getVectorStrides(const Index& voxel) const
+        {
+            if (this->isLinear())
+            {
+                return GridSize(1, this->size[0], this->size[0] * this->size[1]);
+            }
+            const size_t wx = std::min(this->brick_size, this->size[0] - (voxel[0] & ~this->brick_mask));
+            const size_t wy = std::min(this->brick_size, this->size[1] - (voxel[1] & ~this->brick_mask));
+            return GridSize(1, wx, wx * wy);
+        }
+
+
+        /// @brief Checks if two positions along one axis are in the same brick.
+        /// @param a Position of the first voxel along the axis.
+        /// @param b Position of the second voxel along the axis.
+        /// @return True if they are in the same brick. Always true for the linear layout.
+        bool sameBrick(const size_t& a, const size_t& b) const
+        {
+            return ((a ^ b) & ~this->brick_mask) == 0 || this->isLinear();
+        }
+
+
+        /// @brief Reorders a data vector from this Grid's layout into the X-major linear order.
+        /// @param data Vector of `getNumVoxels` elements in this Grid's layout.
+        /// @return Vector in the X-major linear order. This is a copy even if `isLinear` is true.
+        /// @note  Files are always written in the linear order so they do not depend on the layout.
+        template <typename T>
+        std::vector<T> toLinearOrder(const std::vector<T>& data) const
+        {
+            if (this->isLinear())
+            {
+                return data;
+            }
+            std::vector<T> linear;
+            linear.reserve(data.size());
+            for (size_t z = 0; z < this->size.z(); ++z)
+            {
+                for (size_t y = 0; y < this->size.y(); ++y)
+                {
+                    for (size_t x = 0; x < this->size.x(); ++x)
+                    {
+                        linear.push_back(data[this->indexToVector(Index(x, y, z))]);
+                    }
+                }
+            }
+            return linear;
+        }
+
+
+        /// @brief Reorders a data vector from the X-major linear order into this Grid's layout.
+        /// @param data Vector of `getNumVoxels` elements in the linear order.
+        /// @return Vector in this Grid's layout. This is a copy even if `isLinear` is true.
+        template <typename T>
+        std::vector<T> fromLinearOrder(const std::vector<T>& data) const
+        {
+            if (this->isLinear())
+            {
+                return data;
+            }
+            std::vector<T> bricked(data.size());
+            size_t i = 0;
+            for (size_t z = 0; z < this->size.z(); ++z)
+            {
+                for (size_t y = 0; y < this->size.y(); ++y)
+                {
+                    for (size_t x = 0; x < this->size.x(); ++x, ++i)
+                    {
+                        bricked[this->indexToVector(Index(x, y, z))] = data[i];
+                    }
+                }
+            }
+            return bricked;
+        }
+
+
+        /// @brief Visits the voxels as if the Grid's contents were moved some number of voxels
+        ///        towards the lower bound of one axis. Each voxel takes the contents of the voxel that
+        ///        number of steps above it, or is cleared if that is outside the Grid.
+        /// @param axis  Axis to move along. 0, 1 or 2 for X, Y or Z.
+        /// @param steps Number of voxels to move by. A negative value moves towards the upper bound.
+        /// @param move  Callable with the signature `void(to, from)` taking two vector indices.
+        /// @param clear Callable with the signature `void(to)` taking a vector index.
+        /// @note  Each voxel is read before it is written, so the contents may be moved in place.
+        template <typename Move, typename Clear>
+        void forEachShifted(const size_t& axis, const int& steps, Move&& move, Clear&& clear) const
+        {
+            const size_t a1 = (axis + 1) % 3, a2 = (axis + 2) % 3;
+            const long n = static_cast<long>(this->size[axis]);
+            for (long k = 0; k < n; ++k)
+            {
+                const long a    = steps >= 0 ? k : n - 1 - k;
+                const long from = a + steps;
+                Index to_voxel, from_voxel;
+                to_voxel[axis]   = static_cast<size_t>(a);
+                from_voxel[axis] = static_cast<size_t>(from);
+                for (size_t u = 0; u < this->size[a2]; ++u)
+                {
+                    to_voxel[a2] = from_voxel[a2] = u;
+                    for (size_t v = 0; v < this->size[a1]; ++v)
+                    {
+                        to_voxel[a1] = from_voxel[a1] = v;
+                        if (from >= 0 && from < n)
+                        {
+                            move(this->indexToVector(to_voxel), this->indexToVector(from_voxel));
+                        }
+                        else
+                        {
+                            clear(this->indexToVector(to_voxel));
+                        }
+                    }
+                }
+            }
+        }
+
+
+        /// @brief Visits the voxels of a slab of the Grid, in the X-major linear order.
+        /// @param axis  Axis across which the slab is cut. 0, 1 or 2 for X, Y or Z.
+        /// @param first First layer of voxels along the axis in the slab.
+        /// @param last  One past the last layer of voxels along the axis in the slab.
+        /// @param visit Callable with the signature `void(i)` taking a vector index.
+        template <typename Visit>
+        void forEachInSlab(const size_t& axis, const size_t& first, const size_t& last, Visit&& visit) const
+        {
+            Index lower = Index::Zero(), upper = this->size;
+            lower[axis] = first;
+            upper[axis] = std::min(last, this->size[axis]);
+            this->forEachInBox(lower, upper, visit);
+        }
+
+
+        /// @brief Visits the voxels of a box of the Grid, in the X-major linear order.
+        /// @param lower Lowest voxel of the box.
+        /// @param upper One past the highest voxel of the box, along each axis. This must be within
+        ///              the Grid's size.
+        /// @param visit Callable with the signature `void(i)` taking a vector index.
+        template <typename Visit>
+        void forEachInBox(const Index& lower, const Index& upper, Visit&& visit) const
+        {
+            for (size_t z = lower.z(); z < upper.z(); ++z)
+            {
+                for (size_t y = lower.y(); y < upper.y(); ++y)
+                {
+                    for (size_t x = lower.x(); x < upper.x(); ++x)
+                    {
+                        visit(this->indexToVector(Index(x, y, z)));
+                    }
+                }
+            }
+        }
+
+
+        /// @brief Number of chunks in each direction. Chunks are cubes of `1 << chunk_bits` voxels
+        ///        per edge, truncated at the upper edges of the Grid, and are X-major in the Grid.
+        GridSize getNumChunks() const
+        {
+            return (this->size.array() + ((size_t(1) << chunk_bits) - 1)) / (size_t(1) << chunk_bits);
+        }
+
+
+        /// @brief Finds the box of voxels a chunk covers. See `getNumChunks`.
+        /// @param c Index of the chunk.
+        /// @param [out] lower Lowest voxel of the chunk.
+        /// @param [out] upper One past the highest voxel of the chunk, along each axis.
+        void getChunkBox(const size_t& c, Index& lower, Index& upper) const
+        {
+            const GridSize n = this->getNumChunks();
+            lower = Index(c % n[0], (c / n[0]) % n[1], c / (n[0] * n[1])) * (size_t(1) << chunk_bits);
+            upper = (lower.array() + (size_t(1) << chunk_bits)).min(this->size.array());
+        }
+
+
+        /// @brief Finds the chunk holding a voxel, and a run of vector indices around it which are
+        ///        all in that chunk. See `getNumChunks`.
+        /// @param i Vector index of the voxel.
+        /// @param [out] first First vector index of the run.
+        /// @param [out] last  One past the last vector index of the run. This is the voxel's brick,
+        ///                    or for the linear layout its row within the chunk. A brick is never
+        ///                    larger than a chunk.
+        /// @return Index of the chunk.
+        size_t getChunk(const size_t& i, size_t& first, size_t& last) const
+        {
+            const GridSize n = this->getNumChunks();
+            const Index voxel = this->vectorToIndex(i);
+            if (this->isLinear())
+            {
+                const size_t x0 = (voxel[0] >> chunk_bits) << chunk_bits;
+                first = i - (voxel[0] - x0);
+                last  = first + std::min(size_t(1) << chunk_bits, this->size[0] - x0);
+            }
+            else
+            {
+                const Index brick = voxel.unaryExpr([this](const size_t& v) { return v & ~this->brick_mask; });
+                const GridSize width = (brick.array() + this->brick_size).min(this->size.array()) - brick.array();
+                first = this->indexToVector(brick);
+                last  = first + width.prod();
+            }
+            return (voxel[0] >> chunk_bits) + n[0] * ((voxel[1] >> chunk_bits) + n[1] * (voxel[2] >> chunk_bits));
+        }
+
         /// @brief Resolution of the voxels in world dimensions.
         /// @note  Value must be positive.
         float resolution;
@@ -237,15 +515,44 @@ struct Grid
         /// @note  It is set by the setDimensions method.
         Eigen::Vector3f p2i_scale;
 
+        /// @brief If true, VoxelGrids store their data in a `SparseVector` which only allocates the
+        ///        blocks of voxels that are updated. Otherwise a dense `std::vector` is used.
+        bool sparse;
+
+        /// @brief Edge length, in voxels, of the cubic bricks the data vector is ordered by. Within a
+        ///        brick voxels are X-major and bricks themselves are X-major in the Grid. A value of
+        ///        one is the plain X-major linear order.
+        /// @note  Bricks keep voxels which are close in all three directions close in memory. This
+        ///        reduces cache and TLB misses for rays travelling along Y or Z and for the 6-neighbor
+        ///        stencil of `data::Binary::updateOccplanes`.
+        /// @note  Must be a power of two, no more than `max_brick_size`. Bricks at the upper edges of
+        ///        the Grid are truncated, so the data vector still has exactly `getNumVoxels` elements.
+        size_t brick_size;
+
+        /// @brief If not empty, VoxelGrids store their data in a `MappedVector` backed by a file in
+        ///        this directory, rather than on the heap. This allows Grids larger than the RAM.
+        /// @note  Sparse storage takes precedence if both are requested.
+        std::string mmap_dir;
+
+        /// @brief Returns true if VoxelGrids store their data in memory-mapped files.
+        bool isMapped() const
+        {
+            return !this->sparse && !this->mmap_dir.empty();
+        }
+
         static const std::string parse_nx, parse_ny, parse_nz;
 
-        static const std::string parse_resolution;
+        static const std::string parse_resolution, parse_sparse, parse_brick_size, parse_mmap;
 
         static const float default_resolution;
-        static const size_t default_size;
+        static const size_t default_size, default_brick_size, max_brick_size;
 
         static const std::string help_string, default_arguments;
 
+        /// @brief Edge length of the chunks, as a power of two. A chunk of 16^3 voxels holds as many
+        ///        voxels as a block of a `Bitset`'s dirty index, and whole bricks of any brick size.
+        static constexpr size_t chunk_bits = 4;
+
     private:
         /// @brief Ensures there is at least one voxel in each direction.
         void checkMinimumGridSize()
@@ -254,13 +561,47 @@ struct Grid
         }
 
 
+        /// @brief Rounds the brick size down to a power of two in the range [1, `max_brick_size`] and
+        ///        sets the shift and mask used to find each voxel's brick.
+        void checkBrickSize()
+        {
+            this->brick_size = std::clamp(this->brick_size, static_cast<size_t>(1), Properties::max_brick_size);
+            this->brick_bits = 0;
+            while ((static_cast<size_t>(1) << (this->brick_bits + 1)) <= this->brick_size)
+            {
+                ++this->brick_bits;
+            }
+            this->brick_size = static_cast<size_t>(1) << this->brick_bits;
+            this->brick_mask = this->brick_size - 1;
+        }
+
+
         /// @brief Retrieves the vector Index for the given X, Y, Z Index in the Grid.
         /// @param voxel Index for the desired voxel.
         /// @return Vector position for the desired voxel.
         /// @note This does not check that the input voxel's Index is valid.
         size_t indexToVector(const Index& voxel) const
         {
-            return voxel[0] + (voxel[1] * this->size[0]) + (voxel[2] * this->size[0] * this->size[1]);
+            if (this->isLinear())
+            {
+                return voxel[0] + (voxel[1] * this->size[0]) + (voxel[2] * this->size[0] * this->size[1]);
+            }
+
+            // Position of the brick's first voxel in each direction.
+            const size_t x0 = voxel[0] & ~this->brick_mask;
+            const size_t y0 = voxel[1] & ~this->brick_mask;
+            const size_t z0 = voxel[2] & ~this->brick_mask;
+
+            // Size of the brick, which is truncated at the upper edges of the Grid.
+            const size_t wx = std::min(this->brick_size, this->size[0] - x0);
+            const size_t wy = std::min(this->brick_size, this->size[1] - y0);
+            const size_t wz = std::min(this->brick_size, this->size[2] - z0);
+
+            // Skip every voxel in the full layers of bricks below this one, then the full rows of
+            // bricks before it in this layer, then the bricks before it in this row.
+            const size_t brick_start = (z0 * this->size[0] * this->size[1]) + (y0 * this->size[0] * wz) + (x0 * wy * wz);
+
+            return brick_start + (voxel[0] - x0) + wx * ((voxel[1] - y0) + wy * (voxel[2] - z0));
         }
 
 
@@ -276,6 +617,13 @@ struct Grid
             }
             throw VoxelOutOfRange(this->size, voxel);
         }
+
+
+        /// @brief Number of bits to shift a voxel Index by to find its brick. Set by `checkBrickSize`.
+        size_t brick_bits = 0;
+
+        /// @brief Mask for a voxel Index's position within its brick. Set by `checkBrickSize`.
+        size_t brick_mask = 0;
     };
 
 
@@ -318,7 +666,10 @@ std::ostream& operator<<(std::ostream &out, const Grid::Properties& properties)
 {
     out << "grid properties with size of (" << properties.size.transpose() <<
            ") voxels with resolution of " << properties.resolution <<
-           " for a bounded area of (" << properties.dimensions.transpose() << ")";
+           " for a bounded area of (" << properties.dimensions.transpose() << ")" <<
+           (properties.sparse ? " using sparse storage" : "") <<
+           (properties.isMapped() ? " using storage mapped in " + properties.mmap_dir : "") <<
+           (properties.isLinear() ? "" : " in bricks of " + std::to_string(properties.brick_size) + "^3 voxels");
     return out;
 }
 
@@ -331,25 +682,44 @@ const std::string Grid::Properties::parse_nx = std::string("--nx"),
 /// @brief ArgParser key for the resolution of the voxels.
 const std::string Grid::Properties::parse_resolution = std::string("--resolution");
 
+/// @brief ArgParser flag for using sparse VoxelGrid storage.
+const std::string Grid::Properties::parse_sparse = std::string("--sparse");
+
+/// @brief ArgParser key for the edge length of the bricks the data vector is ordered by.
+const std::string Grid::Properties::parse_brick_size = std::string("--brick-size");
+
+/// @brief ArgParser key for the directory to create memory-mapped VoxelGrid storage in.
+const std::string Grid::Properties::parse_mmap = std::string("--mmap");
+
 /// @brief Default resolution value.
 const float  Grid::Properties::default_resolution = 0.02;
 
 /// @brief Default size value (for each dimension).
 const size_t Grid::Properties::default_size       = 101;
 
+/// @brief Default brick size value, which is the X-major linear order.
+const size_t Grid::Properties::default_brick_size = 1;
+
+/// @brief Largest supported brick size value.
+const size_t Grid::Properties::max_brick_size     = 16;
+
 /// @brief String explaining what arguments this class accepts.
 const std::string Grid::Properties::help_string =
     "[" + Properties::parse_resolution + " <dimension of a voxel>]" +
     " [" + Properties::parse_nx + " <number voxel in X>]" +
     " [" + Properties::parse_ny + " <number voxel in Y>]" +
-    " [" + Properties::parse_nz + " <number voxel in Z>]";
+    " [" + Properties::parse_nz + " <number voxel in Z>]" +
+    " [" + Properties::parse_sparse + "]" +
+    " [" + Properties::parse_brick_size + " <voxels per brick edge: 1, 2, 4, 8 or 16>]" +
+    " [" + Properties::parse_mmap + " <directory for memory-mapped storage>]";
 
 /// @brief String explaining what this class's default parsed values are.
 const std::string Grid::Properties::default_arguments =
     Properties::parse_resolution + " " + std::to_string(Properties::default_resolution) +
     " " + Properties::parse_nx + " " + std::to_string(Properties::default_size) +
     " " + Properties::parse_ny + " " + std::to_string(Properties::default_size) +
-    " " + Properties::parse_nz + " " + std::to_string(Properties::default_size);
+    " " + Properties::parse_nz + " " + std::to_string(Properties::default_size) +
+    " " + Properties::parse_brick_size + " " + std::to_string(Properties::default_brick_size);
 
 
 } // forge_scan
@@ -0,0 +1,364 @@
+#ifndef FORGE_SCAN_COMMON_MAPPED_VECTOR_HPP
+#define FORGE_SCAN_COMMON_MAPPED_VECTOR_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #define FORGE_SCAN_HAS_MMAP
+#endif
+
+
+namespace forge_scan {
+
+
+/// @brief A fixed-size alternative to a `std::vector` for the voxel data of a Grid, stored in a
+///        memory-mapped file rather than on the heap.
+/// @details The file is created in a chosen directory and unlinked immediately, so it has no name
+///          and is removed by the OS when the MappedVector is destroyed, even after a crash. Pages
+///          are read from and written back to the file by the OS as they are used. A Grid may then
+///          be larger than the available RAM, with only the voxels rays recently touched resident.
+/// @note  Voxels are addressed by the same vector index as a dense `std::vector`. See
+///        `Grid::Properties::at`.
+/// @note  The directory should be on a fast local disk. If it is on a `tmpfs` mount, such as
+///        `/dev/shm`, the data is in RAM but still off the heap, and is put on transparent huge
+///        pages where the kernel allows it.
+/// @note  Only available on POSIX systems. Elsewhere constructing a non-empty MappedVector throws.
+template <typename T>
+class MappedVector
+{
+    static_assert(std::is_trivially_copyable<T>::value, "MappedVector only stores trivially copyable types.");
+
+public:
+    using value_type     = T;
+    using iterator       = T*;
+    using const_iterator = const T*;
+
+    /// @brief Expected pattern of access, passed to the OS as a hint. See `advise`.
+    enum class Access
+    {
+        NORMAL,
+        SEQUENTIAL,
+        RANDOM
+    };
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Creates an empty MappedVector with no file.
+    MappedVector() = default;
+
+
+    /// @brief Creates a MappedVector backed by a new file.
+    /// @param n Number of elements.
+    /// @param value Initial value of every element.
+    /// @param directory Directory to create the file in.
+    /// @throws std::system_error If the file cannot be created, sized, or mapped.
+    /// @throws std::runtime_error If memory-mapped storage is not available on this platform.
+    MappedVector(const size_t& n, const T& value, const std::filesystem::path& directory)
+        : directory(directory)
+    {
+        this->map(n);
+
+        // A new file reads as zeros, so filling is only needed for a non-zero value. Skipping it
+        // leaves the pages unallocated until they are first written.
+        static const T zero{};
+        if (std::memcmp(&value, &zero, sizeof(T)) != 0)
+        {
+            this->advise(Access::SEQUENTIAL);
+            std::fill_n(this->ptr, this->n, value);
+            this->advise(Access::NORMAL);
+        }
+    }
+
+
+    /// @brief Copies the data into a new file in the same directory.
+    MappedVector(const MappedVector& other)
+        : directory(other.directory)
+    {
+        this->map(other.n);
+        if (this->n > 0)
+        {
+            other.advise(Access::SEQUENTIAL);
+            std::memcpy(this->ptr, other.ptr, this->n * sizeof(T));
+            other.advise(Access::NORMAL);
+        }
+    }
+
+
+    MappedVector(MappedVector&& other) noexcept
+        : directory(std::move(other.directory)),
+          ptr(std::exchange(other.ptr, nullptr)),
+          n(std::exchange(other.n, 0))
+    {
+
+    }
+
+
+    MappedVector& operator=(const MappedVector& other)
+    {
+        if (this != &other)
+        {
+            *this = MappedVector(other);
+        }
+        return *this;
+    }
+
+
+    MappedVector& operator=(MappedVector&& other) noexcept
+    {
+        if (this != &other)
+        {
+            this->unmap();
+            this->directory = std::move(other.directory);
+            this->ptr = std::exchange(other.ptr, nullptr);
+            this->n   = std::exchange(other.n, 0);
+        }
+        return *this;
+    }
+
+
+    ~MappedVector()
+    {
+        this->unmap();
+    }
+
+
+    /// @brief Number of elements.
+    size_t size() const
+    {
+        return this->n;
+    }
+
+
+    /// @brief True if there are no elements.
+    bool empty() const
+    {
+        return this->n == 0;
+    }
+
+
+    /// @brief Pointer to the mapped elements. Null if empty.
+    T* data()
+    {
+        return this->ptr;
+    }
+
+
+    /// @brief Pointer to the mapped elements. Null if empty.
+    const T* data() const
+    {
+        return this->ptr;
+    }
+
+
+    /// @brief Access to an element.
+    /// @param i Vector index for the voxel. See `Grid::Properties::at`.
+    T& operator[](const size_t& i)
+    {
+        return this->ptr[i];
+    }
+
+
+    /// @brief Read-only access to an element.
+    /// @param i Vector index for the voxel. See `Grid::Properties::at`.
+    const T& operator[](const size_t& i) const
+    {
+        return this->ptr[i];
+    }
+
+
+    iterator begin() { return this->ptr; }
+    iterator end()   { return this->ptr + this->n; }
+
+    const_iterator begin() const { return this->ptr; }
+    const_iterator end()   const { return this->ptr + this->n; }
+
+
+    /// @brief Directory the file was created in.
+    const std::filesystem::path& getDirectory() const
+    {
+        return this->directory;
+    }
+
+
+    /// @brief Tells the OS how the elements are about to be accessed.
+    /// @param access `SEQUENTIAL` before sweeping the whole vector in order, so pages are read ahead
+    ///               and released behind. `RANDOM` disables read ahead. `NORMAL` restores the default.
+    /// @note  This is only a hint and has no effect on the values.
+    void advise([[maybe_unused]] const Access& access) const
+    {
+#ifdef FORGE_SCAN_HAS_MMAP
+        if (this->ptr == nullptr)
+        {
+            return;
+        }
+        const int advice = access == Access::SEQUENTIAL ? MADV_SEQUENTIAL :
+                           access == Access::RANDOM     ? MADV_RANDOM     : MADV_NORMAL;
+        ::madvise(static_cast<void*>(this->ptr), this->n * sizeof(T), advice);
+#endif
+    }
+
+
+    /// @brief Creates the equivalent dense vector.
+    /// @return Vector of `size()` elements.
+    std::vector<T> toDense() const
+    {
+        this->advise(Access::SEQUENTIAL);
+        std::vector<T> dense(this->begin(), this->end());
+        this->advise(Access::NORMAL);
+        return dense;
+    }
+
+
+    /// @brief Number of bytes mapped.
+    size_t sizeBytes() const
+    {
+        return this->n * sizeof(T);
+    }
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Creates, sizes, and maps a new, unlinked file in the directory.
+    /// @param n_elements Number of elements to map. If zero nothing is created.
+    void map(const size_t& n_elements)
+    {
+        if (n_elements == 0)
+        {
+            return;
+        }
+#ifdef FORGE_SCAN_HAS_MMAP
+        std::string name = (this->directory / "forge_scan_XXXXXX").string();
+        const int fd = ::mkstemp(name.data());
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "Could not create a file for mapped storage in " + this->directory.string());
+        }
+        ::unlink(name.c_str());
+
+        const size_t n_bytes = n_elements * sizeof(T);
+        if (::ftruncate(fd, static_cast<off_t>(n_bytes)) != 0)
+        {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "Could not size the file for mapped storage");
+        }
+
+        void* region = ::mmap(nullptr, n_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);
+        if (region == MAP_FAILED)
+        {
+            throw std::system_error(error, std::generic_category(), "Could not map the file for mapped storage");
+        }
+    #ifdef MADV_HUGEPAGE
+        // Only honored for tmpfs and shmem backed files. Ignored, and harmless, elsewhere.
+        ::madvise(region, n_bytes, MADV_HUGEPAGE);
+    #endif
+        this->ptr = static_cast<T*>(region);
+        this->n   = n_elements;
+#else
+        throw std::runtime_error("Memory-mapped VoxelGrid storage is not supported on this platform.");
+#endif
+    }
+
+
+    /// @brief Unmaps the file, which removes it as it has already been unlinked.
+    void unmap()
+    {
+#ifdef FORGE_SCAN_HAS_MMAP
+        if (this->ptr != nullptr)
+        {
+            ::munmap(static_cast<void*>(this->ptr), this->n * sizeof(T));
+        }
+#endif
+        this->ptr = nullptr;
+        this->n   = 0;
+    }
+
+
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Directory the file was created in. Copies are made in the same directory.
+    std::filesystem::path directory;
+
+    /// @brief Start of the mapped region.
+    T* ptr = nullptr;
+
+    /// @brief Number of elements.
+    size_t n = 0;
+};
+
+
+/// @brief Calls a function on each value of a mapped vector. See `SparseVector::forEachValue`.
+/// @param vector Vector to visit.
+/// @param f Callable with the signature `void(T& value, const size_t& count)`. The count is always one.
+/// @note  The OS is told the vector will be read sequentially for the length of the sweep.
+template <typename T, typename Function>
+inline void for_each_value(MappedVector<T>& vector, Function&& f)
+{
+    vector.advise(MappedVector<T>::Access::SEQUENTIAL);
+    for (auto& value : vector)
+    {
+        f(value, 1);
+    }
+    vector.advise(MappedVector<T>::Access::NORMAL);
+}
+
+
+namespace utilities {
+namespace memory_use {
+
+
+/// @brief Finds the memory usage of a MappedVector.
+/// @param vec MappedVector of any type.
+/// @return The number of bytes mapped. Only some of these may be resident in RAM at once.
+template<typename T>
+inline size_t vector_size(const MappedVector<T>& vec)
+{
+    return vec.sizeBytes();
+}
+
+
+/// @brief Finds the memory usage of a MappedVector.
+/// @param vec MappedVector of any type.
+/// @return The number of bytes mapped. A MappedVector has no spare capacity.
+template<typename T>
+inline size_t vector_capacity(const MappedVector<T>& vec)
+{
+    return vec.sizeBytes();
+}
+
+
+} // namespace memory_use
+} // namespace utilities
+
+
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_COMMON_MAPPED_VECTOR_HPP
@@ -0,0 +1,333 @@
+#ifndef FORGE_SCAN_COMMON_MARCHING_CUBES_HPP
+#define FORGE_SCAN_COMMON_MARCHING_CUBES_HPP
+
+#include <cstdint>
+
+
+namespace forge_scan {
+
+
+/// @details Lookup tables and helpers for extracting a surface from the cells of a Grid, where each
+///          cell is the cube between eight neighbouring voxels. See `data::SurfaceMesh`.
+/// @note  Corners of a cell are numbered with bit 0 along X, then around the lower face, then the
+///        same for the upper face in Z. Edges 0 to 3 are the lower face, 4 to 7 the upper face, and
+///        8 to 11 join them. This is the usual numbering for marching cubes.
+namespace marching_cubes {
+
+
+/// @brief Offset of each corner of a cell from its lowest corner.
+static constexpr uint8_t corner_offsets[8][3] = {
+    {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+    {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}
+};
+
+
+/// @brief The two corners each edge of a cell joins. The first is always the lower along the edge.
+static constexpr uint8_t edge_corners[12][2] = {
+    {0, 1}, {1, 2}, {3, 2}, {0, 3},
+    {4, 5}, {5, 6}, {7, 6}, {4, 7},
+    {0, 4}, {1, 5}, {2, 6}, {3, 7}
+};
+
+
+/// @brief Axis along which each edge of a cell runs. 0, 1 or 2 for X, Y or Z.
+static constexpr uint8_t edge_axis[12] = {0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2};
+
+
+/// @brief Edges of the triangles for each case of a cell, three at a time and ended by -1.
+/// @details The case has bit `c` set when corner `c` is below the iso-value. Each face where the
+///          four corners alternate is cut so the corners below the iso-value are apart, and the
+///          same choice is made by both cells sharing the face, so the surface has no holes.
+///          Triangles wind counter-clockwise seen from above the iso-value.
+static constexpr int8_t triangle_table[256][16] = {
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  9,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  1,  3,  8,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 1, 10,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  1, 10,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 0, 10,  2,  0,  9, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3, 10,  2,  3,  9, 10,  3,  8,  9, -1, -1, -1, -1, -1, -1, -1},
+    { 2, 11,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  8,  0,  2, 11,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 2, 11,  3,  0,  9,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  9,  1,  2,  8,  9,  2, 11,  8, -1, -1, -1, -1, -1, -1, -1},
+    { 1, 11,  3,  1, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  8,  0,  1, 11,  8,  1, 10, 11, -1, -1, -1, -1, -1, -1, -1},
+    { 0, 11,  3,  0, 10, 11,  0,  9, 10, -1, -1, -1, -1, -1, -1, -1},
+    { 9, 11,  8,  9, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 4,  8,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  4,  0,  3,  7,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  9,  1,  4,  8,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  1,  3,  4,  9,  3,  7,  4, -1, -1, -1, -1, -1, -1, -1},
+    { 1, 10,  2,  4,  8,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  4,  0,  3,  7,  4,  1, 10,  2, -1, -1, -1, -1, -1, -1, -1},
+    { 0, 10,  2,  0,  9, 10,  4,  8,  7, -1, -1, -1, -1, -1, -1, -1},
+    { 3, 10,  2,  3,  9, 10,  3,  4,  9,  3,  7,  4, -1, -1, -1, -1},
+    { 2, 11,  3,  4,  8,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  4,  0,  2,  7,  4,  2, 11,  7, -1, -1, -1, -1, -1, -1, -1},
+    { 2, 11,  3,  0,  9,  1,  4,  8,  7, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  9,  1,  2,  4,  9,  2,  7,  4,  2, 11,  7, -1, -1, -1, -1},
+    { 1, 11,  3,  1, 10, 11,  4,  8,  7, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  4,  0,  1,  7,  4,  1, 11,  7,  1, 10, 11, -1, -1, -1, -1},
+    { 0, 11,  3,  0, 10, 11,  0,  9, 10,  4,  8,  7, -1, -1, -1, -1},
+    { 4, 11,  7,  4, 10, 11,  4,  9, 10, -1, -1, -1, -1, -1, -1, -1},
+    { 5,  9,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  5,  9,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  5,  1,  0,  4,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  5,  1,  3,  4,  5,  3,  8,  4, -1, -1, -1, -1, -1, -1, -1},
+    { 1, 10,  2,  5,  9,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  1, 10,  2,  5,  9,  4, -1, -1, -1, -1, -1, -1, -1},
+    { 0, 10,  2,  0,  5, 10,  0,  4,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 3, 10,  2,  3,  5, 10,  3,  4,  5,  3,  8,  4, -1, -1, -1, -1},
+    { 2, 11,  3,  5,  9,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  8,  0,  2, 11,  8,  5,  9,  4, -1, -1, -1, -1, -1, -1, -1},
+    { 2, 11,  3,  0,  5,  1,  0,  4,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  5,  1,  2,  4,  5,  2,  8,  4,  2, 11,  8, -1, -1, -1, -1},
+    { 1, 11,  3,  1, 10, 11,  5,  9,  4, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  8,  0,  1, 11,  8,  1, 10, 11,  5,  9,  4, -1, -1, -1, -1},
+    { 0, 11,  3,  0, 10, 11,  0,  5, 10,  0,  4,  5, -1, -1, -1, -1},
+    { 5,  8,  4,  5, 11,  8,  5, 10, 11, -1, -1, -1, -1, -1, -1, -1},
+    { 5,  8,  7,  5,  9,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  0,  3,  5,  9,  3,  7,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  5,  1,  0,  7,  5,  0,  8,  7, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  5,  1,  3,  7,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 1, 10,  2,  5,  8,  7,  5,  9,  8, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  0,  3,  5,  9,  3,  7,  5,  1, 10,  2, -1, -1, -1, -1},
+    { 0, 10,  2,  0,  5, 10,  0,  7,  5,  0,  8,  7, -1, -1, -1, -1},
+    { 3, 10,  2,  3,  5, 10,  3,  7,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 2, 11,  3,  5,  8,  7,  5,  9,  8, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  9,  0,  2,  5,  9,  2,  7,  5,  2, 11,  7, -1, -1, -1, -1},
+    { 2, 11,  3,  0,  5,  1,  0,  7,  5,  0,  8,  7, -1, -1, -1, -1},
+    { 2,  5,  1,  2,  7,  5,  2, 11,  7, -1, -1, -1, -1, -1, -1, -1},
+    { 1, 11,  3,  1, 10, 11,  5,  8,  7,  5,  9,  8, -1, -1, -1, -1},
+    { 0,  5,  9,  0,  7,  5,  0, 11,  7,  0, 10, 11,  0,  1, 10, -1},
+    { 0, 11,  3,  0, 10, 11,  0,  5, 10,  0,  7,  5,  0,  8,  7, -1},
+    { 5, 11,  7,  5, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 6, 10,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  6, 10,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  9,  1,  6, 10,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  1,  3,  8,  9,  6, 10,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  6,  2,  1,  5,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  1,  6,  2,  1,  5,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  6,  2,  0,  5,  6,  0,  9,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  6,  2,  3,  5,  6,  3,  9,  5,  3,  8,  9, -1, -1, -1, -1},
+    { 2, 11,  3,  6, 10,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  8,  0,  2, 11,  8,  6, 10,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 2, 11,  3,  0,  9,  1,  6, 10,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  9,  1,  2,  8,  9,  2, 11,  8,  6, 10,  5, -1, -1, -1, -1},
+    { 1, 11,  3,  1,  6, 11,  1,  5,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  8,  0,  1, 11,  8,  1,  6, 11,  1,  5,  6, -1, -1, -1, -1},
+    { 0, 11,  3,  0,  6, 11,  0,  5,  6,  0,  9,  5, -1, -1, -1, -1},
+    { 6,  9,  5,  6,  8,  9,  6, 11,  8, -1, -1, -1, -1, -1, -1, -1},
+    { 4,  8,  7,  6, 10,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  4,  0,  3,  7,  4,  6, 10,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  9,  1,  4,  8,  7,  6, 10,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  1,  3,  4,  9,  3,  7,  4,  6, 10,  5, -1, -1, -1, -1},
+    { 1,  6,  2,  1,  5,  6,  4,  8,  7, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  4,  0,  3,  7,  4,  1,  6,  2,  1,  5,  6, -1, -1, -1, -1},
+    { 0,  6,  2,  0,  5,  6,  0,  9,  5,  4,  8,  7, -1, -1, -1, -1},
+    { 3,  6,  2,  3,  5,  6,  3,  9,  5,  3,  4,  9,  3,  7,  4, -1},
+    { 2, 11,  3,  4,  8,  7,  6, 10,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  4,  0,  2,  7,  4,  2, 11,  7,  6, 10,  5, -1, -1, -1, -1},
+    { 2, 11,  3,  0,  9,  1,  4,  8,  7,  6, 10,  5, -1, -1, -1, -1},
+    { 2,  9,  1,  2,  4,  9,  2,  7,  4,  2, 11,  7,  6, 10,  5, -1},
+    { 1, 11,  3,  1,  6, 11,  1,  5,  6,  4,  8,  7, -1, -1, -1, -1},
+    { 1,  4,  0,  1,  7,  4,  1, 11,  7,  1,  6, 11,  1,  5,  6, -1},
+    { 0, 11,  3,  0,  6, 11,  0,  5,  6,  0,  9,  5,  4,  8,  7, -1},
+    {11,  5,  6, 11,  9,  5, 11,  4,  9, 11,  7,  4, -1, -1, -1, -1},
+    { 6,  9,  4,  6, 10,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  6,  9,  4,  6, 10,  9, -1, -1, -1, -1, -1, -1, -1},
+    { 0, 10,  1,  0,  6, 10,  0,  4,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 3, 10,  1,  3,  6, 10,  3,  4,  6,  3,  8,  4, -1, -1, -1, -1},
+    { 1,  6,  2,  1,  4,  6,  1,  9,  4, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  1,  6,  2,  1,  4,  6,  1,  9,  4, -1, -1, -1, -1},
+    { 0,  6,  2,  0,  4,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  6,  2,  3,  4,  6,  3,  8,  4, -1, -1, -1, -1, -1, -1, -1},
+    { 2, 11,  3,  6,  9,  4,  6, 10,  9, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  8,  0,  2, 11,  8,  6,  9,  4,  6, 10,  9, -1, -1, -1, -1},
+    { 2, 11,  3,  0, 10,  1,  0,  6, 10,  0,  4,  6, -1, -1, -1, -1},
+    { 1,  6, 10,  1,  4,  6,  1,  8,  4,  1, 11,  8,  1,  2, 11, -1},
+    { 1, 11,  3,  1,  6, 11,  1,  4,  6,  1,  9,  4, -1, -1, -1, -1},
+    { 1,  8,  0,  1, 11,  8,  1,  6, 11,  1,  4,  6,  1,  9,  4, -1},
+    { 0, 11,  3,  0,  6, 11,  0,  4,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 6,  8,  4,  6, 11,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 6,  8,  7,  6,  9,  8,  6, 10,  9, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  0,  3, 10,  9,  3,  6, 10,  3,  7,  6, -1, -1, -1, -1},
+    { 0, 10,  1,  0,  6, 10,  0,  7,  6,  0,  8,  7, -1, -1, -1, -1},
+    { 3, 10,  1,  3,  6, 10,  3,  7,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  6,  2,  1,  7,  6,  1,  8,  7,  1,  9,  8, -1, -1, -1, -1},
+    { 9,  2,  1,  9,  6,  2,  9,  7,  6,  9,  3,  7,  9,  0,  3, -1},
+    { 0,  6,  2,  0,  7,  6,  0,  8,  7, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  6,  2,  3,  7,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 2, 11,  3,  6,  8,  7,  6,  9,  8,  6, 10,  9, -1, -1, -1, -1},
+    { 0, 10,  9,  0,  6, 10,  0,  7,  6,  0, 11,  7,  0,  2, 11, -1},
+    { 2, 11,  3,  0, 10,  1,  0,  6, 10,  0,  7,  6,  0,  8,  7, -1},
+    { 1,  6, 10,  1,  7,  6,  1, 11,  7,  1,  2, 11, -1, -1, -1, -1},
+    { 1, 11,  3,  1,  6, 11,  1,  7,  6,  1,  8,  7,  1,  9,  8, -1},
+    { 1,  9,  0,  6, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 0, 11,  3,  0,  6, 11,  0,  7,  6,  0,  8,  7, -1, -1, -1, -1},
+    { 6, 11,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 7, 11,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  7, 11,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  9,  1,  7, 11,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  1,  3,  8,  9,  7, 11,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 1, 10,  2,  7, 11,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  1, 10,  2,  7, 11,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 0, 10,  2,  0,  9, 10,  7, 11,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 3, 10,  2,  3,  9, 10,  3,  8,  9,  7, 11,  6, -1, -1, -1, -1},
+    { 2,  7,  3,  2,  6,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  8,  0,  2,  7,  8,  2,  6,  7, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  7,  3,  2,  6,  7,  0,  9,  1, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  9,  1,  2,  8,  9,  2,  7,  8,  2,  6,  7, -1, -1, -1, -1},
+    { 1,  7,  3,  1,  6,  7,  1, 10,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  8,  0,  1,  7,  8,  1,  6,  7,  1, 10,  6, -1, -1, -1, -1},
+    { 0,  7,  3,  0,  6,  7,  0, 10,  6,  0,  9, 10, -1, -1, -1, -1},
+    { 7, 10,  6,  7,  9, 10,  7,  8,  9, -1, -1, -1, -1, -1, -1, -1},
+    { 4, 11,  6,  4,  8, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  4,  0,  3,  6,  4,  3, 11,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  9,  1,  4, 11,  6,  4,  8, 11, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  1,  3,  4,  9,  3,  6,  4,  3, 11,  6, -1, -1, -1, -1},
+    { 1, 10,  2,  4, 11,  6,  4,  8, 11, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  4,  0,  3,  6,  4,  3, 11,  6,  1, 10,  2, -1, -1, -1, -1},
+    { 0, 10,  2,  0,  9, 10,  4, 11,  6,  4,  8, 11, -1, -1, -1, -1},
+    { 3, 10,  2,  3,  9, 10,  3,  4,  9,  3,  6,  4,  3, 11,  6, -1},
+    { 2,  8,  3,  2,  4,  8,  2,  6,  4, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  4,  0,  2,  6,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  8,  3,  2,  4,  8,  2,  6,  4,  0,  9,  1, -1, -1, -1, -1},
+    { 2,  9,  1,  2,  4,  9,  2,  6,  4, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  8,  3,  1,  4,  8,  1,  6,  4,  1, 10,  6, -1, -1, -1, -1},
+    { 1,  4,  0,  1,  6,  4,  1, 10,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  4,  8,  3,  6,  4,  3, 10,  6,  3,  9, 10,  3,  0,  9, -1},
+    { 4, 10,  6,  4,  9, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 5,  9,  4,  7, 11,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  5,  9,  4,  7, 11,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  5,  1,  0,  4,  5,  7, 11,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  5,  1,  3,  4,  5,  3,  8,  4,  7, 11,  6, -1, -1, -1, -1},
+    { 1, 10,  2,  5,  9,  4,  7, 11,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  1, 10,  2,  5,  9,  4,  7, 11,  6, -1, -1, -1, -1},
+    { 0, 10,  2,  0,  5, 10,  0,  4,  5,  7, 11,  6, -1, -1, -1, -1},
+    { 3, 10,  2,  3,  5, 10,  3,  4,  5,  3,  8,  4,  7, 11,  6, -1},
+    { 2,  7,  3,  2,  6,  7,  5,  9,  4, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  8,  0,  2,  7,  8,  2,  6,  7,  5,  9,  4, -1, -1, -1, -1},
+    { 2,  7,  3,  2,  6,  7,  0,  5,  1,  0,  4,  5, -1, -1, -1, -1},
+    { 2,  5,  1,  2,  4,  5,  2,  8,  4,  2,  7,  8,  2,  6,  7, -1},
+    { 1,  7,  3,  1,  6,  7,  1, 10,  6,  5,  9,  4, -1, -1, -1, -1},
+    { 1,  8,  0,  1,  7,  8,  1,  6,  7,  1, 10,  6,  5,  9,  4, -1},
+    { 0,  7,  3,  0,  6,  7,  0, 10,  6,  0,  5, 10,  0,  4,  5, -1},
+    { 8,  6,  7,  8, 10,  6,  8,  5, 10,  8,  4,  5, -1, -1, -1, -1},
+    { 5, 11,  6,  5,  8, 11,  5,  9,  8, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  0,  3,  5,  9,  3,  6,  5,  3, 11,  6, -1, -1, -1, -1},
+    { 0,  5,  1,  0,  6,  5,  0, 11,  6,  0,  8, 11, -1, -1, -1, -1},
+    { 3,  5,  1,  3,  6,  5,  3, 11,  6, -1, -1, -1, -1, -1, -1, -1},
+    { 1, 10,  2,  5, 11,  6,  5,  8, 11,  5,  9,  8, -1, -1, -1, -1},
+    { 3,  9,  0,  3,  5,  9,  3,  6,  5,  3, 11,  6,  1, 10,  2, -1},
+    { 0, 10,  2,  0,  5, 10,  0,  6,  5,  0, 11,  6,  0,  8, 11, -1},
+    { 3, 10,  2,  3,  5, 10,  3,  6,  5,  3, 11,  6, -1, -1, -1, -1},
+    { 2,  8,  3,  2,  9,  8,  2,  5,  9,  2,  6,  5, -1, -1, -1, -1},
+    { 2,  9,  0,  2,  5,  9,  2,  6,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 8,  1,  0,  8,  5,  1,  8,  6,  5,  8,  2,  6,  8,  3,  2, -1},
+    { 2,  5,  1,  2,  6,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  8,  3,  5,  9,  3,  6,  5,  3, 10,  6,  3,  1, 10, -1},
+    { 0,  5,  9,  0,  6,  5,  0, 10,  6,  0,  1, 10, -1, -1, -1, -1},
+    { 0,  8,  3,  5, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 5, 10,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 7, 10,  5,  7, 11, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  7, 10,  5,  7, 11, 10, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  9,  1,  7, 10,  5,  7, 11, 10, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  1,  3,  8,  9,  7, 10,  5,  7, 11, 10, -1, -1, -1, -1},
+    { 1, 11,  2,  1,  7, 11,  1,  5,  7, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  1, 11,  2,  1,  7, 11,  1,  5,  7, -1, -1, -1, -1},
+    { 0, 11,  2,  0,  7, 11,  0,  5,  7,  0,  9,  5, -1, -1, -1, -1},
+    { 2,  7, 11,  2,  5,  7,  2,  9,  5,  2,  8,  9,  2,  3,  8, -1},
+    { 2,  7,  3,  2,  5,  7,  2, 10,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  8,  0,  2,  7,  8,  2,  5,  7,  2, 10,  5, -1, -1, -1, -1},
+    { 2,  7,  3,  2,  5,  7,  2, 10,  5,  0,  9,  1, -1, -1, -1, -1},
+    { 2,  9,  1,  2,  8,  9,  2,  7,  8,  2,  5,  7,  2, 10,  5, -1},
+    { 1,  7,  3,  1,  5,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  8,  0,  1,  7,  8,  1,  5,  7, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  7,  3,  0,  5,  7,  0,  9,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 7,  9,  5,  7,  8,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 4, 10,  5,  4, 11, 10,  4,  8, 11, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  4,  0,  3,  5,  4,  3, 10,  5,  3, 11, 10, -1, -1, -1, -1},
+    { 0,  9,  1,  4, 10,  5,  4, 11, 10,  4,  8, 11, -1, -1, -1, -1},
+    { 3,  9,  1,  3,  4,  9,  3,  5,  4,  3, 10,  5,  3, 11, 10, -1},
+    { 1, 11,  2,  1,  8, 11,  1,  4,  8,  1,  5,  4, -1, -1, -1, -1},
+    { 4,  1,  5,  4,  2,  1,  4, 11,  2,  4,  3, 11,  4,  0,  3, -1},
+    { 2,  8, 11,  2,  4,  8,  2,  5,  4,  2,  9,  5,  2,  0,  9, -1},
+    { 3, 11,  2,  4,  9,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  8,  3,  2,  4,  8,  2,  5,  4,  2, 10,  5, -1, -1, -1, -1},
+    { 2,  4,  0,  2,  5,  4,  2, 10,  5, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  8,  3,  2,  4,  8,  2,  5,  4,  2, 10,  5,  0,  9,  1, -1},
+    { 2,  9,  1,  2,  4,  9,  2,  5,  4,  2, 10,  5, -1, -1, -1, -1},
+    { 1,  8,  3,  1,  4,  8,  1,  5,  4, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  4,  0,  1,  5,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  4,  8,  3,  5,  4,  3,  9,  5,  3,  0,  9, -1, -1, -1, -1},
+    { 4,  9,  5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 7,  9,  4,  7, 10,  9,  7, 11, 10, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  8,  0,  7,  9,  4,  7, 10,  9,  7, 11, 10, -1, -1, -1, -1},
+    { 0, 10,  1,  0, 11, 10,  0,  7, 11,  0,  4,  7, -1, -1, -1, -1},
+    { 1, 11, 10,  1,  7, 11,  1,  4,  7,  1,  8,  4,  1,  3,  8, -1},
+    { 1, 11,  2,  1,  7, 11,  1,  4,  7,  1,  9,  4, -1, -1, -1, -1},
+    { 3,  8,  0,  1, 11,  2,  1,  7, 11,  1,  4,  7,  1,  9,  4, -1},
+    { 0, 11,  2,  0,  7, 11,  0,  4,  7, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  7, 11,  2,  4,  7,  2,  8,  4,  2,  3,  8, -1, -1, -1, -1},
+    { 2,  7,  3,  2,  4,  7,  2,  9,  4,  2, 10,  9, -1, -1, -1, -1},
+    { 2,  8,  0,  2,  7,  8,  2,  4,  7,  2,  9,  4,  2, 10,  9, -1},
+    { 7,  0,  4,  7,  1,  0,  7, 10,  1,  7,  2, 10,  7,  3,  2, -1},
+    { 2, 10,  1,  7,  8,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  7,  3,  1,  4,  7,  1,  9,  4, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  8,  0,  1,  7,  8,  1,  4,  7,  1,  9,  4, -1, -1, -1, -1},
+    { 0,  7,  3,  0,  4,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 7,  8,  4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 8, 10,  9,  8, 11, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3,  9,  0,  3, 10,  9,  3, 11, 10, -1, -1, -1, -1, -1, -1, -1},
+    { 0, 10,  1,  0, 11, 10,  0,  8, 11, -1, -1, -1, -1, -1, -1, -1},
+    { 3, 10,  1,  3, 11, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 1, 11,  2,  1,  8, 11,  1,  9,  8, -1, -1, -1, -1, -1, -1, -1},
+    { 9,  2,  1,  9, 11,  2,  9,  3, 11,  9,  0,  3, -1, -1, -1, -1},
+    { 0, 11,  2,  0,  8, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 3, 11,  2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  8,  3,  2,  9,  8,  2, 10,  9, -1, -1, -1, -1, -1, -1, -1},
+    { 2,  9,  0,  2, 10,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 8,  1,  0,  8, 10,  1,  8,  2, 10,  8,  3,  2, -1, -1, -1, -1},
+    { 2, 10,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  8,  3,  1,  9,  8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 1,  9,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    { 0,  8,  3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}
+};
+
+
+/// @brief Finds the case of a cell.
+/// @param values Value at each corner of the cell.
+/// @param iso Value of the surface.
+/// @return Index into `triangle_table`.
+inline uint8_t get_case(const float* values, const float& iso)
+{
+    uint8_t cell_case = 0;
+    for (uint8_t c = 0; c < 8; ++c)
+    {
+        cell_case |= static_cast<uint8_t>(values[c] < iso) << c;
+    }
+    return cell_case;
+}
+
+
+/// @brief Finds where the surface crosses an edge of a cell.
+/// @param v0 Value at the lower corner of the edge.
+/// @param v1 Value at the upper corner of the edge.
+/// @param iso Value of the surface.
+/// @return Fraction of the edge's length, from the lower corner, at which the surface crosses it.
+inline float get_crossing(const float& v0, const float& v1, const float& iso)
+{
+    const float dv = v1 - v0;
+    return dv != 0 ? (iso - v0) / dv : 0.5f;
+}
+
+
+} // namespace marching_cubes
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_COMMON_MARCHING_CUBES_HPP
@@ -0,0 +1,437 @@
+#ifndef FORGE_SCAN_COMMON_OCCUPANCY_PYRAMID_HPP
+#define FORGE_SCAN_COMMON_OCCUPANCY_PYRAMID_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ForgeScan/Common/Bitset.hpp"
+#include "ForgeScan/Common/Grid.hpp"
+#include "ForgeScan/Common/VoxelData.hpp"
+
+
+namespace forge_scan {
+
+
+/// @brief Coarse summaries of a VoxelGrid's occupancy, at each power of two of resolution.
+/// @details Level `l`, for `l` in `[1, numLevels()]`, divides the Grid into cells of `2^l` voxels
+///          along each axis. Each cell records which VoxelOccupancy types (unknown, free, occupied)
+///          any of its voxels have, and how many of its voxels are not unknown. The last level is a
+///          single cell for the whole Grid. Region-level questions, such as whether anything in a
+///          block is unknown, are then answered from a few cells rather than every voxel.
+/// @note  Voxels which change are marked with `markVoxel`, and `refresh` then recalculates only the
+///        cells which hold them, and their parents. A VoxelGrid which does not track its changes
+///        uses `markAll`, so `refresh` rebuilds every cell.
+/// @note  Regions which are about to change may be held with `hold`, so `uniformLevel` finds no
+///        uniform cell overlapping them until they are released.
+class OccupancyPyramid
+{
+public:
+    /// @brief Summary of the voxels in one cell.
+    struct Cell
+    {
+        /// @brief Bitwise OR of the VoxelOccupancy type of each voxel. See `VoxelOccupancy::MASK_LOWER_BITS`.
+        uint8_t types = 0;
+
+        /// @brief Number of voxels whose type is not unknown.
+        uint32_t n_seen = 0;
+    };
+
+
+    /// @brief VoxelOccupancy type bits which a Cell records.
+    static constexpr uint8_t type_bits = VoxelOccupancy::TYPE_UNKNOWN | VoxelOccupancy::TYPE_FREE |
+                                         VoxelOccupancy::TYPE_OCCUPIED;
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Creates a pyramid for a Grid. Every cell is stale until the first `refresh`.
+    /// @param properties Shared, constant pointer to the `Grid::Properties` to summarize.
+    explicit OccupancyPyramid(const std::shared_ptr<const Grid::Properties>& properties)
+        : properties(properties)
+    {
+        GridSize size = properties->size;
+        do
+        {
+            size = (size.array() + 1) / 2;
+            this->level_size.push_back(size);
+            this->cells.emplace_back(size.prod());
+            this->dirty.emplace_back(size.prod());
+        }
+        while (size.maxCoeff() > 1);
+    }
+
+
+    /// @brief Number of levels, not counting the voxels themselves.
+    size_t numLevels() const
+    {
+        return this->cells.size();
+    }
+
+
+    /// @brief Number of cells along each axis of a level.
+    /// @param level Level in `[1, numLevels()]`.
+    const GridSize& getLevelSize(const size_t& level) const
+    {
+        return this->level_size[level - 1];
+    }
+
+
+    /// @brief Gets a cell.
+    /// @param level Level in `[1, numLevels()]`.
+    /// @param cell Index of the cell in that level.
+    const Cell& at(const size_t& level, const Index& cell) const
+    {
+        return this->cells[level - 1][this->cellToLinear(level, cell)];
+    }
+
+
+    /// @brief Gets the cell which holds a voxel.
+    /// @param level Level in `[1, numLevels()]`.
+    /// @param voxel Index of the voxel.
+    const Cell& atVoxel(const size_t& level, const Index& voxel) const
+    {
+        return this->at(level, voxel.unaryExpr([&level](const size_t& v) { return v >> level; }));
+    }
+
+
+    /// @brief Finds the largest cell holding a voxel whose voxels all have the same type.
+    /// @param voxel Index of the voxel.
+    /// @param type One of the VoxelOccupancy types, such as `VoxelOccupancy::TYPE_FREE`.
+    /// @return The highest level at which the voxel's cell only holds voxels of that type. Zero if
+    ///         even the cell at level one holds another type.
+    /// @note  A ray traversal may step over the whole cell at this level, which is `2^level`
+    ///        voxels wide, knowing every voxel it skips has that type.
+    size_t uniformLevel(const Index& voxel, const uint8_t& type) const
+    {
+        size_t level = 0;
+        while (level < this->numLevels() && this->atVoxel(level + 1, voxel).types == type &&
+               !this->isHeld(level + 1, voxel))
+        {
+            ++level;
+        }
+        return level;
+    }
+
+
+    /// @brief Holds every voxel within a distance of any of a set of voxels. Until `release` is
+    ///        called `uniformLevel` treats their cells as holding every type.
+    /// @param voxels Indices of the voxels. These may be outside of the Grid, for voxels which are
+    ///               near it.
+    /// @param radius Distance, in voxels, around each voxel to hold.
+    /// @note  The holds are made on cells `2^l` voxels wide, for the smallest `l` not less than the
+    ///        radius. This holds more than is required, but costs at most a few cells per voxel.
+    void hold(const std::vector<Eigen::Vector3i>& voxels, const size_t& radius)
+    {
+        this->release();
+        this->hold_level = 1;
+        while ((size_t(1) << this->hold_level) < radius && this->hold_level < this->numLevels())
+        {
+            ++this->hold_level;
+        }
+        this->held.resize(this->numLevels() - this->hold_level + 1);
+        for (size_t level = this->hold_level; level <= this->numLevels(); ++level)
+        {
+            Bitset& held = this->held[level - this->hold_level];
+            if (held.size() != static_cast<size_t>(this->getLevelSize(level).prod()))
+            {
+                held = Bitset(this->getLevelSize(level).prod());
+            }
+        }
+
+        const Eigen::Vector3i size = this->properties->size.cast<int>();
+        for (const auto& voxel : voxels)
+        {
+            const Eigen::Vector3i lower = (voxel.array() - static_cast<int>(radius)).max(0);
+            const Eigen::Vector3i upper = (voxel.array() + static_cast<int>(radius)).min(size.array() - 1);
+            if ((lower.array() > upper.array()).any())
+            {
+                continue;
+            }
+            for (size_t level = this->hold_level; level <= this->numLevels(); ++level)
+            {
+                const Index first = lower.unaryExpr([&level](const int& v) { return static_cast<size_t>(v) >> level; });
+                const Index last  = upper.unaryExpr([&level](const int& v) { return static_cast<size_t>(v) >> level; });
+                Bitset& held = this->held[level - this->hold_level];
+                for (size_t z = first.z(); z <= last.z(); ++z)
+                {
+                    for (size_t y = first.y(); y <= last.y(); ++y)
+                    {
+                        for (size_t x = first.x(); x <= last.x(); ++x)
+                        {
+                            held.set(this->cellToLinear(level, Index(x, y, z)));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+
+    /// @brief Releases the voxels held by `hold`.
+    void release()
+    {
+        for (auto& held : this->held)
+        {
+            held.resetDirtyBlocks();
+        }
+    }
+
+
+    /// @brief Finds which types are held by the voxels in a region.
+    /// @param lower Index of the lower bound voxel of the region.
+    /// @param upper Index of the upper bound voxel of the region, inclusive.
+    /// @return Bitwise OR of the types. This is exact for the cells at level one which overlap
+    ///         the region and so may include voxels up to one voxel outside of it.
+    uint8_t regionTypes(const Index& lower, const Index& upper) const
+    {
+        const size_t top = this->numLevels();
+        return this->regionTypes(top, Index::Zero(), lower, upper.cwiseMin(this->properties->size - Index::Ones()));
+    }
+
+
+    /// @brief Marks a voxel as changed, so its cells are recalculated by the next `refresh`.
+    /// @param i Vector index of the voxel.
+    void markVoxel(const size_t& i)
+    {
+        const Index voxel = this->properties->vectorToIndex(i);
+        this->dirty.front().set(this->cellToLinear(1, voxel.unaryExpr([](const size_t& v) { return v >> 1; })));
+    }
+
+
+    /// @brief Marks every voxel as changed, so the next `refresh` rebuilds the pyramid.
+    void markAll()
+    {
+        this->full = true;
+    }
+
+
+    /// @brief Returns true if a voxel was marked since the last `refresh`.
+    bool isStale() const
+    {
+        return this->full || this->dirty.front().numDirtyBlocks() > 0;
+    }
+
+
+    /// @brief Recalculates the cells which hold the voxels marked since the last call.
+    /// @param label Callable with the signature `uint8_t(const size_t& i)` which returns the
+    ///              VoxelOccupancy of the voxel at vector index `i`.
+    template <typename Label>
+    void refresh(Label&& label)
+    {
+        if (this->full)
+        {
+            this->build(label);
+            return;
+        }
+        if (this->dirty.front().numDirtyBlocks() == 0)
+        {
+            return;
+        }
+
+        for (size_t level = 1; level <= this->numLevels(); ++level)
+        {
+            Bitset& marked = this->dirty[level - 1];
+            const GridSize& size = this->getLevelSize(level);
+            marked.forEachSetInDirtyBlocks([&](const size_t& n)
+            {
+                const Index cell(n % size.x(), (n / size.x()) % size.y(), n / (size.x() * size.y()));
+                this->cells[level - 1][n] = level == 1 ? this->summarizeVoxels(cell, label) : this->summarizeCells(level, cell);
+                if (level < this->numLevels())
+                {
+                    this->dirty[level].set(this->cellToLinear(level + 1, cell / 2));
+                }
+            });
+            marked.resetDirtyBlocks();
+        }
+    }
+
+
+    /// @brief Rebuilds every cell.
+    /// @param label Callable with the signature `uint8_t(const size_t& i)` which returns the
+    ///              VoxelOccupancy of the voxel at vector index `i`.
+    template <typename Label>
+    void build(Label&& label)
+    {
+        for (size_t level = 1; level <= this->numLevels(); ++level)
+        {
+            const GridSize& size = this->getLevelSize(level);
+            size_t n = 0;
+            for (size_t z = 0; z < size.z(); ++z)
+            {
+                for (size_t y = 0; y < size.y(); ++y)
+                {
+                    for (size_t x = 0; x < size.x(); ++x, ++n)
+                    {
+                        const Index cell(x, y, z);
+                        this->cells[level - 1][n] = level == 1 ? this->summarizeVoxels(cell, label) : this->summarizeCells(level, cell);
+                    }
+                }
+            }
+            this->dirty[level - 1].reset();
+        }
+        this->full = false;
+    }
+
+
+    /// @brief Memory used by the cells, in bytes.
+    size_t sizeBytes() const
+    {
+        size_t n_bytes = 0;
+        for (size_t level = 0; level < this->cells.size(); ++level)
+        {
+            n_bytes += this->cells[level].capacity() * sizeof(Cell) + this->dirty[level].sizeBytes();
+        }
+        return n_bytes;
+    }
+
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Returns true if the cell which holds a voxel at a level is held. See `hold`.
+    bool isHeld(const size_t& level, const Index& voxel) const
+    {
+        if (this->held.empty())
+        {
+            return false;
+        }
+        const size_t l = std::max(level, this->hold_level);
+        return this->held[l - this->hold_level].test(
+            this->cellToLinear(l, voxel.unaryExpr([&l](const size_t& v) { return v >> l; })));
+    }
+
+
+    size_t cellToLinear(const size_t& level, const Index& cell) const
+    {
+        const GridSize& size = this->getLevelSize(level);
+        return cell.x() + size.x() * (cell.y() + size.y() * cell.z());
+    }
+
+
+    /// @brief Summarizes the up to eight voxels of a cell at level one.
+    template <typename Label>
+    Cell summarizeVoxels(const Index& cell, Label& label) const
+    {
+        const Grid::Properties& grid = *this->properties;
+        const Index first = cell * 2, last = (first + Index::Constant(2)).cwiseMin(grid.size);
+
+        Cell summary;
+        for (size_t z = first.z(); z < last.z(); ++z)
+        {
+            for (size_t y = first.y(); y < last.y(); ++y)
+            {
+                for (size_t x = first.x(); x < last.x(); ++x)
+                {
+                    const uint8_t type = label(grid[Index(x, y, z)]) & type_bits;
+                    summary.types  |= type;
+                    summary.n_seen += type != VoxelOccupancy::TYPE_UNKNOWN;
+                }
+            }
+        }
+        return summary;
+    }
+
+
+    /// @brief Summarizes the up to eight child cells of a cell above level one.
+    Cell summarizeCells(const size_t& level, const Index& cell) const
+    {
+        const GridSize& size = this->getLevelSize(level - 1);
+        const Index first = cell * 2, last = (first + Index::Constant(2)).cwiseMin(size);
+
+        Cell summary;
+        for (size_t z = first.z(); z < last.z(); ++z)
+        {
+            for (size_t y = first.y(); y < last.y(); ++y)
+            {
+                for (size_t x = first.x(); x < last.x(); ++x)
+                {
+                    const Cell& child = this->at(level - 1, Index(x, y, z));
+                    summary.types  |= child.types;
+                    summary.n_seen += child.n_seen;
+                }
+            }
+        }
+        return summary;
+    }
+
+
+    /// @brief Implements `regionTypes` by descending only into the cells the region partly overlaps.
+    uint8_t regionTypes(const size_t& level, const Index& cell, const Index& lower, const Index& upper) const
+    {
+        const Index first = cell.unaryExpr([&level](const size_t& c) { return c << level; });
+        const Index last  = first.array() + ((size_t(1) << level) - 1);
+        if ((last.array() < lower.array()).any() || (first.array() > upper.array()).any())
+        {
+            return 0;
+        }
+        const uint8_t types = this->at(level, cell).types;
+        const bool inside = (first.array() >= lower.array()).all() && (last.array() <= upper.array()).all();
+        if (inside || level == 1 || types == 0 || (types & (types - 1)) == 0)
+        {
+            // Whole cell is in the region, or it holds only one type so its children can add no others.
+            return types;
+        }
+
+        const GridSize& size = this->getLevelSize(level - 1);
+        uint8_t result = 0;
+        for (size_t dz = 0; dz < 2; ++dz)
+        {
+            for (size_t dy = 0; dy < 2; ++dy)
+            {
+                for (size_t dx = 0; dx < 2; ++dx)
+                {
+                    const Index child = cell * 2 + Index(dx, dy, dz);
+                    if ((child.array() < size.array()).all())
+                    {
+                        result |= this->regionTypes(level - 1, child, lower, upper);
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                 PRIVATE CLASS MEMBERS                                 * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Shape of the Grid being summarized.
+    const std::shared_ptr<const Grid::Properties> properties;
+
+    /// @brief Number of cells along each axis of each level, starting at level one.
+    std::vector<GridSize> level_size;
+
+    /// @brief Cells of each level, starting at level one, in X-major linear order.
+    std::vector<std::vector<Cell>> cells;
+
+    /// @brief Cells of each level which must be recalculated by `refresh`.
+    std::vector<Bitset> dirty;
+
+    /// @brief If true the next `refresh` rebuilds every cell.
+    bool full = true;
+
+    /// @brief Cells held by `hold`, for each level from `hold_level`.
+    std::vector<Bitset> held;
+
+    /// @brief Lowest level at which cells are held.
+    size_t hold_level = 1;
+};
+
+
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_COMMON_OCCUPANCY_PYRAMID_HPP
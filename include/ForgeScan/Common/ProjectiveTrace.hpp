@@ -0,0 +1,176 @@
+#ifndef FORGE_SCAN_COMMON_PROJECTIVE_TRACE_HPP
+#define FORGE_SCAN_COMMON_PROJECTIVE_TRACE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "ForgeScan/Common/Bitset.hpp"
+#include "ForgeScan/Common/Grid.hpp"
+#include "ForgeScan/Common/TraceBatch.hpp"
+#include "ForgeScan/Sensor/Intrinsics.hpp"
+
+
+namespace forge_scan {
+
+
+/// @brief Helpers for the projective update, which samples each voxel near a surface from the depth
+///        image once rather than tracing a ray from each pixel.
+/// @details The Grid is divided into cubic blocks of `2^block_shift` voxels on each side. Blocks which
+///          the truncation band of any sensed point reaches are marked, then the voxels of each
+///          marked block are projected into the depth image. Each voxel is given the distance from
+///          the pixel's measured depth along that pixel's ray, with the same sign as a Trace: positive
+///          towards the camera. The samples of one block form one ray of a TraceBatch, sorted by
+///          distance, so a VoxelGrid updates from them exactly as it does from a traced ray.
+namespace projective_trace {
+
+
+/// @brief Number of blocks along each axis of a Grid.
+/// @param properties Grid Properties.
+/// @param block_shift Blocks are `2^block_shift` voxels on each side.
+inline GridSize get_num_blocks(const std::shared_ptr<const Grid::Properties>& properties, const size_t& block_shift)
+{
+    const size_t mask = (static_cast<size_t>(1) << block_shift) - 1;
+    return GridSize((properties->size[0] + mask) >> block_shift,
+                    (properties->size[1] + mask) >> block_shift,
+                    (properties->size[2] + mask) >> block_shift);
+}
+
+
+/// @brief Marks the blocks which the truncation band of any sensed point may reach.
+/// @param [out] blocks Bitset with a bit for each block, in X, then Y, then Z order. This is not
+///                     cleared first.
+/// @param sensed_points Sensed points, in the Grid's reference frame.
+/// @param origin Position of the camera, in the Grid's reference frame.
+/// @param properties Grid Properties.
+/// @param dist_min Minimum distance along each ray, relative to its sensed point, to reach.
+/// @param dist_max Maximum distance along each ray, relative to its sensed point, to reach.
+/// @param block_shift Blocks are `2^block_shift` voxels on each side.
+/// @note  Each block overlapping the bounding box of the band's segment is marked. The segment is
+///        clipped to `dist_max` but not to the camera, as with a Trace.
+inline void mark_blocks(Bitset& blocks, const PointMatrix& sensed_points, const Point& origin,
+                        const std::shared_ptr<const Grid::Properties>& properties,
+                        const float& dist_min, const float& dist_max, const size_t& block_shift)
+{
+    const GridSize n_blocks = get_num_blocks(properties, block_shift);
+    const Eigen::Array3f upper = properties->size.cast<float>().array() - 1.0f;
+    const float p2i = 1.0f / properties->resolution;
+
+    for (const auto& sensed : sensed_points.colwise())
+    {
+        const Point to_origin = origin - sensed;
+        const float length = to_origin.norm();
+        if (!(length > 0.0f))
+        {
+            continue;
+        }
+        const Point u = to_origin / length;
+        const Eigen::Array3f a = (sensed + dist_min * u).array() * p2i;
+        const Eigen::Array3f b = (sensed + std::min(dist_max, length) * u).array() * p2i;
+
+        // Voxel centers fall on integer coordinates, so pad by half a voxel to round outwards.
+        const Eigen::Array3f lo = (a.min(b) - 0.5f).ceil();
+        const Eigen::Array3f hi = (a.max(b) + 0.5f).floor();
+        if ((hi < 0.0f).any() || (lo > upper).any())
+        {
+            continue;
+        }
+        const Index first = lo.max(0.0f).cast<size_t>().matrix();
+        const Index last  = hi.min(upper).cast<size_t>().matrix();
+        for (size_t z = first[2] >> block_shift; z <= last[2] >> block_shift; ++z)
+        {
+            for (size_t y = first[1] >> block_shift; y <= last[1] >> block_shift; ++y)
+            {
+                for (size_t x = first[0] >> block_shift; x <= last[0] >> block_shift; ++x)
+                {
+                    blocks.set(x + n_blocks[0] * (y + n_blocks[1] * z));
+                }
+            }
+        }
+    }
+}
+
+
+/// @brief Projects the voxels of one block into a depth image and appends those within the distance
+///        range to the batch as one ray.
+/// @param [out] trace_batch Batch to append the block's ray to. Nothing is appended if no voxel of
+///                          the block is within the distance range.
+/// @param [out] samples Scratch space for the block's samples. Reused between calls.
+/// @param image Depth image, with a row for each pixel row and a column for each pixel column.
+/// @param intr Intrinsics of the camera which took the image.
+/// @param extr Pose of the camera, in the Grid's reference frame.
+/// @param properties Grid Properties.
+/// @param dist_min Minimum distance along each pixel's ray, relative to its sensed point, to keep.
+/// @param dist_max Maximum distance along each pixel's ray, relative to its sensed point, to keep.
+/// @param block Block to sample, in X, then Y, then Z order.
+/// @param block_shift Blocks are `2^block_shift` voxels on each side.
+/// @return Number of voxels appended.
+/// @note  Each voxel center is projected to its nearest pixel. Voxels behind the camera, outside the
+///        image, or in pixels without a finite, positive depth are left out.
+inline size_t get_block_samples(TraceBatch& trace_batch, std::vector<TraceBatch::Voxel>& samples,
+                                const DepthImage& image, const sensor::Intrinsics& intr, const Extrinsic& extr,
+                                const std::shared_ptr<const Grid::Properties>& properties,
+                                const float& dist_min, const float& dist_max,
+                                const size_t& block, const size_t& block_shift)
+{
+    const GridSize n_blocks = get_num_blocks(properties, block_shift);
+    const size_t side = static_cast<size_t>(1) << block_shift;
+    const Index first(side * (block % n_blocks[0]),
+                      side * ((block / n_blocks[0]) % n_blocks[1]),
+                      side * (block / (n_blocks[0] * n_blocks[1])));
+    const Index last = (first.array() + side).min(properties->size.array()).matrix();
+
+    const Extrinsic to_camera = extr.inverse();
+    const Eigen::Index n_rows = image.rows(), n_cols = image.cols();
+
+    samples.clear();
+    for (size_t z = first[2]; z < last[2]; ++z)
+    {
+        for (size_t y = first[1]; y < last[1]; ++y)
+        {
+            for (size_t x = first[0]; x < last[0]; ++x)
+            {
+                const Point p = to_camera * (Index(x, y, z).cast<float>() * properties->resolution);
+                if (!(p.z() > 0.0f))
+                {
+                    continue;
+                }
+                const Eigen::Index col = static_cast<Eigen::Index>(std::lround(intr.f_x * p.x() / p.z() + intr.c_x));
+                const Eigen::Index row = static_cast<Eigen::Index>(std::lround(intr.f_y * p.y() / p.z() + intr.c_y));
+                if (col < 0 || row < 0 || col >= n_cols || row >= n_rows)
+                {
+                    continue;
+                }
+                const float depth = image(row, col);
+                if (!(depth > 0.0f) || !std::isfinite(depth))
+                {
+                    continue;
+                }
+
+                // Distance along the pixel's ray from its sensed point, positive towards the camera.
+                const float d = (depth - p.z()) * p.norm() / p.z();
+                if (d >= dist_min && d <= dist_max)
+                {
+                    samples.push_back(TraceBatch::Voxel{properties->at(Index(x, y, z)), d});
+                }
+            }
+        }
+    }
+
+    if (!samples.empty())
+    {
+        std::sort(samples.begin(), samples.end(),
+                  [](const TraceBatch::Voxel& a, const TraceBatch::Voxel& b) { return a.d < b.d; });
+        trace_batch.appendRay(samples);
+    }
+    return samples.size();
+}
+
+
+} // namespace projective_trace
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_COMMON_PROJECTIVE_TRACE_HPP
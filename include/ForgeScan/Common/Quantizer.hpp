@@ -0,0 +1,246 @@
+#ifndef FORGE_SCAN_COMMON_QUANTIZER_HPP
+#define FORGE_SCAN_COMMON_QUANTIZER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "ForgeScan/Common/Definitions.hpp"
+#include "ForgeScan/Common/Exceptions.hpp"
+#include "ForgeScan/Common/VoxelData.hpp"
+
+
+namespace forge_scan {
+
+
+/// @brief Fixed-point encoding of real values stored in a small integer type.
+/// @details A value `x` is stored as `round(x / step)`, where the step divides the largest value
+///          of the integer type across `range`. Signed types hold `[-range, range]` and unsigned
+///          types hold `[0, range]`. Values outside this saturate at its bounds. The lowest value of
+///          a signed type is kept outside the range to stand for negative infinity.
+/// @note  Floating point types store values unchanged, so code which encodes and decodes through a
+///        Quantizer works for both and costs nothing for floating point data.
+/// @note  Only 8 and 16-bit integers may be quantized. Wider types gain nothing over a `float`.
+class Quantizer
+{
+public:
+    /// @brief Creates a Quantizer which stores values unchanged.
+    Quantizer() = default;
+
+
+    /// @brief Creates a Quantizer for a DataType.
+    /// @param range Largest magnitude to represent. Values are stored unchanged if this is not
+    ///              positive and finite.
+    /// @param type_id DataType the values are stored in.
+    /// @throws DataVariantError If the DataType is an integer type wider than 16 bits.
+    Quantizer(const float& range, const DataType& type_id)
+    {
+        const float max_value = Quantizer::getMaxValue(Quantizer::validDataTypeID(type_id));
+        if (max_value > 0 && range > 0 && std::isfinite(range))
+        {
+            this->step     = range / max_value;
+            this->inv_step = max_value / range;
+        }
+    }
+
+
+    /// @brief Checks that a DataType may be used with a Quantizer.
+    /// @param type_id DataType to check.
+    /// @return The input, if it is a floating point type or an 8 or 16-bit integer type.
+    /// @throws DataVariantError If it is not.
+    static DataType validDataTypeID(const DataType& type_id)
+    {
+        if ((type_id & DataType::TYPE_FLOATING_POINT) || Quantizer::getMaxValue(type_id) > 0)
+        {
+            return type_id;
+        }
+        throw DataVariantError::VoxelGridDoesNotSupport(dataTypeToString(type_id),
+                                                        "TYPE_FLOATING_POINT, INT8_T, INT16_T, UINT8_T or UINT16_T");
+    }
+
+
+    /// @brief Returns the size of one step of the encoding. This is 1 for floating point types.
+    float getStep() const
+    {
+        return this->step;
+    }
+
+
+    /// @brief Converts a stored value to the value it represents.
+    /// @param value Stored value.
+    /// @return Represented value. The lowest value of a signed integer type gives negative infinity.
+    ///         Floating point values are returned unchanged, in their own type.
+    template <typename T>
+    std::conditional_t<std::is_floating_point_v<T>, T, float> decode(const T& value) const
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            return value;
+        }
+        else
+        {
+            if constexpr (std::is_signed_v<T>)
+            {
+                if (value == std::numeric_limits<T>::lowest())
+                {
+                    return NEGATIVE_INFINITY;
+                }
+            }
+            return static_cast<float>(value) * this->step;
+        }
+    }
+
+
+    /// @brief Converts a value to the value to store for it.
+    /// @param value Value to represent.
+    /// @return Stored value. Values outside the range saturate at its bounds, except that negative
+    ///         infinity in a signed integer type is stored as the lowest value of the type. NaN is
+    ///         stored as zero in an integer type.
+    template <typename T>
+    T encode(const float& value) const
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            return static_cast<T>(value);
+        }
+        else
+        {
+            constexpr float hi = static_cast<float>(std::numeric_limits<T>::max());
+            constexpr float lo = std::is_signed_v<T> ? -hi : 0.0f;
+            if (std::is_signed_v<T> && value == NEGATIVE_INFINITY)
+            {
+                return std::numeric_limits<T>::lowest();
+            }
+            if (std::isnan(value))
+            {
+                return T(0);
+            }
+            return static_cast<T>(std::clamp(std::round(value * this->inv_step), lo, hi));
+        }
+    }
+
+
+    /// @brief Gets a threshold to compare stored values against without decoding them.
+    /// @param value Value to compare the represented values against.
+    /// @return Threshold for which `stored < threshold` exactly when `decode(stored) < value`.
+    /// @note  Comparing stored values keeps loops over integer data free of conversions, so they
+    ///        vectorize.
+    template <typename T>
+    float storedThreshold(const float& value) const
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            return value;
+        }
+        else
+        {
+            constexpr float hi = static_cast<float>(std::numeric_limits<T>::max());
+            constexpr float lo = std::is_signed_v<T> ? -hi : 0.0f;
+            if (!(value > lo * this->step))
+            {
+                return lo;
+            }
+            if (value > hi * this->step)
+            {
+                return hi + 1;
+            }
+
+            // Rounding may put the first guess one step off, which the checks correct.
+            float k = std::clamp(std::ceil(value * this->inv_step), lo, hi + 1);
+            while (k > lo && (k - 1) * this->step >= value)
+            {
+                --k;
+            }
+            while (k <= hi && k * this->step < value)
+            {
+                ++k;
+            }
+            return k;
+        }
+    }
+
+
+    /// @brief Gets the value to pass as the default value of a VoxelGrid so each voxel stores the
+    ///        encoding of a value. See `VoxelGrid::VoxelGrid`.
+    /// @param value Value to represent.
+    /// @param type_id DataType the values are stored in.
+    /// @return The value a voxel stores for the input, as a float.
+    float stored(const float& value, const DataType& type_id) const
+    {
+        switch (type_id)
+        {
+            case DataType::INT8_T:   return static_cast<float>(this->encode<int8_t>(value));
+            case DataType::INT16_T:  return static_cast<float>(this->encode<int16_t>(value));
+            case DataType::UINT8_T:  return static_cast<float>(this->encode<uint8_t>(value));
+            case DataType::UINT16_T: return static_cast<float>(this->encode<uint16_t>(value));
+            default:                 return value;
+        }
+    }
+
+
+    /// @brief Decodes every element of a vector.
+    /// @param vector Vector to decode. Either a `std::vector`, a `SparseVector` or a `MappedVector`.
+    /// @param n Number of elements to decode.
+    /// @return Dense vector of the represented values.
+    template <typename Vector>
+    std::vector<float> decodeAll(const Vector& vector, const size_t& n) const
+    {
+        std::vector<float> decoded(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            decoded[i] = static_cast<float>(this->decode(vector[i]));
+        }
+        return decoded;
+    }
+
+
+    /// @brief Encodes every element of a dense vector into another vector.
+    /// @param decoded Vector of represented values.
+    /// @param [out] vector Vector to store into. Either a `std::vector`, a `SparseVector` or a
+    ///                     `MappedVector`. It must already have as many elements as `decoded`.
+    /// @note  Voxels of a `SparseVector` whose stored value is its fill value are not allocated.
+    template <typename Vector>
+    void encodeAll(const std::vector<float>& decoded, Vector& vector) const
+    {
+        using T = typename Vector::value_type;
+        for (size_t i = 0; i < decoded.size(); ++i)
+        {
+            const T value = this->encode<T>(decoded[i]);
+            if (value != static_cast<const Vector&>(vector)[i])
+            {
+                vector[i] = value;
+            }
+        }
+    }
+
+
+    /// @brief Largest value of an integer DataType which may be quantized.
+    /// @param type_id DataType to check.
+    /// @return The largest value, or 0 if the type may not be quantized.
+    static float getMaxValue(const DataType& type_id)
+    {
+        switch (type_id)
+        {
+            case DataType::INT8_T:   return static_cast<float>(std::numeric_limits<int8_t>::max());
+            case DataType::INT16_T:  return static_cast<float>(std::numeric_limits<int16_t>::max());
+            case DataType::UINT8_T:  return static_cast<float>(std::numeric_limits<uint8_t>::max());
+            case DataType::UINT16_T: return static_cast<float>(std::numeric_limits<uint16_t>::max());
+            default:                 return 0;
+        }
+    }
+
+
+private:
+    /// @brief Size of one step of the encoding, and its inverse.
+    float step = 1, inv_step = 1;
+};
+
+
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_COMMON_QUANTIZER_HPP
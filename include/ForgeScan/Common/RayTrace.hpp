@@ -1,10 +1,14 @@
 #ifndef FORGE_SCAN_COMMON_RAY_TRACE_HPP
 #define FORGE_SCAN_COMMON_RAY_TRACE_HPP
 
+#include <algorithm>
 #include <cstddef>
+#include <limits>
+#include <type_traits>
 
 #include "ForgeScan/Common/AABB.hpp"
 #include "ForgeScan/Common/Grid.hpp"
+#include "ForgeScan/Common/OccupancyPyramid.hpp"
 #include "ForgeScan/Common/VectorMath.hpp"
 
 
@@ -62,7 +66,8 @@ struct Trace : public std::vector<TraceVoxel>
 {
     /// @details Required to set the sensed iterator for the Trace.
     friend bool get_ray_trace(const std::shared_ptr<Trace>&, const Point&, const Point&,
-                              const std::shared_ptr<const Grid::Properties>&, const float&, const float&);
+                              const std::shared_ptr<const Grid::Properties>&, const float&, const float&,
+                              const OccupancyPyramid*, const float&, const uint32_t&);
 
 
     /// @brief Describes where the sensed point is relative to the traced ray.
@@ -81,6 +86,7 @@ struct Trace : public std::vector<TraceVoxel>
         std::vector<TraceVoxel>::clear();
         this->sensed_location = SensedLocation::UNKNOWN;
         this->sensed_point    = Point(-1, -1, -1);
+        this->n_samples       = 1;
     }
 
 
@@ -101,6 +107,14 @@ struct Trace : public std::vector<TraceVoxel>
     }
 
 
+    /// @brief Number of rays this one stands in for. One unless the rays of an update were merged
+    ///        by their sensed voxel, see `data::Reconstruction::setEndpointMerge`.
+    uint32_t weight() const
+    {
+        return this->n_samples;
+    }
+
+
     /// @brief Finds the voxel at a distance greater than the specified value.
     /// @param dist Threshold distance.
     /// @return First voxel with a value greater than the specified distance threshold.
@@ -170,6 +184,9 @@ private:
 
     /// @brief Flag for the status of the sensed point relative to the Trace.
     SensedLocation sensed_location = SensedLocation::UNKNOWN;
+
+    /// @brief Number of rays this one stands in for. See `weight`.
+    uint32_t n_samples = 1;
 };
 
 
@@ -205,6 +222,23 @@ inline float get_dist(const std::ptrdiff_t& d, const std::ptrdiff_t* sign, const
 }
 
 
+/// @brief Helper for `get_ray_trace`. Gets the signed change in vector index for one step along each axis.
+/// @param [out] index_step Change in vector index for a step along X, Y and Z.
+/// @param step Direction of travel along each axis.
+/// @param c_idx Index of the current voxel. For a bricked layout the steps are only valid within its brick.
+/// @param properties Shared `Grid::Properties` for the VoxelGrids begin traversed.
+/// @warning This should only be called by `get_ray_trace`.
+inline void get_index_step(std::ptrdiff_t* index_step, const int* step, const Index& c_idx,
+                           const std::shared_ptr<const Grid::Properties>& properties)
+{
+    const GridSize stride = properties->getVectorStrides(c_idx);
+    for (std::ptrdiff_t d = 0; d < 3; ++d)
+    {
+        index_step[d] = step[d] * static_cast<std::ptrdiff_t>(stride[d]);
+    }
+}
+
+
 /// @brief Helper for `get_ray_trace`.
 /// @warning This should only be called by `get_ray_trace`.
 inline std::ptrdiff_t get_min_dist(const float* dist)
@@ -232,73 +266,201 @@ inline Trace::SensedLocation get_sensed_location(const float& d_min,  const floa
 }
 
 
-} // namespace ray_trace_helpers
+/// @brief Helper for `traverse`. Calls `emit` for a voxel.
+/// @return False if `emit` returns a bool and it was false, to stop the traversal. Otherwise true.
+template <typename EmitVoxel>
+inline bool emit_voxel(EmitVoxel& emit, const size_t& i, const float& d)
+{
+    if constexpr (std::is_same<std::invoke_result_t<EmitVoxel&, const size_t&, const float&>, bool>::value)
+    {
+        return emit(i, d);
+    }
+    else
+    {
+        emit(i, d);
+        return true;
+    }
+}
 
 
-/// @brief Calculates what voxels are hit on the ray between `sensed` and `origin`.
-/// @param [out] ray_trace A trace of what voxels were hit and the distance from that voxel to the `sensed` voxel.
+/// @brief Where a ray's traversal of the Grid begins. See `start_traversal`.
+struct TraversalStart
+{
+    /// @brief Range of distances, relative to the sensed point, over which the ray is within the Grid.
+    float dist_min_adj, dist_max_adj;
+
+    /// @brief Index of the first voxel on the ray.
+    Index c_idx;
+
+    /// @brief Direction of travel (increment or decrement) along the respective axis.
+    int step[3];
+
+    /// @brief The amount of distance to move one voxel length along each axis based on the ray's direction.
+    float delta[3];
+
+    /// @brief Distance at which the ray leaves the first voxel along the respective axis.
+    float dist[3];
+};
+
+
+/// @brief Clips a ray to the Grid and finds the parameters to begin its traversal from.
 /// @param sensed Sensed point, the start of the ray.
 /// @param origin Origin point, the end of the ray.
 /// @param properties Shared `Grid::Properties` for the VoxelGrids begin traversed.
 /// @param dist_min Minimum distance to trace along the ray, relative to the `sensed` point.
 /// @param dist_max Maximum distance to trace along the ray, relative to the `sensed` point.
-/// @return True if the ray intersected the Grid, this indicates that `ray_trace` has valid data to add.
-inline bool get_ray_trace(const std::shared_ptr<Trace>& ray_trace,
-                          const Point& sensed, const Point& origin,
-                          const std::shared_ptr<const Grid::Properties>& properties,
-                          const float& dist_min, const float& dist_max)
+/// @param [out] start Parameters for the traversal. Only valid if this returns true.
+/// @return True if the ray intersected the Grid.
+/// @warning This should only be called by `traverse` or `get_ray_trace_batch`.
+inline bool start_traversal(const Point& sensed, const Point& origin,
+                            const std::shared_ptr<const Grid::Properties>& properties,
+                            const float& dist_min, const float& dist_max, TraversalStart& start)
 {
     static constexpr std::ptrdiff_t X = 0, Y = 1, Z = 2;
 
-    ray_trace->clear();
-
-    // Adjusted min and max distances so we only trace the ray while it is within the Grid's bounds.
-    float dist_min_adj, dist_max_adj;
-
     float length;
     Direction normal, inv_normal;
     vector_math::get_length_normal_and_inverse_normal(sensed, origin, length, normal, inv_normal);
     length = std::min(length, dist_max);
 
-    const bool valid_intersection = AABB::find_zero_bounded_intersection(properties->dimensions, sensed, inv_normal,
-                                                                         dist_min, length, dist_min_adj, dist_max_adj);
-    if (valid_intersection)
+    // Adjusted min and max distances so we only trace the ray while it is within the Grid's bounds.
+    if (!AABB::find_zero_bounded_intersection(properties->dimensions, sensed, inv_normal, dist_min, length,
+                                              start.dist_min_adj, start.dist_max_adj))
     {
-        dist_min_adj = std::max(dist_min_adj, dist_min);
-        dist_max_adj = std::min(dist_max_adj, dist_max);
+        return false;
+    }
+    start.dist_min_adj = std::max(start.dist_min_adj, dist_min);
+    start.dist_max_adj = std::min(start.dist_max_adj, dist_max);
+
+    const Point sensed_adj = sensed + normal * start.dist_min_adj;
+    start.c_idx = properties->pointToIndex(sensed_adj);
 
-        const Point sensed_adj = sensed + normal * dist_min_adj;
-        Index c_idx = properties->pointToIndex(sensed_adj);
+    const std::ptrdiff_t sign[3] = {std::signbit(normal[X]), std::signbit(normal[Y]), std::signbit(normal[Z])};
+    for (std::ptrdiff_t d = 0; d < 3; ++d)
+    {
+        start.step[d]  = get_step(d, sign);
+        start.delta[d] = get_delta(d, inv_normal, properties);
+        start.dist[d]  = get_dist(d, sign, start.c_idx, sensed_adj, inv_normal, start.dist_min_adj, properties);
+    }
+    return true;
+}
 
-        const std::ptrdiff_t sign[3] = {std::signbit(normal[X]), std::signbit(normal[Y]), std::signbit(normal[Z])};
 
-        // Direction of travel (increment or decrement) along the respective axis.
-        const int step[3] = { ray_trace_helpers::get_step(X, sign),
-                              ray_trace_helpers::get_step(Y, sign),
-                              ray_trace_helpers::get_step(Z, sign) };
+/// @brief Implements the Amanatides-Woo traversal for `get_ray_trace` and `get_ray_trace_batch`.
+/// @param sensed Sensed point, the start of the ray.
+/// @param origin Origin point, the end of the ray.
+/// @param properties Shared `Grid::Properties` for the VoxelGrids begin traversed.
+/// @param dist_min Minimum distance to trace along the ray, relative to the `sensed` point.
+/// @param dist_max Maximum distance to trace along the ray, relative to the `sensed` point.
+/// @param emit Callable with the signature `void(const size_t& i, const float& d)`. This is called
+///             for each voxel hit, in order of ascending distance from the sensed point. It may
+///             instead return a bool, and the traversal stops early when it returns false.
+/// @param [out] sensed_location If the ray intersected the Grid, the location of the sensed point
+///                              relative to the traced voxels.
+/// @param skip_pyramid Optional pyramid of voxels which may be skipped. Voxels entered further than
+///                     `skip_dist` from the sensed point, in a cell of this pyramid which is all free,
+///                     are stepped through without being emitted.
+/// @param skip_dist Distance past which voxels may be skipped.
+/// @return True if the ray intersected the Grid.
+/// @throws VoxelOutOfRange If the traversal left the Grid. This should not happen.
+/// @warning This should only be called by `get_ray_trace`, `get_ray_trace_batch` or `visit_ray`.
+template <typename EmitVoxel>
+inline bool traverse(const Point& sensed, const Point& origin,
+                     const std::shared_ptr<const Grid::Properties>& properties,
+                     const float& dist_min, const float& dist_max,
+                     EmitVoxel&& emit, Trace::SensedLocation& sensed_location,
+                     const OccupancyPyramid* skip_pyramid = nullptr, const float& skip_dist = INFINITY)
+{
+    TraversalStart start;
+    const bool valid_intersection = start_traversal(sensed, origin, properties, dist_min, dist_max, start);
+    if (valid_intersection)
+    {
+        const float& dist_max_adj = start.dist_max_adj;
+        const int*   step  = start.step;
+        const float* delta = start.delta;
+        Index c_idx = start.c_idx;
 
-        // The amount of distance to move one voxel length along each axis based on the ray's direction.
-        const float delta[3] = { ray_trace_helpers::get_delta(X, inv_normal, properties),
-                                 ray_trace_helpers::get_delta(Y, inv_normal, properties),
-                                 ray_trace_helpers::get_delta(Z, inv_normal, properties) };
+        // The change in vector index when moving one voxel along each axis based on the ray's direction.
+        std::ptrdiff_t index_step[3];
+        get_index_step(index_step, step, c_idx, properties);
 
         // Cumulative distance traveled along the respective axis.
-        float dist[3] = { ray_trace_helpers::get_dist(X, sign, c_idx, sensed_adj, inv_normal, dist_min_adj, properties),
-                          ray_trace_helpers::get_dist(Y, sign, c_idx, sensed_adj, inv_normal, dist_min_adj, properties),
-                          ray_trace_helpers::get_dist(Z, sign, c_idx, sensed_adj, inv_normal, dist_min_adj, properties) };
+        float dist[3] = { start.dist[0], start.dist[1], start.dist[2] };
 
         try
         {
-            ray_trace->emplace_back(properties->at(c_idx), dist_min_adj);
-
-            std::ptrdiff_t i = ray_trace_helpers::get_min_dist(dist);
-            while (dist[i] <= dist_max_adj)
+            // Only the first voxel needs the full bounds check and index calculation. After that only
+            // one axis changes per step, so only that axis is checked and the vector index is stepped
+            // by that axis's stride. Decrementing past zero wraps the unsigned index, which this catches.
+            // For a bricked layout the strides are only constant within a brick. So when the step
+            // enters a new brick the vector index and strides are found again from the Index.
+            size_t v_idx = properties->at(c_idx);
+            float d_entry = start.dist_min_adj;
+
+            // Steps into the next voxel. Returns the axis stepped along, or -1 past the end of the ray.
+            auto advance = [&]() -> std::ptrdiff_t
             {
+                const std::ptrdiff_t i = get_min_dist(dist);
+                if (dist[i] > dist_max_adj)
+                {
+                    return -1;
+                }
+                const size_t previous = c_idx[i];
                 c_idx[i] +=  step[i];
-                ray_trace->emplace_back(properties->at(c_idx), dist[i]);
-
-                dist[i]  += delta[i];
-                i = ray_trace_helpers::get_min_dist(dist);
+                if (c_idx[i] >= properties->size[i])
+                {
+                    throw VoxelOutOfRange(properties->size, c_idx);
+                }
+                if (properties->sameBrick(previous, c_idx[i]))
+                {
+                    v_idx += index_step[i];
+                }
+                else
+                {
+                    v_idx = properties->operator[](c_idx);
+                    get_index_step(index_step, step, c_idx, properties);
+                }
+                d_entry  = dist[i];
+                dist[i] += delta[i];
+                return i;
+            };
+
+            // Cell at level one of the skip pyramid which was last found to not be uniform. Every
+            // other voxel in it would be found the same, so it is only checked once.
+            Index checked = Index::Constant(std::numeric_limits<size_t>::max());
+            while (true)
+            {
+                if (skip_pyramid != nullptr && d_entry > skip_dist)
+                {
+                    const Index cell = c_idx.unaryExpr([](const size_t& v) { return v >> 1; });
+                    if (cell != checked)
+                    {
+                        const size_t level = skip_pyramid->uniformLevel(c_idx, VoxelOccupancy::TYPE_FREE);
+                        if (level > 0)
+                        {
+                            // The voxels of the cell are stepped through just as they would be otherwise,
+                            // only without emitting them. So the voxels after it are the same.
+                            const Index skipped = c_idx.unaryExpr([&level](const size_t& v) { return v >> level; });
+                            std::ptrdiff_t i;
+                            do
+                            {
+                                i = advance();
+                            }
+                            while (i >= 0 && (c_idx[i] >> level) == skipped[i]);
+
+                            if (i < 0)
+                            {
+                                break;
+                            }
+                            continue;
+                        }
+                        checked = cell;
+                    }
+                }
+                if (!emit_voxel(emit, v_idx, d_entry) || advance() < 0)
+                {
+                    break;
+                }
             }
         }
         catch (const VoxelOutOfRange& e)
@@ -311,12 +473,70 @@ inline bool get_ray_trace(const std::shared_ptr<Trace>& ray_trace,
             throw VoxelOutOfRange("Ray tracing failed: This should not happen. Failed with: " +  std::string(e.what()));
         }
 
-        ray_trace->set_sensed(sensed, ray_trace_helpers::get_sensed_location(dist_min_adj, dist_max_adj));
+        sensed_location = get_sensed_location(start.dist_min_adj, start.dist_max_adj);
+    }
+    return valid_intersection;
+}
+
+
+} // namespace ray_trace_helpers
+
+
+/// @brief Calculates what voxels are hit on the ray between `sensed` and `origin`.
+/// @param [out] ray_trace A trace of what voxels were hit and the distance from that voxel to the `sensed` voxel.
+/// @param sensed Sensed point, the start of the ray.
+/// @param origin Origin point, the end of the ray.
+/// @param properties Shared `Grid::Properties` for the VoxelGrids begin traversed.
+/// @param dist_min Minimum distance to trace along the ray, relative to the `sensed` point.
+/// @param dist_max Maximum distance to trace along the ray, relative to the `sensed` point.
+/// @param skip_pyramid Optional pyramid whose free cells, past `skip_dist`, are left out of the trace.
+/// @param skip_dist Distance past which voxels may be left out of the trace.
+/// @param weight Number of rays the ray stands in for, see `Trace::weight`.
+/// @return True if the ray intersected the Grid, this indicates that `ray_trace` has valid data to add.
+inline bool get_ray_trace(const std::shared_ptr<Trace>& ray_trace,
+                          const Point& sensed, const Point& origin,
+                          const std::shared_ptr<const Grid::Properties>& properties,
+                          const float& dist_min, const float& dist_max,
+                          const OccupancyPyramid* skip_pyramid = nullptr, const float& skip_dist = INFINITY,
+                          const uint32_t& weight = 1)
+{
+    ray_trace->clear();
+
+    auto emit = [&ray_trace](const size_t& i, const float& d) { ray_trace->emplace_back(i, d); };
+
+    Trace::SensedLocation sensed_location = Trace::SensedLocation::UNKNOWN;
+    const bool valid_intersection = ray_trace_helpers::traverse(sensed, origin, properties, dist_min, dist_max,
+                                                                emit, sensed_location, skip_pyramid, skip_dist);
+    if (valid_intersection)
+    {
+        ray_trace->set_sensed(sensed, sensed_location);
+        ray_trace->n_samples = weight;
     }
     return valid_intersection;
 }
 
 
+/// @brief Visits the voxels hit on the ray from `start` towards `end`, in order, until told to stop.
+/// @param start Start of the ray.
+/// @param end End of the ray.
+/// @param properties Shared `Grid::Properties` for the VoxelGrids begin traversed.
+/// @param dist_min Minimum distance to trace along the ray, relative to the `start` point.
+/// @param dist_max Maximum distance to trace along the ray, relative to the `start` point.
+/// @param visit Callable with the signature `bool(const size_t& i, const float& d)`. This is called
+///              for each voxel hit, in order of ascending distance from `start`, until it returns false.
+/// @return True if the ray intersected the Grid.
+/// @note  Nothing is stored, so this suits casting many rays to query a VoxelGrid's data, such as
+///        to score views, where each ray stops at the first occupied voxel.
+template <typename Visit>
+inline bool visit_ray(const Point& start, const Point& end,
+                      const std::shared_ptr<const Grid::Properties>& properties,
+                      const float& dist_min, const float& dist_max, Visit&& visit)
+{
+    Trace::SensedLocation sensed_location = Trace::SensedLocation::UNKNOWN;
+    return ray_trace_helpers::traverse(start, end, properties, dist_min, dist_max, visit, sensed_location);
+}
+
+
 } // namespace forge_scan
 
 
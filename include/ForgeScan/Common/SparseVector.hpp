@@ -0,0 +1,514 @@
+#ifndef FORGE_SCAN_COMMON_SPARSE_VECTOR_HPP
+#define FORGE_SCAN_COMMON_SPARSE_VECTOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ForgeScan/Common/Types.hpp"
+#include "ForgeScan/Utilities/MemoryUse.hpp"
+
+
+namespace forge_scan {
+
+
+/// @brief A sparse alternative to a `std::vector` for the voxel data of a Grid.
+/// @details Voxels are grouped into cubic blocks of `block_width^3` voxels. A block is only
+///          allocated the first time one of its voxels is accessed through the non-const
+///          `operator[]`. Until then every voxel in that block reads as the fill value. Allocated
+///          blocks are found with an open-addressing hash map keyed by the block's coordinate.
+///          Memory therefore scales with the volume that rays actually touch, rather than with
+///          the volume of the Grid's bounding box.
+/// @details For a bricked layout, see `Grid::Properties::brick_size`, a block is instead
+///          `block_volume` consecutive vector indices within one row of bricks. A row of bricks is
+///          contiguous in the vector, so a block is a compact `n x brick_size x brick_size` slab of
+///          the Grid, and for a brick size of `block_width` it is exactly one brick.
+/// @note  Voxels are addressed by the same vector index as a dense `std::vector`. See
+///        `Grid::Properties::at`.
+/// @note  Accessing voxels through the non-const `operator[]` may allocate a block and grow the
+///        hash map. This is not safe to do from multiple threads. Const access is.
+template <typename T>
+class SparseVector
+{
+public:
+    using value_type = T;
+
+    /// @brief Number of voxels along each edge of a block, as a power of two.
+    static constexpr size_t block_bits = 3;
+
+    /// @brief Number of voxels along each edge of a block.
+    static constexpr size_t block_width = 1 << block_bits;
+
+    /// @brief Number of voxels in a block.
+    static constexpr size_t block_volume = block_width * block_width * block_width;
+
+    /// @brief Storage for the voxels of one block.
+    using Block = std::array<T, block_volume>;
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Creates a SparseVector for a Grid with no blocks allocated.
+    /// @param size Number of voxels in the Grid in each direction.
+    /// @param fill_value Value of every voxel which has not been written to.
+    /// @param brick_size Brick size of the Grid's layout, see `Grid::Properties::brick_size`. Must be
+    ///                   a power of two. One is the X-major linear layout.
+    SparseVector(const GridSize& size = GridSize(1, 1, 1), const T& fill_value = T(), const size_t& brick_size = 1)
+        : size_xyz(size),
+          n_voxels(size.prod()),
+          n_blocks_xyz(((size.array() + block_width - 1) / block_width).matrix()),
+          brick_size(brick_size),
+          brick_mask(brick_size - 1),
+          n_brick_rows_y((size[1] + brick_size - 1) / brick_size),
+          blocks_per_brick_row((size[0] * brick_size * brick_size + block_volume - 1) / block_volume),
+          fill_value(fill_value)
+    {
+        this->table.assign(SparseVector::initial_table_size, SparseVector::empty_slot);
+    }
+
+
+    SparseVector(const SparseVector& other)
+        : size_xyz(other.size_xyz),
+          n_voxels(other.n_voxels),
+          n_blocks_xyz(other.n_blocks_xyz),
+          brick_size(other.brick_size),
+          brick_mask(other.brick_mask),
+          n_brick_rows_y(other.n_brick_rows_y),
+          blocks_per_brick_row(other.blocks_per_brick_row),
+          fill_value(other.fill_value),
+          table(other.table),
+          block_keys(other.block_keys)
+    {
+        this->blocks.reserve(other.blocks.size());
+        for (const auto& block : other.blocks)
+        {
+            this->blocks.push_back(std::make_unique<Block>(*block));
+        }
+    }
+
+
+    SparseVector(SparseVector&&) = default;
+
+
+    SparseVector& operator=(const SparseVector& other)
+    {
+        if (this != &other)
+        {
+            *this = SparseVector(other);
+        }
+        return *this;
+    }
+
+
+    SparseVector& operator=(SparseVector&& other)
+    {
+        this->size_xyz             = other.size_xyz;
+        this->n_voxels             = other.n_voxels;
+        this->n_blocks_xyz         = other.n_blocks_xyz;
+        this->brick_size           = other.brick_size;
+        this->brick_mask           = other.brick_mask;
+        this->n_brick_rows_y       = other.n_brick_rows_y;
+        this->blocks_per_brick_row = other.blocks_per_brick_row;
+        this->fill_value           = other.fill_value;
+        this->table                = std::move(other.table);
+        this->block_keys           = std::move(other.block_keys);
+        this->blocks               = std::move(other.blocks);
+        this->last_key             = std::numeric_limits<size_t>::max();
+        this->last_block           = nullptr;
+        return *this;
+    }
+
+
+    /// @brief Number of voxels in the Grid. This matches the size of the equivalent dense vector.
+    size_t size() const
+    {
+        return this->n_voxels;
+    }
+
+
+    /// @brief Number of blocks which have been allocated.
+    size_t numBlocks() const
+    {
+        return this->blocks.size();
+    }
+
+
+    /// @brief Brick size of the Grid's layout the vector indices follow.
+    size_t brickSize() const
+    {
+        return this->brick_size;
+    }
+
+
+    /// @brief Value of every voxel in an unallocated block.
+    const T& fill() const
+    {
+        return this->fill_value;
+    }
+
+
+    /// @brief Writable access to a voxel. Allocates the voxel's block if needed.
+    /// @param i Vector index for the voxel. See `Grid::Properties::at`.
+    /// @return Reference to the voxel's value. This remains valid while the SparseVector exists.
+    T& operator[](const size_t& i)
+    {
+        size_t offset;
+        const size_t key = this->blockKey(i, offset);
+        if (key != this->last_key)
+        {
+            this->last_block = this->findOrAllocate(key);
+            this->last_key   = key;
+        }
+        return (*this->last_block)[offset];
+    }
+
+
+    /// @brief Read-only access to a voxel. Does not allocate.
+    /// @param i Vector index for the voxel. See `Grid::Properties::at`.
+    /// @return Reference to the voxel's value, or to the fill value if its block is not allocated.
+    const T& operator[](const size_t& i) const
+    {
+        size_t offset;
+        const size_t key  = this->blockKey(i, offset);
+        const size_t slot = this->findSlot(key);
+        if (this->table[slot] == SparseVector::empty_slot)
+        {
+            return this->fill_value;
+        }
+        return (*this->blocks[this->table[slot]])[offset];
+    }
+
+
+    /// @brief Calls a function on each distinct stored value.
+    /// @param f Callable with the signature `void(T& value, const size_t& count)`. This is called once
+    ///          for each voxel in an allocated block, with a count of one, and once for the fill value,
+    ///          with a count of the number of voxels it represents.
+    /// @note  Modifying the value modifies the voxel(s) it represents. For a `std::vector` see the
+    ///        matching free function `for_each_value`.
+    template <typename Function>
+    void forEachValue(Function&& f)
+    {
+        size_t n_allocated = 0;
+        for (size_t b = 0; b < this->blocks.size(); ++b)
+        {
+            this->forEachVoxelInBlock(b, [&](const size_t&, const size_t& offset)
+            {
+                f((*this->blocks[b])[offset], 1);
+                ++n_allocated;
+            });
+        }
+        f(this->fill_value, this->n_voxels - n_allocated);
+    }
+
+
+    /// @brief Creates the equivalent dense vector.
+    /// @return Vector of `size()` elements.
+    std::vector<T> toDense() const
+    {
+        std::vector<T> dense(this->n_voxels, this->fill_value);
+        for (size_t b = 0; b < this->blocks.size(); ++b)
+        {
+            this->forEachVoxelInBlock(b, [&](const size_t& i, const size_t& offset)
+            {
+                dense[i] = (*this->blocks[b])[offset];
+            });
+        }
+        return dense;
+    }
+
+
+    /// @brief Compares the value of every voxel, regardless of which blocks are allocated.
+    bool operator==(const SparseVector& other) const
+    {
+        if (this->n_voxels != other.n_voxels)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < this->n_voxels; ++i)
+        {
+            if (!((*this)[i] == other[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    bool operator!=(const SparseVector& other) const
+    {
+        return !(*this == other);
+    }
+
+
+    /// @brief Number of bytes used by allocated blocks and the hash map.
+    size_t sizeBytes() const
+    {
+        return sizeof(Block) * this->blocks.size() + sizeof(size_t) * (this->table.size() + this->block_keys.size());
+    }
+
+
+    /// @brief Number of bytes reserved by allocated blocks and the hash map, including capacity.
+    size_t capacityBytes() const
+    {
+        return sizeof(Block) * this->blocks.size() + sizeof(size_t) * (this->table.capacity() + this->block_keys.capacity()) +
+               sizeof(std::unique_ptr<Block>) * this->blocks.capacity();
+    }
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Finds the block key and the offset within the block for a vector index.
+    /// @param i Vector index for the voxel.
+    /// @param [out] offset Position of the voxel within its block.
+    /// @return Key of the block. For the linear layout this is its linear index in the Grid of
+    ///         blocks. For a bricked layout it counts blocks along each row of bricks, then rows.
+    size_t blockKey(const size_t& i, size_t& offset) const
+    {
+        static constexpr size_t mask = SparseVector::block_width - 1;
+
+        if (this->brick_size > 1)
+        {
+            // Find the row of bricks as `Grid::Properties::vectorToIndex` does, then the position in it.
+            const size_t plane = this->size_xyz[0] * this->size_xyz[1];
+            const size_t z0 = (i / plane) & ~this->brick_mask;
+            const size_t wz = std::min(this->brick_size, this->size_xyz[2] - z0);
+            const size_t r  = i - z0 * plane;
+            const size_t y0 = (r / (this->size_xyz[0] * wz)) & ~this->brick_mask;
+            const size_t in_row = r - y0 * this->size_xyz[0] * wz;
+
+            const size_t row = (z0 / this->brick_size) * this->n_brick_rows_y + y0 / this->brick_size;
+            offset = in_row % SparseVector::block_volume;
+            return row * this->blocks_per_brick_row + in_row / SparseVector::block_volume;
+        }
+
+        const size_t x  = i % this->size_xyz[0];
+        const size_t yz = i / this->size_xyz[0];
+        const size_t y  = yz % this->size_xyz[1];
+        const size_t z  = yz / this->size_xyz[1];
+
+        offset = (x & mask) | ((y & mask) << block_bits) | ((z & mask) << (2 * block_bits));
+        return (x >> block_bits) + this->n_blocks_xyz[0] * ((y >> block_bits) + this->n_blocks_xyz[1] * (z >> block_bits));
+    }
+
+
+    /// @brief Calls a function for each voxel in a block which is within the Grid.
+    /// @param b Position of the block in `blocks`.
+    /// @param f Callable with the signature `void(const size_t& i, const size_t& offset)`, for the
+    ///          voxel's vector index and position in the block.
+    template <typename Function>
+    void forEachVoxelInBlock(const size_t& b, Function&& f) const
+    {
+        const size_t key = this->block_keys[b];
+        if (this->brick_size > 1)
+        {
+            const size_t row = key / this->blocks_per_brick_row;
+            const size_t z0  = (row / this->n_brick_rows_y) * this->brick_size;
+            const size_t y0  = (row % this->n_brick_rows_y) * this->brick_size;
+            const size_t wz  = std::min(this->brick_size, this->size_xyz[2] - z0);
+            const size_t wy  = std::min(this->brick_size, this->size_xyz[1] - y0);
+
+            const size_t row_start = z0 * this->size_xyz[0] * this->size_xyz[1] + y0 * this->size_xyz[0] * wz;
+            const size_t first     = row_start + (key % this->blocks_per_brick_row) * SparseVector::block_volume;
+            const size_t last      = std::min(first + SparseVector::block_volume,
+                                              row_start + this->size_xyz[0] * wy * wz);
+            for (size_t i = first; i < last; ++i)
+            {
+                f(i, i - first);
+            }
+            return;
+        }
+
+        const size_t x0  = (key % this->n_blocks_xyz[0]) << block_bits;
+        const size_t y0  = ((key / this->n_blocks_xyz[0]) % this->n_blocks_xyz[1]) << block_bits;
+        const size_t z0  = (key / (this->n_blocks_xyz[0] * this->n_blocks_xyz[1])) << block_bits;
+
+        const size_t x1 = std::min(x0 + block_width, this->size_xyz[0]);
+        const size_t y1 = std::min(y0 + block_width, this->size_xyz[1]);
+        const size_t z1 = std::min(z0 + block_width, this->size_xyz[2]);
+
+        for (size_t z = z0; z < z1; ++z)
+        {
+            for (size_t y = y0; y < y1; ++y)
+            {
+                size_t i      = x0 + this->size_xyz[0] * (y + this->size_xyz[1] * z);
+                size_t offset = ((y - y0) << block_bits) | ((z - z0) << (2 * block_bits));
+                for (size_t x = x0; x < x1; ++x, ++i, ++offset)
+                {
+                    f(i, offset);
+                }
+            }
+        }
+    }
+
+
+    /// @brief Hashes a block key to its starting slot in the table.
+    size_t hash(const size_t& key) const
+    {
+        // Fibonacci hashing spreads the sequential keys of neighboring blocks across the table.
+        return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 32) & (this->table.size() - 1);
+    }
+
+
+    /// @brief Finds the slot holding the key, or the empty slot where it would be inserted.
+    size_t findSlot(const size_t& key) const
+    {
+        const size_t mask = this->table.size() - 1;
+        size_t slot = this->hash(key);
+        while (this->table[slot] != SparseVector::empty_slot && this->block_keys[this->table[slot]] != key)
+        {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+
+    /// @brief Finds the block for a key, allocating it with the fill value if it does not exist.
+    Block* findOrAllocate(const size_t& key)
+    {
+        size_t slot = this->findSlot(key);
+        if (this->table[slot] == SparseVector::empty_slot)
+        {
+            // Keep the load factor at or below one half so probe sequences stay short.
+            if (2 * (this->blocks.size() + 1) > this->table.size())
+            {
+                this->rehash(2 * this->table.size());
+                slot = this->findSlot(key);
+            }
+            this->table[slot] = this->blocks.size();
+            this->block_keys.push_back(key);
+            this->blocks.push_back(std::make_unique<Block>());
+            this->blocks.back()->fill(this->fill_value);
+        }
+        return this->blocks[this->table[slot]].get();
+    }
+
+
+    /// @brief Rebuilds the hash map with a new number of slots.
+    /// @param n_slots New number of slots. Must be a power of two.
+    void rehash(const size_t& n_slots)
+    {
+        this->table.assign(n_slots, SparseVector::empty_slot);
+        for (size_t b = 0; b < this->block_keys.size(); ++b)
+        {
+            this->table[this->findSlot(this->block_keys[b])] = b;
+        }
+    }
+
+
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Number of voxels in the Grid in each direction.
+    GridSize size_xyz;
+
+    /// @brief Total number of voxels in the Grid.
+    size_t n_voxels;
+
+    /// @brief Number of blocks needed to cover the Grid in each direction.
+    GridSize n_blocks_xyz;
+
+    /// @brief Brick size of the Grid's layout, and the mask for a position within a brick.
+    size_t brick_size, brick_mask;
+
+    /// @brief Number of rows of bricks in each layer of bricks, for a bricked layout.
+    size_t n_brick_rows_y;
+
+    /// @brief Number of blocks needed to cover the longest row of bricks, for a bricked layout.
+    size_t blocks_per_brick_row;
+
+    /// @brief Value of every voxel in an unallocated block.
+    T fill_value;
+
+    /// @brief Open-addressing hash map from a block key to the block's position in `blocks`.
+    std::vector<size_t> table;
+
+    /// @brief Key of each allocated block, in allocation order.
+    std::vector<size_t> block_keys;
+
+    /// @brief Allocated blocks. These are held by pointer so references to voxels stay valid
+    ///        when more blocks are allocated.
+    std::vector<std::unique_ptr<Block>> blocks;
+
+    /// @brief Cache of the most recently accessed block. Consecutive voxels of a ray usually
+    ///        share a block so this skips most hash map lookups.
+    size_t last_key   = std::numeric_limits<size_t>::max();
+    Block* last_block = nullptr;
+
+    /// @brief Marks an unused slot of the hash map.
+    static constexpr size_t empty_slot = std::numeric_limits<size_t>::max();
+
+    /// @brief Initial number of slots in the hash map. Must be a power of two.
+    static constexpr size_t initial_table_size = 64;
+};
+
+
+/// @brief Calls a function on each value of a dense vector. See `SparseVector::forEachValue`.
+/// @param vector Vector to visit.
+/// @param f Callable with the signature `void(T& value, const size_t& count)`. The count is always one.
+template <typename T, typename Function>
+inline void for_each_value(std::vector<T>& vector, Function&& f)
+{
+    for (auto& value : vector)
+    {
+        f(value, 1);
+    }
+}
+
+
+/// @brief Calls a function on each distinct value of a sparse vector. See `SparseVector::forEachValue`.
+/// @param vector Vector to visit.
+/// @param f Callable with the signature `void(T& value, const size_t& count)`.
+template <typename T, typename Function>
+inline void for_each_value(SparseVector<T>& vector, Function&& f)
+{
+    vector.forEachValue(std::forward<Function>(f));
+}
+
+
+namespace utilities {
+namespace memory_use {
+
+
+/// @brief Finds the memory usage of a SparseVector.
+/// @param vec SparseVector of any type.
+/// @return The number of bytes used by the allocated blocks of the vector.
+template<typename T>
+inline size_t vector_size(const SparseVector<T>& vec)
+{
+    return vec.sizeBytes();
+}
+
+
+/// @brief Finds the memory usage of a SparseVector.
+/// @param vec SparseVector of any type.
+/// @return The number of bytes used by the allocated blocks of the vector, including capacity.
+template<typename T>
+inline size_t vector_capacity(const SparseVector<T>& vec)
+{
+    return vec.capacityBytes();
+}
+
+
+} // namespace memory_use
+} // namespace utilities
+
+
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_COMMON_SPARSE_VECTOR_HPP
@@ -0,0 +1,674 @@
+#ifndef FORGE_SCAN_COMMON_TRACE_BATCH_HPP
+#define FORGE_SCAN_COMMON_TRACE_BATCH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "ForgeScan/Common/RayTrace.hpp"
+
+
+namespace forge_scan {
+
+
+/// @brief Collection of traces for many rays stored as a flat structure-of-arrays.
+/// @details Voxel indices and distances for all rays are stored back to back in two arrays. The
+///          voxels of ray `r` are in the range `[offset[r], offset[r + 1])` and, as with a Trace,
+///          are sorted in ascending distance from the ray's sensed point. Only rays which
+///          intersected the Grid are stored.
+/// @note    Indices are 32-bit. `get_ray_trace_batch` throws for Grids with more voxels than this
+///          can hold; those must use the per-ray `get_ray_trace`.
+struct TraceBatch
+{
+    /// @details Required to append traced rays into the batch.
+    friend size_t get_ray_trace_batch(const std::shared_ptr<TraceBatch>&, const PointMatrix&, const Point&,
+                                      const std::shared_ptr<const Grid::Properties>&, const float&, const float&,
+                                      const size_t&, const size_t&, const OccupancyPyramid*, const float&,
+                                      const uint32_t*);
+
+
+    /// @brief Largest number of voxels a Grid may have to be traced into a TraceBatch.
+    static constexpr size_t max_num_voxels = static_cast<size_t>(std::numeric_limits<uint32_t>::max());
+
+
+    /// @brief Voxel information within a TraceBatch. Mirrors `TraceVoxel` so the UpdateCallable of a
+    ///        VoxelGrid may treat either the same way.
+    struct Voxel
+    {
+        /// @brief Vector index for the voxel. See `Grid::Properties::at`.
+        size_t i;
+
+        /// @brief Distance from the voxel to the sensed point.
+        float  d;
+
+        /// @brief Allows `iter->i` and `iter->d` access through the iterator's returned value.
+        const Voxel* operator->() const
+        {
+            return this;
+        }
+    };
+
+
+    /// @brief Read-only iterator over the voxels of one ray in the batch.
+    class const_iterator
+    {
+    public:
+        const_iterator(const uint32_t* index, const float* dist)
+            : index(index), dist(dist)
+        {
+
+        }
+
+        Voxel operator*()  const { return Voxel{*this->index, *this->dist}; }
+        Voxel operator->() const { return Voxel{*this->index, *this->dist}; }
+
+        const_iterator& operator++()
+        {
+            ++this->index;
+            ++this->dist;
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return this->dist == other.dist; }
+        bool operator!=(const const_iterator& other) const { return this->dist != other.dist; }
+
+    private:
+        /// @details Required to binary search over the distance array.
+        friend struct TraceBatch;
+
+        const uint32_t* index;
+        const float*    dist;
+    };
+
+
+    /// @brief A view of one ray in the batch. This provides the same read-only interface as a
+    ///        Trace so the same update code may be used for either.
+    class Ray
+    {
+    public:
+        Ray(const TraceBatch& batch, const size_t& r)
+            : first(batch.index.data() + batch.offset[r], batch.dist.data() + batch.offset[r]),
+              last(batch.index.data() + batch.offset[r + 1], batch.dist.data() + batch.offset[r + 1]),
+              sensed_point(batch.sensed_point[r]),
+              sensed_location(batch.sensed_location[r]),
+              n_samples(batch.weight[r])
+        {
+
+        }
+
+        const_iterator begin() const { return this->first; }
+        const_iterator end()   const { return this->last;  }
+
+        /// @brief Number of voxels on the ray.
+        size_t size() const
+        {
+            return static_cast<size_t>(this->last.dist - this->first.dist);
+        }
+
+        /// @brief True if the ray has no voxels.
+        bool empty() const
+        {
+            return this->first == this->last;
+        }
+
+        /// @brief Checks if the sensed point is on the ray. See `Trace::hasSensed`.
+        bool hasSensed() const
+        {
+            return this->sensed_location == Trace::SensedLocation::IN;
+        }
+
+        /// @brief Gets the point location for the ray's sensed point. See `Trace::sensedPoint`.
+        const Point& sensedPoint() const
+        {
+            return this->sensed_point;
+        }
+
+        /// @brief Number of rays this one stands in for. One unless the rays of an update were
+        ///        merged by their sensed voxel, see `data::Reconstruction::setEndpointMerge`.
+        uint32_t weight() const
+        {
+            return this->n_samples;
+        }
+
+        /// @brief Finds the voxel at a distance greater than the specified value.
+        /// @param dist Threshold distance.
+        /// @return First voxel with a value greater than the specified distance threshold.
+        ///         Or the `end` iterator if all values are below the distance threshold.
+        /// @note Unlike `Trace::first_above`, this is a binary search rather than a linear scan.
+        const_iterator first_above(const float& dist) const
+        {
+            return this->first_above(dist, this->first);
+        }
+
+        /// @brief Finds the voxel at a distance greater than the specified value.
+        /// @param dist  Threshold distance.
+        /// @param start Iterator, from this ray, to begin the search from.
+        /// @return First voxel with a value greater than the specified distance threshold.
+        ///         Or the `end` iterator if all values are below the distance threshold.
+        const_iterator first_above(const float& dist, const const_iterator& start) const
+        {
+            if (dist == INFINITY)
+            {
+                return this->last;
+            }
+            const float* found = std::lower_bound(start.dist, this->last.dist, dist);
+            return const_iterator(start.index + (found - start.dist), found);
+        }
+
+    private:
+        const_iterator first, last;
+
+        const Point& sensed_point;
+
+        const Trace::SensedLocation sensed_location;
+
+        const uint32_t n_samples;
+    };
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    TraceBatch()
+    {
+        this->clear();
+    }
+
+
+    /// @brief Removes all rays from the batch. Allocated capacity is retained for reuse.
+    void clear()
+    {
+        this->index.clear();
+        this->dist.clear();
+        this->offset.assign(1, 0);
+        this->sensed_point.clear();
+        this->sensed_index.clear();
+        this->sensed_location.clear();
+        this->weight.clear();
+    }
+
+
+    /// @brief Reserves capacity for the batch.
+    /// @param n_rays   Expected number of rays.
+    /// @param n_voxels Expected total number of voxels across all rays.
+    void reserve(const size_t& n_rays, const size_t& n_voxels)
+    {
+        this->index.reserve(n_voxels);
+        this->dist.reserve(n_voxels);
+        this->offset.reserve(n_rays + 1);
+        this->sensed_point.reserve(n_rays);
+        this->sensed_index.reserve(n_rays);
+        this->sensed_location.reserve(n_rays);
+        this->weight.reserve(n_rays);
+    }
+
+
+    /// @brief Number of rays stored in the batch.
+    size_t numRays() const
+    {
+        return this->offset.size() - 1;
+    }
+
+
+    /// @brief Total number of voxels stored across all rays in the batch.
+    size_t numVoxels() const
+    {
+        return this->index.size();
+    }
+
+
+    /// @brief Number of bytes reserved by the batch, including capacity kept for reuse.
+    size_t capacityBytes() const
+    {
+        return sizeof(uint32_t) * this->index.capacity()        +
+               sizeof(float)    * this->dist.capacity()         +
+               sizeof(size_t)   * this->offset.capacity()       +
+               sizeof(Point)    * this->sensed_point.capacity() +
+               sizeof(uint32_t) * this->sensed_index.capacity() +
+               sizeof(Trace::SensedLocation) * this->sensed_location.capacity() +
+               sizeof(uint32_t) * this->weight.capacity();
+    }
+
+
+    /// @brief Gets a view of a ray in the batch.
+    /// @param r Position of the ray in the batch. Must be less than `numRays`.
+    /// @return View of the ray's voxels and sensed point information.
+    Ray ray(const size_t& r) const
+    {
+        return Ray(*this, r);
+    }
+
+
+    /// @brief Vector index of the sensed voxel for a ray. Only valid if the ray has the sensed point.
+    /// @param r Position of the ray in the batch. Must be less than `numRays`.
+    size_t sensedIndex(const size_t& r) const
+    {
+        return this->sensed_index[r];
+    }
+
+
+    /// @brief Splits the batch into pieces, appending each voxel to the piece its index maps to. The
+    ///        order of rays, and of voxels within each ray, is preserved in every piece.
+    /// @param pieces   First of `n_pieces` batches to append to. These are not cleared first.
+    /// @param n_pieces Number of pieces.
+    /// @param piece_of Callable taking a voxel's vector index and returning its piece, less than `n_pieces`.
+    /// @note  A ray's sensed point is only kept in the piece of the sensed voxel. Rays left with no
+    ///        voxels and no sensed point in a piece are not added to that piece.
+    /// @note  This is used to split a batch into spatially disjoint pieces for a parallel update.
+    template <typename PieceOf>
+    void scatter(const std::shared_ptr<TraceBatch>* pieces, const size_t& n_pieces, const PieceOf& piece_of) const
+    {
+        for (size_t r = 0; r < this->numRays(); ++r)
+        {
+            for (size_t v = this->offset[r]; v < this->offset[r + 1]; ++v)
+            {
+                TraceBatch& piece = *pieces[piece_of(this->index[v])];
+                piece.index.push_back(this->index[v]);
+                piece.dist.push_back(this->dist[v]);
+            }
+
+            const bool   has_sensed   = this->sensed_location[r] == Trace::SensedLocation::IN;
+            const size_t sensed_piece = has_sensed ? piece_of(this->sensed_index[r]) : n_pieces;
+            for (size_t p = 0; p < n_pieces; ++p)
+            {
+                TraceBatch& piece = *pieces[p];
+                const bool keep_sensed = p == sensed_piece;
+                if (piece.index.size() != piece.offset.back() || keep_sensed)
+                {
+                    piece.offset.push_back(piece.index.size());
+                    piece.sensed_point.push_back(this->sensed_point[r]);
+                    piece.sensed_index.push_back(this->sensed_index[r]);
+                    piece.sensed_location.push_back(keep_sensed ? Trace::SensedLocation::IN :
+                                                                  Trace::SensedLocation::UNKNOWN);
+                    piece.weight.push_back(this->weight[r]);
+                }
+            }
+        }
+    }
+
+
+    /// @brief Appends all rays of another batch.
+    /// @param other Batch to copy rays from.
+    void append(const TraceBatch& other)
+    {
+        const size_t n_start = this->index.size();
+        this->index.insert(this->index.end(), other.index.begin(), other.index.end());
+        this->dist.insert(this->dist.end(), other.dist.begin(), other.dist.end());
+        for (size_t r = 1; r < other.offset.size(); ++r)
+        {
+            this->offset.push_back(n_start + other.offset[r]);
+        }
+        this->sensed_point.insert(this->sensed_point.end(), other.sensed_point.begin(), other.sensed_point.end());
+        this->sensed_index.insert(this->sensed_index.end(), other.sensed_index.begin(), other.sensed_index.end());
+        this->sensed_location.insert(this->sensed_location.end(),
+                                     other.sensed_location.begin(), other.sensed_location.end());
+        this->weight.insert(this->weight.end(), other.weight.begin(), other.weight.end());
+    }
+
+
+    /// @brief Appends a ray made of the provided voxels, without a sensed point.
+    /// @param voxels Voxels of the ray. These must be sorted in ascending distance.
+    /// @note  This is used by the projective update, which gathers the voxels of one block of the
+    ///        Grid as a ray. Each voxel's distance is then to its own pixel's sensed point.
+    void appendRay(const std::vector<Voxel>& voxels)
+    {
+        for (const auto& voxel : voxels)
+        {
+            this->index.push_back(static_cast<uint32_t>(voxel.i));
+            this->dist.push_back(voxel.d);
+        }
+        this->offset.push_back(this->index.size());
+        this->sensed_point.push_back(Point::Constant(-1));
+        this->sensed_index.push_back(0);
+        this->sensed_location.push_back(Trace::SensedLocation::UNKNOWN);
+        this->weight.push_back(1);
+    }
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Vector index of each voxel, for all rays.
+    std::vector<uint32_t> index;
+
+    /// @brief Distance from each voxel to its ray's sensed point, for all rays.
+    std::vector<float> dist;
+
+    /// @brief Start position of each ray in `index` and `dist`. Has `numRays() + 1` elements.
+    std::vector<size_t> offset;
+
+    /// @brief Sensed point of each ray.
+    std::vector<Point> sensed_point;
+
+    /// @brief Vector index of the sensed voxel of each ray. Only valid if the sensed location is IN.
+    std::vector<uint32_t> sensed_index;
+
+    /// @brief Location of each ray's sensed point relative to its traced voxels.
+    std::vector<Trace::SensedLocation> sensed_location;
+
+    /// @brief Number of rays each ray stands in for. See `Ray::weight`.
+    std::vector<uint32_t> weight;
+};
+
+
+namespace ray_trace_helpers {
+
+
+/// @brief Rays of a TraceBatch which are stepped through the Grid together by `trace_packet`.
+/// @details Each member holds one value per ray, or lane, so the loop over the lanes of a step
+///          is made of independent, same-typed operations. Compilers auto-vectorize this loop
+///          without any ISA-specific flags or intrinsics.
+struct RayPacket
+{
+    /// @brief Number of rays in a packet.
+    static constexpr size_t width = 8;
+
+    /// @brief Distance at which each ray leaves its current voxel along X, Y and Z.
+    float dist[3][width];
+
+    /// @brief Distance to move one voxel length along X, Y and Z, for each ray.
+    float delta[3][width];
+
+    /// @brief Largest distance, relative to its sensed point, to trace each ray.
+    float dist_max[width];
+
+    /// @brief Distance at which each ray entered its current voxel.
+    float d_entry[width];
+
+    /// @brief Change in vector index for a step along X, Y and Z, for each ray. Negative steps wrap.
+    uint32_t index_step[3][width];
+
+    /// @brief Steps left along X, Y and Z before each ray leaves the Grid or passes its `dist_max`.
+    uint32_t steps_left[3][width];
+
+    /// @brief Vector index of each ray's current voxel.
+    uint32_t v_idx[width];
+
+    /// @brief Number of voxels each ray has emitted.
+    uint32_t n_voxels[width];
+
+    /// @brief One while the ray is still being traced, zero once it has ended.
+    uint32_t active[width];
+};
+
+
+/// @brief Sets up one lane of a RayPacket from the start of its traversal.
+/// @param [out] packet Packet to set the lane of.
+/// @param l      Lane to set.
+/// @param start  Start of the ray's traversal. See `start_traversal`.
+/// @param properties Shared `Grid::Properties` for the VoxelGrids begin traversed.
+/// @return Upper bound on the number of voxels the ray will emit.
+/// @throws VoxelOutOfRange If the first voxel is not in the Grid. This should not happen.
+/// @details The ray is clipped to the Grid here, by counting the steps left along each axis until
+///          the Grid's face. The count is also capped by how many voxel boundaries the ray can cross
+///          before `dist_max`, with a margin for rounding, so buffers may be sized to it. The packet
+///          loop stops a ray when it would step an axis with no steps left, so it never needs to
+///          check its voxels against the Grid's size.
+/// @warning This should only be called by `get_ray_trace_batch`.
+inline size_t set_packet_lane(RayPacket& packet, const size_t& l, const TraversalStart& start,
+                              const std::shared_ptr<const Grid::Properties>& properties)
+{
+    packet.v_idx[l]    = static_cast<uint32_t>(properties->at(start.c_idx));
+    packet.d_entry[l]  = start.dist_min_adj;
+    packet.dist_max[l] = start.dist_max_adj;
+    packet.n_voxels[l] = 0;
+    packet.active[l]   = 1;
+
+    std::ptrdiff_t index_step[3];
+    get_index_step(index_step, start.step, start.c_idx, properties);
+
+    size_t n_steps = 0;
+    for (size_t d = 0; d < 3; ++d)
+    {
+        const size_t to_face = start.step[d] > 0 ? properties->size[d] - 1 - start.c_idx[d] : start.c_idx[d];
+        const float  to_end  = start.dist[d] <= start.dist_max_adj ?
+                               (start.dist_max_adj - start.dist[d]) / start.delta[d] + 2.0f : 0.0f;
+        // Capped again once an integer, as the float conversion may round a large count up.
+        const size_t left = static_cast<size_t>(std::min(to_end, static_cast<float>(to_face)));
+
+        packet.dist[d][l]       = start.dist[d];
+        packet.delta[d][l]      = start.delta[d];
+        packet.index_step[d][l] = static_cast<uint32_t>(index_step[d]);
+        packet.steps_left[d][l] = static_cast<uint32_t>(std::min(left, to_face));
+        n_steps += packet.steps_left[d][l];
+    }
+    return n_steps + 1;
+}
+
+
+/// @brief Sets a lane of a RayPacket which has no ray, or whose ray missed the Grid.
+/// @param [out] packet Packet to set the lane of.
+/// @param l Lane to set.
+/// @warning This should only be called by `get_ray_trace_batch`.
+inline void clear_packet_lane(RayPacket& packet, const size_t& l)
+{
+    for (size_t d = 0; d < 3; ++d)
+    {
+        packet.dist[d][l]       = INFINITY;
+        packet.delta[d][l]      = INFINITY;
+        packet.index_step[d][l] = 0;
+        packet.steps_left[d][l] = 0;
+    }
+    packet.dist_max[l] = -INFINITY;
+    packet.d_entry[l]  = INFINITY;
+    packet.v_idx[l]    = 0;
+    packet.n_voxels[l] = 0;
+    packet.active[l]   = 0;
+}
+
+
+/// @brief Selects between two floats by a mask, without a branch.
+/// @param mask All one bits to select `a`, or all zero bits to select `b`.
+/// @warning This should only be called by `trace_packet`.
+inline float select(const uint32_t& mask, const float& a, const float& b)
+{
+    uint32_t bits_a, bits_b;
+    std::memcpy(&bits_a, &a, sizeof(float));
+    std::memcpy(&bits_b, &b, sizeof(float));
+    const uint32_t bits = (bits_a & mask) | (bits_b & ~mask);
+    float out;
+    std::memcpy(&out, &bits, sizeof(float));
+    return out;
+}
+
+
+/// @brief Steps the rays of a packet through the Grid together until all have ended.
+/// @param packet Packet of rays, set up by `set_packet_lane` or `clear_packet_lane`.
+/// @param index  Start of the output of each lane's voxel indices.
+/// @param dist   Start of the output of each lane's voxel distances.
+/// @param first  Position in `index` and `dist` of each lane's first voxel. Each lane must have room
+///               for one more than the voxels it may emit, as ended lanes keep writing one past their last.
+/// @details Each step stores every lane's current voxel and then advances every lane along the axis of
+///          its nearest voxel boundary. This is the same Amanatides-Woo step as `traverse`, made the
+///          same for every lane with selects in place of branches, so each ray's voxels and distances
+///          are identical to tracing it alone. The stores are kept out of the stepping loop as each
+///          lane writes to a different place.
+/// @warning This should only be called by `get_ray_trace_batch`.
+inline void trace_packet(RayPacket& packet, uint32_t* index, float* dist, const size_t* first)
+{
+    static constexpr size_t W = RayPacket::width;
+
+    uint32_t any_active = 1;
+    while (any_active)
+    {
+        for (size_t l = 0; l < W; ++l)
+        {
+            index[first[l] + packet.n_voxels[l]] = packet.v_idx[l];
+            dist[first[l]  + packet.n_voxels[l]] = packet.d_entry[l];
+        }
+
+        any_active = 0;
+        for (size_t l = 0; l < W; ++l)
+        {
+            packet.n_voxels[l] += packet.active[l];
+
+            const float    dx = packet.dist[0][l],       dy = packet.dist[1][l],       dz = packet.dist[2][l];
+            const uint32_t lx = packet.steps_left[0][l], ly = packet.steps_left[1][l], lz = packet.steps_left[2][l];
+
+            // The same choice of axis as `get_min_dist`, as masks of all zero or all one bits.
+            const uint32_t on_x = 0u - ((dx < dy) & (dx < dz));
+            const uint32_t on_y = ~on_x & (0u - (dy < dz));
+            const uint32_t on_z = ~on_x & ~on_y;
+
+            const float    d_next = select(on_x, dx, select(on_y, dy, dz));
+            const uint32_t left   = (on_x & lx) | (on_y & ly) | (on_z & lz);
+            const uint32_t active = 0u - (packet.active[l] & (d_next <= packet.dist_max[l]) & (left != 0));
+
+            const uint32_t step_x = on_x & active, step_y = on_y & active, step_z = on_z & active;
+            packet.v_idx[l] += (step_x & packet.index_step[0][l]) |
+                               (step_y & packet.index_step[1][l]) |
+                               (step_z & packet.index_step[2][l]);
+            packet.steps_left[0][l] = lx - (step_x & 1);
+            packet.steps_left[1][l] = ly - (step_y & 1);
+            packet.steps_left[2][l] = lz - (step_z & 1);
+            packet.dist[0][l] = select(step_x, dx + packet.delta[0][l], dx);
+            packet.dist[1][l] = select(step_y, dy + packet.delta[1][l], dy);
+            packet.dist[2][l] = select(step_z, dz + packet.delta[2][l], dz);
+            packet.d_entry[l] = select(active, d_next, packet.d_entry[l]);
+            packet.active[l]  = active & 1;
+            any_active |= active;
+        }
+    }
+}
+
+
+} // namespace ray_trace_helpers
+
+
+/// @brief Calculates what voxels are hit by each ray between a sensed point and the origin and
+///        appends them to the batch.
+/// @param [out] trace_batch Batch to append the traced rays to. This is not cleared first.
+/// @param sensed_points A set of measurements which act as the start for a collection of rays.
+/// @param origin Origin point, the end of each ray.
+/// @param properties Shared `Grid::Properties` for the VoxelGrids begin traversed.
+/// @param dist_min Minimum distance to trace along each ray, relative to its `sensed` point.
+/// @param dist_max Maximum distance to trace along each ray, relative to its `sensed` point.
+/// @param first_col First column of `sensed_points` to trace.
+/// @param n_cols    Number of columns of `sensed_points`, starting at `first_col`, to trace.
+/// @param skip_pyramid Optional pyramid whose free cells, past `skip_dist`, are left out of the traces.
+/// @param skip_dist Distance past which voxels may be left out of the traces.
+/// @param weights Optional weight of each column of `sensed_points`, see `TraceBatch::Ray::weight`.
+///                If null each ray has a weight of one.
+/// @return Number of rays which intersected the Grid and were appended.
+/// @throws GridPropertyError If the Grid has too many voxels for 32-bit indices.
+/// @note  For the linear layout without a `skip_pyramid`, rays are traced a RayPacket at a time. The
+///        voxels and distances are the same as tracing each ray alone with `get_ray_trace`.
+inline size_t get_ray_trace_batch(const std::shared_ptr<TraceBatch>& trace_batch,
+                                  const PointMatrix& sensed_points, const Point& origin,
+                                  const std::shared_ptr<const Grid::Properties>& properties,
+                                  const float& dist_min, const float& dist_max,
+                                  const size_t& first_col, const size_t& n_cols,
+                                  const OccupancyPyramid* skip_pyramid = nullptr, const float& skip_dist = INFINITY,
+                                  const uint32_t* weights = nullptr)
+{
+    if (properties->getNumVoxels() > TraceBatch::max_num_voxels)
+    {
+        throw GridPropertyError("Grid Properties have too many voxels to use 32-bit indices in a TraceBatch.");
+    }
+
+    size_t n_valid = 0;
+    auto add_ray = [&](const size_t& c, const Trace::SensedLocation& sensed_location, const size_t& end)
+    {
+        const Point sensed = sensed_points.col(c);
+        const bool has_sensed = sensed_location == Trace::SensedLocation::IN;
+        trace_batch->offset.push_back(end);
+        trace_batch->sensed_point.push_back(sensed);
+        trace_batch->sensed_index.push_back(has_sensed ? static_cast<uint32_t>(properties->at(sensed)) : 0);
+        trace_batch->sensed_location.push_back(sensed_location);
+        trace_batch->weight.push_back(weights ? weights[c] : 1);
+        ++n_valid;
+    };
+
+    // The packet steps assume the vector index changes by a constant stride along each axis and that
+    // every voxel is emitted. So bricked layouts and skipping free space use the per-ray traversal.
+    if (!properties->isLinear() || skip_pyramid != nullptr)
+    {
+        auto emit = [&trace_batch](const size_t& i, const float& d)
+        {
+            trace_batch->index.push_back(static_cast<uint32_t>(i));
+            trace_batch->dist.push_back(d);
+        };
+
+        for (size_t c = first_col; c < first_col + n_cols; ++c)
+        {
+            const Point sensed = sensed_points.col(c);
+            Trace::SensedLocation sensed_location = Trace::SensedLocation::UNKNOWN;
+            if (ray_trace_helpers::traverse(sensed, origin, properties, dist_min, dist_max, emit, sensed_location,
+                                            skip_pyramid, skip_dist))
+            {
+                add_ray(c, sensed_location, trace_batch->index.size());
+            }
+        }
+        return n_valid;
+    }
+
+    static constexpr size_t W = ray_trace_helpers::RayPacket::width;
+    ray_trace_helpers::RayPacket packet;
+    ray_trace_helpers::TraversalStart start[W];
+    bool   valid[W];
+    size_t first[W];
+
+    for (size_t c0 = first_col; c0 < first_col + n_cols; c0 += W)
+    {
+        // Each lane is given room for as many voxels as it may emit, plus the one ended lanes write to.
+        const size_t n_start = trace_batch->index.size();
+        size_t n_room = 0;
+        for (size_t l = 0; l < W; ++l)
+        {
+            const size_t c = c0 + l;
+            valid[l] = c < first_col + n_cols &&
+                       ray_trace_helpers::start_traversal(sensed_points.col(c), origin, properties,
+                                                          dist_min, dist_max, start[l]);
+            first[l] = n_room;
+            try
+            {
+                n_room += valid[l] ? ray_trace_helpers::set_packet_lane(packet, l, start[l], properties) + 1 : 1;
+            }
+            catch (const VoxelOutOfRange& e)
+            {
+                throw VoxelOutOfRange("Ray tracing failed: This should not happen. Failed with: " + std::string(e.what()));
+            }
+            if (!valid[l])
+            {
+                ray_trace_helpers::clear_packet_lane(packet, l);
+            }
+        }
+        trace_batch->index.resize(n_start + n_room);
+        trace_batch->dist.resize(n_start + n_room);
+
+        ray_trace_helpers::trace_packet(packet, trace_batch->index.data() + n_start,
+                                        trace_batch->dist.data() + n_start, first);
+
+        // Moves each lane's voxels down to follow the previous lane's, keeping the rays in order.
+        size_t n_used = n_start;
+        for (size_t l = 0; l < W; ++l)
+        {
+            if (valid[l])
+            {
+                const size_t from = n_start + first[l], n = packet.n_voxels[l];
+                std::copy_n(trace_batch->index.begin() + from, n, trace_batch->index.begin() + n_used);
+                std::copy_n(trace_batch->dist.begin()  + from, n, trace_batch->dist.begin()  + n_used);
+                n_used += n;
+                add_ray(c0 + l, ray_trace_helpers::get_sensed_location(start[l].dist_min_adj, start[l].dist_max_adj),
+                        n_used);
+            }
+        }
+        trace_batch->index.resize(n_used);
+        trace_batch->dist.resize(n_used);
+    }
+    return n_valid;
+}
+
+
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_COMMON_TRACE_BATCH_HPP
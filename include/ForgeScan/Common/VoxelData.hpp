@@ -10,6 +10,8 @@
 
 
 #include "ForgeScan/Common/Exceptions.hpp"
+#include "ForgeScan/Common/MappedVector.hpp"
+#include "ForgeScan/Common/SparseVector.hpp"
 #include "ForgeScan/Utilities/Strings.hpp"
 
 
@@ -37,6 +39,8 @@ DataVariant;
 
 /// @brief Union of std::vectors for the possible types of data, DataVariant, that a VoxelGrid may hold.
 /// @note Each vector only holds one data type. This union interact with it without caring what the Data is until runtime.
+/// @note The SparseVector alternatives are used when the Grid Properties request sparse storage.
+/// @note The MappedVector alternatives are used when the Grid Properties request memory-mapped storage.
 typedef
 std::variant<
     std::vector<int8_t>,
@@ -50,11 +54,63 @@ std::variant<
     std::vector<size_t>,
 
     std::vector<float>,
-    std::vector<double>
+    std::vector<double>,
+
+    SparseVector<int8_t>,
+    SparseVector<int16_t>,
+    SparseVector<int32_t>,
+    SparseVector<int64_t>,
+
+    SparseVector<uint8_t>,
+    SparseVector<uint16_t>,
+    SparseVector<uint32_t>,
+    SparseVector<size_t>,
+
+    SparseVector<float>,
+    SparseVector<double>,
+
+    MappedVector<int8_t>,
+    MappedVector<int16_t>,
+    MappedVector<int32_t>,
+    MappedVector<int64_t>,
+
+    MappedVector<uint8_t>,
+    MappedVector<uint16_t>,
+    MappedVector<uint32_t>,
+    MappedVector<size_t>,
+
+    MappedVector<float>,
+    MappedVector<double>
 >
 VectorVariant;
 
 
+/// @brief Gets direct access to the elements of a data vector, for loops the compiler may vectorize.
+/// @param vector Data vector.
+/// @return Pointer to the elements of a `std::vector` or `MappedVector`. A `SparseVector` has no
+///         contiguous storage, so it is returned as is. Either is indexed the same way.
+/// @note  Loops which store through a `uint8_t` pointer must read through the returned pointer, and
+///        copy any other values they read into locals. Otherwise the compiler must assume each
+///        store may change them and reload them on every iteration.
+template <typename T>
+inline const T* getElements(const std::vector<T>& vector)
+{
+    return vector.data();
+}
+
+template <typename T>
+inline const T* getElements(const MappedVector<T>& vector)
+{
+    return vector.data();
+}
+
+template <typename T>
+inline const SparseVector<T>& getElements(const SparseVector<T>& vector)
+{
+    return vector;
+}
+
+
 /// @brief Identification and type checking for the DataVariants a Grid has or may have.
 /// @note Enumerations beginning with TYPE_* are used for checking types, not for assigning them.
 enum DataType
@@ -243,6 +299,29 @@ inline std::string getNumberPrecisionXDMF(const DataType& x)
 }
 
 
+/// @brief Returns the size, in bytes, of one value of a DataType.
+/// @param x The DataType to get the size of.
+/// @throws DataVariantError if `x` is not recognized as a DataType, or is a type checking DataType.
+inline size_t getDataTypeSize(const DataType& x)
+{
+    switch (x)
+    {
+        case DataType::INT8_T:   return sizeof(int8_t);
+        case DataType::INT16_T:  return sizeof(int16_t);
+        case DataType::INT32_T:  return sizeof(int32_t);
+        case DataType::INT64_T:  return sizeof(int64_t);
+        case DataType::UINT8_T:  return sizeof(uint8_t);
+        case DataType::UINT16_T: return sizeof(uint16_t);
+        case DataType::UINT32_T: return sizeof(uint32_t);
+        case DataType::SIZE_T:   return sizeof(size_t);
+        case DataType::FLOAT:    return sizeof(float);
+        case DataType::DOUBLE:   return sizeof(double);
+        default: break;
+    }
+    throw DataVariantError("DataType \"" + std::to_string(x) + "\" does not have a size.");
+}
+
+
 /// @brief Enumeration for occupancy-style Grids.
 enum VoxelOccupancy
     : uint8_t
@@ -0,0 +1,387 @@
+#ifndef FORGE_SCAN_DATA_CHECKPOINT_HPP
+#define FORGE_SCAN_DATA_CHECKPOINT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define H5_USE_EIGEN 1
+#include <highfive/H5File.hpp>
+
+#include "ForgeScan/Common/Bitset.hpp"
+#include "ForgeScan/Common/Definitions.hpp"
+#include "ForgeScan/Data/Reconstruction.hpp"
+#include "ForgeScan/Data/Snapshot.hpp"
+#include "ForgeScan/Data/VoxelGrids/VoxelGrid.hpp"
+#include "ForgeScan/Utilities/HDF5.hpp"
+
+
+namespace forge_scan {
+namespace data {
+
+
+/// @brief A copy of the channels and seen data of a `data::Reconstruction` which is kept between
+///        saves to one HDF5 file, so each save after the first writes only the chunks of voxels
+///        which changed since the one before.
+/// @details The Reconstruction records which chunks of the Grid its updates change, see
+///          `Reconstruction::enableChangeTracking`. `copy` brings just those chunks of the copy up
+///          to date, and `write` then writes each run of them along X over the data sets an earlier
+///          `write` created, as one hyperslab selection per data set. Chunks are cubes of 16 voxels
+///          per edge, see `Grid::Properties::getNumChunks`. The first write, and any after a channel
+///          is added or removed, writes the whole copy.
+/// @note  `copy` must not be called while the Reconstruction is updated, but `write` may be, from
+///        a different thread, as the copy shares nothing with the Reconstruction. The two must not
+///        be called at once.
+class Checkpoint
+{
+public:
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Creates a Checkpoint of a Reconstruction. Nothing is copied until `copy` is called.
+    /// @param reconstruction Reconstruction to keep a copy of. Its change tracking is enabled.
+    /// @return Shared pointer to the Checkpoint.
+    static std::shared_ptr<Checkpoint> create(const std::shared_ptr<Reconstruction>& reconstruction)
+    {
+        reconstruction->enableChangeTracking();
+        return std::shared_ptr<Checkpoint>(new Checkpoint(reconstruction));
+    }
+
+
+    /// @brief Copies the chunks of the Reconstruction which changed since the last call.
+    /// @return Number of chunks the next `write` will write.
+    /// @note  This takes time in proportion to the changed chunks, not to the Grid. If the channels
+    ///        are not those copied before, each is cloned again and the next `write` writes the
+    ///        whole copy.
+    size_t copy()
+    {
+        const Reconstruction& reconstruction = *this->reconstruction;
+        if (this->full || !this->hasSameChannels())
+        {
+            this->sources.clear();
+            this->channels.clear();
+            this->data_seen = std::make_shared<Bitset>(*reconstruction.data_seen);
+            for (const auto& item : reconstruction.channels)
+            {
+                std::shared_ptr<VoxelGrid> copy = item.second->clone();
+                copy->addSeenData(this->data_seen);
+                this->channels.insert({item.first, copy});
+                this->sources.insert({item.first, item.second});
+            }
+            this->full = true;
+            for (size_t c = 0; c < this->chunks.size(); ++c)
+            {
+                this->chunks.set(c);
+            }
+        }
+        else
+        {
+            this->changed_chunks->forEachSet([&](const size_t& c)
+            {
+                Index lower, upper;
+                this->grid_properties->getChunkBox(c, lower, upper);
+                for (const auto& item : reconstruction.channels)
+                {
+                    this->channels.at(item.first)->copyBox(*item.second, lower, upper);
+                }
+                this->copySeenBox(*reconstruction.data_seen, lower, upper);
+                this->chunks.set(c);
+            });
+            this->copyNeighbors();
+        }
+        this->changed_chunks->reset();
+        this->n_updates     = reconstruction.n_updates;
+        this->window_offset = reconstruction.window_offset;
+        this->channel_args  = reconstruction.channel_args;
+        return this->chunks.count();
+    }
+
+
+    /// @brief Returns true if the next `write` writes the whole copy, rather than its changed chunks
+    ///        into data sets an earlier `write` created.
+    bool isFullWrite() const
+    {
+        return this->full;
+    }
+
+
+    /// @brief Marks the copy to be written whole, such as when the file its chunks were written to
+    ///        is replaced.
+    void markFullWrite()
+    {
+        this->full = true;
+    }
+
+
+    /// @brief Writes the copy into an HDF5 file, as `Reconstruction::save` would have when `copy` was
+    ///        last called.
+    /// @param h5_file An opened HDF5 file. Unless `isFullWrite`, it must hold an earlier `write` of
+    ///                this Checkpoint.
+    /// @param options Chunking and compression for the VoxelGrid data sets. These are only used when
+    ///                the whole copy is written.
+    /// @throws Any exception encountered while writing. The next `write` is then a full one.
+    void write(HighFive::File& h5_file, const utilities::DataSetOptions& options = utilities::DataSetOptions())
+    {
+        const bool was_full = this->full;
+        this->full = true;
+        if (was_full)
+        {
+            Snapshot::write(h5_file, *this->grid_properties, this->n_updates, this->window_offset, *this->data_seen,
+                            this->channels, this->channel_args, options);
+        }
+        else
+        {
+            this->writeChunks(h5_file);
+        }
+
+        this->chunks.reset();
+        this->full = false;
+    }
+
+
+    /// @brief Adds each channel to the XDMF file which accompanies the HDF5 file `write` writes.
+    /// @param file An opened file stream.
+    /// @param hdf5_fname File name (not the full path) of the HDF5 file.
+    void addToXDMF(std::ofstream& file, const std::string& hdf5_fname) const
+    {
+        for (const auto& item : this->channels)
+        {
+            item.second->addToXDMF(file, hdf5_fname, item.first, item.second->getTypeName());
+        }
+    }
+
+
+    /// @brief Gets the copy of a channel as of the last call to `copy`.
+    /// @param name Name of the channel.
+    /// @return Read-only pointer to the copy.
+    /// @throws std::out_of_range If no channel of that name was copied.
+    std::shared_ptr<const VoxelGrid> getChannel(const std::string& name) const
+    {
+        return this->channels.at(name);
+    }
+
+
+    /// @brief Gets the number of updates the Reconstruction had when `copy` was last called.
+    const size_t& getNumUpdates() const
+    {
+        return this->n_updates;
+    }
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Private constructor to enforce shared pointer usage. See `create`.
+    explicit Checkpoint(const std::shared_ptr<Reconstruction>& reconstruction)
+        : reconstruction(reconstruction),
+          grid_properties(reconstruction->grid_properties),
+          changed_chunks(reconstruction->changed_chunks),
+          chunks(reconstruction->grid_properties->getNumChunks().prod())
+    {
+
+    }
+
+
+    /// @brief Returns true if the Reconstruction has exactly the channels which were last cloned.
+    /// @note  Channels are compared by identity, so one removed and added again with the same name
+    ///        is cloned again.
+    bool hasSameChannels() const
+    {
+        if (this->sources.size() != this->reconstruction->channels.size())
+        {
+            return false;
+        }
+        for (const auto& item : this->reconstruction->channels)
+        {
+            auto iter = this->sources.find(item.first);
+            if (iter == this->sources.end() ||
+                iter->second.owner_before(item.second) || item.second.owner_before(iter->second))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    /// @brief Copies the seen data in a box.
+    /// @param seen Seen data of the Reconstruction.
+    /// @param lower Lowest voxel of the box.
+    /// @param upper One past the highest voxel of the box, along each axis.
+    void copySeenBox(const Bitset& seen, const Index& lower, const Index& upper)
+    {
+        Bitset& copy = *this->data_seen;
+        this->grid_properties->forEachInBox(lower, upper, [&](const size_t& i)
+        {
+            seen.test(i) ? copy.set(i) : copy.reset(i);
+        });
+    }
+
+
+    /// @brief Copies the voxels next to each changed chunk which a channel may change between
+    ///        updates, and marks the chunks holding any which differed. See
+    ///        `VoxelGrid::getChangeRadius`.
+    void copyNeighbors()
+    {
+        const Grid::Properties& properties = *this->grid_properties;
+        const GridSize n = properties.getNumChunks();
+        const size_t stride[3] = {1, n[0], n[0] * n[1]};
+        for (const auto& item : this->reconstruction->channels)
+        {
+            const size_t radius = std::min(item.second->getChangeRadius(), size_t(1) << Grid::Properties::chunk_bits);
+            if (radius == 0)
+            {
+                continue;
+            }
+            VoxelGrid& copy = *this->channels.at(item.first);
+            this->changed_chunks->forEachSet([&](const size_t& c)
+            {
+                Index lower, upper;
+                properties.getChunkBox(c, lower, upper);
+                for (size_t axis = 0; axis < 3; ++axis)
+                {
+                    // The layers of the chunks below and above along the axis which touch this one.
+                    Index face_lower = lower, face_upper = upper;
+                    if (lower[axis] > 0 && !this->changed_chunks->test(c - stride[axis]))
+                    {
+                        face_lower[axis] = lower[axis] - radius;
+                        face_upper[axis] = lower[axis];
+                        if (copy.copyBox(*item.second, face_lower, face_upper))
+                        {
+                            this->chunks.set(c - stride[axis]);
+                        }
+                    }
+                    if (upper[axis] < properties.size[axis] && !this->changed_chunks->test(c + stride[axis]))
+                    {
+                        face_lower[axis] = upper[axis];
+                        face_upper[axis] = std::min(upper[axis] + radius, properties.size[axis]);
+                        if (copy.copyBox(*item.second, face_lower, face_upper))
+                        {
+                            this->chunks.set(c + stride[axis]);
+                        }
+                    }
+                }
+            });
+        }
+    }
+
+
+    /// @brief Writes each run of changed chunks along X of the channels and seen data over the data
+    ///        sets of an earlier `write`, and updates the update count.
+    /// @param h5_file An opened HDF5 file holding an earlier `write`.
+    void writeChunks(HighFive::File& h5_file) const
+    {
+        auto g_reconstruction = h5_file.getGroup(FS_HDF5_RECONSTRUCTION_GROUP);
+        g_reconstruction.getAttribute("Updates").write(this->n_updates);
+        if (g_reconstruction.hasAttribute("Window Offset"))
+        {
+            g_reconstruction.getAttribute("Window Offset").write(this->window_offset);
+        }
+        else if (!this->window_offset.isZero())
+        {
+            g_reconstruction.createAttribute("Window Offset", this->window_offset);
+        }
+
+        HighFive::DataSet dset_seen = g_reconstruction.getDataSet(Snapshot::seen_dset_name);
+        std::vector<std::pair<const VoxelGrid*, HighFive::Group>> groups;
+        for (const auto& item : this->channels)
+        {
+            groups.emplace_back(item.second.get(), g_reconstruction.getGroup(item.first));
+        }
+
+        const Grid::Properties& properties = *this->grid_properties;
+        std::vector<uint8_t> box;
+        auto write_run = [&](const size_t& c_first, const size_t& c_last)
+        {
+            Index lower, upper, last_lower;
+            properties.getChunkBox(c_first, lower, upper);
+            properties.getChunkBox(c_last, last_lower, upper);
+            for (auto& item : groups)
+            {
+                item.first->saveBox(item.second, item.first->getTypeName(), lower, upper);
+            }
+            box.clear();
+            properties.forEachInBox(lower, upper, [&](const size_t& i) { box.push_back(this->data_seen->test(i)); });
+            dset_seen.select(utilities::boxHyperSlab(properties.size, lower, upper)).write_raw(box.data());
+        };
+
+        const size_t nx = properties.getNumChunks()[0];
+        size_t run_first = 0, run_last = 0;
+        bool in_run = false;
+        this->chunks.forEachSet([&](const size_t& c)
+        {
+            if (in_run && c == run_last + 1 && c % nx != 0)
+            {
+                run_last = c;
+                return;
+            }
+            if (in_run)
+            {
+                write_run(run_first, run_last);
+            }
+            run_first = run_last = c;
+            in_run = true;
+        });
+        if (in_run)
+        {
+            write_run(run_first, run_last);
+        }
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Reconstruction the copy is kept of.
+    const std::shared_ptr<const Reconstruction> reconstruction;
+
+    /// @brief Grid Properties of the Reconstruction.
+    const std::shared_ptr<const Grid::Properties> grid_properties;
+
+    /// @brief The Reconstruction's record of the chunks its updates changed. `copy` clears it.
+    const std::shared_ptr<Bitset> changed_chunks;
+
+    /// @brief Channels of the Reconstruction each copy was cloned from, by name.
+    std::map<std::string, std::weak_ptr<const VoxelGrid>> sources;
+
+    /// @brief Copy of each channel.
+    std::map<std::string, std::shared_ptr<VoxelGrid>> channels;
+
+    /// @brief Copy of the seen data.
+    std::shared_ptr<Bitset> data_seen;
+
+    /// @brief One flag per chunk, set if the chunk changed since the last `write`.
+    Bitset chunks;
+
+    /// @brief If true the next `write` writes the whole copy.
+    bool full = true;
+
+    /// @brief Number of updates the Reconstruction had when `copy` was last called.
+    size_t n_updates = 0;
+
+    /// @brief Offset of the Reconstruction's window when `copy` was last called.
+    Eigen::Vector3i window_offset = Eigen::Vector3i::Zero();
+
+    /// @brief Arguments each channel added through an ArgParser was created with.
+    std::map<std::string, std::string> channel_args;
+};
+
+
+} // namespace data
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_DATA_CHECKPOINT_HPP
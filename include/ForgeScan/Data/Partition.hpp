@@ -0,0 +1,509 @@
+#ifndef FORGE_SCAN_DATA_PARTITION_HPP
+#define FORGE_SCAN_DATA_PARTITION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#define H5_USE_EIGEN 1
+#include <highfive/H5File.hpp>
+
+#include "ForgeScan/Common/Definitions.hpp"
+#include "ForgeScan/Common/Exceptions.hpp"
+#include "ForgeScan/Common/Grid.hpp"
+#include "ForgeScan/Common/VectorMath.hpp"
+#include "ForgeScan/Data/Snapshot.hpp"
+#include "ForgeScan/Utilities/ArgParser.hpp"
+#include "ForgeScan/Utilities/Files.hpp"
+#include "ForgeScan/Utilities/HDF5.hpp"
+
+
+namespace forge_scan {
+namespace data {
+
+
+/// @brief One of several slabs a Grid is split into along Z, so that separate processes, or ranks,
+///        may each reconstruct one part of a Grid larger than any one of them could hold.
+/// @details Each rank owns an even share of the Z-planes, and also stores `halo` planes of each
+///          neighbour's share. A Manager created for the Partition (see `Manager::create`) has Grid
+///          Properties the size of the stored planes, and its Reconstruction's window starts at the
+///          lowest of them, so poses in the frame of the whole Grid are moved into the Partition's.
+///          The AABB clipping of the ray trace means each rank only traces the part of a ray crossing
+///          its planes. `route` finds which ranks a view's rays cross, so the application may send each
+///          view only to those, by whatever transport it uses. The halo planes are traced by both
+///          neighbours, so voxels at the edge of an owned share see the same neighbourhood as in one
+///          Grid, without exchanging data.
+/// @note  The slabs are along Z so that each is a contiguous range of the linear order, and of the
+///        chunks, of the saved data sets. `merge` then joins the files each rank saved by copying
+///        each owned range into one file, as if one Reconstruction of the whole Grid had saved it.
+/// @note  This is an offline partition and merge, not a distributed Reconstruction. There is no
+///        transport between ranks, so there is also no halo exchange: a halo plane only matches its
+///        owner's because both traced the same views. `route` keeps this, as it sends a view to each
+///        rank storing a plane the view crosses, halo planes included. Metrics and Policies are not reduced across
+///        ranks. Each runs on its own rank's stored planes, halo included, and stays in that rank's
+///        file; Policies which need the whole Grid should run on the merged file.
+class Partition
+{
+public:
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Creates one Partition of a Grid.
+    /// @param properties Grid Properties of the whole Grid.
+    /// @param rank    Index of the Partition.
+    /// @param n_ranks Number of Partitions the Grid is split into.
+    /// @param halo    Number of planes of each neighbour's share which are also stored.
+    /// @return Shared, constant pointer to the Partition.
+    /// @throws std::invalid_argument If the rank is not less than the number of ranks, or if there
+    ///         are more ranks than Z-planes.
+    static std::shared_ptr<const Partition> create(const Grid::Properties& properties, const size_t& rank,
+                                                   const size_t& n_ranks, const size_t& halo = Partition::default_halo)
+    {
+        return std::shared_ptr<const Partition>(new Partition(properties, rank, n_ranks, halo));
+    }
+
+
+    /// @brief Creates one Partition of a Grid from the provided ArgParser.
+    /// @param parser Arguments for the Grid Properties of the whole Grid, and for the Partition. See
+    ///               `parse_rank`, `parse_n_ranks` and `parse_halo`.
+    /// @return Shared, constant pointer to the Partition. Without `parse_n_ranks` this is the only
+    ///         Partition, which is the whole Grid.
+    /// @throws std::invalid_argument If the rank is not less than the number of ranks, or if there
+    ///         are more ranks than Z-planes.
+    static std::shared_ptr<const Partition> create(const utilities::ArgParser& parser)
+    {
+        return Partition::create(Grid::Properties(parser),
+                                 parser.get<size_t>(Partition::parse_rank, 0),
+                                 parser.get<size_t>(Partition::parse_n_ranks, 1),
+                                 parser.get<size_t>(Partition::parse_halo, Partition::default_halo));
+    }
+
+
+    /// @brief Gets the Grid Properties of the planes the Partition stores.
+    const std::shared_ptr<const Grid::Properties>& getProperties() const
+    {
+        return this->properties;
+    }
+
+
+    /// @brief Gets the window offset of a Reconstruction of the Partition, which is the index of its
+    ///        lowest stored voxel in the whole Grid. See `Reconstruction::setWindowOffset`.
+    Eigen::Vector3i getWindowOffset() const
+    {
+        return Eigen::Vector3i(0, 0, static_cast<int>(this->z_lower));
+    }
+
+
+    /// @brief Gets the first Z-plane of the whole Grid the Partition owns.
+    const size_t& getFirstOwned() const
+    {
+        return this->z_first;
+    }
+
+
+    /// @brief Gets one past the last Z-plane of the whole Grid the Partition owns.
+    const size_t& getLastOwned() const
+    {
+        return this->z_last;
+    }
+
+
+    /// @brief Gets the index of the Partition.
+    const size_t& getRank() const
+    {
+        return this->rank;
+    }
+
+
+    /// @brief Gets the number of Partitions the Grid is split into.
+    const size_t& getNumRanks() const
+    {
+        return this->n_ranks;
+    }
+
+
+    /// @brief Checks if any ray of a view crosses the planes the Partition stores.
+    /// @param sensed_points Sensed points of the view, in the frame of the whole Grid.
+    /// @param origin   Origin of the view, in the frame of the whole Grid.
+    /// @param dist_min Distance each ray is traced from, relative to its sensed point.
+    ///                 See `Reconstruction::getMinDistMin`.
+    /// @param dist_max Distance each ray is traced to, relative to its sensed point.
+    ///                 See `Reconstruction::getMaxDistMax`.
+    /// @return False only if the Partition's Reconstruction would not trace any voxel of the view.
+    /// @note  Only Z is checked, so this may return true for a view which misses the Grid in X or Y.
+    bool receives(const PointMatrix& sensed_points, const Point& origin, const float& dist_min,
+                  const float& dist_max) const
+    {
+        float z_min, z_max;
+        Partition::getExtentZ(sensed_points, origin, dist_min, dist_max, z_min, z_max);
+        return Partition::crossesZ(this->properties->resolution, this->z_lower,
+                                   this->z_lower + this->properties->size.z(), z_min, z_max);
+    }
+
+
+    /// @brief Finds the Partitions of a Grid whose stored planes any ray of a view crosses. These are
+    ///        the ranks the view must be sent to.
+    /// @param properties Grid Properties of the whole Grid.
+    /// @param n_ranks  Number of Partitions the Grid is split into.
+    /// @param halo     Number of planes of each neighbour's share which are also stored.
+    /// @param sensed_points Sensed points of the view, in the frame of the whole Grid.
+    /// @param origin   Origin of the view, in the frame of the whole Grid.
+    /// @param dist_min Distance each ray is traced from, relative to its sensed point.
+    /// @param dist_max Distance each ray is traced to, relative to its sensed point.
+    /// @return Ranks to send the view to, in ascending order. See `receives`.
+    /// @throws std::invalid_argument If there are no ranks, or more ranks than Z-planes.
+    static std::vector<size_t> route(const Grid::Properties& properties, const size_t& n_ranks, const size_t& halo,
+                                     const PointMatrix& sensed_points, const Point& origin,
+                                     const float& dist_min, const float& dist_max)
+    {
+        Partition::checkRanks(properties.size.z(), 0, n_ranks);
+        float z_min, z_max;
+        Partition::getExtentZ(sensed_points, origin, dist_min, dist_max, z_min, z_max);
+
+        std::vector<size_t> ranks;
+        for (size_t rank = 0; rank < n_ranks; ++rank)
+        {
+            size_t z_first, z_last, z_lower, z_upper;
+            Partition::getPlanes(properties.size.z(), rank, n_ranks, halo, z_first, z_last, z_lower, z_upper);
+            if (Partition::crossesZ(properties.resolution, z_lower, z_upper, z_min, z_max))
+            {
+                ranks.push_back(rank);
+            }
+        }
+        return ranks;
+    }
+
+
+    /// @brief Joins the Reconstructions saved by each Partition of a Grid into one HDF5 file, as if one
+    ///        Reconstruction of the whole Grid had saved it. This may then be loaded by a Manager of
+    ///        the whole Grid. See `Manager::load`.
+    /// @param fpath File path, with file name, to write to.
+    /// @param partition_fpaths Files saved by the Manager of each Partition, in any order.
+    /// @param options Chunking and compression for the joined data sets.
+    /// @return Full path to the joined file.
+    /// @details The Partitions are placed by their window offsets, and the planes each owns are found
+    ///          as the middle of its overlap with each neighbour. Every data set of the seen data and
+    ///          channels is copied one plane at a time, in the type it was saved in.
+    /// @note  Only the Reconstruction is joined. Policies and Metrics stay in each Partition's file.
+    /// @throws GridPropertyError If the files do not have the same resolution and X-Y size, or if
+    ///         they do not cover every Z-plane of a Grid.
+    /// @throws std::runtime_error If the files do not have the same channels and data sets.
+    /// @throws Any exception encountered while reading or writing the HDF5 files.
+    static std::filesystem::path merge(std::filesystem::path fpath, const std::vector<std::filesystem::path>& partition_fpaths,
+                                       const utilities::DataSetOptions& options = utilities::DataSetOptions())
+    {
+        if (partition_fpaths.empty())
+        {
+            throw std::invalid_argument("No Partition files were given to merge.");
+        }
+
+        std::vector<Saved> saved;
+        for (const auto& partition_fpath : partition_fpaths)
+        {
+            saved.push_back(Saved(partition_fpath));
+        }
+        std::sort(saved.begin(), saved.end(), [](const Saved& a, const Saved& b) { return a.z_lower < b.z_lower; });
+
+        // Each owns from the middle of its overlap with the one below to the middle of its overlap
+        // with the one above. Partitions made by `create` overlap by twice the halo, so this is the
+        // share each was created to own.
+        GridSize size = saved.front().size;
+        for (size_t r = 0; r < saved.size(); ++r)
+        {
+            const Saved& part = saved[r];
+            if (part.resolution != saved.front().resolution || part.size.x() != size.x() || part.size.y() != size.y())
+            {
+                throw GridPropertyError::PropertiesDoNotMatch("Partition " + part.fpath.string(),
+                                                              "Partition " + saved.front().fpath.string());
+            }
+            const size_t below = r == 0 ? 0 : saved[r - 1].z_lower + saved[r - 1].size.z();
+            if (part.z_lower > below)
+            {
+                throw GridPropertyError::PropertiesDoNotMatch("Partition " + part.fpath.string(),
+                                                              "Partitions covering each Z-plane");
+            }
+            saved[r].z_first = r == 0 ? 0 : (part.z_lower + below) / 2;
+            if (r > 0)
+            {
+                saved[r - 1].z_last = saved[r].z_first;
+            }
+        }
+        saved.back().z_last = saved.back().z_lower + saved.back().size.z();
+        size.z() = saved.back().z_last;
+        const Grid::Properties properties(saved.front().resolution, size);
+
+        utilities::validateAndCreateFilepath(fpath, FS_HDF5_FILE_EXTENSION, "Merged", true);
+        HighFive::File file(fpath.string(), HighFive::File::Truncate);
+        HighFive::Group g_reconstruction = file.createGroup(FS_HDF5_RECONSTRUCTION_GROUP);
+        g_reconstruction.createAttribute("VoxelGrid Resolution", properties.resolution);
+        g_reconstruction.createAttribute("VoxelGrid Dimensions", properties.dimensions);
+        g_reconstruction.createAttribute("VoxelGrid Size",       properties.size);
+        g_reconstruction.createAttribute("Updates",
+            std::max_element(saved.begin(), saved.end(),
+                             [](const Saved& a, const Saved& b) { return a.n_updates < b.n_updates; })->n_updates);
+
+        // The data sets of the first Partition are created whole, then each fills its owned planes.
+        const HighFive::File first_file(saved.front().fpath.string(), HighFive::File::ReadOnly);
+        const HighFive::Group g_first = first_file.getGroup(FS_HDF5_RECONSTRUCTION_GROUP);
+        std::vector<std::string> dset_paths;
+        for (const auto& name : g_first.listObjectNames())
+        {
+            if (g_first.getObjectType(name) == HighFive::ObjectType::Dataset)
+            {
+                dset_paths.push_back(name);
+                continue;
+            }
+            const HighFive::Group g_channel = g_first.getGroup(name);
+            HighFive::Group g_merged = g_reconstruction.createGroup(name);
+            if (g_channel.hasAttribute(Snapshot::channel_args_attr_name))
+            {
+                g_merged.createAttribute(Snapshot::channel_args_attr_name,
+                                         g_channel.getAttribute(Snapshot::channel_args_attr_name).read<std::string>());
+            }
+            for (const auto& dset_name : g_channel.listObjectNames())
+            {
+                dset_paths.push_back(name + "/" + dset_name);
+            }
+        }
+        for (const auto& dset_path : dset_paths)
+        {
+            const HighFive::DataType type = g_first.getDataSet(dset_path).getDataType();
+            g_reconstruction.createDataSet(dset_path, HighFive::DataSpace(std::vector<size_t>{properties.getNumVoxels()}),
+                                           type, options.getCreateProps(type, properties.getNumVoxels(), properties.size));
+        }
+
+        const size_t plane = size.x() * size.y();
+        for (const Saved& part : saved)
+        {
+            const HighFive::File part_file(part.fpath.string(), HighFive::File::ReadOnly);
+            const HighFive::Group g_part = part_file.getGroup(FS_HDF5_RECONSTRUCTION_GROUP);
+            for (const auto& dset_path : dset_paths)
+            {
+                if (!g_part.exist(dset_path))
+                {
+                    throw std::runtime_error("Partition " + part.fpath.string() + " does not have the data set \"" +
+                                             dset_path + "\" of Partition " + saved.front().fpath.string() + ".");
+                }
+                const HighFive::DataSet src = g_part.getDataSet(dset_path);
+                HighFive::DataSet dst = g_reconstruction.getDataSet(dset_path);
+                const HighFive::DataType type = src.getDataType();
+                if (src.getElementCount() != plane * part.size.z())
+                {
+                    throw std::runtime_error("Data set \"" + dset_path + "\" of Partition " + part.fpath.string() +
+                                             " does not have one element per voxel.");
+                }
+
+                std::vector<char> buffer(plane * type.getSize());
+                for (size_t z = part.z_first; z < part.z_last; ++z)
+                {
+                    src.select({(z - part.z_lower) * plane}, {plane}).read(buffer.data(), type);
+                    dst.select({z * plane}, {plane}).write_raw(buffer.data(), type);
+                }
+            }
+        }
+        file.flush();
+        return fpath;
+    }
+
+
+    /// @brief Returns a string help message for the Partition arguments.
+    static std::string helpMessage()
+    {
+        return "A Grid may be split along Z between ranks with: [" + Partition::parse_rank + " <rank>] [" +
+               Partition::parse_n_ranks + " <number of ranks>] [" + Partition::parse_halo +
+               " <planes shared with each neighbour, default " + std::to_string(Partition::default_halo) + ">]";
+    }
+
+
+    static const std::string parse_rank, parse_n_ranks, parse_halo;
+
+    /// @brief Default number of planes of each neighbour's share a Partition stores.
+    static constexpr size_t default_halo = 1;
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief What `merge` reads of the Reconstruction saved by one Partition.
+    struct Saved
+    {
+        /// @brief Reads the Grid Properties, update count and window offset.
+        /// @param fpath Path to the file.
+        explicit Saved(const std::filesystem::path& fpath)
+            : fpath(fpath)
+        {
+            const HighFive::File file(fpath.string(), HighFive::File::ReadOnly);
+            const HighFive::Group g_reconstruction = file.getGroup(FS_HDF5_RECONSTRUCTION_GROUP);
+            this->resolution = g_reconstruction.getAttribute("VoxelGrid Resolution").read<float>();
+            this->size       = g_reconstruction.getAttribute("VoxelGrid Size").read<GridSize>();
+            if (g_reconstruction.hasAttribute("Updates"))
+            {
+                this->n_updates = g_reconstruction.getAttribute("Updates").read<size_t>();
+            }
+            if (g_reconstruction.hasAttribute("Window Offset"))
+            {
+                const Eigen::Vector3i offset = g_reconstruction.getAttribute("Window Offset").read<Eigen::Vector3i>();
+                if (offset.x() != 0 || offset.y() != 0 || offset.z() < 0)
+                {
+                    throw GridPropertyError::PropertiesDoNotMatch("Partition " + fpath.string(),
+                                                                  "a Partition along Z");
+                }
+                this->z_lower = static_cast<size_t>(offset.z());
+            }
+        }
+
+        std::filesystem::path fpath;
+        float    resolution = 0;
+        GridSize size       = GridSize::Zero();
+        size_t   n_updates  = 0;
+
+        /// @brief First stored plane, and the first and one past the last owned plane, in the whole Grid.
+        size_t z_lower = 0, z_first = 0, z_last = 0;
+    };
+
+
+    /// @brief Private constructor to enforce shared pointer usage. See `create`.
+    Partition(const Grid::Properties& properties, const size_t& rank, const size_t& n_ranks, const size_t& halo)
+        : rank(rank),
+          n_ranks(n_ranks)
+    {
+        Partition::checkRanks(properties.size.z(), rank, n_ranks);
+        size_t z_upper;
+        Partition::getPlanes(properties.size.z(), rank, n_ranks, halo, this->z_first, this->z_last, this->z_lower, z_upper);
+
+        GridSize size = properties.size;
+        size.z() = z_upper - this->z_lower;
+        this->properties = Grid::Properties::createConst(properties.resolution, size, properties.sparse,
+                                                         properties.brick_size, properties.mmap_dir);
+    }
+
+
+    /// @brief Checks that a Grid may be split into the number of ranks and that the rank is one of them.
+    /// @param nz Number of Z-planes of the whole Grid.
+    /// @param rank    Index of a Partition.
+    /// @param n_ranks Number of Partitions the Grid is split into.
+    /// @throws std::invalid_argument If the rank is not less than the number of ranks, or if there
+    ///         are more ranks than Z-planes.
+    static void checkRanks(const size_t& nz, const size_t& rank, const size_t& n_ranks)
+    {
+        if (n_ranks == 0 || rank >= n_ranks)
+        {
+            throw std::invalid_argument("Partition rank " + std::to_string(rank) + " is not less than the " +
+                                        std::to_string(n_ranks) + " ranks.");
+        }
+        if (n_ranks > nz)
+        {
+            throw std::invalid_argument("A Grid with " + std::to_string(nz) + " Z-planes may not be split between " +
+                                        std::to_string(n_ranks) + " ranks.");
+        }
+    }
+
+
+    /// @brief Finds the planes of the whole Grid a Partition owns and stores.
+    /// @param nz Number of Z-planes of the whole Grid.
+    /// @param rank    Index of the Partition.
+    /// @param n_ranks Number of Partitions the Grid is split into.
+    /// @param halo    Number of planes of each neighbour's share which are also stored.
+    /// @param [out] z_first First owned plane.
+    /// @param [out] z_last  One past the last owned plane.
+    /// @param [out] z_lower First stored plane.
+    /// @param [out] z_upper One past the last stored plane.
+    static void getPlanes(const size_t& nz, const size_t& rank, const size_t& n_ranks, const size_t& halo,
+                          size_t& z_first, size_t& z_last, size_t& z_lower, size_t& z_upper)
+    {
+        z_first = rank * nz / n_ranks;
+        z_last  = (rank + 1) * nz / n_ranks;
+        z_lower = z_first - std::min(z_first, halo);
+        z_upper = std::min(z_last + halo, nz);
+    }
+
+
+    /// @brief Finds the range of Z, in the frame of the whole Grid, the traced rays of a view span.
+    /// @param sensed_points Sensed points of the view.
+    /// @param origin   Origin of the view.
+    /// @param dist_min Distance each ray is traced from, relative to its sensed point.
+    /// @param dist_max Distance each ray is traced to, relative to its sensed point.
+    /// @param [out] z_min Lowest Z of any traced ray. Greater than `z_max` if there are no rays.
+    /// @param [out] z_max Highest Z of any traced ray.
+    /// @details As in `start_traversal`, each ray runs from its sensed point towards the origin and is
+    ///          traced from `dist_min` to the lesser of `dist_max` and the origin. Z is linear along
+    ///          the ray, so its ends bound it.
+    static void getExtentZ(const PointMatrix& sensed_points, const Point& origin, const float& dist_min,
+                           const float& dist_max, float& z_min, float& z_max)
+    {
+        z_min =  INFINITY;
+        z_max = -INFINITY;
+        for (const auto& sensed : sensed_points.colwise())
+        {
+            float length;
+            Direction normal;
+            vector_math::get_length_and_normal(sensed, origin, length, normal);
+            float z_a = sensed.z(), z_b = sensed.z();
+            if (normal.z() != 0)
+            {
+                z_a += normal.z() * dist_min;
+                z_b += normal.z() * std::min(length, dist_max);
+            }
+            z_min = std::min(z_min, std::min(z_a, z_b));
+            z_max = std::max(z_max, std::max(z_a, z_b));
+        }
+    }
+
+
+    /// @brief Checks if a range of Z, in the frame of the whole Grid, crosses a range of stored planes.
+    /// @param resolution Voxel resolution of the Grid.
+    /// @param z_lower First stored plane.
+    /// @param z_upper One past the last stored plane.
+    /// @param z_min Lowest Z of the range.
+    /// @param z_max Highest Z of the range.
+    /// @return True if the range meets the bounds which a Reconstruction of the stored planes clips
+    ///         rays to, see `Grid::Properties::dimensions`. These are widened by half a voxel so
+    ///         rounding in the ray's intersection with them cannot make this miss a traced voxel.
+    static bool crossesZ(const float& resolution, const size_t& z_lower, const size_t& z_upper,
+                         const float& z_min, const float& z_max)
+    {
+        return z_min <= (z_upper - 0.5f) * resolution && (z_lower - 0.5f) * resolution <= z_max;
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Grid Properties of the planes the Partition stores.
+    std::shared_ptr<const Grid::Properties> properties;
+
+    /// @brief Index of the Partition, and the number the Grid is split into.
+    const size_t rank, n_ranks;
+
+    /// @brief First stored plane, and the first and one past the last owned plane, in the whole Grid.
+    size_t z_lower = 0, z_first = 0, z_last = 0;
+};
+
+
+/// @brief ArgParser key for the index of the Partition.
+const std::string Partition::parse_rank = "--rank";
+
+/// @brief ArgParser key for the number of Partitions the Grid is split into.
+const std::string Partition::parse_n_ranks = "--n-ranks";
+
+/// @brief ArgParser key for the number of planes of each neighbour's share a Partition stores.
+const std::string Partition::parse_halo = "--halo";
+
+
+} // namespace data
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_DATA_PARTITION_HPP
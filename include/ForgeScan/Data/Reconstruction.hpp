@@ -1,12 +1,28 @@
 #ifndef FORGE_SCAN_RECONSTRUCTION_RECONSTRUCTION_HPP
 #define FORGE_SCAN_RECONSTRUCTION_RECONSTRUCTION_HPP
 
+#include <atomic>
+#include <cmath>
+#include <exception>
 #include <map>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
+#include "ForgeScan/Common/Bitset.hpp"
+#include "ForgeScan/Common/ProjectiveTrace.hpp"
 #include "ForgeScan/Common/RayTrace.hpp"
+#include "ForgeScan/Common/TraceBatch.hpp"
+#include "ForgeScan/Data/Snapshot.hpp"
 #include "ForgeScan/Data/VoxelGrids/Constructor.hpp"
 #include "ForgeScan/Utilities/ArgParser.hpp"
+#include "ForgeScan/Utilities/HDF5.hpp"
+#include "ForgeScan/Utilities/MemoryUse.hpp"
+#include "ForgeScan/Utilities/Profiler.hpp"
+#include "ForgeScan/Utilities/Threads.hpp"
 
 
 namespace forge_scan {
@@ -53,6 +69,9 @@ class Reconstruction
     /// @details Required to add/remove Policy-specific channels.
     friend class policies::Policy;
 
+    /// @details Required to copy the channels and seen data into a saved copy of them.
+    friend class Checkpoint;
+
 
 public:
     // ***************************************************************************************** //
@@ -66,156 +85,1722 @@ public:
     /// @return Shared pointer to a Reconstruction.
     static std::shared_ptr<Reconstruction> create(std::shared_ptr<const Grid::Properties> grid_properties)
     {
-        return std::shared_ptr<Reconstruction>(new Reconstruction(grid_properties));
+        return std::shared_ptr<Reconstruction>(new Reconstruction(grid_properties));
+    }
+
+
+    /// @brief Updates each VoxelGrid based on the provided set of rays.
+    /// @param sensed_points A set of measurements which act as the end points for a collection of rays.
+    /// @param origin Common origin of the sensed points.
+    /// @note Both `sensed` and `origin` are assumed to be in the Reconstruction's reference frame.
+    /// @note If more than one thread is set with `setNumThreads` the parallel update is used. This
+    ///       produces the same VoxelGrid data as the serial update. Grids with sparse storage always
+    ///       use the serial update because allocating a block in a `SparseVector` is not thread-safe.
+    /// @note Rays are traced into a `TraceBatch` and each VoxelGrid is updated once per batch.
+    ///       Grids too large for the 32-bit indices of a batch are updated one ray at a time.
+    /// @note The channels are held, and updated, in host memory. There is no device backend, as
+    ///       there are no device kernels for the traversal or the VoxelGrid updates.
+    /// @note The dirty index of the seen data is cleared at the start of each update, so afterwards
+    ///       it marks the regions touched by this update. See `getSeenData`.
+    /// @note If the saturation-aware update is set with `setSkipSaturated` voxels which no channel
+    ///       would change are left out of the traces.
+    /// @note If endpoint merging is set with `setEndpointMerge` the sensed points which end in the
+    ///       same voxel are traced as one ray, which each VoxelGrid is updated along once for each.
+    void update(const PointMatrix& sensed_points, const Point& origin)
+    {
+        FS_PROFILE_SCOPE(RECONSTRUCTION_UPDATE, nullptr);
+        this->beginUpdate();
+        this->traceAndApply(sensed_points, origin);
+        this->endUpdate();
+    }
+
+
+    /// @brief Updates each VoxelGrid from a depth image and the Points deprojected from it.
+    /// @param sensed_points The depth image's Points, in the Reconstruction's reference frame.
+    /// @param image Depth image.
+    /// @param intr  Intrinsics of the camera which took the image.
+    /// @param extr  Pose of the camera, in the Reconstruction's reference frame.
+    /// @throws Rethrows the first exception encountered by any thread once all threads have joined.
+    /// @note  Unless the projective update is set with `setProjectiveUpdate` this is the same as the
+    ///        ray update, with the camera's position as the origin.
+    /// @note  VoxelGrids supporting the projective update are instead updated once per voxel near
+    ///        the surface, see `updateProjective`. Any other VoxelGrids are updated along the rays as
+    ///        usual. Grids too large for the 32-bit indices of a TraceBatch use the ray update.
+    void update(const PointMatrix& sensed_points, const DepthImage& image,
+                const sensor::Intrinsics& intr, const Extrinsic& extr)
+    {
+        ProjectiveRange range;
+        if (!this->getProjectiveRange(range))
+        {
+            this->update(sensed_points, extr.translation());
+            return;
+        }
+
+        FS_PROFILE_SCOPE(RECONSTRUCTION_UPDATE, nullptr);
+        this->beginUpdate();
+        this->traceAndApplyImage(sensed_points, image, intr, extr, range);
+        this->endUpdate();
+    }
+
+
+    /// @brief One camera's frame of a capture by a rig of cameras. See the rig `update`.
+    struct RigFrame
+    {
+        /// @brief The frame's Points, in the Reconstruction's reference frame.
+        const PointMatrix* sensed_points = nullptr;
+
+        /// @brief Pose of the camera, in the Reconstruction's reference frame.
+        Extrinsic extr = Extrinsic::Identity();
+
+        /// @brief Depth image and Intrinsics of the camera, used by the projective update. If
+        ///        either is null the frame uses the ray update.
+        const DepthImage* image = nullptr;
+        const sensor::Intrinsics* intr = nullptr;
+    };
+
+
+    /// @brief Updates each VoxelGrid with the frames of several cameras, captured together, as one
+    ///        update.
+    /// @param frames Frame of each camera of the rig. Each has its own origin.
+    /// @throws std::invalid_argument If any frame has no Points.
+    /// @throws Rethrows the first exception encountered by any thread once all threads have joined.
+    /// @note  Each frame is traced and applied as the single-camera `update` would, with the parallel
+    ///        update if more than one thread is set. But the frames share one `beginUpdate` and one
+    ///        `endUpdate`, so the update count, the dirty index of the seen data and each VoxelGrid's
+    ///        `postUpdate` count the capture once. A `CountViews` channel, for example, counts one
+    ///        view of a voxel seen by several cameras of the rig.
+    void update(const std::vector<RigFrame>& frames)
+    {
+        for (const auto& frame : frames)
+        {
+            if (frame.sensed_points == nullptr)
+            {
+                throw std::invalid_argument("A rig frame must have its sensed points.");
+            }
+        }
+        ProjectiveRange range;
+        const bool projective = this->getProjectiveRange(range);
+
+        FS_PROFILE_SCOPE(RECONSTRUCTION_UPDATE, nullptr);
+        this->beginUpdate();
+        for (const auto& frame : frames)
+        {
+            if (projective && frame.image != nullptr && frame.intr != nullptr)
+            {
+                this->traceAndApplyImage(*frame.sensed_points, *frame.image, *frame.intr, frame.extr, range);
+            }
+            else
+            {
+                this->traceAndApply(*frame.sensed_points, frame.extr.translation());
+            }
+        }
+        this->endUpdate();
+    }
+
+
+    /// @brief Updates several Reconstructions along the same set of rays, tracing each ray once for
+    ///        each distinct set of trace settings.
+    /// @param reconstructions Reconstructions to update. They must all share equal Grid Properties.
+    /// @param sensed_points A set of measurements which act as the end points for a collection of rays.
+    /// @param origin Common origin of the sensed points.
+    /// @param n_threads Number of threads to apply the traces with. Each Reconstruction is only
+    ///                  updated by one thread. A value of 0 uses the number of hardware threads.
+    /// @throws GridPropertyError If the Reconstructions do not have equal Grid Properties.
+    /// @throws Rethrows the first exception encountered by any thread once all threads have joined.
+    /// @note  The Reconstructions are grouped by the settings which change their traces: the
+    ///        distance range of their channels and their endpoint merging. Each batch of rays is
+    ///        traced once for each group and applied to every Reconstruction in it, so each ends
+    ///        with the same data as if it were updated alone. A sweep over channel parameters which
+    ///        share a range may then cost little more than a single run.
+    /// @note  The saturation-aware update is not used, as each Reconstruction saturates differently.
+    ///        It only skips voxels no channel would change, so this does not change the results.
+    /// @note  Grids too large for the 32-bit indices of a batch update each Reconstruction alone.
+    static void update(const std::vector<std::shared_ptr<Reconstruction>>& reconstructions,
+                       const PointMatrix& sensed_points, const Point& origin, const size_t& n_threads = 1)
+    {
+        if (reconstructions.empty())
+        {
+            return;
+        }
+        const std::shared_ptr<Reconstruction>& lead = reconstructions.front();
+        for (const auto& reconstruction : reconstructions)
+        {
+            if (!reconstruction->grid_properties->isEqual(lead->grid_properties))
+            {
+                throw GridPropertyError::PropertiesDoNotMatch("a Reconstruction", "the first Reconstruction");
+            }
+        }
+        if (reconstructions.size() == 1 || lead->grid_properties->getNumVoxels() > TraceBatch::max_num_voxels)
+        {
+            for (const auto& reconstruction : reconstructions)
+            {
+                reconstruction->update(sensed_points, origin);
+            }
+            return;
+        }
+
+        // Group the Reconstructions which would trace identical rays, in the order they were given.
+        std::vector<std::vector<std::shared_ptr<Reconstruction>>> groups;
+        for (const auto& reconstruction : reconstructions)
+        {
+            auto same_trace = [&reconstruction](const std::vector<std::shared_ptr<Reconstruction>>& group)
+            {
+                const Reconstruction& other = *group.front();
+                return other.min_dist_min   == reconstruction->min_dist_min &&
+                       other.max_dist_max   == reconstruction->max_dist_max &&
+                       other.endpoint_merge == reconstruction->endpoint_merge;
+            };
+            auto group = std::find_if(groups.begin(), groups.end(), same_trace);
+            if (group == groups.end())
+            {
+                groups.emplace_back();
+                group = std::prev(groups.end());
+            }
+            group->push_back(reconstruction);
+        }
+
+        FS_PROFILE_SCOPE(RECONSTRUCTION_UPDATE, nullptr);
+        for (const auto& reconstruction : reconstructions)
+        {
+            reconstruction->beginUpdate();
+        }
+        for (const auto& group : groups)
+        {
+            Reconstruction::updateShared(group, sensed_points, origin,
+                                         n_threads == 0 ? utilities::getHardwareThreadCount() : n_threads);
+        }
+        for (const auto& reconstruction : reconstructions)
+        {
+            reconstruction->endUpdate();
+        }
+    }
+
+
+    /// @brief Sets the number of threads used by `update`.
+    /// @param n_threads Number of threads. A value of 1 uses the serial update. A value of 0 uses
+    ///                  the number of hardware threads reported by the system.
+    void setNumThreads(const size_t& n_threads)
+    {
+        this->n_threads = n_threads == 0 ? utilities::getHardwareThreadCount() : n_threads;
+    }
+
+
+    /// @brief Gets the number of threads used by `update`.
+    /// @return Number of threads. A value of 1 means the serial update is used.
+    size_t getNumThreads() const
+    {
+        return this->n_threads;
+    }
+
+
+    /// @brief Sets if `update` uses the saturation-aware update. This leaves out of the traces the
+    ///        voxels which are seen and which no channel would change, stepping over whole blocks of
+    ///        them at a time. Rescanning a scene from nearby poses mostly traces such voxels.
+    /// @param skip_saturated True to use the saturation-aware update.
+    /// @details Each channel states, with `VoxelGrid::getSkipDistance` and `VoxelGrid::isSaturated`,
+    ///          which voxels an update past a distance along the ray leaves unchanged. Voxels are only
+    ///          skipped past the furthest of these distances, and only in blocks where every channel
+    ///          reports every voxel as saturated. A pyramid of these blocks is kept between updates,
+    ///          and refreshed around the voxels each update traces.
+    /// @note  Both produce the same VoxelGrid data and seen data. The skipped voxels are not marked
+    ///        in the dirty index of the seen data, or in the update tracking record, which this
+    ///        enables. If any channel updates every voxel on a trace, such as `CountViews`, nothing
+    ///        is skipped.
+    void setSkipSaturated(const bool& skip_saturated)
+    {
+        if (skip_saturated && !this->skip_pyramid)
+        {
+            this->enableUpdateTracking();
+            this->skip_pyramid = std::make_shared<OccupancyPyramid>(this->grid_properties);
+        }
+        else if (!skip_saturated)
+        {
+            this->skip_pyramid.reset();
+        }
+    }
+
+
+    /// @brief Gets if `update` uses the saturation-aware update.
+    /// @return True if the saturation-aware update is used.
+    bool getSkipSaturated() const
+    {
+        return this->skip_pyramid != nullptr;
+    }
+
+
+    /// @brief Sets if the depth image `update` uses the projective update. This updates the
+    ///        VoxelGrids supporting it, such as `TSDF`, once per voxel near the surface rather than
+    ///        once per ray through each voxel.
+    /// @param projective_update True to use the projective update.
+    /// @note  The two do not produce the same data. A ray update gives a voxel one sample from each
+    ///        ray crossing it, which for voxels near the camera may be many. The projective update
+    ///        gives each voxel one sample, from the pixel its center projects to.
+    void setProjectiveUpdate(const bool& projective_update)
+    {
+        this->projective_update = projective_update;
+    }
+
+
+    /// @brief Gets if the depth image `update` uses the projective update.
+    /// @return True if the projective update is used.
+    bool getProjectiveUpdate() const
+    {
+        return this->projective_update;
+    }
+
+
+    /// @brief How `update` merges the sensed points which end in the same voxel.
+    enum class EndpointMerge
+    {
+        /// @brief Every sensed point is traced.
+        NONE,
+
+        /// @brief The first sensed point in each voxel is traced, in place of all of them.
+        FIRST,
+
+        /// @brief The mean of the sensed points in each voxel is traced, in place of all of them.
+        CENTROID
+    };
+
+
+    /// @brief Sets if `update` merges the sensed points which end in the same voxel, tracing one
+    ///        ray for each such voxel. When voxels are much larger than the footprint of a pixel many
+    ///        neighboring pixels end in one voxel and trace nearly the same path to it.
+    /// @param endpoint_merge How the sensed points are merged.
+    /// @details Each merged ray carries the number of sensed points it stands in for, see
+    ///          `TraceBatch::Ray::weight`. Each VoxelGrid is updated along it once, taking the weight
+    ///          as that many samples: a `TSDF` adds them to its weighted or running average and a
+    ///          `Probability` scales its log-odds increment. So a channel takes as many samples as
+    ///          before, but traces are made, stored and applied once per voxel.
+    /// @note  This does not produce the same data as tracing every point. The merged rays only
+    ///        differ from those they replace by less than a voxel at their sensed points, but they
+    ///        may cross slightly different voxels on their way back to the origin. `CENTROID` places
+    ///        each sample at the mean surface position within the voxel; `FIRST` keeps a point which
+    ///        was actually sensed.
+    /// @note  Sensed points outside the Grid are not merged.
+    void setEndpointMerge(const EndpointMerge& endpoint_merge)
+    {
+        this->endpoint_merge = endpoint_merge;
+    }
+
+
+    /// @brief Gets how `update` merges the sensed points which end in the same voxel.
+    EndpointMerge getEndpointMerge() const
+    {
+        return this->endpoint_merge;
+    }
+
+
+    /// @brief Gets an EndpointMerge from its name.
+    /// @param name Name of the merge. An empty string is the same as "none".
+    /// @return Matching EndpointMerge.
+    /// @throws std::invalid_argument If the name is not recognized.
+    static EndpointMerge getEndpointMerge(const std::string& name)
+    {
+        if (name.empty() || name == "none") return EndpointMerge::NONE;
+        if (name == "first")                return EndpointMerge::FIRST;
+        if (name == "centroid")             return EndpointMerge::CENTROID;
+        throw std::invalid_argument("Unknown endpoint merge \"" + name + "\". Use none, first, or centroid.");
+    }
+
+
+    /// @brief Gets a constant reference to the record of which voxels were seen, that is which
+    ///        voxels the positive region of a ray has intersected at least once.
+    /// @return Read-only reference to the seen data. Its dirty index marks the blocks of voxels
+    ///         seen by the most recent call to `update`.
+    std::shared_ptr<const Bitset> getSeenData() const
+    {
+        return this->data_seen;
+    }
+
+
+    /// @brief Gets the number of times `update` has been called.
+    size_t getNumUpdates() const
+    {
+        return this->n_updates;
+    }
+
+
+    /// @brief Gets a copy of every channel and the seen data as they are now, which may be read
+    ///        while the Reconstruction carries on being updated.
+    /// @return Shared, constant pointer to the Snapshot.
+    /// @details The Snapshot is kept until the next call to `update`, or until a channel is added,
+    ///          removed or loaded, so calls in between return the same Snapshot without copying.
+    /// @note  This must not be called while the Reconstruction is being updated. Data written
+    ///        through `getChannelRef` does not replace a Snapshot which has already been taken.
+    std::shared_ptr<const Snapshot> getSnapshot() const
+    {
+        if (!this->snapshot)
+        {
+            this->snapshot = Snapshot::create(this->grid_properties, this->n_updates, this->window_offset, *this->data_seen,
+                                              this->channels, this->channel_args);
+        }
+        return this->snapshot;
+    }
+
+
+    /// @brief Starts recording which voxels each call to `update` traces. See `getUpdatedData`.
+    /// @note  Every VoxelGrid only changes voxels on the traces of an update, so the record lets
+    ///        consumers revisit just those voxels. Recording costs one extra pass over each trace
+    ///        so it is off until a consumer, such as `metrics::OccupancyConfusion`, asks for it.
+    void enableUpdateTracking()
+    {
+        if (!this->data_updated)
+        {
+            this->data_updated = std::make_shared<Bitset>(this->grid_properties->getNumVoxels());
+        }
+    }
+
+
+    /// @brief Starts recording which chunks of the Grid hold voxels changed since a `Checkpoint` last
+    ///        copied them. Every chunk starts changed. See `Grid::Properties::getNumChunks`.
+    /// @note  This enables update tracking, and at the end of each update marks the chunks holding
+    ///        the voxels set in the dirty blocks of its record. Loading a file marks every chunk.
+    ///        Moving the window marks the chunks which held, or now hold, a voxel changed since the
+    ///        Reconstruction was made, see `shiftWindow`.
+    ///        Data written through `getChannelRef` is not recorded.
+    void enableChangeTracking()
+    {
+        this->enableUpdateTracking();
+        if (!this->changed_chunks)
+        {
+            const size_t n_chunks = this->grid_properties->getNumChunks().prod();
+            this->changed_chunks = std::make_shared<Bitset>(n_chunks);
+            this->touched_chunks = std::make_shared<Bitset>(n_chunks);
+            this->markAllChanged();
+            if (this->n_updates == 0)
+            {
+                // Before the first update every voxel still holds its default value.
+                this->touched_chunks->reset();
+            }
+        }
+    }
+
+
+    /// @brief Gets a constant reference to the record of which voxels were traced by the most
+    ///        recent call to `update`. This covers the whole trace, not just its positive region.
+    /// @return Read-only reference to the record, or nullptr if `enableUpdateTracking` was not
+    ///         called. Its dirty index marks the same voxels, in blocks.
+    std::shared_ptr<const Bitset> getUpdatedData() const
+    {
+        return this->data_updated;
+    }
+
+
+    /// @brief Moves the window of the world the Reconstruction covers some number of voxels along
+    ///        one axis. The data is copied to its new place within the same storage, so the memory
+    ///        used stays the same but every voxel is visited.
+    /// @param axis  Axis to move along. 0, 1 or 2 for X, Y or Z.
+    /// @param steps Number of voxels to move the window by. A negative value moves it towards the
+    ///              lower bound of the axis.
+    /// @param g_evicted If not null, the layers of voxels which leave the window are written into a
+    ///                  new group of this, named "Slab N" for the Nth slab evicted.
+    /// @param options   Chunking and compression for the evicted data sets.
+    /// @details Voxels which leave the window are dropped, after being written to `g_evicted`, and
+    ///          voxels which enter it are unseen with each channel's default value. The slab group
+    ///          has the attributes "Lower Voxel", the index of its first voxel in the frame the
+    ///          window started in, "Size" and "Updates". It holds the seen data and each channel's
+    ///          data vector, as stored, in the linear order of a Grid that size.
+    /// @note  The Reconstruction's frame does not move. Once the window has moved, a point in the
+    ///        frame the window started in is at that point less `getWindowOffset` times the
+    ///        resolution in the Reconstruction's frame.
+    /// @note  Metrics comparing channels to a ground truth see moved data, so their results are
+    ///        only meaningful until the window first moves.
+    /// @note  This is a copying window, not a circular buffer. The storage is not indexed modulo the
+    ///        Grid size, so a move is not limited to clearing the slab which left. A voxel's vector
+    ///        index is a fixed function of its position. The traversal's constant strides and ray
+    ///        packets, the bricked layout, chunks, Partitions, saved files and the NumPy views all rely
+    ///        on that, and none of them handle an index which wraps.
+    /// @note  So moving the data takes time in proportion to the Grid, not to the steps: every voxel
+    ///        of each channel, the seen data and the pyramid of the saturation-aware update is
+    ///        visited. With change tracking enabled every chunk which held, or now holds, a voxel
+    ///        changed since the Reconstruction was made is marked, so the next `Checkpoint` copies
+    ///        about as much as has been scanned in the window. Chunks which were never reached are
+    ///        skipped.
+    /// @throws std::invalid_argument If the axis is not 0, 1 or 2.
+    /// @throws Any exception encountered while writing the HDF5 file.
+    void shiftWindow(const size_t& axis, const int& steps, HighFive::Group* g_evicted = nullptr,
+                     const utilities::DataSetOptions& options = utilities::DataSetOptions())
+    {
+        if (axis > 2)
+        {
+            throw std::invalid_argument("Window axis must be 0, 1 or 2 but was " + std::to_string(axis) + ".");
+        }
+        if (steps == 0)
+        {
+            return;
+        }
+
+        const size_t n = this->grid_properties->size[axis];
+        const size_t k = std::min(static_cast<size_t>(std::abs(steps)), n);
+        const size_t first = steps > 0 ? 0 : n - k;
+        if (g_evicted != nullptr)
+        {
+            this->writeSlab(*g_evicted, axis, first, first + k, options);
+        }
+
+        for (const auto& item : this->channels)
+        {
+            item.second->shift(axis, steps);
+        }
+        this->grid_properties->forEachShifted(axis, steps,
+            [this](const size_t& to, const size_t& from)
+            {
+                this->data_seen->test(from) ? this->data_seen->set(to) : this->data_seen->reset(to);
+            },
+            [this](const size_t& to)
+            {
+                this->data_seen->reset(to);
+            });
+        if (this->data_updated)
+        {
+            this->data_updated->reset();
+        }
+        if (this->skip_pyramid)
+        {
+            this->skip_pyramid->markAll();
+        }
+        this->markShiftedChanged(axis, steps);
+        this->snapshot.reset();
+        this->window_offset[axis] += steps;
+    }
+
+
+    /// @brief Gets how many voxels the window has moved along each axis. See `shiftWindow`.
+    const Eigen::Vector3i& getWindowOffset() const
+    {
+        return this->window_offset;
+    }
+
+
+    /// @brief Gets the most negative `dist_min` of the channels. Rays are traced from this distance
+    ///        relative to their sensed point, see `get_ray_trace_batch`.
+    const float& getMinDistMin() const
+    {
+        return this->min_dist_min;
+    }
+
+
+    /// @brief Gets the most positive `dist_max` of the channels. Rays are traced to this distance
+    ///        relative to their sensed point, or to their origin if it is closer.
+    const float& getMaxDistMax() const
+    {
+        return this->max_dist_max;
+    }
+
+
+    /// @brief Places the window some number of voxels from the frame it starts in, without moving
+    ///        any data. This is used for a `Partition` of a larger Grid, which starts at its lower
+    ///        voxel. See `shiftWindow` for how the offset is applied.
+    /// @param offset Voxels from the lower bound of the starting frame to the window's, along each axis.
+    void setWindowOffset(const Eigen::Vector3i& offset)
+    {
+        this->window_offset = offset;
+        this->snapshot.reset();
+    }
+
+
+    /// @brief Adds a VoxelGrid data channel to the Reconstruction.
+    /// @param parser ArgParser with arguments to construct a new VoxelGrid from.
+    ///               See `forge_scan::data::Reconstruction::addChannel` for details.
+    /// @throws InvalidMapKey If no name was provided for the channel.
+    /// @throws InvalidMapKey If there is already a channel with that name.
+    /// @throws ReservedMapKey if the channel name is reserved for Metrics or Policies.
+    /// @throws MemoryBudgetError if the channel would exceed the memory budget. See `setMemoryBudget`.
+    /// @throws Any exceptions thrown by `Constructor::create` pass through this.
+    void addChannel(const utilities::ArgParser& parser)
+    {
+        std::string channel_name = parser.get(Reconstruction::parse_name);
+        if (channel_name.empty())
+        {
+            throw InvalidMapKey::NoNameProvided();
+        }
+        else if (this->channels.count(channel_name) == 1)
+        {
+            throw InvalidMapKey::NameAlreadyExists(channel_name);
+        }
+        this->checkChannelNameIsNotReserved(channel_name);
+        utilities::ArgParser args(parser);
+        this->checkMemoryBudget(channel_name, args);
+        std::shared_ptr<VoxelGrid> voxel_grid  = Constructor::create(args, this->grid_properties);
+        voxel_grid->addSeenData(this->data_seen);
+        this->channels.insert( {channel_name, voxel_grid} );
+        this->channel_args.insert( {channel_name, args.getArgs()} );
+        this->updateMinAndMaxDist();
+        this->snapshot.reset();
+    }
+
+
+    /// @brief Gets a constant reference to the VoxelGrid data channel.
+    /// @param name Name of the channel in the channel dictionary to retrieve.
+    /// @returns Read-only reference to the requested VoxelGrid data channel.
+    /// @throws InvalidMapKey If a channel with that name does not exist.
+    std::shared_ptr<const forge_scan::data::VoxelGrid> getChannelView(const std::string& name) const
+    {
+        return this->getChannelRef(name);
+    }
+
+
+    /// @brief Gets a reference to the VoxelGrid data channel.
+    /// @param name Name of the channel in the channel dictionary to retrieve.
+    /// @returns Reference to the requested VoxelGrid data channel.
+    /// @throws InvalidMapKey If a channel with that name does not exist.
+    std::shared_ptr<forge_scan::data::VoxelGrid> getChannelRef(const std::string& name) const
+    {
+        for (auto iter = this->channels.begin(); iter != this->channels.end(); ++iter)
+        {
+            if (iter->first == name)
+            {
+                return iter->second;
+            }
+        }
+        throw InvalidMapKey::NonexistantValue(name);
+    }
+
+
+    /// @brief Removes a VoxelGrid data channel.
+    /// @param name Name of the channel in the channel dictionary to remove.
+    /// @returns True if successful. False if that channel did not exits or if it is owned by a
+    ///          Metric or a Policy.
+    bool removeChannel(const std::string& name)
+    {
+        for (auto iter = this->channels.begin(); iter != this->channels.end(); ++iter)
+        {
+            if (iter->first == name && iter->second.use_count() <= 1)
+            {
+                this->channel_args.erase(iter->first);
+                this->channels.erase(iter);
+                this->updateMinAndMaxDist();
+                this->snapshot.reset();
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+
+    /// @brief Sets a limit on the memory the Reconstruction may use. Each call to `addChannel` first
+    ///        estimates the memory of the new channel and throws, rather than allocating it, if the
+    ///        channel would take the Reconstruction over the limit.
+    /// @param budget_bytes Largest number of bytes to use, or zero for no limit.
+    /// @param compact_fallback If true, a `TSDF` or `Probability` channel which would exceed the limit
+    ///                         is instead created with compact `int16_t` data if that fits.
+    ///                         See `Constructor::getCompactArgs`.
+    /// @note  The estimate is of what a channel allocates when it is created. Sparse channels
+    ///        allocate as voxels are updated and memory-mapped channels are paged to their files,
+    ///        so these mostly pass the check. Channels added by Metrics and Policies are created
+    ///        before they are added, so they count towards the memory used but are not checked.
+    void setMemoryBudget(const size_t& budget_bytes, const bool& compact_fallback = false)
+    {
+        this->memory_budget = budget_bytes;
+        this->compact_fallback = compact_fallback;
+    }
+
+
+    /// @brief Gets the limit on the memory the Reconstruction may use.
+    /// @return Largest number of bytes to use, or zero for no limit.
+    size_t getMemoryBudget() const
+    {
+        return this->memory_budget;
+    }
+
+
+    /// @brief Calculates how much space each part of the Reconstruction is using.
+    /// @return Report with an item for each channel, named `Channel/<name>`, and for the seen data,
+    ///         the update tracking record, the trace and scratch buffers and the pyramids and block
+    ///         records of the saturation-aware and projective updates. Any Snapshot still held by
+    ///         the Reconstruction is also included. See `getSnapshot`.
+    utilities::memory_use::Report getMemoryReport() const
+    {
+        using utilities::memory_use::Usage;
+        auto bitset_usage = [](const std::shared_ptr<const Bitset>& bitset)
+        {
+            const size_t n = bitset ? bitset->sizeBytes() : 0;
+            return Usage{n, n};
+        };
+
+        utilities::memory_use::Report report;
+        for (const auto& item : this->channels)
+        {
+            report["Channel/" + item.first] = item.second->getMemoryUsage();
+        }
+        report["Seen"]              = bitset_usage(this->data_seen);
+        report["Updated"]           = bitset_usage(this->data_updated);
+        report["Changed Chunks"]    = bitset_usage(this->changed_chunks);
+        report["Touched Chunks"]    = bitset_usage(this->touched_chunks);
+        report["Projective Blocks"] = bitset_usage(this->projective_blocks);
+        if (this->snapshot)
+        {
+            report["Snapshot"] = this->snapshot->getMemoryUsage();
+        }
+
+        const size_t n_pyramid = this->skip_pyramid ? this->skip_pyramid->sizeBytes() : 0;
+        report["Skip Pyramid"] = Usage{n_pyramid, n_pyramid};
+
+        Usage traces{sizeof(TraceVoxel) * this->ray_trace->size(), sizeof(TraceVoxel) * this->ray_trace->capacity()};
+        auto add_batch = [&traces](const std::shared_ptr<const TraceBatch>& batch)
+        {
+            traces.size_bytes     += batch->capacityBytes();
+            traces.capacity_bytes += batch->capacityBytes();
+        };
+        add_batch(this->trace_batch);
+        for (const auto& batch : this->thread_batches)
+        {
+            add_batch(batch);
+        }
+        for (const auto& batch : this->shard_batches)
+        {
+            add_batch(batch);
+        }
+        for (const auto& batch : this->shard_pieces)
+        {
+            add_batch(batch);
+        }
+        auto add_vector = [&traces](const auto& vector)
+        {
+            traces.size_bytes     += utilities::memory_use::vector_size(vector);
+            traces.capacity_bytes += utilities::memory_use::vector_capacity(vector);
+        };
+        for (const auto& samples : this->thread_samples)
+        {
+            add_vector(samples);
+        }
+        add_vector(this->held_voxels);
+        add_vector(this->projective_block_list);
+        report["Traces"] = traces;
+
+        const size_t n_merged = this->merged_weights.size();
+        report["Merged Points"] = Usage{sizeof(Point) * n_merged + utilities::memory_use::vector_size(this->merged_weights),
+                                        sizeof(float) * this->merged_points.size() +
+                                        utilities::memory_use::vector_capacity(this->merged_weights)};
+        return report;
+    }
+
+
+    /// @brief Calculates how much space the Reconstruction is using.
+    /// @return Total of `getMemoryReport`.
+    utilities::memory_use::Usage getMemoryUsage() const
+    {
+        return utilities::memory_use::total(this->getMemoryReport());
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Shared, constant `Grid::Properties` used by all VoxelGrids.
+    const std::shared_ptr<const Grid::Properties> grid_properties;
+
+    static const std::string parse_name, parse_n_threads, parse_skip_saturated,
+                             parse_projective, parse_endpoint_merge, parse_memory_budget,
+                             parse_compact_fallback;
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Private constructor to enforce use of shared pointers.
+    /// @param grid_properties Shared, constant pointer to the `Grid::Properties` to use.
+    ///                        These `Grid::Properties` are utilized by all VoxelGrids.
+    explicit Reconstruction(const std::shared_ptr<const Grid::Properties>& grid_properties)
+        : grid_properties(grid_properties),
+          data_seen(std::make_shared<Bitset>(this->grid_properties->getNumVoxels())),
+          ray_trace(std::make_shared<Trace>()),
+          trace_batch(std::make_shared<TraceBatch>())
+    {
+
+    }
+
+
+    /// @brief Checks that a new channel fits in the memory budget, before it is created.
+    /// @param channel_name Name of the new channel.
+    /// @param [in, out] args Arguments to create the channel with. These are changed to those of the
+    ///                       compact version of the channel if that is used instead.
+    /// @throws MemoryBudgetError if the channel, and its compact version, would exceed the budget.
+    void checkMemoryBudget(const std::string& channel_name, utilities::ArgParser& args) const
+    {
+        if (this->memory_budget == 0)
+        {
+            return;
+        }
+        const size_t in_use = this->getMemoryUsage().capacity_bytes;
+        size_t requested = Constructor::estimateMemoryUsage(args, this->grid_properties);
+        if (in_use + requested <= this->memory_budget)
+        {
+            return;
+        }
+
+        utilities::ArgParser compact;
+        if (this->compact_fallback && Constructor::getCompactArgs(args, compact))
+        {
+            requested = Constructor::estimateMemoryUsage(compact, this->grid_properties);
+            if (in_use + requested <= this->memory_budget)
+            {
+                args = compact;
+                return;
+            }
+        }
+        throw MemoryBudgetError::WouldExceed(channel_name, requested, in_use, this->memory_budget);
+    }
+
+
+    /// @brief Clears the dirty indices of the seen and updated data and counts the update. Called
+    ///        at the start of `update`. Brings the pyramid of the saturation-aware update up to date.
+    void beginUpdate()
+    {
+        if (this->getSkipPyramid() != nullptr)
+        {
+            this->skip_pyramid->refresh([this](const size_t& i)
+            {
+                if (!this->data_seen->test(i))
+                {
+                    return VoxelOccupancy::UNSEEN;
+                }
+                for (const auto& item : this->channels)
+                {
+                    if (!item.second->isSaturated(i))
+                    {
+                        return VoxelOccupancy::OCCUPIED;
+                    }
+                }
+                return VoxelOccupancy::FREE;
+            });
+        }
+        this->data_seen->clearDirty();
+        if (this->data_updated)
+        {
+            this->data_updated->resetDirtyBlocks();
+        }
+        this->projective_pass = false;
+        this->snapshot.reset();
+        ++this->n_updates;
+    }
+
+
+    /// @brief Runs the post-update step of each VoxelGrid. Called at the end of `update`. Marks
+    ///        the traced voxels in the pyramid of the saturation-aware update, and the chunks
+    ///        holding them if change tracking is enabled.
+    void endUpdate()
+    {
+        if (this->skip_pyramid)
+        {
+            this->skip_pyramid->release();
+            this->data_updated->forEachSetInDirtyBlocks([this](const size_t& i) { this->skip_pyramid->markVoxel(i); });
+        }
+        if (this->changed_chunks)
+        {
+            // Traced voxels come in runs, so most are in the run of the chunk marked for the last.
+            size_t first = 0, last = 0;
+            this->data_updated->forEachSetInDirtyBlocks([this, &first, &last](const size_t& i)
+            {
+                if (i < first || i >= last)
+                {
+                    const size_t c = this->grid_properties->getChunk(i, first, last);
+                    this->changed_chunks->set(c);
+                    this->touched_chunks->set(c);
+                }
+            });
+        }
+        for (const auto& item : this->channels)
+        {
+            item.second->postUpdate();
+        }
+    }
+
+
+    /// @brief Distance range of the VoxelGrids supporting the projective update, and whether any
+    ///        VoxelGrid does not. See `getProjectiveRange`.
+    struct ProjectiveRange
+    {
+        float dist_min = 0, dist_max = 0;
+        bool has_ray_channel = false;
+    };
+
+
+    /// @brief Finds whether the depth image update may use the projective update, and over what range.
+    /// @param [out] range Distance range of the VoxelGrids supporting the projective update.
+    /// @return True if the projective update is set, some VoxelGrid supports it and the Grid fits
+    ///         the 32-bit indices of a TraceBatch. Otherwise the depth image update uses the rays.
+    bool getProjectiveRange(ProjectiveRange& range) const
+    {
+        bool has_projective_channel = false;
+        for (const auto& item : this->channels)
+        {
+            if (item.second->hasProjectiveUpdate())
+            {
+                has_projective_channel = true;
+                range.dist_min = std::min(range.dist_min, item.second->dist_min);
+                range.dist_max = std::max(range.dist_max, item.second->dist_max);
+            }
+            else
+            {
+                range.has_ray_channel = true;
+            }
+        }
+        return this->projective_update && has_projective_channel &&
+               this->grid_properties->getNumVoxels() <= TraceBatch::max_num_voxels;
+    }
+
+
+    /// @brief Updates each VoxelGrid from a depth image and its Points, with the projective update
+    ///        for VoxelGrids which support it. See the depth image `update`.
+    /// @param sensed_points The depth image's Points, in the Reconstruction's reference frame.
+    /// @param image Depth image.
+    /// @param intr  Intrinsics of the camera which took the image.
+    /// @param extr  Pose of the camera, in the Reconstruction's reference frame.
+    /// @param range Range found by `getProjectiveRange`.
+    void traceAndApplyImage(const PointMatrix& sensed_points, const DepthImage& image,
+                            const sensor::Intrinsics& intr, const Extrinsic& extr, const ProjectiveRange& range)
+    {
+        if (range.has_ray_channel)
+        {
+            this->projective_pass = true;
+            this->traceAndApply(sensed_points, extr.translation());
+            this->projective_pass = false;
+        }
+        this->updateProjective(sensed_points, image, intr, extr, range.dist_min, range.dist_max);
+    }
+
+
+    /// @brief Traces the rays and updates each VoxelGrid along them. See `update`.
+    /// @param sensed_points A set of measurements which act as the end points for a collection of rays.
+    /// @param origin Common origin of the sensed points.
+    void traceAndApply(const PointMatrix& all_sensed_points, const Point& origin)
+    {
+        const uint32_t* weights = nullptr;
+        size_t n_rays = 0;
+        const PointMatrix& sensed_points = this->mergeEndpoints(all_sensed_points, weights, n_rays);
+
+        const OccupancyPyramid* skip_pyramid = this->getSkipPyramid();
+        if (skip_pyramid != nullptr)
+        {
+            this->holdNearSensed(sensed_points, n_rays);
+        }
+        if (this->grid_properties->getNumVoxels() > TraceBatch::max_num_voxels)
+        {
+            FS_PROFILE_COUNT(RAYS_TRACED, static_cast<uint64_t>(n_rays));
+            for (size_t c = 0; c < n_rays; ++c)
+            {
+                bool hit = false;
+                {
+                    FS_PROFILE_SCOPE(TRACE, nullptr);
+                    hit = get_ray_trace(this->ray_trace, sensed_points.col(c), origin, this->grid_properties,
+                                        this->min_dist_min, this->max_dist_max, skip_pyramid, this->skip_dist,
+                                        weights ? weights[c] : 1);
+                }
+                if (hit)
+                {
+                    FS_PROFILE_COUNT(VOXELS_VISITED, this->ray_trace->size());
+                    this->applyTrace(this->ray_trace);
+                }
+                else
+                {
+                    FS_PROFILE_COUNT(RAYS_REJECTED, 1);
+                }
+            }
+        }
+        else if (this->n_threads > 1 && !this->grid_properties->sparse && n_rays > 1)
+        {
+            this->updateParallel(sensed_points, n_rays, origin, skip_pyramid, weights);
+        }
+        else
+        {
+            for (size_t batch_start = 0; batch_start < n_rays; batch_start += Reconstruction::rays_per_batch)
+            {
+                {
+                    FS_PROFILE_SCOPE(TRACE, nullptr);
+                    const size_t n_batch = std::min(Reconstruction::rays_per_batch, n_rays - batch_start);
+                    this->trace_batch->clear();
+                    get_ray_trace_batch(this->trace_batch, sensed_points, origin, this->grid_properties,
+                                        this->min_dist_min, this->max_dist_max,
+                                        batch_start, n_batch, skip_pyramid, this->skip_dist, weights);
+                    Reconstruction::countTraced(*this->trace_batch, n_batch);
+                }
+                this->applyTraceBatch(this->trace_batch);
+            }
+        }
+    }
+
+
+    /// @brief Traces each batch of rays once and applies it to every Reconstruction of a group.
+    ///        See the static `update`.
+    /// @param group Reconstructions with the same distance range and endpoint merging. `beginUpdate`
+    ///              must already have been called for each.
+    /// @param all_sensed_points A set of measurements which act as the end points for a collection of rays.
+    /// @param origin Common origin of the sensed points.
+    /// @param n_threads Number of threads to apply the traces with.
+    /// @throws Rethrows the first exception encountered by any thread once all threads have joined.
+    static void updateShared(const std::vector<std::shared_ptr<Reconstruction>>& group,
+                             const PointMatrix& all_sensed_points, const Point& origin, const size_t& n_threads)
+    {
+        const std::shared_ptr<Reconstruction>& lead = group.front();
+
+        const uint32_t* weights = nullptr;
+        size_t n_rays = 0;
+        const PointMatrix& sensed_points = lead->mergeEndpoints(all_sensed_points, weights, n_rays);
+
+        const size_t n_workers = std::min(group.size(), n_threads);
+        auto trace = [&](const size_t& batch_start)
+        {
+            FS_PROFILE_SCOPE(TRACE, nullptr);
+            const size_t n_batch = std::min(Reconstruction::rays_per_batch, n_rays - batch_start);
+            lead->trace_batch->clear();
+            get_ray_trace_batch(lead->trace_batch, sensed_points, origin, lead->grid_properties,
+                                lead->min_dist_min, lead->max_dist_max, batch_start, n_batch,
+                                nullptr, INFINITY, weights);
+            Reconstruction::countTraced(*lead->trace_batch, n_batch);
+        };
+
+        if (n_workers <= 1)
+        {
+            for (size_t batch_start = 0; batch_start < n_rays; batch_start += Reconstruction::rays_per_batch)
+            {
+                trace(batch_start);
+                for (const auto& reconstruction : group)
+                {
+                    reconstruction->applyTraceBatch(lead->trace_batch);
+                }
+            }
+            return;
+        }
+
+        // Thread 0 traces each batch. Then every thread applies it to its own Reconstructions.
+        utilities::Barrier barrier(n_workers);
+        std::atomic<bool>  failed(false);
+        std::exception_ptr error = nullptr;
+        std::mutex         error_mutex;
+
+        auto record_error = [&failed, &error, &error_mutex]()
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (error == nullptr)
+            {
+                error = std::current_exception();
+            }
+            failed = true;
+        };
+
+        auto worker = [&](const size_t t)
+        {
+            for (size_t batch_start = 0; batch_start < n_rays; batch_start += Reconstruction::rays_per_batch)
+            {
+                if (t == 0 && !failed)
+                {
+                    try
+                    {
+                        trace(batch_start);
+                    }
+                    catch (...)
+                    {
+                        record_error();
+                    }
+                }
+                barrier.wait();
+
+                for (size_t r = t; r < group.size() && !failed; r += n_workers)
+                {
+                    try
+                    {
+                        group[r]->applyTraceBatch(lead->trace_batch);
+                    }
+                    catch (...)
+                    {
+                        record_error();
+                    }
+                }
+                barrier.wait();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(n_workers - 1);
+        for (size_t t = 1; t < n_workers; ++t)
+        {
+            threads.emplace_back(worker, t);
+        }
+        worker(0);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        if (error != nullptr)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+
+    /// @brief Marks every chunk as changed, if change tracking is enabled. See `enableChangeTracking`.
+    void markAllChanged()
+    {
+        if (this->changed_chunks)
+        {
+            for (size_t c = 0; c < this->changed_chunks->size(); ++c)
+            {
+                this->changed_chunks->set(c);
+                this->touched_chunks->set(c);
+            }
+        }
+    }
+
+
+    /// @brief Marks the chunks a move of the window changed, if change tracking is enabled. Used by
+    ///        `shiftWindow` once the data is moved.
+    /// @param axis  Axis the window moved along.
+    /// @param steps Number of voxels it moved by.
+    /// @details A chunk which held only untouched voxels, and now holds only untouched voxels, is
+    ///          the same as before. Any other chunk is marked. Voxels a channel changes next to the
+    ///          traced ones, see `VoxelGrid::getChangeRadius`, are in the layers `Checkpoint::copy`
+    ///          reads next to each marked chunk.
+    void markShiftedChanged(const size_t& axis, const int& steps)
+    {
+        if (!this->changed_chunks)
+        {
+            return;
+        }
+        const GridSize n_chunks = this->grid_properties->getNumChunks();
+        const size_t stride[3]  = {1, n_chunks[0], n_chunks[0] * n_chunks[1]};
+        const long   edge       = long(1) << Grid::Properties::chunk_bits;
+        const long   n          = static_cast<long>(this->grid_properties->size[axis]);
+
+        auto touched = std::make_shared<Bitset>(this->touched_chunks->size());
+        for (size_t c = 0; c < touched->size(); ++c)
+        {
+            // The chunk now holds the layers `steps` above its own, which were in at most two chunks
+            // along the axis. Layers moved in from outside the Grid are untouched.
+            const size_t k     = (c / stride[axis]) % n_chunks[axis];
+            const size_t row   = c - k * stride[axis];
+            const long   first = std::max(static_cast<long>(k) * edge + steps, long(0));
+            const long   last  = std::min(std::min(static_cast<long>(k + 1) * edge, n) + steps, n);
+            for (long k_from = first / edge; first < last && k_from <= (last - 1) / edge; ++k_from)
+            {
+                if (this->touched_chunks->test(row + static_cast<size_t>(k_from) * stride[axis]))
+                {
+                    touched->set(c);
+                    break;
+                }
+            }
+            if (touched->test(c) || this->touched_chunks->test(c))
+            {
+                this->changed_chunks->set(c);
+            }
+        }
+        this->touched_chunks = touched;
+    }
+
+
+    /// @brief Writes the seen data and each channel's data for a slab of the Grid into a new group.
+    ///        Used by `shiftWindow`.
+    /// @param g_evicted Group to create the slab's group in.
+    /// @param axis  Axis across which the slab is cut.
+    /// @param first First layer of voxels along the axis in the slab.
+    /// @param last  One past the last layer of voxels along the axis in the slab.
+    /// @param options Chunking and compression for the data sets.
+    void writeSlab(HighFive::Group& g_evicted, const size_t& axis, const size_t& first, const size_t& last,
+                   const utilities::DataSetOptions& options)
+    {
+        std::lock_guard<std::recursive_mutex> hdf5_lock(utilities::hdf5Mutex());
+        GridSize size = this->grid_properties->size;
+        size[axis] = last - first;
+        Eigen::Vector3i lower = this->window_offset;
+        lower[axis] += static_cast<int>(first);
+
+        HighFive::Group g_slab = g_evicted.createGroup("Slab " + std::to_string(this->n_evicted_slabs++));
+        g_slab.createAttribute("Lower Voxel", lower);
+        g_slab.createAttribute("Size",        size);
+        g_slab.createAttribute("Updates",     this->n_updates);
+
+        std::vector<uint8_t> seen_bytes;
+        seen_bytes.reserve(size.prod());
+        this->grid_properties->forEachInSlab(axis, first, last, [&](const size_t& i)
+        {
+            seen_bytes.push_back(this->data_seen->test(i));
+        });
+        options.createDataSet(g_slab, Snapshot::seen_dset_name, seen_bytes, size);
+
+        for (const auto& item : this->channels)
+        {
+            std::visit([&](const auto& vector)
+            {
+                using T = typename std::decay_t<decltype(vector)>::value_type;
+                std::vector<T> slab;
+                slab.reserve(size.prod());
+                this->grid_properties->forEachInSlab(axis, first, last, [&](const size_t& i)
+                {
+                    slab.push_back(vector[i]);
+                });
+                options.createDataSet(g_slab, item.first, slab, size);
+            }, item.second->getData());
+        }
     }
 
 
-    /// @brief Updates each VoxelGrid based on the provided set of rays.
+    /// @brief Merges the sensed points which end in the same voxel, as set by `setEndpointMerge`.
     /// @param sensed_points A set of measurements which act as the end points for a collection of rays.
-    /// @param origin Common origin of the sensed points.
-    /// @note Both `sensed` and `origin` are assumed to be in the Reconstruction's reference frame.
-    void update(const PointMatrix& sensed_points, const Point& origin)
+    /// @param [out] weights Set to the number of sensed points each merged point stands in for, or
+    ///                      to null if nothing was merged.
+    /// @param [out] n_rays Set to the number of points to trace: the first `n_rays` columns of the
+    ///                     returned matrix.
+    /// @return The merged points, in the order their voxels were first reached, or `sensed_points`
+    ///         itself if the points are not merged.
+    /// @note  The merged points are kept in a buffer which only grows, so updates of a similar size
+    ///        do not allocate. It may have more columns than `n_rays`.
+    const PointMatrix& mergeEndpoints(const PointMatrix& sensed_points, const uint32_t*& weights, size_t& n_rays)
     {
-        for (const auto& sensed : sensed_points.colwise())
+        weights = nullptr;
+        const size_t n_points = static_cast<size_t>(sensed_points.cols());
+        n_rays = n_points;
+        if (this->endpoint_merge == EndpointMerge::NONE || n_points < 2)
+        {
+            return sensed_points;
+        }
+
+        if (static_cast<size_t>(this->merged_points.cols()) < n_points)
+        {
+            this->merged_points.resize(3, n_points);
+        }
+        this->merged_weights.clear();
+        this->merge_bins.clear();
+        const bool centroid = this->endpoint_merge == EndpointMerge::CENTROID;
+
+        size_t n_merged = 0;
+        for (size_t c = 0; c < n_points; ++c)
         {
-            if(get_ray_trace(this->ray_trace, sensed, origin, this->grid_properties,
-                             this->min_dist_min, this->max_dist_max))
+            const Point sensed = sensed_points.col(c);
+            const Index voxel  = this->grid_properties->pointToIndex(sensed);
+            if (this->grid_properties->indexIsValid(voxel))
             {
-                for (auto it = this->ray_trace->first_above(0.0f); it != this->ray_trace->end(); ++it)
+                const auto bin = this->merge_bins.try_emplace((*this->grid_properties)[voxel],
+                                                              static_cast<uint32_t>(n_merged));
+                if (!bin.second)
                 {
-                    this->data_seen->operator[](it->i) = true;
+                    const uint32_t m = bin.first->second;
+                    ++this->merged_weights[m];
+                    if (centroid)
+                    {
+                        this->merged_points.col(m) += sensed;
+                    }
+                    continue;
                 }
+            }
+            this->merged_points.col(n_merged) = sensed;
+            this->merged_weights.push_back(1);
+            ++n_merged;
+        }
 
-                for (const auto& item : this->channels)
+        if (centroid)
+        {
+            for (size_t m = 0; m < n_merged; ++m)
+            {
+                if (this->merged_weights[m] > 1)
                 {
-                    item.second->update(this->ray_trace);
+                    this->merged_points.col(m) /= static_cast<float>(this->merged_weights[m]);
                 }
             }
         }
+        FS_PROFILE_COUNT(RAYS_MERGED, n_points - n_merged);
+        weights = this->merged_weights.data();
+        n_rays  = n_merged;
+        return this->merged_points;
+    }
+
+
+    /// @brief Counts the rays of a freshly traced batch for the Profiler.
+    /// @param batch Batch the rays were traced into. It must have been empty before tracing.
+    /// @param n_rays Number of rays traced, including those which missed the Grid.
+    static void countTraced([[maybe_unused]] const TraceBatch& batch, [[maybe_unused]] const size_t& n_rays)
+    {
+        FS_PROFILE_COUNT(RAYS_TRACED,    n_rays);
+        FS_PROFILE_COUNT(RAYS_REJECTED,  n_rays - batch.numRays());
+        FS_PROFILE_COUNT(VOXELS_VISITED, batch.numVoxels());
+    }
+
+
+    /// @brief Holds the voxels near each sensed point in the pyramid of the saturation-aware update.
+    /// @param sensed_points A set of measurements which act as the end points for a collection of rays.
+    /// @param n_rays Number of columns of `sensed_points` to hold the voxels near.
+    /// @details The traces of an update are made before the VoxelGrids are updated along them. Along
+    ///          one ray, a VoxelGrid may change a voxel within its distance range of the sensed point
+    ///          such that it is no longer saturated. Another ray of the same update must still visit
+    ///          it, so no voxel this close to any sensed point is skipped.
+    void holdNearSensed(const PointMatrix& sensed_points, const size_t& n_rays)
+    {
+        const float reach  = std::max(this->skip_dist, -this->min_dist_min) / this->grid_properties->resolution;
+        const size_t radius = static_cast<size_t>(std::ceil(reach)) + 1;
+
+        const Eigen::Array3f lower = Eigen::Array3f::Constant(-1.0f - radius);
+        const Eigen::Array3f upper = this->grid_properties->size.cast<float>().array() + radius;
+        std::vector<Eigen::Vector3i>& voxels = this->held_voxels;
+        voxels.clear();
+        for (const auto& sensed : sensed_points.leftCols(n_rays).colwise())
+        {
+            const Eigen::Array3f v = (sensed.array() / this->grid_properties->resolution).round();
+            voxels.push_back(v.max(lower).min(upper).cast<int>().matrix());
+        }
+        this->skip_pyramid->hold(voxels, radius);
+    }
+
+
+    /// @brief Marks the positive region of the trace as seen and updates each VoxelGrid along it.
+    /// @param trace A trace to update the VoxelGrids along.
+    void applyTrace(const std::shared_ptr<Trace>& trace)
+    {
+        for (auto it = trace->first_above(0.0f); it != trace->end(); ++it)
+        {
+            this->data_seen->set(it->i);
+        }
+        if (this->data_updated)
+        {
+            for (auto it = trace->begin(); it != trace->end(); ++it)
+            {
+                this->data_updated->set(it->i);
+            }
+        }
+
+        // Converted once here, rather than for each channel, to not change the reference count for each.
+        const std::shared_ptr<const Trace> const_trace = trace;
         for (const auto& item : this->channels)
         {
-            item.second->postUpdate();
+            if (this->isRayChannel(*item.second))
+            {
+                FS_PROFILE_SCOPE(CHANNEL_UPDATE, item.first.c_str());
+                item.second->update(const_trace);
+            }
         }
     }
 
 
-    /// @brief Adds a VoxelGrid data channel to the Reconstruction.
-    /// @param parser ArgParser with arguments to construct a new VoxelGrid from.
-    ///               See `forge_scan::data::Reconstruction::addChannel` for details.
-    /// @throws InvalidMapKey If no name was provided for the channel.
-    /// @throws InvalidMapKey If there is already a channel with that name.
-    /// @throws ReservedMapKey if the channel name is reserved for Metrics or Policies.
-    /// @throws Any exceptions thrown by `Constructor::create` pass through this.
-    void addChannel(const utilities::ArgParser& parser)
+    /// @brief Marks the positive region of each trace in the batch as seen and updates each
+    ///        VoxelGrid along the batch.
+    /// @param batch A batch of traces to update the VoxelGrids along.
+    /// @note  Each VoxelGrid is updated along the whole batch in turn. Applying the batch in small
+    ///        tiles of rays across every VoxelGrid, to keep a tile's traces in cache, was measured
+    ///        on a 200^3 Grid with four channels and was no faster, and at times slower: each
+    ///        VoxelGrid reads the batch in order, which the hardware prefetches well.
+    void applyTraceBatch(const std::shared_ptr<TraceBatch>& batch)
     {
-        std::string channel_name = parser.get(Reconstruction::parse_name);
-        if (channel_name.empty())
+        if (batch->numRays() == 0)
         {
-            throw InvalidMapKey::NoNameProvided();
+            return;
         }
-        else if (this->channels.count(channel_name) == 1)
+
+        this->markSeen(batch);
+        const std::shared_ptr<const TraceBatch> const_batch = batch;
+        for (const auto& item : this->channels)
         {
-            throw InvalidMapKey::NameAlreadyExists(channel_name);
+            if (this->isRayChannel(*item.second))
+            {
+                FS_PROFILE_SCOPE(CHANNEL_UPDATE, item.first.c_str());
+                item.second->update(const_batch);
+            }
         }
-        this->checkChannelNameIsNotReserved(channel_name);
-        std::shared_ptr<VoxelGrid> voxel_grid  = Constructor::create(parser, this->grid_properties);
-        voxel_grid->addSeenData(this->data_seen);
-        this->channels.insert( {channel_name, voxel_grid} );
-        this->updateMinAndMaxDist();
     }
 
 
-    /// @brief Gets a constant reference to the VoxelGrid data channel.
-    /// @param name Name of the channel in the channel dictionary to retrieve.
-    /// @returns Read-only reference to the requested VoxelGrid data channel.
-    /// @throws InvalidMapKey If a channel with that name does not exist.
-    std::shared_ptr<const forge_scan::data::VoxelGrid> getChannelView(const std::string& name) const
+    /// @brief Marks the positive region of each trace in the batch as seen. If update tracking is
+    ///        enabled, also marks the whole of each ray as updated.
+    /// @param batch A batch of traces.
+    /// @note  This uses the non-atomic `Bitset::set`. That is safe in the parallel update because
+    ///        each thread only holds voxels in its own shard, and shards never share a word.
+    void markSeen(const std::shared_ptr<TraceBatch>& batch)
     {
-        return this->getChannelRef(name);
+        for (size_t r = 0; r < batch->numRays(); ++r)
+        {
+            const TraceBatch::Ray ray = batch->ray(r);
+            for (auto it = ray.first_above(0.0f); it != ray.end(); ++it)
+            {
+                this->data_seen->set(it->i);
+            }
+            if (this->data_updated)
+            {
+                for (auto it = ray.begin(); it != ray.end(); ++it)
+                {
+                    this->data_updated->set(it->i);
+                }
+            }
+        }
     }
 
 
-    /// @brief Gets a reference to the VoxelGrid data channel.
-    /// @param name Name of the channel in the channel dictionary to retrieve.
-    /// @returns Reference to the requested VoxelGrid data channel.
-    /// @throws InvalidMapKey If a channel with that name does not exist.
-    std::shared_ptr<forge_scan::data::VoxelGrid> getChannelRef(const std::string& name) const
+    /// @brief Returns true if the VoxelGrid is updated along the traced rays. This is every VoxelGrid,
+    ///        except those supporting the projective update during a projective update.
+    bool isRayChannel(const VoxelGrid& channel) const
     {
-        for (auto iter = this->channels.begin(); iter != this->channels.end(); ++iter)
+        return !this->projective_pass || !channel.hasProjectiveUpdate();
+    }
+
+
+    /// @brief Implements the projective update for the VoxelGrids which support it.
+    /// @param sensed_points The depth image's Points, in the Reconstruction's reference frame.
+    /// @param image Depth image.
+    /// @param intr  Intrinsics of the camera which took the image.
+    /// @param extr  Pose of the camera, in the Reconstruction's reference frame.
+    /// @param dist_min Minimum distance of any VoxelGrid supporting the projective update.
+    /// @param dist_max Maximum distance of any VoxelGrid supporting the projective update.
+    /// @throws Rethrows the first exception encountered by any thread once all threads have joined.
+    /// @details The blocks of the Grid within the truncation band of any sensed point are found
+    ///          first, so free space far from the surface is never projected. Each thread then
+    ///          samples every `n_threads`-th block into its own TraceBatch, one ray per block, see
+    ///          `projective_trace::get_block_samples`, and updates the VoxelGrids along it. Every
+    ///          voxel is sampled once, so the threads never update the same voxel.
+    /// @note  Grids with sparse storage are updated by one thread because allocating a block in a
+    ///        `SparseVector` is not thread-safe.
+    void updateProjective(const PointMatrix& sensed_points, const DepthImage& image,
+                          const sensor::Intrinsics& intr, const Extrinsic& extr,
+                          const float& dist_min, const float& dist_max)
+    {
+        const size_t shift    = Reconstruction::projective_block_shift;
+        const size_t n_blocks = projective_trace::get_num_blocks(this->grid_properties, shift).prod();
+        if (!this->projective_blocks || this->projective_blocks->size() != n_blocks)
         {
-            if (iter->first == name)
+            this->projective_blocks = std::make_shared<Bitset>(n_blocks);
+        }
+        else
+        {
+            this->projective_blocks->reset();
+        }
+        projective_trace::mark_blocks(*this->projective_blocks, sensed_points, extr.translation(),
+                                      this->grid_properties, dist_min, dist_max, shift);
+
+        std::vector<size_t>& blocks = this->projective_block_list;
+        blocks.clear();
+        this->projective_blocks->forEachSet([&blocks](const size_t& b) { blocks.push_back(b); });
+
+        const size_t n_threads = this->grid_properties->sparse ? 1 :
+                                 std::max(size_t(1), std::min(this->n_threads, blocks.size()));
+        while (this->thread_batches.size() < n_threads)
+        {
+            this->thread_batches.push_back(std::make_shared<TraceBatch>());
+            this->shard_batches.push_back(std::make_shared<TraceBatch>());
+        }
+        if (this->thread_samples.size() < n_threads)
+        {
+            this->thread_samples.resize(n_threads);
+        }
+
+        std::atomic<bool>  failed(false);
+        std::exception_ptr error = nullptr;
+        std::mutex         error_mutex;
+
+        auto worker = [&](const size_t t)
+        {
+            try
             {
-                return iter->second;
+                const std::shared_ptr<TraceBatch>& thread_batch = this->thread_batches[t];
+                std::vector<TraceBatch::Voxel>& samples = this->thread_samples[t];
+                thread_batch->clear();
+                for (size_t b = t; b < blocks.size() && !failed; b += n_threads)
+                {
+                    FS_PROFILE_SCOPE(TRACE, nullptr);
+                    projective_trace::get_block_samples(*thread_batch, samples, image, intr, extr,
+                                                        this->grid_properties, dist_min, dist_max,
+                                                        blocks[b], shift);
+                    if (thread_batch->numVoxels() >= Reconstruction::voxels_per_projective_batch)
+                    {
+                        this->applyProjectiveBatch(thread_batch, n_threads > 1);
+                        thread_batch->clear();
+                    }
+                }
+                this->applyProjectiveBatch(thread_batch, n_threads > 1);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (error == nullptr)
+                {
+                    error = std::current_exception();
+                }
+                failed = true;
             }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(n_threads - 1);
+        for (size_t t = 1; t < n_threads; ++t)
+        {
+            threads.emplace_back(worker, t);
+        }
+        worker(0);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        if (error != nullptr)
+        {
+            std::rethrow_exception(error);
         }
-        throw InvalidMapKey::NonexistantValue(name);
     }
 
 
-    /// @brief Removes a VoxelGrid data channel.
-    /// @param name Name of the channel in the channel dictionary to remove.
-    /// @returns True if successful. False if that channel did not exits or if it is owned by a
-    ///          Metric or a Policy.
-    bool removeChannel(const std::string& name)
+    /// @brief Marks the positive region of each ray of a projective batch as seen, and the whole of
+    ///        each as updated, then updates each VoxelGrid supporting the projective update along it.
+    /// @param batch A batch of block samples. See `updateProjective`.
+    /// @param atomic If true the seen and updated data are marked with `Bitset::setAtomic`, as the
+    ///               voxels of a block share words with those of blocks other threads sample.
+    void applyProjectiveBatch(const std::shared_ptr<TraceBatch>& batch, const bool& atomic)
     {
-        for (auto iter = this->channels.begin(); iter != this->channels.end(); ++iter)
+        auto mark = [&atomic](Bitset& bitset, const size_t& i)
         {
-            if (iter->first == name && iter->second.use_count() <= 1)
+            atomic ? bitset.setAtomic(i) : bitset.set(i);
+        };
+
+        for (size_t r = 0; r < batch->numRays(); ++r)
+        {
+            const TraceBatch::Ray ray = batch->ray(r);
+            for (auto it = ray.first_above(0.0f); it != ray.end(); ++it)
             {
-                this->channels.erase(iter);
-                return true;
+                mark(*this->data_seen, it->i);
+            }
+            if (this->data_updated)
+            {
+                for (auto it = ray.begin(); it != ray.end(); ++it)
+                {
+                    mark(*this->data_updated, it->i);
+                }
+            }
+        }
+
+        FS_PROFILE_COUNT(VOXELS_VISITED, batch->numVoxels());
+        const std::shared_ptr<const TraceBatch> const_batch = batch;
+        for (const auto& item : this->channels)
+        {
+            if (item.second->hasProjectiveUpdate())
+            {
+                FS_PROFILE_SCOPE(CHANNEL_UPDATE, item.first.c_str());
+                item.second->update(const_batch);
             }
         }
-        return false;
     }
 
 
+    /// @brief Implements the parallel update. Rays are processed in batches with two phases:
+    ///          1) Each thread traces a contiguous set of rays from the batch into its own TraceBatch
+    ///             and scatters its voxels into one piece for each shard of the Grid.
+    ///          2) Each thread gathers, in ray order, the pieces of all threads for the shard of the
+    ///             Grid it owns and applies them as one TraceBatch.
+    ///        Each traced voxel is therefore read once by the scatter and once by its shard's gather,
+    ///        no matter the number of threads.
+    ///        Because every voxel is owned by exactly one thread and each thread visits the rays in
+    ///        the same order as the serial update, every voxel sees the same sequence of updates as
+    ///        it would in the serial update. The results are therefore identical.
+    /// @param sensed_points A set of measurements which act as the end points for a collection of rays.
+    /// @param n_rays Number of columns of `sensed_points` to trace.
+    /// @param origin Common origin of the sensed points.
+    /// @param skip_pyramid Pyramid of the saturation-aware update, or nullptr.
+    /// @param weights Weight of each sensed point, or nullptr. See `mergeEndpoints`.
+    /// @throws Rethrows the first exception encountered by any thread once all threads have joined.
+    /// @note  Shards are interleaved stripes of `2^shard_shift` voxels. The stripe width is a
+    ///        multiple of the 64-bit words of `Bitset`, so threads never write to the same word
+    ///        of `data_seen`.
+    void updateParallel(const PointMatrix& sensed_points, const size_t& n_rays, const Point& origin,
+                        const OccupancyPyramid* skip_pyramid, const uint32_t* weights)
+    {
+        const size_t n_threads  = this->n_threads;
+        const size_t batch_size = std::min(n_rays, n_threads * Reconstruction::rays_per_thread_batch);
 
-    // ***************************************************************************************** //
-    // *                                 PUBLIC CLASS MEMBERS                                  * //
-    // ***************************************************************************************** //
+        while (this->thread_batches.size() < n_threads)
+        {
+            this->thread_batches.push_back(std::make_shared<TraceBatch>());
+            this->shard_batches.push_back(std::make_shared<TraceBatch>());
+        }
+        if (this->shard_pieces.size() != n_threads * n_threads)
+        {
+            this->shard_pieces.resize(n_threads * n_threads);
+            for (auto& piece : this->shard_pieces)
+            {
+                piece = std::make_shared<TraceBatch>();
+            }
+        }
 
+        utilities::Barrier barrier(n_threads);
+        std::atomic<bool>  failed(false);
+        std::exception_ptr error = nullptr;
+        std::mutex         error_mutex;
 
-    /// @brief Shared, constant `Grid::Properties` used by all VoxelGrids.
-    const std::shared_ptr<const Grid::Properties> grid_properties;
+        auto record_error = [&failed, &error, &error_mutex]()
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (error == nullptr)
+            {
+                error = std::current_exception();
+            }
+            failed = true;
+        };
 
-    static const std::string parse_name;
+        auto worker = [&](const size_t t)
+        {
+            auto shard_of = [n_threads](const size_t& i)
+            {
+                return (i >> Reconstruction::shard_shift) % n_threads;
+            };
+            const std::shared_ptr<TraceBatch>& thread_batch = this->thread_batches[t];
+            const std::shared_ptr<TraceBatch>& shard_batch  = this->shard_batches[t];
+            const std::shared_ptr<TraceBatch>* pieces       = this->shard_pieces.data() + t * n_threads;
 
+            for (size_t batch_start = 0; batch_start < n_rays; batch_start += batch_size)
+            {
+                const size_t n_batch   = std::min(batch_size, n_rays - batch_start);
+                const size_t per_thread = (n_batch + n_threads - 1) / n_threads;
+                const size_t first     = std::min(n_batch, t * per_thread);
+                const size_t last      = std::min(n_batch, first + per_thread);
 
-private:
-    // ***************************************************************************************** //
-    // *                                PRIVATE CLASS METHODS                                  * //
-    // ***************************************************************************************** //
+                if (!failed)
+                {
+                    try
+                    {
+                        FS_PROFILE_SCOPE(TRACE, nullptr);
+                        thread_batch->clear();
+                        get_ray_trace_batch(thread_batch, sensed_points, origin, this->grid_properties,
+                                            this->min_dist_min, this->max_dist_max,
+                                            batch_start + first, last - first, skip_pyramid, this->skip_dist,
+                                            weights);
+                        Reconstruction::countTraced(*thread_batch, last - first);
+                        for (size_t s = 0; s < n_threads; ++s)
+                        {
+                            pieces[s]->clear();
+                        }
+                        thread_batch->scatter(pieces, n_threads, shard_of);
+                    }
+                    catch (...)
+                    {
+                        record_error();
+                    }
+                }
+                barrier.wait();
 
+                if (!failed)
+                {
+                    try
+                    {
+                        shard_batch->clear();
+                        for (size_t s = 0; s < n_threads; ++s)
+                        {
+                            shard_batch->append(*this->shard_pieces[s * n_threads + t]);
+                        }
+                        this->applyTraceBatch(shard_batch);
+                    }
+                    catch (...)
+                    {
+                        record_error();
+                    }
+                }
+                barrier.wait();
+            }
+        };
 
-    /// @brief Private constructor to enforce use of shared pointers.
-    /// @param grid_properties Shared, constant pointer to the `Grid::Properties` to use.
-    ///                        These `Grid::Properties` are utilized by all VoxelGrids.
-    explicit Reconstruction(const std::shared_ptr<const Grid::Properties>& grid_properties)
-        : grid_properties(grid_properties),
-          data_seen(std::make_shared<std::vector<bool>>(this->grid_properties->getNumVoxels(), false)),
-          ray_trace(std::make_shared<Trace>())
-    {
+        std::vector<std::thread> threads;
+        threads.reserve(n_threads - 1);
+        for (size_t t = 1; t < n_threads; ++t)
+        {
+            threads.emplace_back(worker, t);
+        }
+        worker(0);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
 
+        if (error != nullptr)
+        {
+            std::rethrow_exception(error);
+        }
     }
 
 
     /// @brief Saves `Grid::Properties` into the HDF5 file as attributes and calls the save method
     ///        for each VoxelGrid in the channel dictionary.
     /// @param h5_file An opened HDF5 file to write data into.
-    void save(HighFive::File& h5_file)
+    /// @param options Chunking and compression for the VoxelGrid data sets.
+    /// @note  The seen data, the update count, the window offset, and the arguments each channel was
+    ///        added with are also saved so `load` may restore the Reconstruction. To save while the
+    ///        Reconstruction is being updated, save a Snapshot instead. See `getSnapshot`.
+    void save(HighFive::File& h5_file, const utilities::DataSetOptions& options = utilities::DataSetOptions())
     {
-        auto g_reconstruction = h5_file.createGroup(FS_HDF5_RECONSTRUCTION_GROUP);
+        Snapshot::write(h5_file, *this->grid_properties, this->n_updates, this->window_offset, *this->data_seen,
+                        this->channels, this->channel_args, options);
+    }
 
-        g_reconstruction.createAttribute("VoxelGrid Resolution", this->grid_properties->resolution);
-        g_reconstruction.createAttribute("VoxelGrid Dimensions", this->grid_properties->dimensions);
-        g_reconstruction.createAttribute("VoxelGrid Size",       this->grid_properties->size);
 
-        for (const auto& item : this->channels)
+    /// @brief Restores the Reconstruction from an HDF5 file written by `save`.
+    /// @param h5_file An opened HDF5 file to read data from.
+    /// @details Each channel in the file is read into the channel of the same name. Channels added
+    ///          with `addChannel` which do not exist yet are first added with the same arguments.
+    ///          Channels owned by a Metric or a Policy are only restored if that Metric or Policy
+    ///          has already been added, so that it has recreated its channel.
+    /// @throws GridPropertyError If the file's `Grid::Properties` do not match this Reconstruction's.
+    /// @throws Any exception encountered while reading the HDF5 file or adding a channel.
+    /// @note  The seen data's dirty index is cleared, so the next update is not incremental.
+    void load(const HighFive::File& h5_file)
+    {
+        auto g_reconstruction = h5_file.getGroup(FS_HDF5_RECONSTRUCTION_GROUP);
+
+        const float    resolution = g_reconstruction.getAttribute("VoxelGrid Resolution").read<float>();
+        const GridSize size       = g_reconstruction.getAttribute("VoxelGrid Size").read<GridSize>();
+        if (resolution != this->grid_properties->resolution || size != this->grid_properties->size)
+        {
+            throw GridPropertyError::PropertiesDoNotMatch("Reconstruction", "loaded Reconstruction");
+        }
+
+        // Files saved before checkpoints were supported do not have these.
+        if (g_reconstruction.hasAttribute("Updates"))
+        {
+            this->n_updates = g_reconstruction.getAttribute("Updates").read<size_t>();
+        }
+        this->window_offset = Eigen::Vector3i::Zero();
+        if (g_reconstruction.hasAttribute("Window Offset"))
+        {
+            this->window_offset = g_reconstruction.getAttribute("Window Offset").read<Eigen::Vector3i>();
+        }
+        if (g_reconstruction.exist(Snapshot::seen_dset_name))
+        {
+            std::vector<uint8_t> seen(this->data_seen->size());
+            g_reconstruction.getDataSet(Snapshot::seen_dset_name).read(seen);
+            seen = this->grid_properties->fromLinearOrder(seen);
+            this->data_seen->reset();
+            for (size_t i = 0; i < seen.size(); ++i)
+            {
+                if (seen[i] != 0)
+                {
+                    this->data_seen->set(i);
+                }
+            }
+            this->data_seen->clearDirty();
+        }
+
+        for (const auto& name : g_reconstruction.listObjectNames())
+        {
+            if (g_reconstruction.getObjectType(name) != HighFive::ObjectType::Group)
+            {
+                continue;
+            }
+            auto g_channel = g_reconstruction.getGroup(name);
+
+            if (this->channels.count(name) == 0)
+            {
+                if (!g_channel.hasAttribute(Snapshot::channel_args_attr_name))
+                {
+                    continue;
+                }
+                this->addChannel(utilities::ArgParser(
+                    g_channel.getAttribute(Snapshot::channel_args_attr_name).read<std::string>()));
+            }
+            const auto& channel = this->channels.at(name);
+            channel->load(g_channel, channel->getTypeName());
+        }
+        this->snapshot.reset();
+        if (this->skip_pyramid)
         {
-            HighFive::Group g_channel = g_reconstruction.createGroup(item.first);
-            item.second->save(g_channel, item.second->getTypeName());
+            this->skip_pyramid->markAll();
         }
+        this->markAllChanged();
     }
 
 
@@ -231,17 +1816,23 @@ private:
     }
 
 
-    /// @brief Helper to update the minimum min and maximum max values each time the channel dict
-    ///        changes.
+    /// @brief Helper to update the minimum min and maximum max values, and the skip distance, each
+    ///        time the channel dict changes.
     void updateMinAndMaxDist() {
         this->min_dist_min = 0;
         this->max_dist_max = 0;
+        this->skip_dist    = 0;
 
         for (const auto& item : this->channels)
         {
             // Record the most negative distance as min and most positive distance as max.
             this->min_dist_min = std::min(this->min_dist_min, item.second->dist_min);
             this->max_dist_max = std::max(this->max_dist_max, item.second->dist_max);
+            this->skip_dist    = std::max(this->skip_dist, item.second->getSkipDistance());
+        }
+        if (this->skip_pyramid)
+        {
+            this->skip_pyramid->markAll();
         }
 
         // Verify that we never have a case where the min is greater than the max.
@@ -273,6 +1864,7 @@ private:
 
         this->channels.insert( {channel_name, channel} );
         this->updateMinAndMaxDist();
+        this->snapshot.reset();
     }
 
 
@@ -297,6 +1889,7 @@ private:
 
         this->channels.insert( {channel_name, channel} );
         this->updateMinAndMaxDist();
+        this->snapshot.reset();
     }
 
 
@@ -306,6 +1899,15 @@ private:
     // ***************************************************************************************** //
 
 
+    /// @brief Gets the pyramid for the saturation-aware update.
+    /// @return Pointer to the pyramid, or nullptr if either the saturation-aware update is not used or
+    ///         no voxels may be skipped.
+    const OccupancyPyramid* getSkipPyramid() const
+    {
+        return this->skip_pyramid && this->skip_dist < INFINITY ? this->skip_pyramid.get() : nullptr;
+    }
+
+
     /// @brief Verifies that the requested channel name does not begin with a reserved prefix.
     /// @param name A channel name to check.
     /// @throws ReservedMapKey if the channel name is reserved for Metrics or Policies.
@@ -353,6 +1955,10 @@ private:
     /// @brief Dictionary mapping the name of a channel to its VoxelGrid.
     std::map<std::string, std::shared_ptr<VoxelGrid>> channels;
 
+    /// @brief Dictionary mapping the name of each channel added by `addChannel` to the arguments
+    ///        it was added with. These are saved so `load` may add the channel again.
+    std::map<std::string, std::string> channel_args;
+
     /// @brief Record the extreme min and max dist for across all VoxelGrids. This constrains ray
     ///        trace calculations to only the regions which VoxelGrids will actually update.
     float min_dist_min = 0, max_dist_max = 0;
@@ -360,16 +1966,136 @@ private:
     /// @brief Container of the same shape as `VoxelGrid::data` in any derived grid, but this stores
     ///        a boolean flag for if a voxel was intersected by the postive region of a ray at least.
     ///        It may be used by some grids in creating an occupancy data vector or in the update method.
-    std::shared_ptr<std::vector<bool>> data_seen;
+    std::shared_ptr<Bitset> data_seen;
+
+    /// @brief Record of the voxels traced by the most recent update. Null unless update tracking
+    ///        is enabled. See `enableUpdateTracking`.
+    std::shared_ptr<Bitset> data_updated{nullptr};
+
+    /// @brief One flag per chunk of the Grid, set if the chunk holds voxels changed since a
+    ///        `Checkpoint` last copied it. Null unless change tracking is enabled. See
+    ///        `enableChangeTracking`.
+    std::shared_ptr<Bitset> changed_chunks{nullptr};
+
+    /// @brief One flag per chunk of the Grid, set if the chunk may hold a voxel changed since the
+    ///        Reconstruction was made. Moved along with the data by `shiftWindow`, which uses it to
+    ///        skip chunks that were never reached. Null unless change tracking is enabled.
+    std::shared_ptr<Bitset> touched_chunks{nullptr};
+
+    /// @brief Number of times `update` has been called.
+    size_t n_updates = 0;
+
+    /// @brief Number of voxels the window has moved along each axis. See `shiftWindow`.
+    Eigen::Vector3i window_offset = Eigen::Vector3i::Zero();
+
+    /// @brief Number of slabs `shiftWindow` has written, which names the next one.
+    size_t n_evicted_slabs = 0;
+
+    /// @brief Snapshot taken since the last update or change to the channels, if any. See `getSnapshot`.
+    mutable std::shared_ptr<const Snapshot> snapshot{nullptr};
     
     /// @brief Stores an ray trace used for performing updates on each VoxelGrid.
     std::shared_ptr<Trace> ray_trace;
+
+    /// @brief Stores a batch of ray traces used for performing updates on each VoxelGrid.
+    std::shared_ptr<TraceBatch> trace_batch;
+
+    /// @brief Number of threads used by `update`. A value of 1 uses the serial update.
+    size_t n_threads = 1;
+
+    /// @brief Blocks of voxels which are seen and saturated in every channel. Null unless the
+    ///        saturation-aware update is used. See `setSkipSaturated`.
+    std::shared_ptr<OccupancyPyramid> skip_pyramid{nullptr};
+
+    /// @brief Distance along a ray past which voxels in `skip_pyramid` may be skipped. The furthest
+    ///        `VoxelGrid::getSkipDistance` of any channel.
+    float skip_dist = 0;
+
+    /// @brief If true the depth image `update` uses the projective update. See `setProjectiveUpdate`.
+    bool projective_update = false;
+
+    /// @brief How `update` merges sensed points ending in the same voxel. See `setEndpointMerge`.
+    EndpointMerge endpoint_merge = EndpointMerge::NONE;
+
+    /// @brief Merged sensed points, and how many points each stands in for. Reused between updates.
+    /// @note  `merged_points` only grows. The first `merged_weights.size()` columns are in use.
+    PointMatrix merged_points;
+    std::vector<uint32_t> merged_weights;
+
+    /// @brief Position in `merged_points` of the merged point for each voxel. Reused between updates.
+    std::unordered_map<size_t, uint32_t> merge_bins;
+
+    /// @brief True while the rays of a projective update are applied, so VoxelGrids supporting the
+    ///        projective update are not also updated along them. See `isRayChannel`.
+    bool projective_pass = false;
+
+    /// @brief Blocks of the Grid sampled by the projective update. Reused between updates.
+    std::shared_ptr<Bitset> projective_blocks{nullptr};
+
+    /// @brief Rays traced by each thread in the parallel update. Reused between updates.
+    std::vector<std::shared_ptr<TraceBatch>> thread_batches;
+
+    /// @brief Voxels in each thread's shard of the Grid in the parallel update. Reused between updates.
+    std::vector<std::shared_ptr<TraceBatch>> shard_batches;
+
+    /// @brief Voxels of each thread's rays in each shard of the parallel update. The piece of thread
+    ///        `t` for shard `s` is at `t * n_threads + s`. Reused between updates.
+    std::vector<std::shared_ptr<TraceBatch>> shard_pieces;
+
+    /// @brief Voxels near each sensed point, held by the saturation-aware update. Reused between updates.
+    std::vector<Eigen::Vector3i> held_voxels;
+
+    /// @brief Blocks marked for the projective update, in order. Reused between updates.
+    std::vector<size_t> projective_block_list;
+
+    /// @brief Samples of one block for each thread of the projective update. Reused between updates.
+    std::vector<std::vector<TraceBatch::Voxel>> thread_samples;
+
+    /// @brief Largest number of bytes the Reconstruction may use, or zero for no limit.
+    size_t memory_budget = 0;
+
+    /// @brief If true, channels which would exceed the memory budget may use compact data instead.
+    bool compact_fallback = false;
+
+    /// @brief Number of rays traced into each TraceBatch of the serial update.
+    static constexpr size_t rays_per_batch = 4096;
+
+    /// @brief Number of rays each thread traces per batch of the parallel update.
+    static constexpr size_t rays_per_thread_batch = 256;
+
+    /// @brief Shards in the parallel update are interleaved stripes of `2^shard_shift` voxels.
+    static constexpr size_t shard_shift = 12;
+
+    /// @brief Blocks of the projective update are `2^projective_block_shift` voxels on each side.
+    static constexpr size_t projective_block_shift = 3;
+
+    /// @brief Number of voxels sampled into each thread's TraceBatch before it is applied in the
+    ///        projective update.
+    static constexpr size_t voxels_per_projective_batch = 1 << 16;
 };
 
 
 /// @brief ArgParser key for the name of the Data Channel to be add.
 const std::string Reconstruction::parse_name = "--name";
 
+/// @brief ArgParser key for the number of threads the Reconstruction update uses.
+const std::string Reconstruction::parse_n_threads = "--n-threads";
+
+/// @brief ArgParser flag to use the saturation-aware update.
+const std::string Reconstruction::parse_skip_saturated = "--skip-saturated";
+
+/// @brief ArgParser flag to use the projective update.
+const std::string Reconstruction::parse_projective = "--projective";
+
+/// @brief ArgParser key for how the Reconstruction update merges sensed points ending in the same voxel.
+const std::string Reconstruction::parse_endpoint_merge = "--endpoint-merge";
+
+/// @brief ArgParser key for the memory budget of the Reconstruction, in megabytes.
+const std::string Reconstruction::parse_memory_budget = "--memory-budget";
+
+/// @brief ArgParser flag to create compact channels when the full channel exceeds the memory budget.
+const std::string Reconstruction::parse_compact_fallback = "--compact-fallback";
+
 
 } // namespace data
 } // namespace forge_scan
@@ -0,0 +1,252 @@
+#ifndef FORGE_SCAN_DATA_SNAPSHOT_HPP
+#define FORGE_SCAN_DATA_SNAPSHOT_HPP
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define H5_USE_EIGEN 1
+#include <highfive/H5File.hpp>
+
+#include "ForgeScan/Common/Bitset.hpp"
+#include "ForgeScan/Common/Definitions.hpp"
+#include "ForgeScan/Common/Exceptions.hpp"
+#include "ForgeScan/Data/VoxelGrids/VoxelGrid.hpp"
+#include "ForgeScan/Utilities/HDF5.hpp"
+#include "ForgeScan/Utilities/MemoryUse.hpp"
+
+
+namespace forge_scan {
+namespace data {
+
+
+/// @brief A read-only copy of the channels and seen data of a `data::Reconstruction`, as they were
+///        after one of its updates.
+/// @details A Snapshot shares nothing with the Reconstruction it was taken from, so it may be read,
+///          or saved, from any thread while the Reconstruction carries on being updated. Taking one
+///          copies each channel with `VoxelGrid::clone`, which is a copy of their data vectors. See
+///          `Reconstruction::getSnapshot`.
+/// @note  Each channel of the Snapshot sees the Snapshot's copy of the seen data.
+class Snapshot
+{
+public:
+    /// @brief Channels of the Snapshot, by name.
+    typedef std::map<std::string, std::shared_ptr<const VoxelGrid>> ChannelMap;
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Copies the state of a Reconstruction.
+    /// @param grid_properties Grid Properties of the Reconstruction.
+    /// @param n_updates Number of updates the Reconstruction has had.
+    /// @param window_offset Voxels the Reconstruction's window has moved along each axis.
+    /// @param seen Seen data of the Reconstruction.
+    /// @param channels Channels of the Reconstruction, by name.
+    /// @param channel_args Arguments each channel added through an ArgParser was created with.
+    /// @return Shared, constant pointer to the Snapshot.
+    /// @note  Nothing passed in may be written while the Snapshot is taken.
+    static std::shared_ptr<const Snapshot> create(const std::shared_ptr<const Grid::Properties>& grid_properties,
+                                                  const size_t& n_updates, const Eigen::Vector3i& window_offset,
+                                                  const Bitset& seen,
+                                                  const std::map<std::string, std::shared_ptr<VoxelGrid>>& channels,
+                                                  const std::map<std::string, std::string>& channel_args)
+    {
+        return std::shared_ptr<const Snapshot>(new Snapshot(grid_properties, n_updates, window_offset, seen,
+                                                            channels, channel_args));
+    }
+
+
+    /// @brief Gets a channel of the Snapshot.
+    /// @param name Name of the channel, as in the Reconstruction.
+    /// @return Read-only reference to the copy of the channel.
+    /// @throws InvalidMapKey If a channel with that name does not exist.
+    std::shared_ptr<const VoxelGrid> getChannel(const std::string& name) const
+    {
+        auto iter = this->channels.find(name);
+        if (iter == this->channels.end())
+        {
+            throw InvalidMapKey::NonexistantValue(name);
+        }
+        return iter->second;
+    }
+
+
+    /// @brief Gets every channel of the Snapshot, by name.
+    const ChannelMap& getChannels() const
+    {
+        return this->channels;
+    }
+
+
+    /// @brief Gets the copy of the seen data.
+    std::shared_ptr<const Bitset> getSeenData() const
+    {
+        return this->data_seen;
+    }
+
+
+    /// @brief Gets the number of updates the Reconstruction had when the Snapshot was taken.
+    const size_t& getNumUpdates() const
+    {
+        return this->n_updates;
+    }
+
+
+    /// @brief Calculates how much space the Snapshot is using for its channels and seen data.
+    utilities::memory_use::Usage getMemoryUsage() const
+    {
+        const size_t n_seen = this->data_seen->sizeBytes();
+        utilities::memory_use::Usage usage{n_seen, n_seen};
+        for (const auto& item : this->channels)
+        {
+            const utilities::memory_use::Usage channel = item.second->getMemoryUsage();
+            usage.size_bytes     += channel.size_bytes;
+            usage.capacity_bytes += channel.capacity_bytes;
+        }
+        return usage;
+    }
+
+
+    /// @brief Saves the Snapshot into an HDF5 file, as `Reconstruction::save` would have when the
+    ///        Snapshot was taken.
+    /// @param h5_file An opened HDF5 file to write data into.
+    /// @param options Chunking and compression for the VoxelGrid data sets.
+    void save(HighFive::File& h5_file, const utilities::DataSetOptions& options = utilities::DataSetOptions()) const
+    {
+        Snapshot::write(h5_file, *this->grid_properties, this->n_updates, this->window_offset, *this->data_seen,
+                        this->channels, this->channel_args, options);
+    }
+
+
+    /// @brief Adds each channel to the XDMF file which accompanies the HDF5 file `save` writes.
+    /// @param file An opened file stream.
+    /// @param hdf5_fname File name (not the full path) of the HDF5 file.
+    void addToXDMF(std::ofstream& file, const std::string& hdf5_fname) const
+    {
+        for (const auto& item : this->channels)
+        {
+            item.second->addToXDMF(file, hdf5_fname, item.first, item.second->getTypeName());
+        }
+    }
+
+
+    /// @brief Writes the `Grid::Properties`, update count, window offset, seen data and channels of
+    ///        a Reconstruction into an HDF5 file. Used by `save` and by `Reconstruction::save`.
+    /// @param h5_file An opened HDF5 file to write data into.
+    /// @param grid_properties Grid Properties of the Reconstruction.
+    /// @param n_updates Number of updates the Reconstruction has had.
+    /// @param window_offset Voxels the Reconstruction's window has moved along each axis. This is
+    ///                      only written if it is not zero.
+    /// @param seen Seen data of the Reconstruction.
+    /// @param channels Channels of the Reconstruction, by name.
+    /// @param channel_args Arguments each channel added through an ArgParser was created with.
+    /// @param options Chunking and compression for the VoxelGrid data sets.
+    template <typename Channels>
+    static void write(HighFive::File& h5_file, const Grid::Properties& grid_properties,
+                      const size_t& n_updates, const Eigen::Vector3i& window_offset,
+                      const Bitset& seen, const Channels& channels,
+                      const std::map<std::string, std::string>& channel_args,
+                      const utilities::DataSetOptions& options)
+    {
+        auto g_reconstruction = h5_file.createGroup(FS_HDF5_RECONSTRUCTION_GROUP);
+
+        g_reconstruction.createAttribute("VoxelGrid Resolution", grid_properties.resolution);
+        g_reconstruction.createAttribute("VoxelGrid Dimensions", grid_properties.dimensions);
+        g_reconstruction.createAttribute("VoxelGrid Size",       grid_properties.size);
+        g_reconstruction.createAttribute("Updates",              n_updates);
+        if (!window_offset.isZero())
+        {
+            g_reconstruction.createAttribute("Window Offset", window_offset);
+        }
+
+        std::vector<uint8_t> seen_bytes(seen.size());
+        for (size_t i = 0; i < seen_bytes.size(); ++i)
+        {
+            seen_bytes[i] = seen.test(i);
+        }
+        options.createDataSet(g_reconstruction, Snapshot::seen_dset_name,
+                              grid_properties.toLinearOrder(seen_bytes), grid_properties.size);
+
+        for (const auto& item : channels)
+        {
+            HighFive::Group g_channel = g_reconstruction.createGroup(item.first);
+            item.second->save(g_channel, item.second->getTypeName(), options);
+
+            auto args = channel_args.find(item.first);
+            if (args != channel_args.end())
+            {
+                g_channel.createAttribute(Snapshot::channel_args_attr_name, args->second);
+            }
+        }
+    }
+
+
+    /// @brief Name of the data set for the seen data. This has a space, so no channel may share it.
+    static constexpr const char* seen_dset_name = "VoxelGrid Seen";
+
+    /// @brief Name of the attribute holding the arguments a channel was added with.
+    static constexpr const char* channel_args_attr_name = "Arguments";
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Private constructor to enforce shared pointer usage. See `create`.
+    Snapshot(const std::shared_ptr<const Grid::Properties>& grid_properties,
+             const size_t& n_updates, const Eigen::Vector3i& window_offset, const Bitset& seen,
+             const std::map<std::string, std::shared_ptr<VoxelGrid>>& channels,
+             const std::map<std::string, std::string>& channel_args)
+        : grid_properties(grid_properties),
+          n_updates(n_updates),
+          window_offset(window_offset),
+          data_seen(std::make_shared<Bitset>(seen)),
+          channel_args(channel_args)
+    {
+        for (const auto& item : channels)
+        {
+            std::shared_ptr<VoxelGrid> copy = item.second->clone();
+            copy->addSeenData(this->data_seen);
+            this->channels.insert({item.first, copy});
+        }
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Grid Properties of the Reconstruction.
+    const std::shared_ptr<const Grid::Properties> grid_properties;
+
+    /// @brief Number of updates the Reconstruction had when the Snapshot was taken.
+    const size_t n_updates;
+
+    /// @brief Voxels the Reconstruction's window had moved along each axis.
+    const Eigen::Vector3i window_offset;
+
+    /// @brief Copy of the seen data.
+    const std::shared_ptr<const Bitset> data_seen;
+
+    /// @brief Copy of each channel.
+    ChannelMap channels;
+
+    /// @brief Arguments each channel added through an ArgParser was created with.
+    const std::map<std::string, std::string> channel_args;
+};
+
+
+} // namespace data
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_DATA_SNAPSHOT_HPP
@@ -0,0 +1,515 @@
+#ifndef FORGE_SCAN_DATA_SURFACE_MESH_HPP
+#define FORGE_SCAN_DATA_SURFACE_MESH_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "ForgeScan/Common/Bitset.hpp"
+#include "ForgeScan/Common/Definitions.hpp"
+#include "ForgeScan/Common/Exceptions.hpp"
+#include "ForgeScan/Common/MarchingCubes.hpp"
+#include "ForgeScan/Common/Quantizer.hpp"
+#include "ForgeScan/Data/Reconstruction.hpp"
+#include "ForgeScan/Data/VoxelGrids/BinaryTSDF.hpp"
+#include "ForgeScan/Data/VoxelGrids/TSDF.hpp"
+#include "ForgeScan/Utilities/Files.hpp"
+#include "ForgeScan/Utilities/Threads.hpp"
+
+
+namespace forge_scan {
+namespace data {
+
+
+/// @brief Triangle mesh of the surface in a `TSDF` or `BinaryTSDF` channel of a Reconstruction,
+///        found by marching cubes and kept in blocks of the Grid.
+/// @details Each cell between eight neighbouring voxels is meshed with `marching_cubes`. The cells
+///          are grouped into cubic blocks and the mesh of each block is kept, so `update` only meshes
+///          again the blocks holding voxels which updates have traced since it was last called. These
+///          are found with the Reconstruction's update tracking, which this enables, by calling
+///          `markUpdated` after each update. The blocks are meshed with the Reconstruction's threads.
+/// @note  A cell is only meshed if every corner has been measured, that is its distance is not the
+///        channel's default or the voxel is seen, so no surface is made along the edge of the
+///        measured region.
+/// @note  Once meshed, a block is never changed, only replaced. The list from `getBlocks` may then be
+///        read, or saved, from any thread while the Reconstruction carries on being updated.
+class SurfaceMesh
+{
+public:
+    /// @brief Mesh of the cells of one block.
+    struct Block
+    {
+        /// @brief Position of each vertex, in the Reconstruction's frame.
+        std::vector<Point> vertices;
+
+        /// @brief Grid edge each vertex lies on. Blocks which meet share the vertices on the same edge.
+        std::vector<uint64_t> edges;
+
+        /// @brief Vertices of each triangle, three at a time, as positions in `vertices`.
+        std::vector<uint32_t> triangles;
+    };
+
+
+    /// @brief Mesh of each block of the Grid, in order, or nullptr for blocks with no triangles.
+    typedef std::vector<std::shared_ptr<const Block>> BlockList;
+
+
+    /// @brief One mesh made from the blocks, with the vertices the blocks share merged.
+    struct Mesh
+    {
+        /// @brief Position of each vertex, in the Reconstruction's frame.
+        PointMatrix vertices;
+
+        /// @brief Vertices of each triangle, as columns of `vertices`. Triangles wind counter-clockwise
+        ///        seen from outside the surface.
+        Eigen::Matrix<uint32_t, 3, Eigen::Dynamic> triangles;
+    };
+
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Creates a SurfaceMesh for a channel of a Reconstruction. Every block is stale until
+    ///        the first `update`.
+    /// @param reconstruction Reconstruction to mesh. Its update tracking is enabled.
+    /// @param channel Name of the `TSDF` or `BinaryTSDF` channel to mesh.
+    /// @param iso Distance of the surface. Default 0.
+    /// @param block_shift Blocks are `2^block_shift` cells along each axis. Default 3.
+    /// @return Shared pointer to the SurfaceMesh.
+    /// @throws InvalidMapKey If a channel with that name does not exist.
+    /// @throws BadVoxelGridDownCast If the channel is not a `TSDF` or a `BinaryTSDF`.
+    static std::shared_ptr<SurfaceMesh> create(const std::shared_ptr<Reconstruction>& reconstruction,
+                                               const std::string& channel, const float& iso = 0,
+                                               const size_t& block_shift = SurfaceMesh::default_block_shift)
+    {
+        return std::shared_ptr<SurfaceMesh>(new SurfaceMesh(reconstruction, channel, iso, block_shift));
+    }
+
+
+    /// @brief Marks the blocks holding the voxels traced by the Reconstruction's most recent update
+    ///        as stale. This must be called after each update for `update` to see its changes.
+    /// @note  The Reconstruction must not be updated while this is called.
+    void markUpdated()
+    {
+        if (this->blocks.empty())
+        {
+            return;
+        }
+        const std::shared_ptr<const Bitset> updated = this->reconstruction->getUpdatedData();
+        updated->forEachSetInDirtyBlocks([this](const size_t& i)
+        {
+            this->markVoxel(this->properties->vectorToIndex(i));
+        });
+    }
+
+
+    /// @brief Marks every block as stale, such as after a Reconstruction is loaded or its window
+    ///        moves.
+    void markAll()
+    {
+        for (size_t b = 0; b < this->blocks.size(); ++b)
+        {
+            this->stale.set(b);
+        }
+    }
+
+
+    /// @brief Meshes each stale block again.
+    /// @return Number of blocks which were meshed.
+    /// @note  The Reconstruction must not be updated while this is called.
+    size_t update()
+    {
+        this->stale_list.clear();
+        for (size_t b = 0; b < this->blocks.size(); ++b)
+        {
+            if (this->stale.test(b))
+            {
+                this->stale_list.push_back(b);
+            }
+        }
+        utilities::parallelReduce<size_t>(this->stale_list.size(), this->reconstruction->getNumThreads(),
+                                          SurfaceMesh::min_blocks_per_thread,
+            [this](const size_t& first, const size_t& last)
+            {
+                for (size_t k = first; k < last; ++k)
+                {
+                    const size_t b = this->stale_list[k];
+                    this->blocks[b] = this->extractBlock(b);
+                }
+                return last - first;
+            });
+        for (const auto& b : this->stale_list)
+        {
+            this->stale.reset(b);
+        }
+        return this->stale_list.size();
+    }
+
+
+    /// @brief Gets the mesh of each block, as of the last `update`.
+    const BlockList& getBlocks() const
+    {
+        return this->blocks;
+    }
+
+
+    /// @brief Gets the mesh as of the last `update`, with the vertices the blocks share merged.
+    Mesh getMesh() const
+    {
+        return SurfaceMesh::merge(this->blocks);
+    }
+
+
+    /// @brief Gets the name of the channel which is meshed.
+    const std::string& getChannelName() const
+    {
+        return this->channel_name;
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                               PUBLIC STATIC METHODS                                   * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Makes one mesh from the blocks, merging the vertices they share.
+    /// @param blocks Mesh of each block. See `getBlocks`.
+    /// @return The merged mesh.
+    static Mesh merge(const BlockList& blocks)
+    {
+        size_t n_vertices = 0, n_triangles = 0;
+        for (const auto& block : blocks)
+        {
+            if (block)
+            {
+                n_vertices  += block->vertices.size();
+                n_triangles += block->triangles.size() / 3;
+            }
+        }
+
+        Mesh mesh;
+        mesh.vertices.resize(3, n_vertices);
+        mesh.triangles.resize(3, n_triangles);
+        std::unordered_map<uint64_t, uint32_t> edge_vertex;
+        edge_vertex.reserve(n_vertices);
+        std::vector<uint32_t> merged;
+
+        size_t n_merged = 0, t = 0;
+        for (const auto& block : blocks)
+        {
+            if (!block)
+            {
+                continue;
+            }
+            merged.resize(block->vertices.size());
+            for (size_t v = 0; v < block->vertices.size(); ++v)
+            {
+                const auto vertex = edge_vertex.try_emplace(block->edges[v], static_cast<uint32_t>(n_merged));
+                if (vertex.second)
+                {
+                    mesh.vertices.col(n_merged++) = block->vertices[v];
+                }
+                merged[v] = vertex.first->second;
+            }
+            for (size_t k = 0; k < block->triangles.size(); k += 3, ++t)
+            {
+                mesh.triangles.col(t) << merged[block->triangles[k]], merged[block->triangles[k + 1]],
+                                         merged[block->triangles[k + 2]];
+            }
+        }
+        mesh.vertices.conservativeResize(3, n_merged);
+        return mesh;
+    }
+
+
+    /// @brief Writes the blocks to a binary PLY file, one block at a time.
+    /// @param fpath File path, with file name, to write to. The `.ply` extension is added if needed,
+    ///              and a default, time stamped, file name if none is given.
+    /// @param blocks Mesh of each block. See `getBlocks`.
+    /// @return Full path to the file written.
+    /// @note  The blocks are not merged, so vertices where blocks meet are written once for each.
+    ///        This writes the file without copying the blocks into one mesh.
+    /// @throws std::runtime_error If the file could not be opened.
+    static std::filesystem::path savePLY(std::filesystem::path fpath, const BlockList& blocks)
+    {
+        utilities::validateAndCreateFilepath(fpath, FS_PLY_FILE_EXTENSION, "Surface", true);
+        std::ofstream file(fpath, std::ios::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Could not open \"" + fpath.string() + "\" to write the surface.");
+        }
+
+        size_t n_vertices = 0, n_triangles = 0;
+        for (const auto& block : blocks)
+        {
+            if (block)
+            {
+                n_vertices  += block->vertices.size();
+                n_triangles += block->triangles.size() / 3;
+            }
+        }
+        const uint16_t endian_test = 1;
+        const bool little_endian = *reinterpret_cast<const uint8_t*>(&endian_test) == 1;
+        file << "ply\n"
+             << "format " << (little_endian ? "binary_little_endian" : "binary_big_endian") << " 1.0\n"
+             << "element vertex " << n_vertices << "\n"
+             << "property float x\nproperty float y\nproperty float z\n"
+             << "element face " << n_triangles << "\n"
+             << "property list uchar uint vertex_indices\n"
+             << "end_header\n";
+
+        for (const auto& block : blocks)
+        {
+            if (block)
+            {
+                for (const auto& vertex : block->vertices)
+                {
+                    file.write(reinterpret_cast<const char*>(vertex.data()), 3 * sizeof(float));
+                }
+            }
+        }
+        uint32_t offset = 0;
+        for (const auto& block : blocks)
+        {
+            if (!block)
+            {
+                continue;
+            }
+            for (size_t k = 0; k < block->triangles.size(); k += 3)
+            {
+                const uint8_t  n = 3;
+                const uint32_t face[3] = {offset + block->triangles[k], offset + block->triangles[k + 1],
+                                          offset + block->triangles[k + 2]};
+                file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+                file.write(reinterpret_cast<const char*>(face), sizeof(face));
+            }
+            offset += static_cast<uint32_t>(block->vertices.size());
+        }
+        return fpath;
+    }
+
+
+    /// @brief Default number of cells along each axis of a block, as a power of two.
+    static constexpr size_t default_block_shift = 3;
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Private constructor to enforce shared pointer usage. See `create`.
+    SurfaceMesh(const std::shared_ptr<Reconstruction>& reconstruction, const std::string& channel,
+                const float& iso, const size_t& block_shift)
+        : reconstruction(reconstruction),
+          properties(reconstruction->grid_properties),
+          channel_name(channel),
+          channel(SurfaceMesh::castChannel(reconstruction->getChannelView(channel))),
+          iso(iso),
+          block_shift(block_shift)
+    {
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            const size_t n_cells = std::max(this->properties->size[axis], static_cast<size_t>(1)) - 1;
+            this->n_blocks[axis] = (n_cells + (size_t(1) << this->block_shift) - 1) >> this->block_shift;
+        }
+        this->blocks.resize(this->n_blocks.prod());
+        this->stale = Bitset(this->blocks.size());
+        this->markAll();
+        this->reconstruction->enableUpdateTracking();
+    }
+
+
+    /// @brief Casts a channel to one of the types which may be meshed.
+    /// @param channel Channel to cast.
+    /// @return The channel.
+    /// @throws BadVoxelGridDownCast If the channel is not a `TSDF` or a `BinaryTSDF`.
+    static std::variant<std::shared_ptr<const TSDF>, std::shared_ptr<const BinaryTSDF>>
+    castChannel(const std::shared_ptr<const VoxelGrid>& channel)
+    {
+        if (auto tsdf = std::dynamic_pointer_cast<const TSDF>(channel))
+        {
+            return tsdf;
+        }
+        if (auto binary_tsdf = std::dynamic_pointer_cast<const BinaryTSDF>(channel))
+        {
+            return binary_tsdf;
+        }
+        throw BadVoxelGridDownCast("TSDF or BinaryTSDF");
+    }
+
+
+    /// @brief Marks the blocks holding each cell which has a voxel as one of its corners as stale.
+    /// @param voxel Index of the voxel.
+    void markVoxel(const Index& voxel)
+    {
+        Index lower, upper;
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            const size_t last_cell = this->properties->size[axis] - 2;
+            lower[axis] = std::min(std::max(voxel[axis], static_cast<size_t>(1)) - 1, last_cell) >> this->block_shift;
+            upper[axis] = std::min(voxel[axis], last_cell) >> this->block_shift;
+        }
+        for (size_t z = lower.z(); z <= upper.z(); ++z)
+        {
+            for (size_t y = lower.y(); y <= upper.y(); ++y)
+            {
+                for (size_t x = lower.x(); x <= upper.x(); ++x)
+                {
+                    this->stale.set(x + this->n_blocks.x() * (y + this->n_blocks.y() * z));
+                }
+            }
+        }
+    }
+
+
+    /// @brief Meshes the cells of one block.
+    /// @param b Position of the block in `blocks`.
+    /// @return The block's mesh, or nullptr if it has no triangles.
+    /// @note  This is called from several threads at once, for different blocks.
+    std::shared_ptr<const Block> extractBlock(const size_t& b) const
+    {
+        std::shared_ptr<const Block> block;
+        auto extract_channel = [&](const auto& channel)
+        {
+            std::visit([&](const auto& vector)
+            {
+                using T = typename std::decay_t<decltype(vector)>::value_type;
+                block = this->extractBlock(b, vector, channel->getQuantizer(), std::get<T>(channel->default_value));
+            }, channel->getData());
+        };
+        std::visit(extract_channel, this->channel);
+        return block;
+    }
+
+
+    /// @brief Meshes the cells of one block.
+    /// @param b Position of the block in `blocks`.
+    /// @param vector Data vector of the channel.
+    /// @param quantizer Encoding of the data vector's distances.
+    /// @param unset Stored value of voxels which have not been measured.
+    /// @return The block's mesh, or nullptr if it has no triangles.
+    template <typename Vector, typename T>
+    std::shared_ptr<const Block> extractBlock(const size_t& b, const Vector& vector, const Quantizer& quantizer,
+                                              const T& unset) const
+    {
+        using namespace marching_cubes;
+
+        const Grid::Properties& properties = *this->properties;
+        const Bitset& seen = *this->reconstruction->getSeenData();
+        const size_t n_cells = size_t(1) << this->block_shift;
+
+        Index lower(b % this->n_blocks.x(), (b / this->n_blocks.x()) % this->n_blocks.y(),
+                    b / (this->n_blocks.x() * this->n_blocks.y()));
+        lower *= n_cells;
+        Index upper;
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            upper[axis] = std::min(lower[axis] + n_cells, properties.size[axis] - 1);
+        }
+
+        auto block = std::make_shared<Block>();
+        std::unordered_map<uint64_t, uint32_t> edge_vertex;
+        float  values[8];
+        Index  corners[8];
+        for (size_t z = lower.z(); z < upper.z(); ++z)
+        {
+            for (size_t y = lower.y(); y < upper.y(); ++y)
+            {
+                for (size_t x = lower.x(); x < upper.x(); ++x)
+                {
+                    bool measured = true;
+                    for (size_t c = 0; c < 8 && measured; ++c)
+                    {
+                        corners[c] = Index(x + corner_offsets[c][0], y + corner_offsets[c][1], z + corner_offsets[c][2]);
+                        const size_t i  = properties[corners[c]];
+                        const T stored  = vector[i];
+                        values[c] = static_cast<float>(quantizer.decode(stored));
+                        measured  = std::isfinite(values[c]) && (!(stored == unset) || seen.test(i));
+                    }
+                    if (!measured)
+                    {
+                        continue;
+                    }
+                    const uint8_t cell_case = get_case(values, this->iso);
+                    for (const int8_t* e = triangle_table[cell_case]; *e >= 0; ++e)
+                    {
+                        const uint8_t c0 = edge_corners[*e][0], c1 = edge_corners[*e][1], axis = edge_axis[*e];
+                        const Index& voxel = corners[c0];
+                        const uint64_t edge = 3 * (voxel.x() + properties.size.x() *
+                                                   (voxel.y() + properties.size.y() * voxel.z())) + axis;
+                        const auto vertex = edge_vertex.try_emplace(edge, static_cast<uint32_t>(block->vertices.size()));
+                        if (vertex.second)
+                        {
+                            Point position = voxel.cast<float>();
+                            position[axis] += get_crossing(values[c0], values[c1], this->iso);
+                            block->vertices.push_back(position * properties.resolution);
+                            block->edges.push_back(edge);
+                        }
+                        block->triangles.push_back(vertex.first->second);
+                    }
+                }
+            }
+        }
+        return block->triangles.empty() ? nullptr : block;
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Reconstruction which is meshed.
+    const std::shared_ptr<Reconstruction> reconstruction;
+
+    /// @brief Grid Properties of the Reconstruction.
+    const std::shared_ptr<const Grid::Properties> properties;
+
+    /// @brief Name of the channel which is meshed.
+    const std::string channel_name;
+
+    /// @brief Channel which is meshed.
+    const std::variant<std::shared_ptr<const TSDF>, std::shared_ptr<const BinaryTSDF>> channel;
+
+    /// @brief Distance of the surface.
+    const float iso;
+
+    /// @brief Blocks are `2^block_shift` cells along each axis.
+    const size_t block_shift;
+
+    /// @brief Number of blocks along each axis.
+    GridSize n_blocks;
+
+    /// @brief Mesh of each block, in the X-major order.
+    BlockList blocks;
+
+    /// @brief Flag for each block which must be meshed again.
+    Bitset stale;
+
+    /// @brief Stale blocks found by `update`. Reused between calls.
+    std::vector<size_t> stale_list;
+
+    /// @brief Fewest stale blocks worth starting a thread for.
+    static constexpr size_t min_blocks_per_thread = 4;
+};
+
+
+} // namespace data
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_DATA_SURFACE_MESH_HPP
@@ -1,8 +1,11 @@
 #ifndef FORGE_SCAN_RECONSTRUCTIONS_GRID_BINARY_HPP
 #define FORGE_SCAN_RECONSTRUCTIONS_GRID_BINARY_HPP
 
-#include <functional>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
 
+#include "ForgeScan/Common/OccupancyPyramid.hpp"
 #include "ForgeScan/Data/VoxelGrids/VoxelGrid.hpp"
 
 
@@ -43,6 +46,19 @@ public:
     }
 
 
+    /// @brief Estimates the memory a Binary VoxelGrid allocates when it is created.
+    /// @param properties Shared, constant pointer to the `Grid::Properties` to use.
+    /// @param parser ArgParser with arguments to construct a Binary Grid from.
+    /// @return Number of bytes allocated by the data vector and the record of changed voxels. The
+    ///         occplanes and pyramid are allocated later, when first used.
+    static size_t estimateMemoryUsage(const std::shared_ptr<const Grid::Properties>& properties,
+                                      [[maybe_unused]] const utilities::ArgParser& parser)
+    {
+        return VoxelGrid::estimateVectorMemory(*properties, sizeof(uint8_t)) +
+               sizeof(uint64_t) * ((properties->getNumVoxels() + 63) / 64);
+    }
+
+
     /// @return Help message for constructing a Binary VoxelGrid with ArgParser.
     static std::string helpMessage()
     {
@@ -59,14 +75,50 @@ public:
 
     /// @brief Accessor for `metrics::ground_truth::ExperimentOccupancy` in
     ///       `metrics::OccupancyConfusion`
-    /// @return Read-only reference to the Occupancy data vector.
-    const std::vector<uint8_t>& getOccupancyData() const
+    /// @return Occupancy data vector.
+    std::vector<uint8_t> getOccupancyData() const
     {
+        if (this->properties->sparse)
+        {
+            return std::get<SparseVector<uint8_t>>(this->data).toDense();
+        }
+        if (this->properties->isMapped())
+        {
+            return std::get<MappedVector<uint8_t>>(this->data).toDense();
+        }
         return std::get<std::vector<uint8_t>>(this->data);
     }
 
 
+    /// @brief Writes the occupancy of every voxel into an existing vector.
+    /// @param [out] occupancy_data Occupancy data vector. Resized to one element for each voxel,
+    ///                             which only allocates if it is too small.
+    void getOccupancyData(std::vector<uint8_t>& occupancy_data) const
+    {
+        occupancy_data.resize(this->properties->getNumVoxels());
+        this->getOccupancyData(occupancy_data, 0, occupancy_data.size());
+    }
+
+
+    /// @brief Writes the occupancy of the voxels `[first, last)` into an existing vector.
+    /// @param [out] occupancy_data Occupancy data vector with one element for each voxel.
+    /// @param first Vector index of the first voxel to write.
+    /// @param last  Vector index one past the last voxel to write.
+    void getOccupancyData(std::vector<uint8_t>& occupancy_data, const size_t& first, const size_t& last) const
+    {
+        auto get_occupancy_data = [&](auto&& data){
+            for (size_t i = first; i < last; ++i)
+            {
+                occupancy_data[i] = data[i];
+            }
+        };
+        std::visit(get_occupancy_data, this->data);
+    }
+
+
     /// @brief Updates the grid to mark specific voxels as Occplanes.
+    /// @note  Only the voxels whose labels changed since the last call, and their neighbors, are
+    ///        re-evaluated. See `recomputeOccplanes` to evaluate every voxel.
     void updateOccplanes()
     {
         std::visit(this->update_callable_occplane, this->data);
@@ -76,12 +128,160 @@ public:
     /// @brief Updates the grid to mark specific voxels as Occplanes.
     /// @param occplane_centers Storage location for the occplane centers. Any existing data is cleared.
     /// @param occplane_normals Storage location for the occplane normals. Any existing data is cleared.
+    /// @note  The first call starts maintaining the set of occplanes, see `getOccplanes`, which
+    ///        takes a full sweep. Later calls, and `updateOccplanes`, keep it current incrementally.
     void updateOccplanes(std::vector<Eigen::Vector3d>& occplane_centers,
                          std::vector<Eigen::Vector3d>& occplane_normals)
     {
-        this->update_callable_occplane.acquireTracking(occplane_centers, occplane_normals);
-        std::visit(this->update_callable_occplane, this->data);
-        this->update_callable_occplane.releaseTracking();
+        if (!this->occplanes)
+        {
+            this->occplanes = std::make_shared<Bitset>(this->properties->getNumVoxels());
+            this->update_callable_occplane.full = true;
+        }
+        this->updateOccplanes();
+
+        if (this->properties->sparse)
+        {
+            this->getOccplanes(std::get<SparseVector<uint8_t>>(this->data), occplane_centers, occplane_normals);
+        }
+        else if (this->properties->isMapped())
+        {
+            this->getOccplanes(std::get<MappedVector<uint8_t>>(this->data), occplane_centers, occplane_normals);
+        }
+        else
+        {
+            this->getOccplanes(std::get<std::vector<uint8_t>>(this->data), occplane_centers, occplane_normals);
+        }
+    }
+
+
+    /// @brief Evaluates every voxel to mark the Occplanes, rather than just those near changes.
+    void recomputeOccplanes()
+    {
+        this->update_callable_occplane.full = true;
+        this->updateOccplanes();
+    }
+
+
+    /// @brief Gets the set of voxels which are occplanes, by vector index.
+    /// @return Read-only reference to the set, as of the last call to `updateOccplanes`. Nullptr
+    ///         until `updateOccplanes` has been called with storage for the centers and normals.
+    std::shared_ptr<const Bitset> getOccplanes() const
+    {
+        return this->occplanes;
+    }
+
+
+    /// @brief Returns zero. Past the sensed point voxels are only ever labeled free.
+    float getSkipDistance() const override final
+    {
+        return 0;
+    }
+
+
+    /// @brief Returns one, as `updateOccplanes` labels the neighbors of the voxels an update changed.
+    size_t getChangeRadius() const override final
+    {
+        return 1;
+    }
+
+
+    /// @brief Returns true if the voxel is labeled free, so a free-space update leaves it unchanged.
+    /// @param i Vector index of the voxel.
+    bool isSaturated(const size_t& i) const override final
+    {
+        if (this->properties->sparse)
+        {
+            return std::get<SparseVector<uint8_t>>(this->data)[i] == VoxelOccupancy::FREE;
+        }
+        else if (this->properties->isMapped())
+        {
+            return std::get<MappedVector<uint8_t>>(this->data)[i] == VoxelOccupancy::FREE;
+        }
+        return std::get<std::vector<uint8_t>>(this->data)[i] == VoxelOccupancy::FREE;
+    }
+
+
+    /// @brief Calculates how much space the VoxelGrid is using, including its record of changed
+    ///        voxels, occplanes and pyramid.
+    utilities::memory_use::Usage getMemoryUsage() const override final
+    {
+        utilities::memory_use::Usage usage = VoxelGrid::getMemoryUsage();
+        usage.size_bytes     += this->changed.sizeBytes();
+        usage.capacity_bytes += this->changed.sizeBytes();
+        if (this->occplanes)
+        {
+            usage.size_bytes     += this->occplanes->sizeBytes();
+            usage.capacity_bytes += this->occplanes->sizeBytes();
+        }
+        if (this->pyramid)
+        {
+            usage.size_bytes     += this->pyramid->sizeBytes();
+            usage.capacity_bytes += this->pyramid->sizeBytes();
+        }
+        return usage;
+    }
+
+
+    /// @brief Gets the pyramid of coarse occupancy summaries, brought up to date with the last update.
+    /// @return Read-only reference to the pyramid. It is valid until the next update.
+    /// @note  The first call starts maintaining the pyramid, which takes a pass over every voxel.
+    ///        Later calls only recalculate the cells holding voxels whose label changed since.
+    std::shared_ptr<const OccupancyPyramid> getPyramid()
+    {
+        if (!this->pyramid)
+        {
+            this->pyramid = std::make_shared<OccupancyPyramid>(this->properties);
+        }
+        if (this->pyramid->isStale())
+        {
+            if (this->properties->sparse)
+            {
+                this->refreshPyramid(std::get<SparseVector<uint8_t>>(this->data));
+            }
+            else if (this->properties->isMapped())
+            {
+                this->refreshPyramid(std::get<MappedVector<uint8_t>>(this->data));
+            }
+            else
+            {
+                this->refreshPyramid(std::get<std::vector<uint8_t>>(this->data));
+            }
+        }
+        return this->pyramid;
+    }
+
+
+    /// @brief Reads the VoxelGrid's data vector from the provided HDF5 group.
+    /// @param g_channel Group in the opened HDF5 file.
+    /// @param grid_type Name of the derived class.
+    /// @note  The next update of the occplanes is a full sweep, and the pyramid is rebuilt.
+    void load(const HighFive::Group& g_channel, const std::string& grid_type) override final
+    {
+        VoxelGrid::load(g_channel, grid_type);
+        this->changed.reset();
+        this->update_callable_occplane.full = true;
+        if (this->pyramid)
+        {
+            this->pyramid->markAll();
+        }
+    }
+
+
+    /// @brief Moves the VoxelGrid's data along an axis. See `VoxelGrid::shift`.
+    /// @param axis  Axis to move along.
+    /// @param steps Number of voxels to move by.
+    /// @note  As after `load`, the next update of the occplanes is a full sweep, and the pyramid
+    ///        is rebuilt.
+    void shift(const size_t& axis, const int& steps) override final
+    {
+        VoxelGrid::shift(axis, steps);
+        this->changed.reset();
+        this->update_callable_occplane.full = true;
+        if (this->pyramid)
+        {
+            this->pyramid->markAll();
+        }
     }
 
 
@@ -89,14 +289,31 @@ public:
     /// @param ray_trace Trace with update voxel location and distances.
     void update(const std::shared_ptr<const Trace>& ray_trace) override final
     {
-        this->update_callable.acquireRayTrace(ray_trace);
-        std::visit(this->update_callable, this->data);
-        this->update_callable.releaseRayTrace();
+        this->visitUpdate(this->update_callable, ray_trace);
+    }
+
+
+    /// @brief Updates the Grid with new information along each ray in a batch.
+    /// @param trace_batch Batch of traces with update voxel locations and distances.
+    void update(const std::shared_ptr<const TraceBatch>& trace_batch) override final
+    {
+        this->visitUpdate(this->update_callable, trace_batch);
+    }
+
+
+    std::shared_ptr<VoxelGrid> clone() const override final
+    {
+        return std::shared_ptr<Binary>(new Binary(*this));
     }
 
 
     void postUpdate() override final
     {
+        // The changes are recorded before the occplane update clears them.
+        if (this->pyramid)
+        {
+            this->changed.forEachSetInDirtyBlocks([this](const size_t& i) { this->pyramid->markVoxel(i); });
+        }
         if (this->no_occplane == false)
         {
             this->updateOccplanes();
@@ -126,6 +343,21 @@ private:
                     DataType::UINT8_T,
                     DataType::UINT8_T),
           no_occplane(no_occplane),
+          changed(properties->getNumVoxels()),
+          update_callable_occplane(*this),
+          update_callable(*this)
+    {
+
+    }
+
+
+    /// @brief Copy constructor for `clone`. The occplanes and pyramid are copied if they are maintained.
+    Binary(const Binary& other)
+        : VoxelGrid(other),
+          no_occplane(other.no_occplane),
+          changed(other.changed),
+          occplanes(other.occplanes ? std::make_shared<Bitset>(*other.occplanes) : nullptr),
+          pyramid(other.pyramid ? std::make_shared<OccupancyPyramid>(*other.pyramid) : nullptr),
           update_callable_occplane(*this),
           update_callable(*this)
     {
@@ -133,6 +365,46 @@ private:
     }
 
 
+    /// @brief Lists the center and normal of each voxel in the set of occplanes.
+    /// @param read Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+    /// @param [out] occplane_centers Storage location for the occplane centers. Any existing data is cleared.
+    /// @param [out] occplane_normals Storage location for the occplane normals. Any existing data is cleared.
+    /// @note  The normal points from the voxel towards its free neighbors.
+    template <typename Vector>
+    void getOccplanes(const Vector& read, std::vector<Eigen::Vector3d>& occplane_centers,
+                      std::vector<Eigen::Vector3d>& occplane_normals) const
+    {
+        const Grid::Properties& properties = *this->properties;
+        const float& res = properties.resolution;
+        auto is_free = [&](const size_t& x, const size_t& y, const size_t& z)
+        {
+            return (read[properties[Index(x, y, z)]] & VoxelOccupancy::TYPE_FREE) == VoxelOccupancy::TYPE_FREE ? 1.0 : 0.0;
+        };
+
+        occplane_centers.clear();
+        occplane_normals.clear();
+        this->occplanes->forEachSet([&](const size_t& i)
+        {
+            const Index v = properties.vectorToIndex(i);
+            const size_t &x = v[0], &y = v[1], &z = v[2];
+            const Eigen::Vector3d normal(is_free(x + 1, y, z) - is_free(x - 1, y, z),
+                                         is_free(x, y + 1, z) - is_free(x, y - 1, z),
+                                         is_free(x, y, z + 1) - is_free(x, y, z - 1));
+            occplane_centers.emplace_back(x * res, y * res, z * res);
+            occplane_normals.emplace_back(normal.normalized());
+        });
+    }
+
+
+    /// @brief Recalculates the stale cells of the pyramid.
+    /// @param read Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+    template <typename Vector>
+    void refreshPyramid(const Vector& read)
+    {
+        this->pyramid->refresh([&read](const size_t& i) { return read[i]; });
+    }
+
+
     /// @brief Subclass provides update functions for each supported DataType/VectorVariant of
     ///        the data vector.
     struct UpdateCallable : public VoxelGrid::UpdateCallable
@@ -144,31 +416,56 @@ private:
         // ************************************************************************************* //
 
 
-        void operator()(std::vector<uint8_t>& vector)
-        {
-            Trace::const_iterator iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last_occ  = this->ray_trace->first_above(0, iter);
-            const Trace::const_iterator last_free = this->ray_trace->first_above(this->caller.dist_max, last_occ);
+        void operator()(std::vector<uint8_t>&  vector) { this->updateVector(vector); }
+        void operator()(SparseVector<uint8_t>& vector) { this->updateVector(vector); }
+        void operator()(MappedVector<uint8_t>& vector) { this->updateVector(vector); }
+
 
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last_occ; ++iter)
+        /// @brief Labels voxels on every ray as occluded, free or occupied.
+        /// @param vector Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+        /// @note  Changes are recorded with the non-atomic `Bitset::set`. This is safe in the parallel
+        ///        update for the same reason as the Reconstruction's seen data: each thread only
+        ///        holds voxels in its own shard.
+        template <typename Vector>
+        void updateVector(Vector& vector)
+        {
+            const Vector& read = vector;
+            Bitset& changed = this->caller.changed;
+            this->forEachRay([&](const auto& ray_trace)
             {
-                if (vector[iter->i] != VoxelOccupancy::OCCUPIED)
+                auto iter = ray_trace.first_above(this->caller.dist_min);
+                const auto last_occ  = ray_trace.first_above(0, iter);
+                const auto last_free = ray_trace.first_above(this->caller.dist_max, last_occ);
+
+                // ************************** APPLY VOXEL UPDATE HERE ************************** //
+                // Voxels are only written if their label changes, and each change is recorded so
+                // the occplanes may be updated around just those voxels.
+                for ( ; iter != last_occ; ++iter)
                 {
-                    vector[iter->i] = VoxelOccupancy::OCCLUDED;
+                    if (read[iter->i] != VoxelOccupancy::OCCUPIED && read[iter->i] != VoxelOccupancy::OCCLUDED)
+                    {
+                        vector[iter->i] = VoxelOccupancy::OCCLUDED;
+                        changed.set(iter->i);
+                    }
                 }
-            }
-            for ( ; iter != last_free; ++iter)
-            {
-                // if (vector[iter->i] != VoxelOccupancy::OCCUPIED)
+                for ( ; iter != last_free; ++iter)
                 {
-                    vector[iter->i] = VoxelOccupancy::FREE;
+                    if (read[iter->i] != VoxelOccupancy::FREE)
+                    {
+                        vector[iter->i] = VoxelOccupancy::FREE;
+                        changed.set(iter->i);
+                    }
                 }
-            }
-            if (this->ray_trace->hasSensed())
-            {
-                vector[caller.properties->at(this->ray_trace->sensedPoint())] = VoxelOccupancy::OCCUPIED;
-            }
+                if (ray_trace.hasSensed())
+                {
+                    const size_t i = caller.properties->at(ray_trace.sensedPoint());
+                    if (read[i] != VoxelOccupancy::OCCUPIED)
+                    {
+                        vector[i] = VoxelOccupancy::OCCUPIED;
+                        changed.set(i);
+                    }
+                }
+            });
         }
 
 
@@ -193,65 +490,57 @@ private:
 
     /// @brief Subclass provides occplane calculation functions for each supported DataType/VectorVariant of
     ///        the data vector.
+    /// @details An occplane is an unknown voxel, away from the Grid's faces, with at least one free
+    ///          neighbor. A voxel's state only depends on its own label and those of its 6 neighbors.
+    ///          So after an update only the voxels whose label changed, and their neighbors, are
+    ///          re-evaluated. A full sweep is used the first time and when most of the Grid changed.
+    /// @note  A voxel's occplane bit is only ever set here. It is cleared when an update relabels the
+    ///        voxel. The set of voxels in `Binary::occplanes` is exact: voxels which are no longer
+    ///        occplanes are removed from it.
     struct UpdateCallableOccplane : public VoxelGrid::UpdateCallable
     {
         using VoxelGrid::UpdateCallable::operator();
 
-        using implement_function = std::function<void(uint8_t&, const uint8_t&, const uint8_t&, const uint8_t&,
-                                                                const uint8_t&, const uint8_t&, const uint8_t&,
-                                                                const size_t&,  const size_t&,  const size_t&)>;
+        /// @brief If the blocks of the changed record which are dirty are more than one in this many,
+        ///        a full sweep is used instead.
+        static constexpr size_t full_sweep_ratio = 4;
 
         // ************************************************************************************* //
         // *                                SUPPORTED DATATYPES                                * //
         // ************************************************************************************* //
 
 
-        void operator()(std::vector<uint8_t>& vector)
+        void operator()(std::vector<uint8_t>&  vector) { this->updateVector(vector); }
+        void operator()(SparseVector<uint8_t>& vector) { this->updateVector(vector); }
+        void operator()(MappedVector<uint8_t>& vector) { this->updateVector(vector); }
+
+
+        /// @brief Labels unknown voxels which neighbor a free voxel as occplanes.
+        /// @param vector Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+        /// @note  Neighbors are only read through a const reference and a voxel is only written if
+        ///        its label changes. This keeps a `SparseVector` from allocating every block it reads.
+        template <typename Vector>
+        void updateVector(Vector& vector)
         {
             static const GridSize minGridSize = GridSize(3, 3, 3);
+            Bitset& changed = this->caller.changed;
             if ((this->caller.properties->size.array() < minGridSize.array()).any())
             {
+                changed.resetDirtyBlocks();
                 return;
             }
 
-            implement_function implement;
-            if (this->occplane_centers && this->occplane_normals)
+            const bool sweep = this->full || changed.numDirtyBlocks() * full_sweep_ratio > changed.numBlocks();
+            if (this->caller.occplanes)
             {
-                this->occplane_centers->clear();
-                this->occplane_normals->clear();
-                implement = this->implement_track;
+                sweep ? this->sweep<true>(vector) : this->incremental<true>(vector);
             }
             else
             {
-                implement = this->implement_no_track;
-            }
-
-            const size_t dx = 1;
-            const size_t dy = this->caller.properties->size.x();
-            const size_t dz = this->caller.properties->size.x() * this->caller.properties->size.y();
-
-            for (size_t z = 1; z < this->caller.properties->size.z() - 1; ++z)
-            {
-                for (size_t y = 1; y < this->caller.properties->size.y() - 1; ++y)
-                {
-                    for (size_t x = 1; x < this->caller.properties->size.x() - 1; ++x)
-                    {
-                        size_t c_idx = this->caller.properties->operator[](Index(x, y, z));
-                        uint8_t& c  = vector[c_idx];
-                        uint8_t& px = vector[c_idx + dx];
-                        uint8_t& nx = vector[c_idx - dx];
-                        uint8_t& py = vector[c_idx + dy];
-                        uint8_t& ny = vector[c_idx - dy];
-                        uint8_t& pz = vector[c_idx + dz];
-                        uint8_t& nz = vector[c_idx - dz];
-
-                        if (c & VoxelOccupancy::TYPE_UNKNOWN)
-                        {
-                            implement(c, px, nx, py, ny, pz, nz, x, y, z);
-                        }
-                    }
-                }
+                sweep ? this->sweep<false>(vector) : this->incremental<false>(vector);
             }
+            changed.resetDirtyBlocks();
+            this->full = false;
         }
 
 
@@ -265,93 +554,238 @@ private:
         UpdateCallableOccplane(Binary& caller)
             : caller(caller)
         {
-            using namespace std::placeholders;
-            this->implement_track    = std::bind(&UpdateCallableOccplane::implementTrack,   this, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10);
-            this->implement_no_track = std::bind(&UpdateCallableOccplane::implementNoTrack, this, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10);
+
         }
 
 
-        /// @brief Acquires the centers and normals vectors in this class' member variables.
-        /// @param occplane_centers Storage location for occplane centers.
-        /// @param occplane_normals Storage location for occplane normals.
-        void acquireTracking(std::vector<Eigen::Vector3d>& occplane_centers,
-                             std::vector<Eigen::Vector3d>& occplane_normals)
+        /// @brief Finds the occplane bit for a voxel.
+        /// @param c Label of the voxel.
+        /// @param neighbors Bitwise OR of the labels of its 6 neighbors.
+        /// @return The bit of `TYPE_OCCPLANE` which is not `TYPE_UNKNOWN` if the voxel is unknown and
+        ///         any neighbor is free. Zero otherwise.
+        static uint8_t occplaneBit(const uint8_t& c, const uint8_t& neighbors)
         {
-            this->occplane_centers = &occplane_centers;
-            this->occplane_normals = &occplane_normals;
+            static_assert(VoxelOccupancy::TYPE_UNKNOWN == 0b0010'0000 && VoxelOccupancy::TYPE_FREE == 0b0100'0000 &&
+                          VoxelOccupancy::TYPE_OCCPLANE == (VoxelOccupancy::TYPE_UNKNOWN | 0b0000'0100),
+                          "occplaneBit relies on the bit positions of the VoxelOccupancy types.");
+            return static_cast<uint8_t>(((c >> 5) & (neighbors >> 6) & 1) << 2);
         }
 
 
-        /// @brief Resets the class member variables pointing to the storage location of occplane centers
-        ///        and normals to nullptr, releasing temporary ownership.
-        void releaseTracking()
+        /// @brief Reference to the specific derived class calling this object.
+        Binary& caller;
+
+        /// @brief If true the next update uses a full sweep.
+        bool full = false;
+
+        /// @brief Occplane bits of one row of a full sweep. Reused between sweeps.
+        std::vector<uint8_t> row_bits;
+
+
+    private:
+        /// @brief Applies the occplane bit found for a voxel.
+        /// @param vector Data vector.
+        /// @param c_idx Vector index of the voxel.
+        /// @param c Current label of the voxel.
+        /// @param bit Result of `occplaneBit` for the voxel.
+        template <bool track, typename Vector>
+        void apply(Vector& vector, const size_t& c_idx, const uint8_t& c, const uint8_t& bit)
         {
-            this->occplane_centers = nullptr;
-            this->occplane_normals = nullptr;
+            if ((c | bit) != c)
+            {
+                vector[c_idx] = c | bit;
+            }
+            if constexpr (track)
+            {
+                bit ? this->caller.occplanes->set(c_idx) : this->caller.occplanes->reset(c_idx);
+            }
+        }
+
+
+        /// @brief Evaluates one voxel away from the Grid's faces.
+        /// @param vector Data vector.
+        /// @param voxel Index of the voxel.
+        template <bool track, typename Vector>
+        void evaluate(Vector& vector, const Index& voxel)
+        {
+            const Vector& read = vector;
+            const Grid::Properties& properties = *this->caller.properties;
+            const size_t c_idx = properties[voxel];
+            const uint8_t c    = read[c_idx];
+
+            const size_t &x = voxel[0], &y = voxel[1], &z = voxel[2];
+            const uint8_t neighbors = read[properties[Index(x + 1, y, z)]] | read[properties[Index(x - 1, y, z)]] |
+                                      read[properties[Index(x, y + 1, z)]] | read[properties[Index(x, y - 1, z)]] |
+                                      read[properties[Index(x, y, z + 1)]] | read[properties[Index(x, y, z - 1)]];
+            this->apply<track>(vector, c_idx, c, occplaneBit(c, neighbors));
         }
 
 
-        /// @brief Implementation that only sets the voxel label to an occplane type.
-        void implementNoTrack(uint8_t& c,
-                              const uint8_t& px, const uint8_t& nx,
-                              const uint8_t& py, const uint8_t& ny,
-                              const uint8_t& pz, const uint8_t& nz,
-                              const size_t&, const size_t&, const size_t&)
+        /// @brief Re-evaluates each voxel whose label changed, and its neighbors.
+        /// @param vector Data vector.
+        template <bool track, typename Vector>
+        void incremental(Vector& vector)
         {
-            if (px & VoxelOccupancy::TYPE_FREE || nx & VoxelOccupancy::TYPE_FREE ||
-                py & VoxelOccupancy::TYPE_FREE || ny & VoxelOccupancy::TYPE_FREE ||
-                pz & VoxelOccupancy::TYPE_FREE || nz & VoxelOccupancy::TYPE_FREE)
+            const Grid::Properties& properties = *this->caller.properties;
+            const GridSize& size = properties.size;
+            auto interior = [&size](const Index& voxel)
             {
-                c |= VoxelOccupancy::TYPE_OCCPLANE;
-            }
+                return (voxel.array() > 0).all() && (voxel.array() + 1 < size.array()).all();
+            };
+
+            this->caller.changed.forEachSetInDirtyBlocks([&](const size_t& i)
+            {
+                const Index voxel = properties.vectorToIndex(i);
+                if (interior(voxel))
+                {
+                    this->evaluate<track>(vector, voxel);
+                }
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    Index step = voxel;
+                    ++step[axis];
+                    if (interior(step))
+                    {
+                        this->evaluate<track>(vector, step);
+                    }
+                    step[axis] -= 2;
+                    if (voxel[axis] > 0 && interior(step))
+                    {
+                        this->evaluate<track>(vector, step);
+                    }
+                }
+            });
         }
 
 
-        /// @brief That sets the voxel label to an occplane type and records the location and
-        ///        normal for each occplane.
-        void implementTrack(uint8_t& c,
-                            const uint8_t& px, const uint8_t& nx,
-                            const uint8_t& py, const uint8_t& ny,
-                            const uint8_t& pz, const uint8_t& nz,
-                            const size_t& x, const size_t& y, const size_t& z)
+        /// @brief Evaluates every voxel away from the Grid's faces.
+        /// @param vector Data vector.
+        /// @details Voxels are visited brick by brick, in the order they are stored, so a bricked
+        ///          layout keeps the stencil's reads within a few bricks. The linear layout is one
+        ///          brick. Within a brick, rows whose neighbors are all at constant offsets are found
+        ///          with a branch-free kernel over the bytes which the compiler vectorizes, if the
+        ///          storage is contiguous. The other voxels use `evaluate`.
+        template <bool track, typename Vector>
+        void sweep(Vector& vector)
         {
-            if (c & VoxelOccupancy::TYPE_UNKNOWN)
+            if constexpr (track)
             {
-                Eigen::Vector3d normal = Eigen::Vector3d::Zero();
+                this->caller.occplanes->reset();
+            }
 
-                normal.x() += ((px & VoxelOccupancy::TYPE_FREE) == VoxelOccupancy::TYPE_FREE) * 1;
-                normal.x() -= ((nx & VoxelOccupancy::TYPE_FREE) == VoxelOccupancy::TYPE_FREE) * 1;
-                normal.y() += ((py & VoxelOccupancy::TYPE_FREE) == VoxelOccupancy::TYPE_FREE) * 1;
-                normal.y() -= ((ny & VoxelOccupancy::TYPE_FREE) == VoxelOccupancy::TYPE_FREE) * 1;
-                normal.z() += ((pz & VoxelOccupancy::TYPE_FREE) == VoxelOccupancy::TYPE_FREE) * 1;
-                normal.z() -= ((nz & VoxelOccupancy::TYPE_FREE) == VoxelOccupancy::TYPE_FREE) * 1;
+            const Vector& read = vector;
+            const Grid::Properties& properties = *this->caller.properties;
+            const GridSize& size = properties.size;
+            const size_t brick = properties.isLinear() ? size.maxCoeff() : properties.brick_size;
+            constexpr bool contiguous = !std::is_same<Vector, SparseVector<uint8_t>>::value;
 
-                if (normal.isZero(0.0f) == false)
-                {
-                    c |= VoxelOccupancy::TYPE_OCCPLANE;
+            this->row_bits.resize(std::min(brick, size.x()));
+
+            auto neighbor = [&properties](const size_t& position, const size_t& neighbor_position,
+                                          const size_t& in_brick, const Index& neighbor_voxel)
+            {
+                return properties.sameBrick(position, neighbor_position) ? in_brick : properties[neighbor_voxel];
+            };
 
-                    const float& res = this->caller.properties->resolution;
-                    this->occplane_centers->emplace_back(x * res, y * res, z * res);
-                    this->occplane_normals->emplace_back(normal.normalized());
+            for (size_t z0 = 0; z0 < size.z(); z0 += brick)
+            for (size_t y0 = 0; y0 < size.y(); y0 += brick)
+            for (size_t x0 = 0; x0 < size.x(); x0 += brick)
+            {
+                const size_t x_begin = std::max(x0, static_cast<size_t>(1)), x_end = std::min(x0 + brick, size.x() - 1);
+                const size_t y_begin = std::max(y0, static_cast<size_t>(1)), y_end = std::min(y0 + brick, size.y() - 1);
+                const size_t z_begin = std::max(z0, static_cast<size_t>(1)), z_end = std::min(z0 + brick, size.z() - 1);
+                if (x_begin >= x_end)
+                {
+                    continue;
                 }
-            }
-        }
 
+                // Voxels on the brick's X faces have neighbors in other bricks.
+                const size_t x_fast_begin = properties.isLinear() ? x_begin : std::max(x_begin, x0 + 1);
+                const size_t x_fast_end   = properties.isLinear() ? x_end   : std::min(x_end, x0 + brick - 1);
 
-        /// @brief Reference to the specific derived class calling this object.
-        Binary& caller;
+                for (size_t z = z_begin; z < z_end; ++z)
+                {
+                    for (size_t y = y_begin; y < y_end; ++y)
+                    {
+                        const GridSize stride = properties.getVectorStrides(Index(x_begin, y, z));
+                        const size_t   first  = properties[Index(x_begin, y, z)];
 
-        /// @brief Function pointers to the implementation callbacks for the two variations of the occplane update.
-        implement_function implement_track, implement_no_track;
+                        // Voxels with a neighbor across a brick's face find it from its Index.
+                        auto evaluate_at = [&](const size_t& x)
+                        {
+                            const size_t c_idx = first + (x - x_begin);
+                            const uint8_t c = read[c_idx];
+                            const uint8_t neighbors = read[neighbor(x, x + 1, c_idx + stride[0], Index(x + 1, y, z))] |
+                                                      read[neighbor(x, x - 1, c_idx - stride[0], Index(x - 1, y, z))] |
+                                                      read[neighbor(y, y + 1, c_idx + stride[1], Index(x, y + 1, z))] |
+                                                      read[neighbor(y, y - 1, c_idx - stride[1], Index(x, y - 1, z))] |
+                                                      read[neighbor(z, z + 1, c_idx + stride[2], Index(x, y, z + 1))] |
+                                                      read[neighbor(z, z - 1, c_idx - stride[2], Index(x, y, z - 1))];
+                            this->apply<track>(vector, c_idx, c, occplaneBit(c, neighbors));
+                        };
+
+                        const bool fast = contiguous && x_fast_begin < x_fast_end &&
+                                          properties.sameBrick(y, y + 1) && properties.sameBrick(y, y - 1) &&
+                                          properties.sameBrick(z, z + 1) && properties.sameBrick(z, z - 1);
+                        if (!fast)
+                        {
+                            for (size_t x = x_begin; x < x_end; ++x)
+                            {
+                                evaluate_at(x);
+                            }
+                            continue;
+                        }
+
+                        for (size_t x = x_begin; x < x_fast_begin; ++x)
+                        {
+                            evaluate_at(x);
+                        }
 
-        /// @brief Locations for the `implementTrack` method to store occplane centers and normals in.
-        std::vector<Eigen::Vector3d> *occplane_centers = nullptr, *occplane_normals = nullptr;
+                        const size_t fast_first = first + (x_fast_begin - x_begin);
+                        const size_t n = x_fast_end - x_fast_begin;
+                        if constexpr (contiguous)
+                        {
+                            const uint8_t* c = read.data() + fast_first;
+                            const std::ptrdiff_t sy = stride[1], sz = stride[2];
+                            uint8_t* bits = this->row_bits.data();
+                            for (std::ptrdiff_t k = 0; k < static_cast<std::ptrdiff_t>(n); ++k)
+                            {
+                                bits[k] = occplaneBit(c[k], c[k + 1]  | c[k - 1]  | c[k + sy] |
+                                                            c[k - sy] | c[k + sz] | c[k - sz]);
+                            }
+                        }
+                        for (size_t k = 0; k < n; ++k)
+                        {
+                            const uint8_t& bit = this->row_bits[k];
+                            if (bit)
+                            {
+                                this->apply<track>(vector, fast_first + k, read[fast_first + k], bit);
+                            }
+                        }
+
+                        for (size_t x = x_fast_end; x < x_end; ++x)
+                        {
+                            evaluate_at(x);
+                        }
+                    }
+                }
+            }
+        }
     };
 
 
     /// @brief If true will skip calculating the occplanes after each update.
     bool no_occplane;
 
+    /// @brief Voxels whose label was changed by an update since the occplanes were last updated.
+    Bitset changed;
+
+    /// @brief Voxels which are occplanes, by vector index. Only maintained once requested.
+    std::shared_ptr<Bitset> occplanes{nullptr};
+
+    /// @brief Coarse summaries of the labels. Only maintained once requested.
+    std::shared_ptr<OccupancyPyramid> pyramid{nullptr};
+
     /// @brief Subclass callable that std::visit uses to perform occplane calculation with typed information.
     UpdateCallableOccplane update_callable_occplane;
 
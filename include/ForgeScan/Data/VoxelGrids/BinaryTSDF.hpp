@@ -1,6 +1,7 @@
 #ifndef FORGE_SCAN_RECONSTRUCTIONS_GRID_BINARY_TSDF_HPP
 #define FORGE_SCAN_RECONSTRUCTIONS_GRID_BINARY_TSDF_HPP
 
+#include "ForgeScan/Common/Quantizer.hpp"
 #include "ForgeScan/Data/VoxelGrids/VoxelGrid.hpp"
 #include "ForgeScan/Utilities/Math.hpp"
 
@@ -45,6 +46,20 @@ public:
     }
 
 
+    /// @brief Estimates the memory a Binary TSDF VoxelGrid allocates when it is created.
+    /// @param properties Shared, constant pointer to the `Grid::Properties` to use.
+    /// @param parser ArgParser with arguments to construct a Binary TSDF Grid from.
+    /// @return Number of bytes allocated by the data vector and the occupancy vector. The occupancy
+    ///         vector is dense even for sparse Grid Properties.
+    static size_t estimateMemoryUsage(const std::shared_ptr<const Grid::Properties>& properties,
+                                      const utilities::ArgParser& parser)
+    {
+        const DataType type_id = stringToDataType(parser.get(VoxelGrid::parse_dtype), DataType::FLOAT);
+        return VoxelGrid::estimateVectorMemory(*properties, getDataTypeSize(type_id)) +
+               properties->getNumVoxels() * sizeof(uint8_t);
+    }
+
+
     /// @return Help message for constructing a Binary TSDF VoxelGrid with ArgParser.
     static std::string helpMessage()
     {
@@ -60,6 +75,50 @@ public:
     }
 
 
+    /// @brief Accessor for `metrics::ground_truth::ExperimentTSDF` in `metrics::TSDFError`.
+    /// @return Encoding of the stored distances. The distances are always floating point, so this
+    ///         stores them unchanged.
+    const Quantizer& getQuantizer() const
+    {
+        static const Quantizer quantizer;
+        return quantizer;
+    }
+
+
+    /// @brief Calculates how much space the VoxelGrid is using, including its occupancy vector.
+    utilities::memory_use::Usage getMemoryUsage() const override final
+    {
+        utilities::memory_use::Usage usage = VoxelGrid::getMemoryUsage();
+        VoxelGrid::addMemoryUsage(this->data_occupancy, usage);
+        return usage;
+    }
+
+
+    /// @brief Moves the distances and the occupancy along an axis. See `VoxelGrid::shift`.
+    /// @param axis  Axis to move along.
+    /// @param steps Number of voxels to move by.
+    void shift(const size_t& axis, const int& steps) override final
+    {
+        VoxelGrid::shift(axis, steps);
+        VoxelGrid::shiftVector(this->data_occupancy, *this->properties, axis, steps,
+                               static_cast<uint8_t>(VoxelOccupancy::UNSEEN));
+    }
+
+
+    /// @brief Copies the changed distances and occupancy in a box from another BinaryTSDF. See
+    ///        `VoxelGrid::copyBox`.
+    /// @param source BinaryTSDF to copy from.
+    /// @param lower Lowest voxel of the box.
+    /// @param upper One past the highest voxel of the box, along each axis.
+    /// @return True if any voxel differed.
+    bool copyBox(const VoxelGrid& source, const Index& lower, const Index& upper) override final
+    {
+        const bool changed = VoxelGrid::copyBox(source, lower, upper);
+        return VoxelGrid::copyBoxVector(this->data_occupancy, static_cast<const BinaryTSDF&>(source).data_occupancy,
+                                        *this->properties, lower, upper) || changed;
+    }
+
+
     /// @brief Accessor for `metrics::ground_truth::ExperimentOccupancy` in
     ///       `metrics::OccupancyConfusion`
     /// @return Read-only reference to the Occupancy data vector.
@@ -69,13 +128,53 @@ public:
     }
 
 
+    /// @brief Writes the occupancy of every voxel into an existing vector.
+    /// @param [out] occupancy_data Occupancy data vector. Resized to one element for each voxel,
+    ///                             which only allocates if it is too small.
+    void getOccupancyData(std::vector<uint8_t>& occupancy_data) const
+    {
+        occupancy_data.resize(this->properties->getNumVoxels());
+        this->getOccupancyData(occupancy_data, 0, occupancy_data.size());
+    }
+
+
+    /// @brief Writes the occupancy of the voxels `[first, last)` into an existing vector.
+    /// @param [out] occupancy_data Occupancy data vector with one element for each voxel.
+    /// @param first Vector index of the first voxel to write.
+    /// @param last  Vector index one past the last voxel to write.
+    void getOccupancyData(std::vector<uint8_t>& occupancy_data, const size_t& first, const size_t& last) const
+    {
+        std::copy(this->data_occupancy.begin() + first, this->data_occupancy.begin() + last,
+                  occupancy_data.begin() + first);
+    }
+
+
     /// @brief Updates the Grid with new information along a ray.
     /// @param ray_trace Trace with update voxel location and distances.
     void update(const std::shared_ptr<const Trace>& ray_trace) override final
     {
-        this->update_callable.acquireRayTrace(ray_trace);
-        std::visit(this->update_callable, this->data);
-        this->update_callable.releaseRayTrace();
+        this->visitUpdate(this->update_callable, ray_trace);
+    }
+
+
+    /// @brief Updates the Grid with new information along each ray in a batch.
+    /// @param trace_batch Batch of traces with update voxel locations and distances.
+    void update(const std::shared_ptr<const TraceBatch>& trace_batch) override final
+    {
+        this->visitUpdate(this->update_callable, trace_batch);
+    }
+
+
+    std::shared_ptr<VoxelGrid> clone() const override final
+    {
+        return std::shared_ptr<BinaryTSDF>(new BinaryTSDF(*this));
+    }
+
+
+    /// @brief Returns true, the Grid supports the projective update.
+    bool hasProjectiveUpdate() const override final
+    {
+        return true;
     }
 
     static const std::string type_name;
@@ -104,29 +203,48 @@ private:
     }
 
 
-    void save(HighFive::Group& g_channel, const std::string& grid_type) override final
+    /// @brief Copy constructor for `clone`.
+    BinaryTSDF(const BinaryTSDF& other)
+        : VoxelGrid(other),
+          data_occupancy(other.data_occupancy),
+          update_callable(*this)
     {
-        try
+
+    }
+
+
+    void save(HighFive::Group& g_channel, const std::string& grid_type,
+              const utilities::DataSetOptions& options) const override final
+    {
+        auto save_data = [this, &g_channel, &grid_type, &options](const auto& vector)
         {
-            if (this->type_id == DataType::FLOAT)
-            {
-                g_channel.createDataSet(grid_type + "_tsdf", std::get<std::vector<float>>(this->data));
-            }
-            else if (this->type_id == DataType::DOUBLE)
-            {
-                g_channel.createDataSet(grid_type + "_tsdf", std::get<std::vector<double>>(this->data));
-            }
-            else
-            {
-                throw DataVariantError::UnrecognizedEnumeration(this->type_id);
-            }
-        }
-        catch (const std::bad_variant_access&)
+            this->createDataSet(g_channel, grid_type + "_tsdf", vector, options);
+        };
+        std::visit(save_data, this->data);
+
+        this->createDataSet(g_channel, grid_type + "_binary", this->data_occupancy, options);
+    }
+
+
+    void saveBox(HighFive::Group& g_channel, const std::string& grid_type,
+                 const Index& lower, const Index& upper) const override final
+    {
+        std::visit([&](const auto& vector) { this->writeBox(g_channel, grid_type + "_tsdf", vector, lower, upper); },
+                   this->data);
+
+        this->writeBox(g_channel, grid_type + "_binary", this->data_occupancy, lower, upper);
+    }
+
+
+    void load(const HighFive::Group& g_channel, const std::string& grid_type) override final
+    {
+        auto load_data = [this, &g_channel, &grid_type](auto& vector)
         {
-            throw std::runtime_error("Bad variant access: Cannot save Grid's Data vector to HDF5 file.");
-        }
+            this->readDataSet(g_channel, grid_type + "_tsdf", vector);
+        };
+        std::visit(load_data, this->data);
 
-        g_channel.createDataSet(grid_type + "_binary", this->data_occupancy);
+        this->readDataSet(g_channel, grid_type + "_binary", this->data_occupancy);
     }
 
 
@@ -164,42 +282,40 @@ private:
         // ************************************************************************************* //
 
 
-        void operator()(std::vector<float>& vector)
-        {
-            Trace::const_iterator iter            = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last_occ  = this->ray_trace->first_above(0, iter);
-            const Trace::const_iterator last_free = this->ray_trace->first_above(this->caller.dist_max, last_occ);
+        void operator()(std::vector<float>&   vector) { this->updateVector(vector); }
+        void operator()(std::vector<double>&  vector) { this->updateVector(vector); }
 
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last_occ; ++iter)
-            {
-                this->caller.data_occupancy[iter->i] = VoxelOccupancy::OCCUPIED;
-                vector[iter->i] = utilities::math::smallest_magnitude(vector[iter->i], iter->d);
-            }
-            for ( ; iter != last_free; ++iter)
-            {
-                this->caller.data_occupancy[iter->i] = VoxelOccupancy::FREE;
-                vector[iter->i] = utilities::math::smallest_magnitude(vector[iter->i], iter->d);
-            }
-        }
+        void operator()(SparseVector<float>&  vector) { this->updateVector(vector); }
+        void operator()(SparseVector<double>& vector) { this->updateVector(vector); }
+        void operator()(MappedVector<float>&  vector) { this->updateVector(vector); }
+        void operator()(MappedVector<double>& vector) { this->updateVector(vector); }
 
 
-        void operator()(std::vector<double>& vector)
+        /// @brief Updates the minimum magnitude distance and occupancy label of voxels on every ray.
+        /// @param vector Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+        template <typename Vector>
+        void updateVector(Vector& vector)
         {
-            Trace::const_iterator iter            = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last_occ  = this->ray_trace->first_above(0, iter);
-            const Trace::const_iterator last_free = this->ray_trace->first_above(this->caller.dist_max, last_occ);
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last_occ; ++iter)
-            {
-                this->caller.data_occupancy[iter->i] = VoxelOccupancy::OCCUPIED;
-                vector[iter->i] = utilities::math::smallest_magnitude(vector[iter->i], static_cast<double>(iter->d));
-            }
-            for ( ; iter != last_free; ++iter)
+            using T = typename Vector::value_type;
+
+            this->forEachRay([&](const auto& ray_trace)
             {
-                this->caller.data_occupancy[iter->i] = VoxelOccupancy::FREE;
-                vector[iter->i] = utilities::math::smallest_magnitude(vector[iter->i], static_cast<double>(iter->d));
-            }
+                auto iter            = ray_trace.first_above(this->caller.dist_min);
+                const auto last_occ  = ray_trace.first_above(0, iter);
+                const auto last_free = ray_trace.first_above(this->caller.dist_max, last_occ);
+
+                // ************************** APPLY VOXEL UPDATE HERE ************************** //
+                for ( ; iter != last_occ; ++iter)
+                {
+                    this->caller.data_occupancy[iter->i] = VoxelOccupancy::OCCUPIED;
+                    vector[iter->i] = utilities::math::smallest_magnitude(vector[iter->i], static_cast<T>(iter->d));
+                }
+                for ( ; iter != last_free; ++iter)
+                {
+                    this->caller.data_occupancy[iter->i] = VoxelOccupancy::FREE;
+                    vector[iter->i] = utilities::math::smallest_magnitude(vector[iter->i], static_cast<T>(iter->d));
+                }
+            });
         }
 
 
@@ -222,6 +338,7 @@ private:
 
 
     /// @brief Stores the occupancy data that the grid uses.
+    /// @note  This is always dense, even if the Grid Properties request sparse storage.
     std::vector<uint8_t> data_occupancy;
 
     /// @brief Subclass callable that std::visit uses to perform updates with typed information.
@@ -2,6 +2,8 @@
 #define FORGE_SCAN_RECONSTRUCTION_GRID_CONSTRUCTOR_HPP
 
 #include <memory>
+#include <sstream>
+#include <string>
 
 #include "ForgeScan/Data/VoxelGrids/Binary.hpp"
 #include "ForgeScan/Data/VoxelGrids/BinaryTSDF.hpp"
@@ -60,6 +62,82 @@ struct Constructor
     }
 
 
+    /// @brief Estimates the memory a VoxelGrid allocates when it is created, without creating it.
+    /// @param parser Arguments that would be passed to `create`.
+    /// @param properties A shared, constant reference to the `Grid::Properties` for the Reconstruction.
+    /// @return Number of bytes allocated. See `VoxelGrid::estimateVectorMemory`.
+    /// @throws ConstructorError if the VoxelGrid type is not recognized.
+    static size_t estimateMemoryUsage(const utilities::ArgParser& parser,
+                                      std::shared_ptr<const Grid::Properties> properties)
+    {
+        using namespace utilities::strings;
+        std::string grid_type = parser.get(VoxelGrid::parse_type);
+
+        if (iequals(grid_type, Binary::type_name))
+        {
+            return Binary::estimateMemoryUsage(properties, parser);
+        }
+        if (iequals(grid_type, BinaryTSDF::type_name))
+        {
+            return BinaryTSDF::estimateMemoryUsage(properties, parser);
+        }
+        if (iequals(grid_type, CountViews::type_name))
+        {
+            return CountViews::estimateMemoryUsage(properties, parser);
+        }
+        if (iequals(grid_type, Probability::type_name))
+        {
+            return Probability::estimateMemoryUsage(properties, parser);
+        }
+        if (iequals(grid_type, TSDF::type_name))
+        {
+            return TSDF::estimateMemoryUsage(properties, parser);
+        }
+        if (iequals(grid_type, CountUpdates::type_name))
+        {
+            return CountUpdates::estimateMemoryUsage(properties, parser);
+        }
+
+        throw ConstructorError::UnkownType(grid_type, VoxelGrid::type_name);
+    }
+
+
+    /// @brief Gets the arguments for a compact version of a VoxelGrid, which stores its data in
+    ///        fixed-point `int16_t` rather than floating point. See `Quantizer`.
+    /// @param parser Arguments that would be passed to `create`.
+    /// @param [out] compact Arguments with the data type changed.
+    /// @return True if the VoxelGrid has a compact version. False if it does not, or if the arguments
+    ///         already select a compact data type.
+    /// @note  Only `TSDF` and `Probability` VoxelGrids have compact versions.
+    static bool getCompactArgs(const utilities::ArgParser& parser, utilities::ArgParser& compact)
+    {
+        using namespace utilities::strings;
+        const std::string grid_type = parser.get(VoxelGrid::parse_type);
+        if (!iequals(grid_type, TSDF::type_name) && !iequals(grid_type, Probability::type_name))
+        {
+            return false;
+        }
+        if (!(stringToDataType(parser.get(VoxelGrid::parse_dtype), DataType::FLOAT) & DataType::TYPE_FLOATING_POINT))
+        {
+            return false;
+        }
+
+        std::stringstream ss(parser.getArgs());
+        std::string args, token;
+        while (ss >> token)
+        {
+            if (token == VoxelGrid::parse_dtype)
+            {
+                ss >> token;
+                continue;
+            }
+            args += token + " ";
+        }
+        compact.setArgs(args + VoxelGrid::parse_dtype + " " + dataTypeToString(DataType::INT16_T));
+        return true;
+    }
+
+
     /// @brief Returns a string help message for constructing a VoxelGrid.
     /// @param parser Arguments to pass determine which help information to print.
     static std::string help(const utilities::ArgParser& parser)
@@ -47,6 +47,18 @@ public:
     }
 
 
+    /// @brief Estimates the memory a CountUpdates VoxelGrid allocates when it is created.
+    /// @param properties Shared, constant pointer to the `Grid::Properties` to use.
+    /// @param parser ArgParser with arguments to construct a CountUpdates Grid from.
+    /// @return Number of bytes allocated by the data vector.
+    static size_t estimateMemoryUsage(const std::shared_ptr<const Grid::Properties>& properties,
+                                      const utilities::ArgParser& parser)
+    {
+        const DataType type_id = stringToDataType(parser.get(VoxelGrid::parse_dtype), DataType::UINT32_T);
+        return VoxelGrid::estimateVectorMemory(*properties, getDataTypeSize(type_id));
+    }
+
+
     /// @return Help message for constructing a CountUpdates VoxelGrid with ArgParser.
     static std::string helpMessage()
     {
@@ -66,11 +78,24 @@ public:
     /// @param ray_trace Trace with update voxel location and distances.
     void update(const std::shared_ptr<const Trace>& ray_trace) override final
     {
-        this->update_callable.acquireRayTrace(ray_trace);
-        std::visit(this->update_callable, this->data);
-        this->update_callable.releaseRayTrace();
+        this->visitUpdate(this->update_callable, ray_trace);
     }
 
+
+    /// @brief Updates the Grid with new information along each ray in a batch.
+    /// @param trace_batch Batch of traces with update voxel locations and distances.
+    void update(const std::shared_ptr<const TraceBatch>& trace_batch) override final
+    {
+        this->visitUpdate(this->update_callable, trace_batch);
+    }
+
+
+    std::shared_ptr<VoxelGrid> clone() const override final
+    {
+        return std::shared_ptr<CountUpdates>(new CountUpdates(*this));
+    }
+
+
     static const std::string type_name;
 
 private:
@@ -98,6 +123,15 @@ private:
     }
 
 
+    /// @brief Copy constructor for `clone`.
+    CountUpdates(const CountUpdates& other)
+        : VoxelGrid(other),
+          update_callable(*this)
+    {
+
+    }
+
+
     /// @brief Subclass provides update functions for each supported DataType/VectorVariant of
     ///        the data vector.
     struct UpdateCallable : public VoxelGrid::UpdateCallable
@@ -109,133 +143,60 @@ private:
         // ************************************************************************************* //
 
 
-        void operator()(std::vector<int8_t>& vector)
-        {
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->first_above(this->caller.dist_max, iter);
-
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
-            {
-                ++vector[iter->i];
-            }
-        }
-
-
-        void operator()(std::vector<int16_t>& vector)
-        {
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->first_above(this->caller.dist_max, iter);
-
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
-            {
-                ++vector[iter->i];
-            }
-        }
-
-
-        void operator()(std::vector<int32_t>& vector)
-        {
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->first_above(this->caller.dist_max, iter);
-
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
-            {
-                ++vector[iter->i];
-            }
-        }
-
-
-        void operator()(std::vector<int64_t>& vector)
-        {
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->first_above(this->caller.dist_max, iter);
-
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
-            {
-                ++vector[iter->i];
-            }
-        }
-
-
-        void operator()(std::vector<uint8_t>& vector)
-        {
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->first_above(this->caller.dist_max, iter);
-
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
-            {
-                ++vector[iter->i];
-            }
-        }
-
-
-        void operator()(std::vector<uint16_t>& vector)
-        {
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->first_above(this->caller.dist_max, iter);
-
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
-            {
-                ++vector[iter->i];
-            }
-        }
-
-
-        void operator()(std::vector<uint32_t>& vector)
-        {
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->first_above(this->caller.dist_max, iter);
-
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
-            {
-                ++vector[iter->i];
-            }
-        }
-
-
-        void operator()(std::vector<size_t>& vector)
-        {
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->first_above(this->caller.dist_max, iter);
-
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
-            {
-                ++vector[iter->i];
-            }
-        }
-
-
-        void operator()(std::vector<float>& vector)
-        {
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->first_above(this->caller.dist_max, iter);
-
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
-            {
-                ++vector[iter->i];
-            }
-        }
-
-
-        void operator()(std::vector<double>& vector)
+        void operator()(std::vector<int8_t>&    vector) { this->updateVector(vector); }
+        void operator()(std::vector<int16_t>&   vector) { this->updateVector(vector); }
+        void operator()(std::vector<int32_t>&   vector) { this->updateVector(vector); }
+        void operator()(std::vector<int64_t>&   vector) { this->updateVector(vector); }
+        void operator()(std::vector<uint8_t>&   vector) { this->updateVector(vector); }
+        void operator()(std::vector<uint16_t>&  vector) { this->updateVector(vector); }
+        void operator()(std::vector<uint32_t>&  vector) { this->updateVector(vector); }
+        void operator()(std::vector<size_t>&    vector) { this->updateVector(vector); }
+        void operator()(std::vector<float>&     vector) { this->updateVector(vector); }
+        void operator()(std::vector<double>&    vector) { this->updateVector(vector); }
+
+        void operator()(SparseVector<int8_t>&   vector) { this->updateVector(vector); }
+        void operator()(SparseVector<int16_t>&  vector) { this->updateVector(vector); }
+        void operator()(SparseVector<int32_t>&  vector) { this->updateVector(vector); }
+        void operator()(SparseVector<int64_t>&  vector) { this->updateVector(vector); }
+        void operator()(SparseVector<uint8_t>&  vector) { this->updateVector(vector); }
+        void operator()(SparseVector<uint16_t>& vector) { this->updateVector(vector); }
+        void operator()(SparseVector<uint32_t>& vector) { this->updateVector(vector); }
+        void operator()(SparseVector<size_t>&   vector) { this->updateVector(vector); }
+        void operator()(SparseVector<float>&    vector) { this->updateVector(vector); }
+        void operator()(SparseVector<double>&   vector) { this->updateVector(vector); }
+
+        void operator()(MappedVector<int8_t>&   vector) { this->updateVector(vector); }
+        void operator()(MappedVector<int16_t>&  vector) { this->updateVector(vector); }
+        void operator()(MappedVector<int32_t>&  vector) { this->updateVector(vector); }
+        void operator()(MappedVector<int64_t>&  vector) { this->updateVector(vector); }
+        void operator()(MappedVector<uint8_t>&  vector) { this->updateVector(vector); }
+        void operator()(MappedVector<uint16_t>& vector) { this->updateVector(vector); }
+        void operator()(MappedVector<uint32_t>& vector) { this->updateVector(vector); }
+        void operator()(MappedVector<size_t>&   vector) { this->updateVector(vector); }
+        void operator()(MappedVector<float>&    vector) { this->updateVector(vector); }
+        void operator()(MappedVector<double>&   vector) { this->updateVector(vector); }
+
+
+        /// @brief Increments each voxel on every ray between the minimum and maximum distance by the
+        ///        ray's weight. See `TraceBatch::Ray::weight`.
+        /// @param vector Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+        template <typename Vector>
+        void updateVector(Vector& vector)
         {
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->first_above(this->caller.dist_max, iter);
+            using T = typename Vector::value_type;
 
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
+            this->forEachRay([&](const auto& ray_trace)
             {
-                ++vector[iter->i];
-            }
+                auto iter = ray_trace.first_above(this->caller.dist_min);
+                const auto last = ray_trace.first_above(this->caller.dist_max, iter);
+                const T n_samples = static_cast<T>(ray_trace.weight());
+
+                // ************************** APPLY VOXEL UPDATE HERE ************************** //
+                for ( ; iter != last; ++iter)
+                {
+                    vector[iter->i] += n_samples;
+                }
+            });
         }
 
 
@@ -1,6 +1,7 @@
 #ifndef FORGE_SCAN_RECONSTRUCTIONS_GRID_COUNT_VIEWS_HPP
 #define FORGE_SCAN_RECONSTRUCTIONS_GRID_COUNT_VIEWS_HPP
 
+#include "ForgeScan/Common/Bitset.hpp"
 #include "ForgeScan/Data/VoxelGrids/VoxelGrid.hpp"
 
 
@@ -13,6 +14,8 @@ namespace data {
 /// @details This increments the count for a voxel only once group of updates, rather than the
 ///          CountUpdates class which increments for each ray traced.
 /// @note Rollover of integer types may occur if the type is too small.
+/// @note Unless the Grid is sparse, the voxels flagged by an update are recorded, so `postUpdate`
+///       only visits those rather than every voxel of the Grid.
 class CountViews : public VoxelGrid
 {
 public:
@@ -40,6 +43,30 @@ public:
     }
 
 
+    /// @brief Estimates the memory a CountViews VoxelGrid allocates when it is created.
+    /// @param properties Shared, constant pointer to the `Grid::Properties` to use.
+    /// @param parser ArgParser with arguments to construct a CountViews Grid from.
+    /// @return Number of bytes allocated by the data vector.
+    static size_t estimateMemoryUsage(const std::shared_ptr<const Grid::Properties>& properties,
+                                      const utilities::ArgParser& parser)
+    {
+        const DataType type_id = stringToDataType(parser.get(VoxelGrid::parse_dtype), DataType::SIZE_T);
+        const size_t n_touched = properties->sparse ? 0 : Bitset(properties->getNumVoxels()).sizeBytes();
+        return VoxelGrid::estimateVectorMemory(*properties, getDataTypeSize(type_id)) + n_touched;
+    }
+
+
+    /// @brief Calculates how much space the VoxelGrid is using, including its record of the voxels
+    ///        flagged by the current update.
+    utilities::memory_use::Usage getMemoryUsage() const override final
+    {
+        utilities::memory_use::Usage usage = VoxelGrid::getMemoryUsage();
+        usage.size_bytes     += this->touched.sizeBytes();
+        usage.capacity_bytes += this->touched.sizeBytes();
+        return usage;
+    }
+
+
     /// @return Help message for constructing a CountViews VoxelGrid with ArgParser.
     static std::string helpMessage()
     {
@@ -59,13 +86,35 @@ public:
     /// @param ray_trace Trace with update voxel location and distances.
     void update(const std::shared_ptr<const Trace>& ray_trace) override final
     {
-        this->update_callable.acquireRayTrace(ray_trace);
-        std::visit(this->update_callable, this->data);
-        this->update_callable.releaseRayTrace();
+        this->visitUpdate(this->update_callable, ray_trace);
+    }
+
+
+    /// @brief Updates the Grid with new information along each ray in a batch.
+    /// @param trace_batch Batch of traces with update voxel locations and distances.
+    void update(const std::shared_ptr<const TraceBatch>& trace_batch) override final
+    {
+        this->visitUpdate(this->update_callable, trace_batch);
+    }
+
+
+    std::shared_ptr<VoxelGrid> clone() const override final
+    {
+        return std::shared_ptr<CountViews>(new CountViews(*this));
+    }
+
+
+    /// @brief Returns infinity. Every voxel on a trace is counted, whatever its distance, so none
+    ///        may be left out of it.
+    float getSkipDistance() const override final
+    {
+        return INFINITY;
     }
 
 
     /// @brief Performs post-update processing on the Grid.
+    /// @note  Unless the Grid is sparse this takes time proportional to the voxels the update
+    ///        flagged, not to the size of the Grid.
     void postUpdate() override final
     {
         std::visit(this->post_update_callable, this->data);
@@ -111,6 +160,21 @@ private:
                     0,
                     type_id,
                     DataType::TYPE_UNSIGNED_INT),
+          touched(properties->sparse ? 0 : properties->getNumVoxels()),
+          update_callable(*this),
+          post_update_callable(*this)
+    {
+
+    }
+
+
+    /// @brief Copy constructor for `clone`.
+    CountViews(const CountViews& other)
+        : VoxelGrid(other),
+          occluded_count(other.occluded_count),
+          viewed_count(other.viewed_count),
+          unseen_count(other.unseen_count),
+          touched(other.touched),
           update_callable(*this),
           post_update_callable(*this)
     {
@@ -129,51 +193,48 @@ private:
         // ************************************************************************************* //
 
 
-        void operator()(std::vector<uint8_t>& vector)
-        {
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for (auto iter = this->ray_trace->begin(); iter != this->ray_trace->end(); ++iter)
-            {
-                const bool on_positive_ray = iter->d > 0.0f;
-                vector[iter->i] |=  (on_positive_ray * u8_viewed) +
-                                   (!on_positive_ray * u8_occluded);
-            }
-        }
+        void operator()(std::vector<uint8_t>&   vector) { this->updateVector(vector, u8_viewed,  u8_occluded);  }
+        void operator()(std::vector<uint16_t>&  vector) { this->updateVector(vector, u16_viewed, u16_occluded); }
+        void operator()(std::vector<uint32_t>&  vector) { this->updateVector(vector, u32_viewed, u32_occluded); }
+        void operator()(std::vector<size_t>&    vector) { this->updateVector(vector, sz_viewed,  sz_occluded);  }
 
+        void operator()(SparseVector<uint8_t>&  vector) { this->updateVector(vector, u8_viewed,  u8_occluded);  }
+        void operator()(SparseVector<uint16_t>& vector) { this->updateVector(vector, u16_viewed, u16_occluded); }
+        void operator()(SparseVector<uint32_t>& vector) { this->updateVector(vector, u32_viewed, u32_occluded); }
+        void operator()(SparseVector<size_t>&   vector) { this->updateVector(vector, sz_viewed,  sz_occluded);  }
 
-        void operator()(std::vector<uint16_t>& vector)
-        {
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for (auto iter = this->ray_trace->begin(); iter != this->ray_trace->end(); ++iter)
-            {
-                const bool on_positive_ray = iter->d > 0.0f;
-                vector[iter->i] |=  (on_positive_ray * u16_viewed) +
-                                   (!on_positive_ray * u16_occluded);
-            }
-        }
+        void operator()(MappedVector<uint8_t>&  vector) { this->updateVector(vector, u8_viewed,  u8_occluded);  }
+        void operator()(MappedVector<uint16_t>& vector) { this->updateVector(vector, u16_viewed, u16_occluded); }
+        void operator()(MappedVector<uint32_t>& vector) { this->updateVector(vector, u32_viewed, u32_occluded); }
+        void operator()(MappedVector<size_t>&   vector) { this->updateVector(vector, sz_viewed,  sz_occluded);  }
 
 
-        void operator()(std::vector<uint32_t>& vector)
+        /// @brief Flags each voxel on every ray as viewed or occluded.
+        /// @param vector Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+        /// @param viewed   Bit flag for a viewed voxel of the vector's data type.
+        /// @param occluded Bit flag for an occluded voxel of the vector's data type.
+        /// @note  Flagged voxels are recorded with the non-atomic `Bitset::set`. As for the changes
+        ///        recorded by `Binary`, this is safe in the parallel update because each thread only
+        ///        holds voxels in its own shard.
+        template <typename Vector, typename T>
+        void updateVector(Vector& vector, const T& viewed, const T& occluded)
         {
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for (auto iter = this->ray_trace->begin(); iter != this->ray_trace->end(); ++iter)
+            Bitset& touched   = this->caller.touched;
+            const bool record = touched.size() > 0;
+            this->forEachRay([&](const auto& ray_trace)
             {
-                const bool on_positive_ray = iter->d > 0.0f;
-                vector[iter->i] |=  (on_positive_ray * u32_viewed) +
-                                   (!on_positive_ray * u32_occluded);
-            }
-        }
-
-
-        void operator()(std::vector<size_t>& vector)
-        {
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for (auto iter = this->ray_trace->begin(); iter != this->ray_trace->end(); ++iter)
-            {
-                const bool on_positive_ray = iter->d > 0.0f;
-                vector[iter->i] |=  (on_positive_ray * sz_viewed) +
-                                   (!on_positive_ray * sz_occluded);
-            }
+                // ************************** APPLY VOXEL UPDATE HERE ************************** //
+                for (auto iter = ray_trace.begin(); iter != ray_trace.end(); ++iter)
+                {
+                    const bool on_positive_ray = iter->d > 0.0f;
+                    vector[iter->i] |=  (on_positive_ray * viewed) +
+                                       (!on_positive_ray * occluded);
+                    if (record)
+                    {
+                        touched.set(iter->i);
+                    }
+                }
+            });
         }
 
 
@@ -208,91 +269,61 @@ private:
         // ************************************************************************************* //
 
 
-        void operator()(std::vector<uint8_t>& vector)
-        {
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            this->caller.viewed_count   = 0;
-            this->caller.occluded_count = 0;
-            this->caller.unseen_count   = 0;
-            for (auto& iter : vector)
-            {
-                const bool was_viewed   =  iter & u8_viewed;
-                const bool was_occluded = (iter & u8_occluded) && !was_viewed;
-                iter &= u8_ceiling;
-
-                const bool no_overflow = iter != u8_ceiling;
-                iter += (was_viewed & no_overflow) * 1;
-
-                this->caller.viewed_count   += was_viewed;
-                this->caller.occluded_count += was_occluded;
-                this->caller.unseen_count   += !(was_viewed | was_occluded);
-            }
-        }
-
-
-        void operator()(std::vector<uint16_t>& vector)
-        {
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            this->caller.viewed_count   = 0;
-            this->caller.occluded_count = 0;
-            this->caller.unseen_count   = 0;
-            for (auto& iter : vector)
-            {
-                const bool was_viewed   =  iter & u16_viewed;
-                const bool was_occluded = (iter & u16_occluded) && !was_viewed;
-                iter &= u16_ceiling;
-
-                const bool no_overflow = iter != u16_ceiling;
-                iter += (was_viewed & no_overflow) * 1;
-
-                this->caller.viewed_count   += was_viewed;
-                this->caller.occluded_count += was_occluded;
-                this->caller.unseen_count   += !(was_viewed | was_occluded);
-            }
-        }
-
-
-        void operator()(std::vector<uint32_t>& vector)
+        void operator()(std::vector<uint8_t>&   vector) { this->postUpdateVector(vector, u8_viewed,  u8_occluded,  u8_ceiling);  }
+        void operator()(std::vector<uint16_t>&  vector) { this->postUpdateVector(vector, u16_viewed, u16_occluded, u16_ceiling); }
+        void operator()(std::vector<uint32_t>&  vector) { this->postUpdateVector(vector, u32_viewed, u32_occluded, u32_ceiling); }
+        void operator()(std::vector<size_t>&    vector) { this->postUpdateVector(vector, sz_viewed,  sz_occluded,  sz_ceiling);  }
+
+        void operator()(SparseVector<uint8_t>&  vector) { this->postUpdateVector(vector, u8_viewed,  u8_occluded,  u8_ceiling);  }
+        void operator()(SparseVector<uint16_t>& vector) { this->postUpdateVector(vector, u16_viewed, u16_occluded, u16_ceiling); }
+        void operator()(SparseVector<uint32_t>& vector) { this->postUpdateVector(vector, u32_viewed, u32_occluded, u32_ceiling); }
+        void operator()(SparseVector<size_t>&   vector) { this->postUpdateVector(vector, sz_viewed,  sz_occluded,  sz_ceiling);  }
+
+        void operator()(MappedVector<uint8_t>&  vector) { this->postUpdateVector(vector, u8_viewed,  u8_occluded,  u8_ceiling);  }
+        void operator()(MappedVector<uint16_t>& vector) { this->postUpdateVector(vector, u16_viewed, u16_occluded, u16_ceiling); }
+        void operator()(MappedVector<uint32_t>& vector) { this->postUpdateVector(vector, u32_viewed, u32_occluded, u32_ceiling); }
+        void operator()(MappedVector<size_t>&   vector) { this->postUpdateVector(vector, sz_viewed,  sz_occluded,  sz_ceiling);  }
+
+
+        /// @brief Increments the count of each voxel flagged as viewed, clears the flags, and
+        ///        counts the viewed, occluded and unseen voxels.
+        /// @param vector Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+        /// @param viewed   Bit flag for a viewed voxel of the vector's data type.
+        /// @param occluded Bit flag for an occluded voxel of the vector's data type.
+        /// @param ceiling  Largest count the vector's data type may hold.
+        /// @note  If the update recorded the voxels it flagged only those are visited. Every other
+        ///        voxel is unseen. A sparse Grid has no record, so every voxel is visited.
+        template <typename Vector, typename T>
+        void postUpdateVector(Vector& vector, const T& viewed, const T& occluded, const T& ceiling)
         {
             // **************************** APPLY VOXEL UPDATE HERE **************************** //
             this->caller.viewed_count   = 0;
             this->caller.occluded_count = 0;
             this->caller.unseen_count   = 0;
-            for (auto& iter : vector)
+            auto fold = [&](T& iter, const size_t& count)
             {
-                const bool was_viewed   =  iter & u32_viewed;
-                const bool was_occluded = (iter & u32_occluded) && !was_viewed;
-                iter &= u32_ceiling;
+                const bool was_viewed   =  iter & viewed;
+                const bool was_occluded = (iter & occluded) && !was_viewed;
+                iter &= ceiling;
 
-                const bool no_overflow = iter != u32_ceiling;
+                const bool no_overflow = iter != ceiling;
                 iter += (was_viewed & no_overflow) * 1;
 
-                this->caller.viewed_count   += was_viewed;
-                this->caller.occluded_count += was_occluded;
-                this->caller.unseen_count   += !(was_viewed | was_occluded);
-            }
-        }
+                this->caller.viewed_count   += was_viewed * count;
+                this->caller.occluded_count += was_occluded * count;
+                this->caller.unseen_count   += !(was_viewed | was_occluded) * count;
+            };
 
-
-        void operator()(std::vector<size_t>& vector)
-        {
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            this->caller.viewed_count   = 0;
-            this->caller.occluded_count = 0;
-            this->caller.unseen_count   = 0;
-            for (auto& iter : vector)
+            Bitset& touched = this->caller.touched;
+            if (touched.size() == 0)
             {
-                const bool was_viewed   =  iter & sz_viewed;
-                const bool was_occluded = (iter & sz_occluded) && !was_viewed;
-                iter &= sz_ceiling;
-
-                const bool no_overflow = iter != sz_ceiling;
-                iter += (was_viewed & no_overflow) * 1;
-
-                this->caller.viewed_count   += was_viewed;
-                this->caller.occluded_count += was_occluded;
-                this->caller.unseen_count   += !(was_viewed | was_occluded);
+                for_each_value(vector, fold);
+                return;
             }
+            touched.forEachSetInDirtyBlocks([&](const size_t& i) { fold(vector[i], 1); });
+            touched.resetDirtyBlocks();
+            this->caller.unseen_count = this->caller.properties->getNumVoxels() -
+                                        this->caller.viewed_count - this->caller.occluded_count;
         }
 
 
@@ -331,6 +362,10 @@ private:
 
     size_t occluded_count = 0, viewed_count = 0, unseen_count = 0;
 
+    /// @brief Voxels flagged as viewed or occluded by the current update, so `postUpdate` need only
+    ///        visit those. Empty if the Grid is sparse.
+    Bitset touched;
+
     /// @brief Subclass callable that std::visit uses to perform updates with typed information.
     /// @note  Initialization order matters. This must be declared last so the other class members that
     ///        this uses are guaranteed to be initialized.
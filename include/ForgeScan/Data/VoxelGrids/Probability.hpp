@@ -2,7 +2,10 @@
 #define FORGE_SCAN_RECONSTRUCTIONS_GRID_PROBABILITY_HPP
 
 #include <algorithm>
+#include <type_traits>
 
+#include "ForgeScan/Common/OccupancyPyramid.hpp"
+#include "ForgeScan/Common/Quantizer.hpp"
 #include "ForgeScan/Data/VoxelGrids/VoxelGrid.hpp"
 #include "ForgeScan/Utilities/Math.hpp"
 
@@ -13,7 +16,11 @@ namespace data {
 
 /// @brief Represents occupation probability via log-odds.
 ///        This implements similar logic to what the OctoMap library uses.
-/// @note Supports `float` and `double` data types only.
+/// @note Supports `float`, `double`, `int8_t` and `int16_t` data types. The integer types store the
+///       log-odds in fixed-point between the minimum and maximum log-odds, see `Quantizer`. For
+///       `int8_t` each voxel takes a quarter of the memory of `float`, with steps of about 0.03 in
+///       log-odds for the default probabilities. Each update is rounded to a step, so with many rays
+///       through each voxel `int8_t` drifts from `float` while `int16_t` tracks it closely.
 class Probability : public VoxelGrid
 {
 public:
@@ -50,8 +57,8 @@ public:
     /// @param p_sensed   Probability for the voxel at the sensed point. Default 0.90.
     /// @param p_far      Probability for voxels far in front of the sensed point. Default 0.15.
     /// @param p_init     Probability for voxel initialization. Default 0.50.
-    /// @param save_as_log_odds If true then the intermediate log odds value is stored. Other wise the
-    ///                        voxels are converted to probability, saved, then back to log odds.
+    /// @param save_as_log_odds If true then the intermediate log odds value is stored. Other wise a
+    ///                        copy of the voxels is converted to probability and saved.
     /// @param type_id Datatype for the Grid. Default is float.
     /// @return Shared pointer to a Probability Grid.
     /// @note Probability values clamped to the range 0<= p <= 1.
@@ -82,6 +89,19 @@ public:
     }
 
 
+    /// @brief Estimates the memory a Probability VoxelGrid allocates when it is created.
+    /// @param properties Shared, constant pointer to the `Grid::Properties` to use.
+    /// @param parser ArgParser with arguments to construct a Probability Grid from.
+    /// @return Number of bytes allocated by the data vector. The pyramid is allocated later, when
+    ///         first used.
+    static size_t estimateMemoryUsage(const std::shared_ptr<const Grid::Properties>& properties,
+                                      const utilities::ArgParser& parser)
+    {
+        const DataType type_id = stringToDataType(parser.get(VoxelGrid::parse_dtype), DataType::FLOAT);
+        return VoxelGrid::estimateVectorMemory(*properties, getDataTypeSize(type_id));
+    }
+
+
     /// @return Help message for constructing a Probability VoxelGrid with ArgParser.
     static std::string helpMessage()
     {
@@ -101,41 +121,126 @@ public:
     /// @return Occupancy data vector.
     std::vector<uint8_t> getOccupancyData() const
     {
-        auto occupancy_data = std::vector<uint8_t>(this->properties->getNumVoxels(), VoxelOccupancy::UNSEEN);
+        std::vector<uint8_t> occupancy_data;
+        this->getOccupancyData(occupancy_data);
+        return occupancy_data;
+    }
+
+
+    /// @brief Writes the occupancy of every voxel into an existing vector.
+    /// @param [out] occupancy_data Occupancy data vector. Resized to one element for each voxel,
+    ///                             which only allocates if it is too small.
+    void getOccupancyData(std::vector<uint8_t>& occupancy_data) const
+    {
+        occupancy_data.resize(this->properties->getNumVoxels());
+        this->getOccupancyData(occupancy_data, 0, occupancy_data.size());
+    }
+
+
+    /// @brief Writes the occupancy of the voxels `[first, last)` into an existing vector.
+    /// @param [out] occupancy_data Occupancy data vector with one element for each voxel.
+    /// @param first Vector index of the first voxel to write.
+    /// @param last  Vector index one past the last voxel to write.
+    /// @note  The loop is branch-free so it vectorizes for dense data.
+    void getOccupancyData(std::vector<uint8_t>& occupancy_data, const size_t& first, const size_t& last) const
+    {
+        // With the seen record, voxels at or above the threshold are occupied. Without it they
+        // are unseen.
+        const bool with_seen_info = this->data_seen != nullptr &&
+                                    this->data_seen->size() == this->properties->getNumVoxels();
 
+        // Everything the loop reads is copied into locals first. See `getElements`.
         auto get_occupancy_data = [&](auto&& data){
-            for (size_t i = 0; i < data.size(); ++i)
+            using T = typename std::decay_t<decltype(data)>::value_type;
+            const auto& values = getElements(data);
+            const float threshold = this->quantizer.template storedThreshold<T>(this->log_p_thresh);
+            const uint8_t not_free = with_seen_info ? VoxelOccupancy::OCCUPIED : VoxelOccupancy::UNSEEN;
+            uint8_t* const out = occupancy_data.data();
+            for (size_t i = first, end = last; i < end; ++i)
             {
-                if (data[i] < this->log_p_thresh)
-                {
-                    occupancy_data[i] = VoxelOccupancy::FREE;
-                }
+                out[i] = values[i] < threshold ? static_cast<uint8_t>(VoxelOccupancy::FREE) : not_free;
             }
         };
+        std::visit(get_occupancy_data, this->data);
+    }
 
-        auto get_occupancy_data_with_seen_info = [&](auto&& data){
-            for (size_t i = 0; i < data.size(); ++i)
-            {
-                if (data[i] < this->log_p_thresh) // || (data[i] == this->log_p_init && this->data_seen->operator[](i) == true))
-                {
-                    occupancy_data[i] = VoxelOccupancy::FREE;
-                }
-                else // if (data[i] != this->log_p_init)
-                {
-                    occupancy_data[i] = VoxelOccupancy::OCCUPIED;
-                }
-            }
-        };
 
-        if (this->data_seen != nullptr && this->data_seen->size() == this->properties->getNumVoxels())
+    /// @brief Returns the distance past which every voxel is updated with the far probability.
+    float getSkipDistance() const override final
+    {
+        return std::max(this->dist_max, 0.0f);
+    }
+
+
+    /// @brief Returns true if the voxel's log-odds are clamped at the bound the far probability moves
+    ///        it towards, so updating it with the far probability leaves it unchanged.
+    /// @param i Vector index of the voxel.
+    bool isSaturated(const size_t& i) const override final
+    {
+        if (this->p_far == 0.5f)
         {
-            std::visit(get_occupancy_data_with_seen_info, this->data);
+            return true;
         }
-        else
+        const float bound = this->p_far < 0.5f ? this->log_p_min : this->log_p_max;
+        return std::visit([&](auto&& data)
+        {
+            using T = typename std::decay_t<decltype(data)>::value_type;
+            return data[i] == this->quantizer.template encode<T>(bound);
+        }, this->data);
+    }
+
+
+    /// @brief Calculates how much space the VoxelGrid is using, including its pyramid.
+    utilities::memory_use::Usage getMemoryUsage() const override final
+    {
+        utilities::memory_use::Usage usage = VoxelGrid::getMemoryUsage();
+        if (this->pyramid)
         {
-            std::visit(get_occupancy_data, this->data);
+            usage.size_bytes     += this->pyramid->sizeBytes();
+            usage.capacity_bytes += this->pyramid->sizeBytes();
+        }
+        return usage;
+    }
+
+
+    /// @brief Gets the pyramid of coarse occupancy summaries, brought up to date with the last update.
+    /// @return Read-only reference to the pyramid. It is valid until the next update.
+    /// @note  Voxels below the threshold probability are free. Others are occupied if they have been
+    ///        seen and unknown if not, or unknown for all if the seen data is not available.
+    /// @note  The first call starts maintaining the pyramid. Updates do not record which voxels they
+    ///        change, so the first call after each update rebuilds it with a pass over every voxel.
+    std::shared_ptr<const OccupancyPyramid> getPyramid()
+    {
+        if (!this->pyramid)
+        {
+            this->pyramid = std::make_shared<OccupancyPyramid>(this->properties);
+        }
+        if (this->pyramid->isStale())
+        {
+            const bool has_seen = this->data_seen != nullptr && this->data_seen->size() == this->properties->getNumVoxels();
+            std::visit([&](auto&& data)
+            {
+                this->pyramid->refresh([&](const size_t& i)
+                {
+                    if (this->quantizer.decode(data[i]) < this->log_p_thresh)
+                    {
+                        return VoxelOccupancy::FREE;
+                    }
+                    return has_seen && this->data_seen->test(i) ? VoxelOccupancy::OCCUPIED : VoxelOccupancy::UNSEEN;
+                });
+            }, this->data);
+        }
+        return this->pyramid;
+    }
+
+
+    /// @brief Marks the pyramid, if there is one, to be rebuilt.
+    void postUpdate() override final
+    {
+        if (this->pyramid)
+        {
+            this->pyramid->markAll();
         }
-        return occupancy_data;
     }
 
 
@@ -143,9 +248,28 @@ public:
     /// @param ray_trace Trace with update voxel location and distances.
     void update(const std::shared_ptr<const Trace>& ray_trace) override final
     {
-        this->update_callable.acquireRayTrace(ray_trace);
-        std::visit(this->update_callable, this->data);
-        this->update_callable.releaseRayTrace();
+        this->visitUpdate(this->update_callable, ray_trace);
+    }
+
+
+    /// @brief Updates the Grid with new information along each ray in a batch.
+    /// @param trace_batch Batch of traces with update voxel locations and distances.
+    void update(const std::shared_ptr<const TraceBatch>& trace_batch) override final
+    {
+        this->visitUpdate(this->update_callable, trace_batch);
+    }
+
+
+    std::shared_ptr<VoxelGrid> clone() const override final
+    {
+        return std::shared_ptr<Probability>(new Probability(*this));
+    }
+
+
+    /// @brief Returns true if the Grid stores its data in a fixed-point integer type.
+    bool isQuantized() const
+    {
+        return this->type_id & DataType::TYPE_SIGNED_INT;
     }
 
 
@@ -168,8 +292,8 @@ private:
     /// @param p_sensed   Probability for the voxel at the sensed point.
     /// @param p_far      Probability for voxels far in front of the sensed point.
     /// @param p_init     Probability for voxel initialization.
-    /// @param save_as_log_odd If true then the intermediate log odds value is stored. Other wise the
-    ///                        voxels are converted to probability, saved, then back to log odds.
+    /// @param save_as_log_odd If true then the intermediate log odds value is stored. Other wise a
+    ///                        copy of the voxels is converted to probability and saved.
     /// @param type_id Datatype for the Grid.
     /// @throws DataVariantError if the DataType is not supported by this VoxelGrid.
     explicit Probability(const std::shared_ptr<const Grid::Properties>& properties,
@@ -187,9 +311,9 @@ private:
         : VoxelGrid(properties,
                     dist_min,
                     dist_max,
-                    utilities::math::log_odds(p_init),
+                    Quantizer(Probability::getQuantizerRange(p_min, p_max), type_id).stored(utilities::math::log_odds(p_init), type_id),
                     type_id,
-                    DataType::TYPE_FLOATING_POINT),
+                    static_cast<DataType>(DataType::TYPE_FLOATING_POINT | DataType::TYPE_SIGNED_INT)),
           log_p_max(utilities::math::log_odds(p_max)),
           log_p_min(utilities::math::log_odds(p_min)),
           log_p_init(utilities::math::log_odds(p_init)),
@@ -198,6 +322,7 @@ private:
           p_far(p_far),
           log_p_thresh(utilities::math::log_odds(p_thresh)),
           save_as_log_odds(save_as_log_odds),
+          quantizer(Probability::getQuantizerRange(p_min, p_max), this->type_id),
           update_callable(*this),
           update_callable_converter(*this)
     {
@@ -205,20 +330,152 @@ private:
     }
 
 
+    /// @brief Copy constructor for `clone`. The pyramid is copied if it is maintained.
+    Probability(const Probability& other)
+        : VoxelGrid(other),
+          log_p_max(other.log_p_max),
+          log_p_min(other.log_p_min),
+          log_p_init(other.log_p_init),
+          p_past(other.p_past),
+          p_sensed(other.p_sensed),
+          p_far(other.p_far),
+          log_p_thresh(other.log_p_thresh),
+          save_as_log_odds(other.save_as_log_odds),
+          quantizer(other.quantizer),
+          update_callable(*this),
+          update_callable_converter(*this),
+          pyramid(other.pyramid ? std::make_shared<OccupancyPyramid>(*other.pyramid) : nullptr)
+    {
+
+    }
+
+
+    /// @brief Largest log-odds magnitude the fixed-point data must hold.
+    /// @param p_min Probability for voxel minimum voxel value saturation.
+    /// @param p_max Probability for voxel maximum voxel value saturation.
+    static float getQuantizerRange(const float& p_min, const float& p_max)
+    {
+        return std::max(std::abs(utilities::math::log_odds(p_min)), std::abs(utilities::math::log_odds(p_max)));
+    }
+
+
     /// @note This is virtual so VoxelGrid with multiple data channels may specifically handle
     ///       their channels. But most derived VoxelGrids may uses this method.
-    void save(HighFive::Group& g_channel, const std::string& grid_type) override final
+    /// @note The data of a quantized Grid is saved decoded, as `float`.
+    void save(HighFive::Group& g_channel, const std::string& grid_type,
+              const utilities::DataSetOptions& options) const override final
     {
+        if (this->isQuantized())
+        {
+            std::vector<float> decoded = std::visit([&](const auto& vector)
+            {
+                return this->quantizer.decodeAll(vector, this->properties->getNumVoxels());
+            }, this->data);
+            if (this->save_as_log_odds == false)
+            {
+                std::transform(decoded.begin(), decoded.end(), decoded.begin(), utilities::math::probability<float>);
+            }
+            this->createDataSet(g_channel, grid_type, decoded, options);
+            return;
+        }
         if (this->save_as_log_odds == false)
         {
-            this->update_callable_converter.setToProbability();
-            std::visit(this->update_callable_converter, this->data);
+            std::visit([&](const auto& vector) { this->saveAsProbability(g_channel, grid_type, vector, options); },
+                       this->data);
+            return;
+        }
+        VoxelGrid::save(g_channel, grid_type, options);
+    }
+
+
+    /// @note Only the voxels in the box are decoded or converted to probabilities.
+    void saveBox(HighFive::Group& g_channel, const std::string& grid_type,
+                 const Index& lower, const Index& upper) const override final
+    {
+        if (this->isQuantized())
+        {
+            std::visit([&](const auto& vector)
+            {
+                this->writeBox<float>(g_channel, grid_type, lower, upper, [&](const size_t& i)
+                {
+                    const float log_odds = static_cast<float>(this->quantizer.decode(vector[i]));
+                    return this->save_as_log_odds ? log_odds : utilities::math::probability(log_odds);
+                });
+            }, this->data);
+            return;
         }
-        VoxelGrid::save(g_channel, grid_type);
         if (this->save_as_log_odds == false)
         {
-            this->update_callable_converter.setToLogOdds();
-            std::visit(this->update_callable_converter, this->data);
+            std::visit([&](const auto& vector)
+            {
+                using T = typename std::decay_t<decltype(vector)>::value_type;
+                if constexpr (std::is_floating_point_v<T>)
+                {
+                    this->writeBox<T>(g_channel, grid_type, lower, upper,
+                                      [&](const size_t& i) { return utilities::math::probability<T>(vector[i]); });
+                }
+            }, this->data);
+            return;
+        }
+        VoxelGrid::saveBox(g_channel, grid_type, lower, upper);
+    }
+
+
+    /// @note Data saved as probabilities is converted back to log-odds.
+    /// @note A quantized Grid encodes the saved values, so it may load files saved by a Grid of any
+    ///       type. Values outside the minimum and maximum log-odds saturate.
+    void load(const HighFive::Group& g_channel, const std::string& grid_type) override final
+    {
+        if (this->isQuantized())
+        {
+            std::vector<float> decoded;
+            this->readDataSet(g_channel, grid_type, decoded);
+            if (this->save_as_log_odds == false)
+            {
+                std::transform(decoded.begin(), decoded.end(), decoded.begin(), utilities::math::log_odds<float>);
+            }
+            std::visit([&](auto& vector) { this->quantizer.encodeAll(decoded, vector); }, this->data);
+        }
+        else
+        {
+            VoxelGrid::load(g_channel, grid_type);
+            if (this->save_as_log_odds == false)
+            {
+                this->update_callable_converter.setToLogOdds();
+                std::visit(this->update_callable_converter, this->data);
+            }
+        }
+        if (this->pyramid)
+        {
+            this->pyramid->markAll();
+        }
+    }
+
+
+    /// @brief Saves a copy of the log-odds data vector converted to probabilities.
+    /// @param g_channel Group in for the opened HDF5 file.
+    /// @param grid_type Name of the derived class.
+    /// @param vector Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+    /// @param options Chunking and compression for the data set.
+    template <typename Vector>
+    void saveAsProbability(HighFive::Group& g_channel, const std::string& grid_type, const Vector& vector,
+                           const utilities::DataSetOptions& options) const
+    {
+        using T = typename Vector::value_type;
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            std::vector<T> probabilities;
+            if constexpr (std::is_same_v<Vector, std::vector<T>>)
+            {
+                probabilities = vector;
+            }
+            else
+            {
+                probabilities = vector.toDense();
+            }
+            std::transform(probabilities.begin(), probabilities.end(), probabilities.begin(),
+                           utilities::math::probability<T>);
+            this->createDataSet(g_channel, grid_type, probabilities, options);
         }
     }
 
@@ -234,45 +491,66 @@ private:
         // ************************************************************************************* //
 
 
-        void operator()(std::vector<float>& vector)
+        void operator()(std::vector<float>&    vector) { this->updateVector(vector); }
+        void operator()(std::vector<double>&   vector) { this->updateVector(vector); }
+        void operator()(std::vector<int8_t>&   vector) { this->updateVector(vector); }
+        void operator()(std::vector<int16_t>&  vector) { this->updateVector(vector); }
+
+        void operator()(SparseVector<float>&   vector) { this->updateVector(vector); }
+        void operator()(SparseVector<double>&  vector) { this->updateVector(vector); }
+        void operator()(SparseVector<int8_t>&  vector) { this->updateVector(vector); }
+        void operator()(SparseVector<int16_t>& vector) { this->updateVector(vector); }
+        void operator()(MappedVector<float>&   vector) { this->updateVector(vector); }
+        void operator()(MappedVector<double>&  vector) { this->updateVector(vector); }
+        void operator()(MappedVector<int8_t>&  vector) { this->updateVector(vector); }
+        void operator()(MappedVector<int16_t>& vector) { this->updateVector(vector); }
+
+
+        /// @brief Adds the log-odds occupation probability of each voxel on every ray.
+        /// @param vector Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+        /// @note  A ray's weight, see `TraceBatch::Ray::weight`, scales its log-odds increments. A
+        ///        voxel would be given the same increment by each of the rays the weight stands for,
+        ///        so this saturates the same as adding it that many times.
+        template <typename Vector>
+        void updateVector(Vector& vector)
         {
-            using namespace forge_scan::utilities::math;
+            using T = typename Vector::value_type;
 
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->end();
-
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
+            this->forEachRay([&](const auto& ray_trace)
             {
-                float px = this->get_px(iter);
-                vector[iter->i] = std::clamp(vector[iter->i] + log_odds(px),
-                                             this->caller.log_p_min, this->caller.log_p_max);
-            }
-        }
-
+                using namespace forge_scan::utilities::math;
 
-        void operator()(std::vector<double>& vector)
-        {
-            using namespace forge_scan::utilities::math;
-
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->end();
+                auto iter = ray_trace.first_above(this->caller.dist_min);
+                const auto last = ray_trace.end();
+                const float n_samples = static_cast<float>(ray_trace.weight());
 
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
-            {
-                float px = this->get_px(iter);
-                vector[iter->i] = std::clamp(vector[iter->i] + log_odds(px),
-                                             static_cast<double>(this->caller.log_p_min),
-                                             static_cast<double>(this->caller.log_p_max));
-            }
+                // ************************** APPLY VOXEL UPDATE HERE ************************** //
+                for ( ; iter != last; ++iter)
+                {
+                    const float increment = log_odds(this->get_px(iter)) * n_samples;
+                    if constexpr (std::is_floating_point_v<T>)
+                    {
+                        vector[iter->i] = std::clamp(vector[iter->i] + static_cast<T>(increment),
+                                                     static_cast<T>(this->caller.log_p_min),
+                                                     static_cast<T>(this->caller.log_p_max));
+                    }
+                    else
+                    {
+                        // The clamp keeps the log-odds bounds when they do not fall on a step.
+                        const float x = this->caller.quantizer.decode(vector[iter->i]) + increment;
+                        vector[iter->i] = this->caller.quantizer.template encode<T>(
+                            std::clamp(x, this->caller.log_p_min, this->caller.log_p_max));
+                    }
+                }
+            });
         }
 
 
         /// @brief Gets the occupation probability for a location on the ray.
-        /// @param iter Iterator for the ray trace.
+        /// @param iter Iterator for the ray trace. Either a `Trace` or a `TraceBatch::Ray` iterator.
         /// @return Occupation probability for the iterator's location on the ray.
-        float get_px(const Trace::const_iterator& iter)
+        template <typename Iterator>
+        float get_px(const Iterator& iter)
         {
             using namespace forge_scan::utilities::math;
 
@@ -320,29 +598,29 @@ private:
         // ************************************************************************************* //
 
 
-        void operator()(std::vector<float>& vector)
-        {
-            using namespace forge_scan::utilities::math;
-            using namespace std::placeholders;
+        void operator()(std::vector<float>&   vector) { this->convertVector(vector); }
+        void operator()(std::vector<double>&  vector) { this->convertVector(vector); }
 
-            auto convert = std::bind(this->to_probability ? probability<float> : log_odds<float>, _1);
-            for (auto& item : vector)
-            {
-                item = convert(item);
-            }
-        }
+        void operator()(SparseVector<float>&  vector) { this->convertVector(vector); }
+        void operator()(SparseVector<double>& vector) { this->convertVector(vector); }
+        void operator()(MappedVector<float>&  vector) { this->convertVector(vector); }
+        void operator()(MappedVector<double>& vector) { this->convertVector(vector); }
 
 
-        void operator()(std::vector<double>& vector)
+        /// @brief Converts every voxel between log-odds and probability.
+        /// @param vector Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+        template <typename Vector>
+        void convertVector(Vector& vector)
         {
             using namespace forge_scan::utilities::math;
             using namespace std::placeholders;
+            using T = typename Vector::value_type;
 
-            auto convert = std::bind(this->to_probability ? probability<double> : log_odds<double>, _1);
-            for (auto& item : vector)
+            auto convert = std::bind(this->to_probability ? probability<T> : log_odds<T>, _1);
+            for_each_value(vector, [&convert](T& item, const size_t&)
             {
                 item = convert(item);
-            }
+            });
         }
 
 
@@ -395,12 +673,19 @@ private:
     /// @brief Controls how the data is saved. If true log odds are saved.
     const bool save_as_log_odds;
 
+    /// @brief Fixed-point encoding of the log-odds between the minimum and maximum log-odds.
+    ///        Stores floating point data unchanged.
+    const Quantizer quantizer;
+
     /// @brief Subclass callable that std::visit uses to perform updates with typed information.
     /// @note  Initialization order matters. This musts be declared last so the other class members that
     ///        this uses are guaranteed to be initialized.
     UpdateCallable update_callable;
 
     UpdateCallableConverter update_callable_converter;
+
+    /// @brief Coarse summaries of the occupancy. Only maintained once requested.
+    std::shared_ptr<OccupancyPyramid> pyramid{nullptr};
 };
 
 
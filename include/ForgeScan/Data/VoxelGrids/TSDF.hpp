@@ -3,6 +3,7 @@
 
 #include <functional>
 
+#include "ForgeScan/Common/Quantizer.hpp"
 #include "ForgeScan/Data/VoxelGrids/VoxelGrid.hpp"
 #include "ForgeScan/Utilities/Math.hpp"
 
@@ -13,7 +14,10 @@ namespace data {
 
 /// @brief Represents a truncated signed-distance function (TSDF).
 /// @note Uses a minimum magnitude strategy to update the voxel's distance.
-/// @note Supports `float` and `double` data types only.
+/// @note Supports `float`, `double`, `int8_t` and `int16_t` data types. The integer types store the
+///       distance in fixed-point over the update distance range, see `Quantizer`. They also store
+///       the weights, sample counts and variance in compact types, see `compact`. This cuts the
+///       memory of each voxel by a factor of 2 to 4, at the cost of rounding each update.
 class TSDF : public VoxelGrid
 {
 public:
@@ -51,11 +55,36 @@ public:
                                         const bool& minimum   = false,
                                         const DataType& type_id = DataType::FLOAT)
     {
-        float default_value = minimum ? NEGATIVE_INFINITY : 0.0f;
+        const Quantizer quantizer(TSDF::getQuantizerRange(dist_min, dist_max), type_id);
+        float default_value = quantizer.stored(minimum ? NEGATIVE_INFINITY : 0.0f, type_id);
         return std::shared_ptr<TSDF>(new TSDF(properties, dist_min, dist_max, average, minimum, default_value, type_id));
     }
 
 
+    /// @brief Estimates the memory a TSDF VoxelGrid allocates when it is created.
+    /// @param properties Shared, constant pointer to the `Grid::Properties` to use.
+    /// @param parser ArgParser with arguments to construct an TSDF Grid from.
+    /// @return Number of bytes allocated by the data vector and the side channels the arguments
+    ///         select. See `VoxelGrid::estimateVectorMemory`.
+    static size_t estimateMemoryUsage(const std::shared_ptr<const Grid::Properties>& properties,
+                                      const utilities::ArgParser& parser)
+    {
+        const DataType type_id = stringToDataType(parser.get(VoxelGrid::parse_dtype), DataType::FLOAT);
+        const bool compact = type_id & DataType::TYPE_SIGNED_INT;
+        size_t bytes = VoxelGrid::estimateVectorMemory(*properties, getDataTypeSize(type_id));
+        if (parser.has(TSDF::parse_average))
+        {
+            bytes += compact ? VoxelGrid::estimateVectorMemory(*properties, 2 * sizeof(uint16_t), false) :
+                               VoxelGrid::estimateVectorMemory(*properties, sizeof(size_t) + sizeof(float), false);
+        }
+        if (!parser.has(TSDF::parse_minimum))
+        {
+            bytes += VoxelGrid::estimateVectorMemory(*properties, compact ? sizeof(uint16_t) : sizeof(float), false);
+        }
+        return bytes;
+    }
+
+
     /// @return Help message for constructing a TSDF VoxelGrid with ArgParser.
     static std::string helpMessage()
     {
@@ -76,28 +105,57 @@ public:
     /// @return Occupancy data vector.
     std::vector<uint8_t> getOccupancyData() const
     {
-        float default_value = this->minimum ? NEGATIVE_INFINITY : 0.0f;
-        auto occupancy_data = std::vector<uint8_t>(this->properties->getNumVoxels(), VoxelOccupancy::UNSEEN);
+        std::vector<uint8_t> occupancy_data;
+        this->getOccupancyData(occupancy_data);
+        return occupancy_data;
+    }
+
+
+    /// @brief Writes the occupancy of every voxel into an existing vector.
+    /// @param [out] occupancy_data Occupancy data vector. Resized to one element for each voxel,
+    ///                             which only allocates if it is too small.
+    void getOccupancyData(std::vector<uint8_t>& occupancy_data) const
+    {
+        occupancy_data.resize(this->properties->getNumVoxels());
+        this->getOccupancyData(occupancy_data, 0, occupancy_data.size());
+    }
+
+
+    /// @brief Writes the occupancy of the voxels `[first, last)` into an existing vector.
+    /// @param [out] occupancy_data Occupancy data vector with one element for each voxel.
+    /// @param first Vector index of the first voxel to write.
+    /// @param last  Vector index one past the last voxel to write.
+    /// @note  The loops are branch-free so they vectorize for dense data. The seen record is
+    ///        unpacked a chunk at a time for the same reason.
+    void getOccupancyData(std::vector<uint8_t>& occupancy_data, const size_t& first, const size_t& last) const
+    {
+        // Everything the loops read is copied into locals first. See `getElements`. A stored
+        // value is positive exactly when the value it represents is, so neither loop decodes.
         auto get_occupancy_data = [&](auto&& data){
-            for (size_t i = 0; i < data.size(); ++i)
+            const auto& values = getElements(data);
+            uint8_t* const out = occupancy_data.data();
+            for (size_t i = first, end = last; i < end; ++i)
             {
-                if (data[i] > 0.0f)
-                {
-                    occupancy_data[i] = VoxelOccupancy::FREE;
-                }
+                out[i] = values[i] > 0 ? VoxelOccupancy::FREE : VoxelOccupancy::UNSEEN;
             }
         };
 
         auto get_occupancy_data_with_seen_info = [&](auto&& data){
-            for (size_t i = 0; i < data.size(); ++i)
+            using T = typename std::decay_t<decltype(data)>::value_type;
+            static constexpr size_t chunk_size = 4 * Bitset::word_bits;
+            const auto& values = getElements(data);
+            const T default_value = this->quantizer.template encode<T>(this->minimum ? NEGATIVE_INFINITY : 0.0f);
+            uint8_t* const out = occupancy_data.data();
+            uint8_t seen[chunk_size];
+            for (size_t i0 = first, end = last; i0 < end; i0 += chunk_size)
             {
-                if (data[i] > 0.0f || (data[i] == default_value && this->data_seen->operator[](i) == true))
-                {
-                    occupancy_data[i] = VoxelOccupancy::FREE;
-                }
-                else // if (data[i] != default_value)
+                const size_t i1 = std::min(end, i0 + chunk_size);
+                this->data_seen->unpack(i0, i1, seen);
+                for (size_t i = i0; i < i1; ++i)
                 {
-                    occupancy_data[i] = VoxelOccupancy::OCCUPIED;
+                    const T value   = values[i];
+                    const bool free = (value > 0) | ((value == default_value) & (seen[i - i0] != 0));
+                    out[i] = free ? VoxelOccupancy::FREE : VoxelOccupancy::OCCUPIED;
                 }
             }
         };
@@ -110,8 +168,6 @@ public:
         {
             std::visit(get_occupancy_data, this->data);
         }
-
-        return occupancy_data;
     }
 
 
@@ -119,9 +175,157 @@ public:
     /// @param ray_trace Trace with update voxel location and distances.
     void update(const std::shared_ptr<const Trace>& ray_trace) override final
     {
-        this->update_callable.acquireRayTrace(ray_trace);
-        std::visit(this->update_callable, this->data);
-        this->update_callable.releaseRayTrace();
+        this->visitUpdate(this->update_callable, ray_trace);
+    }
+
+
+    /// @brief Updates the Grid with new information along each ray in a batch.
+    /// @param trace_batch Batch of traces with update voxel locations and distances.
+    void update(const std::shared_ptr<const TraceBatch>& trace_batch) override final
+    {
+        this->visitUpdate(this->update_callable, trace_batch);
+    }
+
+
+    std::shared_ptr<VoxelGrid> clone() const override final
+    {
+        return std::shared_ptr<TSDF>(new TSDF(*this));
+    }
+
+
+    /// @brief Returns true, the Grid supports the projective update.
+    bool hasProjectiveUpdate() const override final
+    {
+        return true;
+    }
+
+
+    /// @brief Returns true if the Grid stores its data in a fixed-point integer type.
+    bool isQuantized() const
+    {
+        return this->compact;
+    }
+
+
+    /// @brief Accessor for `metrics::ground_truth::ExperimentTSDF` in `metrics::TSDFError`.
+    /// @return Encoding of the stored distances.
+    const Quantizer& getQuantizer() const
+    {
+        return this->quantizer;
+    }
+
+
+    /// @brief Gets direct access to the weights of a weighted TSDF.
+    /// @return Pointer to the weights, in the layout of the Grid Properties. This is null for an average
+    ///         or minimum TSDF, or if the weights are stored sparsely or compactly. Then use
+    ///         `decodeWeights`.
+    const std::vector<float>* getWeights() const
+    {
+        const bool dense = !this->average && !this->minimum && !this->compact && !this->properties->sparse;
+        return dense ? &this->weights : nullptr;
+    }
+
+
+    /// @brief Copies the weights of a weighted TSDF, however they are stored.
+    /// @return Weights, in the layout of the Grid Properties. Empty for an average or minimum TSDF,
+    ///         which do not use weights.
+    std::vector<float> decodeWeights() const
+    {
+        if (this->average || this->minimum)
+        {
+            return {};
+        }
+        const size_t n = this->properties->getNumVoxels();
+        if (this->compact)
+        {
+            return this->properties->sparse ? this->weight_quantizer.decodeAll(this->sparse_compact_weights, n) :
+                                              this->weight_quantizer.decodeAll(this->compact_weights, n);
+        }
+        return this->properties->sparse ? this->sparse_weights.toDense() : this->weights;
+    }
+
+
+    /// @brief Calculates how much space the VoxelGrid is using, including its weights, sample
+    ///        counts and variance.
+    utilities::memory_use::Usage getMemoryUsage() const override final
+    {
+        utilities::memory_use::Usage usage = VoxelGrid::getMemoryUsage();
+        VoxelGrid::addMemoryUsage(this->sample_count, usage);
+        VoxelGrid::addMemoryUsage(this->variance,     usage);
+        VoxelGrid::addMemoryUsage(this->weights,      usage);
+        VoxelGrid::addMemoryUsage(this->sparse_sample_count, usage);
+        VoxelGrid::addMemoryUsage(this->sparse_variance,     usage);
+        VoxelGrid::addMemoryUsage(this->sparse_weights,      usage);
+        VoxelGrid::addMemoryUsage(this->compact_sample_count, usage);
+        VoxelGrid::addMemoryUsage(this->compact_variance,     usage);
+        VoxelGrid::addMemoryUsage(this->compact_weights,      usage);
+        VoxelGrid::addMemoryUsage(this->sparse_compact_sample_count, usage);
+        VoxelGrid::addMemoryUsage(this->sparse_compact_variance,     usage);
+        VoxelGrid::addMemoryUsage(this->sparse_compact_weights,      usage);
+        return usage;
+    }
+
+
+    /// @brief Moves the distances, and their weights, sample counts and variance, along an axis.
+    ///        See `VoxelGrid::shift`.
+    /// @param axis  Axis to move along.
+    /// @param steps Number of voxels to move by.
+    void shift(const size_t& axis, const int& steps) override final
+    {
+        VoxelGrid::shift(axis, steps);
+        auto shift_vector = [&](auto& vector)
+        {
+            using T = typename std::decay_t<decltype(vector)>::value_type;
+            if (vector.size() == this->properties->getNumVoxels())
+            {
+                VoxelGrid::shiftVector(vector, *this->properties, axis, steps, T(0));
+            }
+        };
+        shift_vector(this->sample_count);
+        shift_vector(this->variance);
+        shift_vector(this->weights);
+        shift_vector(this->sparse_sample_count);
+        shift_vector(this->sparse_variance);
+        shift_vector(this->sparse_weights);
+        shift_vector(this->compact_sample_count);
+        shift_vector(this->compact_variance);
+        shift_vector(this->compact_weights);
+        shift_vector(this->sparse_compact_sample_count);
+        shift_vector(this->sparse_compact_variance);
+        shift_vector(this->sparse_compact_weights);
+    }
+
+
+    /// @brief Copies the changed distances, and their weights, sample counts and variance, in a box
+    ///        from another TSDF. See `VoxelGrid::copyBox`.
+    /// @param source TSDF to copy from.
+    /// @param lower Lowest voxel of the box.
+    /// @param upper One past the highest voxel of the box, along each axis.
+    /// @return True if any voxel differed.
+    bool copyBox(const VoxelGrid& source, const Index& lower, const Index& upper) override final
+    {
+        bool changed = VoxelGrid::copyBox(source, lower, upper);
+        const TSDF& other = static_cast<const TSDF&>(source);
+        auto copy_vector = [&](auto& vector, const auto& from)
+        {
+            if (vector.size() == this->properties->getNumVoxels())
+            {
+                changed = VoxelGrid::copyBoxVector(vector, from, *this->properties, lower, upper) || changed;
+            }
+        };
+        copy_vector(this->sample_count,                other.sample_count);
+        copy_vector(this->variance,                    other.variance);
+        copy_vector(this->weights,                     other.weights);
+        copy_vector(this->sparse_sample_count,         other.sparse_sample_count);
+        copy_vector(this->sparse_variance,             other.sparse_variance);
+        copy_vector(this->sparse_weights,              other.sparse_weights);
+        copy_vector(this->compact_sample_count,        other.compact_sample_count);
+        copy_vector(this->compact_variance,            other.compact_variance);
+        copy_vector(this->compact_weights,             other.compact_weights);
+        copy_vector(this->sparse_compact_sample_count, other.sparse_compact_sample_count);
+        copy_vector(this->sparse_compact_variance,     other.sparse_compact_variance);
+        copy_vector(this->sparse_compact_weights,      other.sparse_compact_weights);
+        return changed;
     }
 
     static const std::string parse_average, parse_minimum;
@@ -151,78 +355,302 @@ private:
                     dist_max,
                     default_value,
                     type_id,
-                    DataType::TYPE_FLOATING_POINT),
+                    static_cast<DataType>(DataType::TYPE_FLOATING_POINT | DataType::TYPE_SIGNED_INT)),
           average(average),
           minimum(minimum),
+          compact(this->type_id & DataType::TYPE_SIGNED_INT),
+          quantizer(TSDF::getQuantizerRange(this->dist_min, this->dist_max), this->type_id),
+          variance_quantizer(std::pow(TSDF::getQuantizerRange(this->dist_min, this->dist_max), 2.0f), DataType::UINT16_T),
+          weight_quantizer(TSDF::compact_max_weight, DataType::UINT16_T),
+          count_quantizer(Quantizer::getMaxValue(DataType::UINT16_T), DataType::UINT16_T),
           update_callable(*this)
     {
         if (this->average && this->minimum)
         {
             throw ConstructorError::MutuallyExclusive(TSDF::type_name, "minimum", "average");
         }
-        if (this->average)
+        const size_t n = this->properties->getNumVoxels();
+        const bool sparse = this->properties->sparse;
+        if (this->average && this->compact)
+        {
+            if (sparse)
+            {
+                this->sparse_compact_sample_count = SparseVector<uint16_t>(this->properties->size, 0, this->properties->brick_size);
+                this->sparse_compact_variance     = SparseVector<uint16_t>(this->properties->size, 0, this->properties->brick_size);
+            }
+            else
+            {
+                this->compact_sample_count = std::vector<uint16_t>(n, 0);
+                this->compact_variance     = std::vector<uint16_t>(n, 0);
+            }
+        }
+        else if (this->average)
         {
-            this->sample_count = std::vector<size_t>(this->properties->getNumVoxels(), 0);
-            this->variance     = std::vector<float>(this->properties->getNumVoxels(), 0.0f);
+            if (sparse)
+            {
+                this->sparse_sample_count = SparseVector<size_t>(this->properties->size, 0, this->properties->brick_size);
+                this->sparse_variance     = SparseVector<float>(this->properties->size, 0.0f, this->properties->brick_size);
+            }
+            else
+            {
+                this->sample_count = std::vector<size_t>(n, 0);
+                this->variance     = std::vector<float>(n, 0.0f);
+            }
         }
         if (this->minimum)
         {
             // no special action for minimum
         }
+        else if (this->compact)
+        {
+            if (sparse)
+            {
+                this->sparse_compact_weights = SparseVector<uint16_t>(this->properties->size, 0, this->properties->brick_size);
+            }
+            else
+            {
+                this->compact_weights = std::vector<uint16_t>(n, 0);
+            }
+        }
+        else if (sparse)
+        {
+            this->sparse_weights = SparseVector<float>(this->properties->size, 0.0f, this->properties->brick_size);
+        }
         else
         {
-            this->weights = std::vector<float>(this->properties->getNumVoxels(), 0.0f);
+            this->weights = std::vector<float>(n, 0.0f);
         }
     }
 
 
-    void save(HighFive::Group& g_channel, const std::string& grid_type) override final
+    /// @brief Copy constructor for `clone`.
+    /// @note  As in the other constructor, the side channels are set after the UpdateCallable is made.
+    TSDF(const TSDF& other)
+        : VoxelGrid(other),
+          average(other.average),
+          minimum(other.minimum),
+          compact(other.compact),
+          quantizer(other.quantizer),
+          variance_quantizer(other.variance_quantizer),
+          weight_quantizer(other.weight_quantizer),
+          count_quantizer(other.count_quantizer),
+          update_callable(*this)
     {
-        try
+        this->sample_count                = other.sample_count;
+        this->variance                    = other.variance;
+        this->weights                     = other.weights;
+        this->sparse_sample_count         = other.sparse_sample_count;
+        this->sparse_variance             = other.sparse_variance;
+        this->sparse_weights              = other.sparse_weights;
+        this->compact_sample_count        = other.compact_sample_count;
+        this->compact_variance            = other.compact_variance;
+        this->compact_weights             = other.compact_weights;
+        this->sparse_compact_sample_count = other.sparse_compact_sample_count;
+        this->sparse_compact_variance     = other.sparse_compact_variance;
+        this->sparse_compact_weights      = other.sparse_compact_weights;
+    }
+
+
+    /// @brief Largest distance magnitude the fixed-point data must hold.
+    /// @param dist_min Minimum update distance.
+    /// @param dist_max Maximum update distance.
+    static float getQuantizerRange(const float& dist_min, const float& dist_max)
+    {
+        return std::max(std::abs(dist_min), std::abs(dist_max));
+    }
+
+
+    /// @note  The data of a quantized Grid is saved decoded, as `float`, and its compact side
+    ///        channels as the types the full channels use. Saved files are the same either way.
+    void save(HighFive::Group& g_channel, const std::string& grid_type,
+              const utilities::DataSetOptions& options) const override final
+    {
+        if (this->compact)
         {
-            if (this->type_id == DataType::FLOAT)
-            {
-                g_channel.createDataSet(grid_type, std::get<std::vector<float>>(this->data));
-            }
-            else if (this->type_id == DataType::DOUBLE)
-            {
-                g_channel.createDataSet(grid_type, std::get<std::vector<double>>(this->data));
-            }
-            else
-            {
-                throw DataVariantError::UnrecognizedEnumeration(this->type_id);
-            }
+            std::visit([&](const auto& vector) { this->saveDecoded(g_channel, grid_type, vector, this->quantizer, options); },
+                       this->data);
         }
-        catch (const std::bad_variant_access&)
+        else
         {
-            throw std::runtime_error("Bad variant access: Cannot save Grid's Data vector to HDF5 file.");
+            VoxelGrid::save(g_channel, grid_type, options);
         }
 
-        if (this->average)
+        const bool sparse = this->properties->sparse;
+        if (this->average && this->compact)
         {
-            g_channel.createDataSet(grid_type + "_samples", this->sample_count);
-            g_channel.createDataSet(grid_type + "_variance", this->variance);
+            sparse ? this->saveCounts(g_channel, grid_type + "_samples", this->sparse_compact_sample_count, options) :
+                     this->saveCounts(g_channel, grid_type + "_samples", this->compact_sample_count, options);
+            sparse ? this->saveDecoded(g_channel, grid_type + "_variance", this->sparse_compact_variance, this->variance_quantizer, options) :
+                     this->saveDecoded(g_channel, grid_type + "_variance", this->compact_variance, this->variance_quantizer, options);
+        }
+        else if (this->average)
+        {
+            sparse ? this->createDataSet(g_channel, grid_type + "_samples", this->sparse_sample_count, options) :
+                     this->createDataSet(g_channel, grid_type + "_samples", this->sample_count, options);
+            sparse ? this->createDataSet(g_channel, grid_type + "_variance", this->sparse_variance, options) :
+                     this->createDataSet(g_channel, grid_type + "_variance", this->variance, options);
+        }
+        else if (this->minimum)
+        {
+            // no special action for minimum
+        }
+        else if (this->compact)
+        {
+            sparse ? this->saveDecoded(g_channel, grid_type + "_weights", this->sparse_compact_weights, this->weight_quantizer, options) :
+                     this->saveDecoded(g_channel, grid_type + "_weights", this->compact_weights, this->weight_quantizer, options);
+        }
+        else
+        {
+            sparse ? this->createDataSet(g_channel, grid_type + "_weights", this->sparse_weights, options) :
+                     this->createDataSet(g_channel, grid_type + "_weights", this->weights, options);
+        }
+    }
+
+
+    /// @note  Only the voxels in the box are decoded.
+    void saveBox(HighFive::Group& g_channel, const std::string& grid_type,
+                 const Index& lower, const Index& upper) const override final
+    {
+        if (this->compact)
+        {
+            std::visit([&](const auto& vector) { this->saveDecodedBox(g_channel, grid_type, vector, this->quantizer, lower, upper); },
+                       this->data);
+        }
+        else
+        {
+            VoxelGrid::saveBox(g_channel, grid_type, lower, upper);
+        }
+
+        const bool sparse = this->properties->sparse;
+        if (this->average && this->compact)
+        {
+            sparse ? this->writeBox<size_t>(g_channel, grid_type + "_samples", lower, upper, [&](const size_t& i) { return this->sparse_compact_sample_count[i]; }) :
+                     this->writeBox<size_t>(g_channel, grid_type + "_samples", lower, upper, [&](const size_t& i) { return this->compact_sample_count[i]; });
+            sparse ? this->saveDecodedBox(g_channel, grid_type + "_variance", this->sparse_compact_variance, this->variance_quantizer, lower, upper) :
+                     this->saveDecodedBox(g_channel, grid_type + "_variance", this->compact_variance, this->variance_quantizer, lower, upper);
+        }
+        else if (this->average)
+        {
+            sparse ? this->writeBox(g_channel, grid_type + "_samples", this->sparse_sample_count, lower, upper) :
+                     this->writeBox(g_channel, grid_type + "_samples", this->sample_count, lower, upper);
+            sparse ? this->writeBox(g_channel, grid_type + "_variance", this->sparse_variance, lower, upper) :
+                     this->writeBox(g_channel, grid_type + "_variance", this->variance, lower, upper);
+        }
+        else if (this->minimum)
+        {
+            // no special action for minimum
+        }
+        else if (this->compact)
+        {
+            sparse ? this->saveDecodedBox(g_channel, grid_type + "_weights", this->sparse_compact_weights, this->weight_quantizer, lower, upper) :
+                     this->saveDecodedBox(g_channel, grid_type + "_weights", this->compact_weights, this->weight_quantizer, lower, upper);
+        }
+        else
+        {
+            sparse ? this->writeBox(g_channel, grid_type + "_weights", this->sparse_weights, lower, upper) :
+                     this->writeBox(g_channel, grid_type + "_weights", this->weights, lower, upper);
+        }
+    }
+
+
+    /// @note  A quantized Grid encodes the saved values, so it may load files saved by a Grid of
+    ///        any type. Values outside its range saturate.
+    void load(const HighFive::Group& g_channel, const std::string& grid_type) override final
+    {
+        if (this->compact)
+        {
+            std::visit([&](auto& vector) { this->loadEncoded(g_channel, grid_type, vector, this->quantizer); }, this->data);
+        }
+        else
+        {
+            VoxelGrid::load(g_channel, grid_type);
+        }
+
+        const bool sparse = this->properties->sparse;
+        if (this->average && this->compact)
+        {
+            sparse ? this->loadEncoded(g_channel, grid_type + "_samples", this->sparse_compact_sample_count, this->count_quantizer) :
+                     this->loadEncoded(g_channel, grid_type + "_samples", this->compact_sample_count, this->count_quantizer);
+            sparse ? this->loadEncoded(g_channel, grid_type + "_variance", this->sparse_compact_variance, this->variance_quantizer) :
+                     this->loadEncoded(g_channel, grid_type + "_variance", this->compact_variance, this->variance_quantizer);
+        }
+        else if (this->average)
+        {
+            sparse ? this->readDataSet(g_channel, grid_type + "_samples", this->sparse_sample_count) :
+                     this->readDataSet(g_channel, grid_type + "_samples", this->sample_count);
+            sparse ? this->readDataSet(g_channel, grid_type + "_variance", this->sparse_variance) :
+                     this->readDataSet(g_channel, grid_type + "_variance", this->variance);
         }
         else if (this->minimum)
         {
             // no special action for minimum
         }
+        else if (this->compact)
+        {
+            sparse ? this->loadEncoded(g_channel, grid_type + "_weights", this->sparse_compact_weights, this->weight_quantizer) :
+                     this->loadEncoded(g_channel, grid_type + "_weights", this->compact_weights, this->weight_quantizer);
+        }
         else
         {
-            g_channel.createDataSet(grid_type + "_weights", this->weights);
+            sparse ? this->readDataSet(g_channel, grid_type + "_weights", this->sparse_weights) :
+                     this->readDataSet(g_channel, grid_type + "_weights", this->weights);
+        }
+    }
+
+
+    /// @brief Writes the decoded values of a quantized vector as a `float` data set.
+    template <typename Vector>
+    void saveDecoded(HighFive::Group& g_channel, const std::string& name, const Vector& vector,
+                     const Quantizer& quantizer, const utilities::DataSetOptions& options) const
+    {
+        this->createDataSet(g_channel, name, quantizer.decodeAll(vector, this->properties->getNumVoxels()), options);
+    }
+
+
+    /// @brief Writes the decoded values of a box of a quantized vector over a `float` data set.
+    template <typename Vector>
+    void saveDecodedBox(HighFive::Group& g_channel, const std::string& name, const Vector& vector,
+                        const Quantizer& quantizer, const Index& lower, const Index& upper) const
+    {
+        this->writeBox<float>(g_channel, name, lower, upper, [&](const size_t& i) { return quantizer.decode(vector[i]); });
+    }
+
+
+    /// @brief Writes a compact sample count vector as a `size_t` data set.
+    template <typename Vector>
+    void saveCounts(HighFive::Group& g_channel, const std::string& name, const Vector& vector,
+                    const utilities::DataSetOptions& options) const
+    {
+        std::vector<size_t> counts(this->properties->getNumVoxels());
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            counts[i] = vector[i];
         }
+        this->createDataSet(g_channel, name, counts, options);
+    }
+
+
+    /// @brief Reads a data set and encodes it into a quantized vector.
+    template <typename Vector>
+    void loadEncoded(const HighFive::Group& g_channel, const std::string& name, Vector& vector,
+                     const Quantizer& quantizer) const
+    {
+        std::vector<float> decoded;
+        this->readDataSet(g_channel, name, decoded);
+        quantizer.encodeAll(decoded, vector);
     }
 
 
     void addToXDMF(std::ofstream& file,          const std::string& hdf5_fname,
                    const std::string& grid_name, const std::string& grid_type) const override final
     {
+        const DataType saved_type_id = this->compact ? DataType::FLOAT : this->type_id;
         utilities::XDMF::writeVoxelGridAttribute(
             file,
             grid_name,
             utilities::XDMF::makeDataPath(hdf5_fname, FS_HDF5_RECONSTRUCTION_GROUP, grid_name, grid_type),
-            getNumberTypeXDMF(this->type_id),
-            getNumberPrecisionXDMF(this->type_id),
+            getNumberTypeXDMF(saved_type_id),
+            getNumberPrecisionXDMF(saved_type_id),
             this->properties->getNumVoxels()
         );
 
@@ -275,31 +703,45 @@ private:
         // ************************************************************************************* //
 
 
-        void operator()(std::vector<float>& vector)
-        {
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->first_above(this->caller.dist_max, iter);
+        void operator()(std::vector<float>&    vector) { this->updateVector(vector); }
+        void operator()(std::vector<double>&   vector) { this->updateVector(vector); }
+        void operator()(std::vector<int8_t>&   vector) { this->updateVector(vector); }
+        void operator()(std::vector<int16_t>&  vector) { this->updateVector(vector); }
 
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
-            {
-                this->update_callback(vector[iter->i], iter->d, iter->i);
-            }
-        }
+        void operator()(SparseVector<float>&   vector) { this->updateVector(vector); }
+        void operator()(SparseVector<double>&  vector) { this->updateVector(vector); }
+        void operator()(SparseVector<int8_t>&  vector) { this->updateVector(vector); }
+        void operator()(SparseVector<int16_t>& vector) { this->updateVector(vector); }
+        void operator()(MappedVector<float>&   vector) { this->updateVector(vector); }
+        void operator()(MappedVector<double>&  vector) { this->updateVector(vector); }
+        void operator()(MappedVector<int8_t>&  vector) { this->updateVector(vector); }
+        void operator()(MappedVector<int16_t>& vector) { this->updateVector(vector); }
 
 
-        void operator()(std::vector<double>& vector)
+        /// @brief Updates the distance of each voxel on every ray with the selected update callback.
+        /// @param vector Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+        /// @note  A ray's weight, see `TraceBatch::Ray::weight`, is taken as that many samples of the
+        ///        same distance in one update.
+        template <typename Vector>
+        void updateVector(Vector& vector)
         {
-            Trace::const_iterator       iter = this->ray_trace->first_above(this->caller.dist_min);
-            const Trace::const_iterator last = this->ray_trace->first_above(this->caller.dist_max, iter);
+            using T = typename Vector::value_type;
 
-            // **************************** APPLY VOXEL UPDATE HERE **************************** //
-            for ( ; iter != last; ++iter)
+            const Quantizer& quantizer = this->caller.quantizer;
+            this->forEachRay([&](const auto& ray_trace)
             {
-                float average = static_cast<float>(vector[iter->i]);
-                this->update_callback(average, iter->d, iter->i);
-                vector[iter->i] = static_cast<double>(average);
-            }
+                auto iter = ray_trace.first_above(this->caller.dist_min);
+                const auto last = ray_trace.first_above(this->caller.dist_max, iter);
+                const uint32_t n_samples = ray_trace.weight();
+
+                // ************************** APPLY VOXEL UPDATE HERE ************************** //
+                for ( ; iter != last; ++iter)
+                {
+                    float average = static_cast<float>(quantizer.decode(vector[iter->i]));
+                    (this->*update_callback)(average, iter->d, iter->i, n_samples);
+                    vector[iter->i] = quantizer.encode<T>(average);
+                }
+            });
         }
 
 
@@ -325,18 +767,35 @@ private:
                     throw GridPropertyError::DataVectorDoesNotMatch(this->caller.properties->size, this->caller.variance.size());
                 }
                 
-                this->update_callback = std::bind(&UpdateCallable::update_average, this,
-                                                  std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+                const bool sparse = this->caller.properties->sparse;
+                if (this->caller.compact)
+                {
+                    this->update_callback = sparse ? &UpdateCallable::update_average_compact<true> :
+                                                     &UpdateCallable::update_average_compact<false>;
+                }
+                else
+                {
+                    this->update_callback = sparse ? &UpdateCallable::update_average<true> :
+                                                     &UpdateCallable::update_average<false>;
+                }
             }
             else if (this->caller.minimum)
             {
-                this->update_callback = std::bind(&UpdateCallable::update_min_magnitude, this,
-                                                  std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+                this->update_callback = &UpdateCallable::update_min_magnitude;
             }
             else
             {
-                this->update_callback = std::bind(&UpdateCallable::update_weighted, this,
-                                                  std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+                const bool sparse = this->caller.properties->sparse;
+                if (this->caller.compact)
+                {
+                    this->update_callback = sparse ? &UpdateCallable::update_weighted_compact<true> :
+                                                     &UpdateCallable::update_weighted_compact<false>;
+                }
+                else
+                {
+                    this->update_callback = sparse ? &UpdateCallable::update_weighted<true> :
+                                                     &UpdateCallable::update_weighted<false>;
+                }
             }
         }
 
@@ -345,7 +804,9 @@ private:
         /// @param [out] original Current voxel distance value. Updated in place.
         /// @param update Newly measured TSDF distance.
         /// @param i Unused. Vector index for the voxel. See `Grid::Properties::at`.
-        void update_min_magnitude(float& original, const float& update, [[maybe_unused]] const size_t& i)
+        /// @param n_samples Unused. Repeated samples do not change the minimum.
+        void update_min_magnitude(float& original, const float& update, [[maybe_unused]] const size_t& i,
+                                  [[maybe_unused]] const uint32_t& n_samples)
         {
             original = utilities::math::smallest_magnitude(original, update);
         }
@@ -355,18 +816,59 @@ private:
         /// @param [out] average Current average value. Updated in place.
         /// @param update Newly measured TSDF distance.
         /// @param i Vector index for the voxel. See `Grid::Properties::at`.
+        /// @param n_samples Number of samples of the `update` distance to add.
+        /// @tparam Sparse If true, uses the sparse sample count and variance channels.
         /// @details Uses a (modified) version of Welford's algorithm for online updates of the average and variance. See:
         ///          https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Welford's_online_algorithm
-        void update_average(float& average, const float& update, const size_t& i)
+        template <bool Sparse>
+        void update_average(float& average, const float& update, const size_t& i, const uint32_t& n_samples)
+        {
+            float&  var = Sparse ? this->caller.sparse_variance[i]     : this->caller.variance[i];
+            size_t& n   = Sparse ? this->caller.sparse_sample_count[i] : this->caller.sample_count[i];
+
+            welford(average, var, n, update, n_samples);
+        }
+
+
+        /// @brief Performs TSDF voxel value update for average distance, with the compact sample
+        ///        count and variance channels.
+        /// @param [out] average Current average value. Updated in place.
+        /// @param update Newly measured TSDF distance.
+        /// @param i Vector index for the voxel. See `Grid::Properties::at`.
+        /// @param n_samples Number of samples of the `update` distance to add.
+        /// @tparam Sparse If true, uses the sparse compact sample count and variance channels.
+        /// @note  Once the sample count saturates each update has the same weight, so the average
+        ///        becomes a moving average over about as many samples as the count holds.
+        template <bool Sparse>
+        void update_average_compact(float& average, const float& update, const size_t& i, const uint32_t& n_samples)
         {
-            float&  var = this->caller.variance[i];
-            size_t& n   = this->caller.sample_count[i];
+            uint16_t& stored_var = Sparse ? this->caller.sparse_compact_variance[i]     : this->caller.compact_variance[i];
+            uint16_t& stored_n   = Sparse ? this->caller.sparse_compact_sample_count[i] : this->caller.compact_sample_count[i];
+
+            float  var = this->caller.variance_quantizer.decode(stored_var);
+            size_t n   = std::min(static_cast<size_t>(stored_n), static_cast<size_t>(UINT16_MAX - 1));
+            welford(average, var, n, update, n_samples);
+
+            stored_var = this->caller.variance_quantizer.encode<uint16_t>(var);
+            stored_n   = static_cast<uint16_t>(std::min(n, static_cast<size_t>(UINT16_MAX)));
+        }
 
+
+        /// @brief Adds samples of one value to a running average and variance.
+        /// @param [out] average Current average. Updated in place.
+        /// @param [out] var Current variance. Updated in place.
+        /// @param [out] n Number of samples in the average. Increased by `n_samples`.
+        /// @param update New sample.
+        /// @param n_samples Number of times `update` was sampled.
+        /// @note  This gives the same average and variance as adding each of the samples in turn.
+        static void welford(float& average, float& var, size_t& n, const float& update, const uint32_t& n_samples)
+        {
             float delta = update - average;
 
             var     *= n;
-            average += delta / ++n;
-            var     += (update - average) * delta; // Average is updated now.
+            n       += n_samples;
+            average += delta * n_samples / n;
+            var     += (update - average) * delta * n_samples; // Average is updated now.
             var     /= n;
         }
 
@@ -375,10 +877,45 @@ private:
         /// @param [out] current Current value of the TSDF.
         /// @param update Newly measured TSDF distance.
         /// @param i Vector index for the voxel. See `Grid::Properties::at`.
-        void update_weighted(float& current, const float& update, const size_t& i)
+        /// @param n_samples Number of samples of the `update` distance to add.
+        /// @tparam Sparse If true, uses the sparse weights channel.
+        template <bool Sparse>
+        void update_weighted(float& current, const float& update, const size_t& i, const uint32_t& n_samples)
+        {
+            float& w = Sparse ? this->caller.sparse_weights[i] : this->caller.weights[i];
+            this->weighted(current, w, update, n_samples);
+        }
+
+
+        /// @brief Performs TSDF voxel value update with a weighted method on negative values, with
+        ///        the compact weights channel.
+        /// @param [out] current Current value of the TSDF.
+        /// @param update Newly measured TSDF distance.
+        /// @param i Vector index for the voxel. See `Grid::Properties::at`.
+        /// @param n_samples Number of samples of the `update` distance to add.
+        /// @tparam Sparse If true, uses the sparse compact weights channel.
+        /// @note  Weights saturate at `compact_max_weight`, after which the value is a moving
+        ///        average, as in KinectFusion.
+        template <bool Sparse>
+        void update_weighted_compact(float& current, const float& update, const size_t& i, const uint32_t& n_samples)
+        {
+            uint16_t& stored_w = Sparse ? this->caller.sparse_compact_weights[i] : this->caller.compact_weights[i];
+
+            float w = this->caller.weight_quantizer.decode(stored_w);
+            this->weighted(current, w, update, n_samples);
+            stored_w = this->caller.weight_quantizer.encode<uint16_t>(w);
+        }
+
+
+        /// @brief Adds a sample to a weighted average.
+        /// @param [out] current Current value of the TSDF. Updated in place.
+        /// @param [out] w Current weight. Updated in place.
+        /// @param update Newly measured TSDF distance.
+        /// @param n_samples Number of samples of the `update` distance to add. Their weights add.
+        void weighted(float& current, float& w, const float& update, const uint32_t& n_samples) const
         {
-            float&  w = this->caller.weights[i];
             float w_update = update > 0 ? 1 : utilities::math::lerp(1.0f, 0.0f, update / this->caller.dist_min);
+            w_update *= n_samples;
 
             current *= w;
             current += update * w_update;
@@ -395,8 +932,10 @@ private:
         /// @brief Reference to the specific derived class calling this object.
         TSDF& caller;
 
-        /// @brief Callback for the update method: `update_average` or `update_min_magnitude`.
-        std::function<void(float&, const float&, const size_t&)> update_callback;
+        /// @brief Callback for the update method: `update_average`, `update_min_magnitude`, or `update_weighted`.
+        /// @note  This is a member function pointer, rather than a bound `std::function`, so that copies
+        ///        of the UpdateCallable made by `VoxelGrid::visitUpdate` call their own methods.
+        void (UpdateCallable::*update_callback)(float&, const float&, const size_t&, const uint32_t&) = nullptr;
     };
 
 
@@ -406,6 +945,17 @@ private:
     /// @brief If true, uses the minimum magnitude TSDF update algorithm rather than a weighted update.
     const bool minimum;
 
+    /// @brief If true, the data is quantized and the compact side channels are used: `uint16_t`
+    ///        weights, sample counts and variance. True for the integer data types.
+    const bool compact;
+
+    /// @brief Fixed-point encoding of the data over the update distance range. Stores floating
+    ///        point data unchanged.
+    const Quantizer quantizer;
+
+    /// @brief Fixed-point encodings of the compact variance, weights and sample counts.
+    const Quantizer variance_quantizer, weight_quantizer, count_quantizer;
+
     /// @brief Stores the update count data that the grid uses.
     std::vector<size_t> sample_count;
 
@@ -415,6 +965,20 @@ private:
     /// @brief Stores the weighted update value for a voxel.
     std::vector<float> weights;
 
+    /// @brief Sparse equivalents of `sample_count`, `variance` and `weights`. These are used instead
+    ///        when the Grid Properties request sparse storage.
+    SparseVector<size_t> sparse_sample_count;
+    SparseVector<float>  sparse_variance, sparse_weights;
+
+    /// @brief Compact equivalents of `sample_count`, `variance` and `weights`, and their sparse
+    ///        equivalents. These are used instead for quantized data. See `compact`.
+    std::vector<uint16_t>  compact_sample_count, compact_variance, compact_weights;
+    SparseVector<uint16_t> sparse_compact_sample_count, sparse_compact_variance, sparse_compact_weights;
+
+    /// @brief Largest weight the compact weights channel holds, in steps of about `1 / 257`. Small
+    ///        steps matter as updates near `dist_min` add little weight.
+    static constexpr float compact_max_weight = 255.0f;
+
     /// @brief Subclass callable that std::visit uses to perform updates with typed information.
     /// @note  Initialization order matters. This musts be declared last so the other class members that
     ///        this uses are guaranteed to be initialized.
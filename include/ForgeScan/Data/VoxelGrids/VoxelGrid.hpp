@@ -1,21 +1,28 @@
 #ifndef DEMOS_CPP_FORGE_SCAN_RECONSTRUCTION_VOXEL_GRID_HPP
 #define DEMOS_CPP_FORGE_SCAN_RECONSTRUCTION_VOXEL_GRID_HPP
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #define H5_USE_EIGEN 1
 #include <highfive/H5File.hpp>
 
+#include "ForgeScan/Common/Bitset.hpp"
 #include "ForgeScan/Common/Definitions.hpp"
 #include "ForgeScan/Common/Exceptions.hpp"
 #include "ForgeScan/Common/Grid.hpp"
+#include "ForgeScan/Common/TraceBatch.hpp"
 #include "ForgeScan/Common/VoxelData.hpp"
 #include "ForgeScan/Common/Types.hpp"
 #include "ForgeScan/Utilities/ArgParser.hpp"
 #include "ForgeScan/Utilities/Files.hpp"
+#include "ForgeScan/Utilities/HDF5.hpp"
 #include "ForgeScan/Utilities/MemoryUse.hpp"
 #include "ForgeScan/Utilities/XDMF.hpp"
 
@@ -24,7 +31,9 @@ namespace forge_scan {
 namespace data {
 
     // Forward definition to allow friend access.
+    class Checkpoint;
     class Reconstruction;
+    class Snapshot;
 
 } // namespace data
 } // namespace forge_scan
@@ -45,6 +54,12 @@ class VoxelGrid : public Grid
     /// @details Required to call the save method.
     friend class Reconstruction;
 
+    /// @details Required to save a copy of the VoxelGrid. See `Reconstruction::getSnapshot`.
+    friend class Snapshot;
+
+    /// @details Required to keep a copy of the VoxelGrid up to date and save its changed chunks.
+    friend class Checkpoint;
+
 
 public:
     // ***************************************************************************************** //
@@ -63,8 +78,8 @@ public:
 
 
     /// @brief Provides the VoxelGrid with a view of the `data::Reconstruction`'s data_seen record.
-    /// @param data_seen Vector of booleans the same length as `VoxelGrid::data`.
-    void addSeenData(const std::shared_ptr<std::vector<bool>>& data_seen)
+    /// @param data_seen Bitset the same length as `VoxelGrid::data`.
+    void addSeenData(const std::shared_ptr<const Bitset>& data_seen)
     {
         this->data_seen = data_seen;
     }
@@ -96,6 +111,40 @@ public:
     }
 
 
+    /// @brief Calculates how much space the VoxelGrid is using. Unlike `getDataMemoryUsage` this
+    ///        includes the vectors a derived VoxelGrid keeps beside the data vector, such as the
+    ///        weights of a `TSDF`.
+    /// @return Memory used by the VoxelGrid. The seen data is owned by the `data::Reconstruction`
+    ///         and is not included.
+    virtual utilities::memory_use::Usage getMemoryUsage() const
+    {
+        utilities::memory_use::Usage usage;
+        this->getDataMemoryUsage(usage.size_bytes, usage.capacity_bytes);
+        return usage;
+    }
+
+
+    /// @brief Estimates the memory a new vector with one element per voxel allocates when it is
+    ///        constructed. Derived VoxelGrids use this to estimate their memory before they are
+    ///        created, see `Constructor::estimateMemoryUsage`.
+    /// @param properties Grid Properties the vector is sized by.
+    /// @param value_size Size of each element, in bytes.
+    /// @param may_map    True if the vector is stored like the data vector, in a `MappedVector` when
+    ///                   the Grid Properties request memory-mapped storage. False if it is always
+    ///                   on the heap unless it is sparse.
+    /// @return Number of bytes allocated. This is zero for a `SparseVector`, which allocates its blocks
+    ///         as voxels are updated, and for a `MappedVector`, which the system pages to its file.
+    static size_t estimateVectorMemory(const Grid::Properties& properties, const size_t& value_size,
+                                       const bool& may_map = true)
+    {
+        if (properties.sparse || (may_map && properties.isMapped()))
+        {
+            return 0;
+        }
+        return properties.getNumVoxels() * value_size;
+    }
+
+
     /// @brief Gets a constant reference to the VectorVariant data the VoxelGrid stores.
     /// @return Read-only reference to the data.
     const VectorVariant& getData() const
@@ -110,6 +159,50 @@ public:
     }
 
 
+    /// @brief Gets the distance along a ray past which an update leaves a saturated voxel unchanged.
+    ///        See `isSaturated`. The saturation-aware update of `data::Reconstruction` uses this to
+    ///        leave such voxels out of the traces.
+    /// @return By default `dist_max`, as a VoxelGrid does not update voxels past it. A VoxelGrid
+    ///         which updates every voxel on the trace must return infinity.
+    virtual float getSkipDistance() const
+    {
+        return this->dist_max;
+    }
+
+
+    /// @brief Returns true if the voxel is saturated, so updating it from a point on a ray further
+    ///        than `getSkipDistance` leaves it unchanged.
+    /// @param i Vector index of the voxel.
+    /// @note  By default every voxel is, as nothing past `dist_max` is updated.
+    virtual bool isSaturated(const size_t& i) const
+    {
+        (void)i;
+        return true;
+    }
+
+
+    /// @brief Gets how many voxels past the traces of an update the VoxelGrid may change between
+    ///        updates, such as the occplane labels of `Binary`. `Checkpoint::copy` looks that far into
+    ///        the chunks next to each changed one.
+    /// @return By default zero, as only the traced voxels change.
+    virtual size_t getChangeRadius() const
+    {
+        return 0;
+    }
+
+
+    /// @brief Returns true if the VoxelGrid may be updated by the projective update of
+    ///        `data::Reconstruction`. That update gives each voxel near the surface one sample from
+    ///        its pixel of the depth image, with the rays of a TraceBatch grouping voxels by block
+    ///        rather than by pixel.
+    /// @note  Only a VoxelGrid which updates each voxel from its own distance, without the sensed
+    ///        point or the order of voxels along a ray, gives a sensible result from this.
+    virtual bool hasProjectiveUpdate() const
+    {
+        return false;
+    }
+
+
     // ***************************************************************************************** //
     // *                             PUBLIC PURE VIRTUAL METHODS                               * //
     // ***************************************************************************************** //
@@ -117,8 +210,24 @@ public:
 
     /// @brief Updates the VoxelGrid with new information along a ray.
     /// @param ray_trace A trace to update the VoxelGrid along.
+    /// @note  Implementations must be safe to call concurrently with Traces that contain disjoint
+    ///        voxels. The parallel update of `data::Reconstruction` relies on this.
     virtual void update(const std::shared_ptr<const Trace>& ray_trace) = 0;
 
+    /// @brief Updates the VoxelGrid with new information along each ray in a batch.
+    /// @param trace_batch A batch of traces to update the VoxelGrid along.
+    /// @note  This must give the same result as calling the single-trace `update` for each ray
+    ///        of the batch, in order. Derived classes visit their data once for the whole batch.
+    /// @note  Implementations must be safe to call concurrently with batches that contain
+    ///        disjoint voxels.
+    virtual void update(const std::shared_ptr<const TraceBatch>& trace_batch) = 0;
+
+    /// @brief Copies the VoxelGrid, with all its data, for a `data::Snapshot`.
+    /// @return Shared pointer to the copy. It shares nothing with this VoxelGrid but its Grid
+    ///         Properties and its view of the seen data, which the Snapshot replaces.
+    /// @note  The VoxelGrid must not be updated while it is copied.
+    virtual std::shared_ptr<VoxelGrid> clone() const = 0;
+
 
 
     // ***************************************************************************************** //
@@ -160,23 +269,65 @@ protected:
     ///           `using VoxelGrid::UpdateCallable::operator();`
     struct UpdateCallable
     {
-        /// @brief Acquires temporary, shared ownership of a trace.
+        /// @brief Points the callable at a trace. The trace is not owned, so it must outlive the
+        ///        update. See `visitUpdate`.
         /// @param ray_trace Trace to perform an update from.
         void acquireRayTrace(const std::shared_ptr<const Trace>& ray_trace)
         {
-            this->ray_trace = ray_trace;
+            this->ray_trace = ray_trace.get();
         }
 
 
-        /// @brief Releases the VoxelGrid's reference to the trace.
+        /// @brief Points the callable at a batch of traces. The batch is not owned, so it must
+        ///        outlive the update. See `visitUpdate`.
+        /// @param trace_batch Batch of traces to perform an update from.
+        void acquireTraceBatch(const std::shared_ptr<const TraceBatch>& trace_batch)
+        {
+            this->trace_batch = trace_batch.get();
+        }
+
+
+        /// @brief Clears the callable's pointers to the trace and batch of traces.
         void releaseRayTrace()
         {
-            this->ray_trace.reset();
+            this->ray_trace   = nullptr;
+            this->trace_batch = nullptr;
+        }
+
+
+        /// @brief Calls the update function for every ray the callable holds. This is each ray of
+        ///        the acquired batch, in order, or else the single acquired trace.
+        /// @param update_ray Generic callable taking either a `const Trace&` or a
+        ///                   `const TraceBatch::Ray&`, both of which provide `begin`, `end`,
+        ///                   `first_above`, `hasSensed`, `sensedPoint` and `weight`.
+        /// @note  A ray which stands in for several merged rays, see `TraceBatch::Ray::weight`, is
+        ///        updated along once. VoxelGrids which accumulate samples take its weight as that
+        ///        many samples in one step, so they take as many as they would have from the
+        ///        separate rays.
+        template <typename UpdateRay>
+        void forEachRay(UpdateRay&& update_ray) const
+        {
+            if (this->trace_batch)
+            {
+                const size_t n_rays = this->trace_batch->numRays();
+                for (size_t r = 0; r < n_rays; ++r)
+                {
+                    update_ray(this->trace_batch->ray(r));
+                }
+            }
+            else if (this->ray_trace)
+            {
+                update_ray(*this->ray_trace);
+            }
         }
 
 
-        /// @brief Parameter for the voxel update functions.
-        std::shared_ptr<const Trace> ray_trace{nullptr};
+        /// @brief Parameter for the voxel update functions. Not owned, so copying the callable for
+        ///        each update does not touch the trace's reference count.
+        const Trace* ray_trace = nullptr;
+
+        /// @brief Parameter for the voxel update functions, used instead of `ray_trace` when set.
+        const TraceBatch* trace_batch = nullptr;
 
         /// @brief A the error message if a type is not supported.
         static const std::string type_not_supported_message;
@@ -185,20 +336,13 @@ protected:
         // ************************************************************************************* //
         // *                               UNSUPPORTED DATATYPES                               * //
         // * These should be unreachable; the VoxelGrid constructor should ensure no invalid   * //
-        // * vectors are used in this derived class. But for safety these are still defined to * //
-        // * throw a DataVariantError error if they are ever reached.                                   * //
+        // * vectors are used in this derived class. But for safety this is still defined to  * //
+        // * throw a DataVariantError error if it is ever reached. A derived UpdateCallable's  * //
+        // * overloads for the vectors it supports are exact matches, so are chosen over this. * //
         // ************************************************************************************* //
 
-        void operator()(std::vector<int8_t>&)   { throw DataVariantError(this->type_not_supported_message); }
-        void operator()(std::vector<int16_t>&)  { throw DataVariantError(this->type_not_supported_message); }
-        void operator()(std::vector<int32_t>&)  { throw DataVariantError(this->type_not_supported_message); }
-        void operator()(std::vector<int64_t>&)  { throw DataVariantError(this->type_not_supported_message); }
-        void operator()(std::vector<uint8_t>&)  { throw DataVariantError(this->type_not_supported_message); }
-        void operator()(std::vector<uint16_t>&) { throw DataVariantError(this->type_not_supported_message); }
-        void operator()(std::vector<uint32_t>&) { throw DataVariantError(this->type_not_supported_message); }
-        void operator()(std::vector<size_t>&)   { throw DataVariantError(this->type_not_supported_message); }
-        void operator()(std::vector<float>&)    { throw DataVariantError(this->type_not_supported_message); }
-        void operator()(std::vector<double>&)   { throw DataVariantError(this->type_not_supported_message); }
+        template <typename Vector>
+        void operator()(Vector&) { throw DataVariantError(this->type_not_supported_message); }
     };
 
 
@@ -228,48 +372,46 @@ protected:
           dist_max(std::max(dist_min, dist_max)),
           default_value(this->setDefaultValue(default_value))
     {
-        const size_t n = this->properties->getNumVoxels();
-
         // Factory for the correct type_id of vector into the variant.
         if (this->type_id == DataType::INT8_T)
         {
-            this->data = std::vector<int8_t>(n, std::get<int8_t>(this->default_value));
+            this->initData<int8_t>();
         }
         else if (this->type_id == DataType::INT16_T)
         {
-            this->data = std::vector<int16_t>(n, std::get<int16_t>(this->default_value));
+            this->initData<int16_t>();
         }
         else if (this->type_id == DataType::INT32_T)
         {
-            this->data = std::vector<int32_t>(n, std::get<int32_t>(this->default_value));
+            this->initData<int32_t>();
         }
         else if (this->type_id == DataType::INT64_T)
         {
-            this->data = std::vector<int64_t>(n, std::get<int64_t>(this->default_value));
+            this->initData<int64_t>();
         }
         else if (this->type_id == DataType::UINT8_T)
         {
-            this->data = std::vector<uint8_t>(n, std::get<uint8_t>(this->default_value));
+            this->initData<uint8_t>();
         }
         else if (this->type_id == DataType::UINT16_T)
         {
-            this->data = std::vector<uint16_t>(n, std::get<uint16_t>(this->default_value));
+            this->initData<uint16_t>();
         }
         else if (this->type_id == DataType::UINT32_T)
         {
-            this->data = std::vector<uint32_t>(n, std::get<uint32_t>(this->default_value));
+            this->initData<uint32_t>();
         }
         else if (this->type_id == DataType::SIZE_T)
         {
-            this->data = std::vector<size_t>(n, std::get<size_t>(this->default_value));
+            this->initData<size_t>();
         }
         else if (this->type_id == DataType::FLOAT)
         {
-            this->data = std::vector<float>(n, std::get<float>(this->default_value));
+            this->initData<float>();
         }
         else if (this->type_id == DataType::DOUBLE)
         {
-            this->data = std::vector<double>(n, std::get<double>(this->default_value));
+            this->initData<double>();
         }
         else
         {
@@ -278,66 +420,438 @@ protected:
     }
 
 
+    /// @brief Adds the memory used by a vector to a total. Used by derived VoxelGrids to include
+    ///        their other vectors in `getMemoryUsage`.
+    /// @param vector Either a `std::vector`, a `SparseVector` or a `MappedVector`.
+    /// @param [out] usage Total to add to.
+    template <typename Vector>
+    static void addMemoryUsage(const Vector& vector, utilities::memory_use::Usage& usage)
+    {
+        usage.size_bytes     += utilities::memory_use::vector_size(vector);
+        usage.capacity_bytes += utilities::memory_use::vector_capacity(vector);
+    }
+
+
+    /// @brief Initializes the data vector with every voxel set to the default value. This is a
+    ///        `SparseVector` if the Grid Properties request sparse storage, a `MappedVector` if they
+    ///        request memory-mapped storage, and a `std::vector` otherwise.
+    /// @tparam T Data type of the vector. Must match the type of `default_value`.
+    template <typename T>
+    void initData()
+    {
+        if (this->properties->sparse)
+        {
+            this->data = SparseVector<T>(this->properties->size, std::get<T>(this->default_value),
+                                         this->properties->brick_size);
+        }
+        else if (this->properties->isMapped())
+        {
+            this->data = MappedVector<T>(this->properties->getNumVoxels(), std::get<T>(this->default_value),
+                                         this->properties->mmap_dir);
+        }
+        else
+        {
+            this->data = std::vector<T>(this->properties->getNumVoxels(), std::get<T>(this->default_value));
+        }
+    }
+
+
+    /// @brief Performs an update on the data vector with a copy of the provided UpdateCallable.
+    /// @param update_callable Derived class's UpdateCallable to copy and visit the data with.
+    /// @param ray_trace Trace to perform an update from.
+    /// @note  Using a local copy, rather than acquiring the trace in a shared member callable,
+    ///        allows separate threads to update the same VoxelGrid along disjoint Traces.
+    template <typename Callable>
+    void visitUpdate(const Callable& update_callable, const std::shared_ptr<const Trace>& ray_trace)
+    {
+        Callable local_callable(update_callable);
+        local_callable.acquireRayTrace(ray_trace);
+        std::visit(local_callable, this->data);
+    }
+
+
+    /// @brief Performs an update on the data vector with a copy of the provided UpdateCallable.
+    /// @param update_callable Derived class's UpdateCallable to copy and visit the data with.
+    /// @param trace_batch Batch of traces to perform an update from.
+    /// @note  The data is visited once and the callable then loops over every ray in the batch.
+    template <typename Callable>
+    void visitUpdate(const Callable& update_callable, const std::shared_ptr<const TraceBatch>& trace_batch)
+    {
+        Callable local_callable(update_callable);
+        local_callable.acquireTraceBatch(trace_batch);
+        std::visit(local_callable, this->data);
+    }
+
+
+    /// @brief Moves the VoxelGrid's data some number of voxels towards the lower bound of one axis,
+    ///        in place. Voxels moved in from beyond the upper bound take the default value.
+    /// @param axis  Axis to move along. 0, 1 or 2 for X, Y or Z.
+    /// @param steps Number of voxels to move by. A negative value moves towards the upper bound.
+    /// @note  This is virtual so VoxelGrid with multiple data channels may move each of them.
+    ///        See `Reconstruction::shiftWindow`.
+    virtual void shift(const size_t& axis, const int& steps)
+    {
+        std::visit([&](auto& vector)
+        {
+            using T = typename std::decay_t<decltype(vector)>::value_type;
+            VoxelGrid::shiftVector(vector, *this->properties, axis, steps, std::get<T>(this->default_value));
+        }, this->data);
+    }
+
+
+    /// @brief Moves a data vector some number of voxels towards the lower bound of one axis, in
+    ///        place. See `Grid::Properties::forEachShifted`.
+    /// @param vector Data vector, either a `std::vector`, a `SparseVector` or a `MappedVector`.
+    /// @param properties Grid Properties the vector is laid out for.
+    /// @param axis  Axis to move along.
+    /// @param steps Number of voxels to move by.
+    /// @param fill  Value for the voxels moved in from beyond the Grid.
+    /// @note  Voxels are only written if their value changes, so a `SparseVector` only allocates
+    ///        blocks for the data moved into them.
+    template <typename Vector, typename T>
+    static void shiftVector(Vector& vector, const Grid::Properties& properties,
+                            const size_t& axis, const int& steps, const T& fill)
+    {
+        const Vector& read = vector;
+        properties.forEachShifted(axis, steps,
+            [&](const size_t& to, const size_t& from)
+            {
+                const T value = read[from];
+                if (!(read[to] == value))
+                {
+                    vector[to] = value;
+                }
+            },
+            [&](const size_t& to)
+            {
+                if (!(read[to] == fill))
+                {
+                    vector[to] = fill;
+                }
+            });
+    }
+
+
+    /// @brief Copies each voxel in a box of another VoxelGrid which differs from this one's.
+    /// @param source VoxelGrid to copy from. It must be of the same derived type as this one, with
+    ///               its data stored the same way, such as the VoxelGrid this one was cloned from.
+    /// @param lower Lowest voxel of the box.
+    /// @param upper One past the highest voxel of the box, along each axis.
+    /// @return True if any voxel differed.
+    /// @note  This is virtual so VoxelGrid with multiple data channels may copy each of them. See
+    ///        `Checkpoint::copy`.
+    virtual bool copyBox(const VoxelGrid& source, const Index& lower, const Index& upper)
+    {
+        return std::visit([&](auto& vector)
+        {
+            using Vector = std::decay_t<decltype(vector)>;
+            return VoxelGrid::copyBoxVector(vector, std::get<Vector>(source.data), *this->properties, lower, upper);
+        }, this->data);
+    }
+
+
+    /// @brief Copies each element in a box of a data vector which differs from another of the same Grid.
+    /// @param vector Data vector to copy into.
+    /// @param source Data vector to copy from.
+    /// @param properties Grid Properties both vectors are laid out for.
+    /// @param lower Lowest voxel of the box.
+    /// @param upper One past the highest voxel of the box, along each axis.
+    /// @return True if any element differed.
+    /// @note  As in `shiftVector`, only changed voxels are written so a `SparseVector` only
+    ///        allocates the blocks which its source has written.
+    template <typename Vector>
+    static bool copyBoxVector(Vector& vector, const Vector& source, const Grid::Properties& properties,
+                              const Index& lower, const Index& upper)
+    {
+        const Vector& read = vector;
+        bool changed = false;
+        properties.forEachInBox(lower, upper, [&](const size_t& i)
+        {
+            if (!(read[i] == source[i]))
+            {
+                vector[i] = source[i];
+                changed = true;
+            }
+        });
+        return changed;
+    }
+
+
+    /// @brief Writes a box of voxels of the VoxelGrid into the data sets `save` created before.
+    /// @param g_channel Group `save` wrote the VoxelGrid to.
+    /// @param grid_type Name of the derived class.
+    /// @param lower Lowest voxel of the box.
+    /// @param upper One past the highest voxel of the box, along each axis.
+    /// @note This is virtual so VoxelGrid which save converted or multiple data channels may write
+    ///       only the voxels in the box. But most derived VoxelGrids may uses this method.
+    virtual void saveBox(HighFive::Group& g_channel, const std::string& grid_type,
+                         const Index& lower, const Index& upper) const
+    {
+        std::visit([&](const auto& vector) { this->writeBox(g_channel, grid_type, vector, lower, upper); },
+                   this->data);
+    }
+
+
+    /// @brief Writes a box of a data vector over the existing data set as one hyperslab selection.
+    /// @param g_channel Group in for the opened HDF5 file.
+    /// @param name Name of the data set.
+    /// @param vector Data to write.
+    /// @param lower Lowest voxel of the box.
+    /// @param upper One past the highest voxel of the box, along each axis.
+    template <typename Vector>
+    void writeBox(HighFive::Group& g_channel, const std::string& name, const Vector& vector,
+                  const Index& lower, const Index& upper) const
+    {
+        this->writeBox<typename Vector::value_type>(g_channel, name, lower, upper,
+                                                    [&](const size_t& i) { return vector[i]; });
+    }
+
+
+    /// @brief Writes a box of values over the existing data set as one hyperslab selection.
+    /// @tparam T Type of the data set.
+    /// @param g_channel Group in for the opened HDF5 file.
+    /// @param name Name of the data set.
+    /// @param lower Lowest voxel of the box.
+    /// @param upper One past the highest voxel of the box, along each axis.
+    /// @param value Function returning the value to save for a vector index. It is only called for
+    ///              voxels in the box, so derived VoxelGrids may decode or convert as they write.
+    template <typename T, typename Function>
+    void writeBox(HighFive::Group& g_channel, const std::string& name,
+                  const Index& lower, const Index& upper, const Function& value) const
+    {
+        if (!(lower.array() < upper.array()).all())
+        {
+            return;
+        }
+        std::vector<T> box;
+        box.reserve((upper - lower).prod());
+        this->properties->forEachInBox(lower, upper, [&](const size_t& i) { box.push_back(static_cast<T>(value(i))); });
+        g_channel.getDataSet(name).select(utilities::boxHyperSlab(this->properties->size, lower, upper))
+                                  .write_raw(box.data());
+    }
+
+
     /// @brief Writes the VoxelGrid's data vector to the provided HDF5 group.
     /// @param g_channel Group in for the opened HDF5 file.
     /// @param grid_type Name of the derived class.
-    /// @throws std::runtime_error If there is a bad variant access.
-    /// @throws DataVariantError If the VoxelGrid's `type_id` is not recognized.
-    ///         (However, this error should be caught earlier in the VoxelGrid constructor.)
+    /// @param options Chunking and compression for the data sets.
     /// @note This is virtual so VoxelGrid with multiple data channels may specifically handle
     ///       their channels. But most derived VoxelGrids may uses this method.
-    virtual void save(HighFive::Group& g_channel, const std::string& grid_type)
+    virtual void save(HighFive::Group& g_channel, const std::string& grid_type,
+              const utilities::DataSetOptions& options) const
     {
-        try
+        auto save_data = [this, &g_channel, &grid_type, &options](const auto& vector)
         {
-            if (this->type_id == DataType::INT8_T)
-            {
-                g_channel.createDataSet(grid_type, std::get<std::vector<int8_t>>(this->data));
-            }
-            else if (this->type_id == DataType::INT16_T)
-            {
-                g_channel.createDataSet(grid_type, std::get<std::vector<int16_t>>(this->data));
-            }
-            else if (this->type_id == DataType::INT32_T)
-            {
-                g_channel.createDataSet(grid_type, std::get<std::vector<int32_t>>(this->data));
-            }
-            else if (this->type_id == DataType::INT64_T)
-            {
-                g_channel.createDataSet(grid_type, std::get<std::vector<int64_t>>(this->data));
-            }
-            else if (this->type_id == DataType::UINT8_T)
-            {
-                g_channel.createDataSet(grid_type, std::get<std::vector<uint8_t>>(this->data));
-            }
-            else if (this->type_id == DataType::UINT16_T)
-            {
-                g_channel.createDataSet(grid_type, std::get<std::vector<uint16_t>>(this->data));
-            }
-            else if (this->type_id == DataType::UINT32_T)
-            {
-                g_channel.createDataSet(grid_type, std::get<std::vector<uint32_t>>(this->data));
-            }
-            else if (this->type_id == DataType::SIZE_T)
-            {
-                g_channel.createDataSet(grid_type, std::get<std::vector<size_t>>(this->data));
-            }
-            else if (this->type_id == DataType::FLOAT)
+            this->createDataSet(g_channel, grid_type, vector, options);
+        };
+        std::visit(save_data, this->data);
+    }
+
+
+    /// @brief Writes a data vector to the provided HDF5 group.
+    /// @param g_channel Group in for the opened HDF5 file.
+    /// @param name Name of the data set.
+    /// @param vector Data to write.
+    /// @param options Chunking and compression for the data set.
+    /// @note  The data is written in the linear order so saved files do not depend on the layout.
+    ///        See `Grid::Properties::brick_size`.
+    template <typename T>
+    void createDataSet(HighFive::Group& g_channel, const std::string& name, const std::vector<T>& vector,
+                       const utilities::DataSetOptions& options) const
+    {
+        if (this->properties->isLinear())
+        {
+            options.createDataSet(g_channel, name, vector, this->properties->size);
+        }
+        else
+        {
+            options.createDataSet(g_channel, name, this->properties->toLinearOrder(vector), this->properties->size);
+        }
+    }
+
+
+    /// @brief Writes a sparse data vector to the provided HDF5 group.
+    /// @param g_channel Group in for the opened HDF5 file.
+    /// @param name Name of the data set.
+    /// @param vector Data to write.
+    /// @param options Chunking and compression for the data set.
+    /// @note  The data is written densely so saved files do not depend on the storage type.
+    template <typename T>
+    void createDataSet(HighFive::Group& g_channel, const std::string& name, const SparseVector<T>& vector,
+                       const utilities::DataSetOptions& options) const
+    {
+        this->createDataSet(g_channel, name, vector.toDense(), options);
+    }
+
+
+    /// @brief Writes a memory-mapped data vector to the provided HDF5 group.
+    /// @param g_channel Group in for the opened HDF5 file.
+    /// @param name Name of the data set.
+    /// @param vector Data to write.
+    /// @param options Chunking and compression for the data set.
+    /// @note  For the linear layout HDF5 reads straight from the mapped file, so no copy of the data
+    ///        is made. Otherwise it is reordered and written one Z-plane at a time.
+    template <typename T>
+    void createDataSet(HighFive::Group& g_channel, const std::string& name, const MappedVector<T>& vector,
+                       const utilities::DataSetOptions& options) const
+    {
+        vector.advise(MappedVector<T>::Access::SEQUENTIAL);
+        if (this->properties->isLinear())
+        {
+            options.createDataSet(g_channel, name, vector.data(), vector.size(), this->properties->size);
+        }
+        else
+        {
+            HighFive::DataSet dset = options.createDataSet<T>(g_channel, name, nullptr, vector.size(),
+                                                              this->properties->size);
+            this->forEachPlane<T>([&](std::vector<T>& plane, const size_t& z)
             {
-                g_channel.createDataSet(grid_type, std::get<std::vector<float>>(this->data));
-            }
-            else if (this->type_id == DataType::DOUBLE)
+                this->forEachVoxelInPlane(z, [&](const size_t& i, const size_t& j) { plane[j] = vector[i]; });
+                dset.select({z * plane.size()}, {plane.size()}).write_raw(plane.data());
+            });
+        }
+        vector.advise(MappedVector<T>::Access::NORMAL);
+    }
+
+
+    /// @brief Reads the VoxelGrid's data vector from the provided HDF5 group. This is the inverse
+    ///        of `save`.
+    /// @param g_channel Group in the opened HDF5 file.
+    /// @param grid_type Name of the derived class.
+    /// @throws GridPropertyError If a data set does not have one element per voxel.
+    /// @throws Any exception encountered while reading the HDF5 file.
+    /// @note This is virtual so VoxelGrid with multiple data channels may specifically handle
+    ///       their channels. But most derived VoxelGrids may uses this method.
+    virtual void load(const HighFive::Group& g_channel, const std::string& grid_type)
+    {
+        auto load_data = [this, &g_channel, &grid_type](auto& vector)
+        {
+            this->readDataSet(g_channel, grid_type, vector);
+        };
+        std::visit(load_data, this->data);
+    }
+
+
+    /// @brief Reads a data vector, written by `createDataSet`, from the provided HDF5 group.
+    /// @param g_channel Group in the opened HDF5 file.
+    /// @param name Name of the data set.
+    /// @param [out] vector Data to read into. It is resized to the number of voxels.
+    /// @throws GridPropertyError If the data set does not have one element per voxel.
+    /// @note  The data set is read directly into the vector's storage, converting to its type if
+    ///        needed. Only a non-linear layout needs a second buffer to reorder into.
+    template <typename T>
+    void readDataSet(const HighFive::Group& g_channel, const std::string& name, std::vector<T>& vector) const
+    {
+        const HighFive::DataSet dset = g_channel.getDataSet(name);
+        if (dset.getElementCount() != this->properties->getNumVoxels())
+        {
+            throw GridPropertyError::DataVectorDoesNotMatch(this->properties->size, dset.getElementCount());
+        }
+
+        if (this->properties->isLinear())
+        {
+            vector.resize(this->properties->getNumVoxels());
+            dset.read(vector);
+        }
+        else
+        {
+            std::vector<T> linear(this->properties->getNumVoxels());
+            dset.read(linear);
+            vector = this->properties->fromLinearOrder(linear);
+        }
+    }
+
+
+    /// @brief Reads a sparse data vector, written by `createDataSet`, from the provided HDF5 group.
+    /// @param g_channel Group in the opened HDF5 file.
+    /// @param name Name of the data set.
+    /// @param [out] vector Data to read into. Only voxels which differ from its fill value are
+    ///                     allocated.
+    /// @throws GridPropertyError If the data set does not have one element per voxel.
+    template <typename T>
+    void readDataSet(const HighFive::Group& g_channel, const std::string& name, SparseVector<T>& vector) const
+    {
+        std::vector<T> dense;
+        this->readDataSet(g_channel, name, dense);
+
+        SparseVector<T> sparse(this->properties->size, vector.fill(), this->properties->brick_size);
+        for (size_t i = 0; i < dense.size(); ++i)
+        {
+            if (dense[i] != sparse.fill())
             {
-                g_channel.createDataSet(grid_type, std::get<std::vector<double>>(this->data));
+                sparse[i] = dense[i];
             }
-            else
+        }
+        vector = std::move(sparse);
+    }
+
+
+    /// @brief Reads a memory-mapped data vector, written by `createDataSet`, from the provided HDF5
+    ///        group.
+    /// @param g_channel Group in the opened HDF5 file.
+    /// @param name Name of the data set.
+    /// @param [out] vector Data to read into. It is remapped if it does not have one element per voxel.
+    /// @throws GridPropertyError If the data set does not have one element per voxel.
+    /// @note  For the linear layout HDF5 writes straight into the mapped file. Otherwise it is read
+    ///        and reordered one Z-plane at a time.
+    template <typename T>
+    void readDataSet(const HighFive::Group& g_channel, const std::string& name, MappedVector<T>& vector) const
+    {
+        const HighFive::DataSet dset = g_channel.getDataSet(name);
+        if (dset.getElementCount() != this->properties->getNumVoxels())
+        {
+            throw GridPropertyError::DataVectorDoesNotMatch(this->properties->size, dset.getElementCount());
+        }
+        if (vector.size() != this->properties->getNumVoxels())
+        {
+            vector = MappedVector<T>(this->properties->getNumVoxels(), T(), this->properties->mmap_dir);
+        }
+
+        vector.advise(MappedVector<T>::Access::SEQUENTIAL);
+        if (this->properties->isLinear())
+        {
+            dset.read(vector.data());
+        }
+        else
+        {
+            this->forEachPlane<T>([&](std::vector<T>& plane, const size_t& z)
             {
-                DataVariantError::UnrecognizedEnumeration(this->type_id);
-            }
+                dset.select({z * plane.size()}, {plane.size()}).read(plane.data());
+                this->forEachVoxelInPlane(z, [&](const size_t& i, const size_t& j) { vector[i] = plane[j]; });
+            });
         }
-        catch (const std::bad_variant_access&)
+        vector.advise(MappedVector<T>::Access::NORMAL);
+    }
+
+
+    /// @brief Calls a function once for each Z-plane of the Grid with a buffer for the plane.
+    /// @param f Callable with the signature `void(std::vector<T>& plane, const size_t& z)`. The
+    ///          buffer holds one element per voxel in the plane and is reused between calls.
+    template <typename T, typename Function>
+    void forEachPlane(Function&& f) const
+    {
+        std::vector<T> plane(this->properties->size.x() * this->properties->size.y());
+        for (size_t z = 0; z < this->properties->size.z(); ++z)
+        {
+            f(plane, z);
+        }
+    }
+
+
+    /// @brief Calls a function for each voxel in a Z-plane, in the linear order.
+    /// @param z Position of the plane along Z.
+    /// @param f Callable with the signature `void(const size_t& i, const size_t& j)` for the voxel's
+    ///          vector index `i` and its position `j` within the plane.
+    template <typename Function>
+    void forEachVoxelInPlane(const size_t& z, Function&& f) const
+    {
+        size_t j = 0;
+        for (size_t y = 0; y < this->properties->size.y(); ++y)
         {
-            throw std::runtime_error("Bad variant access: Cannot save Grid's Data vector to HDF5 file.");
+            for (size_t x = 0; x < this->properties->size.x(); ++x, ++j)
+            {
+                f((*this->properties)[Index(x, y, z)], j);
+            }
         }
     }
 
@@ -377,9 +891,9 @@ protected:
 
 
     /// @brief Container of the same shape as `VoxelGrid::data` in any derived grid, but this stores
-    ///        a boolean flag for if a voxel was intersected by the postive region of a ray at least.
+    ///        a bit flag for if a voxel was intersected by the postive region of a ray at least.
     /// @note  This is a view of data managed by `data::Reconstruction`.
-    std::shared_ptr<const std::vector<bool>> data_seen{nullptr};
+    std::shared_ptr<const Bitset> data_seen{nullptr};
 
 private:
     // ***************************************************************************************** //
@@ -1,11 +1,19 @@
 #ifndef DEMOS_CPP_DEMOS_FORGE_SCAN_MANAGER_HPP
 #define DEMOS_CPP_DEMOS_FORGE_SCAN_MANAGER_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <list>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 #define H5_USE_EIGEN 1
 #include <highfive/H5File.hpp>
@@ -14,9 +22,18 @@
 #include "ForgeScan/Common/Definitions.hpp"
 #include "ForgeScan/Metrics/Constructor.hpp"
 #include "ForgeScan/Policies/Constructor.hpp"
+#include "ForgeScan/Data/Checkpoint.hpp"
+#include "ForgeScan/Data/Partition.hpp"
 #include "ForgeScan/Data/Reconstruction.hpp"
+#include "ForgeScan/Data/SurfaceMesh.hpp"
+#include "ForgeScan/Sensor/Camera.hpp"
+#include "ForgeScan/Sensor/FrameQueue.hpp"
+#include "ForgeScan/Sensor/ViewLog.hpp"
 #include "ForgeScan/Utilities/ArgParser.hpp"
 #include "ForgeScan/Utilities/Files.hpp"
+#include "ForgeScan/Utilities/HDF5.hpp"
+#include "ForgeScan/Utilities/MemoryUse.hpp"
+#include "ForgeScan/Utilities/Profiler.hpp"
 #include "ForgeScan/Utilities/XDMF.hpp"
 
 
@@ -24,6 +41,10 @@ namespace forge_scan {
 
 
 /// @brief Controls the Reconstruction, any Policies, and and Metrics.
+/// @note  Updates, saving, loading and the Policy methods hold a lock on the Manager's state, so
+///        while frames are integrated in the background (see `ingestStart`) each of these sees the
+///        Reconstruction between two whole updates. Channels, Metrics and Policies must not be
+///        added or removed while ingesting.
 class Manager
 {
 public:
@@ -53,12 +74,59 @@ public:
     }
 
 
+    /// @brief Creates a shared pointer to a Manager of one Partition of a Grid.
+    /// @param partition Partition the Manager reconstructs. Poses are given in the frame of the whole
+    ///                  Grid, and the Reconstruction stores only the Partition's planes.
+    /// @return Shared pointer to a Manager.
+    /// @note  The files each Partition's Manager saves may be joined with `data::Partition::merge`.
+    static std::shared_ptr<Manager> create(const data::Partition& partition)
+    {
+        return std::shared_ptr<Manager>(new Manager(partition));
+    }
+
+
+    /// @brief Integrates any frames still queued by `ingestFrame` and stops the ingestion threads,
+    ///        then writes any saves still queued by `saveAsync`. Exceptions from those threads are
+    ///        discarded; call `ingestStop` to receive them.
+    ~Manager()
+    {
+        try
+        {
+            this->ingestStop();
+        }
+        catch (...)
+        {
+
+        }
+        this->stopSaveThread();
+        std::lock_guard<std::recursive_mutex> hdf5_lock(utilities::hdf5Mutex());
+        this->evict_file.reset();
+    }
+
+
+    /// @brief Saves the current state of all items (VoxelGrids, Policies, Metrics, etc.) handled by the Manager.
+    /// @param fpath File path and file name for the data.
+    /// @returns Full path to the location the file was saved, including name and file extension.
+    /// @note  - If the file path does not already have the `.h5` extension, then this is added.
+    /// @note  - If a file name is not provided then this uses a default of `ForgeScan-[TIME STAMP].h5`.
+    /// @note  - The VoxelGrids are written with the Manager's `DataSetOptions`. See `setDataSetOptions`.
+    std::filesystem::path save(const std::filesystem::path& fpath) const
+    {
+        return this->save(fpath, this->dataset_options);
+    }
+
+
     /// @brief Saves the current state of all items (VoxelGrids, Policies, Metrics, etc.) handled by the Manager.
     /// @param fpath File path and file name for the data.
+    /// @param options Chunking and compression for the VoxelGrid data sets.
     /// @returns Full path to the location the file was saved, including name and file extension.
     /// @note  - If the file path does not already have the `.h5` extension, then this is added.
     /// @note  - If a file name is not provided then this uses a default of `ForgeScan-[TIME STAMP].h5`.
-    std::filesystem::path save(std::filesystem::path fpath) const
+    /// @note  - The Reconstruction is written from a Snapshot, so integration only waits for the
+    ///          Policies and Metrics to be saved and for the Snapshot to be taken, not for its data
+    ///          to be written. See `reconstructionGetSnapshot`.
+    /// @note  - The file is written while holding `utilities::hdf5Mutex`.
+    std::filesystem::path save(std::filesystem::path fpath, const utilities::DataSetOptions& options) const
     {
         utilities::checkPathHasFileNameAndExtension(fpath, FS_HDF5_FILE_EXTENSION, "Reconstruction", true);
         fpath.make_preferred();
@@ -68,16 +136,147 @@ public:
             std::filesystem::create_directories(fpath.parent_path());
         }
 
-        HighFive::File file(fpath.string(), HighFive::File::Truncate);
-        this->savePolicies(file);
-        this->reconstruction->save(file);
-        this->saveMetrics(file);
+        // Declared before the file so it is closed while the lock is still held.
+        std::unique_lock<std::recursive_mutex> hdf5_lock(utilities::hdf5Mutex(), std::defer_lock);
+        std::unique_ptr<HighFive::File> file;
+        std::shared_ptr<const data::Snapshot> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(this->update_mutex);
+            hdf5_lock.lock();
+            file = std::make_unique<HighFive::File>(fpath.string(), HighFive::File::Truncate);
+            this->savePolicies(*file);
+            this->saveMetrics(*file);
+            snapshot = this->reconstruction->getSnapshot();
+        }
+        snapshot->save(*file, options);
+        utilities::Profiler::instance().save(*file);
+        file.reset();
+        hdf5_lock.unlock();
 
-        this->makeXDMF(fpath);
+        this->makeXDMF(fpath, *snapshot);
         return fpath;
     }
 
 
+    /// @brief Saves the current state of all items handled by the Manager, as `save` does, on a
+    ///        background thread which writes only what changed since the last call.
+    /// @param fpath File path and file name for the data. If a file name is not provided then this
+    ///              uses a default of `Reconstruction.h5`, so each call writes the same file.
+    /// @return Future for the full path to the saved file, set once it is written. Or for the
+    ///         exception encountered while writing it.
+    /// @details The first call, and any to a different path or after a channel is added or removed,
+    ///          writes the whole file. Later calls to the same path copy only the chunks of voxels
+    ///          which the updates since the last call changed while holding the update lock, then
+    ///          write just those chunks over the data sets the file already has.
+    ///          A call made while an earlier one to the same path is still waiting to start is merged
+    ///          into it, and both return the same future.
+    /// @details The Policies, Metrics and Profile change size as the scan goes on, so they are not
+    ///          written into the file, where replacing them each call would leave their old space
+    ///          unused and the file would grow. They are written whole into a second file, named
+    ///          with `-State` after the file's stem, which each call replaces. The file holds
+    ///          external links to its groups, so `load` reads both as one file. Keep the two together.
+    /// @note  - Checkpoints only cost roughly the changed chunks if the data sets are chunked, see
+    ///          `utilities::DataSetOptions::chunk_bytes` and `setDataSetOptions`. Compact channels are
+    ///          still decoded whole to write their chunks.
+    /// @note  - The Manager keeps a copy of the channels between calls, see `data::Checkpoint`. The
+    ///          first call enables the Reconstruction's change tracking, see
+    ///          `data::Reconstruction::enableChangeTracking`.
+    /// @note  - The file must not be written by anything else, such as `save`, between calls. The
+    ///          save thread holds `utilities::hdf5Mutex` while it writes.
+    std::shared_future<std::filesystem::path> saveAsync(std::filesystem::path fpath)
+    {
+        utilities::validateAndCreateFilepath(fpath, FS_HDF5_FILE_EXTENSION, "Reconstruction", false);
+
+        std::lock_guard<std::mutex> lock(this->save_mutex);
+        if (!this->save_requests.empty() && this->save_requests.back().fpath == fpath)
+        {
+            return this->save_requests.back().future;
+        }
+        this->save_requests.emplace_back();
+        SaveRequest& request = this->save_requests.back();
+        request.fpath  = fpath;
+        request.future = request.promise.get_future().share();
+
+        if (!this->save_thread.joinable())
+        {
+            this->save_stop   = false;
+            this->save_thread = std::thread(&Manager::saveLoop, this);
+        }
+        this->save_cv.notify_one();
+        return request.future;
+    }
+
+
+    /// @brief Restores the state saved by `save` so a scan may be resumed, or branched, from it.
+    /// @param fpath File path, with file name, for the HDF5 file to read.
+    /// @details The Reconstruction's channels, seen data, and update count are restored. So are the
+    ///          accepted and rejected views of each Policy, and the history of each Metric.
+    /// @note  Policies and Metrics are not created from the file. Add them, in the same order as
+    ///        when the file was saved, before calling this so their data and channels are restored.
+    ///        Channels added with `reconstructionAddChannel` are created if they do not exist.
+    /// @throws GridPropertyError If the file's `Grid::Properties` do not match the Manager's.
+    /// @throws Any exception encountered while reading the HDF5 file.
+    void load(std::filesystem::path fpath)
+    {
+        fpath.make_preferred();
+        fpath = std::filesystem::absolute(fpath);
+
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        std::lock_guard<std::recursive_mutex> hdf5_lock(utilities::hdf5Mutex());
+        HighFive::File file(fpath.string(), HighFive::File::ReadOnly);
+
+        this->reconstruction->load(file);
+        this->reconstruction_update_count = this->reconstruction->getNumUpdates();
+        if (this->surface)
+        {
+            this->surface->markAll();
+        }
+        this->loadPolicies(file);
+        this->loadMetrics(file);
+    }
+
+
+    /// @brief Sets the chunking and compression used by `save`.
+    /// @param options Options for the VoxelGrid data sets.
+    void setDataSetOptions(const utilities::DataSetOptions& options)
+    {
+        this->dataset_options = options;
+    }
+
+
+    /// @brief Gets the chunking and compression used by `save`.
+    const utilities::DataSetOptions& getDataSetOptions() const
+    {
+        return this->dataset_options;
+    }
+
+
+    /// @brief Calculates how much space each item handled by the Manager is using.
+    /// @return Report with the items of `data::Reconstruction::getMemoryReport`, prefixed by
+    ///         `Reconstruction/`, an item for each Metric, named `Metric/<name>`, and an item for the
+    ///         sensed points buffers of the Manager. See `utilities::memory_use::total` for the sum.
+    utilities::memory_use::Report getMemoryReport() const
+    {
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        utilities::memory_use::Report report;
+        for (const auto& item : this->reconstruction->getMemoryReport())
+        {
+            report["Reconstruction/" + item.first] = item.second;
+        }
+        for (const auto& item : this->metrics_map)
+        {
+            report["Metric/" + item.first] = item.second->getMemoryUsage();
+        }
+        size_t n_sensed = sizeof(PointMatrix::Scalar) * this->sensed_buffer.size();
+        for (const auto& buffer : this->rig_buffers)
+        {
+            n_sensed += sizeof(PointMatrix::Scalar) * buffer.size();
+        }
+        report["Manager/Sensed Points"] = utilities::memory_use::Usage{n_sensed, n_sensed};
+        return report;
+    }
+
+
 
     // ***************************************************************************************** //
     // *                                 PUBLIC POLICY METHODS                                 * //
@@ -154,6 +353,8 @@ public:
     void policyGenerate()
     {
         this->throwIfNoActivePolicy();
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        FS_PROFILE_SCOPE(POLICY_GENERATE, nullptr);
         return this->policyGetActiveNonConst()->generate();
     }
 
@@ -164,6 +365,7 @@ public:
     Extrinsic policyGetView()
     {
         this->throwIfNoActivePolicy();
+        std::lock_guard<std::mutex> lock(this->update_mutex);
         return this->policyGetActiveNonConst()->getView();
     }
 
@@ -174,6 +376,7 @@ public:
     bool policyAcceptView()
     {
         this->throwIfNoActivePolicy();
+        std::lock_guard<std::mutex> lock(this->update_mutex);
         bool res = this->policyGetActiveNonConst()->acceptView(this->policy_total_views);
         if (res)
         {
@@ -189,6 +392,7 @@ public:
     bool policyRejectView()
     {
         this->throwIfNoActivePolicy();
+        std::lock_guard<std::mutex> lock(this->update_mutex);
         bool res = this->policyGetActiveNonConst()->rejectView(this->policy_total_views);
         if (res)
         {
@@ -204,6 +408,7 @@ public:
     bool policyIsComplete() const
     {
         this->throwIfNoActivePolicy();
+        std::lock_guard<std::mutex> lock(this->update_mutex);
         return this->policyGetActive()->isComplete();
     }
 
@@ -234,20 +439,325 @@ public:
     }
 
 
+    /// @brief Gets a copy of the Reconstruction's channels and seen data as they are now. This may
+    ///        be read, or saved, while frames passed to `ingestFrame` carry on being integrated.
+    /// @return Shared, constant pointer to the Snapshot. See `data::Reconstruction::getSnapshot`.
+    std::shared_ptr<const data::Snapshot> reconstructionGetSnapshot() const
+    {
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        return this->reconstruction->getSnapshot();
+    }
+
+
+    /// @brief Starts keeping a mesh of the surface in a TSDF channel, which is extracted again only
+    ///        where updates have changed it. See `data::SurfaceMesh`.
+    /// @param channel Name of the `data::TSDF` or `data::BinaryTSDF` channel to mesh.
+    /// @param iso Distance of the surface. Default 0.
+    /// @note  This replaces any surface already kept. Blocks are meshed on the first call to
+    ///        `reconstructionGetSurface` or `reconstructionSaveSurface`, so updates only mark which
+    ///        blocks they change.
+    /// @throws Any exception thrown by `data::SurfaceMesh::create` passes through this.
+    void reconstructionEnableSurface(const std::string& channel, const float& iso = 0)
+    {
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        this->surface = data::SurfaceMesh::create(this->reconstruction, channel, iso);
+    }
+
+
+    /// @brief Gets the surface mesh as it is now, with the blocks meeting at shared vertices.
+    /// @return The merged mesh. See `data::SurfaceMesh::merge`.
+    /// @note  Integration only waits while the blocks changed since the last call are meshed. The
+    ///        blocks are merged after the update lock is released.
+    /// @throws std::runtime_error If `reconstructionEnableSurface` was not called.
+    data::SurfaceMesh::Mesh reconstructionGetSurface()
+    {
+        return data::SurfaceMesh::merge(this->updateSurface());
+    }
+
+
+    /// @brief Saves the surface mesh as it is now to a binary PLY file.
+    /// @param fpath File path, with file name, to write to. See `data::SurfaceMesh::savePLY`.
+    /// @return Full path to the file written.
+    /// @note  As with `reconstructionGetSurface`, the file is written after the update lock is released.
+    /// @throws std::runtime_error If `reconstructionEnableSurface` was not called.
+    /// @throws std::runtime_error If the file could not be opened.
+    std::filesystem::path reconstructionSaveSurface(const std::filesystem::path& fpath)
+    {
+        return data::SurfaceMesh::savePLY(fpath, this->updateSurface());
+    }
+
+
+    /// @brief Makes the Reconstruction a rolling window which follows the sensor, so a scene larger
+    ///        than the Grid may be scanned in constant memory.
+    /// @param margin Distance, in world units, the sensor may move from the centre of the window
+    ///               along each axis before the window moves to centre on it again. A negative
+    ///               value stops rolling.
+    /// @param evict_fpath If not empty, the voxels which leave the window are written to this HDF5
+    ///                    file, one group for each slab. See `data::Reconstruction::shiftWindow`.
+    ///                    The file is truncated, and is closed when rolling stops.
+    /// @details Before each update the window is moved, by whole voxels, along each axis on which
+    ///          the sensor is further than `margin` from its centre. Poses given to the updates are in
+    ///          the Reconstruction's starting frame, and are moved into the window before they reach
+    ///          the Reconstruction, Policies and Metrics. Views suggested by a Policy are in the
+    ///          window, so add `data::Reconstruction::getWindowOffset` times the resolution to them.
+    /// @note  The shared `reconstructionUpdate` of many Managers does not move their windows.
+    /// @note  Memory is constant, but moves are not free. The window is a copy within the same
+    ///        storage rather than a circular buffer, see `data::Reconstruction::shiftWindow`, so each
+    ///        move takes time in proportion to the Grid. Keep the margin large enough that moves are
+    ///        rare. The next `saveAsync` then writes each chunk which held, or now holds, scanned
+    ///        voxels, which is most of the file once the window is full.
+    /// @throws Any exception encountered while creating the HDF5 file.
+    void reconstructionSetRolling(const float& margin, std::filesystem::path evict_fpath = "")
+    {
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        std::lock_guard<std::recursive_mutex> hdf5_lock(utilities::hdf5Mutex());
+        this->evict_file.reset();
+        this->rolling_margin = margin;
+        if (margin < 0 || evict_fpath.empty())
+        {
+            return;
+        }
+        utilities::checkPathHasFileNameAndExtension(evict_fpath, FS_HDF5_FILE_EXTENSION, "Evicted", true);
+        evict_fpath.make_preferred();
+        evict_fpath = std::filesystem::absolute(evict_fpath);
+        if (!std::filesystem::exists(evict_fpath.parent_path()))
+        {
+            std::filesystem::create_directories(evict_fpath.parent_path());
+        }
+        this->evict_file = std::make_unique<HighFive::File>(evict_fpath.string(), HighFive::File::Truncate);
+    }
+
+
     /// @brief Updates each VoxelGrid in the Reconstruction based on the provided set of rays.
     /// @param sensed A set of measurements which act as the end points for a collection of rays.
-    /// @param extr   Reference frame for the `sensed` measurements and their common origin.
+    /// @param pose   Reference frame for the `sensed` measurements and their common origin.
     /// @warning This transforms the sensed points in-place.
-    void reconstructionUpdate(PointMatrix& sensed, const Extrinsic& extr)
+    void reconstructionUpdate(PointMatrix& sensed, const Extrinsic& pose)
     {
-        this->preUpdate(sensed, extr);
-        sensed = extr * sensed.colwise().homogeneous();
-        this->reconstruction->update(sensed, extr.translation());
-        this->postUpdate();
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        {
+            FS_PROFILE_SCOPE(MANAGER_UPDATE, nullptr);
+            this->rollWindow(pose.translation());
+            const Extrinsic extr = this->toWindow(pose);
+            this->preUpdate(sensed, extr);
+            Manager::transformInPlace(sensed, extr);
+            this->reconstruction->update(sensed, extr.translation());
+            this->postUpdate();
+        }
+        FS_PROFILE_RECORD(this->reconstruction_update_count);
+        ++this->reconstruction_update_count;
+    }
+
+
+    /// @brief Updates each VoxelGrid in the Reconstruction with the current depth image of a Camera.
+    /// @param camera Camera to use. Its extrinsic pose must be relative to the Reconstruction's frame.
+    /// @param stride Only every `stride` rows and columns of the image are used. A value of 1 uses
+    ///               every pixel.
+    /// @note  Pixels without a valid depth are skipped. See `sensor::Camera::getPointMatrix`.
+    /// @note  The image is deprojected with the Reconstruction's threads, see
+    ///        `data::Reconstruction::setNumThreads`.
+    /// @note  When no Metrics are added the image is deprojected directly into the Reconstruction's
+    ///        frame, in a buffer reused between updates. Otherwise the Metrics are given the Points
+    ///        relative to the Camera, as with the other `reconstructionUpdate`.
+    /// @note  The depth image is also passed on for the projective update, see
+    ///        `data::Reconstruction::setProjectiveUpdate`. That samples the whole image regardless
+    ///        of the stride, which then only thins the Points used to find the surface.
+    void reconstructionUpdate(const std::shared_ptr<const sensor::Camera>& camera, const size_t& stride = 1)
+    {
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        {
+            FS_PROFILE_SCOPE(MANAGER_UPDATE, nullptr);
+            this->rollWindow(camera->getExtr().translation());
+            const Extrinsic extr = this->toWindow(camera->getExtr());
+            const bool relative = !this->metrics_map.empty();
+            camera->getPointMatrix(this->sensed_buffer, relative ? Extrinsic::Identity() : extr, stride, true,
+                                   this->reconstruction->getNumThreads());
+            this->integrate(this->sensed_buffer, camera->getImage(), *camera->getIntr(), extr, relative);
+        }
+        FS_PROFILE_RECORD(this->reconstruction_update_count);
+        ++this->reconstruction_update_count;
+    }
+
+
+    /// @brief Updates each VoxelGrid in the Reconstruction with one capture by a rig of cameras.
+    /// @param sensed Points measured by each camera of the rig, relative to that camera.
+    /// @param extrs  Pose of each camera, which is the reference frame and origin of its Points.
+    /// @throws std::invalid_argument If there is not one pose for each set of Points.
+    /// @warning This transforms the sensed points in-place.
+    /// @note  The capture is one update. The Metrics' `preUpdate` is called for each camera and
+    ///        their `postUpdate` once, and the update count goes up by one. See the rig
+    ///        `data::Reconstruction::update`.
+    void reconstructionUpdateRig(std::vector<PointMatrix>& sensed, const std::vector<Extrinsic>& extrs)
+    {
+        if (sensed.size() != extrs.size())
+        {
+            throw std::invalid_argument("A rig update needs one extrinsic pose for each set of sensed points.");
+        }
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        {
+            FS_PROFILE_SCOPE(MANAGER_UPDATE, nullptr);
+            Point centre = Point::Zero();
+            for (const auto& extr : extrs)
+            {
+                centre += extr.translation() / static_cast<float>(extrs.size());
+            }
+            this->rollWindow(centre);
+            std::vector<data::Reconstruction::RigFrame> frames(sensed.size());
+            for (size_t c = 0; c < sensed.size(); ++c)
+            {
+                const Extrinsic extr = this->toWindow(extrs[c]);
+                this->preUpdate(sensed[c], extr);
+                Manager::transformInPlace(sensed[c], extr);
+                frames[c].sensed_points = &sensed[c];
+                frames[c].extr = extr;
+            }
+            this->reconstruction->update(frames);
+            this->postUpdate();
+        }
+        FS_PROFILE_RECORD(this->reconstruction_update_count);
+        ++this->reconstruction_update_count;
+    }
+
+
+    /// @brief Updates each VoxelGrid in the Reconstruction with the current depth images of a rig
+    ///        of cameras, as one capture.
+    /// @param rig Cameras of the rig. Their extrinsic poses must be relative to the Reconstruction's frame.
+    /// @param stride Only every `stride` rows and columns of each image are used. See the Camera
+    ///               overload of `reconstructionUpdate`.
+    /// @note  As with the other `reconstructionUpdateRig`, the Metrics' `postUpdate` is called once
+    ///        and the update count goes up by one for the whole rig. Each camera's image is still
+    ///        deprojected, and used by the projective update, on its own.
+    void reconstructionUpdateRig(const std::vector<std::shared_ptr<const sensor::Camera>>& rig, const size_t& stride = 1)
+    {
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        {
+            FS_PROFILE_SCOPE(MANAGER_UPDATE, nullptr);
+            const bool relative = !this->metrics_map.empty();
+            if (this->rig_buffers.size() < rig.size())
+            {
+                this->rig_buffers.resize(rig.size());
+            }
+            Point centre = Point::Zero();
+            for (const auto& camera : rig)
+            {
+                centre += camera->getExtr().translation() / static_cast<float>(rig.size());
+            }
+            this->rollWindow(centre);
+            std::vector<data::Reconstruction::RigFrame> frames(rig.size());
+            for (size_t c = 0; c < rig.size(); ++c)
+            {
+                const Extrinsic extr = this->toWindow(rig[c]->getExtr());
+                PointMatrix& sensed   = this->rig_buffers[c];
+                rig[c]->getPointMatrix(sensed, relative ? Extrinsic::Identity() : extr, stride, true,
+                                       this->reconstruction->getNumThreads());
+                if (relative)
+                {
+                    this->preUpdate(sensed, extr);
+                    Manager::transformInPlace(sensed, extr);
+                }
+                frames[c].sensed_points = &sensed;
+                frames[c].extr  = extr;
+                frames[c].image = &rig[c]->getImage();
+                frames[c].intr  = rig[c]->getIntr().get();
+            }
+            this->reconstruction->update(frames);
+            this->postUpdate();
+        }
+        FS_PROFILE_RECORD(this->reconstruction_update_count);
         ++this->reconstruction_update_count;
     }
 
 
+    /// @brief Updates the Reconstruction with every view recorded in a view log, in order.
+    /// @param log Views to replay. See `sensor::ViewLogWriter`.
+    /// @param stride Only every `stride` rows and columns of each image are used. See the Camera
+    ///               overload of `reconstructionUpdate`.
+    /// @return Number of views replayed.
+    /// @note  Views recorded from a `simulation::Pipeline` are integrated exactly as they were when
+    ///        recorded, as the images already have their noise added.
+    size_t reconstructionReplay(const sensor::ViewLogReader& log, const size_t& stride = 1)
+    {
+        std::shared_ptr<sensor::Camera> camera = log.createCamera();
+        for (size_t i = 0; i < log.size(); ++i)
+        {
+            log.read(i, camera);
+            this->reconstructionUpdate(camera, stride);
+        }
+        return log.size();
+    }
+
+
+    /// @brief Updates the Reconstructions of several Managers with the depth image of a Camera,
+    ///        deprojecting the image once and tracing each ray once for each distinct set of trace
+    ///        settings. See `data::Reconstruction::update`.
+    /// @param managers Managers to update. Their Reconstructions must share equal Grid Properties.
+    /// @param camera Camera to use. Its extrinsic pose must be relative to the Reconstructions' frame.
+    /// @param stride Only every `stride` rows and columns of the image are used.
+    /// @param n_threads Number of threads to deproject the image and apply the traces with. See
+    ///                  `data::Reconstruction::update`.
+    /// @throws GridPropertyError If the Reconstructions do not have equal Grid Properties.
+    /// @note  Each Manager's Metrics are still given the Points relative to the Camera.
+    /// @note  This does not take the Managers' update locks, so they must not be ingesting frames.
+    static void reconstructionUpdate(const std::vector<std::shared_ptr<Manager>>& managers,
+                                     const std::shared_ptr<const sensor::Camera>& camera,
+                                     const size_t& stride = 1, const size_t& n_threads = 1)
+    {
+        if (managers.empty())
+        {
+            return;
+        }
+        {
+            FS_PROFILE_SCOPE(MANAGER_UPDATE, nullptr);
+            const Extrinsic& extr = camera->getExtr();
+            PointMatrix& sensed   = managers.front()->sensed_buffer;
+            camera->getPointMatrix(sensed, Extrinsic::Identity(), stride, true, n_threads);
+
+            std::vector<std::shared_ptr<data::Reconstruction>> reconstructions;
+            reconstructions.reserve(managers.size());
+            for (const auto& manager : managers)
+            {
+                manager->preUpdate(sensed, extr);
+                reconstructions.push_back(manager->reconstruction);
+            }
+            Manager::transformInPlace(sensed, extr);
+            data::Reconstruction::update(reconstructions, sensed, extr.translation(), n_threads);
+
+            for (const auto& manager : managers)
+            {
+                manager->postUpdate();
+            }
+        }
+
+        // The Managers share one trace, so they share one Profiler record.
+        FS_PROFILE_RECORD(managers.front()->reconstruction_update_count);
+        for (const auto& manager : managers)
+        {
+            ++manager->reconstruction_update_count;
+        }
+    }
+
+
+    /// @brief Updates the Reconstructions of several Managers with every view recorded in a view
+    ///        log, in order, tracing each ray once for each distinct set of trace settings.
+    /// @param managers Managers to update. See the shared `reconstructionUpdate`.
+    /// @param log Views to replay. See `sensor::ViewLogWriter`.
+    /// @param stride Only every `stride` rows and columns of each image are used.
+    /// @param n_threads Number of threads to apply the traces with.
+    /// @return Number of views replayed.
+    static size_t reconstructionReplay(const std::vector<std::shared_ptr<Manager>>& managers,
+                                       const sensor::ViewLogReader& log,
+                                       const size_t& stride = 1, const size_t& n_threads = 1)
+    {
+        std::shared_ptr<sensor::Camera> camera = log.createCamera();
+        for (size_t i = 0; i < log.size(); ++i)
+        {
+            log.read(i, camera);
+            Manager::reconstructionUpdate(managers, camera, stride, n_threads);
+        }
+        return log.size();
+    }
+
+
     /// @brief Queries the Reconstruction for how many times it has been updated with new data.
     /// @return Total number of successful updates the Reconstruction has had.
     size_t reconstructionGetUpdateCount() const
@@ -257,6 +767,134 @@ public:
 
 
 
+    // ***************************************************************************************** //
+    // *                               PUBLIC INGESTION METHODS                                * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Frame counts and latencies of the frames given to `ingestFrame`.
+    struct IngestStats
+    {
+        /// @brief Number of frames given to `ingestFrame`, dropped by the overflow policy, waiting
+        ///        to be integrated, and integrated.
+        size_t received = 0, dropped = 0, queued = 0, integrated = 0;
+
+        /// @brief Time from a frame's arrival in `ingestFrame` to the end of its integration, in
+        ///        milliseconds. The mean and maximum are over every integrated frame.
+        double latency_last_ms = 0, latency_mean_ms = 0, latency_max_ms = 0;
+    };
+
+
+    /// @brief Starts threads which integrate the frames given to `ingestFrame` in the background.
+    /// @param intr Intrinsics of the sensor the frames come from.
+    /// @param parser ArgParser with the ingestion options:
+    ///               - `--queue-capacity <n>` Frames which may wait to be integrated. Default 4.
+    ///               - `--n-ingest-threads <n>` Threads which integrate frames. Default 1.
+    ///               - `--overflow <block | drop-newest | drop-oldest>` What `ingestFrame` does when
+    ///                 the queue is full. See `sensor::FrameQueue::Overflow`. Default block.
+    ///               - `--stride <n>` See the Camera overload of `reconstructionUpdate`. Default 1.
+    /// @details Each thread deprojects the frames it takes from the queue on its own and then
+    ///          integrates them one at a time, holding the same lock as the other updates. With more
+    ///          than one thread the deprojection of one frame overlaps the integration of another.
+    ///          Frames are still integrated in the order they were queued, so the result does not
+    ///          depend on the number of threads. Only the deprojection runs in parallel.
+    /// @throws std::runtime_error If the Manager is already ingesting frames.
+    /// @throws std::invalid_argument If the overflow policy is not recognized.
+    void ingestStart(const std::shared_ptr<const sensor::Intrinsics>& intr,
+                     const utilities::ArgParser& parser = utilities::ArgParser())
+    {
+        if (this->ingest_queue)
+        {
+            throw std::runtime_error("Manager is already ingesting frames.");
+        }
+        const size_t n_threads = std::max(parser.get<size_t>(Manager::parse_n_ingest_threads, 1), size_t(1));
+        this->ingest_stride = std::max(parser.get<size_t>(Manager::parse_stride, 1), size_t(1));
+        this->ingest_queue  = std::make_unique<sensor::FrameQueue>(
+            *intr, parser.get<size_t>(Manager::parse_queue_capacity, Manager::default_queue_capacity),
+            sensor::FrameQueue::getOverflow(parser.get(Manager::parse_overflow)));
+        {
+            std::lock_guard<std::mutex> lock(this->update_mutex);
+            this->ingest_stats          = IngestStats();
+            this->ingest_error          = nullptr;
+            this->ingest_next_pop       = 0;
+            this->ingest_next_integrate = 0;
+        }
+        for (size_t i = 0; i < n_threads; ++i)
+        {
+            this->ingest_threads.emplace_back([this, intr]() { this->ingestRun(intr); });
+        }
+    }
+
+
+    /// @brief Queues a copy of a depth image and its pose to be integrated in the background.
+    ///        Only one thread may call this at a time.
+    /// @param image Depth image from the sensor given to `ingestStart`.
+    /// @param extr  Pose of the sensor, relative to the Reconstruction's frame.
+    /// @return True if the frame was queued. False if it was dropped because the queue was full.
+    /// @note  With the `block` overflow policy this waits while the queue is full.
+    /// @throws std::runtime_error If the Manager is not ingesting frames.
+    /// @throws std::invalid_argument If the image is not the size of the Intrinsics.
+    /// @throws Any exception from the ingestion threads. Once one has thrown every call throws it
+    ///         again until `ingestStop` is called.
+    bool ingestFrame(const DepthImage& image, const Extrinsic& extr)
+    {
+        if (!this->ingest_queue)
+        {
+            throw std::runtime_error("Manager is not ingesting frames. Call ingestStart first.");
+        }
+        this->rethrowIfIngestFailed(false);
+        return this->ingest_queue->push(image, extr);
+    }
+
+
+    /// @brief Integrates every frame still queued and stops the ingestion threads.
+    /// @return Counts and latencies of the frames ingested since `ingestStart`.
+    /// @throws Any exception from the ingestion threads.
+    IngestStats ingestStop()
+    {
+        if (this->ingest_queue)
+        {
+            this->ingest_queue->close();
+            for (auto& thread : this->ingest_threads)
+            {
+                thread.join();
+            }
+            this->ingest_threads.clear();
+
+            std::lock_guard<std::mutex> lock(this->update_mutex);
+            this->ingest_stats.received = this->ingest_queue->getNumReceived();
+            this->ingest_stats.dropped  = this->ingest_queue->getNumDropped();
+            this->ingest_stats.queued   = 0;
+            this->ingest_queue.reset();
+        }
+        this->rethrowIfIngestFailed(true);
+        return this->ingestGetStats();
+    }
+
+
+    /// @brief Returns true between `ingestStart` and `ingestStop`.
+    bool isIngesting() const
+    {
+        return this->ingest_queue != nullptr;
+    }
+
+
+    /// @brief Returns the counts and latencies of the frames ingested since `ingestStart`.
+    IngestStats ingestGetStats() const
+    {
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        IngestStats stats = this->ingest_stats;
+        if (this->ingest_queue)
+        {
+            stats.received = this->ingest_queue->getNumReceived();
+            stats.dropped  = this->ingest_queue->getNumDropped();
+            stats.queued   = this->ingest_queue->size();
+        }
+        return stats;
+    }
+
+
+
     // ***************************************************************************************** //
     // *                                 PUBLIC METRIC METHODS                                 * //
     // ***************************************************************************************** //
@@ -291,6 +929,11 @@ public:
     // *                                 PUBLIC CLASS MEMBERS                                  * //
     // ***************************************************************************************** //
 
+    /// @brief Default number of frames which may wait to be integrated. See `ingestStart`.
+    static constexpr size_t default_queue_capacity = 4;
+
+    static const std::string parse_queue_capacity, parse_n_ingest_threads, parse_overflow, parse_stride;
+
     /// @brief Shared, constant `Grid::Properties` used by all items the handled by the Manager.
     const std::shared_ptr<const Grid::Properties> grid_properties;
 
@@ -308,11 +951,20 @@ private:
     /// @param parser ArgParser with arguments to construct `Grid::Properties` from.
     ///               These `Grid::Properties` are utilized by all Reconstruction VoxelGrids.
     ///               See `forge_scan::Grid::Properties` for details.
+    /// @note  If the parser has `data::Partition::parse_n_ranks` the Manager reconstructs one Partition
+    ///        of the Grid. See `data::Partition::create`.
     explicit Manager(const utilities::ArgParser& parser)
-        : grid_properties(Grid::Properties::createConst(parser)),
-          reconstruction(data::Reconstruction::create(this->grid_properties))
+        : Manager(*data::Partition::create(parser))
     {
-
+        this->reconstruction->setNumThreads(parser.get<size_t>(data::Reconstruction::parse_n_threads, 1));
+        this->reconstruction->setSkipSaturated(parser.has(data::Reconstruction::parse_skip_saturated));
+        this->reconstruction->setProjectiveUpdate(parser.has(data::Reconstruction::parse_projective));
+        this->reconstruction->setEndpointMerge(
+            data::Reconstruction::getEndpointMerge(parser.get(data::Reconstruction::parse_endpoint_merge)));
+        this->reconstruction->setMemoryBudget(
+            utilities::memory_use::megabytes_to_byte(parser.get<float>(data::Reconstruction::parse_memory_budget, 0)),
+            parser.has(data::Reconstruction::parse_compact_fallback));
+        this->dataset_options = utilities::DataSetOptions(parser);
     }
 
     /// @brief Private constructor to enforce use of shared pointers.
@@ -325,13 +977,24 @@ private:
 
     }
 
+    /// @brief Private constructor to enforce use of shared pointers.
+    /// @param partition Partition of a Grid to reconstruct.
+    explicit Manager(const data::Partition& partition)
+        : grid_properties(partition.getProperties()),
+          reconstruction(data::Reconstruction::create(this->grid_properties))
+    {
+        this->reconstruction->setWindowOffset(partition.getWindowOffset());
+    }
+
 
     /// @brief Writes an XDMF to pair with the HDF5 file for visualizing the data in tools like
     ///        ParaView.
     /// @param fpath File path, with file name, for the HDF5 file.
+    /// @param snapshot Snapshot, or Checkpoint, of the Reconstruction written into the HDF5 file.
     /// @throws std::runtime_error If any issues are ofstream failures are encountered when
     ///         writing the XDMF file.
-    void makeXDMF(std::filesystem::path fpath) const
+    template <typename Copy>
+    void makeXDMF(std::filesystem::path fpath, const Copy& snapshot) const
     {
         const std::string hdf5_fname = fpath.filename().string();
         fpath.replace_extension(FS_XDMF_FILE_EXTENSION);
@@ -356,7 +1019,7 @@ private:
                 lower.x(), lower.y(), lower.z()
             );
 
-            this->reconstruction->addToXDMF(file, hdf5_fname);
+            snapshot.addToXDMF(file, hdf5_fname);
 
             utilities::XDMF::writeVoxelGridFooter(file);
             utilities::XDMF::writeFooter(file);
@@ -371,6 +1034,106 @@ private:
     }
 
 
+    /// @brief Writes the requests of `saveAsync`, in order, until `stopSaveThread` is called and
+    ///        none are left. Run by the save thread.
+    void saveLoop()
+    {
+        std::unique_lock<std::mutex> lock(this->save_mutex);
+        while (true)
+        {
+            this->save_cv.wait(lock, [this]() { return this->save_stop || !this->save_requests.empty(); });
+            if (this->save_requests.empty())
+            {
+                return;
+            }
+            SaveRequest request = std::move(this->save_requests.front());
+            this->save_requests.pop_front();
+            lock.unlock();
+
+            try
+            {
+                request.promise.set_value(this->writeCheckpoint(request.fpath));
+            }
+            catch (...)
+            {
+                this->checkpoint_fpath.clear();
+                request.promise.set_exception(std::current_exception());
+            }
+            lock.lock();
+        }
+    }
+
+
+    /// @brief Writes one request of `saveAsync`.
+    /// @param fpath Full path to the HDF5 file.
+    /// @return The same path.
+    /// @throws Any exception encountered while writing the file. `saveLoop` then has the next
+    ///         request write the whole file.
+    std::filesystem::path writeCheckpoint(const std::filesystem::path& fpath)
+    {
+        if (!this->checkpoint)
+        {
+            this->checkpoint = data::Checkpoint::create(this->reconstruction);
+        }
+        if (fpath != this->checkpoint_fpath || !std::filesystem::exists(fpath))
+        {
+            this->checkpoint->markFullWrite();
+            this->checkpoint_fpath = fpath;
+        }
+        std::filesystem::path state_fpath = fpath;
+        state_fpath.replace_filename(fpath.stem().string() + "-State" + fpath.extension().string());
+
+        // Declared before the file so it is closed while the lock is still held.
+        std::unique_lock<std::recursive_mutex> hdf5_lock(utilities::hdf5Mutex(), std::defer_lock);
+        bool full = false;
+        {
+            std::lock_guard<std::mutex> lock(this->update_mutex);
+            this->checkpoint->copy();
+            full = this->checkpoint->isFullWrite();
+
+            hdf5_lock.lock();
+            HighFive::File state(state_fpath.string(), HighFive::File::Truncate);
+            this->savePolicies(state);
+            state.createGroup(FS_HDF5_METRIC_GROUP);
+            this->saveMetrics(state);
+            state.createGroup(FS_HDF5_PROFILE_GROUP);
+            utilities::Profiler::instance().save(state);
+        }
+
+        HighFive::File file(fpath.string(), full ? HighFive::File::Truncate : HighFive::File::ReadWrite);
+        this->checkpoint->write(file, this->dataset_options);
+        if (full)
+        {
+            for (const char* group : {FS_HDF5_POLICY_GROUP, FS_HDF5_METRIC_GROUP, FS_HDF5_PROFILE_GROUP})
+            {
+                utilities::createExternalLink(file, group, state_fpath.filename().string(), group);
+            }
+        }
+        file.flush();
+
+        if (full)
+        {
+            this->makeXDMF(fpath, *this->checkpoint);
+        }
+        return fpath;
+    }
+
+
+    /// @brief Writes any requests of `saveAsync` still queued and stops the save thread.
+    void stopSaveThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->save_mutex);
+            this->save_stop = true;
+        }
+        this->save_cv.notify_one();
+        if (this->save_thread.joinable())
+        {
+            this->save_thread.join();
+        }
+    }
+
+
 
     // ***************************************************************************************** //
     // *                                PRIVATE POLICY METHODS                                 * //
@@ -405,6 +1168,7 @@ private:
     void savePolicies(HighFive::File& file) const
     {
         auto g_policy = file.createGroup(FS_HDF5_POLICY_GROUP);
+        g_policy.createAttribute("active", this->active_policy_idx);
         for (const auto& policy : this->policy_vec)
         {
             policy->save(file, g_policy);
@@ -412,12 +1176,244 @@ private:
     }
 
 
+    /// @brief Restores the accepted and rejected views of each Policy.
+    /// @param file HDF5 file to read Policy data from.
+    void loadPolicies(const HighFive::File& file)
+    {
+        this->policy_total_views = 0;
+        for (const auto& policy : this->policy_vec)
+        {
+            policy->load(file);
+            this->policy_total_views += policy->numAccepted() + policy->numRejected();
+        }
+        if (file.exist(FS_HDF5_POLICY_GROUP))
+        {
+            auto g_policy = file.getGroup(FS_HDF5_POLICY_GROUP);
+            if (g_policy.hasAttribute("active"))
+            {
+                this->policySetActive(g_policy.getAttribute("active").read<size_t>());
+            }
+        }
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                              PRIVATE RECONSTRUCTION METHODS                           * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Meshes the blocks of the surface changed since it was last meshed.
+    /// @return The mesh of each block, which may be read once the update lock is released.
+    /// @throws std::runtime_error If `reconstructionEnableSurface` was not called.
+    data::SurfaceMesh::BlockList updateSurface()
+    {
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        if (!this->surface)
+        {
+            throw std::runtime_error("No surface is kept. Call reconstructionEnableSurface first.");
+        }
+        this->surface->update();
+        return this->surface->getBlocks();
+    }
+
+
+    /// @brief Moves the Reconstruction's window to centre on a position, along each axis on which
+    ///        the position is further than the rolling margin from the window's centre.
+    /// @param position Position of the sensor, in the Reconstruction's starting frame.
+    /// @note  The caller must hold the update lock. Nothing is done unless the Manager is rolling.
+    ///        See `reconstructionSetRolling`.
+    void rollWindow(const Point& position)
+    {
+        if (this->rolling_margin < 0)
+        {
+            return;
+        }
+        const Grid::Properties& properties = *this->grid_properties;
+        std::unique_lock<std::recursive_mutex> hdf5_lock(utilities::hdf5Mutex(), std::defer_lock);
+        HighFive::Group g_evicted;
+        if (this->evict_file)
+        {
+            hdf5_lock.lock();
+            g_evicted = this->evict_file->getGroup("/");
+        }
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            const float centre = (this->reconstruction->getWindowOffset()[axis] +
+                                  0.5f * static_cast<float>(properties.size[axis])) * properties.resolution;
+            const float dist   = position[axis] - centre;
+            if (std::abs(dist) > this->rolling_margin)
+            {
+                const int steps = static_cast<int>(std::round(dist / properties.resolution));
+                this->reconstruction->shiftWindow(axis, steps, this->evict_file ? &g_evicted : nullptr,
+                                                  this->dataset_options);
+                if (this->surface)
+                {
+                    this->surface->markAll();
+                }
+            }
+        }
+    }
+
+
+    /// @brief Moves a pose from the Reconstruction's starting frame into its window.
+    /// @param extr Pose in the starting frame.
+    /// @return The pose, relative to the Reconstruction's frame once its window has moved. This is
+    ///         the same pose unless the Manager is rolling. See `reconstructionSetRolling`.
+    Extrinsic toWindow(const Extrinsic& extr) const
+    {
+        Extrinsic window = extr;
+        window.translation() -= this->reconstruction->getWindowOffset().cast<float>() *
+                                this->grid_properties->resolution;
+        return window;
+    }
+
+
+    /// @brief Updates the Reconstruction with the Points deprojected from a depth image.
+    /// @param sensed Points of the depth image.
+    /// @param image Depth image, for the projective update.
+    /// @param intr  Intrinsics of the depth image.
+    /// @param extr  Pose of the depth image, relative to the Reconstruction's frame.
+    /// @param relative If true the Points are relative to `extr`, so the Metrics are given them and
+    ///                 then they are transformed in-place. Otherwise they are already in the
+    ///                 Reconstruction's frame, which may only be the case when there are no Metrics.
+    /// @note  The caller must hold the update lock.
+    void integrate(PointMatrix& sensed, const DepthImage& image, const sensor::Intrinsics& intr,
+                   const Extrinsic& extr, const bool& relative)
+    {
+        if (relative)
+        {
+            this->preUpdate(sensed, extr);
+            Manager::transformInPlace(sensed, extr);
+        }
+        this->reconstruction->update(sensed, image, intr, extr);
+        this->postUpdate();
+    }
+
+
+    /// @brief Body of each ingestion thread. Integrates frames until the queue is closed and empty.
+    /// @param intr Intrinsics of the frames.
+    void ingestRun(const std::shared_ptr<const sensor::Intrinsics>& intr)
+    {
+        try
+        {
+            // The frame's image is swapped into the Camera, so the frame may be reused by the
+            // sensor while this thread deprojects and integrates it.
+            std::shared_ptr<sensor::Camera> camera = sensor::Camera::create(intr);
+            PointMatrix sensed;
+            while (true)
+            {
+                // Frames are numbered in the order they leave the queue, which is the order they
+                // were pushed, and integrated in that order.
+                sensor::FrameQueue::Frame* frame = nullptr;
+                size_t sequence = 0;
+                {
+                    std::lock_guard<std::mutex> lock(this->ingest_pop_mutex);
+                    frame = this->ingest_queue->pop();
+                    sequence = this->ingest_next_pop++;
+                }
+                if (frame == nullptr)
+                {
+                    break;
+                }
+                camera->image.swap(frame->image);
+                const Extrinsic extr = frame->extr;
+                const sensor::FrameQueue::Clock::time_point arrival = frame->arrival;
+                this->ingest_queue->release(frame);
+
+                // A rolling window may move before this thread holds the lock, so the Points are
+                // then only moved into the Reconstruction's frame once it does.
+                const bool relative = !this->metrics_map.empty() || this->rolling_margin >= 0;
+                camera->getPointMatrix(sensed, relative ? Extrinsic::Identity() : extr, this->ingest_stride, true);
+
+                std::unique_lock<std::mutex> lock(this->update_mutex);
+                this->ingest_turn.wait(lock, [this, sequence]()
+                {
+                    return this->ingest_next_integrate == sequence || this->ingest_error != nullptr;
+                });
+                if (this->ingest_error != nullptr)
+                {
+                    break;
+                }
+                {
+                    FS_PROFILE_SCOPE(MANAGER_UPDATE, nullptr);
+                    this->rollWindow(extr.translation());
+                    this->integrate(sensed, camera->getImage(), *intr, this->toWindow(extr), relative);
+                }
+                const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                    sensor::FrameQueue::Clock::now() - arrival).count();
+                this->recordIngestLatency(1e-3 * static_cast<double>(latency));
+                FS_PROFILE_COUNT(INGEST_LATENCY_US, static_cast<uint64_t>(latency));
+                FS_PROFILE_RECORD(this->reconstruction_update_count);
+                ++this->reconstruction_update_count;
+                ++this->ingest_next_integrate;
+                this->ingest_turn.notify_all();
+            }
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->update_mutex);
+                this->ingest_error = std::current_exception();
+            }
+            this->ingest_turn.notify_all();
+            this->ingest_queue->close();
+        }
+    }
+
+
+    /// @brief Adds the latency of an integrated frame to the ingestion statistics.
+    /// @param latency_ms Time from the frame's arrival to the end of its integration.
+    /// @note  The caller must hold the update lock.
+    void recordIngestLatency(const double& latency_ms)
+    {
+        IngestStats& stats = this->ingest_stats;
+        ++stats.integrated;
+        stats.latency_last_ms = latency_ms;
+        stats.latency_max_ms  = std::max(stats.latency_max_ms, latency_ms);
+        stats.latency_mean_ms += (latency_ms - stats.latency_mean_ms) / static_cast<double>(stats.integrated);
+    }
+
+
+    /// @brief Rethrows the exception of an ingestion thread, if one threw.
+    /// @param clear If true the exception is cleared. This may only be done once the ingestion
+    ///              threads are joined: those still waiting for their turn are only released by
+    ///              seeing the exception, so clearing it sooner leaves them waiting forever.
+    void rethrowIfIngestFailed(const bool& clear)
+    {
+        std::lock_guard<std::mutex> lock(this->update_mutex);
+        if (this->ingest_error)
+        {
+            std::exception_ptr error = this->ingest_error;
+            if (clear)
+            {
+                this->ingest_error = nullptr;
+            }
+            std::rethrow_exception(error);
+        }
+    }
+
+
 
     // ***************************************************************************************** //
     // *                                 PRIVATE METIC METHODS                                 * //
     // ***************************************************************************************** //
 
 
+    /// @brief Transforms each Point of a matrix without allocating a temporary matrix.
+    /// @param [in, out] points Points to transform.
+    /// @param extr Transformation to apply.
+    static void transformInPlace(PointMatrix& points, const Extrinsic& extr)
+    {
+        const Eigen::Matrix3f rotation    = extr.rotation();
+        const Eigen::Vector3f translation = extr.translation();
+        for (auto point : points.colwise())
+        {
+            point = rotation * point + translation;
+        }
+    }
+
+
     /// @brief Calls the preUpdate method for each metric.
     /// @param sensed The sensed points passed to `reconstructionUpdate`.
     /// @param extr   The reference frame and common origin for the `sensed` points passed to
@@ -431,11 +1427,17 @@ private:
     }
 
 
-    /// @brief Calls the postUpdate method for each metric.
+    /// @brief Calls the postUpdate method for each metric, and marks the blocks of the surface
+    ///        mesh the update changed.
     void postUpdate()
     {
+        if (this->surface)
+        {
+            this->surface->markUpdated();
+        }
         for (auto& dict_item : this->metrics_map)
         {
+            FS_PROFILE_SCOPE(METRIC_UPDATE, dict_item.first.c_str());
             dict_item.second->postUpdate(this->reconstructionGetUpdateCount());
         }
     }
@@ -452,6 +1454,17 @@ private:
     }
 
 
+    /// @brief Restores the data for each metric.
+    /// @param file HDF5 file to read Metric data from.
+    void loadMetrics(const HighFive::File& file)
+    {
+        for (const auto& dict_item : this->metrics_map)
+        {
+            dict_item.second->load(file);
+        }
+    }
+
+
 
     // ***************************************************************************************** //
     // *                                 PRIVATE CLASS MEMBERS                                 * //
@@ -459,7 +1472,14 @@ private:
 
 
     /// @brief Counts the number of times that the update function has been called.
-    size_t reconstruction_update_count = 0;
+    /// @note  Atomic so it may be read while frames are integrated in the background.
+    std::atomic<size_t> reconstruction_update_count{0};
+
+    /// @brief Points of the most recent Camera update. Reused between updates.
+    PointMatrix sensed_buffer;
+
+    /// @brief Points of each camera of the most recent rig update. Reused between updates.
+    std::vector<PointMatrix> rig_buffers;
 
     /// @brief Counts the total views accepted/rejected across all Policies.
     size_t policy_total_views = 0;
@@ -474,9 +1494,93 @@ private:
     /// @brief Map of Metric type names to Metric. A map ensures we check if a metric exists before
     ///        it is added.
     std::map<std::string, std::shared_ptr<metrics::Metric>> metrics_map;
+
+    /// @brief Chunking and compression used by `save`. Default writes uncompressed data sets.
+    utilities::DataSetOptions dataset_options;
+
+    /// @brief Distance the sensor may move from the centre of the Reconstruction's window before it
+    ///        moves, or negative if the window does not move. See `reconstructionSetRolling`.
+    float rolling_margin = -1;
+
+    /// @brief File the voxels leaving a rolling window are written to, if any.
+    std::unique_ptr<HighFive::File> evict_file;
+
+    /// @brief Mesh of the surface in a TSDF channel, if one is kept. See `reconstructionEnableSurface`.
+    std::shared_ptr<data::SurfaceMesh> surface;
+
+    /// @brief Held by updates, saving, loading and the Policy methods so each sees the Reconstruction
+    ///        between whole updates.
+    mutable std::mutex update_mutex;
+
+    /// @brief Frames waiting to be integrated, and the threads integrating them. Only set between
+    ///        `ingestStart` and `ingestStop`.
+    std::unique_ptr<sensor::FrameQueue> ingest_queue;
+    std::vector<std::thread> ingest_threads;
+
+    /// @brief Stride used to deproject the ingested frames.
+    size_t ingest_stride = 1;
+
+    /// @brief Counts and latencies of the ingested frames. Guarded by the update lock.
+    IngestStats ingest_stats;
+
+    /// @brief Exception thrown by an ingestion thread. Guarded by the update lock. Kept until
+    ///        `ingestStop` has joined the ingestion threads, as it is what releases them.
+    std::exception_ptr ingest_error;
+
+    /// @brief Taken by the ingestion threads to pop a frame and number it, so the numbers follow
+    ///        the order of the queue.
+    std::mutex ingest_pop_mutex;
+
+    /// @brief Number of the next frame to pop. Guarded by `ingest_pop_mutex`.
+    size_t ingest_next_pop = 0;
+
+    /// @brief Number of the next frame to integrate. Guarded by the update lock.
+    size_t ingest_next_integrate = 0;
+
+    /// @brief Notified, with the update lock, when a frame is integrated or an ingestion thread fails.
+    std::condition_variable ingest_turn;
+
+    /// @brief A request of `saveAsync` waiting to be written.
+    struct SaveRequest
+    {
+        std::filesystem::path fpath;
+        std::promise<std::filesystem::path> promise;
+        std::shared_future<std::filesystem::path> future;
+    };
+
+    /// @brief Requests of `saveAsync` waiting to be written, in order. Guarded by the save lock.
+    std::list<SaveRequest> save_requests;
+
+    /// @brief Guards the save requests, and signals the save thread when one is added.
+    std::mutex save_mutex;
+    std::condition_variable save_cv;
+
+    /// @brief Thread writing the save requests, started by the first one.
+    std::thread save_thread;
+
+    /// @brief Set to stop the save thread once no requests are left. Guarded by the save lock.
+    bool save_stop = false;
+
+    /// @brief Copy of the Reconstruction as the save thread last wrote it, and the file it was
+    ///        written to. Only used by the save thread.
+    std::shared_ptr<data::Checkpoint> checkpoint;
+    std::filesystem::path checkpoint_fpath;
 };
 
 
+/// @brief ArgParser key for the number of frames which may wait to be integrated.
+const std::string Manager::parse_queue_capacity = "--queue-capacity";
+
+/// @brief ArgParser key for the number of threads integrating frames.
+const std::string Manager::parse_n_ingest_threads = "--n-ingest-threads";
+
+/// @brief ArgParser key for what `ingestFrame` does when the queue is full.
+const std::string Manager::parse_overflow = "--overflow";
+
+/// @brief ArgParser key for the stride used to deproject the ingested frames.
+const std::string Manager::parse_stride = "--stride";
+
+
 } // namespace forge_scan
 
 
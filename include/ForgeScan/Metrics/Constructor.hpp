@@ -4,6 +4,7 @@
 #include <memory>
 
 #include "ForgeScan/Metrics/OccupancyConfusion.hpp"
+#include "ForgeScan/Metrics/TSDFError.hpp"
 #include "ForgeScan/Utilities/Strings.hpp"
 
 
@@ -30,6 +31,11 @@ struct Constructor
             throw std::invalid_argument("The Metric type of " + OccupancyConfusion::type_name +
                                         "  requires ground-truth information that this method cannot parse.");
         }
+        if (iequals(metric_type, TSDFError::type_name))
+        {
+            throw std::invalid_argument("The Metric type of " + TSDFError::type_name +
+                                        "  requires ground-truth information that this method cannot parse.");
+        }
 
         throw ConstructorError::UnkownType(metric_type, "Metric");
     }
@@ -46,9 +52,13 @@ struct Constructor
         {
             return OccupancyConfusion::helpMessage();
         }
+        if (iequals(metric_type, TSDFError::type_name))
+        {
+            return TSDFError::helpMessage();
+        }
         std::stringstream ss;
         ss << Metric::helpMessage() << "\nPossible Metrics are: "
-           << OccupancyConfusion::type_name;
+           << OccupancyConfusion::type_name << ", " << TSDFError::type_name;
         return ss.str();
     }
 };
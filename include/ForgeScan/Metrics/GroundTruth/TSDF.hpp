@@ -1,14 +1,20 @@
 #ifndef FORGE_SCAN_METRICS_GROUND_TRUTH_TSDF_HPP
 #define FORGE_SCAN_METRICS_GROUND_TRUTH_TSDF_HPP
 
+#include <cmath>
+
 #include "ForgeScan/Common/Grid.hpp"
+#include "ForgeScan/Common/Quantizer.hpp"
+#include "ForgeScan/Common/VoxelData.hpp"
+#include "ForgeScan/Utilities/HDF5.hpp"
+#include "ForgeScan/Utilities/Threads.hpp"
 
 
 namespace forge_scan {
 namespace metrics {
 
     // Forward definition to allow friend access.
-    /// TODO: Create the Metric which uses this.
+    class TSDFError;
 
 } // namespace metrics
 
@@ -27,13 +33,59 @@ namespace metrics {
 namespace ground_truth {
 
 
+/// @brief Stores the error between the distances of a Ground Truth TSDF Grid and an
+///        experimentally collected TSDF VoxelGrid.
+struct DistanceError
+{
+    /// @brief Sets all values to zero.
+    void reset()
+    {
+        this->sum_squared  = 0;
+        this->sum_absolute = 0;
+        this->n = 0;
+    }
+
+
+    /// @brief Adds the sums of another DistanceError to this one.
+    DistanceError& operator+=(const DistanceError& other)
+    {
+        this->sum_squared  += other.sum_squared;
+        this->sum_absolute += other.sum_absolute;
+        this->n += other.n;
+        return *this;
+    }
+
+
+    /// @return Root mean squared error. Zero if no voxels were compared.
+    double getRMSE() const
+    {
+        return this->n > 0 ? std::sqrt(this->sum_squared / this->n) : 0.0;
+    }
+
+
+    /// @return Mean absolute error. Zero if no voxels were compared.
+    double getMAE() const
+    {
+        return this->n > 0 ? this->sum_absolute / this->n : 0.0;
+    }
+
+
+    /// @brief Sum of the squared errors.
+    double sum_squared = 0;
+
+    /// @brief Sum of the absolute errors.
+    double sum_absolute = 0;
+
+    /// @brief Number of voxels compared.
+    size_t n = 0;
+};
+
 
 /// @brief Stores a ground truth for the voxel TSDF of a Scene.
 class TSDF : public Grid
 {
     /// @details Required to call the compare method.
-    /// TODO: Create the Metric which uses this.
-    /// friend class metrics::OccupancyConfusion;
+    friend class metrics::TSDFError;
 
     /// @details Required to modify values in the grid.
     friend struct simulation::Scene;
@@ -73,35 +125,34 @@ public:
     }
 
 
-    static const std::string type_name;
-
-protected:
-
-    /// @brief Compares the ground truth to another vector
-    /// @param experiment Vector of experimentally collected data to compare.
-    /// @return True of the vectors were the same size and the comparison was performed.
-    bool compare(const std::vector<double>& experiment) const
+    /// @brief Gets the ground truth data, in the layout of the Grid Properties.
+    /// @note  This is the X-major linear order unless the Properties use bricks. See
+    ///        `Grid::Properties::toLinearOrder`.
+    const std::vector<double>& getData() const
     {
-        const size_t n = this->data.size();
-        if (experiment.size() != n)
-        {
-            return false;
-        }
-
-        for (size_t i = 0; i < n; ++i)
-        {
-            /// TODO: Decide how to compare.
-            // double measurement = other[i];
-            // double truth  = this->data[i];
-        }
-        return true;
+        return this->data;
     }
 
 
-    //// @brief Compares the ground truth to another vector
-    /// @param experiment Vector of experimentally collected data to compare.
+    static const std::string type_name;
+
+protected:
+
+    /// @brief Compares the ground truth to the distances of an experimental TSDF.
+    /// @param experiment Data vector of the experiment. Either a `std::vector`, a `SparseVector` or a
+    ///                   `MappedVector`, in the same layout as the ground truth.
+    /// @param quantizer  Encoding of the experiment's stored values.
+    /// @param unmeasured Stored value of voxels the experiment has not measured. These are skipped.
+    /// @param dist_min Lower bound of the experiment's truncation band.
+    /// @param dist_max Upper bound of the experiment's truncation band.
+    /// @param [out] error Reference to a DistanceError struct to store the results in.
+    /// @param n_threads Number of threads to compare with. Each takes one contiguous slab of voxels.
     /// @return True of the vectors were the same size and the comparison was performed.
-    bool compare(const std::vector<float>& experiment) const
+    /// @note  Only voxels whose true distance is within the band are compared, as only those have
+    ///        a measurable distance.
+    template <typename Vector>
+    bool compare(const Vector& experiment, const Quantizer& quantizer, const typename Vector::value_type& unmeasured,
+                 const float& dist_min, const float& dist_max, DistanceError& error, const size_t& n_threads = 1) const
     {
         const size_t n = this->data.size();
         if (experiment.size() != n)
@@ -109,23 +160,30 @@ protected:
             return false;
         }
 
-        for (size_t i = 0; i < n; ++i)
-        {
-            /// TODO: Decide how to compare.
-            // double measurement = other[i];
-            // double truth  = this->data[i];
-
-        }
+        const auto& values = getElements(experiment);
+        error = utilities::parallelReduce<DistanceError>(n, n_threads, TSDF::min_voxels_per_thread,
+            [&](const size_t& first, const size_t& last)
+            {
+                return TSDF::count(this->data.data(), values, quantizer, unmeasured, dist_min, dist_max, first, last);
+            });
         return true;
     }
 
 
     /// @brief Writes the Grid's data vector to the provided HDF5 group.
     /// @param group Group in the opened HDF5 file.
+    /// @param options Chunking and compression for the data set.
     /// @return DataSet Object.
-    HighFive::DataSet save(HighFive::Group& group) const
+    /// @note  The data is written in the linear order so saved files do not depend on the layout.
+    HighFive::DataSet save(HighFive::Group& group,
+                           const utilities::DataSetOptions& options = utilities::DataSetOptions()) const
     {
-        return group.createDataSet(this->getTypeName(), this->data);
+        if (this->properties->isLinear())
+        {
+            return options.createDataSet(group, this->getTypeName(), this->data, this->properties->size);
+        }
+        return options.createDataSet(group, this->getTypeName(), this->properties->toLinearOrder(this->data),
+                                     this->properties->size);
     }
 
 
@@ -156,6 +214,9 @@ protected:
     /// @brief Ground truth data.
     std::vector<double> data;
 
+    /// @brief Fewest voxels `compare` gives each thread.
+    static constexpr size_t min_voxels_per_thread = size_t(1) << 18;
+
 
 private:
     /// @brief Private constructor to enforce use of shared pointers.
@@ -185,6 +246,36 @@ private:
         }
         this->data.swap(data);
     }
+
+
+    /// @brief Sums the error of the voxels `[first, last)`.
+    /// @param truth Ground truth distances.
+    /// @param values Stored values of the experiment. Either a pointer or a `SparseVector`.
+    /// @param quantizer Encoding of the stored values.
+    /// @param unmeasured Stored value of voxels the experiment has not measured.
+    /// @param dist_min Lower bound of the truncation band.
+    /// @param dist_max Upper bound of the truncation band.
+    /// @param first Vector index of the first voxel to compare.
+    /// @param last  Vector index one past the last voxel to compare.
+    /// @return Error of the voxels.
+    /// @note  The loop is branch-free. Floating point sums are not reordered, so it is not
+    ///        vectorized, but slabs are summed on separate threads by `compare`.
+    template <typename Values, typename T>
+    static DistanceError count(const double* truth, const Values& values, const Quantizer quantizer, const T unmeasured,
+                               const double dist_min, const double dist_max, const size_t first, const size_t last)
+    {
+        DistanceError error;
+        for (size_t i = first; i < last; ++i)
+        {
+            const T stored = values[i];
+            const bool compared = (stored != unmeasured) & (truth[i] >= dist_min) & (truth[i] <= dist_max);
+            const double e = compared ? static_cast<double>(quantizer.decode(stored)) - truth[i] : 0.0;
+            error.sum_squared  += e * e;
+            error.sum_absolute += std::abs(e);
+            error.n += compared;
+        }
+        return error;
+    }
 };
 
 
@@ -8,6 +8,7 @@
 #include "ForgeScan/Common/Types.hpp"
 #include "ForgeScan/Data/Reconstruction.hpp"
 #include "ForgeScan/Utilities/ArgParser.hpp"
+#include "ForgeScan/Utilities/MemoryUse.hpp"
 
 
 namespace forge_scan {
@@ -43,6 +44,16 @@ public:
         return "TODO: Metric help message";
     }
 
+    /// @brief Calculates how much space the Metric is using for the data it records and the ground
+    ///        truth it compares against.
+    /// @return Memory used by the Metric. Channels it added to the `data::Reconstruction` are counted
+    ///         by `data::Reconstruction::getMemoryReport` instead. By default nothing is used.
+    virtual utilities::memory_use::Usage getMemoryUsage() const
+    {
+        return utilities::memory_use::Usage{};
+    }
+
+
     static const std::string parse_type;
 
     static const std::string type_name;
@@ -114,6 +125,15 @@ protected:
     }
 
 
+    /// @brief Restores the data stored by the Metric from an HDF5 file written by `save`.
+    /// @param file HDF5 file to read from.
+    /// @note  By default nothing is restored.
+    virtual void load([[maybe_unused]] const HighFive::File& file)
+    {
+
+    }
+
+
 
     // ***************************************************************************************** //
     // *                            PROTECTED PURE VIRTUAL METHODS                             * //
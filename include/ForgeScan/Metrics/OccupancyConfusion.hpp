@@ -1,6 +1,7 @@
 #ifndef FORGE_SCAN_METRICS_OCCUPANCY_CONFUSION_HPP
 #define FORGE_SCAN_METRICS_OCCUPANCY_CONFUSION_HPP
 
+#include <list>
 #include <sstream>
 
 #include "ForgeScan/Common/Definitions.hpp"
@@ -14,6 +15,13 @@ namespace forge_scan {
 namespace metrics {
 
 
+/// @brief Records the Confusion Matrix between the occupancy of a `data::Reconstruction` channel
+///        and a ground truth Occupancy Grid after each update.
+/// @details The Confusion is kept up to date incrementally. The Metric stores the channel's
+///          occupancy data from the last update and, after each new update, only re-reads and
+///          re-compares the blocks of voxels the update traced. See
+///          `data::Reconstruction::getUpdatedData`. If the Metric missed an update, or the ground
+///          truth changed, then the whole Grid is compared again.
 class OccupancyConfusion : public Metric
 {
 public:
@@ -50,12 +58,26 @@ public:
         if (this->reconstruction->grid_properties->isEqual(ground_truth->properties))
         {
             this->ground_truth = ground_truth;
+            this->occupancy_data.clear();
             return true;
         }
         return false;
     }
 
 
+    /// @brief Calculates how much space the Metric is using for its list of Confusion Matrix data,
+    ///        its copy of the experiment's occupancy and the ground truth.
+    utilities::memory_use::Usage getMemoryUsage() const override final
+    {
+        using namespace utilities::memory_use;
+        const size_t n_list = list_size(this->confusion_list);
+        return Usage{n_list + vector_size(this->occupancy_data) + vector_size(this->previous_block) +
+                     vector_size(this->ground_truth->data),
+                     n_list + vector_capacity(this->occupancy_data) + vector_capacity(this->previous_block) +
+                     vector_capacity(this->ground_truth->data)};
+    }
+
+
     /// @return Help message for constructing a OccupancyConfusion with ArgParser.
     static std::string helpMessage()
     {
@@ -64,6 +86,28 @@ public:
     }
 
 
+    /// @brief Transforms the list of Confusion Matrix data into an Eigen matrix so it may be saved
+    ///        in an HDF5 file.
+    /// @return An Eigen matrix containing the data stored in the Confusion Matrix list.
+    Eigen::Matrix<size_t, -1, -1> getConfusionAsMatrix() const
+    {
+        Eigen::Matrix<size_t, -1, -1> mat;
+        mat.resize(this->confusion_list.size(), 6);
+        size_t n = 0;
+        for (const auto& item: this->confusion_list)
+        {
+            mat(n, 0) = item.second;
+            mat(n, 1) = item.first.tp;
+            mat(n, 2) = item.first.tn;
+            mat(n, 3) = item.first.fp;
+            mat(n, 4) = item.first.fn;
+            mat(n, 5) = item.first.uk;
+            ++n;
+        }
+        return mat;
+    }
+
+
     static const std::string type_name;
 
 
@@ -103,6 +147,7 @@ protected:
             auto voxel_grid = this->reconstruction->getChannelView(use_channel);
             this->experiment = ground_truth::dynamic_cast_to_experimental_occupancy(voxel_grid);
         }
+        this->reconstruction->enableUpdateTracking();
     }
 
 
@@ -116,28 +161,6 @@ protected:
     }
 
 
-    /// @brief Transforms the list of Confusion Matrix data into an Eigen matrix so it may be saved
-    ///        in an HDF5 file.
-    /// @return An Eigen matrix containing the data stored in the Confusion Matrix list.
-    Eigen::Matrix<size_t, -1, -1> getConfusionAsMatrix() const
-    {
-        Eigen::Matrix<size_t, -1, -1> mat;
-        mat.resize(this->confusion_list.size(), 6);
-        size_t n = 0;
-        for (const auto& item: this->confusion_list)
-        {
-            mat(n, 0) = item.second;
-            mat(n, 1) = item.first.tp;
-            mat(n, 2) = item.first.tn;
-            mat(n, 3) = item.first.fp;
-            mat(n, 4) = item.first.fn;
-            mat(n, 5) = item.first.uk;
-            ++n;
-        }
-        return mat;
-    }
-
-
     /// @brief Verifies that the Grid Properties of the Reconstruction match those of the
     ///        ground truth data.
     /// @throws GridPropertyError if the ground truth Occupancy Grid Properties are not equal.
@@ -159,14 +182,36 @@ protected:
 
     void postUpdate(const size_t& update_count) override final
     {
-        this->confusion_list.push_back({ground_truth::Confusion(), update_count});
+        const size_t n_updates = this->reconstruction->getNumUpdates();
+        auto updated = this->reconstruction->getUpdatedData();
 
-        auto get_occupancy_data = [](auto&& experiment){
-            return experiment->getOccupancyData();
-        };
+        if (this->occupancy_data.empty() || n_updates != this->last_n_updates + 1 || updated == nullptr)
+        {
+            // Fills the existing buffer, so only the first comparison allocates.
+            auto get_occupancy_data = [this](auto&& experiment){
+                experiment->getOccupancyData(this->occupancy_data);
+            };
+            std::visit(get_occupancy_data, this->experiment);
+            this->ground_truth->compare(this->occupancy_data, this->confusion, this->reconstruction->getNumThreads());
+        }
+        else
+        {
+            updated->forEachDirtyBlock([&](const size_t& first, const size_t& last)
+            {
+                this->previous_block.assign(this->occupancy_data.begin() + first,
+                                            this->occupancy_data.begin() + last);
+
+                auto get_occupancy_data = [&](auto&& experiment){
+                    experiment->getOccupancyData(this->occupancy_data, first, last);
+                };
+                std::visit(get_occupancy_data, this->experiment);
+                this->ground_truth->compareChanged(this->occupancy_data, this->previous_block,
+                                                   first, last, this->confusion);
+            });
+        }
 
-        this->ground_truth->compare(std::visit(get_occupancy_data, this->experiment),
-                                    this->confusion_list.back().first);
+        this->last_n_updates = n_updates;
+        this->confusion_list.push_back({this->confusion, update_count});
     }
 
 
@@ -181,6 +226,35 @@ protected:
     }
 
 
+    /// @note The next update compares the whole Grid, rather than only the voxels it changed.
+    void load(const HighFive::File& file) override final
+    {
+        const std::string hdf5_data_path = getDatasetPathHDF5(this->map_name);
+        if (!file.exist(hdf5_data_path))
+        {
+            return;
+        }
+        const auto mat = H5Easy::load<Eigen::Matrix<size_t, -1, -1>>(file, hdf5_data_path);
+
+        this->confusion_list.clear();
+        for (Eigen::Index n = 0; n < mat.rows(); ++n)
+        {
+            ground_truth::Confusion confusion;
+            confusion.tp = mat(n, 1);
+            confusion.tn = mat(n, 2);
+            confusion.fp = mat(n, 3);
+            confusion.fn = mat(n, 4);
+            confusion.uk = mat(n, 5);
+            this->confusion_list.push_back({confusion, mat(n, 0)});
+        }
+        if (!this->confusion_list.empty())
+        {
+            this->confusion = this->confusion_list.back().first;
+        }
+        this->occupancy_data.clear();
+    }
+
+
     const std::string& getTypeName() const override final
     {
         return OccupancyConfusion::type_name;
@@ -204,6 +278,19 @@ protected:
 
     /// @brief Reference to the Reconstruction VoxelGrid that this Metric uses.
     ground_truth::ExperimentOccupancy experiment;
+
+    /// @brief Occupancy data of the experiment as of the last call to `postUpdate`. Empty if the
+    ///        whole Grid must be compared on the next call.
+    std::vector<uint8_t> occupancy_data;
+
+    /// @brief Confusion between `occupancy_data` and the ground truth.
+    ground_truth::Confusion confusion;
+
+    /// @brief Reconstruction update count as of the last call to `postUpdate`.
+    size_t last_n_updates = 0;
+
+    /// @brief Occupancy data of one block before it is re-read. Reused between blocks.
+    std::vector<uint8_t> previous_block;
 };
 
 
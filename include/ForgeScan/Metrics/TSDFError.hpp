@@ -0,0 +1,260 @@
+#ifndef FORGE_SCAN_METRICS_TSDF_ERROR_HPP
+#define FORGE_SCAN_METRICS_TSDF_ERROR_HPP
+
+#include <list>
+#include <sstream>
+
+#include "ForgeScan/Common/Definitions.hpp"
+
+#include "ForgeScan/Metrics/Metric.hpp"
+#include "ForgeScan/Metrics/GroundTruth/ExperimentVariants.hpp"
+#include "ForgeScan/Metrics/GroundTruth/TSDF.hpp"
+
+
+namespace forge_scan {
+namespace metrics {
+
+
+/// @brief Records the error between the distances of a `data::Reconstruction` TSDF channel and a
+///        ground truth TSDF Grid after each update.
+/// @details The mean absolute error and root mean squared error are found over the voxels which the
+///          channel has measured and whose true distance is within the channel's truncation band.
+///          See `ground_truth::TSDF::compare`. The whole Grid is compared after each update, split
+///          into slabs across the `data::Reconstruction`'s threads.
+class TSDFError : public Metric
+{
+public:
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Creates a TSDFError Metric.
+    /// @param reconstruction Shared pointer to the `data::Reconstruction` that the Metric observes.
+    /// @param ground_truth   The `ground_truth::TSDF` Grid to compare `data::Reconstruction` data against.
+    /// @param use_channel    The name of the `data::Reconstruction` channel to use. If this is an empty
+    ///                       string then a default `data::TSDF` `data::VoxelGrid` is created.
+    /// @return Shared pointer to a TSDFError Metric.
+    /// @throws GridPropertyError if the `ground_truth::TSDF` `Grid::Properties` are not equal
+    ///                           to those of the `data::Reconstruction`.
+    /// @throws BadVoxelGridDownCast if the channel from `use_channel` may not be cast to one of
+    ///                              the supported `ground_truth::ExperimentTSDF` types.
+    static std::shared_ptr<TSDFError> create(const std::shared_ptr<data::Reconstruction>& reconstruction,
+                                             const std::shared_ptr<const ground_truth::TSDF>& ground_truth,
+                                             const std::string& use_channel = "")
+    {
+        return std::shared_ptr<TSDFError>(new TSDFError(reconstruction, ground_truth, use_channel));
+    }
+
+
+    /// @brief Changes what ground truth the class uses.
+    /// @param ground_truth The `ground_truth::TSDF` Grid to compare Reconstruction data against.
+    /// @returns True if the ground truth was changed. False if the `Grid::Properties` were not equal
+    ///          to those of the `data::Reconstruction` and the ground truth was not changed.
+    bool setGroundTruth(const std::shared_ptr<const ground_truth::TSDF>& ground_truth)
+    {
+        if (this->reconstruction->grid_properties->isEqual(ground_truth->properties))
+        {
+            this->ground_truth = ground_truth;
+            return true;
+        }
+        return false;
+    }
+
+
+    /// @brief Calculates how much space the Metric is using for its list of error data and the
+    ///        ground truth.
+    utilities::memory_use::Usage getMemoryUsage() const override final
+    {
+        using namespace utilities::memory_use;
+        const size_t n_list = list_size(this->error_list);
+        return Usage{n_list + vector_size(this->ground_truth->data),
+                     n_list + vector_capacity(this->ground_truth->data)};
+    }
+
+
+    /// @return Help message for constructing a TSDFError with ArgParser.
+    static std::string helpMessage()
+    {
+        return "A TSDFError Metric requires a ground truth TSDF and is constructed through code. It records "
+               "the mean absolute and root mean squared error of a TSDF channel after each update.";
+    }
+
+
+    /// @brief Transforms the list of errors into an Eigen matrix so it may be saved in an HDF5 file.
+    /// @return An Eigen matrix with a row for each update: the update, the number of voxels
+    ///         compared, the mean absolute error, and the root mean squared error.
+    Eigen::MatrixXd getErrorAsMatrix() const
+    {
+        Eigen::MatrixXd mat;
+        mat.resize(this->error_list.size(), 4);
+        size_t n = 0;
+        for (const auto& item: this->error_list)
+        {
+            mat(n, 0) = static_cast<double>(item.second);
+            mat(n, 1) = static_cast<double>(item.first.n);
+            mat(n, 2) = item.first.getMAE();
+            mat(n, 3) = item.first.getRMSE();
+            ++n;
+        }
+        return mat;
+    }
+
+
+    static const std::string type_name;
+
+
+protected:
+    // ***************************************************************************************** //
+    // *                               PROTECTED CLASS METHODS                                 * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Private constructor to enforce use of shared pointers.
+    /// @param reconstruction Shared pointer to the `data::Reconstruction` that the Metric observes.
+    /// @param ground_truth   The `ground_truth::TSDF` Grid to compare `data::Reconstruction` data against.
+    /// @param use_channel    The name of the `data::Reconstruction` channel to use. If this is an empty
+    ///                       string then a default `data::TSDF` `data::VoxelGrid` is created.
+    /// @throws GridPropertyError if the ground truth TSDF Grid Properties are not equal
+    ///                           to those of the Reconstruction.
+    /// @throws BadVoxelGridDownCast if the channel from `use_channel` may not be cast to one of
+    ///                              the supported `ground_truth::ExperimentTSDF` types.
+    explicit TSDFError(const std::shared_ptr<data::Reconstruction>& reconstruction,
+                       const std::shared_ptr<const ground_truth::TSDF>& ground_truth,
+                       const std::string& use_channel = "")
+        : Metric(reconstruction,
+                 TSDFError::getMapName(use_channel)),
+          channel_name(FS_METRIC_CHANNEL_PREFIX + TSDFError::type_name),
+          ground_truth(ground_truth)
+    {
+        this->throwIfGridPropertiesDoNotMatch();
+        if (use_channel.empty())
+        {
+            auto voxel_grid = data::TSDF::create(this->reconstruction->grid_properties);
+            this->addChannel(voxel_grid, channel_name);
+            this->experiment = voxel_grid;
+        }
+        else
+        {
+            auto voxel_grid = this->reconstruction->getChannelView(use_channel);
+            this->experiment = ground_truth::dynamic_cast_to_experimental_tsdf(voxel_grid);
+        }
+    }
+
+
+    static std::string getMapName(const std::string& use_channel)
+    {
+        if (use_channel.empty())
+        {
+            return TSDFError::type_name;
+        }
+        return TSDFError::type_name + "_" + use_channel;
+    }
+
+
+    /// @brief Verifies that the Grid Properties of the Reconstruction match those of the
+    ///        ground truth data.
+    /// @throws GridPropertyError if the ground truth TSDF Grid Properties are not equal.
+    void throwIfGridPropertiesDoNotMatch()
+    {
+        if (this->reconstruction->grid_properties->isEqual(this->ground_truth->properties))
+        {
+            return;
+        }
+        throw GridPropertyError::PropertiesDoNotMatch("Reconstruction", "Ground Truth TSDF");
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                          PROTECTED VIRTUAL METHOD OVERRIDES                           * //
+    // ***************************************************************************************** //
+
+
+    void postUpdate(const size_t& update_count) override final
+    {
+        ground_truth::DistanceError error;
+        auto compare_experiment = [&](auto&& experiment)
+        {
+            auto compare_data = [&](const auto& vector)
+            {
+                using T = typename std::decay_t<decltype(vector)>::value_type;
+                this->ground_truth->compare(vector, experiment->getQuantizer(), std::get<T>(experiment->default_value),
+                                            experiment->dist_min, experiment->dist_max, error,
+                                            this->reconstruction->getNumThreads());
+            };
+            std::visit(compare_data, experiment->getData());
+        };
+        std::visit(compare_experiment, this->experiment);
+        this->error_list.push_back({error, update_count});
+    }
+
+
+    void save(HighFive::File& file) const override final
+    {
+        static const std::vector<std::string> headers = {"update", "voxels", "mean absolute error",
+                                                         "root mean squared error"};
+
+        const std::string hdf5_data_path = getDatasetPathHDF5(this->map_name);
+        H5Easy::dump(file, hdf5_data_path, this->getErrorAsMatrix());
+        H5Easy::dumpAttribute(file, hdf5_data_path, "header", headers);
+    }
+
+
+    void load(const HighFive::File& file) override final
+    {
+        const std::string hdf5_data_path = getDatasetPathHDF5(this->map_name);
+        if (!file.exist(hdf5_data_path))
+        {
+            return;
+        }
+        const auto mat = H5Easy::load<Eigen::MatrixXd>(file, hdf5_data_path);
+
+        this->error_list.clear();
+        for (Eigen::Index n = 0; n < mat.rows(); ++n)
+        {
+            ground_truth::DistanceError error;
+            error.n = static_cast<size_t>(mat(n, 1));
+            error.sum_absolute = mat(n, 2) * mat(n, 1);
+            error.sum_squared  = mat(n, 3) * mat(n, 3) * mat(n, 1);
+            this->error_list.push_back({error, static_cast<size_t>(mat(n, 0))});
+        }
+    }
+
+
+    const std::string& getTypeName() const override final
+    {
+        return TSDFError::type_name;
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                PROTECTED CLASS MEMBERS                                * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Records a pair of error data and what Reconstruction update it came from.
+    std::list<std::pair<ground_truth::DistanceError, size_t>> error_list;
+
+    /// @brief Name for the channel the Metric makes.
+    const std::string channel_name;
+
+    /// @brief The ground truth TSDF Grid to compare Reconstruction data against.
+    std::shared_ptr<const ground_truth::TSDF> ground_truth;
+
+    /// @brief Reference to the Reconstruction VoxelGrid that this Metric uses.
+    ground_truth::ExperimentTSDF experiment;
+};
+
+
+/// @brief String for the class name.
+const std::string TSDFError::type_name = "TSDFError";
+
+
+} // namespace metrics
+} // namespace forge_scan
+
+
+
+#endif // FORGE_SCAN_METRICS_TSDF_ERROR_HPP
@@ -9,6 +9,7 @@
 #include "ForgeScan/Policies/Simple/Sphere.hpp"
 #include "ForgeScan/Policies/Simple/Axis.hpp"
 
+#include "ForgeScan/Policies/Heuristic/InfoGain.hpp"
 #include "ForgeScan/Policies/Heuristic/Occplane.hpp"
 
 #include "ForgeScan/Policies/Precomputed/Normal.hpp"
@@ -50,6 +51,10 @@ struct Constructor
         {
             return Normal::create(reconstruction, parser);
         }
+        if (iequals(policy_type, InfoGainInfo::type_name))
+        {
+            return InfoGain::create(reconstruction, parser);
+        }
 
         throw ConstructorError::UnkownType(policy_type, Policy::type_name);
     }
@@ -80,10 +85,15 @@ struct Constructor
             /// TODO: Return and implement this.
             return "TODO: Write normal help.";
         }
+        if (iequals(policy_type, InfoGainInfo::type_name))
+        {
+            return InfoGain::helpMessage();
+        }
         std::stringstream ss;
         ss << Policy::helpMessage() << "\nPossible Policies are: "
            << Sphere::type_name << ", "
-           << Axis::type_name;
+           << Axis::type_name << ", "
+           << InfoGainInfo::type_name;
         return ss.str();
     }
 };
@@ -0,0 +1,496 @@
+#ifndef FORGE_SCAN_POLICIES_HEURISTIC_INFO_GAIN_HPP
+#define FORGE_SCAN_POLICIES_HEURISTIC_INFO_GAIN_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "ForgeScan/Policies/Policy.hpp"
+
+#include "ForgeScan/Common/RayTrace.hpp"
+#include "ForgeScan/Common/VectorMath.hpp"
+#include "ForgeScan/Sensor/Intrinsics.hpp"
+#include "ForgeScan/Utilities/ArgParser.hpp"
+#include "ForgeScan/Utilities/Random.hpp"
+#include "ForgeScan/Utilities/Threads.hpp"
+
+
+namespace forge_scan {
+namespace policies {
+
+
+struct InfoGainInfo
+{
+    inline static const std::string type_name =
+        "InfoGain";
+
+    struct Parse
+    {
+        inline static const std::string radius =
+            "--r";
+
+        inline static const std::string radius_max =
+            "--r-max";
+
+        inline static const std::string channel =
+            "--channel";
+
+        inline static const std::string n_candidates =
+            "--n-candidates";
+
+        inline static const std::string stride =
+            "--stride";
+
+        inline static const std::string keep_top_n =
+            "--keep-top-n";
+
+        inline static const std::string min_gain =
+            "--min-gain";
+
+        inline static const std::string n_threads =
+            "--n-threads";
+    };
+
+    struct Help
+    {
+        inline static const std::string radius =
+            "The minimum distance between a candidate view and the center of the grid";
+
+        inline static const std::string radius_max =
+            "The maximum distance between a candidate view and the center of the grid";
+
+        inline static const std::string channel =
+            "The name of an existing Binary or Probability channel to score views against";
+
+        inline static const std::string n_candidates =
+            "The number of candidate views scored in each generation step";
+
+        inline static const std::string stride =
+            "The pixel stride, in each direction, of the rays cast for each candidate";
+
+        inline static const std::string keep_top_n =
+            "The maximum number of views to keep in each generation step";
+
+        inline static const std::string min_gain =
+            "Policy.isComplete returns true once no candidate views more unknown voxels than this";
+
+        inline static const std::string n_threads =
+            "The number of threads to score candidates with, 0 for all hardware threads";
+    };
+
+    struct Def
+    {
+        inline static const float radius =
+            2.5;
+
+        inline static const int n_candidates =
+            256;
+
+        inline static const int stride =
+            16;
+
+        inline static const int keep_top_n =
+            1;
+
+        inline static const float min_gain =
+            0;
+
+        inline static const int n_threads =
+            0;
+    };
+};
+
+
+/// @brief Suggests the views which see the most unknown voxels in the Reconstruction.
+/// @details Each generation step samples candidate poses around the grid and casts a sparse set of
+///          the camera's pixel rays from each through the occupancy of a Binary or Probability
+///          channel. A ray counts the unknown voxels it passes and stops at the first occupied one,
+///          so a candidate's gain estimates how many unknown voxels its image would reveal.
+/// @note  Candidates are scored in parallel. Each thread walks its rays through the same read-only
+///        copy of the occupancy, which is taken once per generation step.
+/// @note  Scoring runs on the CPU only, and `--n-threads` is how it scales. There is no CUDA or Open3D
+///        device path. The occupancy copy and the ray traversal are host code, and ForgeScan has no
+///        device kernels to run them on. Rays are walked one at a time with `visit_ray` rather than
+///        in the packets of `get_ray_trace_batch`, as each stops at its first occupied voxel.
+class InfoGain : public Policy
+{
+public:
+    /// @brief Creates an InfoGain Policy.
+    /// @param reconstruction Shared pointer to the Reconstruction that the Policy suggests new
+    ///                       views for.
+    /// @param parser ArgParser with arguments to construct an InfoGain Policy from. The camera's
+    ///               Intrinsics are read from these as well, see `sensor::Intrinsics::create`.
+    /// @return Shared pointer to a InfoGain Policy.
+    /// @throws ConstructorError If the channel is not a Binary or Probability VoxelGrid.
+    static std::shared_ptr<InfoGain> create(const std::shared_ptr<data::Reconstruction>& reconstruction,
+                                            const utilities::ArgParser& parser)
+    {
+        const float radius = parser.get<float>(InfoGainInfo::Parse::radius, InfoGainInfo::Def::radius);
+        return std::shared_ptr<InfoGain>(new InfoGain(
+            reconstruction,
+            sensor::Intrinsics::create(parser),
+            radius,
+            parser.get<float>(InfoGainInfo::Parse::radius_max, radius),
+            std::max(parser.get<int>(InfoGainInfo::Parse::n_candidates, InfoGainInfo::Def::n_candidates), 1),
+            std::max(parser.get<int>(InfoGainInfo::Parse::stride, InfoGainInfo::Def::stride), 1),
+            std::max(parser.get<int>(InfoGainInfo::Parse::keep_top_n, InfoGainInfo::Def::keep_top_n), 1),
+            parser.get<float>(InfoGainInfo::Parse::min_gain, InfoGainInfo::Def::min_gain),
+            std::max(parser.get<int>(InfoGainInfo::Parse::n_threads, InfoGainInfo::Def::n_threads), 0),
+            std::max(parser.get<int>(Policy::parse_n_views, Policy::default_n_views), 1),
+            parser.get<float>(Policy::parse_seed, Policy::default_seed),
+            parser.get(InfoGainInfo::Parse::channel))
+        );
+    }
+
+
+    /// @return Help message for constructing an InfoGain Policy with ArgParser.
+    static std::string helpMessage()
+    {
+        return "An InfoGain Policy suggests the candidate views which see the most unknown voxels."
+               "\nAn InfoGain Policy may be created with the following arguments:"
+               "\n\t[" + InfoGainInfo::Parse::channel      + " <name>] "      + InfoGainInfo::Help::channel +
+               "\n\t[" + InfoGainInfo::Parse::radius       + " <radius>] "    + InfoGainInfo::Help::radius +
+               "\n\t[" + InfoGainInfo::Parse::radius_max   + " <radius>] "    + InfoGainInfo::Help::radius_max +
+               "\n\t[" + InfoGainInfo::Parse::n_candidates + " <n>] "         + InfoGainInfo::Help::n_candidates +
+               "\n\t[" + InfoGainInfo::Parse::stride       + " <pixels>] "    + InfoGainInfo::Help::stride +
+               "\n\t[" + InfoGainInfo::Parse::keep_top_n   + " <n>] "         + InfoGainInfo::Help::keep_top_n +
+               "\n\t[" + InfoGainInfo::Parse::min_gain     + " <n voxels>] "  + InfoGainInfo::Help::min_gain +
+               "\n\t[" + InfoGainInfo::Parse::n_threads    + " <n>] "         + InfoGainInfo::Help::n_threads +
+               "\n\t[" + Policy::parse_n_views + " <n>] [" + Policy::parse_seed + " <seed>]"
+               "\n\t[camera intrinsics] " + sensor::Intrinsics::help_string_3;
+    }
+
+
+private:
+    InfoGain(const std::shared_ptr<data::Reconstruction>& reconstruction,
+             const std::shared_ptr<const sensor::Intrinsics>& intr,
+             const float& radius,
+             const float& radius_max,
+             const int& n_candidates,
+             const int& stride,
+             const int& keep_top_n,
+             const float& min_gain,
+             const int& n_threads,
+             const int& complete_after,
+             const float& seed,
+             const std::string& use_channel)
+        : Policy(reconstruction),
+          intr(intr),
+          radius(std::min(std::abs(radius), std::abs(radius_max))),
+          radius_max(std::max(std::abs(radius), std::abs(radius_max))),
+          n_candidates(n_candidates),
+          stride(stride),
+          keep_top_n(keep_top_n),
+          min_gain(min_gain),
+          n_threads(n_threads == 0 ? utilities::getHardwareThreadCount() : static_cast<size_t>(n_threads)),
+          complete_after(complete_after),
+          sample(seed)
+    {
+        if (use_channel.empty())
+        {
+            auto voxel_grid = data::Binary::create(this->reconstruction->grid_properties);
+            this->addChannel(voxel_grid, InfoGainInfo::type_name);
+            this->setChannel(voxel_grid);
+        }
+        else
+        {
+            this->setChannel(this->reconstruction->getChannelRef(use_channel));
+        }
+        this->setRays();
+    }
+
+
+    /// @brief Sets how the occupancy is read from the channel the Policy scores views against.
+    /// @param voxel_grid Channel to use.
+    /// @throws ConstructorError If the channel is not a Binary or Probability VoxelGrid.
+    void setChannel(const std::shared_ptr<data::VoxelGrid>& voxel_grid)
+    {
+        if (auto binary = std::dynamic_pointer_cast<const data::Binary>(voxel_grid))
+        {
+            this->get_occupancy = [binary](std::vector<uint8_t>& occupancy)
+            {
+                binary->getOccupancyData(occupancy, 0, occupancy.size());
+            };
+        }
+        else if (auto probability = std::dynamic_pointer_cast<const data::Probability>(voxel_grid))
+        {
+            this->get_occupancy = [probability](std::vector<uint8_t>& occupancy)
+            {
+                probability->getOccupancyData(occupancy, 0, occupancy.size());
+            };
+        }
+        else
+        {
+            throw ConstructorError(InfoGainInfo::type_name + " could not cast grid of " +
+                                   voxel_grid->getTypeName() + " to type " + data::Binary::type_name +
+                                   " or " + data::Probability::type_name + ".");
+        }
+    }
+
+
+    /// @brief Selects every `stride`-th pixel ray of the Intrinsics, in each direction, and
+    ///        normalizes them to unit length.
+    void setRays()
+    {
+        const PointMatrix& pixel_rays = this->intr->getPixelRays();
+
+        const size_t offset = this->stride / 2;
+        const size_t n_rows = this->intr->height > offset ? (this->intr->height - offset - 1) / this->stride + 1 : 0;
+        const size_t n_cols = this->intr->width  > offset ? (this->intr->width  - offset - 1) / this->stride + 1 : 0;
+
+        this->rays.resize(3, n_rows * n_cols);
+        Eigen::Index n = 0;
+        for (size_t row = offset; row < this->intr->height; row += this->stride)
+        {
+            for (size_t col = offset; col < this->intr->width; col += this->stride, ++n)
+            {
+                this->rays.col(n) = pixel_rays.col(row * this->intr->width + col).normalized();
+            }
+        }
+    }
+
+
+    /// @brief Copies the occupancy of the channel. Voxels which no ray has seen are marked unknown.
+    void updateOccupancy()
+    {
+        this->occupancy.resize(this->reconstruction->grid_properties->getNumVoxels());
+        this->get_occupancy(this->occupancy);
+
+        const std::shared_ptr<const Bitset> seen = this->reconstruction->getSeenData();
+        if (seen != nullptr && seen->size() == this->occupancy.size())
+        {
+            for (size_t i = 0; i < this->occupancy.size(); ++i)
+            {
+                if (!seen->test(i))
+                {
+                    this->occupancy[i] = VoxelOccupancy::UNSEEN;
+                }
+            }
+        }
+    }
+
+
+    /// @brief Samples the candidate poses, oriented to the center of the grid.
+    void sampleCandidates()
+    {
+        const Point grid_center = this->reconstruction->grid_properties->getCenter();
+
+        this->candidates.resize(this->n_candidates);
+        for (auto& extr : this->candidates)
+        {
+            float theta, phi;
+            this->sample.sphere(theta, phi, true);
+            const float r = this->sample.uniform(this->radius, this->radius_max);
+
+            extr = Extrinsic::Identity();
+            extr.translation() = vector_math::spherical_to_cartesian(r, theta, phi) + grid_center;
+            extr.rotate(vector_math::get_rotation_to_orient_z_axis(extr, grid_center));
+        }
+    }
+
+
+    /// @brief Counts the unknown voxels seen by a candidate pose.
+    /// @param extr Pose of the candidate, in the Reconstruction's frame.
+    /// @return Estimated number of unknown voxels the candidate's full image would see.
+    float scoreCandidate(const Extrinsic& extr) const
+    {
+        const auto& properties = this->reconstruction->grid_properties;
+        const Point origin = extr.translation();
+        const PointMatrix directions = extr.rotation() * this->rays;
+
+        size_t n_unknown = 0;
+        auto visit = [&](const size_t& i, const float&)
+        {
+            const uint8_t label = this->occupancy[i];
+            n_unknown += (label & VoxelOccupancy::TYPE_UNKNOWN) != 0;
+            return (label & VoxelOccupancy::TYPE_OCCUPIED) == 0;
+        };
+        for (Eigen::Index j = 0; j < directions.cols(); ++j)
+        {
+            const Point end = origin + this->intr->max_d * directions.col(j);
+            visit_ray(origin, end, properties, this->intr->min_d, this->intr->max_d, visit);
+        }
+        return static_cast<float>(n_unknown) * this->stride * this->stride;
+    }
+
+
+    /// @brief Scores every candidate in parallel.
+    /// @throws Any exception thrown while scoring a candidate, once all threads have stopped.
+    void scoreCandidates()
+    {
+        this->gains.assign(this->candidates.size(), 0);
+
+        std::atomic<size_t> next{0};
+        std::exception_ptr error = nullptr;
+        std::mutex error_mutex;
+        auto worker = [&]()
+        {
+            try
+            {
+                for (size_t c = next++; c < this->candidates.size(); c = next++)
+                {
+                    this->gains[c] = this->scoreCandidate(this->candidates[c]);
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (error == nullptr)
+                {
+                    error = std::current_exception();
+                }
+            }
+        };
+
+        const size_t n_workers = std::min(this->n_threads, this->candidates.size());
+        std::vector<std::thread> threads;
+        threads.reserve(n_workers > 0 ? n_workers - 1 : 0);
+        for (size_t t = 1; t < n_workers; ++t)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        if (error != nullptr)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                           PRIVATE VIRTUAL METHOD OVERRIDES                            * //
+    // ***************************************************************************************** //
+
+
+    virtual const std::string& getTypeName() const override final
+    {
+        return InfoGainInfo::type_name;
+    }
+
+
+    void print(std::ostream& out) const override final
+    {
+        out << InfoGainInfo::type_name << " Policy scoring " << this->n_candidates << " candidates at radius ("
+            << this->radius << ", " << this->radius_max << ") with " << this->rays.cols() << " rays each.";
+    }
+
+
+    /// @brief Scores a new set of candidates and keeps the best of them. The best candidate is
+    ///        kept even if its gain is too low, so there is always a view to suggest.
+    virtual void generate() override final
+    {
+        this->updateOccupancy();
+        this->sampleCandidates();
+        this->scoreCandidates();
+
+        std::vector<size_t> order(this->candidates.size());
+        std::iota(order.begin(), order.end(), 0);
+        const size_t n_keep = std::min(static_cast<size_t>(this->keep_top_n), order.size());
+        std::partial_sort(order.begin(), order.begin() + n_keep, order.end(),
+                          [this](const size_t& a, const size_t& b) { return this->gains[a] > this->gains[b]; });
+
+        this->best_gain = this->gains[order.front()];
+        this->views.clear();
+        for (size_t k = 0; k < n_keep; ++k)
+        {
+            if (k == 0 || this->gains[order[k]] > this->min_gain)
+            {
+                this->views.push_back(this->candidates[order[k]]);
+            }
+        }
+        this->n_accepted_at_generate = this->numAccepted();
+    }
+
+
+    bool isComplete() const override final
+    {
+        const bool no_gain_after_at_least_one_update = this->n_accepted_at_generate > 0 &&
+                                                       this->best_gain <= this->min_gain;
+        return no_gain_after_at_least_one_update ||
+               this->numAccepted() + this->numRejected() >= this->complete_after;
+    }
+
+
+    void save(H5Easy::File& file, HighFive::Group& g_policy) const override final
+    {
+        auto g_info_gain = g_policy.createGroup(InfoGainInfo::type_name);
+        g_info_gain.createAttribute("radius",       this->radius);
+        g_info_gain.createAttribute("radius_max",   this->radius_max);
+        g_info_gain.createAttribute("n_candidates", this->n_candidates);
+        g_info_gain.createAttribute("stride",       this->stride);
+        g_info_gain.createAttribute("best_gain",    this->best_gain);
+        g_info_gain.createAttribute("completed",    static_cast<uint8_t>(this->isComplete()));
+        Policy::saveRejectedViews(file, InfoGainInfo::type_name);
+        Policy::saveAcceptedViews(file, InfoGainInfo::type_name);
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                 PRIVATE CLASS MEMBERS                                 * //
+    // ***************************************************************************************** //
+
+    /// @brief Intrinsics of the camera the candidate views are for.
+    const std::shared_ptr<const sensor::Intrinsics> intr;
+
+    /// @brief Range of distances from the center of the grid for the candidate views.
+    const float radius, radius_max;
+
+    /// @brief Number of candidates scored in each call to generate.
+    const size_t n_candidates;
+
+    /// @brief Pixel stride of the rays cast for each candidate.
+    const size_t stride;
+
+    /// @brief Maximum number of views to keep after each call to generate.
+    const int keep_top_n;
+
+    /// @brief Policy is complete once no candidate has a gain above this.
+    const float min_gain;
+
+    /// @brief Number of threads used to score candidates.
+    const size_t n_threads;
+
+    /// @brief Policy is complete after this many views.
+    const size_t complete_after;
+
+    /// @brief Random sampler for the candidate poses.
+    utilities::RandomSampler<float> sample;
+
+    /// @brief Copies the channel's occupancy into a vector with one element per voxel.
+    std::function<void(std::vector<uint8_t>&)> get_occupancy;
+
+    /// @brief Unit directions, in the camera frame, of the rays cast for each candidate.
+    PointMatrix rays;
+
+    /// @brief Occupancy of the channel when generate was last called.
+    std::vector<uint8_t> occupancy;
+
+    /// @brief Candidate poses and their gains from the last call to generate.
+    std::vector<Extrinsic> candidates;
+    std::vector<float> gains;
+
+    /// @brief Highest gain found by the last call to generate.
+    float best_gain = 0;
+
+    /// @brief Number of accepted views when generate was last called. Before the first view every
+    ///        voxel is unknown, so the gain only decides completion once a view has been integrated.
+    size_t n_accepted_at_generate = 0;
+};
+
+
+} // namespace policies
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_POLICIES_HEURISTIC_INFO_GAIN_HPP
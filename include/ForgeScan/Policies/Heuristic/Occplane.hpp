@@ -5,10 +5,10 @@
 #include <limits>
 #include <functional>
 
-#include <open3d/geometry/PointCloud.h>
-
 #include "ForgeScan/Policies/Policy.hpp"
 
+#include "ForgeScan/Common/DBSCAN.hpp"
+
 #include "ForgeScan/Utilities/ArgParser.hpp"
 #include "ForgeScan/Utilities/Random.hpp"
 
@@ -120,7 +120,8 @@ private:
           eps(eps),
           min_points(min_points),
           keep_top_n(keep_top_n),
-          complete_after(complete_after)
+          complete_after(complete_after),
+          candidates(eps, min_points)
     {
         if (use_channel.empty())
         {
@@ -193,7 +194,8 @@ private:
     /// @brief Updates the view list based on the occplanes in the reconstruction.
     void generateOccplaneViews()
     {
-        std::vector<Eigen::Vector3d> candidate_normals, candidate_points;
+        std::vector<Eigen::Vector3d>& candidate_normals = this->candidate_normals;
+        std::vector<Eigen::Vector3d>& candidate_points  = this->candidate_points;
         this->binary_grid->updateOccplanes(candidate_points, candidate_normals);
 
         // Record the number of occplanes found. But set to zero if somehow the number of points and
@@ -207,19 +209,25 @@ private:
             return;
         }
 
-        // Turn the centers & normals into the final positions for the candidate points.
-        for (size_t i = 0; i < this->n_occplane; ++i)
+        // Turn the centers & normals into the final positions for the candidate points. The set of
+        // candidates is kept between calls, so only the occplanes which appeared, moved, or were
+        // removed since the last call change it. Occplanes are listed in the order of their set.
+        size_t k = 0;
+        this->candidates.beginUpdate();
+        this->binary_grid->getOccplanes()->forEachSet([&](const size_t& i)
         {
-            candidate_points[i] += this->radius * candidate_normals[i];
-        }
-
-        // Labels from the Open3D DBSCAN function are [-1, 0, 1, ..., M]. We use the labels as an index into the clusters
-        // vector so we add one because of the first noise label is -1 and and then add one again to get the total size.
-        std::vector<int32_t> labels = open3d::geometry::PointCloud(candidate_points).ClusterDBSCAN(this->eps, this->min_points);
-        this->n_clusters = *(std::max_element(labels.begin(), labels.end())) + 2;
-
-        // Fallback to default (random) method if is only one cluster and it is noise.
-        if (this->n_clusters == 1 && labels.at(0) == -1)
+            this->candidates.update(i, candidate_points[k] + this->radius * candidate_normals[k], candidate_normals[k]);
+            ++k;
+        });
+        this->candidates.endUpdate();
+
+        // Labels are [-1, 0, 1, ..., M]. We use the labels as an index into the clusters vector so we
+        // add one because of the first noise label is -1 and and then add one again to get the total size.
+        const size_t n_labeled = this->candidates.cluster();
+        this->n_clusters = n_labeled + 1;
+
+        // Fallback to default (random) method if every point is noise.
+        if (n_labeled == 0)
         {
             this->generateDefault(true);
             return;
@@ -227,37 +235,39 @@ private:
 
         // Create the clusters vector and index each occplane point into it, sum points and normals.
         // The normals are inverted to the pose points from the candidate point to the occplane voxel.
-        std::vector<Cluster> clusters(this->n_clusters);
-        for (size_t i = 0; i < this->n_occplane; ++i)
+        std::vector<Cluster>& clusters = this->clusters;
+        clusters.assign(this->n_clusters, Cluster());
+        for (const auto& node : this->candidates.getNodes())
         {
-            // Labels vector is still [-1, 0, 1, ... (n_clusters - 2)]. So we add one
+            // Labels are still [-1, 0, 1, ... (n_clusters - 2)]. So we add one
             // to get the index equivelent for the cluster.
-            size_t c = labels[i] + 1;
+            size_t c = node.label + 1;
             clusters[c].n_points += 1;
-            clusters[c].center   += candidate_points[i];
-            clusters[c].normal   -= candidate_normals[i];
+            clusters[c].center   += node.point;
+            clusters[c].normal   -= node.value;
         }
 
         // Label each cluster. Now labels start from 0 rather than -1.
         int c = -1;
         for (auto& vector_item : clusters)
         {
-            vector_item.label   = ++c;
-            vector_item.center /= vector_item.n_points;
-            vector_item.normal /= vector_item.n_points;
+            vector_item.label = ++c;
+            if (vector_item.n_points > 0)
+            {
+                vector_item.center /= vector_item.n_points;
+                vector_item.normal /= vector_item.n_points;
+            }
         }
 
-        // Sort in order of cluster size unless the cluster is labeled as noise. Once sorted, remove
-        // the last element if its label is noise.
+        // Keep the largest clusters unless the cluster is labeled as noise. Only the kept clusters
+        // are sorted. The noise cluster sorts last, so it is only kept if there are too few others.
         auto sort_clusters = [](const Cluster& a, const Cluster& b) {
             return (a.n_points * (a.label != 0)) > (b.n_points * (b.label != 0));
         };
-        std::sort(clusters.begin(), clusters.end(), sort_clusters);
+        const size_t n_keep = std::min(clusters.size(), static_cast<size_t>(this->keep_top_n));
+        std::partial_sort(clusters.begin(), clusters.begin() + n_keep, clusters.end(), sort_clusters);
+        clusters.resize(n_keep);
         if (clusters.back().label == 0) { clusters.pop_back(); }
-        if (static_cast<int>(clusters.size()) > this->keep_top_n)
-        {
-            clusters.resize(this->keep_top_n);
-        }
 
         // Transform each cluster into a view and add it to the view list.
         for (const auto& vector_item : clusters)
@@ -346,6 +356,15 @@ private:
     /// @brief Records the number of occplanes and clusters they were sorted into.
     size_t n_occplane = 0, n_clusters = 0;
 
+    /// @brief Candidate points for the occplanes, keyed by the occplane's vector index, with
+    ///        the occplane's normal. Clustered with DBSCAN.
+    IncrementalDBSCAN<Eigen::Vector3d> candidates;
+
+    /// @brief Centers and normals of the occplanes, and the clusters of their candidate points, in
+    ///        `generateOccplaneViews`. Reused between calls.
+    std::vector<Eigen::Vector3d> candidate_points, candidate_normals;
+    std::vector<Cluster> clusters;
+
     /// @brief View of a `data::Binary` voxel grid which the Policy searches for occplanes.
     std::shared_ptr<data::Binary> binary_grid;
 };
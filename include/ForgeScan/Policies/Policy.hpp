@@ -1,14 +1,18 @@
 #ifndef FORGE_SCAN_POLICIES_POLICY_HPP
 #define FORGE_SCAN_POLICIES_POLICY_HPP
 
-#include <memory>
 #include <list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #define H5_USE_EIGEN 1
 #include <highfive/H5Easy.hpp>
 
 #include "ForgeScan/Common/Exceptions.hpp"
 #include "ForgeScan/Data/Reconstruction.hpp"
+#include "ForgeScan/Utilities/Profiler.hpp"
 
 
 namespace forge_scan {
@@ -48,6 +52,7 @@ public:
     {
         if (views.empty())
         {
+            FS_PROFILE_SCOPE(POLICY_GENERATE, nullptr);
             this->generate();
         }
         assert(views.empty() == false &&
@@ -70,6 +75,16 @@ public:
     }
 
 
+    /// @brief Returns true if the Policy reads the Reconstruction's data to choose its views.
+    /// @details A pipelined simulation waits for every accepted view to be integrated before asking
+    ///          such a Policy for its next view. See `simulation::Pipeline`.
+    /// @note  Derived classes which only use the Grid Properties may return false.
+    virtual bool requiresUpdatedReconstruction() const
+    {
+        return true;
+    }
+
+
     /// @return Help message for constructing a Policy with ArgParser.
     static std::string helpMessage()
     {
@@ -171,18 +186,43 @@ protected:
     }
 
 
+    /// @brief Saves views, and their order identifiers, to the HDF5 file.
+    /// @param file File to write to.
+    /// @param policy_name Name of the derived Policy class.
+    /// @param id_and_view List of the views and their order identifiers.
+    /// @param label Label to save the views under.
+    /// @details The views are written in one `N x 4 x 4` data set of their row-major matrices, with
+    ///          their identifiers in an `N` element data set beside it. Nothing is written if the
+    ///          list is empty.
     static void saveViews(H5Easy::File& file, const std::string& policy_name,
-                          std::list<std::pair<size_t, forge_scan::Extrinsic>> id_and_view,
+                          const std::list<std::pair<size_t, forge_scan::Extrinsic>>& id_and_view,
                           const std::string& label)
     {
+        if (id_and_view.empty())
+        {
+            return;
+        }
         const std::string hdf5_data_root = "/" FS_HDF5_POLICY_GROUP "/" + policy_name + "/" + label;
-        std::stringstream ss;
+        HighFive::Group g_views = file.createGroup(hdf5_data_root);
+
+        std::vector<size_t> ids;
+        std::vector<float>  matrices;
+        ids.reserve(id_and_view.size());
+        matrices.reserve(16 * id_and_view.size());
         for (const auto& list_item : id_and_view)
         {
-            ss << hdf5_data_root << "/" << list_item.first;
-            H5Easy::dump(file, ss.str(), list_item.second.matrix());
-            ss.str(std::string());
+            ids.push_back(list_item.first);
+            for (int r = 0; r < 4; ++r)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    matrices.push_back(list_item.second.matrix()(r, c));
+                }
+            }
         }
+        g_views.createDataSet<float>(Policy::views_dset_name, HighFive::DataSpace({ids.size(), 4, 4}))
+            .write_raw(matrices.data());
+        g_views.createDataSet(Policy::ids_dset_name, ids);
     }
 
 
@@ -203,6 +243,76 @@ protected:
     }
 
 
+    /// @brief Reads views, and their order identifiers, written by `saveViews`.
+    /// @param file File to read from.
+    /// @param policy_name Name of the derived Policy class.
+    /// @param label Label the views were saved under.
+    /// @return List of the views sorted by their order identifier. Empty if there are none.
+    static std::list<std::pair<size_t, Extrinsic>> loadViews(const H5Easy::File& file, const std::string& policy_name,
+                                                             const std::string& label)
+    {
+        return Policy::loadViews(file, "/" FS_HDF5_POLICY_GROUP "/" + policy_name + "/" + label);
+    }
+
+
+    /// @brief Reads views, and their order identifiers, from the group `saveViews` wrote them to.
+    /// @param file File to read from.
+    /// @param hdf5_data_root Path of the group holding the views.
+    /// @return List of the views sorted by their order identifier. Empty if there are none.
+    /// @throws std::runtime_error If the views or identifiers data sets are not the expected shape.
+    /// @note  Files written before views were stored together have one 4x4 data set per view, named
+    ///        by its identifier. These are read too.
+    static std::list<std::pair<size_t, Extrinsic>> loadViews(const H5Easy::File& file, const std::string& hdf5_data_root)
+    {
+        std::list<std::pair<size_t, Extrinsic>> id_and_view;
+        if (!file.exist(hdf5_data_root))
+        {
+            return id_and_view;
+        }
+        const HighFive::Group g_views = file.getGroup(hdf5_data_root);
+        if (g_views.exist(Policy::views_dset_name))
+        {
+            HighFive::DataSet dset = g_views.getDataSet(Policy::views_dset_name);
+            const std::vector<size_t> dims = dset.getSpace().getDimensions();
+
+            std::vector<size_t> ids;
+            g_views.getDataSet(Policy::ids_dset_name).read(ids);
+            if (dims.size() != 3 || dims[1] != 4 || dims[2] != 4 || dims[0] != ids.size())
+            {
+                throw std::runtime_error("Policy views in \"" + hdf5_data_root + "\" are not an N x 4 x 4 "
+                                         "data set with one identifier for each view.");
+            }
+
+            std::vector<float> matrices(16 * ids.size());
+            dset.read(matrices.data());
+            for (size_t n = 0; n < ids.size(); ++n)
+            {
+                Extrinsic view;
+                view.matrix() = Eigen::Map<const Eigen::Matrix<float, 4, 4, Eigen::RowMajor>>(&matrices[16 * n]);
+                id_and_view.push_back( {ids[n], view} );
+            }
+        }
+        else
+        {
+            for (const auto& name : g_views.listObjectNames())
+            {
+                Extrinsic view;
+                view.matrix() = H5Easy::load<Eigen::Matrix4f>(file, hdf5_data_root + "/" + name);
+                id_and_view.push_back( {std::stoull(name), view} );
+            }
+        }
+
+        // HDF5 lists names alphabetically, so "10" comes before "9".
+        id_and_view.sort([](const auto& a, const auto& b) { return a.first < b.first; });
+        return id_and_view;
+    }
+
+
+    /// @brief Names of the data sets `saveViews` writes the views and their identifiers to.
+    static constexpr const char* views_dset_name = "views";
+    static constexpr const char* ids_dset_name   = "ids";
+
+
 
     // ***************************************************************************************** //
     // *                              PROTECTED VIRTUAL METHODS                                * //
@@ -223,6 +333,18 @@ protected:
     virtual void save(H5Easy::File& file, HighFive::Group& g_policy) const = 0;
 
 
+    /// @brief Restores the Policy's accepted and rejected views from an HDF5 file written by `save`.
+    /// @param file The HDF5 file to read from.
+    /// @note  Any suggested views which were not yet accepted or rejected are discarded, so the
+    ///        Policy generates new ones. Derived classes may override this to restore more state.
+    virtual void load(const H5Easy::File& file)
+    {
+        this->accepted_views = Policy::loadViews(file, this->getTypeName(), "accepted");
+        this->rejected_views = Policy::loadViews(file, this->getTypeName(), "rejected");
+        this->views.clear();
+    }
+
+
 
     // ***************************************************************************************** //
     // *                               PROTECTED STATIC METHODS                                * //
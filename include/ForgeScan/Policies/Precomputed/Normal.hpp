@@ -2,6 +2,11 @@
 #define FORGE_SCAN_POLICIES_PRECOMPUTED_NORMAL_H
 
 #include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <vector>
 
 #include "ForgeScan/Policies/Policy.hpp"
 #include "ForgeScan/Simulation/Scene.hpp"
@@ -31,7 +36,10 @@ struct NormalInfo
 };
 
 
-class Normal : public Policy, public simulation::Scene
+/// @brief Precomputes views which see the most surface normals of a set of meshes head on.
+/// @note  The meshes are a `simulation::SceneGeometry`, which is shared rather than copied. Normal
+///        Policies loaded from the same file share one copy of the meshes.
+class Normal : public Policy
 {
 public:
     /// @brief Creates an Normal Policy.
@@ -46,19 +54,32 @@ public:
     }
 
 
+    /// @brief Creates an Normal Policy which precomputes its views for a set of meshes.
+    /// @param reconstruction Shared pointer to the Reconstruction that the Policy suggests new
+    ///                       views for.
+    /// @param geometry Meshes to find the views for. See `simulation::Scene::getGeometry`.
+    /// @return Shared pointer to a Normal Policy.
     static std::shared_ptr<Normal> create(const std::shared_ptr<data::Reconstruction>& reconstruction,
+                                          const std::shared_ptr<const simulation::SceneGeometry>& geometry,
                                           const std::shared_ptr<const sensor::Intrinsics>& intr,
                                           const Extrinsic& grid_lower_bound,
                                           const float& radius,
                                           const float& min_similarity,
                                           const float& n_sample,
                                           const float& n_store,
-                                          const float& alpha)
+                                          const float& alpha,
+                                          const size_t& stride = Normal::default_stride,
+                                          const size_t& n_refine = 0)
     {
-        return std::shared_ptr<Normal>(new Normal(reconstruction, intr, grid_lower_bound, radius, min_similarity, n_sample, n_store, alpha));
+        return std::shared_ptr<Normal>(new Normal(reconstruction, geometry, intr, grid_lower_bound, radius, min_similarity,
+                                                  n_sample, n_store, alpha, stride, n_refine));
     }
 
 
+    /// @brief Default pixel stride for the first, coarse scoring of each candidate view.
+    static constexpr size_t default_stride = 4;
+
+
     void precomputeViews()
     {
         this->generateNormalScores();
@@ -66,7 +87,7 @@ public:
     }
 
 
-    std::filesystem::path save(std::filesystem::path fpath) const override final
+    std::filesystem::path save(std::filesystem::path fpath) const
     {
         utilities::validateAndCreateFilepath(fpath, FS_HDF5_FILE_EXTENSION, "PrecomputedViewsNormal", true);
 
@@ -87,6 +108,8 @@ public:
         g_normal.createAttribute("n_sample",       this->n_sample);
         g_normal.createAttribute("n_store",        this->n_store);
         g_normal.createAttribute("alpha",          this->alpha);
+        g_normal.createAttribute("stride",         this->stride);
+        g_normal.createAttribute("n_refine",       this->n_refine);
         g_normal.createAttribute("completed",      static_cast<uint8_t>(this->isComplete()));
 
         Policy::saveViews(file, NormalInfo::type_name, this->precomputed_views, "precomputed");
@@ -94,18 +117,18 @@ public:
         Policy::saveAcceptedViews(file, NormalInfo::type_name);
 
         // Save information about the assumed location of the reconstruction location and properties
-        Scene::writeExtrToHDF5(file, g_normal.getPath(), this->grid_lower_bound);
+        simulation::Scene::writeExtrToHDF5(file, g_normal.getPath(), this->grid_lower_bound);
 
         g_normal.createAttribute("VoxelGrid Resolution", this->reconstruction->grid_properties->resolution);
         g_normal.createAttribute("VoxelGrid Dimensions", this->reconstruction->grid_properties->dimensions);
         g_normal.createAttribute("VoxelGrid Size",       this->reconstruction->grid_properties->size);
 
         // Record what meshes were used and how they were posed.
-        this->writeMeshesToHDF5(g_normal, file);
+        this->geometry->writeToHDF5(g_normal, file);
     }
 
 
-    void load(std::filesystem::path fpath) override final
+    void load(std::filesystem::path fpath)
     {
         fpath = std::filesystem::absolute(fpath.make_preferred());
 
@@ -125,45 +148,49 @@ public:
         this->n_sample       = g_normal.getAttribute("n_sample").read<size_t>();
         this->n_store        = g_normal.getAttribute("n_store").read<int>();
         this->alpha          = g_normal.getAttribute("alpha").read<float>();
+        if (g_normal.hasAttribute("stride"))
+        {
+            this->stride   = g_normal.getAttribute("stride").read<size_t>();
+            this->n_refine = g_normal.getAttribute("n_refine").read<size_t>();
+        }
 
-        Scene::readExtrFromHDF5(file, g_normal.getPath(), this->grid_lower_bound);
+        simulation::Scene::readExtrFromHDF5(file, g_normal.getPath(), this->grid_lower_bound);
 
         this->accepted_views.clear();
         this->rejected_views.clear();
-        this->precomputed_views.clear();
+        this->precomputed_views = Policy::loadViews(file, g_normal.getPath() + "/precomputed");
 
-        for (size_t i = 0; i < this->n_store; ++i)
+        // Re-load the meshes, unless they are already in use.
+        if (auto loaded = simulation::SceneGeometry::readFromHDF5(g_normal, file))
         {
-            Extrinsic extr;
-            std::stringstream ss;
-            ss << g_normal.getPath() << "/precomputed/" << i;
-            extr.matrix() = H5Easy::load<Eigen::Matrix4f>(file, ss.str());
-            this->precomputed_views.push_back({i, extr});
+            this->geometry = loaded;
         }
-
-        // Re-load the meshes to this scene.
-        this->readMeshesFromHDF5(g_normal, file);
     }
 
 
 private:
     Normal(const std::shared_ptr<data::Reconstruction>& reconstruction,
+           const std::shared_ptr<const simulation::SceneGeometry>& geometry,
            const std::shared_ptr<const sensor::Intrinsics>& intr,
            const Extrinsic& grid_lower_bound,
            const float& radius,
            const float& min_similarity,
            const float& n_sample,
            const float& n_store,
-           const float& alpha)
+           const float& alpha,
+           const size_t& stride,
+           const size_t& n_refine)
         : Policy(reconstruction),
-          Scene(),
+          geometry(geometry),
           camera(sensor::Camera::create(intr)),
           grid_lower_bound(grid_lower_bound),
           radius(radius),
           min_similarity(min_similarity),
           n_sample(n_sample),
           n_store(n_store),
-          alpha(alpha)
+          alpha(alpha),
+          stride(std::max(stride, size_t(1))),
+          n_refine(n_refine > 0 ? n_refine : 4 * this->n_store)
     {
 
     }
@@ -172,7 +199,9 @@ private:
     Normal(const std::shared_ptr<data::Reconstruction>& reconstruction,
            const std::filesystem::path fpath)
         : Policy(reconstruction),
-          Scene()
+          geometry(simulation::SceneGeometry::create()),
+          stride(Normal::default_stride),
+          n_refine(0)
     {
         this->load(fpath);
     }
@@ -204,6 +233,10 @@ private:
 
 
     /// @brief Generates the sample poses and their normal scores.
+    /// @details Every candidate is first scored with the rays of every `stride`-th pixel in each
+    ///          direction, scaled up to estimate the full image's score. Only the `n_refine` best
+    ///          candidates are then scored with every pixel, as the others are very unlikely to be
+    ///          selected. Candidates are cast in batches so Open3D traces many images in parallel.
     void generateNormalScores()
     {
         const Point grid_center = this->reconstruction->grid_properties->getCenter();
@@ -219,39 +252,109 @@ private:
             extr.rotate(vector_math::get_rotation_to_orient_z_axis(extr, grid_center));
             // extr = this->grid_lower_bound * extr;
 
-            this->score_and_extr.push_back({this->scoreNormals(this->grid_lower_bound * extr), extr});
+            this->score_and_extr.push_back({0, extr});
+        }
+
+        std::vector<size_t> candidates(this->score_and_extr.size());
+        std::iota(candidates.begin(), candidates.end(), 0);
+
+        const sensor::Intrinsics& intr = *this->camera->getIntr();
+        if (this->stride == 1)
+        {
+            this->scoreNormals(intr.getPixelRays(), candidates);
+            this->normalizeNormalScores();
+            return;
+        }
+
+        PointMatrix coarse_rays;
+        this->getCoarsePixelRays(coarse_rays);
+        this->scoreNormals(coarse_rays, candidates);
+        const float scale = static_cast<float>(intr.size()) / std::max(coarse_rays.cols(), Eigen::Index(1));
+        for (auto& score : this->score_and_extr)
+        {
+            score.first *= scale;
+        }
+
+        if (this->n_refine < candidates.size())
+        {
+            std::nth_element(candidates.begin(), candidates.begin() + this->n_refine, candidates.end(),
+                             [this](const size_t& a, const size_t& b)
+                             { return this->score_and_extr[a].first > this->score_and_extr[b].first; });
+            candidates.resize(this->n_refine);
         }
+        this->scoreNormals(intr.getPixelRays(), candidates);
         this->normalizeNormalScores();
     }
 
 
-    /// @brief Find the normal view score for a camera pose.
-    /// @param extr The camera pose to test.
-    /// @return A score in the range `[0, width * height]` where a higher score indicates more normals viewed.
-    float scoreNormals(const Extrinsic& extr)
+    /// @brief Selects the pixel rays used for the coarse score.
+    /// @param [out] directions Directions of every `stride`-th pixel in each direction, in the camera frame.
+    ///                         Each is centered within its `stride` by `stride` block of pixels.
+    void getCoarsePixelRays(PointMatrix& directions) const
     {
+        const sensor::Intrinsics& intr = *this->camera->getIntr();
+        const PointMatrix& pixel_rays = intr.getPixelRays();
 
-        Eigen::RowVector3f axis = extr.rotation().col(2).transpose();
-        auto optical_axis = open3d::core::eigen_converter::EigenMatrixToTensor(axis);
-
-        this->camera->resetDepth(1.0f);
-        auto results = this->o3d_scene.CastRays(Scene::getCameraRays(this->camera, extr));
-        auto normals = results["primitive_normals"];
+        const size_t offset = this->stride / 2;
+        const size_t n_rows = intr.height > offset ? (intr.height - offset - 1) / this->stride + 1 : 0;
+        const size_t n_cols = intr.width  > offset ? (intr.width  - offset - 1) / this->stride + 1 : 0;
 
-        normals *= optical_axis[0];
-        auto pixel_scores = normals.Sum({2});
-        pixel_scores.Abs_();
+        directions.resize(3, n_rows * n_cols);
+        Eigen::Index n = 0;
+        for (size_t row = offset; row < intr.height; row += this->stride)
+        {
+            for (size_t col = offset; col < intr.width; col += this->stride, ++n)
+            {
+                directions.col(n) = pixel_rays.col(row * intr.width + col);
+            }
+        }
+    }
 
-        auto mask = pixel_scores.Gt(this->min_similarity).To(open3d::core::Dtype::Float32);
-        mask.Clip_(0.0f, 1.0f);
-        pixel_scores *= mask;
 
-        // Element-wise original normals
-        // this->camera->image = open3d::core::eigen_converter::TensorToEigenMatrixXf(pixel_scores);
-        // sensor::DepthImageProcessing::imshow(this->camera, true, "pixel_scores");
+    /// @brief Finds the normal view scores for a set of the candidate poses.
+    /// @param directions Directions, in the camera frame, of the rays to cast for each candidate.
+    /// @param candidates Indices in `score_and_extr` of the candidates to score. Their scores are
+    ///                   set, in the range `[0, directions.cols()]` where a higher score indicates
+    ///                   more normals viewed.
+    /// @note  Candidates are cast together, up to `max_rays_per_cast` rays at once.
+    void scoreNormals(const PointMatrix& directions, const std::vector<size_t>& candidates)
+    {
+        const size_t n_rays = static_cast<size_t>(directions.cols());
+        const size_t per_cast = std::max(simulation::Scene::max_rays_per_cast / std::max(n_rays, size_t(1)), size_t(1));
 
+        for (size_t first = 0; first < candidates.size(); first += per_cast)
+        {
+            const size_t n = std::min(per_cast, candidates.size() - first);
+            const open3d::core::SizeVector shape = {static_cast<int64_t>(n), static_cast<int64_t>(n_rays), 6};
+            if (this->rays.GetShape() != shape)
+            {
+                this->rays = open3d::core::Tensor(shape, open3d::core::Float32);
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                simulation::Scene::writeRays(directions, this->grid_lower_bound * this->score_and_extr[candidates[first + i]].second,
+                                 this->rays.GetDataPtr<float>() + 6 * n_rays * i);
+            }
 
-        return pixel_scores.Sum({0, 1}).Item<float>();
+            auto results = this->geometry->castRays(this->rays);
+            const open3d::core::Tensor normals = results["primitive_normals"].Contiguous();
+            for (size_t i = 0; i < n; ++i)
+            {
+                std::pair<float, Extrinsic>& candidate = this->score_and_extr[candidates[first + i]];
+                const Direction axis = (this->grid_lower_bound * candidate.second).rotation().col(2);
+                const Eigen::Map<const Eigen::Matrix3Xf> normals_map(normals.GetDataPtr<float>() + 3 * n_rays * i, 3, n_rays);
+
+                // Pixels with normals nearly perpendicular to the optical axis do not count. Rays
+                // which missed have a zero normal.
+                float score = 0;
+                for (size_t j = 0; j < n_rays; ++j)
+                {
+                    const float similarity = std::abs(axis.dot(normals_map.col(j)));
+                    score += similarity > this->min_similarity ? similarity : 0.0f;
+                }
+                candidate.first = score;
+            }
+        }
     }
 
 
@@ -268,6 +371,11 @@ private:
 
     /// @brief Reviews the list of scores and extrinsics to select a set with high values that are
     ///        also distant from each other.
+    /// @details A candidate's distance score is its minimum over the selected views, so it never goes
+    ///          up as views are selected. Candidates are kept in a max-heap by the combined score they
+    ///          had when last checked, which is an upper bound for it now. Only the top candidate is
+    ///          brought up to date against the views selected since, until the top is current and
+    ///          so is the best. This selects the same views as comparing every candidate each time.
     void findNextBestViews()
     {
         std::vector<int> default_idx(this->n_sample);
@@ -276,48 +384,84 @@ private:
 
         this->precomputed_views.clear();
 
+        const size_t n_candidates = this->score_and_extr.size();
+        std::vector<Direction> selected_axes;
+        std::vector<float>  dist_score(n_candidates, 1);
+        std::vector<size_t> n_compared(n_candidates, 0);
+
+        // Ordered by the highest score, then by the lowest index.
+        struct Entry
+        {
+            float score;
+            size_t idx;
+            size_t n_compared;
+
+            bool operator<(const Entry& other) const
+            {
+                return this->score < other.score || (this->score == other.score && this->idx > other.idx);
+            }
+        };
+        std::priority_queue<Entry> heap;
+        for (size_t i = 0; i < n_candidates; ++i)
+        {
+            if (this->score_and_extr[i].first > 0)
+            {
+                heap.push({this->alpha * this->score_and_extr[i].first + (1 - this->alpha), i, 0});
+            }
+        }
+
         for (size_t n = 0; n < this->n_store; ++n)
         {
             int best_idx = default_idx[n];
-            float best_score = 0;
-
-            for (size_t i = 0; i < this->score_and_extr.size(); ++i)
+            while (!heap.empty())
             {
-                if (this->score_and_extr[i].first > 0)
+                const Entry top = heap.top();
+                if (this->score_and_extr[top.idx].first <= 0)
+                {
+                    heap.pop();
+                }
+                else if (top.n_compared == selected_axes.size())
+                {
+                    if (top.score > 0)
+                    {
+                        best_idx = static_cast<int>(top.idx);
+                        heap.pop();
+                    }
+                    break;
+                }
+                else
                 {
-                    float dist_score = scoreViewDistance(score_and_extr[i].second);
-                    float score = this->alpha * this->score_and_extr[i].first + (1 - this->alpha) * dist_score;
-                    if (score > best_score)
+                    heap.pop();
+                    const Direction axis = this->score_and_extr[top.idx].second.rotation().col(2);
+                    for (size_t& k = n_compared[top.idx]; k < selected_axes.size(); ++k)
                     {
-                        best_score = score;
-                        best_idx   = i;
+                        dist_score[top.idx] = std::min(dist_score[top.idx], Normal::scoreViewDistance(selected_axes[k], axis));
                     }
+                    heap.push({this->alpha * this->score_and_extr[top.idx].first + (1 - this->alpha) * dist_score[top.idx],
+                               top.idx, n_compared[top.idx]});
                 }
             }
 
             this->score_and_extr.at(best_idx).first = -1;
             this->precomputed_views.push_back({this->precomputed_views.size(), this->score_and_extr[best_idx].second});
+            selected_axes.push_back(this->score_and_extr[best_idx].second.rotation().col(2));
         }
     }
 
 
-    /// @brief Compares a view against all already selected views, return ing a score for its similarity to other views
-    /// @param extr The view to test against the selected views.
-    /// @return A value between 0 and 1 where a higher indicates it is further away from other views.
-    float scoreViewDistance(const Extrinsic& extr)
+    /// @brief Scores how far apart two views are.
+    /// @param a Optical axis of the first view.
+    /// @param b Optical axis of the second view.
+    /// @return A value between 0 and 1 where a higher indicates the views are further away from each other.
+    static float scoreViewDistance(const Direction& a, const Direction& b)
     {
-        float min_dist_score = 1;
-        for (const auto& view : this->precomputed_views)
-        {
-            // Since points exist on the same sphere  the similarity their optical axes, oriented to the center, are
-            // analogous to the distance. E.g., views far apart will have opposite axes and a negative cosine similarity.
-            float dist = (view.second.rotation().col(2).array() * extr.rotation().col(2).array()).sum();
-            
-            // Similarity is [-1, 1], but we normalize it then invert it. Now, most similar vectors have a score of 0
-            // and dissimilar ones a score of 1.
-            min_dist_score = std::min(min_dist_score, 1 - ((dist + 1) / 2));
-        }
-        return min_dist_score;
+        // Since points exist on the same sphere  the similarity their optical axes, oriented to the center, are
+        // analogous to the distance. E.g., views far apart will have opposite axes and a negative cosine similarity.
+        const float dist = a.dot(b);
+
+        // Similarity is [-1, 1], but we normalize it then invert it. Now, most similar vectors have a score of 0
+        // and dissimilar ones a score of 1.
+        return 1 - ((dist + 1) / 2);
     }
 
 
@@ -355,14 +499,27 @@ private:
     }
 
 
+    /// @brief Views only depend on the Grid Properties, not on the Reconstruction's data.
+    bool requiresUpdatedReconstruction() const override final
+    {
+        return false;
+    }
+
+
 
     // ***************************************************************************************** //
     // *                                 PRIVATE CLASS MEMBERS                                 * //
     // ***************************************************************************************** //
 
 
+    /// @brief Meshes the views are found for.
+    std::shared_ptr<const simulation::SceneGeometry> geometry;
+
     std::shared_ptr<sensor::Camera> camera;
 
+    /// @brief Rays cast by `scoreNormals`, reused between batches.
+    open3d::core::Tensor rays;
+
     Extrinsic grid_lower_bound;
 
     float radius;
@@ -375,6 +532,12 @@ private:
 
     float alpha;
 
+    /// @brief Pixel stride for the coarse normal scores. One scores every candidate with every pixel.
+    size_t stride;
+
+    /// @brief Number of candidates with the best coarse scores which are scored again with every pixel.
+    size_t n_refine;
+
     std::vector<std::pair<float, Extrinsic>> score_and_extr;
 
     std::list<std::pair<size_t, Extrinsic>> precomputed_views;
@@ -197,6 +197,13 @@ protected:
     }
 
 
+    /// @brief Views only depend on the Grid Properties, not on the Reconstruction's data.
+    bool requiresUpdatedReconstruction() const override final
+    {
+        return false;
+    }
+
+
     void save(H5Easy::File& file, HighFive::Group& g_policy) const override final
     {
         auto g_rand_sph = g_policy.createGroup(Sphere::type_name);
@@ -1,15 +1,19 @@
 #ifndef FORGE_SCAN_SENSOR_DEPTH_CAMERA_HPP
 #define FORGE_SCAN_SENSOR_DEPTH_CAMERA_HPP
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 #include "ForgeScan/Common/Entity.hpp"
 #include "ForgeScan/Sensor/Intrinsics.hpp"
 
 #include "ForgeScan/Utilities/ArgParser.hpp"
 #include "ForgeScan/Utilities/Random.hpp"
+#include "ForgeScan/Utilities/Threads.hpp"
 
 
 namespace forge_scan {
@@ -125,20 +129,31 @@ struct Camera : public Entity
 
     /// @brief Turns the Camera's depth image into a list of Points, relative to the camera's frame.
     /// @param [out] dest Matrix to store the depth image's Points in.
-    void getPointMatrix(PointMatrix& dest)
+    void getPointMatrix(PointMatrix& dest) const
     {
-        dest.setConstant(3, this->intr->size(), 0);
-        size_t n = 0;
-        Point xyz;
-        for (size_t row = 0; row < this->intr->height; ++row)
-        {
-            for (size_t col = 0; col < this->intr->width; ++col)
-            {
-                this->getPoint(row, col, xyz);
-                dest.col(n) << xyz;
-                ++n;
-            }
-        }
+        this->deproject<false>(dest, Extrinsic::Identity(), 1, false);
+    }
+
+
+    /// @brief Turns the Camera's depth image into a list of Points, transformed into another frame.
+    /// @param [out] dest Matrix to store the depth image's Points in. This is only reallocated if
+    ///                   its size changes, so it may be reused between images.
+    /// @param frame  Transformation applied to each Point. For example, `getExtr()` gives Points
+    ///               relative to the frame the Camera's pose is relative to.
+    /// @param stride Only every `stride` rows and columns of the image are used. A value of 1 uses
+    ///               every pixel.
+    /// @param cull_invalid If true, pixels with a depth which is not a finite, positive number
+    ///                     are skipped. These are the pixels of a real sensor with no return.
+    /// @param n_threads Number of threads to deproject the image with, each taking a contiguous
+    ///                  band of rows. A value of 0 uses every hardware thread.
+    /// @note  This uses the per-pixel directions cached by `Intrinsics::getPixelRays`. The Points
+    ///        are found and transformed in a single pass over the image.
+    /// @note  The Points are in the same order for any number of threads.
+    void getPointMatrix(PointMatrix& dest, const Extrinsic& frame, const size_t& stride = 1,
+                        const bool& cull_invalid = false, const size_t& n_threads = 1) const
+    {
+        this->deproject<true>(dest, frame, stride, cull_invalid,
+                              n_threads == 0 ? utilities::getHardwareThreadCount() : n_threads);
     }
 
 
@@ -195,18 +210,25 @@ struct Camera : public Entity
     ///        by some percent of its original length.
     /// @param percent Uniform sampling factor. The ray is scaled a random percentage between [-p, +p]
     /// @note This does ensure no value is set below zero.
+    /// @note The noise of each pixel is drawn from a `utilities::Philox` generator keyed by the
+    ///       Camera's seed, the number of images noised before this one, and the pixel's index. An
+    ///       image's noise is therefore the same regardless of the order its pixels are visited in.
     /// @warning A percent value above `0.2` may cause ray tracing failures. I have not investigated why yet.
     ///          Likely some numeric instability leading to negative voxel coordinates.
     void addNoise(const float& percent)
     {
-        std::uniform_real_distribution<float> ud(-1 * percent, percent);
-        for (size_t row = 0; row < this->intr->height; ++row)
+        const uint64_t view   = this->n_noisy_images++;
+        const size_t width    = this->intr->width;
+        const size_t n_pixels = this->intr->size();
+        const float  scale    = 2 * percent;
+        for (size_t first = 0; first < n_pixels; first += 4)
         {
-            for (size_t col = 0; col < this->intr->width; ++col)
+            const std::array<float, 4> u = utilities::Philox::uniform(this->seed, view, first / 4);
+            for (size_t k = 0; k < 4 && first + k < n_pixels; ++k)
             {
-                auto& x = this->image(row, col);
+                auto& x = this->image((first + k) / width, (first + k) % width);
                 x = std::clamp(x, this->intr->min_d, this->intr->max_d);
-                x = std::max(0.0f, x + x * ud(this->sample.gen));
+                x = std::max(0.0f, x + x * (u[k] * scale - percent));
             }
         }
     }
@@ -243,6 +265,13 @@ struct Camera : public Entity
     }
 
 
+    /// @brief Returns the amount of noise added to each image. See `addNoise`.
+    const float& getPercentNoise() const
+    {
+        return this->percent_noise;
+    }
+
+
     /// @brief Read-only access to the Camera's current intrinsics.
     const std::shared_ptr<const Intrinsics>& getIntr() const
     {
@@ -273,12 +302,108 @@ private:
         : Entity(extr),
           intr(intr),
           percent_noise(percent_noise),
-          sample(seed)
+          seed(seed > 0 ? static_cast<uint64_t>(seed) : utilities::RANDOM_DEVICE())
     {
         this->resetDepthMax();
     }
 
 
+    /// @brief Implements `getPointMatrix`.
+    /// @tparam Transform If false, `frame` is ignored and Points are relative to the camera's frame.
+    /// @param [out] dest Matrix to store the depth image's Points in.
+    /// @param frame  Transformation applied to each Point.
+    /// @param stride Only every `stride` rows and columns of the image are used.
+    /// @param cull_invalid If true, pixels with a depth which is not a finite, positive number are skipped.
+    /// @param n_threads Number of threads to deproject the image with.
+    template <bool Transform>
+    void deproject(PointMatrix& dest, const Extrinsic& frame, const size_t& stride, const bool& cull_invalid,
+                   const size_t& n_threads = 1) const
+    {
+        const PointMatrix& pixel_rays = this->intr->getPixelRays();
+        const size_t width  = this->intr->width;
+        const size_t step   = std::max(stride, size_t(1));
+        const size_t n_rows = (this->intr->height + step - 1) / step;
+        const size_t n_cols = (width + step - 1) / step;
+
+        // Reserve space for every used pixel. Culled pixels are trimmed at the end.
+        const size_t n_max = n_rows * n_cols;
+        dest.resize(3, n_max);
+
+        const Eigen::Matrix3f rotation    = frame.rotation();
+        const Eigen::Vector3f translation = frame.translation();
+
+        // Writes the Points of the r-th used row from column n of dest. Returns how many were written.
+        auto deproject_row = [&](const size_t& r, size_t n) -> size_t
+        {
+            const size_t first = n;
+            const size_t row   = r * step;
+            for (size_t col = 0; col < width; col += step)
+            {
+                const float depth = this->image(row, col);
+                if (cull_invalid && !(depth > 0.0f && std::isfinite(depth)))
+                {
+                    continue;
+                }
+                if constexpr (Transform)
+                {
+                    dest.col(n) = rotation * (depth * pixel_rays.col(row * width + col)) + translation;
+                }
+                else
+                {
+                    dest.col(n) = depth * pixel_rays.col(row * width + col);
+                }
+                ++n;
+            }
+            return n - first;
+        };
+
+        size_t n = 0;
+        if (n_threads <= 1 || n_rows < 2 * min_rows_per_thread)
+        {
+            for (size_t r = 0; r < n_rows; ++r)
+            {
+                n += deproject_row(r, n);
+            }
+        }
+        else
+        {
+            // Each row is written where it would be if no pixel were culled, so the threads never
+            // share a column of dest. The rows are then packed in order.
+            std::vector<size_t> row_counts(n_rows);
+            n = utilities::parallelReduce<size_t>(n_rows, n_threads, min_rows_per_thread,
+                [&](const size_t& first, const size_t& last)
+                {
+                    size_t total = 0;
+                    for (size_t r = first; r < last; ++r)
+                    {
+                        row_counts[r] = deproject_row(r, r * n_cols);
+                        total += row_counts[r];
+                    }
+                    return total;
+                });
+            if (n != n_max)
+            {
+                float* data = dest.data();
+                size_t packed = row_counts[0];
+                for (size_t r = 1; r < n_rows; ++r)
+                {
+                    const float* row_data = data + 3 * r * n_cols;
+                    std::copy(row_data, row_data + 3 * row_counts[r], data + 3 * packed);
+                    packed += row_counts[r];
+                }
+            }
+        }
+        if (n != n_max)
+        {
+            dest.conservativeResize(3, n);
+        }
+    }
+
+
+    /// @brief Fewest rows `deproject` starts a thread for.
+    static constexpr size_t min_rows_per_thread = 32;
+
+
     /// @brief Throws an error if the requested pixel is beyond the bounds of the image.
     /// @param intr Intrinsic properties for the camera.
     /// @param row Row location to check.
@@ -314,8 +439,11 @@ private:
     /// @brief Amount of noise to add.
     float percent_noise;
 
-    /// @brief Amount of noise to add.
-    utilities::RandomSampler<float> sample;
+    /// @brief Seed for the noise added to each image.
+    const uint64_t seed;
+
+    /// @brief Number of images noise has been added to. This is the stream of the noise generator.
+    uint64_t n_noisy_images = 0;
 };
 
 
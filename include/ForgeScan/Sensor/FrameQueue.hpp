@@ -0,0 +1,284 @@
+#ifndef FORGE_SCAN_SENSOR_FRAME_QUEUE_HPP
+#define FORGE_SCAN_SENSOR_FRAME_QUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ForgeScan/Common/Types.hpp"
+#include "ForgeScan/Sensor/Intrinsics.hpp"
+#include "ForgeScan/Utilities/Threads.hpp"
+
+
+namespace forge_scan {
+namespace sensor {
+
+
+/// @brief A bounded ring of depth frames and poses passed from one sensor thread to the threads
+///        which integrate them.
+/// @details The frames are allocated once, at the size of the Intrinsics. `push` copies an image
+///          into a free frame and `pop` hands a queued frame to a consumer, which gives it back with
+///          `release` once it has used the image. Both pass frames through lock-free
+///          `utilities::RingQueue`s; a mutex is only taken to put a thread to sleep, or to wake one,
+///          when there is nothing for it to do.
+/// @note  When every frame is in use `push` follows the queue's `Overflow` policy.
+class FrameQueue
+{
+public:
+    /// @brief Clock used to time stamp frames.
+    typedef std::chrono::steady_clock Clock;
+
+
+    /// @brief What `push` does when every frame is in use because the consumers have fallen behind.
+    enum class Overflow
+    {
+        /// @brief Wait for a consumer to release a frame. The sensor is slowed to the consumers' rate.
+        BLOCK,
+
+        /// @brief Drop the frame being pushed.
+        DROP_NEWEST,
+
+        /// @brief Drop the oldest frame still waiting in the queue and push the new one in its place.
+        DROP_OLDEST
+    };
+
+
+    /// @brief A depth image, the pose it was taken from, and when it was pushed.
+    struct Frame
+    {
+        DepthImage image;
+        Extrinsic extr;
+        Clock::time_point arrival;
+    };
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Constructs an empty queue.
+    /// @param intr Intrinsics of the sensor. Each frame holds an image of its size.
+    /// @param capacity Number of frames which may wait in the queue. At least one.
+    /// @param overflow What `push` does when every frame is in use.
+    FrameQueue(const Intrinsics& intr, const size_t& capacity, const Overflow& overflow = Overflow::BLOCK)
+        : overflow(overflow),
+          width(intr.width),
+          height(intr.height),
+          frames(std::max(capacity, size_t(1))),
+          free_frames(frames.size()),
+          ready_frames(frames.size())
+    {
+        for (auto& frame : this->frames)
+        {
+            frame.image.resize(this->height, this->width);
+            Frame* ptr = &frame;
+            this->free_frames.tryPush(ptr);
+        }
+    }
+
+
+    /// @brief Copies a depth image and pose into the queue. Only one thread may push.
+    /// @param image Depth image. Must be the size of the queue's Intrinsics.
+    /// @param extr Pose the image was taken from.
+    /// @return True if the frame was queued. False if it was dropped, by `Overflow::DROP_NEWEST`,
+    ///         or if the queue is closed.
+    /// @throws std::invalid_argument If the image is not the size of the queue's Intrinsics.
+    bool push(const DepthImage& image, const Extrinsic& extr)
+    {
+        const Clock::time_point arrival = Clock::now();
+        if (static_cast<size_t>(image.rows()) != this->height || static_cast<size_t>(image.cols()) != this->width)
+        {
+            throw std::invalid_argument("Image does not match the size of the frame queue.");
+        }
+        if (this->closed.load())
+        {
+            return false;
+        }
+        this->n_received.fetch_add(1, std::memory_order_relaxed);
+
+        Frame* frame = nullptr;
+        while (!this->free_frames.tryPop(frame))
+        {
+            if (this->overflow == Overflow::DROP_NEWEST)
+            {
+                this->n_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (this->overflow == Overflow::DROP_OLDEST && this->ready_frames.tryPop(frame))
+            {
+                this->n_dropped.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+
+            // Every frame is queued or held by a consumer, so wait for one to be released.
+            this->park(this->frame_released, [this]() { return this->free_frames.size() > 0; });
+            if (this->closed.load())
+            {
+                return false;
+            }
+        }
+
+        frame->image   = image;
+        frame->extr    = extr;
+        frame->arrival = arrival;
+        this->ready_frames.tryPush(frame);
+        this->wake(this->frame_ready);
+        return true;
+    }
+
+
+    /// @brief Takes the oldest queued frame, waiting for one if the queue is empty.
+    /// @return The frame, which must be given back with `release`. Nullptr once the queue is closed
+    ///         and every queued frame has been taken.
+    Frame* pop()
+    {
+        Frame* frame = nullptr;
+        while (!this->ready_frames.tryPop(frame))
+        {
+            if (this->closed.load() && this->ready_frames.size() == 0)
+            {
+                return nullptr;
+            }
+            this->park(this->frame_ready, [this]() { return this->ready_frames.size() > 0; });
+        }
+        return frame;
+    }
+
+
+    /// @brief Gives a frame taken by `pop` back to the queue to be reused.
+    /// @param frame Frame to give back.
+    void release(Frame* frame)
+    {
+        this->free_frames.tryPush(frame);
+        this->wake(this->frame_released);
+    }
+
+
+    /// @brief Stops the queue from accepting frames and wakes every waiting thread. Frames already
+    ///        queued may still be popped.
+    void close()
+    {
+        this->closed.store(true);
+        {
+            std::lock_guard<std::mutex> lock(this->park_mutex);
+        }
+        this->frame_ready.notify_all();
+        this->frame_released.notify_all();
+    }
+
+
+    /// @brief Returns the number of frames offered to `push` while the queue was open.
+    size_t getNumReceived() const
+    {
+        return this->n_received.load(std::memory_order_relaxed);
+    }
+
+
+    /// @brief Returns the number of frames dropped by the `Overflow` policy.
+    size_t getNumDropped() const
+    {
+        return this->n_dropped.load(std::memory_order_relaxed);
+    }
+
+
+    /// @brief Returns the number of frames waiting to be popped.
+    size_t size() const
+    {
+        return this->ready_frames.size();
+    }
+
+
+    /// @brief Gets the Overflow policy from its name.
+    /// @param name Name of the policy. An empty string is the same as "block".
+    /// @return Matching Overflow policy.
+    /// @throws std::invalid_argument If the name is not recognized.
+    static Overflow getOverflow(const std::string& name)
+    {
+        if (name.empty() || name == "block") return Overflow::BLOCK;
+        if (name == "drop-newest")           return Overflow::DROP_NEWEST;
+        if (name == "drop-oldest")           return Overflow::DROP_OLDEST;
+        throw std::invalid_argument("Unknown frame queue overflow \"" + name + "\". Use block, drop-newest, or drop-oldest.");
+    }
+
+
+    /// @brief What `push` does when every frame is in use.
+    const Overflow overflow;
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Puts the calling thread to sleep until there is something for it to do.
+    /// @param condition Condition variable to wait on.
+    /// @param ready Returns true once the thread has something to do.
+    template <typename Ready>
+    void park(std::condition_variable& condition, Ready&& ready)
+    {
+        std::unique_lock<std::mutex> lock(this->park_mutex);
+
+        // Both this and `wake` read-modify-write the count, so one is ordered after the other:
+        // either this thread sees the change to the queue, or `wake` sees it waiting and takes the
+        // lock to notify it.
+        this->n_parked.fetch_add(1, std::memory_order_acq_rel);
+        condition.wait(lock, [&]() { return this->closed.load() || ready(); });
+        this->n_parked.fetch_sub(1);
+    }
+
+
+    /// @brief Wakes threads waiting on a condition variable, if any are waiting.
+    /// @param condition Condition variable to notify.
+    void wake(std::condition_variable& condition)
+    {
+        if (this->n_parked.fetch_add(0, std::memory_order_acq_rel) > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->park_mutex);
+            }
+            condition.notify_all();
+        }
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Size of each depth image.
+    const size_t width, height;
+
+    /// @brief Storage for every frame.
+    std::vector<Frame> frames;
+
+    /// @brief Frames which may be pushed into and frames waiting to be popped.
+    utilities::RingQueue<Frame*> free_frames, ready_frames;
+
+    /// @brief True once `close` has been called.
+    std::atomic<bool> closed{false};
+
+    /// @brief Counts of frames offered to `push` and of frames dropped.
+    std::atomic<size_t> n_received{0}, n_dropped{0};
+
+    /// @brief Number of threads sleeping in `park`.
+    std::atomic<size_t> n_parked{0};
+
+    /// @brief Lock for sleeping threads, and the condition variables they sleep on.
+    std::mutex park_mutex;
+    std::condition_variable frame_ready, frame_released;
+};
+
+
+} // namespace sensor
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_SENSOR_FRAME_QUEUE_HPP
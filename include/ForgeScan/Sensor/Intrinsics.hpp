@@ -1,6 +1,7 @@
 #ifndef FORGE_SCAN_SENSOR_INTRINSICS_HPP
 #define FORGE_SCAN_SENSOR_INTRINSICS_HPP
 
+#include <array>
 #include <memory>
 
 #include "ForgeScan/Common/Types.hpp"
@@ -171,6 +172,46 @@ struct Intrinsics
     }
 
 
+    /// @brief Gets the direction through each pixel, scaled so its Z component is one. Scaling a
+    ///        direction by the pixel's depth gives the pixel's Point, relative to the camera's frame.
+    /// @return Matrix of `size()` directions. Column `row * width + col` is for pixel (row, col).
+    /// @note  The directions are calculated on the first call and then only again if the shape,
+    ///        focal lengths, or principle point change. The returned reference is valid until then.
+    /// @note  This is thread-safe, as long as the Intrinsics are not modified at the same time.
+    ///        Threads which race on the first call agree on a single table.
+    const PointMatrix& getPixelRays() const
+    {
+        const PixelRays::Key key = {static_cast<float>(this->width), static_cast<float>(this->height),
+                                    this->f_x, this->f_y, this->c_x, this->c_y};
+
+        std::shared_ptr<const PixelRays> cached = std::atomic_load(&this->pixel_rays);
+        while (cached == nullptr || cached->key != key)
+        {
+            auto table = std::make_shared<PixelRays>();
+            table->key = key;
+            table->rays.resize(3, this->size());
+            size_t n = 0;
+            for (size_t row = 0; row < this->height; ++row)
+            {
+                const float y = (row - this->c_y) / this->f_y;
+                for (size_t col = 0; col < this->width; ++col, ++n)
+                {
+                    table->rays.col(n) << (col - this->c_x) / this->f_x, y, 1.0f;
+                }
+            }
+
+            // A table is only replaced if its key is stale. If another thread stored a table first
+            // then `cached` is updated to it and, if it matches, that table is used instead.
+            std::shared_ptr<const PixelRays> desired = table;
+            if (std::atomic_compare_exchange_strong(&this->pixel_rays, &cached, desired))
+            {
+                cached = desired;
+            }
+        }
+        return cached->rays;
+    }
+
+
 
     // ***************************************************************************************** //
     // *                                 PUBLIC CLASS MEMBERS                                  * //
@@ -282,6 +323,27 @@ private:
     {
         return 0.5 * distance  / std::tan(0.5 * (M_PI / 180) * fov_deg);
     }
+
+
+
+    // ***************************************************************************************** //
+    // *                                 PRIVATE CLASS MEMBERS                                 * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Per-pixel directions and the Intrinsics they were calculated for.
+    struct PixelRays
+    {
+        /// @brief Width, height, focal lengths, and principle point.
+        using Key = std::array<float, 6>;
+
+        Key key;
+
+        PointMatrix rays;
+    };
+
+    /// @brief Cached result of `getPixelRays`. Accessed atomically.
+    mutable std::shared_ptr<const PixelRays> pixel_rays{nullptr};
 };
 
 
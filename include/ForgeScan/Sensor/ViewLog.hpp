@@ -0,0 +1,417 @@
+#ifndef FORGE_SCAN_SENSOR_VIEW_LOG_HPP
+#define FORGE_SCAN_SENSOR_VIEW_LOG_HPP
+
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <highfive/H5File.hpp>
+
+#include "ForgeScan/Common/Types.hpp"
+#include "ForgeScan/Sensor/Camera.hpp"
+#include "ForgeScan/Utilities/HDF5.hpp"
+#include "ForgeScan/Utilities/Threads.hpp"
+
+// Define some helper constants for HDF5.
+// These are undefined at the end of this header.
+#define FS_HDF5_VIEW_LOG_GROUP  "ViewLog"
+#define FS_HDF5_VIEW_LOG_DEPTH  "Depth"
+#define FS_HDF5_VIEW_LOG_POSE   "Pose"
+
+
+namespace forge_scan {
+namespace sensor {
+
+
+/// @brief Records the depth image and pose of each view to an HDF5 file on a background thread.
+/// @details The file has a `ViewLog` group with two data sets which grow by one entry per view:
+///              - `Depth`, float of shape (N, height, width), each image is one chunk.
+///              - `Pose`, float of shape (N, 4, 4), the Camera's extrinsic matrix.
+///          The Intrinsics are stored as attributes of the group. Images are raw floats, so the
+///          log is lossless and may be replayed with `ViewLogReader`.
+/// @note  `write` only copies the image into a free buffer. Compression and file I/O happen on the
+///        writer thread. `write` only blocks if every buffer is still waiting to be written.
+/// @note  The writer thread is the only user of the file while it is open. As HDF5 is often built
+///        without thread-safety, it holds `utilities::hdf5Mutex` while writing each view, as does
+///        every other HDF5 writer of the library.
+class ViewLogWriter
+{
+public:
+    /// @brief Default number of views which may wait to be written.
+    static constexpr size_t default_capacity = 8;
+
+
+    /// @brief Constructor for a shared pointer to a ViewLogWriter.
+    /// @param fpath Location of the HDF5 file. It is overwritten if it exists.
+    /// @param intr Intrinsics of every Camera whose views are written.
+    /// @param options Compression of the depth images. Each image is one chunk.
+    /// @param capacity Number of views which may wait to be written. At least one.
+    /// @return Shared pointer to a ViewLogWriter.
+    /// @throws Any exception encountered while creating the HDF5 file.
+    static std::shared_ptr<ViewLogWriter> create(const std::filesystem::path& fpath,
+                                                 const std::shared_ptr<const Intrinsics>& intr,
+                                                 const utilities::DataSetOptions& options = utilities::DataSetOptions(),
+                                                 const size_t& capacity = default_capacity)
+    {
+        return std::shared_ptr<ViewLogWriter>(new ViewLogWriter(fpath, intr, options, capacity));
+    }
+
+
+    /// @brief Finishes writing the queued views. Exceptions from the writer thread are discarded;
+    ///        call `close` to receive them.
+    ~ViewLogWriter()
+    {
+        try
+        {
+            this->close();
+        }
+        catch (...)
+        {
+
+        }
+    }
+
+
+    /// @brief Queues a copy of the Camera's depth image and pose to be written.
+    /// @param camera Camera to record. Its Intrinsics must have the same width and height as the
+    ///               log's.
+    /// @throws std::invalid_argument If the image does not match the log's size.
+    /// @throws std::runtime_error If the log has been closed.
+    /// @throws Any exception from the writer thread.
+    void write(const std::shared_ptr<const Camera>& camera)
+    {
+        const DepthImage& image = camera->getImage();
+        if (static_cast<size_t>(image.rows()) != this->height || static_cast<size_t>(image.cols()) != this->width)
+        {
+            throw std::invalid_argument("Image does not match the size of the view log.");
+        }
+        this->rethrowIfFailed();
+
+        Frame* frame = nullptr;
+        if (!this->writer.joinable() || !this->free_frames->pop(frame))
+        {
+            this->rethrowIfFailed();
+            throw std::runtime_error("Cannot write a view to a closed view log.");
+        }
+        frame->depth = image;
+        frame->pose  = camera->getExtr().matrix();
+        if (!this->to_write->push(frame))
+        {
+            this->rethrowIfFailed();
+        }
+    }
+
+
+    /// @brief Writes every queued view, stops the writer thread, and closes the file.
+    /// @throws Any exception from the writer thread.
+    void close()
+    {
+        if (this->writer.joinable())
+        {
+            this->to_write->close();
+            this->writer.join();
+            this->free_frames->close();
+            std::lock_guard<std::recursive_mutex> hdf5_lock(utilities::hdf5Mutex());
+            this->depth_dset.reset();
+            this->pose_dset.reset();
+            this->file.reset();
+        }
+        this->rethrowIfFailed();
+    }
+
+
+    /// @brief Returns the number of views written to the file so far.
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->n_written;
+    }
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief One view waiting to be written. Both are row-major to match the data set layout.
+    struct Frame
+    {
+        Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> depth;
+        Eigen::Matrix<float, 4, 4, Eigen::RowMajor> pose;
+    };
+
+
+    /// @brief Private constructor to enforce shared pointer usage.
+    ViewLogWriter(const std::filesystem::path& fpath, const std::shared_ptr<const Intrinsics>& intr,
+                  const utilities::DataSetOptions& options, const size_t& capacity)
+        : width(intr->width),
+          height(intr->height),
+          frames(std::max(capacity, size_t(1))),
+          free_frames(std::make_unique<utilities::BoundedQueue<Frame*>>(frames.size())),
+          to_write(std::make_unique<utilities::BoundedQueue<Frame*>>(frames.size()))
+    {
+        {
+            std::lock_guard<std::recursive_mutex> hdf5_lock(utilities::hdf5Mutex());
+            this->file = std::make_unique<HighFive::File>(fpath.string(), HighFive::File::Overwrite);
+            HighFive::Group g_log = this->file->createGroup(FS_HDF5_VIEW_LOG_GROUP);
+
+            g_log.createAttribute("width",  this->width);
+            g_log.createAttribute("height", this->height);
+            g_log.createAttribute("min_d",  intr->min_d);
+            g_log.createAttribute("max_d",  intr->max_d);
+            g_log.createAttribute("f_x",    intr->f_x);
+            g_log.createAttribute("f_y",    intr->f_y);
+            g_log.createAttribute("c_x",    intr->c_x);
+            g_log.createAttribute("c_y",    intr->c_y);
+
+            this->depth_dset = std::make_unique<HighFive::DataSet>(
+                ViewLogWriter::createLog(g_log, FS_HDF5_VIEW_LOG_DEPTH, this->height, this->width, 1, options));
+            this->pose_dset = std::make_unique<HighFive::DataSet>(
+                ViewLogWriter::createLog(g_log, FS_HDF5_VIEW_LOG_POSE, 4, 4, 64, utilities::DataSetOptions()));
+        }
+
+        for (auto& frame : this->frames)
+        {
+            frame.depth.resize(this->height, this->width);
+            this->free_frames->push(&frame);
+        }
+        this->writer = std::thread([this]() { this->run(); });
+    }
+
+
+    /// @brief Creates an empty, extendible data set of 2D entries.
+    /// @param group Group to create the data set in.
+    /// @param name Name of the data set.
+    /// @param rows Number of rows in each entry.
+    /// @param cols Number of columns in each entry.
+    /// @param chunk_entries Number of entries in each chunk.
+    /// @param options Compression for the data set.
+    /// @return DataSet Object.
+    static HighFive::DataSet createLog(HighFive::Group& group, const std::string& name,
+                                       const size_t& rows, const size_t& cols, const size_t& chunk_entries,
+                                       const utilities::DataSetOptions& options)
+    {
+        HighFive::DataSetCreateProps props;
+        props.add(HighFive::Chunking(std::vector<hsize_t>{chunk_entries, rows, cols}));
+        options.addFilters<float>(props);
+        return group.createDataSet<float>(name, HighFive::DataSpace({0, rows, cols},
+                                                                    {HighFive::DataSpace::UNLIMITED, rows, cols}),
+                                          props);
+    }
+
+
+    /// @brief Body of the writer thread. Appends each queued view to the data sets.
+    void run()
+    {
+        try
+        {
+            Frame* frame = nullptr;
+            while (this->to_write->pop(frame))
+            {
+                const size_t n = this->n_written;
+                {
+                    std::lock_guard<std::recursive_mutex> hdf5_lock(utilities::hdf5Mutex());
+                    this->depth_dset->resize({n + 1, this->height, this->width});
+                    this->depth_dset->select({n, 0, 0}, {1, this->height, this->width}).write_raw(frame->depth.data());
+                    this->pose_dset->resize({n + 1, 4, 4});
+                    this->pose_dset->select({n, 0, 0}, {1, 4, 4}).write_raw(frame->pose.data());
+                }
+                {
+                    std::lock_guard<std::mutex> lock(this->mutex);
+                    ++this->n_written;
+                }
+                this->free_frames->push(frame);
+            }
+            std::lock_guard<std::recursive_mutex> hdf5_lock(utilities::hdf5Mutex());
+            this->file->flush();
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->error = std::current_exception();
+            }
+            this->free_frames->close();
+            this->to_write->close();
+        }
+    }
+
+
+    /// @brief Rethrows the writer thread's exception, if it threw one.
+    void rethrowIfFailed()
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->error)
+        {
+            std::rethrow_exception(this->error);
+        }
+    }
+
+
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Size of each depth image.
+    const size_t width, height;
+
+    /// @brief Storage for the views waiting to be written.
+    std::vector<Frame> frames;
+
+    /// @brief Queues of free buffers and of buffers waiting to be written.
+    std::unique_ptr<utilities::BoundedQueue<Frame*>> free_frames, to_write;
+
+    /// @brief The open file and its data sets. Only used by the writer thread after construction.
+    std::unique_ptr<HighFive::File> file;
+    std::unique_ptr<HighFive::DataSet> depth_dset, pose_dset;
+
+    /// @brief Number of views written.
+    size_t n_written = 0;
+
+    /// @brief Exception thrown by the writer thread.
+    std::exception_ptr error{nullptr};
+
+    /// @brief Guards the count and the error.
+    mutable std::mutex mutex;
+
+    /// @brief Thread which writes the queued views.
+    std::thread writer;
+};
+
+
+/// @brief Reads the views recorded by a `ViewLogWriter`.
+class ViewLogReader
+{
+public:
+    /// @brief Constructor for a shared pointer to a ViewLogReader.
+    /// @param fpath Location of the HDF5 file.
+    /// @return Shared pointer to a ViewLogReader.
+    /// @throws std::invalid_argument If the file does not exist.
+    /// @throws Any exception encountered while reading the HDF5 file.
+    static std::shared_ptr<ViewLogReader> create(const std::filesystem::path& fpath)
+    {
+        return std::shared_ptr<ViewLogReader>(new ViewLogReader(fpath));
+    }
+
+
+    /// @brief Returns the number of views in the log.
+    size_t size() const
+    {
+        return this->n_views;
+    }
+
+
+    /// @brief Returns the Intrinsics of the Camera the views were recorded with.
+    const std::shared_ptr<const Intrinsics>& getIntr() const
+    {
+        return this->intr;
+    }
+
+
+    /// @brief Reads one view.
+    /// @param i Index of the view, in the order they were written.
+    /// @param [out] image Depth image of the view.
+    /// @param [out] extr Pose of the Camera when the view was taken.
+    /// @throws std::out_of_range If `i` is not less than `size()`.
+    void read(const size_t& i, DepthImage& image, Extrinsic& extr) const
+    {
+        if (i >= this->n_views)
+        {
+            throw std::out_of_range("View " + std::to_string(i) + " is not in the view log.");
+        }
+        const size_t width = this->intr->width, height = this->intr->height;
+        this->depth_buffer.resize(height, width);
+        std::lock_guard<std::recursive_mutex> hdf5_lock(utilities::hdf5Mutex());
+        this->depth_dset.select({i, 0, 0}, {1, height, width}).read(this->depth_buffer.data());
+        this->pose_dset.select({i, 0, 0}, {1, 4, 4}).read(this->pose_buffer.data());
+        image = this->depth_buffer;
+        extr.matrix() = this->pose_buffer;
+    }
+
+
+    /// @brief Reads one view into a Camera.
+    /// @param i Index of the view, in the order they were written.
+    /// @param [out] camera Camera to set the depth image and pose of. Its Intrinsics should match
+    ///                     `getIntr`.
+    /// @throws std::out_of_range If `i` is not less than `size()`.
+    void read(const size_t& i, const std::shared_ptr<Camera>& camera) const
+    {
+        Extrinsic extr;
+        this->read(i, camera->image, extr);
+        camera->setExtr(extr);
+    }
+
+
+    /// @brief Creates a Camera, with no noise, for the Intrinsics of the log.
+    std::shared_ptr<Camera> createCamera() const
+    {
+        return Camera::create(this->intr, 0.0f);
+    }
+
+
+private:
+    /// @brief Private constructor to enforce shared pointer usage.
+    explicit ViewLogReader(const std::filesystem::path& fpath)
+        : file((ViewLogReader::checkExists(fpath), fpath.string()), HighFive::File::ReadOnly),
+          depth_dset(file.getGroup(FS_HDF5_VIEW_LOG_GROUP).getDataSet(FS_HDF5_VIEW_LOG_DEPTH)),
+          pose_dset(file.getGroup(FS_HDF5_VIEW_LOG_GROUP).getDataSet(FS_HDF5_VIEW_LOG_POSE))
+    {
+        const HighFive::Group g_log = this->file.getGroup(FS_HDF5_VIEW_LOG_GROUP);
+        auto get = [&g_log](const std::string& name) { return g_log.getAttribute(name).read<float>(); };
+
+        Eigen::Matrix3f K = Eigen::Matrix3f::Identity();
+        K(0, 0) = get("f_x");
+        K(1, 1) = get("f_y");
+        K(0, 2) = get("c_x");
+        K(1, 2) = get("c_y");
+        this->intr = Intrinsics::create(g_log.getAttribute("width").read<size_t>(),
+                                        g_log.getAttribute("height").read<size_t>(),
+                                        get("min_d"), get("max_d"), K);
+
+        const std::vector<size_t> dims = this->depth_dset.getSpace().getDimensions();
+        this->n_views = dims.empty() ? 0 : dims[0];
+    }
+
+
+    /// @brief Throws if the file does not exist.
+    static void checkExists(const std::filesystem::path& fpath)
+    {
+        if (!std::filesystem::exists(fpath))
+        {
+            throw std::invalid_argument("View log file does not exist: " + fpath.string());
+        }
+    }
+
+
+    /// @brief The open file and its data sets.
+    HighFive::File file;
+    HighFive::DataSet depth_dset, pose_dset;
+
+    /// @brief Intrinsics of the Camera the views were recorded with.
+    std::shared_ptr<const Intrinsics> intr;
+
+    /// @brief Number of views in the log.
+    size_t n_views = 0;
+
+    /// @brief Row-major buffers matching the data set layout.
+    mutable Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> depth_buffer;
+    mutable Eigen::Matrix<float, 4, 4, Eigen::RowMajor> pose_buffer;
+};
+
+
+} // namespace sensor
+} // namespace forge_scan
+
+
+#undef FS_HDF5_VIEW_LOG_GROUP
+#undef FS_HDF5_VIEW_LOG_DEPTH
+#undef FS_HDF5_VIEW_LOG_POSE
+
+#endif // FORGE_SCAN_SENSOR_VIEW_LOG_HPP
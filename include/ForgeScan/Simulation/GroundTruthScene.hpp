@@ -1,7 +1,11 @@
 #ifndef FORGE_SCAN_SIMULATION_GROUND_TRUTH_SCENE_H
 #define FORGE_SCAN_SIMULATION_GROUND_TRUTH_SCENE_H
 
+#include <limits>
+
 #include "ForgeScan/Simulation/Scene.hpp"
+#include "ForgeScan/Utilities/HDF5.hpp"
+#include "ForgeScan/Utilities/Hash.hpp"
 #include "ForgeScan/Utilities/XDMF.hpp"
 
 
@@ -14,6 +18,8 @@
 #define FS_HDF5_GROUND_TRUTH_GROUP        "GroundTruth"
 #define FS_HDF5_OCCUPANCY_DSET            "Occupancy"
 #define FS_HDF5_TSDF_DSET                 "TSDF"
+#define FS_HDF5_OCCUPANCY_TILES_DSET      "OccupancyTiles"
+#define FS_HDF5_TSDF_TILES_DSET           "TSDFTiles"
 
 
 namespace forge_scan {
@@ -83,11 +89,17 @@ struct GroundTruthScene : public Scene
         std::string occupancy_dset_path, tsdf_dset_path;
 
         if (this->true_occupancy) {
-            occupancy_dset_path = this->true_occupancy->save(g_ground_truth).getPath();
+            occupancy_dset_path = this->true_occupancy->save(g_ground_truth, this->dataset_options).getPath();
+            if (!this->occupancy_tile_hashes.empty()) {
+                g_ground_truth.createDataSet(FS_HDF5_OCCUPANCY_TILES_DSET, this->occupancy_tile_hashes);
+            }
         }
 
         if (this->true_tsdf) {
-            tsdf_dset_path = this->true_tsdf->save(g_ground_truth).getPath();
+            tsdf_dset_path = this->true_tsdf->save(g_ground_truth, this->dataset_options).getPath();
+            if (!this->tsdf_tile_hashes.empty()) {
+                g_ground_truth.createDataSet(FS_HDF5_TSDF_TILES_DSET, this->tsdf_tile_hashes);
+            }
         }
 
         if (this->true_occupancy || this->true_tsdf) {
@@ -107,20 +119,29 @@ struct GroundTruthScene : public Scene
 
             GridSize grid_size = g_ground_truth.getAttribute(FS_HDF5_GRID_SIZE_ATTR).read<GridSize>();
             float res          = g_ground_truth.getAttribute(FS_HDF5_GRID_RESOLUTION_ATTR).read<float>();
-            this->grid_properties = Grid::Properties::createConst(res, grid_size);
+
+            // Files store data in the linear order. Keep the storage and layout that were requested
+            // for this scene and reorder the data to match.
+            this->grid_properties = Grid::Properties::createConst(res, grid_size, this->grid_properties->sparse,
+                                                                  this->grid_properties->brick_size);
 
 
             auto ground_truth_groups = g_ground_truth.listObjectNames();
 
-            if(std::find(ground_truth_groups.begin(), ground_truth_groups.end(), FS_HDF5_OCCUPANCY_DSET) != ground_truth_groups.end())
+            // A grid with unfinished tiles is from an interrupted calculation, so it is not loaded.
+            if(std::find(ground_truth_groups.begin(), ground_truth_groups.end(), FS_HDF5_OCCUPANCY_DSET) != ground_truth_groups.end() &&
+               GroundTruthScene::readTileHashes(g_ground_truth, FS_HDF5_OCCUPANCY_TILES_DSET, this->occupancy_tile_hashes))
             {
-                std::vector<uint8_t> data = g_ground_truth.getDataSet(FS_HDF5_OCCUPANCY_DSET).read<std::vector<uint8_t>>();
+                std::vector<uint8_t> data = this->grid_properties->fromLinearOrder(
+                    g_ground_truth.getDataSet(FS_HDF5_OCCUPANCY_DSET).read<std::vector<uint8_t>>());
                 this->true_occupancy = metrics::ground_truth::Occupancy::create(this->grid_properties, data);
             }
 
-            if(std::find(ground_truth_groups.begin(), ground_truth_groups.end(), FS_HDF5_TSDF_DSET) != ground_truth_groups.end())
+            if(std::find(ground_truth_groups.begin(), ground_truth_groups.end(), FS_HDF5_TSDF_DSET) != ground_truth_groups.end() &&
+               GroundTruthScene::readTileHashes(g_ground_truth, FS_HDF5_TSDF_TILES_DSET, this->tsdf_tile_hashes))
             {
-                std::vector<double> data = g_ground_truth.getDataSet(FS_HDF5_TSDF_DSET).read<std::vector<double>>();
+                std::vector<double> data = this->grid_properties->fromLinearOrder(
+                    g_ground_truth.getDataSet(FS_HDF5_TSDF_DSET).read<std::vector<double>>());
                 this->true_tsdf = metrics::ground_truth::TSDF::create(this->grid_properties, data);
             }
         }
@@ -142,6 +163,32 @@ struct GroundTruthScene : public Scene
     void calculateGroundTruthOccupancy()
     {
         this->true_occupancy = Scene::calculateGroundTruthOccupancy(this->grid_properties, this->grid_lower_bound);
+        this->occupancy_tile_hashes = this->getTileHashes(false);
+    }
+
+
+    /// @brief Calculates the scene's occupancy for the scan location, resuming from and adding to
+    ///        the tiles cached in a ground truth file.
+    /// @param fpath Ground truth HDF5 file to use as the cache. It is created if it does not exist.
+    /// @details The grid is calculated in tiles of Z-planes, see `getTilePlanes`. Each tile which
+    ///          is already in the file with a matching hash is read rather than calculated. Every
+    ///          other tile is written to the file, and then its hash, as soon as it is finished.
+    ///          An interrupted run therefore resumes from the last finished tile.
+    /// @note   A tile's occupancy only depends on the meshes whose bounds overlap it, so moving one
+    ///         mesh only recalculates the tiles it was, or now is, within.
+    /// @note   The file keeps the layout written by `save`. Saving to the same file afterwards
+    ///         keeps the tile hashes for the next run.
+    /// @throws Any exception encountered while reading or writing the HDF5 file.
+    void calculateGroundTruthOccupancy(const std::filesystem::path& fpath)
+    {
+        this->true_occupancy = metrics::ground_truth::Occupancy::create(this->grid_properties);
+        this->occupancy_tile_hashes = this->getTileHashes(false);
+        this->calculateCachedTiles(fpath, FS_HDF5_OCCUPANCY_DSET, FS_HDF5_OCCUPANCY_TILES_DSET,
+                                   this->occupancy_tile_hashes, this->true_occupancy->data,
+            [&](const size_t& z_first, const size_t& z_last, uint8_t* dest)
+            {
+                this->calculateOccupancyPlanes(*this->grid_properties, this->grid_lower_bound, z_first, z_last, dest);
+            });
     }
 
 
@@ -160,6 +207,35 @@ struct GroundTruthScene : public Scene
     void calculateGroundTruthTSDF()
     {
         this->true_tsdf = Scene::calculateGroundTruthTSDF(this->grid_properties, this->grid_lower_bound);
+        this->tsdf_tile_hashes = this->getTileHashes(true);
+    }
+
+
+    /// @brief Calculates the scene's TSDF for the scan location, resuming from and adding to the
+    ///        tiles cached in a ground truth file. See `calculateGroundTruthOccupancy(fpath)`.
+    /// @param fpath Ground truth HDF5 file to use as the cache. It is created if it does not exist.
+    /// @note   The distance within a tile may depend on any surface in the scene, so every tile's
+    ///         hash includes every mesh.
+    /// @throws Any exception encountered while reading or writing the HDF5 file.
+    void calculateGroundTruthTSDF(const std::filesystem::path& fpath)
+    {
+        this->true_tsdf = metrics::ground_truth::TSDF::create(this->grid_properties);
+        this->tsdf_tile_hashes = this->getTileHashes(true);
+        this->calculateCachedTiles(fpath, FS_HDF5_TSDF_DSET, FS_HDF5_TSDF_TILES_DSET,
+                                   this->tsdf_tile_hashes, this->true_tsdf->data,
+            [&](const size_t& z_first, const size_t& z_last, double* dest)
+            {
+                this->calculateTSDFPlanes(*this->grid_properties, this->grid_lower_bound, z_first, z_last, dest);
+            });
+    }
+
+
+    /// @brief Returns the number of Z-planes of voxels in each tile of the ground truth cache.
+    /// @note  Tiles are sized to hold at most `max_points_per_slab` voxels, with at least one plane.
+    size_t getTilePlanes() const
+    {
+        const size_t voxel_plane = this->grid_properties->size.x() * this->grid_properties->size.y();
+        return std::max(Scene::max_points_per_slab / voxel_plane, size_t(1));
     }
 
 
@@ -177,6 +253,16 @@ struct GroundTruthScene : public Scene
     /// @brief Shared reference to a Ground Truth TSDF for the Scene.
     std::shared_ptr<metrics::ground_truth::TSDF> true_tsdf{nullptr};
 
+    /// @brief Content hash of each tile of `true_occupancy`. See `calculateGroundTruthOccupancy`.
+    std::vector<uint64_t> occupancy_tile_hashes;
+
+    /// @brief Content hash of each tile of `true_tsdf`. See `calculateGroundTruthTSDF`.
+    std::vector<uint64_t> tsdf_tile_hashes;
+
+    /// @brief Chunking and compression for the ground truth data sets. Default writes uncompressed
+    ///        data sets. Cached tiles are always chunked one tile to a chunk.
+    utilities::DataSetOptions dataset_options;
+
 
 protected:
     /// @brief Private constructor to enforce shared pointer usage.
@@ -189,6 +275,196 @@ protected:
     }
 
 
+    /// @brief Calculates a ground truth grid in tiles, reading finished tiles from a cache file.
+    /// @param fpath Ground truth HDF5 file to use as the cache. It is created if it does not exist.
+    /// @param dset_name Name of the dataset for the grid's data.
+    /// @param tiles_dset_name Name of the dataset for the tile hashes.
+    /// @param tile_hashes Current hash of each tile, as given by `getTileHashes`.
+    /// @param [out] data Data vector of the ground truth grid, in its layout.
+    /// @param calculate Callable with the signature `void(z_first, z_last, T* dest)` which writes
+    ///                  the planes `[z_first, z_last)` in the X-major linear order.
+    template <typename T, typename Calculate>
+    void calculateCachedTiles(std::filesystem::path fpath, const std::string& dset_name,
+                              const std::string& tiles_dset_name, const std::vector<uint64_t>& tile_hashes,
+                              std::vector<T>& data, Calculate&& calculate)
+    {
+        utilities::validateAndCreateFilepath(fpath, FS_HDF5_FILE_EXTENSION, "Scene", true);
+        HighFive::File file(fpath.string(), HighFive::File::OpenOrCreate);
+
+        auto g_scene = file.exist(FS_HDF5_GROUND_TRUTH_SCENE_GROUP) ? file.getGroup(FS_HDF5_GROUND_TRUTH_SCENE_GROUP)
+                                                                    : file.createGroup(FS_HDF5_GROUND_TRUTH_SCENE_GROUP);
+        auto g_ground_truth = g_scene.exist(FS_HDF5_GROUND_TRUTH_GROUP) ? g_scene.getGroup(FS_HDF5_GROUND_TRUTH_GROUP)
+                                                                        : g_scene.createGroup(FS_HDF5_GROUND_TRUTH_GROUP);
+        GroundTruthScene::writeAttribute(g_ground_truth, FS_HDF5_GRID_SIZE_ATTR,       this->grid_properties->size);
+        GroundTruthScene::writeAttribute(g_ground_truth, FS_HDF5_GRID_RESOLUTION_ATTR, this->grid_properties->resolution);
+        GroundTruthScene::writeAttribute(g_ground_truth, FS_HDF5_GRID_DIMENSIONS_ATTR, this->grid_properties->dimensions);
+
+        const size_t nx = this->grid_properties->size.x(), ny = this->grid_properties->size.y(),
+                     nz = this->grid_properties->size.z();
+        const size_t n_voxels    = this->grid_properties->getNumVoxels();
+        const size_t tile_planes = this->getTilePlanes();
+        const size_t n_tiles     = tile_hashes.size();
+
+        // Reuse the cached tiles only if the grid's shape is unchanged. Otherwise start over.
+        std::vector<uint64_t> stored_hashes(n_tiles, 0);
+        if (g_ground_truth.exist(dset_name) && g_ground_truth.exist(tiles_dset_name) &&
+            g_ground_truth.getDataSet(dset_name).getElementCount()       == n_voxels &&
+            g_ground_truth.getDataSet(tiles_dset_name).getElementCount() == n_tiles)
+        {
+            stored_hashes = g_ground_truth.getDataSet(tiles_dset_name).read<std::vector<uint64_t>>();
+        }
+        else
+        {
+            if (g_ground_truth.exist(dset_name)) {
+                g_ground_truth.unlink(dset_name);
+            }
+            if (g_ground_truth.exist(tiles_dset_name)) {
+                g_ground_truth.unlink(tiles_dset_name);
+            }
+            // One tile to a chunk, so writing a tile never rewrites, or recompresses, its neighbors.
+            utilities::DataSetOptions tile_options = this->dataset_options;
+            tile_options.chunk_bytes = tile_planes * nx * ny * sizeof(T);
+            g_ground_truth.createDataSet<T>(dset_name, HighFive::DataSpace({n_voxels}),
+                                            tile_options.getCreateProps<T>(n_voxels, this->grid_properties->size));
+            g_ground_truth.createDataSet(tiles_dset_name, stored_hashes);
+        }
+
+        auto dset       = g_ground_truth.getDataSet(dset_name);
+        auto tiles_dset = g_ground_truth.getDataSet(tiles_dset_name);
+
+        std::vector<T> tile;
+        for (size_t t = 0; t < n_tiles; ++t)
+        {
+            const size_t z_first = t * tile_planes, z_last = std::min(z_first + tile_planes, nz);
+            tile.resize((z_last - z_first) * nx * ny);
+
+            auto selection = dset.select({z_first * nx * ny}, {tile.size()});
+            if (stored_hashes[t] == tile_hashes[t])
+            {
+                selection.read(tile);
+            }
+            else
+            {
+                calculate(z_first, z_last, tile.data());
+                selection.write(tile);
+
+                // The hash is only written once the tile is, so an interrupted write is redone.
+                stored_hashes[t] = tile_hashes[t];
+                tiles_dset.write(stored_hashes);
+                file.flush();
+            }
+            Scene::storePlanes(*this->grid_properties, z_first, z_last, tile.data(), data);
+        }
+    }
+
+
+    /// @brief Calculates the content hash of each tile of the ground truth grid.
+    /// @param all_meshes If true every mesh is included in every tile's hash. Otherwise a tile only
+    ///                   includes the meshes whose bounds overlap it.
+    /// @return Hash of each tile, from the lowest Z-plane up. A hash is never zero.
+    /// @note  Each hash covers the Grid Properties, the grid's lower bound, the tile's planes, and
+    ///        the file contents, scale, and extrinsic of each included mesh.
+    std::vector<uint64_t> getTileHashes(const bool& all_meshes) const
+    {
+        const size_t nx = this->grid_properties->size.x(), ny = this->grid_properties->size.y(),
+                     nz = this->grid_properties->size.z();
+        const float  res = this->grid_properties->resolution;
+        const size_t tile_planes = this->getTilePlanes();
+
+        uint64_t grid_hash = utilities::hash_seed;
+        grid_hash = utilities::hashValue(grid_hash, res);
+        grid_hash = utilities::hashBytes(grid_hash, this->grid_properties->size.data(), sizeof(GridSize::Scalar) * 3);
+        grid_hash = utilities::hashValue(grid_hash, tile_planes);
+        grid_hash = utilities::hashValue(grid_hash, all_meshes);
+        grid_hash = utilities::hashBytes(grid_hash, this->grid_lower_bound.data(), sizeof(float) * 16);
+
+        // Mesh bounds are found relative to the grid's lower bound.
+        std::vector<std::pair<uint64_t, Eigen::AlignedBox3f>> meshes;
+        const Extrinsic world_to_grid = this->grid_lower_bound.inverse();
+        for (const auto& item : this->geometry->getMeshes())
+        {
+            uint64_t mesh_hash = utilities::hashFile(utilities::hash_seed, item.first.fpath);
+            mesh_hash = utilities::hashValue(mesh_hash, item.first.scale);
+            mesh_hash = utilities::hashBytes(mesh_hash, item.first.extr.data(), sizeof(float) * 16);
+
+            Eigen::AlignedBox3f bounds;
+            auto min_bound = item.second.GetMinBound().To(open3d::core::Float32).Contiguous();
+            auto max_bound = item.second.GetMaxBound().To(open3d::core::Float32).Contiguous();
+            if (min_bound.NumElements() == 3 && max_bound.NumElements() == 3)
+            {
+                const Eigen::AlignedBox3f world(Point(min_bound.GetDataPtr<float>()), Point(max_bound.GetDataPtr<float>()));
+                for (int corner = 0; corner < 8; ++corner)
+                {
+                    bounds.extend(world_to_grid * world.corner(static_cast<Eigen::AlignedBox3f::CornerType>(corner)));
+                }
+            }
+            else
+            {
+                // Without bounds the mesh is assumed to overlap every tile.
+                bounds.setEmpty();
+                bounds.extend(Point::Constant(-std::numeric_limits<float>::max()));
+                bounds.extend(Point::Constant( std::numeric_limits<float>::max()));
+            }
+            meshes.push_back({mesh_hash, bounds});
+        }
+
+        std::vector<uint64_t> tile_hashes;
+        for (size_t z_first = 0; z_first < nz; z_first += tile_planes)
+        {
+            const size_t z_last = std::min(z_first + tile_planes, nz);
+
+            // Conservative bounds of the points a tile tests, which includes each voxel's vertices.
+            const Eigen::AlignedBox3f tile(Point(-res, -res, (static_cast<float>(z_first) - 1) * res),
+                                           Point(nx * res, ny * res, z_last * res));
+
+            uint64_t hash = utilities::hashValue(grid_hash, z_first);
+            for (const auto& mesh : meshes)
+            {
+                if (all_meshes || tile.intersects(mesh.second))
+                {
+                    hash = utilities::hashValue(hash, mesh.first);
+                }
+            }
+            tile_hashes.push_back(hash != 0 ? hash : 1);
+        }
+        return tile_hashes;
+    }
+
+
+    /// @brief Reads the tile hashes of a ground truth grid.
+    /// @param g_ground_truth Group to read from.
+    /// @param tiles_dset_name Name of the dataset for the tile hashes.
+    /// @param [out] tile_hashes Hashes that were read. Cleared if there are none.
+    /// @return False if the grid has any unfinished tiles. True otherwise, including if the grid has
+    ///         no tile hashes.
+    static bool readTileHashes(const HighFive::Group& g_ground_truth, const std::string& tiles_dset_name,
+                               std::vector<uint64_t>& tile_hashes)
+    {
+        tile_hashes.clear();
+        if (g_ground_truth.exist(tiles_dset_name))
+        {
+            tile_hashes = g_ground_truth.getDataSet(tiles_dset_name).read<std::vector<uint64_t>>();
+        }
+        return std::find(tile_hashes.begin(), tile_hashes.end(), 0) == tile_hashes.end();
+    }
+
+
+    /// @brief Writes an attribute, replacing its value if it already exists.
+    /// @param group Group to write the attribute in.
+    /// @param name Name of the attribute.
+    /// @param value Value to write.
+    template <typename T>
+    static void writeAttribute(HighFive::Group& group, const std::string& name, const T& value)
+    {
+        if (group.hasAttribute(name))
+        {
+            group.getAttribute(name).write(value);
+            return;
+        }
+        group.createAttribute(name, value);
+    }
+
+
     /// @brief Writes an XDMF to pair with the HDF5 file for visualizing the data in tools like
     ///        ParaView.
     /// @param fpath File path, with file name, for the HDF5 file.
@@ -265,6 +541,8 @@ protected:
 #undef FS_HDF5_GROUND_TRUTH_GROUP
 #undef FS_HDF5_OCCUPANCY_DSET
 #undef FS_HDF5_TSDF_DSET
+#undef FS_HDF5_OCCUPANCY_TILES_DSET
+#undef FS_HDF5_TSDF_TILES_DSET
 
 
 } // namespace simulation
@@ -0,0 +1,288 @@
+#ifndef FORGE_SCAN_SIMULATION_MESH_CACHE_HPP
+#define FORGE_SCAN_SIMULATION_MESH_CACHE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <system_error>
+
+#include <open3d/core/Blob.h>
+#include <open3d/core/Tensor.h>
+
+#include "ForgeScan/Utilities/Hash.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define FORGE_SCAN_MESH_CACHE_HAS_MMAP
+#endif
+
+
+namespace forge_scan {
+namespace simulation {
+
+
+/// @brief Cache of scaled mesh files in a binary format, which load without being parsed.
+/// @details Each entry holds the vertex positions, as float32, and triangle indices, as uint32, in
+///          the layout Open3D's RaycastingScene takes them. An entry is keyed by the absolute path,
+///          size, and modification time of the mesh file, and by the scale applied to it. Editing the
+///          mesh, or using a new scale, makes a new entry.
+/// @note  Entries are memory-mapped copy-on-write when read on POSIX systems. Transforming the
+///        vertices copies only their pages, the triangle indices are used straight from the file.
+/// @note  The directory is set by the `FORGE_SCAN_MESH_CACHE_DIR` environment variable. The system's
+///        temporary directory is used if it is not set, and caching is disabled if it is empty.
+struct MeshCache
+{
+    /// @brief File extension for cache entries.
+    static constexpr char extension[] = ".fsmesh";
+
+
+    /// @brief Gets the cache directory.
+    /// @return Path to the directory. Empty if caching is disabled.
+    static std::filesystem::path getDirectory()
+    {
+        return MeshCache::directory();
+    }
+
+
+    /// @brief Sets the cache directory for the rest of the process.
+    /// @param path Path to the directory. It is created when the first entry is written. An empty
+    ///             path disables caching.
+    static void setDirectory(const std::filesystem::path& path)
+    {
+        MeshCache::directory() = path;
+    }
+
+
+    /// @brief Reads a cached mesh.
+    /// @param fpath Path to the mesh file the entry was made from.
+    /// @param scale Scale the entry was made with.
+    /// @param [out] vertices Tensor of shape {N, 3} and type Float32 for the cached vertex positions.
+    /// @param [out] triangles Tensor of shape {M, 3} and type UInt32 for the cached triangle indices.
+    /// @return True if a valid entry was found. False if not, and the outputs are unchanged.
+    static bool read(const std::filesystem::path& fpath, const float& scale,
+                     open3d::core::Tensor& vertices, open3d::core::Tensor& triangles)
+    {
+        Header expected;
+        const std::filesystem::path entry = MeshCache::getEntryPath(fpath, scale, expected);
+        if (entry.empty())
+        {
+            return false;
+        }
+#ifdef FORGE_SCAN_MESH_CACHE_HAS_MMAP
+        const int fd = ::open(entry.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header))
+        {
+            ::close(fd);
+            return false;
+        }
+        const size_t n_bytes = static_cast<size_t>(info.st_size);
+        void* region = ::mmap(nullptr, n_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (region == MAP_FAILED)
+        {
+            return false;
+        }
+
+        Header header;
+        std::memcpy(&header, region, sizeof(Header));
+        if (!header.matches(expected) || n_bytes != header.sizeBytes())
+        {
+            ::munmap(region, n_bytes);
+            return false;
+        }
+
+        // Both Tensors share the mapping, which is released once neither uses it.
+        auto blob = std::make_shared<open3d::core::Blob>(open3d::core::Device("CPU:0"), region,
+                                                         [n_bytes](void* ptr) { ::munmap(ptr, n_bytes); });
+        char* vertex_ptr   = static_cast<char*>(region) + sizeof(Header);
+        char* triangle_ptr = vertex_ptr + header.vertexBytes();
+        vertices  = open3d::core::Tensor({header.n_vertices, 3}, {3, 1}, vertex_ptr,
+                                         open3d::core::Float32, blob);
+        triangles = open3d::core::Tensor({header.n_triangles, 3}, {3, 1}, triangle_ptr,
+                                         open3d::core::UInt32, blob);
+        return true;
+#else
+        std::error_code ec;
+        std::ifstream file(entry, std::ios::binary);
+        Header header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(Header)) || !header.matches(expected) ||
+            std::filesystem::file_size(entry, ec) != header.sizeBytes())
+        {
+            return false;
+        }
+        auto v = open3d::core::Tensor::Empty({header.n_vertices, 3},  open3d::core::Float32);
+        auto t = open3d::core::Tensor::Empty({header.n_triangles, 3}, open3d::core::UInt32);
+        if (!file.read(static_cast<char*>(v.GetDataPtr()), header.vertexBytes()) ||
+            !file.read(static_cast<char*>(t.GetDataPtr()), header.triangleBytes()))
+        {
+            return false;
+        }
+        vertices  = v;
+        triangles = t;
+        return true;
+#endif
+    }
+
+
+    /// @brief Writes a cache entry for a mesh.
+    /// @param fpath Path to the mesh file the entry is made from.
+    /// @param scale Scale applied to the mesh.
+    /// @param vertices Contiguous Tensor of shape {N, 3} and type Float32 with the scaled vertex positions.
+    /// @param triangles Contiguous Tensor of shape {M, 3} and type UInt32 with the triangle indices.
+    /// @return True if the entry was written. Failing to write is not an error, the mesh is only
+    ///         parsed again the next time.
+    /// @note  The entry is written to a temporary file and then renamed, so processes sharing the cache
+    ///        only ever read complete entries.
+    static bool write(const std::filesystem::path& fpath, const float& scale,
+                      const open3d::core::Tensor& vertices, const open3d::core::Tensor& triangles)
+    {
+        Header header;
+        const std::filesystem::path entry = MeshCache::getEntryPath(fpath, scale, header);
+        if (entry.empty())
+        {
+            return false;
+        }
+        header.n_vertices  = vertices.GetLength();
+        header.n_triangles = triangles.GetLength();
+
+        std::error_code ec;
+        std::filesystem::create_directories(entry.parent_path(), ec);
+        std::filesystem::path temp = entry;
+        temp += ".tmp" + std::to_string(std::random_device{}());
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            file.write(static_cast<const char*>(vertices.GetDataPtr()),  header.vertexBytes());
+            file.write(static_cast<const char*>(triangles.GetDataPtr()), header.triangleBytes());
+            if (!file)
+            {
+                file.close();
+                std::filesystem::remove(temp, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(temp, entry, ec);
+        if (ec)
+        {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Header at the start of each entry. The vertex and then the triangle data follow it.
+    struct Header
+    {
+        /// @brief Identifies the format and its version.
+        char magic[8] = {'F', 'S', 'M', 'E', 'S', 'H', '0', '1'};
+
+        /// @brief Hash of the mesh file's path, size, and modification time, and of the scale.
+        uint64_t key = 0;
+
+        /// @brief Number of vertices and of triangles.
+        int64_t n_vertices = 0, n_triangles = 0;
+
+
+        /// @brief Checks that the format and key match an expected header.
+        bool matches(const Header& other) const
+        {
+            return std::memcmp(this->magic, other.magic, sizeof(this->magic)) == 0 && this->key == other.key &&
+                   this->n_vertices >= 0 && this->n_triangles >= 0;
+        }
+
+        size_t vertexBytes() const
+        {
+            return static_cast<size_t>(this->n_vertices) * 3 * sizeof(float);
+        }
+
+        size_t triangleBytes() const
+        {
+            return static_cast<size_t>(this->n_triangles) * 3 * sizeof(uint32_t);
+        }
+
+        /// @brief Size of the entry this header describes.
+        size_t sizeBytes() const
+        {
+            return sizeof(Header) + this->vertexBytes() + this->triangleBytes();
+        }
+    };
+
+
+    /// @brief Stores the cache directory.
+    /// @return Reference to the directory, initialized from the environment on first use.
+    static std::filesystem::path& directory()
+    {
+        static std::filesystem::path path = []()
+        {
+            if (const char* env = std::getenv("FORGE_SCAN_MESH_CACHE_DIR"))
+            {
+                return std::filesystem::path(env);
+            }
+            std::error_code ec;
+            const std::filesystem::path temp = std::filesystem::temp_directory_path(ec);
+            return ec ? std::filesystem::path() : temp / "ForgeScanMeshCache";
+        }();
+        return path;
+    }
+
+
+    /// @brief Finds the entry for a mesh file and scale.
+    /// @param fpath Path to the mesh file.
+    /// @param scale Scale applied to the mesh.
+    /// @param [out] header Header with the key for the entry.
+    /// @return Path to the entry. Empty if caching is disabled or the mesh file cannot be found.
+    static std::filesystem::path getEntryPath(const std::filesystem::path& fpath, const float& scale, Header& header)
+    {
+        const std::filesystem::path& dir = MeshCache::directory();
+        std::error_code ec;
+        const std::filesystem::path abs_fpath = std::filesystem::absolute(fpath, ec);
+        if (dir.empty() || ec)
+        {
+            return std::filesystem::path();
+        }
+        const uintmax_t size  = std::filesystem::file_size(abs_fpath, ec);
+        const auto      mtime = std::filesystem::last_write_time(abs_fpath, ec).time_since_epoch().count();
+        if (ec)
+        {
+            return std::filesystem::path();
+        }
+
+        uint64_t key = utilities::hashString(utilities::hash_seed, abs_fpath.lexically_normal().string());
+        key = utilities::hashValue(key, static_cast<uint64_t>(size));
+        key = utilities::hashValue(key, static_cast<int64_t>(mtime));
+        key = utilities::hashValue(key, scale);
+        header.key = key;
+
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+        return dir / (fpath.stem().string() + "_" + hex + MeshCache::extension);
+    }
+};
+
+
+} // namespace simulation
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_SIMULATION_MESH_CACHE_HPP
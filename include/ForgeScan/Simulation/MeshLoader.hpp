@@ -9,6 +9,7 @@
 #include <open3d/t/io/TriangleMeshIO.h>
 
 #include "ForgeScan/Common/Entity.hpp"
+#include "ForgeScan/Simulation/MeshCache.hpp"
 
 
 namespace forge_scan {
@@ -67,8 +68,10 @@ struct MeshLoader
     /// @param extr  Extrinsic transformation to apply to the mesh.
     /// @param extra_search_path One additional path to search for the mesh file at.
     /// @param scale Scaling factor to apply to the mesh. Default 1.
-    /// @return A pair with the MeshInfo and the TriangleMesh object.
+    /// @return A pair with the MeshInfo and the TriangleMesh object. The mesh has only its vertex
+    ///         positions, as Float32, and triangle indices, as UInt32.
     /// @throws ConstructorError if there was an issue loading the mesh
+    /// @note  The scaled mesh is read from, or added to, the `MeshCache`.
     static std::pair<MeshInfo, open3d::t::geometry::TriangleMesh> create(std::filesystem::path fpath, Extrinsic& extr,
                                                                          std::filesystem::path extra_search_path,
                                                                          const float& scale = 1.0f)
@@ -98,16 +101,31 @@ struct MeshLoader
             throw ConstructorError("Cannot load mesh, no file name provided or file does not exist at: " + fpath.string());
         }
 
-        open3d::t::geometry::TriangleMesh mesh;
-        bool read_success = open3d::t::io::ReadTriangleMesh(fpath.string(), mesh);
-
-        if (read_success == false)
+        // Parsing a large ASCII mesh dominates loading a Scene. The scaled mesh is cached in a
+        // binary form, keyed by the file and scale, so each mesh is parsed only once.
+        open3d::core::Tensor vertices, triangles;
+        if (MeshCache::read(fpath, scale, vertices, triangles) == false)
         {
-            throw ConstructorError("Failed to read mesh file at: " + fpath.string());
+            open3d::t::geometry::TriangleMesh parsed;
+            bool read_success = open3d::t::io::ReadTriangleMesh(fpath.string(), parsed);
+
+            if (read_success == false)
+            {
+                throw ConstructorError("Failed to read mesh file at: " + fpath.string());
+            }
+
+            parsed.Scale(scale, origin);
+            vertices  = parsed.GetVertexPositions().To(open3d::core::Float32).Contiguous();
+            triangles = parsed.GetTriangleIndices().To(open3d::core::UInt32).Contiguous();
+            MeshCache::write(fpath, scale, vertices, triangles);
         }
 
-        mesh.Scale(scale, origin);
-        mesh.Transform(open3d::core::eigen_converter::EigenMatrixToTensor(extr.matrix()));
+        Eigen::Map<Eigen::Matrix<float, 3, Eigen::Dynamic>> positions(vertices.GetDataPtr<float>(), 3,
+                                                                      vertices.GetLength());
+        positions = extr * positions;
+
+        // The mesh only holds the Tensors, which may be added to a RaycastingScene as they are.
+        open3d::t::geometry::TriangleMesh mesh(vertices, triangles);
         return {{fpath.make_preferred(), extr, scale}, mesh};
     }
 
@@ -0,0 +1,321 @@
+#ifndef FORGE_SCAN_SIMULATION_PIPELINE_HPP
+#define FORGE_SCAN_SIMULATION_PIPELINE_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ForgeScan/Manager.hpp"
+#include "ForgeScan/Sensor/Camera.hpp"
+#include "ForgeScan/Simulation/Scene.hpp"
+#include "ForgeScan/Utilities/Threads.hpp"
+
+
+namespace forge_scan {
+namespace simulation {
+
+
+/// @brief Runs a simulated scan as a pipeline of three stages, each on its own thread, so the next
+///        view is rendered while the current one is integrated.
+/// @details The stages are:
+///              1. Render: gets a view from the Manager's active Policy and images the Scene.
+///              2. Deproject: turns the depth image into a matrix of Points.
+///              3. Integrate: updates the Reconstruction, and the Metrics, with the Points.
+///          Frames are passed between stages through bounded queues, and are recycled once
+///          integrated. The number of frames in flight, and so the memory used, is fixed.
+/// @note  The Manager's Reconstruction and Metrics are only used by the integrate stage, and its
+///        Policy only by the render stage. If the active Policy reads the Reconstruction to choose
+///        its views then rendering waits for every accepted view to be integrated first. See
+///        `policies::Policy::requiresUpdatedReconstruction`.
+/// @note  Each frame has its own Camera, seeded separately, so the noise added to the images is
+///        not the same as when imaging with one Camera.
+class Pipeline
+{
+public:
+    /// @brief Number of frames that may be in flight at once by default.
+    static constexpr size_t default_n_frames = 3;
+
+
+    /// @brief Constructor for a shared pointer to a Pipeline.
+    /// @param manager Manager whose Policy, Reconstruction, and Metrics are used.
+    /// @param scene Scene to image.
+    /// @param camera Camera whose Intrinsics and noise each frame's Camera copies.
+    /// @param n_frames Number of frames that may be in flight at once. At least one.
+    /// @param seed Seed for the first frame's noise RNG. Each following frame adds one. Default -1
+    ///             will use a random seed for every frame.
+    /// @return Shared pointer to a Pipeline.
+    static std::shared_ptr<Pipeline> create(const std::shared_ptr<Manager>& manager,
+                                            const std::shared_ptr<Scene>& scene,
+                                            const std::shared_ptr<const sensor::Camera>& camera,
+                                            const size_t& n_frames = default_n_frames,
+                                            const float& seed = -1)
+    {
+        return std::shared_ptr<Pipeline>(new Pipeline(manager, scene, camera, n_frames, seed));
+    }
+
+
+    /// @brief Sets a function which decides if each view from the Policy is accepted.
+    /// @param filter Callable returning true to accept the view. Rejected views are not imaged.
+    ///               By default every view is accepted.
+    void setViewFilter(std::function<bool(const Extrinsic&)> filter)
+    {
+        this->view_filter = std::move(filter);
+    }
+
+
+    /// @brief Sets a function which is called with each rendered image, on the render stage.
+    /// @param callback Callable receiving the Camera, with its image and pose, and the number of
+    ///                 the accepted view.
+    void setImageCallback(std::function<void(const std::shared_ptr<const sensor::Camera>&, const size_t&)> callback)
+    {
+        this->image_callback = std::move(callback);
+    }
+
+
+    /// @brief Sets how many rows and columns of each image are skipped when deprojecting.
+    /// @param stride Only every `stride` rows and columns of the image are used. A value of 1 uses
+    ///               every pixel. See `sensor::Camera::getPointMatrix`.
+    void setStride(const size_t& stride)
+    {
+        this->stride = std::max(stride, size_t(1));
+    }
+
+
+    /// @brief Runs the pipeline until the active Policy is complete.
+    /// @param camera_pose The reference frame which the Policy's views are relative to. See
+    ///                    `Scene::image`.
+    /// @param max_views Maximum number of views to accept.
+    /// @return Number of views accepted and integrated.
+    /// @throws std::runtime_error If no Policies have been added to the Manager.
+    /// @throws Any exception from a stage. The other stages are stopped first.
+    size_t run(const Extrinsic& camera_pose = Extrinsic::Identity(),
+               const size_t& max_views = std::numeric_limits<size_t>::max())
+    {
+        this->reset();
+
+        std::thread deproject_thread([this]() { this->runStage([this]() { this->deproject(); }); });
+        std::thread integrate_thread([this]() { this->runStage([this]() { this->integrate(); }); });
+
+        this->runStage([&]() { this->render(camera_pose, max_views); });
+        this->to_deproject->close();
+
+        deproject_thread.join();
+        integrate_thread.join();
+
+        if (this->error)
+        {
+            std::rethrow_exception(this->error);
+        }
+        return this->n_integrated;
+    }
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief One image in flight through the pipeline.
+    struct Frame
+    {
+        /// @brief Camera holding the frame's pose and depth image.
+        std::shared_ptr<sensor::Camera> camera;
+
+        /// @brief Points deprojected from the depth image, relative to the Camera.
+        PointMatrix sensed;
+    };
+
+
+    /// @brief Private constructor to enforce shared pointer usage.
+    Pipeline(const std::shared_ptr<Manager>& manager, const std::shared_ptr<Scene>& scene,
+             const std::shared_ptr<const sensor::Camera>& camera, const size_t& n_frames, const float& seed)
+        : manager(manager),
+          scene(scene),
+          frames(std::max(n_frames, size_t(1)))
+    {
+        for (size_t i = 0; i < this->frames.size(); ++i)
+        {
+            this->frames[i].camera = sensor::Camera::create(camera->getIntr(), camera->getPercentNoise(),
+                                                            seed < 0 ? seed : seed + i);
+        }
+    }
+
+
+    /// @brief Recreates the queues and puts every frame in the free queue.
+    void reset()
+    {
+        const size_t n = this->frames.size();
+        this->free_frames  = std::make_unique<utilities::BoundedQueue<Frame*>>(n);
+        this->to_deproject = std::make_unique<utilities::BoundedQueue<Frame*>>(n);
+        this->to_integrate = std::make_unique<utilities::BoundedQueue<Frame*>>(n);
+        for (auto& frame : this->frames)
+        {
+            this->free_frames->push(&frame);
+        }
+        this->n_submitted  = 0;
+        this->n_integrated = 0;
+        this->error        = nullptr;
+    }
+
+
+    /// @brief Runs a stage, recording its exception and stopping the other stages if it throws.
+    /// @param stage Callable for the stage.
+    template <typename Stage>
+    void runStage(Stage&& stage)
+    {
+        try
+        {
+            stage();
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                if (!this->error)
+                {
+                    this->error = std::current_exception();
+                }
+            }
+            this->free_frames->close();
+            this->to_deproject->close();
+            this->to_integrate->close();
+            this->integrated.notify_all();
+        }
+    }
+
+
+    /// @brief Returns true if any stage has thrown an exception.
+    bool failed()
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->error != nullptr;
+    }
+
+
+    /// @brief Render stage. Gets views from the Policy and images them.
+    /// @param camera_pose The reference frame which the Policy's views are relative to.
+    /// @param max_views Maximum number of views to accept.
+    void render(const Extrinsic& camera_pose, const size_t& max_views)
+    {
+        while (this->n_submitted < max_views)
+        {
+            if (this->manager->policyGetActive()->requiresUpdatedReconstruction())
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->integrated.wait(lock, [this]() { return this->error || this->n_integrated == this->n_submitted; });
+            }
+            if (this->failed() || this->manager->policyIsComplete())
+            {
+                return;
+            }
+
+            const Extrinsic view = this->manager->policyGetView();
+            if (this->view_filter && !this->view_filter(view))
+            {
+                this->manager->policyRejectView();
+                continue;
+            }
+            this->manager->policyAcceptView();
+
+            Frame* frame = nullptr;
+            if (!this->free_frames->pop(frame))
+            {
+                return;
+            }
+            frame->camera->setExtr(view);
+            this->scene->image(frame->camera, camera_pose);
+            if (this->image_callback)
+            {
+                this->image_callback(frame->camera, this->n_submitted);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                ++this->n_submitted;
+            }
+            this->to_deproject->push(frame);
+        }
+    }
+
+
+    /// @brief Deproject stage. Turns each frame's depth image into Points.
+    void deproject()
+    {
+        Frame* frame = nullptr;
+        while (this->to_deproject->pop(frame))
+        {
+            frame->camera->getPointMatrix(frame->sensed, Extrinsic::Identity(), this->stride, true);
+            this->to_integrate->push(frame);
+        }
+        this->to_integrate->close();
+    }
+
+
+    /// @brief Integrate stage. Updates the Reconstruction and Metrics with each frame.
+    void integrate()
+    {
+        Frame* frame = nullptr;
+        while (this->to_integrate->pop(frame))
+        {
+            this->manager->reconstructionUpdate(frame->sensed, frame->camera->getExtr());
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                ++this->n_integrated;
+            }
+            this->integrated.notify_all();
+            this->free_frames->push(frame);
+        }
+    }
+
+
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Manager whose Policy, Reconstruction, and Metrics are used.
+    std::shared_ptr<Manager> manager;
+
+    /// @brief Scene to image.
+    std::shared_ptr<Scene> scene;
+
+    /// @brief Storage for the frames in flight.
+    std::vector<Frame> frames;
+
+    /// @brief Queues of frames waiting for each stage.
+    std::unique_ptr<utilities::BoundedQueue<Frame*>> free_frames, to_deproject, to_integrate;
+
+    /// @brief Decides if each view is accepted. Accepts every view if empty.
+    std::function<bool(const Extrinsic&)> view_filter;
+
+    /// @brief Called with each rendered image. Not called if empty.
+    std::function<void(const std::shared_ptr<const sensor::Camera>&, const size_t&)> image_callback;
+
+    /// @brief Stride used when deprojecting.
+    size_t stride = 1;
+
+    /// @brief Number of views rendered and number of views integrated during the current run.
+    size_t n_submitted = 0, n_integrated = 0;
+
+    /// @brief First exception thrown by any stage.
+    std::exception_ptr error{nullptr};
+
+    /// @brief Guards the counts and the error.
+    std::mutex mutex;
+
+    /// @brief Notified each time a frame is integrated or a stage fails.
+    std::condition_variable integrated;
+};
+
+
+} // namespace simulation
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_SIMULATION_PIPELINE_HPP
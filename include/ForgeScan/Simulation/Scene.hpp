@@ -17,17 +17,15 @@
 #include "ForgeScan/Metrics/GroundTruth/Occupancy.hpp"
 #include "ForgeScan/Metrics/GroundTruth/TSDF.hpp"
 #include "ForgeScan/Simulation/MeshLoader.hpp"
+#include "ForgeScan/Simulation/SceneGeometry.hpp"
 #include "ForgeScan/Sensor/Camera.hpp"
 
 #include "ForgeScan/Utilities/Files.hpp"
+#include "ForgeScan/Utilities/Profiler.hpp"
 
 // Define some helper constants for HDF5.
 // These are undefined at the end of this header.
 #define FS_HDF5_SCENE_GROUP            "Scene"
-#define FS_HDF5_MESHES_GROUP           "Meshes"
-#define FS_HDF5_MESHES_EXTR_SUFFIX     "extrinsic"
-#define FS_HDF5_MESHES_FILEPATH        "filepath"
-#define FS_HDF5_MESHES_SCALE           "scale"
 
 
 namespace forge_scan {
@@ -35,6 +33,9 @@ namespace simulation {
 
 
 /// @brief A collection of triangle mesh objects which are imaged together in the same scene.
+/// @details The meshes are held by a `SceneGeometry`, which may be shared with other Scenes and
+///          Policies. Each Scene keeps its own buffers for imaging, so threads imaging the same
+///          meshes at once should each create a Scene for the geometry. See `getGeometry`.
 struct Scene
 {
     /// @details Required to print the Scene's contents.
@@ -53,6 +54,15 @@ public:
         return std::shared_ptr<Scene>(new Scene());
     }
 
+
+    /// @brief Constructor for a shared pointer to a Scene of shared geometry.
+    /// @param geometry Meshes to image. These are not copied.
+    /// @return Shared pointer to a Scene.
+    static std::shared_ptr<Scene> create(const std::shared_ptr<const SceneGeometry>& geometry)
+    {
+        return std::shared_ptr<Scene>(new Scene(geometry));
+    }
+
     virtual ~Scene() {}
 
 
@@ -92,7 +102,7 @@ public:
     /// @param extr The extrinsic matrix to save.
     static void writeExtrToHDF5(HighFive::File& file, const std::string& mesh_group_path, const Extrinsic& extr)
     {
-        H5Easy::dump(file, mesh_group_path + "/" FS_HDF5_MESHES_EXTR_SUFFIX, extr.matrix());
+        SceneGeometry::writeExtrToHDF5(file, mesh_group_path, extr);
     }
 
 
@@ -100,9 +110,9 @@ public:
     /// @param file HDF5 file to use.
     /// @param mesh_group_path Path to the matrix location.
     /// @param extr The extrinsic matrix to read.
-    static void readExtrFromHDF5(HighFive::File& file, const std::string& mesh_group_path, Extrinsic& extr)
+    static void readExtrFromHDF5(const HighFive::File& file, const std::string& mesh_group_path, Extrinsic& extr)
     {
-        extr.matrix() = H5Easy::load<Eigen::Matrix4f>(file, mesh_group_path + "/" FS_HDF5_MESHES_EXTR_SUFFIX);
+        SceneGeometry::readExtrFromHDF5(file, mesh_group_path, extr);
     }
 
 
@@ -110,11 +120,18 @@ public:
     /// @param parser ArgParser with parameters for the mesh to add.
     /// @throws InvalidMapKey If no name was provided.
     /// @throws InvalidMapKey If a shape with the same name already exists.
+    /// @note  The Scene is given new geometry with the extra mesh. Scenes and Policies sharing the
+    ///        old geometry are unchanged.
     void add(const utilities::ArgParser& parser)
     {
-        auto map_item = MeshLoader::create(parser);
-        uint32_t id = this->o3d_scene.AddTriangles(map_item.second);
-        this->mesh_map.insert({id, std::move(map_item)});
+        this->geometry = SceneGeometry::create(*this->geometry, MeshLoader::create(parser));
+    }
+
+
+    /// @brief Returns the Scene's meshes, which may be shared with other Scenes, Policies and threads.
+    const std::shared_ptr<const SceneGeometry>& getGeometry() const
+    {
+        return this->geometry;
     }
 
 
@@ -153,24 +170,43 @@ public:
     /// @param camera Camera intrinsics to use.
     /// @param extr Pose of the camera, relative to the world frame.
     /// @return Tensor of shape {width, height, 6} and datatype float 32.
-    static open3d::core::Tensor getCameraRays(sensor::Camera& camera, const Extrinsic& extr)
+    /// @note  Each ray's direction has unit depth, regardless of the depth image the Camera holds.
+    static open3d::core::Tensor getCameraRays(const sensor::Camera& camera, const Extrinsic& extr)
     {
-        open3d::core::Tensor rays({static_cast<long>(camera.intr->height), static_cast<long>(camera.intr->width), 6}, open3d::core::Float32);
-        Eigen::Map<Eigen::MatrixXf> rays_map(rays.GetDataPtr<float>(), 6, camera.intr->size());
+        open3d::core::Tensor rays;
+        Scene::getCameraRays(camera, extr, rays);
+        return rays;
+    }
+
 
-        Eigen::Matrix<float, 6, 1> r;
-        r.topRows<3>() = extr.translation();
-        int64_t linear_idx = 0;
-        for (size_t y = 0; y < camera.intr->height; ++y)
+    /// @brief Calculates the tensor of rays to cast into the Open3D RaycastingScene.
+    /// @param camera Camera intrinsics to use.
+    /// @param extr Pose of the camera, relative to the world frame.
+    /// @param [out] rays Tensor to write the rays to. It is reused if it already has shape
+    ///                   {width, height, 6} and datatype float 32, otherwise it is reallocated.
+    /// @note  Each ray's direction has unit depth, regardless of the depth image the Camera holds.
+    static void getCameraRays(const sensor::Camera& camera, const Extrinsic& extr, open3d::core::Tensor& rays)
+    {
+        const open3d::core::SizeVector shape = {static_cast<int64_t>(camera.intr->height),
+                                                static_cast<int64_t>(camera.intr->width), 6};
+        if (rays.GetShape() != shape || rays.GetDtype() != open3d::core::Float32)
         {
-            for (size_t x = 0; x < camera.intr->width; ++x, ++linear_idx)
-            {
-                Eigen::Vector3f ray_dir = extr.rotation() * camera.getPoint(y, x);
-                r.bottomRows<3>() = ray_dir;
-                rays_map.col(linear_idx) = r;
-            }
+            rays = open3d::core::Tensor(shape, open3d::core::Float32);
         }
-        return rays;
+        Scene::writeCameraRays(camera, extr, rays.GetDataPtr<float>());
+    }
+
+
+    /// @brief Writes rays from a pose along a set of directions to a buffer.
+    /// @param directions Directions in the camera frame, such as all or a subset of the columns of
+    ///                   `sensor::Intrinsics::getPixelRays`.
+    /// @param extr Pose of the camera, relative to the world frame.
+    /// @param [out] dest Location to write `6 * directions.cols()` floats to.
+    static void writeRays(const PointMatrix& directions, const Extrinsic& extr, float* dest)
+    {
+        Eigen::Map<Eigen::MatrixXf> rays_map(dest, 6, directions.cols());
+        rays_map.topRows<3>().colwise()    = extr.translation();
+        rays_map.bottomRows<3>().noalias() = extr.rotation() * directions;
     }
 
 
@@ -183,28 +219,109 @@ public:
     void image(const std::shared_ptr<sensor::Camera>& camera,
                const Extrinsic& camera_pose = Extrinsic::Identity())
     {
-        // Clear any previous data and ensure that ray tracing is in the proper units.
-        camera->resetDepth(1.0f);
+        this->image(camera, this->rays_buffer, camera_pose);
+    }
+
 
-        open3d::core::Tensor rays = Scene::getCameraRays(camera, camera_pose * camera->extr);
+    /// @brief Generates a depth image of the Scene for the provided Camera, writing its rays to a
+    ///        caller-owned buffer.
+    /// @param camera `sensor::Camera`to store information in.
+    /// @param [out] rays Tensor to write the rays to. It is reused if it already has the Camera's shape.
+    /// @param camera_pose The reference frame which the camera's extrinsic matrix is relative to.
+    ///                    See `image`.
+    /// @note  Several threads may image the same Scene at once if each passes its own ray buffer
+    ///        and no meshes are added meanwhile.
+    void image(const std::shared_ptr<sensor::Camera>& camera, open3d::core::Tensor& rays,
+               const Extrinsic& camera_pose = Extrinsic::Identity()) const
+    {
+        FS_PROFILE_SCOPE(SCENE_IMAGE, nullptr);
+        Scene::getCameraRays(*camera, camera_pose * camera->extr, rays);
 
-        auto result = this->o3d_scene.CastRays(rays);
-        camera->image = open3d::core::eigen_converter::TensorToEigenMatrixXf(result["t_hit"]);
+        auto result = this->geometry->castRays(rays);
+        Scene::readDepthImage(result["t_hit"].Contiguous(), 0, camera->image);
         camera->addNoise();
     }
 
 
+    /// @brief Generates a depth image of the Scene for each of the provided Cameras.
+    /// @param cameras Cameras to store images in. Each uses its own Intrinsics and extrinsic.
+    /// @param camera_pose The reference frame which the cameras' extrinsic matrices are relative to.
+    ///                    See `image`.
+    /// @throws Exception If the Cameras do not all have the same image width and height.
+    /// @note  The rays for many Cameras are cast together, up to `max_rays_per_cast` at once, which
+    ///        is much faster than casting each Camera's rays alone.
+    void imageBatch(const std::vector<std::shared_ptr<sensor::Camera>>& cameras,
+                    const Extrinsic& camera_pose = Extrinsic::Identity())
+    {
+        if (cameras.empty())
+        {
+            return;
+        }
+        FS_PROFILE_SCOPE(SCENE_IMAGE, nullptr);
+        for (const auto& camera : cameras)
+        {
+            if (camera->intr->height != cameras.front()->intr->height ||
+                camera->intr->width  != cameras.front()->intr->width)
+            {
+                throw Exception("Cameras imaged in a batch must all have the same image width and height.");
+            }
+        }
+
+        this->castBatch(*cameras.front(), cameras.size(),
+            [&](const size_t& i) { return camera_pose * cameras[i]->extr; },
+            [&](const open3d::core::Tensor& t_hit, const size_t& n, const size_t& i)
+            {
+                Scene::readDepthImage(t_hit, n, cameras[i]->image);
+                cameras[i]->addNoise();
+            });
+    }
+
+
+    /// @brief Generates a depth image of the Scene for a Camera at each of the provided poses.
+    /// @param camera Camera whose Intrinsics and noise are used. Its extrinsic and image are unchanged.
+    /// @param poses Poses of the camera to image from.
+    /// @param [out] images Depth image for each pose. Resized to the number of poses.
+    /// @param camera_pose The reference frame which the poses are relative to. See `image`.
+    /// @note  The rays for many poses are cast together, up to `max_rays_per_cast` at once. This
+    ///        suits Policies which generate a whole set of views up front.
+    void imageBatch(const std::shared_ptr<sensor::Camera>& camera, const std::vector<Extrinsic>& poses,
+                    std::vector<DepthImage>& images, const Extrinsic& camera_pose = Extrinsic::Identity())
+    {
+        FS_PROFILE_SCOPE(SCENE_IMAGE, nullptr);
+        images.resize(poses.size());
+        this->castBatch(*camera, poses.size(),
+            [&](const size_t& i) { return camera_pose * poses[i]; },
+            [&](const open3d::core::Tensor& t_hit, const size_t& n, const size_t& i)
+            {
+                // Noise is added by the Camera to its own image, so briefly swap the images.
+                Scene::readDepthImage(t_hit, n, images[i]);
+                camera->image.swap(images[i]);
+                camera->addNoise();
+                camera->image.swap(images[i]);
+            });
+    }
+
+
 
     // ***************************************************************************************** //
     // *                         PUBLIC VOXEL AND GROUND TRUTH METHODS                         * //
     // ***************************************************************************************** //
 
 
+    /// @brief Maximum number of points sent to Open3D at once when calculating a ground truth.
+    /// @details Ground truth is calculated in slabs of Z-planes so the peak memory use is bounded
+    ///          regardless of the Grid's size. Each slab holds at least two planes.
+    static constexpr size_t max_points_per_slab = size_t(1) << 22;
+
+    /// @brief Maximum number of rays cast at once by `imageBatch`. Each batch holds at least one image.
+    static constexpr size_t max_rays_per_cast = size_t(1) << 22;
+
+
     /// @brief Gets a list of voxel center location to test for occupancy or distance.
     /// @param grid_properties Size, shape, and resolution of the voxel grid.
     /// @param lower_bound Lower bound location for the grid.
-    /// @return A tensor of shape {n, 3} where n is the number of voxels in the grid. The tensor is
-    ///         ordered first in x, then y, then z.
+    /// @return A tensor of shape {nx, ny, nz, 3} where n is the number of voxels in the grid in the
+    ///         specific direction.
     open3d::core::Tensor getVoxelCenters(const std::shared_ptr<const Grid::Properties>& grid_properties,
                                          const Extrinsic& lower_bound) const
     {
@@ -213,26 +330,8 @@ public:
                       nz = static_cast<int64_t>(grid_properties->size.z());
 
         open3d::core::Tensor voxel_centers({nx, ny, nz, 3}, open3d::core::Float32);
-
-        Point center_lower_bound_f = Point::Zero();
-        for (int64_t z = 0; z < nz; ++z)
-        {
-            for (int64_t y = 0; y < ny; ++y)
-            {
-                for (int64_t x = 0; x < nx; ++x)
-                {
-                    Point center = lower_bound * center_lower_bound_f.homogeneous();
-                    voxel_centers[x][y][z][0] = center.x();
-                    voxel_centers[x][y][z][1] = center.y();
-                    voxel_centers[x][y][z][2] = center.z();
-                    center_lower_bound_f.x() += grid_properties->resolution;
-                }
-                center_lower_bound_f.x()  = 0;
-                center_lower_bound_f.y() += grid_properties->resolution;
-            }
-            center_lower_bound_f.y()  = 0;
-            center_lower_bound_f.z() += grid_properties->resolution;
-        }
+        Scene::fillLattice(voxel_centers.GetDataPtr<float>(), nx, ny, 0, nz, GridSize(ny * nz, nz, 1),
+                           lower_bound, 0, grid_properties->resolution);
         return voxel_centers;
     }
 
@@ -249,29 +348,8 @@ public:
                       nz = static_cast<int64_t>(grid_properties->size.z() + 1);
 
         open3d::core::Tensor voxel_vertices({nx, ny, nz, 3}, open3d::core::Float32);
-
-        const float neg_res = -1 * grid_properties->resolution;
-        Point vertex_lower_bound_f = Point::Ones() * neg_res;
-
-        for (int64_t z = 0; z < nz; ++z)
-        {
-            for (int64_t y = 0; y < ny; ++y)
-            {
-                for (int64_t x = 0; x < nx; ++x)
-                {
-                    Point vertex = lower_bound * vertex_lower_bound_f.homogeneous();
-                    voxel_vertices[x][y][z][0] = vertex.x();
-                    voxel_vertices[x][y][z][1] = vertex.y();
-                    voxel_vertices[x][y][z][2] = vertex.z();
-                    vertex_lower_bound_f.x() += grid_properties->resolution;
-                }
-                vertex_lower_bound_f.x()  = neg_res;
-                vertex_lower_bound_f.y() += grid_properties->resolution;
-            }
-            vertex_lower_bound_f.y()  = neg_res;
-            vertex_lower_bound_f.z() += grid_properties->resolution;
-        }
-
+        Scene::fillLattice(voxel_vertices.GetDataPtr<float>(), nx, ny, 0, nz, GridSize(ny * nz, nz, 1),
+                           lower_bound, -1 * grid_properties->resolution, grid_properties->resolution);
         return voxel_vertices;
     }
 
@@ -284,35 +362,12 @@ public:
     calculateGroundTruthOccupancy(const std::shared_ptr<const Grid::Properties>& grid_properties,
                                   const Extrinsic& lower_bound)
     {
-        static const int all_vertex_votes = 8, no_vertex_votes = 0;
-
-        open3d::core::Tensor voxel_vertices = Scene::getVoxelVertices(grid_properties, lower_bound);
-        auto result = this->o3d_scene.ComputeOccupancy(voxel_vertices, 0, 5);
-
         auto true_occupancy = metrics::ground_truth::Occupancy::create(grid_properties);
-        size_t i = 0;
-        for (size_t z = 0; z < grid_properties->size.z(); ++z)
-        {
-            for (size_t y = 0; y < grid_properties->size.y(); ++y)
+        this->calculateInPlanes(*grid_properties, true_occupancy->data,
+            [&](const size_t& z_first, const size_t& z_last, uint8_t* dest)
             {
-                for (size_t x = 0; x < grid_properties->size.x(); ++x, ++i)
-                {
-                    float votes = 0;
-                    votes += result[x]  [y]  [z].Item<float>();
-                    votes += result[x+1][y]  [z].Item<float>();
-                    votes += result[x]  [y+1][z].Item<float>();
-                    votes += result[x+1][y+1][z].Item<float>();
-                    votes += result[x]  [y]  [z+1].Item<float>();
-                    votes += result[x+1][y]  [z+1].Item<float>();
-                    votes += result[x]  [y+1][z+1].Item<float>();
-                    votes += result[x+1][y+1][z+1].Item<float>();
-                    if (votes < all_vertex_votes)
-                    {
-                        true_occupancy->operator[](i) = (votes == no_vertex_votes) ? VoxelOccupancy::FREE : VoxelOccupancy::CLIPPED;
-                    }
-                }
-            }
-        }
+                this->calculateOccupancyPlanes(*grid_properties, lower_bound, z_first, z_last, dest);
+            });
         return true_occupancy;
     }
 
@@ -325,21 +380,12 @@ public:
     calculateGroundTruthTSDF(const std::shared_ptr<const Grid::Properties>& grid_properties,
                              const Extrinsic& lower_bound)
     {
-        open3d::core::Tensor voxel_centers = Scene::getVoxelCenters(grid_properties, lower_bound);
-        auto result = this->o3d_scene.ComputeSignedDistance(voxel_centers, 0, 5);
-
         auto true_tsdf = metrics::ground_truth::TSDF::create(grid_properties);
-        size_t i = 0;
-        for (size_t z = 0; z < grid_properties->size.z(); ++z)
-        {
-            for (size_t y = 0; y < grid_properties->size.y(); ++y)
+        this->calculateInPlanes(*grid_properties, true_tsdf->data,
+            [&](const size_t& z_first, const size_t& z_last, double* dest)
             {
-                for (size_t x = 0; x < grid_properties->size.x(); ++x, ++i)
-                {
-                    true_tsdf->operator[](i) = result[x][y][z].Item<float>();
-                }
-            }
-        }
+                this->calculateTSDFPlanes(*grid_properties, lower_bound, z_first, z_last, dest);
+            });
         return true_tsdf;
     }
 
@@ -351,75 +397,307 @@ protected:
 
 
     /// @brief Private constructor to enforce shared pointer usage.
-    explicit Scene()
+    /// @param geometry Meshes to image. By default the Scene is empty.
+    explicit Scene(const std::shared_ptr<const SceneGeometry>& geometry = SceneGeometry::create())
+        : geometry(geometry)
     {
 
     }
 
 
-    /// @brief Writes each mesh filepath, scaling value, and transformation in the HDF5 Scene group.
-    /// @param g_scene Reference to the location to store the mesh information at.
-    /// @param file Reference to the opened HDF5 file.
-    void writeMeshesToHDF5(HighFive::Group& g_scene, HighFive::File& file) const
+    /// @brief Calculates occupancy labels for a range of Z-planes of voxels.
+    /// @param grid_properties Size, shape, and resolution of the voxel grid.
+    /// @param lower_bound Lower bound location for the grid.
+    /// @param z_first First plane of voxels to label.
+    /// @param z_last One past the last plane of voxels to label.
+    /// @param [out] dest Location to write `(z_last - z_first) * nx * ny` labels to, in the X-major
+    ///                   linear order.
+    /// @note  Each voxel is labeled by the votes of its eight vertices. Vertices are tested one slab
+    ///        of Z-planes at a time, see `max_points_per_slab`. The votes of each plane are first
+    ///        summed over each 2x2 square of vertices, then two neighboring planes are added together.
+    void calculateOccupancyPlanes(const Grid::Properties& grid_properties, const Extrinsic& lower_bound,
+                                  const size_t& z_first, const size_t& z_last, uint8_t* dest)
+    {
+        static const int all_vertex_votes = 8, no_vertex_votes = 0;
+
+        const size_t nx = grid_properties.size.x(), ny = grid_properties.size.y();
+        const size_t vx = nx + 1, vy = ny + 1, vertex_plane = vx * vy;
+        const float  res = grid_properties.resolution;
+
+        // Neighboring slabs share one plane of vertices.
+        const size_t planes_per_slab = std::max(max_points_per_slab / vertex_plane, size_t(2));
+
+        Eigen::ArrayXXf lower_sum(nx, ny), upper_sum(nx, ny);
+        for (size_t z_slab = z_first; z_slab < z_last; z_slab += planes_per_slab - 1)
+        {
+            const size_t n_planes = std::min(planes_per_slab, z_last + 1 - z_slab);
+
+            open3d::core::Tensor voxel_vertices({static_cast<int64_t>(n_planes), static_cast<int64_t>(vy),
+                                                 static_cast<int64_t>(vx), 3}, open3d::core::Float32);
+            Scene::fillLattice(voxel_vertices.GetDataPtr<float>(), vx, vy, z_slab, n_planes,
+                               GridSize(1, vx, vertex_plane), lower_bound, -1 * res, res);
+
+            auto result = this->geometry->computeOccupancy(voxel_vertices).To(open3d::core::Float32).Contiguous();
+            const float* votes = result.GetDataPtr<float>();
+
+            Scene::sumVertexSquares(votes, vx, vy, lower_sum);
+            for (size_t p = 1; p < n_planes; ++p)
+            {
+                Scene::sumVertexSquares(votes + p * vertex_plane, vx, vy, upper_sum);
+                lower_sum += upper_sum;
+
+                const float* voxel_votes = lower_sum.data();
+                for (size_t n = 0; n < nx * ny; ++n, ++dest)
+                {
+                    *dest = (voxel_votes[n] == all_vertex_votes) ? VoxelOccupancy::OCCUPIED :
+                            (voxel_votes[n] == no_vertex_votes)  ? VoxelOccupancy::FREE : VoxelOccupancy::CLIPPED;
+                }
+                lower_sum.swap(upper_sum);
+            }
+        }
+    }
+
+
+    /// @brief Calculates signed distances for a range of Z-planes of voxels.
+    /// @param grid_properties Size, shape, and resolution of the voxel grid.
+    /// @param lower_bound Lower bound location for the grid.
+    /// @param z_first First plane of voxels to calculate.
+    /// @param z_last One past the last plane of voxels to calculate.
+    /// @param [out] dest Location to write `(z_last - z_first) * nx * ny` distances to, in the
+    ///                   X-major linear order.
+    /// @note  Voxel centers are tested one slab of Z-planes at a time, see `max_points_per_slab`.
+    void calculateTSDFPlanes(const Grid::Properties& grid_properties, const Extrinsic& lower_bound,
+                             const size_t& z_first, const size_t& z_last, double* dest)
     {
-        auto g_meshes = g_scene.createGroup(FS_HDF5_MESHES_GROUP);
+        const size_t nx = grid_properties.size.x(), ny = grid_properties.size.y();
+        const size_t voxel_plane = nx * ny;
+        const size_t planes_per_slab = std::max(max_points_per_slab / voxel_plane, size_t(1));
 
-        int n = 0;
-        for (const auto& item : this->mesh_map)
+        for (size_t z_slab = z_first; z_slab < z_last; z_slab += planes_per_slab)
         {
-            auto g_mesh = g_meshes.createGroup(std::to_string(n++));
-            g_mesh.createAttribute(FS_HDF5_MESHES_SCALE,    item.second.first.scale);
-            g_mesh.createAttribute(FS_HDF5_MESHES_FILEPATH, item.second.first.fpath.string());
-            Scene::writeExtrToHDF5(file, g_mesh.getPath(),  item.second.first.extr);
+            const size_t n_planes = std::min(planes_per_slab, z_last - z_slab);
+
+            open3d::core::Tensor voxel_centers({static_cast<int64_t>(n_planes), static_cast<int64_t>(ny),
+                                                static_cast<int64_t>(nx), 3}, open3d::core::Float32);
+            Scene::fillLattice(voxel_centers.GetDataPtr<float>(), nx, ny, z_slab, n_planes,
+                               GridSize(1, nx, voxel_plane), lower_bound, 0, grid_properties.resolution);
+
+            auto result = this->geometry->computeSignedDistance(voxel_centers).To(open3d::core::Float32).Contiguous();
+            const float* distance = result.GetDataPtr<float>();
+
+            dest = std::copy(distance, distance + n_planes * voxel_plane, dest);
         }
     }
 
 
-    /// @brief Writes each mesh filepath, scaling value, and transformation in the HDF5 Scene group.
-    /// @param g_scene Reference to the location to store the mesh information at.
-    /// @param file Reference to the opened HDF5 file.
-    /// @param fpath Filesystem path to the opened HDF5 file.
-    void readMeshesFromHDF5(HighFive::Group& g_scene,  HighFive::File& file, std::filesystem::path fpath = std::filesystem::path())
+    /// @brief Fills a ground truth data vector by calculating it in ranges of Z-planes.
+    /// @param grid_properties Size, shape, and resolution of the voxel grid.
+    /// @param [out] data Data vector of the ground truth Grid, in its layout.
+    /// @param calculate Callable with the signature `void(z_first, z_last, T* dest)` which writes
+    ///                  the planes `[z_first, z_last)` in the X-major linear order.
+    /// @note  For the linear layout the planes are written directly into the data vector. Otherwise
+    ///        they are calculated one slab at a time and copied into place.
+    template <typename T, typename Calculate>
+    static void calculateInPlanes(const Grid::Properties& grid_properties, std::vector<T>& data, Calculate&& calculate)
     {
-        auto scene_groups = g_scene.listObjectNames();
-        if(std::find(scene_groups.begin(), scene_groups.end(), FS_HDF5_MESHES_GROUP) != scene_groups.end())
+        const size_t nz = grid_properties.size.z();
+        if (grid_properties.isLinear())
         {
-            // Only clear all elements if we make it this far into loading the HDF5.
-            this->mesh_map.clear();
+            calculate(0, nz, data.data());
+            return;
+        }
+
+        const size_t voxel_plane = grid_properties.size.x() * grid_properties.size.y();
+        const size_t planes_per_slab = std::max(max_points_per_slab / voxel_plane, size_t(1));
+
+        std::vector<T> planes;
+        for (size_t z_first = 0; z_first < nz; z_first += planes_per_slab)
+        {
+            const size_t z_last = std::min(z_first + planes_per_slab, nz);
+            planes.resize((z_last - z_first) * voxel_plane);
+            calculate(z_first, z_last, planes.data());
+            Scene::storePlanes(grid_properties, z_first, z_last, planes.data(), data);
+        }
+    }
 
-            auto g_meshes = g_scene.getGroup(FS_HDF5_MESHES_GROUP);
-            auto mesh_groups = g_meshes.listObjectNames();
 
-            // Begin reading each shape and getting the attributes.
-            for (const auto& group_name : mesh_groups)
+    /// @brief Copies a range of Z-planes in the X-major linear order into a data vector.
+    /// @param grid_properties Size, shape, and layout of the voxel grid.
+    /// @param z_first First plane of voxels in `planes`.
+    /// @param z_last One past the last plane of voxels in `planes`.
+    /// @param planes Values for the planes, in the X-major linear order.
+    /// @param [out] data Data vector in the Grid's layout.
+    template <typename T>
+    static void storePlanes(const Grid::Properties& grid_properties, const size_t& z_first, const size_t& z_last,
+                            const T* planes, std::vector<T>& data)
+    {
+        const size_t nx = grid_properties.size.x(), ny = grid_properties.size.y();
+        if (grid_properties.isLinear())
+        {
+            std::copy(planes, planes + (z_last - z_first) * nx * ny, data.begin() + z_first * nx * ny);
+            return;
+        }
+        for (size_t z = z_first; z < z_last; ++z)
+        {
+            for (size_t y = 0; y < ny; ++y)
             {
-                auto g_mesh = g_meshes.getGroup(group_name);
+                for (size_t x = 0; x < nx; ++x, ++planes)
+                {
+                    data[grid_properties[Index(x, y, z)]] = *planes;
+                }
+            }
+        }
+    }
 
-                float scale = g_mesh.getAttribute(FS_HDF5_MESHES_SCALE).read<float>();
-                std::filesystem::path mesh_fpath = std::filesystem::path(g_mesh.getAttribute(FS_HDF5_MESHES_FILEPATH).read<std::string>());
 
-                Extrinsic extr;
-                Scene::readExtrFromHDF5(file, g_mesh.getPath(), extr);
+    /// @brief Casts the rays for many images of the same shape in as few calls as possible.
+    /// @param camera Camera whose Intrinsics give the shape of each image.
+    /// @param n_images Number of images.
+    /// @param get_pose Callable with the signature `Extrinsic(const size_t& i)` for image i's pose.
+    /// @param store Callable with the signature `void(const Tensor& t_hit, const size_t& n, const size_t& i)`
+    ///              which reads image i from position n of the contiguous `{n, height, width}` result.
+    template <typename GetPose, typename Store>
+    void castBatch(const sensor::Camera& camera, const size_t& n_images, GetPose&& get_pose, Store&& store)
+    {
+        const size_t n_pixels = camera.intr->size();
+        const size_t images_per_cast = std::max(max_rays_per_cast / std::max(n_pixels, size_t(1)), size_t(1));
 
-                auto map_item = MeshLoader::create(mesh_fpath, extr, fpath.remove_filename(), scale);
-                uint32_t id = this->o3d_scene.AddTriangles(map_item.second);
-                this->mesh_map.insert({id, std::move(map_item)});
+        open3d::core::Tensor& rays = this->rays_buffer;
+        for (size_t first = 0; first < n_images; first += images_per_cast)
+        {
+            const size_t n = std::min(images_per_cast, n_images - first);
+            const open3d::core::SizeVector shape = {static_cast<int64_t>(n),
+                                                    static_cast<int64_t>(camera.intr->height),
+                                                    static_cast<int64_t>(camera.intr->width), 6};
+            if (rays.GetShape() != shape)
+            {
+                rays = open3d::core::Tensor(shape, open3d::core::Float32);
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                Scene::writeCameraRays(camera, get_pose(first + i), rays.GetDataPtr<float>() + 6 * n_pixels * i);
+            }
+
+            auto result = this->geometry->castRays(rays);
+            const open3d::core::Tensor t_hit = result["t_hit"].Contiguous();
+            for (size_t i = 0; i < n; ++i)
+            {
+                store(t_hit, i, first + i);
             }
         }
     }
 
 
+    /// @brief Writes the rays for a Camera, as `getCameraRays` does, to a buffer.
+    /// @param camera Camera intrinsics to use.
+    /// @param extr Pose of the camera, relative to the world frame.
+    /// @param [out] dest Location to write `6 * width * height` floats to.
+    static void writeCameraRays(const sensor::Camera& camera, const Extrinsic& extr, float* dest)
+    {
+        // Rays at unit depth are cached by the Intrinsics, so only the rotation is applied here.
+        Scene::writeRays(camera.intr->getPixelRays(), extr, dest);
+    }
+
+
+    /// @brief Copies one depth image out of a raycasting result.
+    /// @param t_hit Contiguous `{height, width}` or `{n, height, width}` tensor of hit distances.
+    /// @param n Index of the image within the result.
+    /// @param [out] image Depth image to store the distances in. Resized to fit.
+    static void readDepthImage(const open3d::core::Tensor& t_hit, const size_t& n, DepthImage& image)
+    {
+        const open3d::core::SizeVector shape = t_hit.GetShape();
+        const int64_t height = shape[shape.size() - 2], width = shape[shape.size() - 1];
+
+        // The tensor is row-major while the DepthImage is column-major.
+        using RowMajorImage = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+        image = Eigen::Map<const RowMajorImage>(t_hit.GetDataPtr<float>() + n * height * width, height, width);
+    }
+
+
+    /// @brief Writes a regular lattice of points, such as voxel centers or vertices.
+    /// @param [out] dest Location to write the points to, as three floats each.
+    /// @param nx Number of points along the X-axis.
+    /// @param ny Number of points along the Y-axis.
+    /// @param z_first Position along the Z-axis of the first plane of points.
+    /// @param nz Number of planes of points along the Z-axis.
+    /// @param strides Number of points between neighbors along X, Y, and Z in `dest`.
+    /// @param lower_bound Lower bound location for the grid.
+    /// @param offset Location of the first point along each axis, relative to the lower bound.
+    /// @param resolution Spacing between points.
+    static void fillLattice(float* dest, const size_t& nx, const size_t& ny, const size_t& z_first,
+                            const size_t& nz, const GridSize& strides, const Extrinsic& lower_bound,
+                            const float& offset, const float& resolution)
+    {
+        const Point step_x = lower_bound.linear().col(0) * resolution,
+                    step_y = lower_bound.linear().col(1) * resolution,
+                    step_z = lower_bound.linear().col(2) * resolution;
+        const Point origin = lower_bound * Point(offset, offset, offset);
+
+        // Points are found from their absolute position so they do not depend on how planes are split.
+        for (size_t z = 0; z < nz; ++z)
+        {
+            for (size_t y = 0; y < ny; ++y)
+            {
+                const Point row = origin + static_cast<float>(y) * step_y + static_cast<float>(z_first + z) * step_z;
+                Eigen::Map<Eigen::Matrix3Xf, 0, Eigen::OuterStride<>> points(dest + 3 * (y * strides.y() + z * strides.z()),
+                                                                            3, nx, Eigen::OuterStride<>(3 * strides.x()));
+                for (size_t x = 0; x < nx; ++x)
+                {
+                    points.col(x) = row + static_cast<float>(x) * step_x;
+                }
+            }
+        }
+    }
+
+
+    /// @brief Sums the votes of each 2x2 square of vertices in one plane.
+    /// @param votes Votes for a plane of `vx * vy` vertices, in the X-major order.
+    /// @param vx Number of vertices along the X-axis.
+    /// @param vy Number of vertices along the Y-axis.
+    /// @param [out] sum Array of shape `(vx - 1, vy - 1)` for the sum of each square's votes.
+    static void sumVertexSquares(const float* votes, const size_t& vx, const size_t& vy, Eigen::ArrayXXf& sum)
+    {
+        Eigen::Map<const Eigen::ArrayXXf> plane(votes, vx, vy);
+        sum = plane.topLeftCorner(vx - 1, vy - 1)  + plane.bottomLeftCorner(vx - 1, vy - 1) +
+              plane.topRightCorner(vx - 1, vy - 1) + plane.bottomRightCorner(vx - 1, vy - 1);
+    }
+
+
+    /// @brief Writes each mesh filepath, scaling value, and transformation in the HDF5 Scene group.
+    /// @param g_scene Reference to the location to store the mesh information at.
+    /// @param file Reference to the opened HDF5 file.
+    void writeMeshesToHDF5(HighFive::Group& g_scene, HighFive::File& file) const
+    {
+        this->geometry->writeToHDF5(g_scene, file);
+    }
+
+
+    /// @brief Reads each mesh filepath, scaling value, and transformation from the HDF5 Scene group.
+    /// @param g_scene Reference to the location to store the mesh information at.
+    /// @param file Reference to the opened HDF5 file.
+    /// @param fpath Filesystem path to the opened HDF5 file.
+    /// @note  The meshes are only loaded if they are not already in use. See `SceneGeometry::readFromHDF5`.
+    void readMeshesFromHDF5(HighFive::Group& g_scene,  HighFive::File& file, std::filesystem::path fpath = std::filesystem::path())
+    {
+        if (auto loaded = SceneGeometry::readFromHDF5(g_scene, file, fpath.remove_filename()))
+        {
+            this->geometry = loaded;
+        }
+    }
+
+
 
     // ***************************************************************************************** //
     // *                                PROTECTED CLASS MEMBERS                                * //
     // ***************************************************************************************** //
 
 
-    /// @brief Open3D's raycasting implementation.
-    open3d::t::geometry::RaycastingScene o3d_scene;
+    /// @brief Meshes in the scene and Open3D's raycasting structure for them.
+    std::shared_ptr<const SceneGeometry> geometry;
 
-    /// @brief List of information about the meshes in the scene and the mesh itself.
-    std::map<uint32_t, std::pair<MeshInfo, open3d::t::geometry::TriangleMesh>> mesh_map;
+    /// @brief Rays cast by `image` and `imageBatch`. Reused between calls while the shape of the
+    ///        images does not change.
+    open3d::core::Tensor rays_buffer;
 };
 
 
@@ -429,20 +707,20 @@ protected:
 /// @return Reference to the output stream.
 std::ostream& operator<<(std::ostream &out, const Scene& scene)
 {
-    if (!scene.mesh_map.empty())
+    if (!scene.geometry->getMeshes().empty())
     {
         out << "Scene contains:";
         size_t n = 0;
-        for (const auto& item : scene.mesh_map)
+        for (const auto& item : scene.geometry->getMeshes())
         {
-            std::string description = item.second.second.ToString();
+            std::string description = item.second.ToString();
             std::replace(description.begin(), description.end(), '\n', ' ');
 
-            std::string center = item.second.second.GetCenter().ToString();
+            std::string center = item.second.GetCenter().ToString();
             center.erase(center.find('\n'));
 
-            out << "\n[" << n << "] Mesh name: " << item.second.first.fpath.stem() << " centered at " << center
-                    << "\n\tFrom file: " << item.second.first.fpath
+            out << "\n[" << n << "] Mesh name: " << item.first.fpath.stem() << " centered at " << center
+                    << "\n\tFrom file: " << item.first.fpath
                     << "\n\tWith properties:" << description;
             ++n;
         }
@@ -461,10 +739,6 @@ std::ostream& operator<<(std::ostream &out, const Scene& scene)
 
 #undef FS_HDF5_SCENE_GROUP
 #undef FS_HDF5_SCAN_LOWER_BOUND_DSET
-#undef FS_HDF5_MESHES_GROUP
-#undef FS_HDF5_MESHES_EXTR_SUFFIX
-#undef FS_HDF5_MESHES_FILEPATH
-#undef FS_HDF5_MESHES_SCALE
 
 
 #endif // FORGE_SCAN_SIMULATION_SCENE_HPP
@@ -0,0 +1,287 @@
+#ifndef FORGE_SCAN_SIMULATION_SCENE_GEOMETRY_HPP
+#define FORGE_SCAN_SIMULATION_SCENE_GEOMETRY_HPP
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define H5_USE_EIGEN 1
+#include <highfive/H5File.hpp>
+#include <highfive/H5Easy.hpp>
+
+#include <open3d/t/geometry/RaycastingScene.h>
+
+#include "ForgeScan/Common/Definitions.hpp"
+#include "ForgeScan/Simulation/MeshLoader.hpp"
+#include "ForgeScan/Utilities/Hash.hpp"
+
+// Define some helper constants for HDF5.
+// These are undefined at the end of this header.
+#define FS_HDF5_MESHES_GROUP           "Meshes"
+#define FS_HDF5_MESHES_EXTR_SUFFIX     "extrinsic"
+#define FS_HDF5_MESHES_FILEPATH        "filepath"
+#define FS_HDF5_MESHES_SCALE           "scale"
+
+
+namespace forge_scan {
+namespace simulation {
+
+
+/// @brief The triangle meshes of a Scene and Open3D's raycasting structure for them, shared
+///        read-only by any number of Scenes, Policies and threads.
+/// @details SceneGeometry is immutable once created. Adding a mesh to a Scene creates new geometry
+///          with the extra mesh, so anything holding the old geometry is unaffected. The raycasting
+///          structure is built when the geometry is created, so the queries only read it and may be
+///          made from many threads at once.
+/// @note  Geometry read from an HDF5 file is cached, for as long as it is in use, by the meshes it
+///        holds. Scenes and Policies loaded from the same file share one copy of the meshes and of
+///        the raycasting structure. See `readFromHDF5`.
+class SceneGeometry
+{
+public:
+    /// @brief A mesh, with its file and pose, and the TriangleMesh added to the raycasting structure.
+    typedef std::pair<MeshInfo, open3d::t::geometry::TriangleMesh> Mesh;
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Creates shared geometry.
+    /// @param meshes Meshes of the geometry. May be empty.
+    /// @return Shared, constant pointer to the geometry.
+    static std::shared_ptr<const SceneGeometry> create(std::vector<Mesh> meshes = {})
+    {
+        return std::shared_ptr<const SceneGeometry>(new SceneGeometry(std::move(meshes)));
+    }
+
+
+    /// @brief Creates shared geometry with the meshes of other geometry and one more mesh.
+    /// @param geometry Geometry to copy the meshes of. It is unchanged.
+    /// @param mesh Mesh to add.
+    /// @return Shared, constant pointer to the new geometry.
+    static std::shared_ptr<const SceneGeometry> create(const SceneGeometry& geometry, Mesh mesh)
+    {
+        std::vector<Mesh> meshes = geometry.meshes;
+        meshes.push_back(std::move(mesh));
+        return SceneGeometry::create(std::move(meshes));
+    }
+
+
+    /// @brief Returns the meshes, in the order of their geometry IDs in raycasting results.
+    const std::vector<Mesh>& getMeshes() const
+    {
+        return this->meshes;
+    }
+
+
+    /// @brief Casts rays into the meshes. See Open3D's `RaycastingScene::CastRays`.
+    /// @param rays Tensor of shape `{..., 6}` with the origin and direction of each ray.
+    /// @return Map of the result Tensors, such as "t_hit" and "primitive_normals".
+    /// @note  Safe to call from many threads at once.
+    auto castRays(const open3d::core::Tensor& rays) const
+    {
+        return this->o3d_scene.CastRays(rays);
+    }
+
+
+    /// @brief Tests if points are inside the meshes. See Open3D's `RaycastingScene::ComputeOccupancy`.
+    /// @param points Tensor of shape `{..., 3}` with the points to test.
+    /// @return Tensor of the occupancy of each point.
+    /// @note  Safe to call from many threads at once.
+    open3d::core::Tensor computeOccupancy(const open3d::core::Tensor& points) const
+    {
+        return this->o3d_scene.ComputeOccupancy(points, 0, 5);
+    }
+
+
+    /// @brief Finds the signed distance from points to the meshes. See Open3D's
+    ///        `RaycastingScene::ComputeSignedDistance`.
+    /// @param points Tensor of shape `{..., 3}` with the points to test.
+    /// @return Tensor of the signed distance of each point.
+    /// @note  Safe to call from many threads at once.
+    open3d::core::Tensor computeSignedDistance(const open3d::core::Tensor& points) const
+    {
+        return this->o3d_scene.ComputeSignedDistance(points, 0, 5);
+    }
+
+
+    /// @brief Writes an Extrinsic eigen matrix to an HDF5 file with HighFive.
+    /// @param file HDF5 file to use.
+    /// @param mesh_group_path Path to the matrix location.
+    /// @param extr The extrinsic matrix to save.
+    static void writeExtrToHDF5(HighFive::File& file, const std::string& mesh_group_path, const Extrinsic& extr)
+    {
+        H5Easy::dump(file, mesh_group_path + "/" FS_HDF5_MESHES_EXTR_SUFFIX, extr.matrix());
+    }
+
+
+    /// @brief Reads an Extrinsic eigen matrix from an HDF5 file with HighFive.
+    /// @param file HDF5 file to use.
+    /// @param mesh_group_path Path to the matrix location.
+    /// @param extr The extrinsic matrix to read.
+    static void readExtrFromHDF5(const HighFive::File& file, const std::string& mesh_group_path, Extrinsic& extr)
+    {
+        extr.matrix() = H5Easy::load<Eigen::Matrix4f>(file, mesh_group_path + "/" FS_HDF5_MESHES_EXTR_SUFFIX);
+    }
+
+
+    /// @brief Writes each mesh filepath, scaling value, and transformation in an HDF5 group.
+    /// @param g_parent Reference to the location to store the mesh information at.
+    /// @param file Reference to the opened HDF5 file.
+    void writeToHDF5(HighFive::Group& g_parent, HighFive::File& file) const
+    {
+        auto g_meshes = g_parent.createGroup(FS_HDF5_MESHES_GROUP);
+
+        int n = 0;
+        for (const auto& mesh : this->meshes)
+        {
+            auto g_mesh = g_meshes.createGroup(std::to_string(n++));
+            g_mesh.createAttribute(FS_HDF5_MESHES_SCALE,    mesh.first.scale);
+            g_mesh.createAttribute(FS_HDF5_MESHES_FILEPATH, mesh.first.fpath.string());
+            SceneGeometry::writeExtrToHDF5(file, g_mesh.getPath(), mesh.first.extr);
+        }
+    }
+
+
+    /// @brief Reads the meshes written by `writeToHDF5`.
+    /// @param g_parent Reference to the location the mesh information was stored at.
+    /// @param file Reference to the opened HDF5 file.
+    /// @param extra_search_path One additional path to search for the mesh files at. See `MeshLoader::create`.
+    /// @return Shared geometry for the meshes. If geometry for the same mesh files, scales and
+    ///         poses is already in use then that is returned rather than loading them again.
+    ///         Nullptr if the group holds no mesh information.
+    /// @throws ConstructorError If a mesh cannot be loaded.
+    static std::shared_ptr<const SceneGeometry> readFromHDF5(HighFive::Group& g_parent, HighFive::File& file,
+                                                             const std::filesystem::path& extra_search_path = std::filesystem::path())
+    {
+        const auto parent_groups = g_parent.listObjectNames();
+        if (std::find(parent_groups.begin(), parent_groups.end(), FS_HDF5_MESHES_GROUP) == parent_groups.end())
+        {
+            return nullptr;
+        }
+
+        auto g_meshes = g_parent.getGroup(FS_HDF5_MESHES_GROUP);
+        std::vector<MeshInfo> infos;
+        for (const auto& group_name : g_meshes.listObjectNames())
+        {
+            auto g_mesh = g_meshes.getGroup(group_name);
+
+            MeshInfo info;
+            info.scale = g_mesh.getAttribute(FS_HDF5_MESHES_SCALE).read<float>();
+            info.fpath = std::filesystem::path(g_mesh.getAttribute(FS_HDF5_MESHES_FILEPATH).read<std::string>());
+            SceneGeometry::readExtrFromHDF5(file, g_mesh.getPath(), info.extr);
+            infos.push_back(info);
+        }
+        return SceneGeometry::load(infos, extra_search_path);
+    }
+
+
+    /// @brief Loads geometry for a set of mesh files, reusing geometry already loaded for them.
+    /// @param infos File, scale and pose of each mesh.
+    /// @param extra_search_path One additional path to search for the mesh files at. See `MeshLoader::create`.
+    /// @return Shared geometry for the meshes.
+    /// @throws ConstructorError If a mesh cannot be loaded.
+    static std::shared_ptr<const SceneGeometry> load(const std::vector<MeshInfo>& infos,
+                                                     const std::filesystem::path& extra_search_path = std::filesystem::path())
+    {
+        uint64_t key = utilities::hashString(utilities::hash_seed, extra_search_path.string());
+        for (const auto& info : infos)
+        {
+            key = utilities::hashString(key, info.fpath.string());
+            key = utilities::hashValue(key, info.scale);
+            key = utilities::hashBytes(key, info.extr.data(), sizeof(float) * 16);
+        }
+
+        // Loading holds the lock, so threads loading the same meshes wait for one copy of them.
+        std::lock_guard<std::mutex> lock(SceneGeometry::cacheMutex());
+        auto& cached = SceneGeometry::cache()[key];
+        if (auto geometry = cached.lock())
+        {
+            return geometry;
+        }
+
+        std::vector<Mesh> meshes;
+        meshes.reserve(infos.size());
+        for (auto info : infos)
+        {
+            meshes.push_back(MeshLoader::create(info.fpath, info.extr, extra_search_path, info.scale));
+        }
+        auto geometry = SceneGeometry::create(std::move(meshes));
+        cached = geometry;
+        return geometry;
+    }
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Private constructor to enforce shared pointer usage.
+    /// @param meshes Meshes of the geometry.
+    explicit SceneGeometry(std::vector<Mesh> meshes)
+        : meshes(std::move(meshes))
+    {
+        for (const auto& mesh : this->meshes)
+        {
+            this->o3d_scene.AddTriangles(mesh.second.GetVertexPositions(), mesh.second.GetTriangleIndices());
+        }
+
+        // Open3D builds its BVH on the first query. Making it here means later queries only read it.
+        if (!this->meshes.empty())
+        {
+            this->o3d_scene.CastRays(open3d::core::Tensor::Zeros({1, 6}, open3d::core::Float32));
+        }
+    }
+
+
+    /// @brief Geometry loaded by `load`, keyed by a hash of its meshes. Entries expire once the
+    ///        geometry is no longer in use.
+    static std::map<uint64_t, std::weak_ptr<const SceneGeometry>>& cache()
+    {
+        static std::map<uint64_t, std::weak_ptr<const SceneGeometry>> geometry;
+        return geometry;
+    }
+
+
+    /// @brief Guards the cache.
+    static std::mutex& cacheMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Information about each mesh and the mesh itself.
+    const std::vector<Mesh> meshes;
+
+    /// @brief Open3D's raycasting implementation.
+    /// @note  Mutable as Open3D does not mark every query const. Queries do not change the scene
+    ///        once its BVH is built, which the constructor does.
+    mutable open3d::t::geometry::RaycastingScene o3d_scene;
+};
+
+
+} // namespace simulation
+} // namespace forge_scan
+
+
+#undef FS_HDF5_MESHES_GROUP
+#undef FS_HDF5_MESHES_EXTR_SUFFIX
+#undef FS_HDF5_MESHES_FILEPATH
+#undef FS_HDF5_MESHES_SCALE
+
+
+#endif // FORGE_SCAN_SIMULATION_SCENE_GEOMETRY_HPP
@@ -216,6 +216,23 @@ public:
     }
 
 
+    /// @brief Joins the parsed arguments back into one string.
+    /// @return String of the arguments deliminated by a space. Parsing this recreates the ArgParser.
+    std::string getArgs() const
+    {
+        std::string args;
+        for (const auto& token : this->tokens)
+        {
+            if (!args.empty())
+            {
+                args += ' ';
+            }
+            args += token;
+        }
+        return args;
+    }
+
+
 private:
     /// @brief Parses the inputs into the ArgParser's tokens
     /// @param argc Count of arguments in the argument vector.
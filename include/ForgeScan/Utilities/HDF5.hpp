@@ -0,0 +1,356 @@
+#ifndef FORGE_SCAN_UTILITIES_HDF5_HPP
+#define FORGE_SCAN_UTILITIES_HDF5_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <highfive/H5File.hpp>
+#include <H5Lpublic.h>
+#include <H5Ppublic.h>
+
+#include "ForgeScan/Common/Types.hpp"
+#include "ForgeScan/Utilities/ArgParser.hpp"
+
+
+namespace forge_scan {
+namespace utilities {
+
+
+/// @brief Options for how voxel data sets are laid out and compressed in HDF5 files.
+/// @details Data sets are written in the linear order, so chunks are made of whole X-Y planes when
+///          a plane fits in `chunk_bytes`, or whole X rows if it does not. Reading or rewriting a
+///          range of Z-slices then touches only the chunks that hold them.
+/// @note  Deflate is built into every HDF5 library, so files stay readable in tools like ParaView.
+///        Zstd and Blosc are HDF5 plugin filters (IDs 32015 and 32001). They are added as optional
+///        filters: if the plugin is not found when writing the data is stored uncompressed, and
+///        reading data compressed by them needs the plugin on the `HDF5_PLUGIN_PATH`.
+struct DataSetOptions
+{
+    /// @brief Compression filter applied to each chunk.
+    enum class Filter
+    {
+        NONE,
+        DEFLATE,
+        ZSTD,
+        BLOSC
+    };
+
+
+    /// @brief Registered HDF5 filter IDs for the plugin filters.
+    static constexpr H5Z_filter_t zstd_filter_id = 32015, blosc_filter_id = 32001;
+
+    /// @brief Default compression level.
+    static constexpr unsigned default_level = 4;
+
+    /// @brief Default target size of each chunk, in bytes.
+    static constexpr size_t default_chunk_bytes = size_t(1) << 20;
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Options that write contiguous, uncompressed data sets.
+    DataSetOptions() = default;
+
+
+    /// @brief Options from the provided ArgParser.
+    /// @param parser Arguments to read. See `parse_compression`, `parse_level`, `parse_chunk_bytes`
+    ///               and `parse_no_shuffle`.
+    /// @throws std::invalid_argument If the compression name is not recognized.
+    explicit DataSetOptions(const ArgParser& parser)
+        : filter(DataSetOptions::getFilter(parser.get(DataSetOptions::parse_compression))),
+          level(parser.get<unsigned>(DataSetOptions::parse_level, DataSetOptions::default_level)),
+          shuffle(!parser.has(DataSetOptions::parse_no_shuffle)),
+          chunk_bytes(parser.get<size_t>(DataSetOptions::parse_chunk_bytes, 0))
+    {
+
+    }
+
+
+    /// @brief Writes a data vector of voxel data in the linear order to an HDF5 group.
+    /// @param group Group to create the data set in.
+    /// @param name Name of the data set.
+    /// @param data Data to write.
+    /// @param size Number of voxels in each direction of the grid the data is for. The chunks are
+    ///             aligned to its rows and planes.
+    /// @return DataSet Object.
+    template <typename T>
+    HighFive::DataSet createDataSet(HighFive::Group& group, const std::string& name,
+                                    const std::vector<T>& data, const GridSize& size) const
+    {
+        return group.createDataSet(name, data, this->getCreateProps<T>(data.size(), size));
+    }
+
+
+    /// @brief Writes a buffer of voxel data in the linear order to an HDF5 group.
+    /// @param group Group to create the data set in.
+    /// @param name Name of the data set.
+    /// @param data Start of the buffer. HDF5 reads from it directly. If null the data set is created
+    ///             but not written, so it may be written in parts.
+    /// @param n Number of elements in the data set.
+    /// @param size Number of voxels in each direction of the grid the data is for.
+    /// @return DataSet Object.
+    template <typename T>
+    HighFive::DataSet createDataSet(HighFive::Group& group, const std::string& name,
+                                    const T* data, const size_t& n, const GridSize& size) const
+    {
+        HighFive::DataSet dset = group.createDataSet<T>(name, HighFive::DataSpace(std::vector<size_t>{n}),
+                                                        this->getCreateProps<T>(n, size));
+        if (data != nullptr)
+        {
+            dset.write_raw(data);
+        }
+        return dset;
+    }
+
+
+    /// @brief Creates the properties for a data set of voxel data in the linear order.
+    /// @param n Number of elements in the data set.
+    /// @param size Number of voxels in each direction of the grid the data is for.
+    /// @return Properties for `HighFive::Group::createDataSet`.
+    template <typename T>
+    HighFive::DataSetCreateProps getCreateProps(const size_t& n, const GridSize& size) const
+    {
+        HighFive::DataSetCreateProps props;
+        const size_t chunk = this->getChunkSize(n, sizeof(T), size);
+        if (chunk == 0)
+        {
+            return props;
+        }
+        props.add(HighFive::Chunking(std::vector<hsize_t>{chunk}));
+        this->addFilters<T>(props);
+        return props;
+    }
+
+
+    /// @brief Creates the properties for a data set of voxel data in the linear order, for a data
+    ///        type only known when running, such as one read from another file.
+    /// @param type Data type of the elements.
+    /// @param n Number of elements in the data set.
+    /// @param size Number of voxels in each direction of the grid the data is for.
+    /// @return Properties for `HighFive::Group::createDataSet`.
+    HighFive::DataSetCreateProps getCreateProps(const HighFive::DataType& type, const size_t& n,
+                                                const GridSize& size) const
+    {
+        HighFive::DataSetCreateProps props;
+        const size_t chunk = this->getChunkSize(n, type.getSize(), size);
+        if (chunk == 0)
+        {
+            return props;
+        }
+        props.add(HighFive::Chunking(std::vector<hsize_t>{chunk}));
+        this->addFilters(props, type.getClass() == HighFive::DataTypeClass::Float);
+        return props;
+    }
+
+
+    /// @brief Adds the shuffle and compression filters to the properties of a chunked data set.
+    /// @param [out] props Properties to add to. These must already have chunking set.
+    template <typename T>
+    void addFilters(HighFive::DataSetCreateProps& props) const
+    {
+        this->addFilters(props, std::is_floating_point<T>::value);
+    }
+
+
+    /// @brief Adds the shuffle and compression filters to the properties of a chunked data set.
+    /// @param [out] props Properties to add to. These must already have chunking set.
+    /// @param floating True if the data set holds floating point values.
+    void addFilters(HighFive::DataSetCreateProps& props, const bool& floating) const
+    {
+        // Shuffling groups the bytes of each float by significance, which compress far better.
+        // Blosc shuffles internally.
+        if (this->shuffle && floating &&
+            (this->filter == Filter::DEFLATE || this->filter == Filter::ZSTD))
+        {
+            props.add(HighFive::Shuffle());
+        }
+
+        switch (this->filter)
+        {
+            case Filter::DEFLATE:
+                props.add(HighFive::Deflate(std::min(this->level, 9u)));
+                break;
+            case Filter::ZSTD:
+                props.add(PluginFilter{zstd_filter_id, {this->level}});
+                break;
+            case Filter::BLOSC:
+                // The first four values are filled in by the filter. Then level, shuffle, and
+                // compressor (0 for BloscLZ).
+                props.add(PluginFilter{blosc_filter_id, {0, 0, 0, 0, std::min(this->level, 9u),
+                                                         this->shuffle ? 1u : 0u, 0}});
+                break;
+            default:
+                break;
+        }
+    }
+
+
+    /// @brief Finds the number of elements in each chunk.
+    /// @param n Number of elements in the data set.
+    /// @param n_bytes Number of bytes in each element.
+    /// @param size Number of voxels in each direction of the grid the data is for.
+    /// @return Number of elements in each chunk. Zero if the data set should be contiguous.
+    size_t getChunkSize(const size_t& n, const size_t& n_bytes, const GridSize& size) const
+    {
+        if (n == 0 || (this->filter == Filter::NONE && this->chunk_bytes == 0))
+        {
+            return 0;
+        }
+        const size_t target = std::max((this->chunk_bytes > 0 ? this->chunk_bytes : default_chunk_bytes) / n_bytes,
+                                       size_t(1));
+        const size_t row = std::max(size.x(), size_t(1)), plane = row * std::max(size.y(), size_t(1));
+
+        const size_t unit = plane <= target ? plane : row <= target ? row : 1;
+        return std::min(target / unit * unit, n);
+    }
+
+
+    /// @brief Gets the Filter from its name.
+    /// @param name Name of the filter. An empty string is the same as "none".
+    /// @return Matching Filter.
+    /// @throws std::invalid_argument If the name is not recognized.
+    static Filter getFilter(const std::string& name)
+    {
+        if (name.empty() || name == "none")  return Filter::NONE;
+        if (name == "deflate" || name == "gzip") return Filter::DEFLATE;
+        if (name == "zstd")  return Filter::ZSTD;
+        if (name == "blosc") return Filter::BLOSC;
+        throw std::invalid_argument("Unknown HDF5 compression \"" + name + "\". Use none, deflate, zstd, or blosc.");
+    }
+
+
+    /// @brief Returns a string help message for the options.
+    static std::string helpMessage()
+    {
+        return "HDF5 output may be compressed with: [" + DataSetOptions::parse_compression + " <none | deflate | zstd | blosc>] " +
+               "[" + DataSetOptions::parse_level + " <level>] [" + DataSetOptions::parse_chunk_bytes + " <bytes>] " +
+               "[" + DataSetOptions::parse_no_shuffle + "]";
+    }
+
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Compression filter applied to each chunk.
+    Filter filter = Filter::NONE;
+
+    /// @brief Compression level. Deflate and Blosc use 0 to 9, Zstd uses 1 to 22.
+    unsigned level = default_level;
+
+    /// @brief If true, floating point data sets are byte-shuffled before compression.
+    bool shuffle = true;
+
+    /// @brief Target size of each chunk in bytes. Zero uses `default_chunk_bytes` when compressing
+    ///        and writes contiguous data sets when not.
+    size_t chunk_bytes = 0;
+
+    static const std::string parse_compression, parse_level, parse_chunk_bytes, parse_no_shuffle;
+
+
+private:
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Data set creation property for a filter which HighFive does not wrap.
+    struct PluginFilter
+    {
+        /// @brief Registered ID of the filter.
+        H5Z_filter_t id;
+
+        /// @brief Parameters for the filter.
+        std::vector<unsigned> values;
+
+        /// @brief Adds the filter to a property list. Called by `HighFive::PropertyList::add`.
+        void apply(hid_t hid) const
+        {
+            if (H5Pset_filter(hid, this->id, H5Z_FLAG_OPTIONAL, this->values.size(), this->values.data()) < 0)
+            {
+                throw std::runtime_error("Failed to add HDF5 filter " + std::to_string(this->id) + ".");
+            }
+        }
+    };
+};
+
+
+/// @brief Gets the mutex every thread holds while it reads or writes an HDF5 file.
+/// @details HDF5 is usually built without its thread-safe option, so no two threads may call it at
+///          once, even for different files. The Manager's save thread, `Manager::save`, the
+///          rolling window's evicted slabs and `sensor::ViewLogWriter` each take this around their
+///          HDF5 calls, including the closing of their files.
+/// @note  The mutex is recursive so a writer may call another which takes it. A thread holding the
+///        Manager's update lock may take it, but not the reverse.
+inline std::recursive_mutex& hdf5Mutex()
+{
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+
+
+/// @brief Selects a box of voxels in a data set of voxel data in the linear order.
+/// @param size Number of voxels in each direction of the grid the data is for.
+/// @param lower Lowest voxel of the box.
+/// @param upper One past the highest voxel of the box, along each axis.
+/// @return Union of one hyperslab per Z-plane of the box, each a strided run of its rows. The
+///         selected voxels are in the same order as `Grid::Properties::forEachInBox` visits them.
+inline HighFive::HyperSlab boxHyperSlab(const GridSize& size, const Index& lower, const Index& upper)
+{
+    const size_t plane = size.x() * size.y();
+    HighFive::HyperSlab slab;
+    for (size_t z = lower.z(); z < upper.z(); ++z)
+    {
+        slab |= HighFive::RegularHyperSlab({z * plane + lower.y() * size.x() + lower.x()},
+                                           {upper.y() - lower.y()}, {size.x()}, {upper.x() - lower.x()});
+    }
+    return slab;
+}
+
+
+/// @brief Creates a link to an object in another HDF5 file, which HDF5 follows when reading.
+/// @param group Group to create the link in.
+/// @param name Name of the link.
+/// @param target_fname Name of the file the object is in. A file name without a directory is found
+///                     in the directory of the file holding the link.
+/// @param target_path Path of the object within that file.
+/// @throws std::runtime_error If the link could not be created.
+inline void createExternalLink(HighFive::Group& group, const std::string& name,
+                               const std::string& target_fname, const std::string& target_path)
+{
+    if (H5Lcreate_external(target_fname.c_str(), target_path.c_str(), group.getId(), name.c_str(),
+                           H5P_DEFAULT, H5P_DEFAULT) < 0)
+    {
+        throw std::runtime_error("Failed to link \"" + name + "\" to \"" + target_fname + ":" + target_path + "\".");
+    }
+}
+
+
+/// @brief ArgParser key for the compression filter name.
+const std::string DataSetOptions::parse_compression = "--h5-compression";
+
+/// @brief ArgParser key for the compression level.
+const std::string DataSetOptions::parse_level = "--h5-level";
+
+/// @brief ArgParser key for the target chunk size in bytes.
+const std::string DataSetOptions::parse_chunk_bytes = "--h5-chunk-bytes";
+
+/// @brief ArgParser flag to not byte-shuffle floating point data sets.
+const std::string DataSetOptions::parse_no_shuffle = "--h5-no-shuffle";
+
+
+} // namespace utilities
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_UTILITIES_HDF5_HPP
@@ -0,0 +1,85 @@
+#ifndef FORGE_SCAN_UTILITIES_HASH_HPP
+#define FORGE_SCAN_UTILITIES_HASH_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+
+namespace forge_scan {
+namespace utilities {
+
+
+/// @brief Initial value for a content hash.
+static constexpr uint64_t hash_seed = 14695981039346656037ULL;
+
+
+/// @brief Adds bytes to a 64-bit FNV-1a content hash.
+/// @param hash Hash to add to. Start with `hash_seed`.
+/// @param data Bytes to add.
+/// @param n Number of bytes.
+/// @return The updated hash.
+/// @note  This identifies content for caching. It is not a cryptographic hash.
+inline uint64_t hashBytes(uint64_t hash, const void* data, const size_t& n)
+{
+    static constexpr uint64_t prime = 1099511628211ULL;
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < n; ++i)
+    {
+        hash = (hash ^ bytes[i]) * prime;
+    }
+    return hash;
+}
+
+
+/// @brief Adds the bytes of a trivially copyable value to a content hash.
+/// @param hash Hash to add to.
+/// @param value Value to add.
+/// @return The updated hash.
+template <typename T>
+inline uint64_t hashValue(const uint64_t& hash, const T& value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values may be hashed.");
+    return hashBytes(hash, &value, sizeof(T));
+}
+
+
+/// @brief Adds the characters of a string to a content hash.
+/// @param hash Hash to add to.
+/// @param str String to add.
+/// @return The updated hash.
+inline uint64_t hashString(const uint64_t& hash, const std::string& str)
+{
+    return hashBytes(hashValue(hash, str.size()), str.data(), str.size());
+}
+
+
+/// @brief Adds the contents of a file to a content hash.
+/// @param hash Hash to add to.
+/// @param fpath File to read.
+/// @return The updated hash. If the file cannot be read its path is added instead.
+inline uint64_t hashFile(uint64_t hash, const std::filesystem::path& fpath)
+{
+    std::ifstream file(fpath, std::ios::binary);
+    if (!file.is_open())
+    {
+        return hashString(hash, fpath.string());
+    }
+
+    char buffer[1 << 16];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+    {
+        hash = hashBytes(hash, buffer, static_cast<size_t>(file.gcount()));
+    }
+    return hash;
+}
+
+
+} // namespace utilities
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_UTILITIES_HASH_HPP
@@ -2,6 +2,9 @@
 #define FORGE_SCAN_UTILITIES_MEMORY_USE_HPP
 
 #include <cstddef>
+#include <list>
+#include <map>
+#include <string>
 #include <vector>
 
 // Define conversion utility for bits_to_megabytes (1e-6) for this header file only.
@@ -33,6 +36,54 @@ inline size_t vector_capacity(const typename std::vector<T>& vec)
 }
 
 
+/// @brief Finds the memory usage of a list.
+/// @param list List of any type.
+/// @return The number of bytes used by the nodes of the list.
+/// @note  Each node holds the element and a link to each of its neighbors.
+template<typename T>
+inline size_t list_size(const typename std::list<T>& list)
+{
+    return (sizeof(T) + 2 * sizeof(void*)) * list.size();
+}
+
+
+/// @brief Memory used by one item, such as a VoxelGrid, and everything it allocates.
+struct Usage
+{
+    /// @brief Number of bytes used by the item.
+    size_t size_bytes = 0;
+
+    /// @brief Number of bytes used by the item, including capacity.
+    size_t capacity_bytes = 0;
+
+    Usage& operator+=(const Usage& other)
+    {
+        this->size_bytes     += other.size_bytes;
+        this->capacity_bytes += other.capacity_bytes;
+        return *this;
+    }
+};
+
+
+/// @brief Dictionary of the memory used by each item of a report, such as `Manager::getMemoryReport`.
+///        Names are paths, like `Reconstruction/Channel/tsdf`, grouping items by their owner.
+typedef std::map<std::string, Usage> Report;
+
+
+/// @brief Sums the memory used by all items of a report.
+/// @param report Report to sum.
+/// @return Total memory used.
+inline Usage total(const Report& report)
+{
+    Usage sum;
+    for (const auto& item : report)
+    {
+        sum += item.second;
+    }
+    return sum;
+}
+
+
 /// @brief Converts bytes to megabytes.
 /// @param bytes Number in bytes.
 /// @return Number in megabytes.
@@ -42,6 +93,15 @@ inline float byte_to_megabytes(const size_t& bytes)
 }
 
 
+/// @brief Converts megabytes to bytes.
+/// @param megabytes Number in megabytes.
+/// @return Number in bytes.
+inline size_t megabytes_to_byte(const float& megabytes)
+{
+    return static_cast<size_t>(static_cast<double>(megabytes) / MB_PER_BYTE);
+}
+
+
 } // namespace memory_use
 } // namespace utilities
 } // namespace forge_scan
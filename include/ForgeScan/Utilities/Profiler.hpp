@@ -0,0 +1,541 @@
+#ifndef FORGE_SCAN_UTILITIES_PROFILER_HPP
+#define FORGE_SCAN_UTILITIES_PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+    #include <malloc.h>
+#endif
+
+#include <highfive/H5Easy.hpp>
+#include <Eigen/Dense>
+
+#include "ForgeScan/Common/Definitions.hpp"
+
+
+/// @brief Group name where the Profiler records are stored in an HDF5 file.
+#define FS_HDF5_PROFILE_GROUP "Profile"
+
+
+// Instrumentation is only compiled in when `FORGE_SCAN_PROFILING` is defined. Otherwise the
+// macros expand to empty statements and their arguments are never evaluated.
+#ifdef FORGE_SCAN_PROFILING
+    #define FS_PROFILE_CONCAT_IMPL(a, b) a##b
+    #define FS_PROFILE_CONCAT(a, b) FS_PROFILE_CONCAT_IMPL(a, b)
+
+    /// @brief Times the rest of the enclosing scope as a Profiler Stage, such as `TRACE`. The name
+    ///        labels trace events, or is nullptr to use the Stage's name.
+    #define FS_PROFILE_SCOPE(stage, name) \
+        const ::forge_scan::utilities::Profiler::Scope FS_PROFILE_CONCAT(fs_profile_scope_, __LINE__)( \
+            ::forge_scan::utilities::Profiler::stage, name)
+
+    /// @brief Adds to a Profiler Counter, such as `RAYS_TRACED`.
+    #define FS_PROFILE_COUNT(counter, n) \
+        ::forge_scan::utilities::Profiler::instance().count(::forge_scan::utilities::Profiler::counter, n)
+
+    /// @brief Closes the Profiler's record for an update.
+    #define FS_PROFILE_RECORD(update) \
+        ::forge_scan::utilities::Profiler::instance().record(update)
+
+    /// @brief Replaces the global `operator new` and `operator delete` so each heap allocation is
+    ///        counted by the `HEAP_ALLOCATIONS` and `HEAP_BYTES` Counters. Place this once, at file
+    ///        scope, in the file holding `main` of an executable.
+    /// @note  Every replaceable form is defined: plain and array, each with and without
+    ///        `std::align_val_t` and `std::nothrow_t`, and the matching deletes. So over-aligned
+    ///        types, such as fixed-size Eigen members, and `new (std::nothrow)` are counted too.
+    #define FS_PROFILE_DEFINE_ALLOCATION_HOOKS() \
+        void* operator new(std::size_t size) \
+        { \
+            if (void* ptr = ::forge_scan::utilities::Profiler::allocate(size)) { return ptr; } \
+            throw std::bad_alloc(); \
+        } \
+        void* operator new(std::size_t size, std::align_val_t alignment) \
+        { \
+            if (void* ptr = ::forge_scan::utilities::Profiler::allocate(size, static_cast<std::size_t>(alignment))) \
+            { \
+                return ptr; \
+            } \
+            throw std::bad_alloc(); \
+        } \
+        void* operator new(std::size_t size, const std::nothrow_t&) noexcept \
+        { \
+            return ::forge_scan::utilities::Profiler::allocate(size); \
+        } \
+        void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept \
+        { \
+            return ::forge_scan::utilities::Profiler::allocate(size, static_cast<std::size_t>(alignment)); \
+        } \
+        void* operator new[](std::size_t size) { return ::operator new(size); } \
+        void* operator new[](std::size_t size, std::align_val_t alignment) { return ::operator new(size, alignment); } \
+        void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return ::operator new(size, tag); } \
+        void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept \
+        { \
+            return ::operator new(size, alignment, tag); \
+        } \
+        void operator delete(void* ptr) noexcept { ::forge_scan::utilities::Profiler::deallocate(ptr); } \
+        void operator delete(void* ptr, std::size_t) noexcept { ::forge_scan::utilities::Profiler::deallocate(ptr); } \
+        void operator delete(void* ptr, const std::nothrow_t&) noexcept { ::forge_scan::utilities::Profiler::deallocate(ptr); } \
+        void operator delete(void* ptr, std::align_val_t) noexcept \
+        { \
+            ::forge_scan::utilities::Profiler::deallocate(ptr, true); \
+        } \
+        void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept \
+        { \
+            ::forge_scan::utilities::Profiler::deallocate(ptr, true); \
+        } \
+        void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept \
+        { \
+            ::forge_scan::utilities::Profiler::deallocate(ptr, true); \
+        } \
+        void operator delete[](void* ptr) noexcept { ::operator delete(ptr); } \
+        void operator delete[](void* ptr, std::size_t size) noexcept { ::operator delete(ptr, size); } \
+        void operator delete[](void* ptr, const std::nothrow_t& tag) noexcept { ::operator delete(ptr, tag); } \
+        void operator delete[](void* ptr, std::align_val_t alignment) noexcept { ::operator delete(ptr, alignment); } \
+        void operator delete[](void* ptr, std::size_t size, std::align_val_t alignment) noexcept \
+        { \
+            ::operator delete(ptr, size, alignment); \
+        } \
+        void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t& tag) noexcept \
+        { \
+            ::operator delete(ptr, alignment, tag); \
+        }
+#else
+    #define FS_PROFILE_SCOPE(stage, name) do { } while (false)
+    #define FS_PROFILE_COUNT(counter, n)  do { } while (false)
+    #define FS_PROFILE_RECORD(update)     do { } while (false)
+    #define FS_PROFILE_DEFINE_ALLOCATION_HOOKS()
+#endif
+
+
+namespace forge_scan {
+namespace utilities {
+
+
+/// @brief Accumulates the time spent in each stage of an update, and counts of the work done,
+///        into one record per update.
+/// @details Code is instrumented with the `FS_PROFILE_SCOPE`, `FS_PROFILE_COUNT` and
+///          `FS_PROFILE_RECORD` macros, which do nothing unless `FORGE_SCAN_PROFILING` is defined.
+///          Times come from `std::chrono::steady_clock`, which is monotonic.
+///
+///          Everything timed or counted since the last record is added to the next one, so each
+///          `Manager::reconstructionUpdate` closes a record covering the update, its Metrics and
+///          any Policy generation or Scene imaging done since the previous update.
+///          Updates made from frames queued with `Manager::ingestFrame` also count the microseconds
+///          from the frame's arrival to the end of its integration in `INGEST_LATENCY_US`.
+///
+///          Optionally each timed scope is also kept as an event, which may be written in the Chrome
+///          trace format and viewed in `chrome://tracing` or Perfetto.
+///
+///          An executable may also count its heap allocations, see `FS_PROFILE_DEFINE_ALLOCATION_HOOKS`.
+///          Buffers are kept and reused between updates, so once their capacity has grown to fit the
+///          views the steady-state update should make few allocations. Thread creation by the
+///          multi-threaded updates, and the results of Open3D's raycasting, still allocate.
+/// @note  There is one Profiler for the process, see `instance`. Scopes and counts may be used from
+///        any number of threads. A Stage timed on several threads at once sums the time of each, so
+///        it may exceed the wall-clock time of the update.
+class Profiler
+{
+public:
+    /// @brief Timed stages of an update.
+    enum Stage : size_t
+    {
+        MANAGER_UPDATE,
+        RECONSTRUCTION_UPDATE,
+        TRACE,
+        CHANNEL_UPDATE,
+        METRIC_UPDATE,
+        POLICY_GENERATE,
+        SCENE_IMAGE,
+        NUM_STAGES
+    };
+
+
+    /// @brief Counted work of an update.
+    enum Counter : size_t
+    {
+        RAYS_TRACED,
+        RAYS_REJECTED,
+        RAYS_MERGED,
+        VOXELS_VISITED,
+        HEAP_ALLOCATIONS,
+        HEAP_BYTES,
+        INGEST_LATENCY_US,
+        NUM_COUNTERS
+    };
+
+
+    /// @brief Totals for one update.
+    struct Record
+    {
+        /// @brief Update count the record was closed for.
+        size_t update;
+
+        /// @brief Time in each Stage, in milliseconds.
+        std::array<double, NUM_STAGES> stage_ms;
+
+        /// @brief Value of each Counter.
+        std::array<uint64_t, NUM_COUNTERS> counters;
+    };
+
+
+    /// @brief One timed scope, kept for the Chrome trace export.
+    struct Event
+    {
+        Stage stage;
+        std::string name;
+        /// @brief Index of the thread the scope ran on.
+        size_t thread;
+
+        /// @brief Start time, relative to the Profiler's creation, and duration, in microseconds.
+        double start_us, duration_us;
+    };
+
+
+    /// @brief Times a Stage from construction to destruction. See `FS_PROFILE_SCOPE`.
+    class Scope
+    {
+    public:
+        /// @param stage Stage to add the time to.
+        /// @param name  Name of the event, if events are kept. Defaults to the Stage's name. It must
+        ///              outlive the Scope.
+        explicit Scope(const Stage& stage, const char* name = nullptr)
+            : stage(stage),
+              name(name),
+              start(std::chrono::steady_clock::now())
+        {
+
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        ~Scope()
+        {
+            Profiler::instance().add(this->stage, this->name, this->start, std::chrono::steady_clock::now());
+        }
+
+    private:
+        const Stage stage;
+        const char* const name;
+        const std::chrono::steady_clock::time_point start;
+    };
+
+
+    // ***************************************************************************************** //
+    // *                                 PUBLIC CLASS METHODS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Returns the Profiler for the process.
+    static Profiler& instance()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+
+    /// @brief Adds to a Counter.
+    /// @param counter Counter to add to.
+    /// @param n Amount to add.
+    void count(const Counter& counter, const uint64_t& n)
+    {
+        this->counters[counter].fetch_add(n, std::memory_order_relaxed);
+    }
+
+
+    /// @brief Counts a heap allocation. Called by the hooks of `FS_PROFILE_DEFINE_ALLOCATION_HOOKS`.
+    /// @param size Number of bytes allocated.
+    /// @note  This must not allocate, so the counts are kept apart from the Profiler instance, which
+    ///        may not be constructed yet when the first allocations of the process are made.
+    static void countAllocation(const size_t& size)
+    {
+        Profiler::heapCounts()[0].fetch_add(1,    std::memory_order_relaxed);
+        Profiler::heapCounts()[1].fetch_add(size, std::memory_order_relaxed);
+    }
+
+
+    /// @brief Allocates, and counts, the memory for the hooks of `FS_PROFILE_DEFINE_ALLOCATION_HOOKS`.
+    /// @param size Number of bytes to allocate.
+    /// @param alignment Alignment of the memory, or zero for that of `std::malloc`.
+    /// @return Pointer to the memory, or nullptr if it could not be allocated.
+    static void* allocate(std::size_t size, const std::size_t& alignment = 0) noexcept
+    {
+        Profiler::countAllocation(size);
+        size = size == 0 ? 1 : size;
+        if (alignment == 0)
+        {
+            return std::malloc(size);
+        }
+#if defined(_MSC_VER)
+        return _aligned_malloc(size, alignment);
+#else
+        // The size must be a multiple of the alignment.
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+
+    /// @brief Frees memory from `allocate`.
+    /// @param ptr Pointer to the memory, or nullptr.
+    /// @param aligned True if it was allocated with an alignment.
+    static void deallocate(void* ptr, [[maybe_unused]] const bool& aligned = false) noexcept
+    {
+#if defined(_MSC_VER)
+        if (aligned)
+        {
+            _aligned_free(ptr);
+            return;
+        }
+#endif
+        std::free(ptr);
+    }
+
+
+    /// @brief Adds the time of a timed scope to a Stage. Called by `Scope`.
+    /// @param stage Stage to add the time to.
+    /// @param name  Name of the event, if events are kept, or nullptr for the Stage's name.
+    /// @param start Start time of the scope.
+    /// @param end   End time of the scope.
+    void add(const Stage& stage, const char* name,
+             const std::chrono::steady_clock::time_point& start, const std::chrono::steady_clock::time_point& end)
+    {
+        this->stage_ns[stage].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+                                        std::memory_order_relaxed);
+        if (this->keep_events.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(this->event_mutex);
+            this->events.push_back(Event{stage, name != nullptr ? std::string(name) : Profiler::stage_names[stage],
+                                         Profiler::threadIndex(),
+                                         Profiler::toMicroseconds(start - this->epoch),
+                                         Profiler::toMicroseconds(end - start)});
+        }
+    }
+
+
+    /// @brief Closes the record for an update and starts the next one.
+    /// @param update Update count to label the record with.
+    /// @note  This may be called while scopes are timed, and counts added, on other threads. Each
+    ///        scope or count is added by one atomic operation, which the record takes and clears
+    ///        with another, so it lands whole in exactly one record: a scope which ends before the
+    ///        record is closed is in it, and one still running is in the next. The closed records
+    ///        are kept under a lock, so records may also be closed, read or saved from any thread.
+    void record(const size_t& update)
+    {
+        Record r;
+        r.update = update;
+        for (size_t s = 0; s < NUM_STAGES; ++s)
+        {
+            r.stage_ms[s] = 1e-6 * static_cast<double>(this->stage_ns[s].exchange(0, std::memory_order_relaxed));
+        }
+        for (size_t c = 0; c < NUM_COUNTERS; ++c)
+        {
+            r.counters[c] = this->counters[c].exchange(0, std::memory_order_relaxed);
+        }
+        r.counters[HEAP_ALLOCATIONS] += Profiler::heapCounts()[0].exchange(0, std::memory_order_relaxed);
+        r.counters[HEAP_BYTES]       += Profiler::heapCounts()[1].exchange(0, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(this->record_mutex);
+        this->records.push_back(r);
+    }
+
+
+    /// @brief Returns a copy of the closed records, in order.
+    std::vector<Record> getRecords() const
+    {
+        std::lock_guard<std::mutex> lock(this->record_mutex);
+        return this->records;
+    }
+
+
+    /// @brief Sets whether each timed scope is kept as an event for `writeChromeTrace`.
+    /// @param keep True to keep events. Events cost a lock and an allocation each, so this is off
+    ///             by default.
+    void setKeepEvents(const bool& keep)
+    {
+        this->keep_events.store(keep, std::memory_order_relaxed);
+    }
+
+
+    /// @brief Clears the records, events and any times and counts not yet recorded.
+    void reset()
+    {
+        for (auto& ns : this->stage_ns)
+        {
+            ns.store(0, std::memory_order_relaxed);
+        }
+        for (auto& n : this->counters)
+        {
+            n.store(0, std::memory_order_relaxed);
+        }
+        for (auto& n : Profiler::heapCounts())
+        {
+            n.store(0, std::memory_order_relaxed);
+        }
+        {
+            std::lock_guard<std::mutex> lock(this->record_mutex);
+            this->records.clear();
+        }
+        std::lock_guard<std::mutex> lock(this->event_mutex);
+        this->events.clear();
+    }
+
+
+    /// @brief Saves the records to an HDF5 file, if there are any.
+    /// @param file HDF5 file to save to.
+    /// @details The records are a matrix with a row for each update. The columns are the update
+    ///          count, the time of each Stage in milliseconds, and then each Counter. Their names
+    ///          are stored in the `header` attribute.
+    void save(HighFive::File& file) const
+    {
+        std::lock_guard<std::mutex> lock(this->record_mutex);
+        if (this->records.empty())
+        {
+            return;
+        }
+        Eigen::MatrixXd mat(this->records.size(), 1 + NUM_STAGES + NUM_COUNTERS);
+        for (size_t n = 0; n < this->records.size(); ++n)
+        {
+            const Record& r = this->records[n];
+            mat(n, 0) = static_cast<double>(r.update);
+            for (size_t s = 0; s < NUM_STAGES; ++s)
+            {
+                mat(n, 1 + s) = r.stage_ms[s];
+            }
+            for (size_t c = 0; c < NUM_COUNTERS; ++c)
+            {
+                mat(n, 1 + NUM_STAGES + c) = static_cast<double>(r.counters[c]);
+            }
+        }
+
+        std::vector<std::string> headers = {"update"};
+        for (const auto& name : Profiler::stage_names)
+        {
+            headers.push_back(name + " [ms]");
+        }
+        headers.insert(headers.end(), Profiler::counter_names.begin(), Profiler::counter_names.end());
+
+        static const std::string path = "/" FS_HDF5_PROFILE_GROUP "/data";
+        H5Easy::dump(file, path, mat);
+        H5Easy::dumpAttribute(file, path, "header", headers);
+    }
+
+
+    /// @brief Writes the kept events in the Chrome trace format.
+    /// @param fpath Path to write to. Its extension is changed to `.json`.
+    /// @return The path written to.
+    /// @note  See `setKeepEvents`. The file may be opened in `chrome://tracing` or Perfetto.
+    std::filesystem::path writeChromeTrace(std::filesystem::path fpath) const
+    {
+        fpath.replace_extension(".json");
+        if (fpath.has_parent_path())
+        {
+            std::filesystem::create_directories(fpath.parent_path());
+        }
+        std::ofstream file(fpath);
+
+        std::lock_guard<std::mutex> lock(this->event_mutex);
+        file << "{\"traceEvents\":[" << std::fixed << std::setprecision(3);
+        for (size_t n = 0; n < this->events.size(); ++n)
+        {
+            const Event& e = this->events[n];
+            file << (n == 0 ? "\n" : ",\n")
+                 << "{\"name\":\"" << e.name << "\",\"cat\":\"" << Profiler::stage_names[e.stage]
+                 << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.thread
+                 << ",\"ts\":" << e.start_us << ",\"dur\":" << e.duration_us << "}";
+        }
+        file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        return fpath;
+    }
+
+
+    /// @brief Names of each Stage.
+    static const std::array<std::string, NUM_STAGES> stage_names;
+
+    /// @brief Names of each Counter.
+    static const std::array<std::string, NUM_COUNTERS> counter_names;
+
+
+private:
+    Profiler()
+        : epoch(std::chrono::steady_clock::now())
+    {
+        this->reset();
+    }
+
+
+    /// @brief Numbers each thread which adds an event, in the order they first do so.
+    static size_t threadIndex()
+    {
+        static std::atomic<size_t> n_threads{0};
+        thread_local const size_t index = n_threads.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+
+    /// @brief Number of heap allocations, and bytes allocated, since the last record. Only counted
+    ///        if `FS_PROFILE_DEFINE_ALLOCATION_HOOKS` is used.
+    static std::array<std::atomic<uint64_t>, 2>& heapCounts()
+    {
+        static std::array<std::atomic<uint64_t>, 2> counts{};
+        return counts;
+    }
+
+
+    template <typename Duration>
+    static double toMicroseconds(const Duration& duration)
+    {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+
+    // ***************************************************************************************** //
+    // *                                PRIVATE CLASS MEMBERS                                  * //
+    // ***************************************************************************************** //
+
+
+    /// @brief Time the event start times are relative to.
+    const std::chrono::steady_clock::time_point epoch;
+
+    /// @brief Time in each Stage, and each Counter, since the last record.
+    std::array<std::atomic<uint64_t>, NUM_STAGES>   stage_ns;
+    std::array<std::atomic<uint64_t>, NUM_COUNTERS> counters;
+
+    /// @brief Closed records, in order, and the lock they are added under.
+    std::vector<Record> records;
+    mutable std::mutex record_mutex;
+
+    /// @brief True if timed scopes are kept as events.
+    std::atomic<bool> keep_events{false};
+
+    /// @brief Kept events, and the lock they are added under.
+    std::vector<Event> events;
+    mutable std::mutex event_mutex;
+};
+
+
+const std::array<std::string, Profiler::NUM_STAGES> Profiler::stage_names = {
+    "manager update", "reconstruction update", "trace", "channel update",
+    "metric update", "policy generate", "scene image"
+};
+
+const std::array<std::string, Profiler::NUM_COUNTERS> Profiler::counter_names = {
+    "rays traced", "rays rejected", "rays merged", "voxels visited", "heap allocations", "heap bytes",
+    "ingest latency us"
+};
+
+
+} // namespace utilities
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_UTILITIES_PROFILER_HPP
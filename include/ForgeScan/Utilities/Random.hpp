@@ -1,6 +1,10 @@
 #ifndef FORGE_SCAN_UTILITIES_RANDOM_HPP
 #define FORGE_SCAN_UTILITIES_RANDOM_HPP
 
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <random>
 #include <type_traits>
 
@@ -18,15 +22,173 @@ namespace utilities {
 std::random_device RANDOM_DEVICE;
 
 
+/// @brief Philox4x32-10 counter-based random number generator.
+/// @details Each block of four 32-bit values is a pure function of a seed, a stream and the
+///          block's index within the stream, so any value may be generated without the ones before
+///          it. Work split across threads, such as the noise of each pixel of a depth image, is
+///          then reproducible for a seed no matter which thread generates which part, or in what
+///          order. See Salmon et al. "Parallel random numbers: as easy as 1, 2, 3" (SC 2011).
+/// @note  This also meets the requirements of a standard `UniformRandomBitGenerator`, stepping
+///        through the blocks of one stream in order, so it may be used with the standard
+///        distributions and algorithms.
+class Philox
+{
+public:
+    typedef uint32_t result_type;
+
+    /// @brief Four values generated together.
+    typedef std::array<uint32_t, 4> Block;
+
+
+    /// @brief Creates a generator at the start of a stream.
+    /// @param seed   Seed, the key of the generator.
+    /// @param stream Stream within the seed, such as the index of a view.
+    explicit Philox(const uint64_t& seed = 0, const uint64_t& stream = 0)
+        : seed(seed),
+          stream(stream)
+    {
+
+    }
+
+
+    /// @brief Generates one block of four values.
+    /// @param seed   Seed, the key of the generator.
+    /// @param stream Stream within the seed.
+    /// @param index  Index of the block within the stream.
+    /// @return The block's values.
+    static Block generate(const uint64_t& seed, const uint64_t& stream, const uint64_t& index)
+    {
+        Block ctr = {static_cast<uint32_t>(index),  static_cast<uint32_t>(index >> 32),
+                     static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)};
+        uint32_t k0 = static_cast<uint32_t>(seed), k1 = static_cast<uint32_t>(seed >> 32);
+        for (int round = 0; round < 10; ++round)
+        {
+            const uint64_t p0 = static_cast<uint64_t>(Philox::m0) * ctr[0];
+            const uint64_t p1 = static_cast<uint64_t>(Philox::m1) * ctr[2];
+            ctr = {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ k0, static_cast<uint32_t>(p1),
+                   static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ k1, static_cast<uint32_t>(p0)};
+            k0 += Philox::w0;
+            k1 += Philox::w1;
+        }
+        return ctr;
+    }
+
+
+    /// @brief Generates four uniformly sampled values between [0, 1) from one block.
+    /// @param seed   Seed, the key of the generator.
+    /// @param stream Stream within the seed.
+    /// @param index  Index of the block within the stream.
+    static std::array<float, 4> uniform(const uint64_t& seed, const uint64_t& stream, const uint64_t& index)
+    {
+        const Block block = Philox::generate(seed, stream, index);
+        return {Philox::toUniform(block[0]), Philox::toUniform(block[1]),
+                Philox::toUniform(block[2]), Philox::toUniform(block[3])};
+    }
+
+
+    /// @brief Generates four values from the standard normal distribution from one block, with
+    ///        the Box-Muller transform.
+    /// @param seed   Seed, the key of the generator.
+    /// @param stream Stream within the seed.
+    /// @param index  Index of the block within the stream.
+    static std::array<float, 4> normal(const uint64_t& seed, const uint64_t& stream, const uint64_t& index)
+    {
+        const Block block = Philox::generate(seed, stream, index);
+        std::array<float, 4> out;
+        for (size_t i = 0; i < 4; i += 2)
+        {
+            // Shift the first value by half a step so it lies in (0, 1) and its log is finite.
+            const float r     = std::sqrt(-2.0f * std::log(Philox::toUniform(block[i]) + 0.5f * Philox::step));
+            const float theta = static_cast<float>(2 * M_PI) * Philox::toUniform(block[i + 1]);
+            out[i]     = r * std::cos(theta);
+            out[i + 1] = r * std::sin(theta);
+        }
+        return out;
+    }
+
+
+    /// @brief Maps a value to [0, 1) using its upper 24 bits, the precision of a float.
+    static float toUniform(const uint32_t& x)
+    {
+        return static_cast<float>(x >> 8) * Philox::step;
+    }
+
+
+    /// @brief Moves the generator to the start of a block in its stream.
+    /// @param index Index of the block.
+    void seek(const uint64_t& index)
+    {
+        this->index = index;
+        this->n_used = 4;
+    }
+
+
+    /// @brief Returns the next value of the stream.
+    result_type operator()()
+    {
+        if (this->n_used == 4)
+        {
+            this->block  = Philox::generate(this->seed, this->stream, this->index++);
+            this->n_used = 0;
+        }
+        return this->block[this->n_used++];
+    }
+
+
+    /// @brief Skips values of the stream.
+    /// @param n Number of values to skip.
+    void discard(unsigned long long n)
+    {
+        const unsigned long long n_left = 4 - this->n_used;
+        if (n <= n_left)
+        {
+            this->n_used += static_cast<unsigned int>(n);
+            return;
+        }
+        n -= n_left;
+        this->seek(this->index + n / 4);
+        for (n %= 4; n > 0; --n)
+        {
+            (*this)();
+        }
+    }
+
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+
+    /// @brief Seed and stream of the generator.
+    const uint64_t seed, stream;
+
+
+private:
+    /// @brief Multipliers and key increments of the Philox4x32 round function.
+    static constexpr uint32_t m0 = 0xD2511F53, m1 = 0xCD9E8D57, w0 = 0x9E3779B9, w1 = 0xBB67AE85;
+
+    /// @brief Spacing of the values `toUniform` returns.
+    static constexpr float step = 1.0f / 16777216.0f;
+
+    /// @brief Index of the next block to generate.
+    uint64_t index = 0;
+
+    /// @brief Most recent block, and how many of its values have been returned.
+    Block block{};
+    unsigned int n_used = 4;
+};
+
+
 template<
     typename T = float,
     typename = typename std::enable_if<std::is_arithmetic<T>::value, T>::type
 >
 struct RandomSampler
 {
-    RandomSampler(const int& seed = -1)
+    /// @param seed Seed for the generator. Values of zero or less use a random seed.
+    /// @param stream Stream of the generator within the seed. See `Philox`.
+    RandomSampler(const int& seed = -1, const uint64_t& stream = 0)
         : seed( seed > 0 ? static_cast<unsigned int>(seed) : RANDOM_DEVICE() ),
-          gen( std::mt19937(this->seed) ),
+          gen( Philox(this->seed, stream) ),
           uniform_dist( std::uniform_real_distribution<double>(0.0, 1.0) )
     {
 
@@ -96,7 +258,7 @@ struct RandomSampler
     const unsigned int seed;
 
     /// @brief Random number engine for performing sampling on the uniform real distribution.
-    std::mt19937 gen;
+    Philox gen;
 
 private:
     /// @brief Uniform distribution of double values over [0, 1).
@@ -0,0 +1,360 @@
+#ifndef FORGE_SCAN_UTILITIES_THREADS_HPP
+#define FORGE_SCAN_UTILITIES_THREADS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace forge_scan {
+namespace utilities {
+
+
+/// @brief Returns the number of hardware threads reported by the system.
+/// @return Number of concurrent threads supported. At least one.
+inline size_t getHardwareThreadCount()
+{
+    return std::max(static_cast<size_t>(std::thread::hardware_concurrency()), static_cast<size_t>(1));
+}
+
+
+/// @brief Reduces the range `[0, n)` in contiguous slabs, one for each thread, and sums the results.
+/// @param n Number of elements.
+/// @param n_threads Maximum number of threads to use, including the calling thread.
+/// @param min_per_thread Fewest elements worth starting a thread for.
+/// @param reduce Callable with the signature `T(first, last)` which reduces the elements `[first, last)`.
+/// @return Sum of the results for every slab.
+/// @tparam T Result type. Its default value must be zero and it must support `+=`.
+/// @note  `reduce` is called from several threads at once and must not throw.
+template <typename T, typename Reduce>
+T parallelReduce(const size_t& n, const size_t& n_threads, const size_t& min_per_thread, Reduce&& reduce)
+{
+    const size_t n_slabs = std::clamp(n / std::max(min_per_thread, static_cast<size_t>(1)),
+                                      static_cast<size_t>(1), std::max(n_threads, static_cast<size_t>(1)));
+    if (n_slabs == 1)
+    {
+        return reduce(static_cast<size_t>(0), n);
+    }
+
+    std::vector<T> results(n_slabs);
+    std::vector<std::thread> threads;
+    threads.reserve(n_slabs - 1);
+    for (size_t s = 1; s < n_slabs; ++s)
+    {
+        threads.emplace_back([&, s]() { results[s] = reduce(n * s / n_slabs, n * (s + 1) / n_slabs); });
+    }
+    results[0] = reduce(static_cast<size_t>(0), n / n_slabs);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    T total = results[0];
+    for (size_t s = 1; s < n_slabs; ++s)
+    {
+        total += results[s];
+    }
+    return total;
+}
+
+
+/// @brief A reusable barrier for synchronizing a fixed number of threads between the phases of
+///        a parallel algorithm.
+/// @note  This is a minimal stand-in for the C++20 `std::barrier`.
+class Barrier
+{
+public:
+    /// @brief Constructs a barrier for the specified number of threads.
+    /// @param n_threads Number of threads which must call `wait` before any are released.
+    explicit Barrier(const size_t& n_threads)
+        : n_threads(std::max(n_threads, static_cast<size_t>(1))),
+          n_waiting(0),
+          generation(0)
+    {
+
+    }
+
+
+    /// @brief Blocks the calling thread until all threads of the barrier have called `wait`.
+    ///        The barrier then resets itself so it may be reused for the next phase.
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        const size_t arrival_generation = this->generation;
+        if (++this->n_waiting == this->n_threads)
+        {
+            this->n_waiting = 0;
+            ++this->generation;
+            this->condition.notify_all();
+        }
+        else
+        {
+            this->condition.wait(lock, [this, arrival_generation]() { return arrival_generation != this->generation; });
+        }
+    }
+
+
+private:
+    /// @brief Number of threads which participate in the barrier.
+    const size_t n_threads;
+
+    /// @brief Number of threads currently waiting at the barrier.
+    size_t n_waiting;
+
+    /// @brief Incremented each time the barrier releases its threads.
+    size_t generation;
+
+    /// @brief Guards access to the waiting count and generation.
+    std::mutex mutex;
+
+    /// @brief Condition variable that waiting threads block on.
+    std::condition_variable condition;
+};
+
+
+/// @brief A first-in, first-out queue with a fixed capacity for passing work between threads.
+/// @details Producers block in `push` while the queue is full and consumers block in `pop` while it
+///          is empty. Once `close` is called no more items are accepted; consumers drain the items
+///          already queued and then `pop` returns false.
+template <typename T>
+class BoundedQueue
+{
+public:
+    /// @brief Constructs an empty queue.
+    /// @param capacity Maximum number of queued items. At least one.
+    explicit BoundedQueue(const size_t& capacity)
+        : capacity(std::max(capacity, static_cast<size_t>(1))),
+          closed(false)
+    {
+
+    }
+
+
+    /// @brief Adds an item to the back of the queue, blocking while the queue is full.
+    /// @param item Item to add.
+    /// @return True if the item was added. False if the queue was closed.
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->not_full.wait(lock, [this]() { return this->closed || this->items.size() < this->capacity; });
+        if (this->closed)
+        {
+            return false;
+        }
+        this->items.push_back(std::move(item));
+        lock.unlock();
+        this->not_empty.notify_one();
+        return true;
+    }
+
+
+    /// @brief Removes the item at the front of the queue, blocking while the queue is empty.
+    /// @param [out] item Item that was removed.
+    /// @return True if an item was removed. False if the queue is closed and empty.
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->not_empty.wait(lock, [this]() { return this->closed || !this->items.empty(); });
+        if (this->items.empty())
+        {
+            return false;
+        }
+        item = std::move(this->items.front());
+        this->items.pop_front();
+        lock.unlock();
+        this->not_full.notify_one();
+        return true;
+    }
+
+
+    /// @brief Stops the queue from accepting items and wakes every blocked thread.
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->closed = true;
+        }
+        this->not_empty.notify_all();
+        this->not_full.notify_all();
+    }
+
+
+    /// @brief Returns the number of queued items.
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->items.size();
+    }
+
+
+private:
+    /// @brief Maximum number of queued items.
+    const size_t capacity;
+
+    /// @brief True once `close` has been called.
+    bool closed;
+
+    /// @brief Queued items.
+    std::deque<T> items;
+
+    /// @brief Guards access to the items and closed flag.
+    mutable std::mutex mutex;
+
+    /// @brief Condition variable that `pop` blocks on.
+    std::condition_variable not_empty;
+
+    /// @brief Condition variable that `push` blocks on.
+    std::condition_variable not_full;
+};
+
+
+/// @brief A lock-free, first-in, first-out queue with a fixed capacity for passing items between
+///        any number of producer and consumer threads.
+/// @details Each slot has a sequence number which tells producers and consumers whether it is free
+///          or filled for their turn, so `tryPush` and `tryPop` only claim a position with an atomic
+///          compare-and-swap and never lock or block. The capacity is rounded up to a power of two.
+/// @note  Threads which need to wait for an item or a free slot should do so around these calls,
+///        such as with a condition variable, as `sensor::FrameQueue` does.
+template <typename T>
+class RingQueue
+{
+public:
+    /// @brief Constructs an empty queue.
+    /// @param capacity Minimum number of queued items. At least two.
+    explicit RingQueue(const size_t& capacity)
+        : mask(RingQueue::roundUpToPowerOfTwo(capacity) - 1),
+          slots(new Slot[this->mask + 1])
+    {
+        for (size_t i = 0; i <= this->mask; ++i)
+        {
+            this->slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+
+    /// @brief Adds an item to the back of the queue, if there is room.
+    /// @param item Item to add. Only moved from if it was added.
+    /// @return True if the item was added. False if the queue was full.
+    bool tryPush(T& item)
+    {
+        size_t pos = this->push_pos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot& slot = this->slots[pos & this->mask];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0)
+            {
+                if (this->push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.item = std::move(item);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = this->push_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+
+    /// @brief Removes the item at the front of the queue, if there is one.
+    /// @param [out] item Item that was removed.
+    /// @return True if an item was removed. False if the queue was empty.
+    bool tryPop(T& item)
+    {
+        size_t pos = this->pop_pos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot& slot = this->slots[pos & this->mask];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (this->pop_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    item = std::move(slot.item);
+                    slot.sequence.store(pos + this->mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = this->pop_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+
+    /// @brief Returns the number of queued items. Only a snapshot while other threads use the queue.
+    size_t size() const
+    {
+        const size_t pushed = this->push_pos.load(std::memory_order_acquire);
+        const size_t popped = this->pop_pos.load(std::memory_order_acquire);
+        return pushed > popped ? pushed - popped : 0;
+    }
+
+
+    /// @brief Returns the number of items the queue may hold.
+    size_t capacity() const
+    {
+        return this->mask + 1;
+    }
+
+
+private:
+    /// @brief A queued item and the sequence number of the turn it is for.
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+
+    /// @brief Rounds a capacity up to the next power of two, of at least two.
+    static size_t roundUpToPowerOfTwo(const size_t& capacity)
+    {
+        size_t n = 2;
+        while (n < capacity)
+        {
+            n <<= 1;
+        }
+        return n;
+    }
+
+
+    /// @brief One less than the number of slots, for wrapping positions.
+    const size_t mask;
+
+    /// @brief The slots of the ring.
+    const std::unique_ptr<Slot[]> slots;
+
+    /// @brief Positions of the next push and pop. Each is on its own cache line so producers and
+    ///        consumers do not contend for it.
+    alignas(64) std::atomic<size_t> push_pos{0};
+    alignas(64) std::atomic<size_t> pop_pos{0};
+};
+
+
+} // namespace utilities
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_UTILITIES_THREADS_HPP
@@ -11,20 +11,20 @@ namespace forge_scan {
 namespace utilities {
 
 
-/// @brief Minimal implementation for a timer using std::chrono.
+/// @brief Minimal implementation for a timer using the monotonic `std::chrono::steady_clock`.
 struct Timer
 {
     /// @brief Starts the SimpleTimer.
     void start()
     {
-        start_time = std::chrono::system_clock::now();
+        start_time = std::chrono::steady_clock::now();
         running = true;
     }
 
     /// @brief Stops the SimpleTimer.
     void stop()
     {
-        end_time = std::chrono::system_clock::now();
+        end_time = std::chrono::steady_clock::now();
         running = false;
     }
 
@@ -34,7 +34,7 @@ struct Timer
     {
         if (this->running)
         {
-            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start_time).count();
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
         }
         return std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
     }
@@ -46,7 +46,7 @@ struct Timer
     {
         if (this->running)
         {
-            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start_time).count();
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
         }
         return std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
     }
@@ -63,10 +63,10 @@ struct Timer
 private:
 
     /// @brief Start time for the timer.
-    std::chrono::time_point<std::chrono::system_clock> start_time;
+    std::chrono::time_point<std::chrono::steady_clock> start_time;
 
     /// @brief End time for the timer.
-    std::chrono::time_point<std::chrono::system_clock> end_time;
+    std::chrono::time_point<std::chrono::steady_clock> end_time;
 
     /// @brief True if the timer is running.
     bool running = false;
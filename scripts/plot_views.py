@@ -134,18 +134,30 @@ def add_view_to_plot(extr: np.array, view_id: str, ax: plt.Axes, accept: bool,
         ax.text(text[0], text[1], text[2], view_id, color=origin_color, fontsize=VIEW_ID_FONT_SIZE)
 
 
+def get_views(group: h5py.Group):
+    """
+    Yields the identifier and matrix of each view in a group. Views are stored as one N x 4 x 4
+    "views" data set with their identifiers in "ids", or in older files as one data set per view.
+    """
+    if "views" in group:
+        for (view_id, extr) in zip(np.array(group["ids"]), np.array(group["views"])):
+            yield str(view_id), extr
+    else:
+        for (dset_name, dset) in group.items():
+            if isinstance(dset, h5py.Dataset):
+                yield dset_name, np.array(dset)
+
+
 def add_accepted_group_to_plot(group: h5py.Group, ax: plt.Axes,
                                parsed_args: argparse.Namespace = None) -> None:
-    for (dset_name, dset) in group.items():
-        if isinstance(dset, h5py.Dataset):
-            add_view_to_plot(np.array(dset), dset_name, ax, accept=True, parsed_args=parsed_args)
+    for (view_id, extr) in get_views(group):
+        add_view_to_plot(extr, view_id, ax, accept=True, parsed_args=parsed_args)
 
 
 def add_rejected_group_to_plot(group: h5py.Group, ax: plt.Axes,
                                parsed_args: argparse.Namespace = None) -> None:
-    for (dset_name, dset) in group.items():
-        if isinstance(dset, h5py.Dataset):
-            add_view_to_plot(np.array(dset), dset_name, ax, accept=False, parsed_args=parsed_args)
+    for (view_id, extr) in get_views(group):
+        add_view_to_plot(extr, view_id, ax, accept=False, parsed_args=parsed_args)
 
 
 def plot_views(policy_group: h5py.Group, ax: plt.Axes, parsed_args: argparse.Namespace = None) -> None:
@@ -155,9 +167,9 @@ def plot_views(policy_group: h5py.Group, ax: plt.Axes, parsed_args: argparse.Nam
     for (_, group) in policy_group.items():
         if isinstance(group, h5py.Group):
             for (view_group_name, group) in group.items():
-                if (view_group_name == "ACCEPT"):
+                if (view_group_name in ("accepted", "ACCEPT")):
                     add_accepted_group_to_plot(group, ax, parsed_args)
-                if (view_group_name == "REJECT") and parsed_args and parsed_args.plot_rejects:
+                if (view_group_name in ("rejected", "REJECT")) and parsed_args and parsed_args.plot_rejects:
                     add_rejected_group_to_plot(group, ax, parsed_args)
 
 
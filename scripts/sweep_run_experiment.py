@@ -1,13 +1,12 @@
 import argparse
 import pathlib
 import subprocess
-import random
 
 
 ## ----------------------- LOCATE EXECUTABLE FILES AND GROUND TRUTH DATA ----------------------- ##
 
 HDF5_EXTENSION  = ".h5"
-EXECUTABLE_NAME = 'RunExperiment'
+EXECUTABLE_NAME = 'SweepExperiment'
 EXECUTABLE_PATH = None
 
 # Find the project root and binary directory and the executable (regardless of its file extension).
@@ -42,8 +41,6 @@ for item in GROUND_TRUTH_PATH.iterdir():
 
 ## ----------------------------------- DEFINE FILE CONSTANTS ----------------------------------- ##
 
-STDIN_NEWLINE = "\n"
-
 # Exploration space
 REGULAR_RERUNS = 1
 RANDOM_RERUNS  = 10
@@ -118,87 +115,52 @@ METHODS: list[tuple[str, str, str]] = [
 
 ## ------------------------------ SCRIPT METHODS AND ENTRY POINT ------------------------------- ##
 
-def call_process(fpath: pathlib.Path, scene: pathlib.Path, intr: str, policy_name: str,
-                 policy: str, n_views: int, seed: int = 0, parsed_args: argparse.Namespace = None):
-    stdin  = ""
-    stdin += str(fpath) + STDIN_NEWLINE
-    stdin += ("y" if parsed_args.save_images else "don't save images") + STDIN_NEWLINE
-    stdin += str(scene) + STDIN_NEWLINE
-    stdin += str(REJECTION_RATE) + STDIN_NEWLINE
-    stdin += intr + STDIN_NEWLINE
-    stdin += policy
-    if (policy_name == "Axis_Random"):
-        # Axis Random always takes five views before taking a random axis.
-        stdin += " --n-views 5 --n-repeat " + str(n_views / 5)
-    else:
-        stdin += " --n-views " + str(n_views)
-    stdin += " --seed "  + str(seed) + STDIN_NEWLINE
-
-    # Add data channels
-    stdin += f"--name probability  --type Probability  --d-min -{DIST} --d-max {DIST} --dtype float" + STDIN_NEWLINE
-    stdin += f"--name TSDF         --type TSDF         --d-min -{DIST} --d-max {DIST} --dtype float" + STDIN_NEWLINE
-    stdin +=  "--name binary       --type binary" + STDIN_NEWLINE
-
-    # Add metrics
-    stdin += STDIN_NEWLINE
-
-    proc = subprocess.Popen(executable=EXECUTABLE_PATH, args=[], text=True,
-                            stdin=subprocess.PIPE, stdout=subprocess.PIPE)
-    stdout = proc.communicate(stdin)
-    if parsed_args is not None and parsed_args.pause:
-        print(stdin)
-        print(stdout[0])
-        input("End of process...")
+def write_sweep_file(fpath: pathlib.Path) -> None:
+    """
+    Writes the sweep file describing every experiment for SweepExperiment.
+    """
+    lines = [f"output {fpath.parent}"]
+    lines += [f"scene {scene}" for scene in GROUND_TRUTH_FILES]
+    lines += [f"camera {intr[0]} {intr[1]}" for intr in INTRINSICS]
+    for name, policy, reruns in METHODS:
+        if name == "Axis_Random":
+            # Axis Random always takes five views before taking a random axis.
+            policy += " --views-per-repeat 5"
+        lines.append(f"policy {name} {reruns} {policy}")
+    lines.append(f"channel --name probability --type Probability --d-min -{DIST} --d-max {DIST} --dtype float")
+    lines.append(f"channel --name TSDF        --type TSDF        --d-min -{DIST} --d-max {DIST} --dtype float")
+    lines.append( "channel --name binary      --type binary")
+    lines.append("n-views " + " ".join(str(n) for n in N_VIEWS))
+    lines.append(f"reject-rate {REJECTION_RATE}")
+    if RANDOM_SEED:
+        lines.append("random-seed")
+    fpath.write_text("\n".join(lines) + "\n")
 
 
 def main(parsed_args: argparse.Namespace) -> None:
     """
     Program entry point.
     """
-    start = parsed_args.start_at
-    n = 0
-    N = len(INTRINSICS) * len(GROUND_TRUTH_FILES) * \
-        len(N_VIEWS) * sum([m[2] for m in METHODS])
-    print(f"Generating {N} experiments, beginning at experiment {start}...")
-
     fpath_base = PROJECT_ROOT_PATH / "share" / "Experiments" / "Results"
-    for intr in INTRINSICS:
-        for scene in GROUND_TRUTH_FILES:
-            for policy in METHODS:
-                for n_views in N_VIEWS:
-                    for rep in range(1, policy[2] + 1):
-                        n += 1
-                        if (n < start):
-                            continue
+    fpath_base.mkdir(parents=True, exist_ok=True)
 
-                        seed = random.randrange(1, 1e8) if RANDOM_SEED else rep
+    sweep_fpath = fpath_base / "sweep.txt"
+    write_sweep_file(sweep_fpath)
 
-                        fpath = pathlib.Path(intr[0], scene.name.removesuffix(HDF5_EXTENSION),
-                                             policy[0], str(n_views), str(rep))
-                        print(f"({n} / {N}) {fpath}")
-
-                        fpath = fpath_base / fpath
-                        if fpath.exists() is False:
-                            fpath.mkdir(parents=True)
-                        fpath /= "results" + HDF5_EXTENSION
-
-                        if fpath.exists() is True and parsed_args.no_override:
-                            print("\tAlready exists. Skipping experiment...")
-                            continue
-
-                        call_process(fpath, scene, intr[1], policy[0], policy[1], n_views, seed, parsed_args)
+    args = [str(EXECUTABLE_PATH), "--config", str(sweep_fpath), "--start-at", str(parsed_args.start_at)]
+    if parsed_args.no_override:
+        args.append("--no-override")
+    if parsed_args.n_workers > 0:
+        args += ["--n-workers", str(parsed_args.n_workers)]
+    if parsed_args.list:
+        args.append("--list")
+    subprocess.run(args, check=True)
 
 
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(
         prog='Sweep Run Experiment',
-        description='This script runs the Run Experiment script for a wide sweep of parameters.'
-    )
-    parser.add_argument(
-        "-p", "--pause",
-        action="store_true",
-        default=False,
-        help="Optionally pause after each experiment and display stdin/stdout."
+        description='This script runs the Sweep Experiment executable for a wide sweep of parameters.'
     )
     parser.add_argument(
         "--no-override",
@@ -213,10 +175,16 @@ if __name__ == "__main__":
         help="Start some number into the sweep."
     )
     parser.add_argument(
-        "--save-images",
+        "--n-workers",
+        type=int,
+        default=0,
+        help="Number of experiments to run at once. By default one for each hardware thread."
+    )
+    parser.add_argument(
+        "--list",
         action="store_true",
         default=False,
-        help="Saves images for each view."
+        help="Only list the experiments of the sweep."
     )
 
     args = parser.parse_args()
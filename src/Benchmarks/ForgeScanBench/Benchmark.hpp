@@ -0,0 +1,350 @@
+#ifndef FORGE_SCAN_BENCHMARKS_BENCHMARK_HPP
+#define FORGE_SCAN_BENCHMARKS_BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace forge_scan {
+namespace benchmarks {
+
+
+/// @brief Code timed by a benchmark.
+struct Case
+{
+    /// @brief Work done once per iteration, and timed.
+    std::function<void()> run;
+
+    /// @brief Optional work done before each iteration, and not timed. When this is set each
+    ///        iteration is timed on its own rather than timing a run of iterations together.
+    std::function<void()> prepare;
+
+    /// @brief Number of items, such as rays or pixels, processed by one iteration. Used to report a
+    ///        rate. Zero if the rate has no meaning.
+    double items_per_iteration = 0;
+
+    /// @brief Extra values reported with the result, such as the number of voxels in the Grid.
+    std::map<std::string, double> counters;
+};
+
+
+/// @brief Timing results of one benchmark.
+struct Result
+{
+    std::string name;
+
+    /// @brief Iterations in each repetition.
+    size_t iterations = 0;
+
+    /// @brief Per-iteration wall-clock time of each repetition, in nanoseconds.
+    std::vector<double> real_time;
+
+    /// @brief Per-iteration process CPU time of each repetition, in nanoseconds.
+    std::vector<double> cpu_time;
+
+    double items_per_iteration = 0;
+
+    std::map<std::string, double> counters;
+
+
+    static double mean(const std::vector<double>& x)
+    {
+        double sum = 0;
+        for (const auto& v : x)
+        {
+            sum += v;
+        }
+        return x.empty() ? 0 : sum / x.size();
+    }
+
+
+    static double median(std::vector<double> x)
+    {
+        if (x.empty())
+        {
+            return 0;
+        }
+        std::sort(x.begin(), x.end());
+        const size_t n = x.size() / 2;
+        return x.size() % 2 ? x[n] : 0.5 * (x[n - 1] + x[n]);
+    }
+
+
+    static double stddev(const std::vector<double>& x)
+    {
+        if (x.size() < 2)
+        {
+            return 0;
+        }
+        const double mu = Result::mean(x);
+        double sum = 0;
+        for (const auto& v : x)
+        {
+            sum += (v - mu) * (v - mu);
+        }
+        return std::sqrt(sum / (x.size() - 1));
+    }
+};
+
+
+/// @brief A minimal suite of benchmarks in the style of Google Benchmark.
+/// @details Each benchmark is registered with a function that sets up its data and returns the
+///          `Case` to time. Set up is deferred until the benchmark runs, so a filtered run only
+///          allocates the Grids it uses. The number of iterations is doubled until one repetition
+///          takes at least the minimum time, and then each repetition runs that many iterations.
+/// @note  Results are written in the JSON layout of Google Benchmark, so its `compare.py` tool may
+///        be used to compare runs across releases.
+class Suite
+{
+public:
+    using Setup = std::function<Case()>;
+
+
+    /// @brief Registers a benchmark.
+    /// @param name  Name of the benchmark. By convention this is `Family/param/param`.
+    /// @param setup Function creating the benchmark's data and returning the `Case` to time.
+    void add(const std::string& name, Setup setup)
+    {
+        this->benchmarks.emplace_back(name, std::move(setup));
+    }
+
+
+    /// @brief Lists the names of the registered benchmarks.
+    /// @param out Stream to write to.
+    void list(std::ostream& out) const
+    {
+        for (const auto& item : this->benchmarks)
+        {
+            out << item.first << "\n";
+        }
+    }
+
+
+    /// @brief Runs each registered benchmark whose name matches a filter.
+    /// @param filter  Regular expression searched for in each name.
+    /// @param min_time    Least time, in seconds, for each repetition.
+    /// @param repetitions Number of times to repeat each benchmark.
+    /// @param out Stream to report progress to.
+    /// @note  A benchmark whose set up throws, for example because a mesh file is missing, is
+    ///        reported and skipped.
+    void run(const std::string& filter, const double& min_time, const size_t& repetitions, std::ostream& out)
+    {
+        const std::regex re(filter);
+        out << std::left << std::setw(48) << "Benchmark" << std::right
+            << std::setw(14) << "Time [us]" << std::setw(14) << "CPU [us]"
+            << std::setw(12) << "Iterations" << std::setw(16) << "Items/s" << "\n"
+            << std::string(104, '-') << std::endl;
+
+        for (const auto& item : this->benchmarks)
+        {
+            if (!std::regex_search(item.first, re))
+            {
+                continue;
+            }
+
+            Case c;
+            try
+            {
+                c = item.second();
+            }
+            catch (const std::exception& e)
+            {
+                out << std::left << std::setw(48) << item.first << " SKIPPED: " << e.what() << std::endl;
+                continue;
+            }
+
+            Result result;
+            result.name = item.first;
+            result.items_per_iteration = c.items_per_iteration;
+            result.counters = c.counters;
+
+            // Warm up caches, and any lazily allocated buffers, before timing.
+            Suite::runIterations(c, 1);
+
+            size_t n = 1;
+            while (true)
+            {
+                const auto times = Suite::runIterations(c, n);
+                if (times.first >= min_time * 1e9 || n >= max_iterations)
+                {
+                    break;
+                }
+                const double scale = times.first > 0 ? 1.4 * min_time * 1e9 / times.first : 10.0;
+                n = std::min(max_iterations, std::max(n + 1, static_cast<size_t>(n * std::min(scale, 10.0))));
+            }
+            result.iterations = n;
+
+            for (size_t r = 0; r < repetitions; ++r)
+            {
+                const auto times = Suite::runIterations(c, n);
+                result.real_time.push_back(times.first  / n);
+                result.cpu_time.push_back(times.second / n);
+            }
+
+            const double real = Result::median(result.real_time);
+            out << std::left << std::setw(48) << result.name << std::right << std::fixed << std::setprecision(1)
+                << std::setw(14) << real * 1e-3
+                << std::setw(14) << Result::median(result.cpu_time) * 1e-3
+                << std::setw(12) << result.iterations;
+            if (result.items_per_iteration > 0 && real > 0)
+            {
+                out << std::setw(16) << std::scientific << std::setprecision(3)
+                    << result.items_per_iteration * 1e9 / real;
+            }
+            out << std::endl;
+            this->results.push_back(std::move(result));
+        }
+    }
+
+
+    /// @brief Writes the results in the JSON layout of Google Benchmark.
+    /// @param fpath Path to write to. Its extension is changed to `.json`.
+    /// @return The path written to.
+    /// @note  Each repetition is written as an iteration run, followed by mean, median and stddev
+    ///        aggregates when there is more than one repetition.
+    std::filesystem::path writeJSON(std::filesystem::path fpath) const
+    {
+        fpath.replace_extension(".json");
+        if (fpath.has_parent_path())
+        {
+            std::filesystem::create_directories(fpath.parent_path());
+        }
+        std::ofstream file(fpath);
+
+        const std::time_t now = std::time(nullptr);
+        char date[32];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        file << "{\n  \"context\": {\n"
+             << "    \"date\": \"" << date << "\",\n"
+             << "    \"executable\": \"ForgeScanBench\",\n"
+             << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+             << "    \"library_build_type\": \"release\"\n"
+#else
+             << "    \"library_build_type\": \"debug\"\n"
+#endif
+             << "  },\n  \"benchmarks\": [";
+
+        bool first = true;
+        auto write_entry = [&](const Result& result, const std::string& name, const std::string& run_type,
+                               const std::string& aggregate, const double& real, const double& cpu,
+                               const size_t& repetition_index)
+        {
+            file << (first ? "\n" : ",\n") << "    {\n"
+                 << "      \"name\": \"" << name << "\",\n"
+                 << "      \"run_name\": \"" << result.name << "\",\n"
+                 << "      \"run_type\": \"" << run_type << "\",\n";
+            if (aggregate.empty())
+            {
+                file << "      \"repetition_index\": " << repetition_index << ",\n";
+            }
+            else
+            {
+                file << "      \"aggregate_name\": \"" << aggregate << "\",\n";
+            }
+            file << "      \"repetitions\": " << result.real_time.size() << ",\n"
+                 << "      \"iterations\": " << result.iterations << ",\n"
+                 << std::setprecision(6) << std::defaultfloat
+                 << "      \"real_time\": " << real << ",\n"
+                 << "      \"cpu_time\": "  << cpu  << ",\n"
+                 << "      \"time_unit\": \"ns\"";
+            if (result.items_per_iteration > 0 && real > 0 && aggregate != "stddev")
+            {
+                file << ",\n      \"items_per_second\": " << result.items_per_iteration * 1e9 / real;
+            }
+            for (const auto& counter : result.counters)
+            {
+                file << ",\n      \"" << counter.first << "\": " << counter.second;
+            }
+            file << "\n    }";
+            first = false;
+        };
+
+        for (const auto& result : this->results)
+        {
+            for (size_t r = 0; r < result.real_time.size(); ++r)
+            {
+                write_entry(result, result.name, "iteration", "", result.real_time[r], result.cpu_time[r], r);
+            }
+            if (result.real_time.size() > 1)
+            {
+                write_entry(result, result.name + "_mean", "aggregate", "mean",
+                            Result::mean(result.real_time), Result::mean(result.cpu_time), 0);
+                write_entry(result, result.name + "_median", "aggregate", "median",
+                            Result::median(result.real_time), Result::median(result.cpu_time), 0);
+                write_entry(result, result.name + "_stddev", "aggregate", "stddev",
+                            Result::stddev(result.real_time), Result::stddev(result.cpu_time), 0);
+            }
+        }
+        file << "\n  ]\n}\n";
+        return fpath;
+    }
+
+
+    /// @brief Largest number of iterations in a repetition.
+    static constexpr size_t max_iterations = 1'000'000'000;
+
+
+private:
+    /// @brief Runs iterations of a benchmark.
+    /// @param c Benchmark to run.
+    /// @param n Number of iterations.
+    /// @return Total wall-clock and process CPU time of the timed work, in nanoseconds.
+    static std::pair<double, double> runIterations(const Case& c, const size_t& n)
+    {
+        using clock = std::chrono::steady_clock;
+        double real = 0, cpu = 0;
+        if (c.prepare)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                c.prepare();
+                const std::clock_t cpu_start = std::clock();
+                const auto start = clock::now();
+                c.run();
+                real += std::chrono::duration<double, std::nano>(clock::now() - start).count();
+                cpu  += 1e9 * static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+            }
+        }
+        else
+        {
+            const std::clock_t cpu_start = std::clock();
+            const auto start = clock::now();
+            for (size_t i = 0; i < n; ++i)
+            {
+                c.run();
+            }
+            real = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            cpu  = 1e9 * static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+        }
+        return {real, cpu};
+    }
+
+
+    /// @brief Registered benchmarks and their set up functions, in order.
+    std::vector<std::pair<std::string, Setup>> benchmarks;
+
+    /// @brief Results of each benchmark which has been run.
+    std::vector<Result> results;
+};
+
+
+} // namespace benchmarks
+} // namespace forge_scan
+
+
+#endif // FORGE_SCAN_BENCHMARKS_BENCHMARK_HPP
@@ -0,0 +1,547 @@
+#include "ForgeScan/Common/RayTrace.hpp"
+#include "ForgeScan/Common/TraceBatch.hpp"
+#include "ForgeScan/Data/Reconstruction.hpp"
+#include "ForgeScan/Data/VoxelGrids/Binary.hpp"
+#include "ForgeScan/Data/VoxelGrids/Constructor.hpp"
+#include "ForgeScan/Metrics/OccupancyConfusion.hpp"
+#include "ForgeScan/Sensor/Camera.hpp"
+#include "ForgeScan/Simulation/Scene.hpp"
+#include "ForgeScan/Utilities/Profiler.hpp"
+#include "ForgeScan/Utilities/Random.hpp"
+
+#include "Benchmark.hpp"
+
+
+/// @brief Microbenchmarks for the hot paths of a reconstruction: ray tracing, VoxelGrid updates,
+///        depth image deprojection, scene imaging, occplane updates and occupancy metrics.
+/// @details Accepts the arguments:
+///              [--filter <regex>] [--list] [--min-time <seconds>] [--repetitions <n>]
+///              [--sizes <n,n,...>] [--resolution <voxel size>] [--sparse] [--brick-size <n>]
+///              [--n-rays <rays per iteration>] [--n-threads <n>] [--seed <seed>]
+///              [--out <results.json>]
+///          Each Grid size `n` benchmarks an `n` by `n` by `n` Grid. Results are printed and then
+///          written to the output file in the JSON layout of Google Benchmark.
+/// @note  When built with `FORGE_SCAN_PROFILING` heap allocations are counted, and the
+///        `Reconstruction::update` benchmarks report the allocations made by each update once its
+///        buffers have been warmed up.
+
+
+FS_PROFILE_DEFINE_ALLOCATION_HOOKS()
+
+
+using namespace forge_scan;
+
+
+/// @brief Options shared by each benchmark.
+struct Options
+{
+    float  resolution;
+    bool   sparse;
+    size_t brick_size;
+    size_t n_rays;
+    size_t n_threads;
+    int    seed;
+};
+
+
+/// @brief Rays with a start and an end point each.
+struct Rays
+{
+    PointMatrix sensed, origin;
+};
+
+
+/// @brief Parses a comma-separated list of Grid sizes.
+/// @param list String to parse.
+/// @return Each positive size in the list.
+std::vector<size_t> parse_sizes(const std::string& list)
+{
+    std::vector<size_t> sizes;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        const int n = std::atoi(item.c_str());
+        if (n > 0)
+        {
+            sizes.push_back(static_cast<size_t>(n));
+        }
+    }
+    return sizes;
+}
+
+
+/// @brief Creates cubic Grid Properties for one benchmarked size.
+std::shared_ptr<const Grid::Properties> make_properties(const Options& options, const size_t& n)
+{
+    return Grid::Properties::createConst(options.resolution, GridSize(n, n, n), options.sparse, options.brick_size);
+}
+
+
+/// @brief Generates rays with sensed points within the central half of the Grid.
+/// @param properties Grid Properties to generate the rays in.
+/// @param direction  Distribution of ray directions: "axis" for directions along the X, Y or Z axes,
+///                   "diagonal" for directions along the diagonals of a voxel, or "random" for
+///                   uniformly random directions.
+/// @param length  Length of each ray, relative to the largest dimension of the Grid.
+/// @param n_rays  Number of rays.
+/// @param seed    Random seed.
+/// @return The generated rays.
+Rays make_rays(const std::shared_ptr<const Grid::Properties>& properties, const std::string& direction,
+               const float& length, const size_t& n_rays, const int& seed)
+{
+    utilities::RandomSampler<float> rand_sample(seed);
+    const Point lower = 0.25 * properties->dimensions;
+    const float ray_length = length * properties->dimensions.maxCoeff();
+
+    Rays rays{PointMatrix(3, n_rays), PointMatrix(3, n_rays)};
+    for (size_t i = 0; i < n_rays; ++i)
+    {
+        const Point sensed = lower + Point(rand_sample.uniform(0.5f * properties->dimensions.x()),
+                                           rand_sample.uniform(0.5f * properties->dimensions.y()),
+                                           rand_sample.uniform(0.5f * properties->dimensions.z()));
+        Ray dir = Ray::Zero();
+        if (direction == "axis")
+        {
+            dir[static_cast<size_t>(rand_sample.uniform(3.0f)) % 3] = rand_sample.uniform() < 0.5 ? -1 : 1;
+        }
+        else if (direction == "diagonal")
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                dir[k] = rand_sample.uniform() < 0.5 ? -1 : 1;
+            }
+            dir.normalize();
+        }
+        else
+        {
+            float theta, phi;
+            rand_sample.sphere(theta, phi);
+            dir = Ray(std::sin(phi) * std::cos(theta), std::sin(phi) * std::sin(theta), std::cos(phi));
+        }
+        rays.sensed.col(i) = sensed;
+        rays.origin.col(i) = sensed + ray_length * dir;
+    }
+    return rays;
+}
+
+
+/// @brief Generates the points a camera would sense looking at a sphere in the center of the Grid.
+/// @param properties Grid Properties to generate the points in.
+/// @param origin  Position of the camera.
+/// @param n_rays  Number of points.
+/// @param seed    Random seed.
+/// @return Points on the half of the sphere facing the camera.
+PointMatrix make_view(const std::shared_ptr<const Grid::Properties>& properties, const Point& origin,
+                      const size_t& n_rays, const int& seed)
+{
+    utilities::RandomSampler<float> rand_sample(seed);
+    const Point center = properties->getCenter();
+    const float radius = 0.3f * properties->dimensions.minCoeff();
+    const Ray   facing = (origin - center).normalized();
+
+    PointMatrix sensed(3, n_rays);
+    for (auto col : sensed.colwise())
+    {
+        float theta, phi;
+        rand_sample.sphere(theta, phi);
+        Ray normal(std::sin(phi) * std::cos(theta), std::sin(phi) * std::sin(theta), std::cos(phi));
+        if (normal.dot(facing) < 0)
+        {
+            normal = -normal;
+        }
+        col = center + radius * normal;
+    }
+    return sensed;
+}
+
+
+/// @brief Places camera origins around the Grid, each looking at its center.
+/// @param properties Grid Properties to place the origins around.
+/// @param n_views Number of origins.
+/// @param seed    Random seed.
+/// @return The origins.
+std::vector<Point> make_origins(const std::shared_ptr<const Grid::Properties>& properties,
+                                const size_t& n_views, const int& seed)
+{
+    utilities::RandomSampler<float> rand_sample(seed);
+    const float distance = properties->dimensions.maxCoeff();
+    std::vector<Point> origins;
+    for (size_t i = 0; i < n_views; ++i)
+    {
+        float theta, phi;
+        rand_sample.sphere(theta, phi);
+        origins.push_back(properties->getCenter() +
+                          distance * Point(std::sin(phi) * std::cos(theta), std::sin(phi) * std::sin(theta), std::cos(phi)));
+    }
+    return origins;
+}
+
+
+/// @brief Exposes the update of an OccupancyConfusion Metric so it may be timed alone.
+struct BenchmarkOccupancyConfusion : public metrics::OccupancyConfusion
+{
+    BenchmarkOccupancyConfusion(const std::shared_ptr<data::Reconstruction>& reconstruction,
+                                const std::shared_ptr<const metrics::ground_truth::Occupancy>& ground_truth,
+                                const std::string& use_channel)
+        : OccupancyConfusion(reconstruction, ground_truth, use_channel)
+    {
+
+    }
+
+    using OccupancyConfusion::postUpdate;
+};
+
+
+/// @brief Number of views cycled through by benchmarks which need fresh data for each iteration.
+static constexpr size_t n_views = 16;
+
+
+
+// ********************************************************************************************* //
+// *                                  BENCHMARK REGISTRATION                                   * //
+// ********************************************************************************************* //
+
+
+/// @brief Registers `get_ray_trace` over distributions of ray length and direction.
+void add_ray_trace(benchmarks::Suite& suite, const Options& options, const size_t& n)
+{
+    static const std::vector<std::pair<std::string, float>> lengths = { {"short", 0.1f}, {"long", 2.0f} };
+    for (const std::string direction : {"axis", "diagonal", "random"})
+    {
+        for (const auto& length : lengths)
+        {
+            const std::string name = "get_ray_trace/" + direction + "/" + length.first + "/" + std::to_string(n);
+            suite.add(name, [=]()
+            {
+                auto properties = make_properties(options, n);
+                auto rays  = std::make_shared<Rays>(make_rays(properties, direction, length.second, options.n_rays, options.seed));
+                auto trace = std::make_shared<Trace>();
+                auto n_voxels = std::make_shared<size_t>(0);
+
+                benchmarks::Case c;
+                c.run = [=]()
+                {
+                    for (Eigen::Index i = 0; i < rays->sensed.cols(); ++i)
+                    {
+                        get_ray_trace(trace, rays->sensed.col(i), rays->origin.col(i), properties, -0.2f, INFINITY);
+                        *n_voxels += trace->size();
+                    }
+                };
+                c.run();
+                c.items_per_iteration = static_cast<double>(options.n_rays);
+                c.counters["voxels_per_ray"] = static_cast<double>(*n_voxels) / options.n_rays;
+                return c;
+            });
+        }
+    }
+}
+
+
+/// @brief Registers `get_ray_trace_batch` for a camera view, tracing either the whole ray or only
+///        the truncated distance around each sensed point that a TSDF would.
+void add_ray_trace_batch(benchmarks::Suite& suite, const Options& options, const size_t& n)
+{
+    static const std::vector<std::pair<std::string, float>> lengths = { {"truncated", 0.2f}, {"full", INFINITY} };
+    for (const auto& length : lengths)
+    {
+        suite.add("get_ray_trace_batch/" + length.first + "/" + std::to_string(n), [=]()
+        {
+            auto properties = make_properties(options, n);
+            auto origin = make_origins(properties, 1, options.seed).front();
+            auto sensed = std::make_shared<PointMatrix>(make_view(properties, origin, options.n_rays, options.seed));
+            auto batch  = std::make_shared<TraceBatch>();
+
+            benchmarks::Case c;
+            c.run = [=]()
+            {
+                batch->clear();
+                get_ray_trace_batch(batch, *sensed, origin, properties, -0.2f, length.second, 0, options.n_rays);
+            };
+            c.run();
+            c.items_per_iteration = static_cast<double>(options.n_rays);
+            c.counters["voxels_per_ray"] = static_cast<double>(batch->numVoxels()) / options.n_rays;
+            return c;
+        });
+    }
+}
+
+
+/// @brief Registers the batch `VoxelGrid::update` of each VoxelGrid type.
+void add_voxel_grid_update(benchmarks::Suite& suite, const Options& options, const size_t& n)
+{
+    for (const std::string& type : {data::Binary::type_name,       data::BinaryTSDF::type_name,
+                                    data::CountUpdates::type_name, data::CountViews::type_name,
+                                    data::Probability::type_name,  data::TSDF::type_name})
+    {
+        suite.add("VoxelGrid::update/" + type + "/" + std::to_string(n), [=]()
+        {
+            auto properties = make_properties(options, n);
+            auto grid   = data::Constructor::create(utilities::ArgParser("--type " + type), properties);
+            auto origin = make_origins(properties, 1, options.seed).front();
+            auto batch  = std::make_shared<TraceBatch>();
+            get_ray_trace_batch(batch, make_view(properties, origin, options.n_rays, options.seed), origin,
+                                properties, grid->dist_min, grid->dist_max, 0, options.n_rays);
+
+            benchmarks::Case c;
+            c.run = [=]() { grid->update(batch); };
+            c.items_per_iteration = static_cast<double>(batch->numRays());
+            c.counters["voxels"] = static_cast<double>(batch->numVoxels());
+            return c;
+        });
+    }
+
+    suite.add("Reconstruction::update/" + std::to_string(n), [=]()
+    {
+        auto properties = make_properties(options, n);
+        auto reconstruction = data::Reconstruction::create(properties);
+        reconstruction->setNumThreads(options.n_threads);
+        reconstruction->addChannel(utilities::ArgParser("--name tsdf   --type TSDF"));
+        reconstruction->addChannel(utilities::ArgParser("--name binary --type Binary"));
+        auto origin = make_origins(properties, 1, options.seed).front();
+        auto sensed = std::make_shared<PointMatrix>(make_view(properties, origin, options.n_rays, options.seed));
+
+        benchmarks::Case c;
+        c.run = [=]() { reconstruction->update(*sensed, origin); };
+        c.items_per_iteration = static_cast<double>(options.n_rays);
+#ifdef FORGE_SCAN_PROFILING
+        // The first updates size the scratch buffers. Later updates should reuse them.
+        static constexpr size_t n_warm_up = 2, n_counted = 4;
+        for (size_t i = 0; i < n_warm_up; ++i)
+        {
+            c.run();
+        }
+        auto& profiler = utilities::Profiler::instance();
+        profiler.reset();
+        for (size_t i = 0; i < n_counted; ++i)
+        {
+            c.run();
+        }
+        profiler.record(0);
+        c.counters["allocations_per_update"] = static_cast<double>(
+            profiler.getRecords().back().counters[utilities::Profiler::HEAP_ALLOCATIONS]) / n_counted;
+        profiler.reset();
+#endif
+        return c;
+    });
+}
+
+
+/// @brief Registers `Camera::getPointMatrix` and `Scene::image` for common image sizes.
+void add_sensor(benchmarks::Suite& suite, const Options& options)
+{
+    static const std::vector<std::pair<size_t, size_t>> image_sizes = { {640, 480}, {1280, 720} };
+    for (const auto& image_size : image_sizes)
+    {
+        const std::string size_name = std::to_string(image_size.first) + "x" + std::to_string(image_size.second);
+        auto make_camera = [=]()
+        {
+            auto intr = sensor::Intrinsics::create(image_size.first, image_size.second, 0.1f, 10.0f, 87.0f, 58.0f);
+            auto camera = sensor::Camera::create(intr, 0.0f, static_cast<float>(options.seed));
+            Extrinsic extr = Extrinsic::Identity();
+            extr.translation() = Point(0, 0, -2);
+            camera->setExtr(extr);
+            return camera;
+        };
+
+        suite.add("Camera::getPointMatrix/" + size_name, [=]()
+        {
+            auto camera = make_camera();
+            camera->image.setConstant(1.0f);
+            auto dest = std::make_shared<PointMatrix>();
+
+            benchmarks::Case c;
+            c.run = [=]() { camera->getPointMatrix(*dest, camera->getExtr()); };
+            c.items_per_iteration = static_cast<double>(image_size.first * image_size.second);
+            return c;
+        });
+
+        suite.add("Scene::image/" + size_name, [=]()
+        {
+            auto camera = make_camera();
+            auto scene  = simulation::Scene::create();
+            scene->add("--file abc2.stl --x -0.5 --scale  5.0");
+            scene->add("--file abc3.stl --y -0.5 --scale 25.0");
+            scene->add("--file abc4.stl --z  0.5 --scale  8.0");
+
+            benchmarks::Case c;
+            c.run = [=]() { scene->image(camera); };
+            c.items_per_iteration = static_cast<double>(image_size.first * image_size.second);
+            return c;
+        });
+    }
+}
+
+
+/// @brief Registers the incremental and full occplane updates of a Binary VoxelGrid.
+void add_occplanes(benchmarks::Suite& suite, const Options& options, const size_t& n)
+{
+    auto make_binary = [=](const bool& prepare_views)
+    {
+        auto properties = make_properties(options, n);
+        auto binary  = data::Binary::create(properties);
+        auto origins = make_origins(properties, n_views, options.seed);
+        auto batches = std::make_shared<std::vector<std::shared_ptr<TraceBatch>>>();
+        for (size_t v = 0; v < (prepare_views ? n_views : 1); ++v)
+        {
+            batches->push_back(std::make_shared<TraceBatch>());
+            get_ray_trace_batch(batches->back(), make_view(properties, origins[v], options.n_rays, options.seed + v),
+                                origins[v], properties, binary->dist_min, binary->dist_max, 0, options.n_rays);
+        }
+        binary->update(batches->front());
+        binary->recomputeOccplanes();
+        return std::make_pair(binary, batches);
+    };
+
+    suite.add("Binary::updateOccplanes/" + std::to_string(n), [=]()
+    {
+        auto made = make_binary(true);
+        auto view = std::make_shared<size_t>(0);
+
+        benchmarks::Case c;
+        c.prepare = [=]()
+        {
+            *view = (*view + 1) % n_views;
+            made.first->update(made.second->at(*view));
+        };
+        c.run = [=]() { made.first->updateOccplanes(); };
+        return c;
+    });
+
+    suite.add("Binary::recomputeOccplanes/" + std::to_string(n), [=]()
+    {
+        auto made = make_binary(false);
+
+        benchmarks::Case c;
+        c.run = [=]() { made.first->recomputeOccplanes(); };
+        c.items_per_iteration = static_cast<double>(made.first->properties->getNumVoxels());
+        return c;
+    });
+}
+
+
+/// @brief Registers the full and incremental `OccupancyConfusion::postUpdate`.
+void add_occupancy_confusion(benchmarks::Suite& suite, const Options& options, const size_t& n)
+{
+    auto make_metric = [=]()
+    {
+        auto properties = make_properties(options, n);
+        auto reconstruction = data::Reconstruction::create(properties);
+        reconstruction->setNumThreads(options.n_threads);
+        reconstruction->addChannel(utilities::ArgParser("--name binary --type Binary"));
+
+        // The ground truth is a sphere in the center of the Grid, which is what the views sense.
+        std::vector<uint8_t> truth(properties->getNumVoxels());
+        const Point center = properties->getCenter();
+        const float radius = 0.3f * properties->dimensions.minCoeff();
+        for (size_t i = 0; i < truth.size(); ++i)
+        {
+            const Point p = properties->resolution * properties->vectorToIndex(i).cast<float>();
+            truth[i] = (p - center).norm() < radius ? VoxelOccupancy::OCCUPIED : VoxelOccupancy::FREE;
+        }
+        auto ground_truth = metrics::ground_truth::Occupancy::create(properties, truth);
+        auto metric = std::make_shared<BenchmarkOccupancyConfusion>(reconstruction, ground_truth, "binary");
+
+        auto origins = std::make_shared<std::vector<Point>>(make_origins(properties, n_views, options.seed));
+        auto views   = std::make_shared<std::vector<PointMatrix>>();
+        for (size_t v = 0; v < n_views; ++v)
+        {
+            views->push_back(make_view(properties, origins->at(v), options.n_rays, options.seed + v));
+        }
+        reconstruction->update(views->front(), origins->front());
+        return std::make_tuple(reconstruction, metric, origins, views);
+    };
+
+    suite.add("OccupancyConfusion::postUpdate/full/" + std::to_string(n), [=]()
+    {
+        auto made = make_metric();
+        auto metric = std::get<1>(made);
+
+        // Without a new update between calls each compares the whole Grid.
+        benchmarks::Case c;
+        c.run = [=]() { metric->postUpdate(1); };
+        c.items_per_iteration = static_cast<double>(std::get<0>(made)->grid_properties->getNumVoxels());
+        return c;
+    });
+
+    suite.add("OccupancyConfusion::postUpdate/incremental/" + std::to_string(n), [=]()
+    {
+        auto made = make_metric();
+        auto reconstruction = std::get<0>(made);
+        auto metric = std::get<1>(made);
+        auto origins = std::get<2>(made);
+        auto views   = std::get<3>(made);
+        auto view    = std::make_shared<size_t>(0);
+        metric->postUpdate(0);
+
+        // One update between calls, so each compares only the voxels it changed.
+        benchmarks::Case c;
+        c.prepare = [=]()
+        {
+            *view = (*view + 1) % n_views;
+            reconstruction->update(views->at(*view), origins->at(*view));
+        };
+        c.run = [=]() { metric->postUpdate(1); };
+        return c;
+    });
+}
+
+
+
+// ********************************************************************************************* //
+// *                                           MAIN                                            * //
+// ********************************************************************************************* //
+
+
+int main(const int argc, const char **argv)
+{
+    utilities::ArgParser parser(argc, argv);
+
+    Options options;
+    options.resolution = parser.get<float>("--resolution", 0.02f);
+    options.sparse     = parser.has("--sparse");
+    options.brick_size = static_cast<size_t>(std::max(parser.get<int>("--brick-size", 1),      1));
+    options.n_rays     = static_cast<size_t>(std::max(parser.get<int>("--n-rays",     10000),  1));
+    options.n_threads  = static_cast<size_t>(std::max(parser.get<int>("--n-threads",  1),      0));
+    options.seed       = parser.get<int>("--seed", 50);
+
+    const std::vector<size_t> sizes = parse_sizes(parser.get<std::string>("--sizes", "64,128"));
+    const std::string filter  = parser.get<std::string>("--filter", ".*");
+    const double min_time     = std::max(parser.get<double>("--min-time", 0.5), 0.0);
+    const size_t repetitions  = static_cast<size_t>(std::max(parser.get<int>("--repetitions", 3), 1));
+    const std::filesystem::path out_fpath = parser.get<std::filesystem::path>("--out", "ForgeScanBench.json");
+
+    benchmarks::Suite suite;
+    for (const auto& n : sizes)
+    {
+        add_ray_trace(suite, options, n);
+    }
+    for (const auto& n : sizes)
+    {
+        add_ray_trace_batch(suite, options, n);
+    }
+    for (const auto& n : sizes)
+    {
+        add_voxel_grid_update(suite, options, n);
+    }
+    add_sensor(suite, options);
+    for (const auto& n : sizes)
+    {
+        add_occplanes(suite, options, n);
+    }
+    for (const auto& n : sizes)
+    {
+        add_occupancy_confusion(suite, options, n);
+    }
+
+    if (parser.has("--list"))
+    {
+        suite.list(std::cout);
+        return 0;
+    }
+
+    suite.run(filter, min_time, repetitions, std::cout);
+    std::cout << "\nWrote results to " << suite.writeJSON(out_fpath) << std::endl;
+
+    return 0;
+}
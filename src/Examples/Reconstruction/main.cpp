@@ -90,7 +90,6 @@ int main(const int argc, const char **argv)
     forge_scan::utilities::RandomSampler<float> rand_sample;
     forge_scan::utilities::Timer timer;
 
-    forge_scan::PointMatrix sensed_points;
     size_t n = 0;
 
     timer.start();
@@ -116,8 +115,7 @@ int main(const int argc, const char **argv)
                 forge_scan::sensor::DepthImageProcessing::imwrite(camera, image_fpath);
             }
 
-            camera->getPointMatrix(sensed_points);
-            manager->reconstructionUpdate(sensed_points, camera->getExtr());
+            manager->reconstructionUpdate(camera);
 
             std::cout << "Added view: " << n++ << std::endl;
         }
@@ -0,0 +1,126 @@
+#include "ForgeScan/Data/Reconstruction.hpp"
+#include "ForgeScan/Data/VoxelGrids/Binary.hpp"
+#include "ForgeScan/Utilities/Random.hpp"
+#include "ForgeScan/Utilities/Timer.hpp"
+
+
+/// @brief Benchmarks the VoxelGrid data layouts available through `Grid::Properties::brick_size`.
+/// @details For each brick size a Reconstruction with TSDF and Binary channels is updated with rays
+///          cast towards the Grid along the X, Y and Z axes, and then the Binary channel's occplanes
+///          are found. The time for each part is reported relative to the linear layout.
+///          Accepts the Grid Properties arguments (excluding `--brick-size`) along with:
+///              [--n-rays <rays per update>] [--n-repeat <updates per axis>] [--seed <seed>]
+
+
+/// @brief Timing results for one layout.
+struct LayoutResult
+{
+    size_t brick_size;
+    double update_x, update_y, update_z, occplane;
+};
+
+
+/// @brief Generates rays ending at random points within the central region of the Grid.
+/// @param [out] sensed_points Matrix of points to fill.
+/// @param properties Grid Properties to generate the points in.
+/// @param rand_sample Random sampler to use.
+void fill_sensed_points(forge_scan::PointMatrix& sensed_points,
+                        const std::shared_ptr<const forge_scan::Grid::Properties>& properties,
+                        forge_scan::utilities::RandomSampler<float>& rand_sample)
+{
+    const forge_scan::Point lower = 0.25 * properties->dimensions;
+    for (auto col : sensed_points.colwise())
+    {
+        col = lower + forge_scan::Point(rand_sample.uniform(0.5f * properties->dimensions.x()),
+                                        rand_sample.uniform(0.5f * properties->dimensions.y()),
+                                        rand_sample.uniform(0.5f * properties->dimensions.z()));
+    }
+}
+
+
+/// @brief Runs the benchmark for one layout.
+/// @param parsed Grid Properties parsed from the user's arguments.
+/// @param brick_size Brick size to benchmark.
+/// @param n_rays Number of rays in each update.
+/// @param n_repeat Number of updates along each axis.
+/// @param seed Random seed. Each layout uses the same seed and sees the same rays.
+/// @return Timing results, in milliseconds.
+LayoutResult run_layout(const forge_scan::Grid::Properties& parsed, const size_t& brick_size,
+                        const size_t& n_rays, const size_t& n_repeat, const int& seed)
+{
+    auto properties = forge_scan::Grid::Properties::createConst(parsed.resolution, parsed.size,
+                                                                parsed.sparse, brick_size);
+
+    auto reconstruction = forge_scan::data::Reconstruction::create(properties);
+    reconstruction->addChannel(forge_scan::utilities::ArgParser("--name tsdf   --type TSDF"));
+    reconstruction->addChannel(forge_scan::utilities::ArgParser("--name binary --type Binary --no-occplane"));
+    auto binary = std::dynamic_pointer_cast<forge_scan::data::Binary>(reconstruction->getChannelRef("binary"));
+
+    forge_scan::utilities::RandomSampler<float> rand_sample(seed);
+    forge_scan::utilities::Timer timer;
+    forge_scan::PointMatrix sensed_points(3, n_rays);
+
+    // Origins lie outside the Grid along each axis so the rays mostly travel along that axis.
+    const forge_scan::Point center = properties->getCenter();
+    const float offset = 2.0f * properties->dimensions.maxCoeff();
+    const forge_scan::Point origins[3] = { center + forge_scan::Point(offset, 0, 0),
+                                           center + forge_scan::Point(0, offset, 0),
+                                           center + forge_scan::Point(0, 0, offset) };
+
+    double update_ms[3] = {0, 0, 0};
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        for (size_t n = 0; n < n_repeat; ++n)
+        {
+            fill_sensed_points(sensed_points, properties, rand_sample);
+            timer.start();
+            reconstruction->update(sensed_points, origins[axis]);
+            timer.stop();
+            update_ms[axis] += timer.elapsedMicroseconds() * 1e-3;
+        }
+    }
+
+    timer.start();
+    for (size_t n = 0; n < n_repeat; ++n)
+    {
+        binary->recomputeOccplanes();
+    }
+    timer.stop();
+
+    return LayoutResult{properties->brick_size, update_ms[0], update_ms[1], update_ms[2],
+                        timer.elapsedMicroseconds() * 1e-3};
+}
+
+
+int main(const int argc, const char **argv)
+{
+    forge_scan::utilities::ArgParser parser(argc, argv);
+    const forge_scan::Grid::Properties parsed(parser);
+    const size_t n_rays   = std::max(parser.get<int>("--n-rays",   100000), 1);
+    const size_t n_repeat = std::max(parser.get<int>("--n-repeat", 5),      1);
+    const int    seed     = parser.get<int>("--seed", 50);
+
+    std::cout << "Benchmarking data layouts for " << parsed << "\n"
+              << "Each axis is updated " << n_repeat << " times with " << n_rays << " rays.\n" << std::endl;
+
+    std::vector<LayoutResult> results;
+    for (const size_t brick_size : {1, 4, 8, 16})
+    {
+        results.push_back(run_layout(parsed, brick_size, n_rays, n_repeat, seed));
+    }
+
+    const LayoutResult& linear = results.front();
+    std::cout << std::fixed << std::setprecision(1)
+              << "brick\tupdate X [ms]\tupdate Y [ms]\tupdate Z [ms]\toccplanes [ms]\n";
+    for (const auto& result : results)
+    {
+        std::cout << result.brick_size
+                  << "\t" << result.update_x << " (" << result.update_x / linear.update_x << "x)"
+                  << "\t" << result.update_y << " (" << result.update_y / linear.update_y << "x)"
+                  << "\t" << result.update_z << " (" << result.update_z / linear.update_z << "x)"
+                  << "\t" << result.occplane << " (" << result.occplane / linear.occplane << "x)\n";
+    }
+    std::cout << std::endl;
+
+    return 0;
+}
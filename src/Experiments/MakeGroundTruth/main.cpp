@@ -91,6 +91,31 @@ inline void add_shapes(forge_scan::utilities::ArgParser& parser,
 }
 
 
+/// @brief Helper to get the chunking and compression for the saved HDF5 data sets.
+/// @param [out] parser ArgParser to use. On return this is set to the arguments used for the options.
+/// @return Options for the saved data sets.
+inline forge_scan::utilities::DataSetOptions get_dataset_options(forge_scan::utilities::ArgParser& parser)
+{
+    while (true)
+    {
+        parser.getInput("\nPlease specify HDF5 compression [-h for help or ENTER for none]:");
+        if (parser[0] != "-h")
+        {
+            try
+            {
+                return forge_scan::utilities::DataSetOptions(parser);
+            }
+            catch (const std::invalid_argument& e)
+            {
+                std::cerr << e.what() << '\n';
+                continue;
+            }
+        }
+        std::cout << "\n" << forge_scan::utilities::DataSetOptions::helpMessage() << std::endl;
+    }
+}
+
+
 int main()
 {
     forge_scan::Extrinsic grid_lower_bound;
@@ -100,6 +125,9 @@ int main()
     parser.getInput("Enter file path for this ground truth data:");
     std::filesystem::path fpath = parser.get<std::string>(0, default_file_path);
 
+    // The file doubles as a cache of finished tiles, so resolve its name once.
+    forge_scan::utilities::validateAndCreateFilepath(fpath, FS_HDF5_FILE_EXTENSION, "GroundTruth", false);
+
 
     // ************************************** SETUP SCENE ************************************** //
 
@@ -109,6 +137,7 @@ int main()
 
     auto scene = forge_scan::simulation::GroundTruthScene::create(grid_lower_bound, properties);
     add_shapes(parser, scene);
+    scene->dataset_options = get_dataset_options(parser);
 
 
     // ************************************* GENERATE DATA ************************************* //
@@ -116,8 +145,8 @@ int main()
     parser.getInput("\nGenerate ground truth occupancy? [y/n]:");
     if (parser[0] == "y")
     {
-        std::cout << "\n\tGenerating occupancy... ";
-        scene->calculateGroundTruthOccupancy();
+        std::cout << "\n\tGenerating occupancy, reusing any finished tiles from the file... ";
+        scene->calculateGroundTruthOccupancy(fpath);
         std::cout << "Done!" << std::endl;
     }
     else
@@ -128,8 +157,8 @@ int main()
     parser.getInput("\nGenerate ground truth TSDF? [y/n]:");
     if (parser[0] == "y")
     {
-        std::cout << "\n\tGenerating TSDF... ";
-        scene->calculateGroundTruthTSDF();
+        std::cout << "\n\tGenerating TSDF, reusing any finished tiles from the file... ";
+        scene->calculateGroundTruthTSDF(fpath);
         std::cout << "Done!" << std::endl;
     }
     else
@@ -127,9 +127,11 @@ int main()
     parser.getInput("\nPlease enter alpha: ");
     float alpha = parser.get<float>(0, 0.5);
 
-    auto policy = forge_scan::policies::Normal::create(reconstruction, intr, grid_lower_bound, radius, min_similarity, sample, store, alpha);
+    auto scene = forge_scan::simulation::Scene::create();
+    add_shapes(parser, scene);
 
-    add_shapes(parser, policy);
+    auto policy = forge_scan::policies::Normal::create(reconstruction, scene->getGeometry(), intr, grid_lower_bound,
+                                                       radius, min_similarity, sample, store, alpha);
 
 
     // ************************************* GENERATE DATA ************************************* //
@@ -0,0 +1,164 @@
+#include "ForgeScan/Manager.hpp"
+#include "ForgeScan/Simulation/GroundTruthScene.hpp"
+
+#include "ForgeScan/Sensor/ViewLog.hpp"
+#include "ForgeScan/Utilities/Timer.hpp"
+
+
+/// @brief Re-integrates the views recorded by RunExperiment into several channel configurations.
+/// @details Each configuration is its own Manager, with its own Data Channels and the ground truth
+///          OccupancyConfusion Metric for each of them. Every recorded view is deprojected once, and
+///          traced once for each distinct distance range and endpoint merging of the configurations.
+///          The traces are applied to all configurations which share them. This is much faster than
+///          running RunExperiment once for each configuration, and every configuration sees the same
+///          images.
+
+
+/// @brief Helper to add Data Channels, each with an OccupancyConfusion Metric, to a Manager.
+/// @param [out] parser ArgParser to use. On return this is set to the last arguments used to make a Data Channel.
+/// @param [out] manager Manager to update.
+/// @param scene Ground truth scene the Metrics compare against.
+inline void add_data_channels(forge_scan::utilities::ArgParser& parser,
+                              std::shared_ptr<forge_scan::Manager>& manager,
+                              const std::shared_ptr<forge_scan::simulation::GroundTruthScene>& scene)
+{
+    while (true)
+    {
+        parser.getInput("\nAdd a data channel to the configuration [-h for help or ENTER to finish]:");
+        if (parser[0] == "-h")
+        {
+            std::cout << "\n" << forge_scan::data::Constructor::help(parser) << std::endl;
+        }
+        else if (!parser.hasArgs())
+        {
+            return;
+        }
+        else
+        {
+            try
+            {
+                manager->reconstructionAddChannel(parser);
+            }
+            catch(const std::exception& e)
+            {
+                std::cerr << "Could not add data channel: " << e.what() << '\n';
+                continue;
+            }
+
+            const std::string channel_name = parser.get(forge_scan::data::Reconstruction::parse_name);
+            try
+            {
+                manager->metricAdd(forge_scan::metrics::OccupancyConfusion::create(manager->reconstruction,
+                                                                                   scene->getGroundTruthOccupancy(),
+                                                                                   channel_name));
+            }
+            catch(const std::exception& e)
+            {
+                std::cerr << "Could not add an OccupancyConfusion metric for " << channel_name << ": " << e.what() << '\n';
+            }
+        }
+    }
+}
+
+
+/// @brief Helper to get the chunking and compression for the saved HDF5 data sets.
+/// @param [out] parser ArgParser to use. On return this is set to the arguments used for the options.
+/// @return Options for the saved data sets.
+inline forge_scan::utilities::DataSetOptions get_dataset_options(forge_scan::utilities::ArgParser& parser)
+{
+    while (true)
+    {
+        parser.getInput("\nPlease specify HDF5 compression [-h for help or ENTER for none]:");
+        if (parser[0] != "-h")
+        {
+            try
+            {
+                return forge_scan::utilities::DataSetOptions(parser);
+            }
+            catch (const std::invalid_argument& e)
+            {
+                std::cerr << e.what() << '\n';
+                continue;
+            }
+        }
+        std::cout << "\n" << forge_scan::utilities::DataSetOptions::helpMessage() << std::endl;
+    }
+}
+
+
+int main()
+{
+    forge_scan::utilities::ArgParser parser;
+
+
+    static const std::string default_log_file_path   = "ExperimentResults_views.h5";
+    static const std::string default_scene_file_path = FORGE_SCAN_SHARE_DIR "/Examples/Scene.h5";
+    static const std::string default_file_path       = "ReplayResults";
+
+    parser.getInput("Enter a file path to the recorded views to replay:");
+    auto log = forge_scan::sensor::ViewLogReader::create(parser.get<std::string>(0, default_log_file_path));
+    std::cout << "\nThe log has " << log->size() << " views." << std::endl;
+
+    parser.getInput("Enter a file path prefix for the replayed experiment data:");
+    const std::filesystem::path fpath = parser.get<std::string>(0, default_file_path);
+    const auto dataset_options = get_dataset_options(parser);
+
+    parser.getInput("Enter the image stride and the number of threads to use [stride n_threads]:");
+    const size_t stride    = std::max(parser.get<size_t>(0, 1), size_t(1));
+    const size_t n_threads = std::max(parser.get<size_t>(1, 1), size_t(1));
+
+
+    // *********************************** SETUP EXPERIMENT ************************************ //
+
+
+    parser.getInput("Enter a file path to the ground truth scene to use:");
+    std::filesystem::path scene_fpath = parser.get<std::string>(0, default_scene_file_path);
+    auto scene = forge_scan::simulation::GroundTruthScene::create();
+    scene->load(scene_fpath);
+
+
+    // ***************************** Set up a Manager per configuration ************************ //
+
+    std::vector<std::string> names;
+    std::vector<std::shared_ptr<forge_scan::Manager>> managers;
+    while (true)
+    {
+        parser.getInput("\nEnter a name for the next configuration [ENTER to finish]:");
+        if (!parser.hasArgs())
+        {
+            break;
+        }
+        names.push_back(parser.get<std::string>(0));
+        auto manager = forge_scan::Manager::create(scene->grid_properties);
+        add_data_channels(parser, manager, scene);
+        managers.push_back(manager);
+    }
+    if (managers.empty())
+    {
+        std::cout << "No configurations were added." << std::endl;
+        return 0;
+    }
+
+
+    // ******************************** GENERATE THEN SAVE DATA ******************************** //
+
+    forge_scan::utilities::Timer timer;
+
+    timer.start();
+    const size_t n_views = forge_scan::Manager::reconstructionReplay(managers, *log, stride, n_threads);
+    timer.stop();
+
+    std::cout << "Finished! Replaying " << n_views << " views into " << managers.size()
+              << " configurations took " << timer.elapsedSeconds() << " seconds." << std::endl;
+
+    for (size_t i = 0; i < managers.size(); ++i)
+    {
+        std::filesystem::path config_fpath = fpath;
+        config_fpath.replace_filename(fpath.filename().replace_extension("").string() + "_" + names[i] + ".h5");
+        auto updated_fpath = managers[i]->save(config_fpath, dataset_options);
+
+        std::cout << "\nThe " << names[i] << " data was successfully saved at:\n\t" << updated_fpath << std::endl;
+    }
+
+    return 0;
+}
@@ -1,7 +1,8 @@
 #include "ForgeScan/Manager.hpp"
 #include "ForgeScan/Simulation/GroundTruthScene.hpp"
+#include "ForgeScan/Simulation/Pipeline.hpp"
 
-#include "ForgeScan/Sensor/DepthImageProccessing.hpp"
+#include "ForgeScan/Sensor/ViewLog.hpp"
 #include "ForgeScan/Utilities/Timer.hpp"
 
 
@@ -127,6 +128,31 @@ inline void add_metrics(forge_scan::utilities::ArgParser& parser,
 }
 
 
+/// @brief Helper to get the chunking and compression for the saved HDF5 data sets.
+/// @param [out] parser ArgParser to use. On return this is set to the arguments used for the options.
+/// @return Options for the saved data sets.
+inline forge_scan::utilities::DataSetOptions get_dataset_options(forge_scan::utilities::ArgParser& parser)
+{
+    while (true)
+    {
+        parser.getInput("\nPlease specify HDF5 compression [-h for help or ENTER for none]:");
+        if (parser[0] != "-h")
+        {
+            try
+            {
+                return forge_scan::utilities::DataSetOptions(parser);
+            }
+            catch (const std::invalid_argument& e)
+            {
+                std::cerr << e.what() << '\n';
+                continue;
+            }
+        }
+        std::cout << "\n" << forge_scan::utilities::DataSetOptions::helpMessage() << std::endl;
+    }
+}
+
+
 int main()
 {
     forge_scan::utilities::ArgParser parser;
@@ -138,10 +164,11 @@ int main()
     parser.getInput("Enter a file path for this experiment data:");
     std::filesystem::path fpath = parser.get<std::string>(0, default_file_path);
 
-    std::filesystem::path image_fpath = fpath;
-    const std::string image_prefix    = fpath.filename().replace_extension("").string() + "_view_";
+    std::filesystem::path log_fpath = fpath;
+    log_fpath.replace_filename(fpath.filename().replace_extension("").string() + "_views.h5");
     parser.getInput("Save images with reconstruction data? [y/n]:");
     const bool save_im = parser[0] == "y";
+    const auto dataset_options = get_dataset_options(parser);
 
     // *********************************** SETUP EXPERIMENT ************************************ //
 
@@ -192,44 +219,40 @@ int main()
 
     // ******************************** GENERATE THEN SAVE DATA ******************************** //
 
+    // Views are rendered, deprojected, and integrated on separate threads.
+    auto pipeline = forge_scan::simulation::Pipeline::create(manager, scene, camera);
+
     forge_scan::utilities::RandomSampler<float> rand_sample;
-    forge_scan::utilities::Timer timer;
-    forge_scan::PointMatrix sensed_points;
-    size_t n = 0;
+    pipeline->setViewFilter([&](const forge_scan::Extrinsic&) { return rand_sample.uniform() >= reject_rate; });
 
-    timer.start();
-    while (!manager->policyIsComplete())
+    // Images are copied to a writer thread which appends them, losslessly, to one log file. They
+    // may be replayed with Manager::reconstructionReplay.
+    std::shared_ptr<forge_scan::sensor::ViewLogWriter> view_log;
+    if (save_im)
     {
-        forge_scan::Extrinsic camera_pose = manager->policyGetView();
-
-        float val = rand_sample.uniform();
-        if (val >= reject_rate)
+        view_log = forge_scan::sensor::ViewLogWriter::create(log_fpath, camera->getIntr(), dataset_options);
+        pipeline->setImageCallback([&](const std::shared_ptr<const forge_scan::sensor::Camera>& view_camera, const size_t&)
         {
-            manager->policyAcceptView();
-
-            camera->setExtr(camera_pose);
+            view_log->write(view_camera);
+        });
+    }
 
-            scene->image(camera, scene->grid_lower_bound);
-            if (save_im)
-            {
-                image_fpath.replace_filename(image_prefix + std::to_string(n) + ".jpg");
-                forge_scan::sensor::DepthImageProcessing::imwrite(camera, image_fpath);
-            }
+    forge_scan::utilities::Timer timer;
 
-            camera->getPointMatrix(sensed_points);
-            manager->reconstructionUpdate(sensed_points, camera->getExtr());
-        }
-        else
-        {
-            manager->policyRejectView();
-        }
-        ++n;
-    }
+    timer.start();
+    pipeline->run(scene->grid_lower_bound);
     timer.stop();
 
     std::cout << "Finished! Process took " << timer.elapsedSeconds() << " seconds." << std::endl;
 
-    auto updated_fpath = manager->save(fpath);
+    if (view_log)
+    {
+        view_log->close();
+        std::cout << "\nThe " << view_log->size() << " views were saved at:\n\t"
+                  << std::filesystem::absolute(log_fpath) << std::endl;
+    }
+
+    auto updated_fpath = manager->save(fpath, dataset_options);
 
     std::cout << "\nThe experimental data was successfully saved at:\n\t"
               << std::filesystem::absolute(fpath) << std::endl;
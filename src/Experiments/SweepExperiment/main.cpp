@@ -0,0 +1,412 @@
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "ForgeScan/Manager.hpp"
+#include "ForgeScan/Simulation/GroundTruthScene.hpp"
+
+#include "ForgeScan/Utilities/Threads.hpp"
+#include "ForgeScan/Utilities/Timer.hpp"
+
+
+/// @brief Runs a sweep of experiments, as RunExperiment does for one, within a single process.
+/// @details Accepts the arguments:
+///              --config <sweep file> [--n-workers <n>] [--start-at <n>] [--no-override] [--list]
+///              [HDF5 compression options, see DataSetOptions]
+///          Each ground truth scene is loaded once, and its ground truth occupancy found once, and
+///          these are shared by every experiment which uses it. Experiments are run concurrently,
+///          one Manager each, by worker threads which each take the next experiment not yet
+///          started. Results are saved as each experiment finishes, and a row for it is appended
+///          to `sweep.csv` in the output directory, so a stopped sweep may be resumed with
+///          `--start-at` or `--no-override`.
+/// @details The sweep file has one keyword per line, followed by its arguments. Blank lines and
+///          lines starting with `#` are ignored.
+///              output      <directory>
+///              scene       <ground truth scene file>
+///              camera      <name> <Intrinsics arguments> [--noise <percent>]
+///              policy      <name> <repeats> <Policy arguments>
+///              channel     <Data Channel arguments>
+///              n-views     <n> [<n> ...]
+///              reject-rate <rate>
+///              random-seed
+///          The `scene`, `camera`, `policy` and `channel` keywords may be given many times. One
+///          experiment is run for every camera, scene, policy, number of views and repeat, in that
+///          order, and saved to `<output>/<camera>/<scene>/<policy>/<n views>/<repeat>/results.h5`.
+///          Every experiment has each channel, and an OccupancyConfusion Metric for it. Policies are
+///          given `--n-views` and a `--seed` of the repeat number, unless `random-seed` is set. A
+///          Policy which sets its own `--n-views` keeps it. A Policy with `--views-per-repeat <k>`
+///          instead takes `k` views as many times as are needed for the number of views, as an
+///          Axis Policy does with `--n-views k --n-repeat <n / k>`.
+
+
+/// @brief An experiment setting with a name, such as a camera or a Policy.
+struct NamedArgs
+{
+    std::string name;
+    std::string args;
+    size_t repeats = 1;
+};
+
+
+/// @brief Settings read from a sweep file.
+struct SweepConfig
+{
+    std::filesystem::path output = FORGE_SCAN_SHARE_DIR "/Experiments/Results";
+    std::vector<std::filesystem::path> scenes;
+    std::vector<NamedArgs> cameras;
+    std::vector<NamedArgs> policies;
+    std::vector<std::string> channels;
+    std::vector<size_t> n_views;
+    float reject_rate = 0;
+    bool random_seed = false;
+};
+
+
+/// @brief One experiment of the sweep.
+struct Job
+{
+    size_t number;
+    size_t camera, scene, policy, n_views, repeat;
+    std::filesystem::path fpath;
+};
+
+
+/// @brief Reads a sweep file.
+/// @param fpath Path to the sweep file.
+/// @return Settings for the sweep.
+/// @throws std::invalid_argument If the file may not be opened, has an unknown keyword, or is
+///         missing a scene, camera, policy, or number of views.
+inline SweepConfig read_sweep_config(const std::filesystem::path& fpath)
+{
+    std::ifstream file(fpath);
+    if (!file)
+    {
+        throw std::invalid_argument("Cannot open the sweep file: " + fpath.string());
+    }
+
+    SweepConfig config;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream stream(line);
+        std::string keyword, rest;
+        stream >> keyword;
+        if (keyword.empty() || keyword[0] == '#')
+        {
+            continue;
+        }
+        std::getline(stream >> std::ws, rest);
+
+        if (keyword == "output")
+        {
+            config.output = rest;
+        }
+        else if (keyword == "scene")
+        {
+            config.scenes.emplace_back(rest);
+        }
+        else if (keyword == "camera")
+        {
+            std::istringstream args(rest);
+            NamedArgs camera;
+            args >> camera.name;
+            std::getline(args >> std::ws, camera.args);
+            config.cameras.push_back(camera);
+        }
+        else if (keyword == "policy")
+        {
+            std::istringstream args(rest);
+            NamedArgs policy;
+            args >> policy.name >> policy.repeats;
+            std::getline(args >> std::ws, policy.args);
+            config.policies.push_back(policy);
+        }
+        else if (keyword == "channel")
+        {
+            config.channels.push_back(rest);
+        }
+        else if (keyword == "n-views")
+        {
+            std::istringstream args(rest);
+            size_t n;
+            while (args >> n)
+            {
+                config.n_views.push_back(n);
+            }
+        }
+        else if (keyword == "reject-rate")
+        {
+            config.reject_rate = std::clamp(std::stof(rest), 0.0f, 1.0f);
+        }
+        else if (keyword == "random-seed")
+        {
+            config.random_seed = true;
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown keyword in the sweep file: " + keyword);
+        }
+    }
+
+    if (config.scenes.empty() || config.cameras.empty() || config.policies.empty() || config.n_views.empty())
+    {
+        throw std::invalid_argument("A sweep file needs at least one scene, camera, policy, and number of views.");
+    }
+    return config;
+}
+
+
+/// @brief Lists every experiment of a sweep, in order.
+/// @param config Settings for the sweep.
+/// @return The experiments, numbered from 1.
+inline std::vector<Job> make_jobs(const SweepConfig& config)
+{
+    std::vector<Job> jobs;
+    for (size_t c = 0; c < config.cameras.size(); ++c)
+    {
+        for (size_t s = 0; s < config.scenes.size(); ++s)
+        {
+            for (size_t p = 0; p < config.policies.size(); ++p)
+            {
+                for (size_t v = 0; v < config.n_views.size(); ++v)
+                {
+                    for (size_t r = 1; r <= config.policies[p].repeats; ++r)
+                    {
+                        Job job{jobs.size() + 1, c, s, p, v, r, config.output};
+                        job.fpath /= config.cameras[c].name;
+                        job.fpath /= config.scenes[s].stem();
+                        job.fpath /= config.policies[p].name;
+                        job.fpath /= std::to_string(config.n_views[v]);
+                        job.fpath /= std::to_string(r);
+                        job.fpath /= "results.h5";
+                        jobs.push_back(job);
+                    }
+                }
+            }
+        }
+    }
+    return jobs;
+}
+
+
+/// @brief Policy argument giving the number of views in each of the Policy's groups of views.
+static const std::string parse_views_per_repeat = "--views-per-repeat";
+
+
+/// @brief What one worker reuses between experiments.
+struct Worker
+{
+    /// @brief Ray buffer for imaging the shared scenes. See `Scene::image`.
+    open3d::core::Tensor rays;
+
+    forge_scan::utilities::RandomSampler<float> rand_sample;
+};
+
+
+/// @brief Runs one experiment.
+/// @param job Experiment to run.
+/// @param config Settings for the sweep.
+/// @param scene Ground truth scene to image. Shared with the other workers.
+/// @param intr Intrinsics of the experiment's camera. Shared with the other workers.
+/// @param noise Noise of the experiment's camera.
+/// @param worker Buffers for the calling worker.
+/// @return Manager holding the experiment's results.
+inline std::shared_ptr<forge_scan::Manager> run_job(const Job& job, const SweepConfig& config,
+                                                    const std::shared_ptr<forge_scan::simulation::GroundTruthScene>& scene,
+                                                    const std::shared_ptr<const forge_scan::sensor::Intrinsics>& intr,
+                                                    const float& noise, Worker& worker)
+{
+    const int seed = config.random_seed ? static_cast<int>(worker.rand_sample.uniform(1e8f)) + 1
+                                        : static_cast<int>(job.repeat);
+
+    // Experiments already run concurrently, so each Reconstruction uses only its worker's thread.
+    auto manager = forge_scan::Manager::create(scene->grid_properties);
+    manager->reconstruction->setNumThreads(1);
+
+    // A Policy taking its views in groups, such as an Axis which changes axis, repeats its group
+    // of views until it has taken the sweep's number of views.
+    const forge_scan::utilities::ArgParser policy_parser(config.policies[job.policy].args);
+    const size_t n_views = config.n_views[job.n_views];
+    std::string views_args = " --n-views " + std::to_string(n_views);
+    if (policy_parser.has(parse_views_per_repeat))
+    {
+        const size_t per_repeat = std::max(policy_parser.get<size_t>(parse_views_per_repeat), size_t(1));
+        views_args = " --n-views "  + std::to_string(per_repeat) +
+                     " --n-repeat " + std::to_string(std::max(n_views / per_repeat, size_t(1)));
+    }
+    manager->policyAdd(forge_scan::utilities::ArgParser(policy_parser.getArgs() + views_args +
+                                                        " --seed " + std::to_string(seed)));
+    for (const auto& channel : config.channels)
+    {
+        const forge_scan::utilities::ArgParser parser(channel);
+        manager->reconstructionAddChannel(parser);
+        manager->metricAdd(forge_scan::metrics::OccupancyConfusion::create(manager->reconstruction,
+                                                                           scene->getGroundTruthOccupancy(),
+                                                                           parser.get(forge_scan::data::Reconstruction::parse_name)));
+    }
+
+    auto camera = forge_scan::sensor::Camera::create(intr, noise, static_cast<float>(seed));
+    while (!manager->policyIsComplete())
+    {
+        const forge_scan::Extrinsic view = manager->policyGetView();
+        if (worker.rand_sample.uniform() < config.reject_rate)
+        {
+            manager->policyRejectView();
+            continue;
+        }
+        manager->policyAcceptView();
+        camera->setExtr(view);
+        scene->image(camera, worker.rays, scene->grid_lower_bound);
+        manager->reconstructionUpdate(camera);
+    }
+    return manager;
+}
+
+
+int main(const int argc, const char **argv)
+{
+    forge_scan::utilities::ArgParser parser(argc, argv);
+    if (!parser.has("--config"))
+    {
+        std::cout << "Usage: SweepExperiment --config <sweep file> [--n-workers <n>] [--start-at <n>] "
+                     "[--no-override] [--list]\n\n"
+                  << forge_scan::utilities::DataSetOptions::helpMessage() << std::endl;
+        return 1;
+    }
+
+    const SweepConfig config = read_sweep_config(parser.get<std::string>("--config"));
+    const std::vector<Job> jobs = make_jobs(config);
+    const size_t start_at  = parser.get<size_t>("--start-at", 0);
+    const bool no_override = parser.has("--no-override");
+    const size_t n_workers = std::max(parser.get<size_t>("--n-workers", forge_scan::utilities::getHardwareThreadCount()),
+                                      size_t(1));
+    const forge_scan::utilities::DataSetOptions dataset_options(parser);
+
+    if (parser.has("--list"))
+    {
+        for (const auto& job : jobs)
+        {
+            std::cout << "(" << job.number << " / " << jobs.size() << ") " << job.fpath.string() << "\n";
+        }
+        return 0;
+    }
+
+
+    // ********************************** LOAD SHARED DATA ************************************* //
+
+
+    // Scenes, their ground truth and the camera Intrinsics are only read by the workers.
+    std::vector<std::shared_ptr<forge_scan::simulation::GroundTruthScene>> scenes;
+    for (const auto& scene_fpath : config.scenes)
+    {
+        auto scene = forge_scan::simulation::GroundTruthScene::create();
+        scene->load(scene_fpath);
+        scene->getGroundTruthOccupancy();
+        scenes.push_back(scene);
+    }
+
+    std::vector<std::shared_ptr<const forge_scan::sensor::Intrinsics>> intrinsics;
+    std::vector<float> noise;
+    for (const auto& camera : config.cameras)
+    {
+        const forge_scan::utilities::ArgParser camera_parser(camera.args);
+        intrinsics.push_back(forge_scan::sensor::Intrinsics::create(camera_parser));
+        noise.push_back(camera_parser.get<float>("--noise", 0.0f));
+    }
+
+
+    // ********************************** RUN THE EXPERIMENTS ********************************** //
+
+
+    std::filesystem::create_directories(config.output);
+    const std::filesystem::path log_fpath = config.output / "sweep.csv";
+    const bool new_log = !std::filesystem::exists(log_fpath);
+    std::ofstream log(log_fpath, std::ios::app);
+    if (new_log)
+    {
+        log << "experiment,path,views,seconds,status" << std::endl;
+    }
+
+    std::cout << "Running " << jobs.size() << " experiments on " << n_workers << " workers, beginning at experiment "
+              << start_at << "..." << std::endl;
+
+    // HDF5 is not safe to use from several threads at once, so saving and logging are serialized.
+    std::mutex save_mutex;
+    std::atomic<size_t> next_job{0};
+    auto work = [&]()
+    {
+        Worker worker;
+        for (size_t i = next_job++; i < jobs.size(); i = next_job++)
+        {
+            const Job& job = jobs[i];
+            if (job.number < start_at)
+            {
+                continue;
+            }
+            if (no_override && std::filesystem::exists(job.fpath))
+            {
+                std::lock_guard<std::mutex> lock(save_mutex);
+                std::cout << "(" << job.number << " / " << jobs.size() << ") " << job.fpath.string()
+                          << "\n\tAlready exists. Skipping experiment..." << std::endl;
+                continue;
+            }
+
+            forge_scan::utilities::Timer timer;
+            std::string status = "ok";
+            size_t n_views = 0;
+            std::shared_ptr<forge_scan::Manager> manager;
+
+            timer.start();
+            try
+            {
+                manager = run_job(job, config, scenes[job.scene], intrinsics[job.camera], noise[job.camera], worker);
+                n_views = manager->reconstructionGetUpdateCount();
+            }
+            catch (const std::exception& e)
+            {
+                status = e.what();
+            }
+            timer.stop();
+
+            std::lock_guard<std::mutex> lock(save_mutex);
+            if (manager)
+            {
+                try
+                {
+                    std::filesystem::create_directories(job.fpath.parent_path());
+                    manager->save(job.fpath, dataset_options);
+                }
+                catch (const std::exception& e)
+                {
+                    status = e.what();
+                }
+            }
+            std::replace(status.begin(), status.end(), ',', ';');
+            log << job.number << "," << job.fpath.string() << "," << n_views << ","
+                << timer.elapsedSeconds() << "," << status << std::endl;
+            std::cout << "(" << job.number << " / " << jobs.size() << ") " << job.fpath.string()
+                      << (status == "ok" ? "" : "\n\tFailed: " + status) << std::endl;
+        }
+    };
+
+    forge_scan::utilities::Timer timer;
+    timer.start();
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < n_workers; ++t)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    timer.stop();
+
+    std::cout << "Finished! The sweep took " << timer.elapsedSeconds() << " seconds. Results were logged to:\n\t"
+              << std::filesystem::absolute(log_fpath) << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,453 @@
+#include <chrono>
+#include <future>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/eigen.h>
+#include <pybind11/functional.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <pybind11/stl/filesystem.h>
+
+#include "ForgeScan/Manager.hpp"
+#include "ForgeScan/Metrics/OccupancyConfusion.hpp"
+#include "ForgeScan/Metrics/TSDFError.hpp"
+#include "ForgeScan/Simulation/GroundTruthScene.hpp"
+#include "ForgeScan/Simulation/Pipeline.hpp"
+
+
+namespace py = pybind11;
+using namespace forge_scan;
+
+
+namespace {
+
+
+// ********************************************************************************************* //
+// *                                     ARRAY CONVERSIONS                                     * //
+// ********************************************************************************************* //
+
+
+/// @brief Converts a 4x4 homogeneous transformation from Python into an Extrinsic.
+Extrinsic toExtrinsic(const Eigen::Matrix4f& matrix)
+{
+    Extrinsic extr;
+    extr.matrix() = matrix;
+    return extr;
+}
+
+
+/// @brief Stores a shared pointer in a capsule, so a NumPy array which is a view of the object's
+///        memory keeps the object alive for as long as the array is.
+py::capsule keepAlive(std::shared_ptr<const void> owner)
+{
+    auto* holder = new std::shared_ptr<const void>(std::move(owner));
+    return py::capsule(holder, [](void* ptr) { delete static_cast<std::shared_ptr<const void>*>(ptr); });
+}
+
+
+/// @brief Gets the (nz, ny, nx) shape of a Grid. NumPy's C order then matches the X-major linear order.
+std::vector<py::ssize_t> getShape(const Grid::Properties& properties)
+{
+    return { static_cast<py::ssize_t>(properties.size.z()),
+             static_cast<py::ssize_t>(properties.size.y()),
+             static_cast<py::ssize_t>(properties.size.x()) };
+}
+
+
+/// @brief Creates a read-only array over data in the X-major linear order, without copying it.
+///        It is marked read-only with NumPy's `ndarray.setflags`, so writes from Python raise.
+/// @param data  Elements of the Grid.
+/// @param properties Grid Properties the data has.
+/// @param owner Capsule keeping the memory of the data alive. See `keepAlive`.
+template <typename T>
+py::array viewLinear(const T* data, const Grid::Properties& properties, py::capsule owner)
+{
+    py::array array = py::array_t<T>(getShape(properties), data, owner);
+    array.attr("setflags")(py::arg("write") = false);
+    return array;
+}
+
+
+/// @brief Creates an array which owns a vector in the X-major linear order.
+template <typename T>
+py::array ownLinear(std::vector<T> linear, const Grid::Properties& properties)
+{
+    auto* owner = new std::vector<T>(std::move(linear));
+    py::capsule base(owner, [](void* ptr) { delete static_cast<std::vector<T>*>(ptr); });
+    return py::array_t<T>(getShape(properties), owner->data(), base);
+}
+
+
+/// @brief Gets an array of a data vector in the X-major linear order. Contiguous vectors in the
+///        linear order are viewed in place. A copy is made for bricked or sparse storage, as that
+///        memory has no equivalent NumPy layout.
+/// @{
+template <typename T>
+py::array toArray(const std::vector<T>& vector, const Grid::Properties& properties, py::capsule owner)
+{
+    return properties.isLinear() ? viewLinear(vector.data(), properties, owner) :
+                                   ownLinear(properties.toLinearOrder(vector), properties);
+}
+
+template <typename T>
+py::array toArray(const MappedVector<T>& vector, const Grid::Properties& properties, py::capsule owner)
+{
+    return properties.isLinear() ? viewLinear(vector.data(), properties, owner) :
+                                   ownLinear(properties.toLinearOrder(vector.toDense()), properties);
+}
+
+template <typename T>
+py::array toArray(const SparseVector<T>& vector, const Grid::Properties& properties, py::capsule)
+{
+    return ownLinear(properties.toLinearOrder(vector.toDense()), properties);
+}
+/// @}
+
+
+/// @brief Gets an array of the stored values of a channel. See `toArray`.
+/// @note  Quantized TSDF channels are returned as their stored integers. See `data::TSDF::getQuantizer`.
+py::array getChannelData(const std::shared_ptr<const data::VoxelGrid>& channel)
+{
+    return std::visit([&](const auto& vector) { return toArray(vector, *channel->properties, keepAlive(channel)); },
+                      channel->getData());
+}
+
+
+/// @brief Gets an array of the weights of a TSDF channel. See `toArray`.
+/// @return The weights, or None for an average or minimum TSDF. Compact weights are decoded into a copy.
+/// @throws py::type_error If the channel is not a TSDF.
+py::object getChannelWeights(const std::shared_ptr<const data::VoxelGrid>& channel)
+{
+    auto tsdf = std::dynamic_pointer_cast<const data::TSDF>(channel);
+    if (tsdf == nullptr)
+    {
+        throw py::type_error("Channel of type " + channel->getTypeName() + " has no weights.");
+    }
+    const Grid::Properties& properties = *channel->properties;
+    if (const std::vector<float>* weights = tsdf->getWeights())
+    {
+        return toArray(*weights, properties, keepAlive(channel));
+    }
+    std::vector<float> weights = tsdf->decodeWeights();
+    if (weights.empty())
+    {
+        return py::none();
+    }
+    return ownLinear(properties.toLinearOrder(weights), properties);
+}
+
+
+/// @brief Copies seen data into an array of 0 and 1 in the X-major linear order.
+py::array getSeenData(const Bitset& seen, const Grid::Properties& properties)
+{
+    std::vector<uint8_t> data(seen.size());
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = seen.test(i);
+    }
+    return ownLinear(properties.toLinearOrder(data), properties);
+}
+
+
+/// @brief Gets a read-only view of a ground truth Grid. See `toArray`.
+template <typename GroundTruth>
+py::array getGroundTruthData(const std::shared_ptr<GroundTruth>& ground_truth)
+{
+    return toArray(ground_truth->getData(), *ground_truth->properties, keepAlive(ground_truth));
+}
+
+
+} // namespace
+
+
+
+// ********************************************************************************************* //
+// *                                          MODULE                                           * //
+// ********************************************************************************************* //
+
+
+/// @brief Python module for running ForgeScan experiments in process.
+/// @details Channel data, weights and ground truth are returned as NumPy arrays of shape (nz, ny, nx)
+///          which view the Grid's memory where its layout allows. Each view keeps what it views
+///          alive, but views of a Manager's live channels change as it integrates updates. Views of
+///          a Snapshot do not.
+/// @note  Calls which trace rays, generate views, render images, or read and write files release
+///        the GIL, so other Python threads may run while they do.
+PYBIND11_MODULE(forge_scan, m)
+{
+    m.doc() = "ForgeScan: simulated depth cameras, voxel reconstructions and view selection policies.";
+
+    using release_gil = py::call_guard<py::gil_scoped_release>;
+    const Eigen::Matrix4f identity = Eigen::Matrix4f::Identity();
+
+
+    // ************************************* GRID AND SENSORS ************************************* //
+
+
+    py::class_<Grid::Properties, std::shared_ptr<Grid::Properties>>(m, "GridProperties")
+        .def(py::init([](const std::string& args) { return std::make_shared<Grid::Properties>(utilities::ArgParser(args)); }),
+             py::arg("args") = "")
+        .def_readonly("resolution", &Grid::Properties::resolution)
+        .def_property_readonly("size", [](const Grid::Properties& p) { return std::vector<size_t>{p.size.x(), p.size.y(), p.size.z()}; })
+        .def_property_readonly("dimensions", [](const Grid::Properties& p) { return Eigen::Vector3f(p.dimensions); })
+        .def_property_readonly("shape", [](const Grid::Properties& p) { return getShape(p); });
+
+
+    py::class_<sensor::Camera, std::shared_ptr<sensor::Camera>>(m, "Camera")
+        .def(py::init([](const std::string& intr_args, const float& percent_noise, const float& seed, const Eigen::Matrix4f& pose)
+             {
+                 return sensor::Camera::create(sensor::Intrinsics::create(utilities::ArgParser(intr_args)),
+                                               percent_noise, seed, toExtrinsic(pose));
+             }),
+             py::arg("intr_args") = "", py::arg("percent_noise") = 0.02f, py::arg("seed") = -1.0f,
+             py::arg("pose") = identity)
+        .def_property("pose", [](const sensor::Camera& c) { return Eigen::Matrix4f(c.extr.matrix()); },
+                              [](sensor::Camera& c, const Eigen::Matrix4f& pose) { c.extr = toExtrinsic(pose); })
+        .def_property_readonly("image", &sensor::Camera::getImage, py::return_value_policy::reference_internal,
+                               "Read-only view of the depth image, in the Camera's memory.")
+        .def("orient_principle_axis", &sensor::Camera::orientPrincipleAxis, py::arg("target"))
+        .def("add_noise", py::overload_cast<>(&sensor::Camera::addNoise))
+        .def("points", [](const sensor::Camera& c, const size_t& stride)
+             {
+                 PointMatrix points;
+                 c.getPointMatrix(points, Extrinsic::Identity(), stride);
+                 return points;
+             },
+             py::arg("stride") = 1, release_gil(), "Deprojects the image into a 3 x N array, relative to the Camera.");
+
+
+    // ****************************************** SCENE ******************************************* //
+
+
+    py::class_<simulation::GroundTruthScene, std::shared_ptr<simulation::GroundTruthScene>>(m, "Scene")
+        .def(py::init([](const std::string& grid_args, const Eigen::Matrix4f& grid_lower_bound)
+             {
+                 return simulation::GroundTruthScene::create(toExtrinsic(grid_lower_bound),
+                                                             Grid::Properties::createConst(utilities::ArgParser(grid_args)));
+             }),
+             py::arg("grid_args") = "", py::arg("grid_lower_bound") = identity)
+        .def_static("load", [](const std::filesystem::path& fpath)
+             {
+                 auto scene = simulation::GroundTruthScene::create();
+                 scene->load(fpath);
+                 return scene;
+             },
+             py::arg("fpath"), release_gil())
+        .def("save", &simulation::GroundTruthScene::save, py::arg("fpath"), release_gil())
+        .def("add", [](simulation::GroundTruthScene& s, const std::string& args) { s.add(utilities::ArgParser(args)); },
+             py::arg("args"), release_gil())
+        .def_property_readonly("grid_properties", [](const simulation::GroundTruthScene& s)
+             {
+                 return std::const_pointer_cast<Grid::Properties>(s.grid_properties);
+             })
+        .def("image", [](simulation::GroundTruthScene& s, const std::shared_ptr<sensor::Camera>& camera, const Eigen::Matrix4f& camera_pose)
+             {
+                 s.image(camera, toExtrinsic(camera_pose));
+             },
+             py::arg("camera"), py::arg("camera_pose") = identity, release_gil())
+        .def("ground_truth_occupancy", [](simulation::GroundTruthScene& s)
+             {
+                 std::shared_ptr<metrics::ground_truth::Occupancy> ground_truth;
+                 {
+                     py::gil_scoped_release release;
+                     ground_truth = s.getGroundTruthOccupancy();
+                 }
+                 return getGroundTruthData(ground_truth);
+             })
+        .def("ground_truth_tsdf", [](simulation::GroundTruthScene& s)
+             {
+                 std::shared_ptr<metrics::ground_truth::TSDF> ground_truth;
+                 {
+                     py::gil_scoped_release release;
+                     ground_truth = s.getGroundTruthTSDF();
+                 }
+                 return getGroundTruthData(ground_truth);
+             });
+
+
+    // ***************************************** METRICS ****************************************** //
+
+
+    py::class_<metrics::Metric, std::shared_ptr<metrics::Metric>>(m, "Metric")
+        .def_readonly("name", &metrics::Metric::map_name);
+
+    py::class_<metrics::OccupancyConfusion, metrics::Metric, std::shared_ptr<metrics::OccupancyConfusion>>(m, "OccupancyConfusion")
+        .def_property_readonly("confusion", &metrics::OccupancyConfusion::getConfusionAsMatrix,
+                               "Rows of: update, true positives, true negatives, false positives, false negatives, unknown.");
+
+    py::class_<metrics::TSDFError, metrics::Metric, std::shared_ptr<metrics::TSDFError>>(m, "TSDFError")
+        .def_property_readonly("error", &metrics::TSDFError::getErrorAsMatrix,
+                               "Rows of: update, voxels compared, mean absolute error, root mean squared error.");
+
+
+    // ***************************************** SNAPSHOT ***************************************** //
+
+
+    py::class_<data::Snapshot, std::shared_ptr<data::Snapshot>>(m, "Snapshot")
+        .def_property_readonly("channels", [](const data::Snapshot& s)
+             {
+                 std::vector<std::string> names;
+                 for (const auto& item : s.getChannels())
+                 {
+                     names.push_back(item.first);
+                 }
+                 return names;
+             })
+        .def_property_readonly("n_updates", &data::Snapshot::getNumUpdates)
+        .def("data", [](const data::Snapshot& s, const std::string& name) { return getChannelData(s.getChannel(name)); },
+             py::arg("channel"))
+        .def("weights", [](const data::Snapshot& s, const std::string& name) { return getChannelWeights(s.getChannel(name)); },
+             py::arg("channel"))
+        .def("seen", [](const data::Snapshot& s)
+             {
+                 const auto& channels = s.getChannels();
+                 if (channels.empty())
+                 {
+                     throw py::value_error("Snapshot has no channels to take the Grid Properties from.");
+                 }
+                 return getSeenData(*s.getSeenData(), *channels.begin()->second->properties);
+             });
+
+
+    // ***************************************** MANAGER ****************************************** //
+
+
+    py::class_<Manager::IngestStats>(m, "IngestStats")
+        .def_readonly("received",        &Manager::IngestStats::received)
+        .def_readonly("dropped",         &Manager::IngestStats::dropped)
+        .def_readonly("queued",          &Manager::IngestStats::queued)
+        .def_readonly("integrated",      &Manager::IngestStats::integrated)
+        .def_readonly("latency_last_ms", &Manager::IngestStats::latency_last_ms)
+        .def_readonly("latency_mean_ms", &Manager::IngestStats::latency_mean_ms)
+        .def_readonly("latency_max_ms",  &Manager::IngestStats::latency_max_ms);
+
+    py::class_<std::shared_future<std::filesystem::path>>(m, "SaveFuture")
+        .def("result", [](const std::shared_future<std::filesystem::path>& f) { return f.get(); }, release_gil(),
+             "Waits for the save and returns the path written, or raises its exception.")
+        .def("done", [](const std::shared_future<std::filesystem::path>& f)
+             {
+                 return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+             });
+
+    py::class_<Manager, std::shared_ptr<Manager>>(m, "Manager")
+        .def(py::init([](const std::string& args) { return Manager::create(utilities::ArgParser(args)); }),
+             py::arg("args") = "")
+        .def(py::init([](const std::shared_ptr<simulation::GroundTruthScene>& scene) { return Manager::create(scene->grid_properties); }),
+             py::arg("scene"))
+        .def_property_readonly("grid_properties", [](const Manager& mgr)
+             {
+                 return std::const_pointer_cast<Grid::Properties>(mgr.reconstruction->grid_properties);
+             })
+
+        // Reconstruction.
+        .def("add_channel", [](Manager& mgr, const std::string& args) { mgr.reconstructionAddChannel(utilities::ArgParser(args)); },
+             py::arg("args"))
+        .def("remove_channel", &Manager::reconstructionRemoveChannel, py::arg("name"))
+        .def("data", [](const Manager& mgr, const std::string& name) { return getChannelData(mgr.reconstruction->getChannelView(name)); },
+             py::arg("channel"), "Live view of a channel's data. Use snapshot() while frames are being ingested.")
+        .def("weights", [](const Manager& mgr, const std::string& name) { return getChannelWeights(mgr.reconstruction->getChannelView(name)); },
+             py::arg("channel"), "Live view of a TSDF channel's weights. Use snapshot() while frames are being ingested.")
+        .def("snapshot", [](const Manager& mgr) { return std::const_pointer_cast<data::Snapshot>(mgr.reconstructionGetSnapshot()); },
+             release_gil())
+        .def("update", [](Manager& mgr, PointMatrix points, const Eigen::Matrix4f& pose)
+             {
+                 mgr.reconstructionUpdate(points, toExtrinsic(pose));
+             },
+             py::arg("points"), py::arg("pose"), release_gil(), "Integrates a 3 x N array of points, relative to the sensor pose.")
+        .def("update", [](Manager& mgr, const std::shared_ptr<sensor::Camera>& camera, const size_t& stride)
+             {
+                 mgr.reconstructionUpdate(camera, stride);
+             },
+             py::arg("camera"), py::arg("stride") = 1, release_gil())
+        .def_property_readonly("n_updates", &Manager::reconstructionGetUpdateCount)
+        .def("save_surface", &Manager::reconstructionSaveSurface, py::arg("fpath"), release_gil())
+        .def("enable_surface", &Manager::reconstructionEnableSurface, py::arg("channel"), py::arg("iso") = 0.0f)
+
+        // Policies.
+        .def("policy_add", [](Manager& mgr, const std::string& args) { return mgr.policyAdd(utilities::ArgParser(args)); },
+             py::arg("args"), release_gil())
+        .def("policy_set_active", &Manager::policySetActive, py::arg("idx"))
+        .def("has_policy", py::overload_cast<>(&Manager::hasPolicy, py::const_))
+        .def("policy_generate", &Manager::policyGenerate, release_gil())
+        .def("policy_get_view", [](Manager& mgr) { return Eigen::Matrix4f(mgr.policyGetView().matrix()); })
+        .def("policy_accept_view", &Manager::policyAcceptView)
+        .def("policy_reject_view", &Manager::policyRejectView)
+        .def("policy_is_complete", &Manager::policyIsComplete)
+
+        // Metrics.
+        .def("metric_add", [](Manager& mgr, const std::string& args) { mgr.metricAdd(utilities::ArgParser(args)); },
+             py::arg("args"))
+        .def("metric_add_occupancy_confusion",
+             [](Manager& mgr, const std::shared_ptr<simulation::GroundTruthScene>& scene, const std::string& channel)
+             {
+                 auto metric = metrics::OccupancyConfusion::create(mgr.reconstruction, scene->getGroundTruthOccupancy(), channel);
+                 mgr.metricAdd(metric);
+                 return metric;
+             },
+             py::arg("scene"), py::arg("channel") = "")
+        .def("metric_add_tsdf_error",
+             [](Manager& mgr, const std::shared_ptr<simulation::GroundTruthScene>& scene, const std::string& channel)
+             {
+                 auto metric = metrics::TSDFError::create(mgr.reconstruction, scene->getGroundTruthTSDF(), channel);
+                 mgr.metricAdd(metric);
+                 return metric;
+             },
+             py::arg("scene"), py::arg("channel") = "")
+
+        // Ingestion.
+        .def("ingest_start", [](Manager& mgr, const std::shared_ptr<sensor::Camera>& camera, const std::string& args)
+             {
+                 mgr.ingestStart(camera->getIntr(), utilities::ArgParser(args));
+             },
+             py::arg("camera"), py::arg("args") = "")
+        .def("ingest_frame", [](Manager& mgr, const DepthImage& image, const Eigen::Matrix4f& pose)
+             {
+                 return mgr.ingestFrame(image, toExtrinsic(pose));
+             },
+             py::arg("image"), py::arg("pose"), release_gil())
+        .def("ingest_stop", &Manager::ingestStop, release_gil())
+        .def("ingest_stats", &Manager::ingestGetStats)
+
+        // Files.
+        .def("save", py::overload_cast<const std::filesystem::path&>(&Manager::save, py::const_), py::arg("fpath"), release_gil())
+        .def("save_async", &Manager::saveAsync, py::arg("fpath"))
+        .def("load", &Manager::load, py::arg("fpath"), release_gil());
+
+
+    // ***************************************** PIPELINE ***************************************** //
+
+
+    py::class_<simulation::Pipeline, std::shared_ptr<simulation::Pipeline>>(m, "Pipeline")
+        .def(py::init([](const std::shared_ptr<Manager>& manager, const std::shared_ptr<simulation::GroundTruthScene>& scene,
+                         const std::shared_ptr<sensor::Camera>& camera, const size_t& n_frames, const float& seed)
+             {
+                 return simulation::Pipeline::create(manager, scene, camera, n_frames, seed);
+             }),
+             py::arg("manager"), py::arg("scene"), py::arg("camera"),
+             py::arg("n_frames") = simulation::Pipeline::default_n_frames, py::arg("seed") = -1.0f)
+        .def("set_view_filter", [](simulation::Pipeline& p, std::function<bool(const Eigen::Matrix4f&)> filter)
+             {
+                 p.setViewFilter([filter = std::move(filter)](const Extrinsic& view) { return filter(view.matrix()); });
+             },
+             py::arg("filter"), "Called from the render thread, holding the GIL, with each view's pose.")
+        .def("set_image_callback", [](simulation::Pipeline& p, std::function<void(std::shared_ptr<sensor::Camera>, size_t)> callback)
+             {
+                 p.setImageCallback([callback = std::move(callback)](const std::shared_ptr<const sensor::Camera>& camera, const size_t& n)
+                 {
+                     callback(std::const_pointer_cast<sensor::Camera>(camera), n);
+                 });
+             },
+             py::arg("callback"), "Called from the render thread, holding the GIL. The Camera is reused; copy its image to keep it.")
+        .def("set_stride", &simulation::Pipeline::setStride, py::arg("stride"))
+        .def("run", [](simulation::Pipeline& p, const Eigen::Matrix4f& camera_pose, const size_t& max_views)
+             {
+                 return p.run(toExtrinsic(camera_pose), max_views);
+             },
+             py::arg("camera_pose") = identity,
+             py::arg("max_views") = std::numeric_limits<size_t>::max(), release_gil());
+}
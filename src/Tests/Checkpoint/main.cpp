@@ -0,0 +1,179 @@
+#include <filesystem>
+#include <map>
+#include <random>
+
+#include "ForgeScan/Data/Checkpoint.hpp"
+#include "ForgeScan/Data/VoxelGrids/Binary.hpp"
+
+#include "Test.hpp"
+
+
+/// @brief Tests that a Checkpoint which copies only the chunks each update changed keeps the same
+///        data as the Reconstruction, for the linear and bricked layouts, including the occplane
+///        labels a Binary channel sets next to the traced voxels between updates, and after the
+///        window moves. After each write the file is read back and compared, data set by data set,
+///        with a file saved from a Snapshot of the same state. That is the file `Reconstruction::save`
+///        writes.
+
+
+using namespace forge_scan;
+
+
+/// @brief Copies a channel's data to doubles, so channels of any type may be compared.
+std::vector<double> getData(const data::VoxelGrid& channel)
+{
+    std::vector<double> out;
+    std::visit([&out](const auto& vector)
+    {
+        out.reserve(vector.size());
+        for (size_t i = 0; i < vector.size(); ++i)
+        {
+            out.push_back(static_cast<double>(vector[i]));
+        }
+    }, channel.getData());
+    return out;
+}
+
+
+/// @brief Reads every data set of the Reconstruction group of an HDF5 file to doubles, by path.
+std::map<std::string, std::vector<double>> readFile(const std::filesystem::path& fpath)
+{
+    const HighFive::File file(fpath.string(), HighFive::File::ReadOnly);
+    const HighFive::Group g_reconstruction = file.getGroup(FS_HDF5_RECONSTRUCTION_GROUP);
+    std::map<std::string, std::vector<double>> out;
+    auto read = [&](const std::string& dset_path)
+    {
+        g_reconstruction.getDataSet(dset_path).read(out[dset_path]);
+    };
+    for (const auto& name : g_reconstruction.listObjectNames())
+    {
+        if (g_reconstruction.getObjectType(name) == HighFive::ObjectType::Dataset)
+        {
+            read(name);
+            continue;
+        }
+        for (const auto& dset_name : g_reconstruction.getGroup(name).listObjectNames())
+        {
+            read(name + "/" + dset_name);
+        }
+    }
+    out["Updates"] = {static_cast<double>(g_reconstruction.getAttribute("Updates").read<size_t>())};
+    return out;
+}
+
+
+/// @brief Checks that the file a Checkpoint wrote holds the same data sets, with the same data, as
+///        the file a Snapshot of the Reconstruction saves.
+bool fileMatches(const std::filesystem::path& fpath, const std::shared_ptr<data::Reconstruction>& reconstruction)
+{
+    const std::filesystem::path saved_fpath = fpath.parent_path() / "ForgeScanTestCheckpointSaved.h5";
+    {
+        HighFive::File file(saved_fpath.string(), HighFive::File::Truncate);
+        reconstruction->getSnapshot()->save(file);
+    }
+    const bool matches = readFile(fpath) == readFile(saved_fpath);
+    std::filesystem::remove(saved_fpath);
+    return matches;
+}
+
+
+int main()
+{
+    const std::filesystem::path fpath = std::filesystem::temp_directory_path() / "ForgeScanTestCheckpoint.h5";
+
+    // Small patches of points seen from nearby, so each update changes a part of the Grid.
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<float> uniform(-0.08f, 0.08f);
+    const std::vector<Point> centers = {Point(0.3f, 0.3f, 0.4f), Point(1.0f, 0.7f, 0.3f), Point(0.7f, 0.2f, 0.6f)};
+    std::vector<PointMatrix> views;
+    std::vector<Point> origins;
+    for (const auto& center : centers)
+    {
+        PointMatrix sensed_points(3, 500);
+        for (int c = 0; c < sensed_points.cols(); ++c)
+        {
+            sensed_points.col(c) = center + Point(uniform(gen), uniform(gen), uniform(gen));
+        }
+        views.push_back(sensed_points);
+        origins.push_back(center + Point(0.15f, -0.1f, 0.12f));
+    }
+
+    const std::map<std::string, std::string> channel_types = {
+        {"binary",      "--type Binary"},
+        {"tsdf",        "--type TSDF"},
+        {"views",       "--type CountViews"},
+        {"probability", "--type Probability"},
+        {"quantized",   "--type Probability --dtype int8"},
+        {"compact",     "--type TSDF --dtype int16 --average"},
+        {"weighted",    "--type TSDF --dtype int16"}
+    };
+
+    // With only the Binary channel the traces are short enough for some occplane labels to be in
+    // chunks no trace reached. The last set holds the channels which convert or decode their data
+    // as they save it.
+    const std::vector<std::vector<std::string>> channel_sets = {
+        {"tsdf", "views", "binary"},
+        {"binary"},
+        {"binary", "probability", "quantized", "compact", "weighted"}
+    };
+
+    for (const auto& names : channel_sets)
+    for (const bool sparse : {false, true})
+    for (const size_t brick_size : {1, 4, 8})
+    {
+        const auto properties = Grid::Properties::createConst(0.02f, GridSize(70, 50, 40), sparse, brick_size);
+        const size_t n_chunks = properties->getNumChunks().prod();
+
+        auto reconstruction = data::Reconstruction::create(properties);
+        for (const auto& name : names)
+        {
+            reconstruction->addChannel(utilities::ArgParser("--name " + name + " " + channel_types.at(name) + " --d-max 0.04"));
+        }
+        auto binary = std::static_pointer_cast<data::Binary>(reconstruction->getChannelRef("binary"));
+        std::vector<Eigen::Vector3d> occplane_centers, occplane_normals;
+
+        auto checkpoint = data::Checkpoint::create(reconstruction);
+        FS_TEST_CHECK(checkpoint->copy() == n_chunks);
+        {
+            HighFive::File file(fpath.string(), HighFive::File::Truncate);
+            checkpoint->write(file);
+        }
+        FS_TEST_CHECK(fileMatches(fpath, reconstruction));
+
+        for (size_t v = 0; v < views.size(); ++v)
+        {
+            reconstruction->update(views[v], origins[v]);
+            binary->updateOccplanes(occplane_centers, occplane_normals);
+
+            const size_t n_copied = checkpoint->copy();
+            FS_TEST_CHECK(n_copied > 0 && n_copied < n_chunks);
+            for (const auto& name : names)
+            {
+                FS_TEST_CHECK(getData(*checkpoint->getChannel(name)) == getData(*reconstruction->getChannelView(name)));
+            }
+            {
+                HighFive::File file(fpath.string(), HighFive::File::ReadWrite);
+                checkpoint->write(file);
+            }
+            FS_TEST_CHECK(fileMatches(fpath, reconstruction));
+        }
+
+        // Moving the window changes the chunks which held or now hold scanned voxels, but those
+        // no ray reached before or after the move are not copied.
+        reconstruction->shiftWindow(0, 3);
+        const size_t n_shifted = checkpoint->copy();
+        FS_TEST_CHECK(n_shifted > 0 && n_shifted < n_chunks);
+        for (const auto& name : names)
+        {
+            FS_TEST_CHECK(getData(*checkpoint->getChannel(name)) == getData(*reconstruction->getChannelView(name)));
+        }
+        {
+            HighFive::File file(fpath.string(), HighFive::File::ReadWrite);
+            checkpoint->write(file);
+        }
+        FS_TEST_CHECK(fileMatches(fpath, reconstruction));
+        FS_TEST_CHECK(checkpoint->copy() == 0);
+    }
+    std::filesystem::remove(fpath);
+    return FS_TEST_RESULT();
+}
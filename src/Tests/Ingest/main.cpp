@@ -0,0 +1,179 @@
+#include <cmath>
+
+#include "ForgeScan/Manager.hpp"
+
+#include "Test.hpp"
+
+
+/// @brief Tests that ingesting frames with several threads integrates them in the order they were
+///        queued, giving the same data as ingesting them with one thread, and that a failed
+///        integration stops every ingestion thread.
+
+
+using namespace forge_scan;
+
+
+/// @brief Metric which throws on a chosen update, to make an integration fail.
+class FailingMetric : public metrics::Metric
+{
+public:
+    FailingMetric(const std::shared_ptr<data::Reconstruction>& reconstruction, const size_t& fail_update)
+        : metrics::Metric(reconstruction, "failing"),
+          fail_update(fail_update)
+    {
+
+    }
+
+private:
+    void preUpdate(const PointMatrix&, const Extrinsic&, const size_t& update_count) override
+    {
+        if (update_count == this->fail_update)
+        {
+            throw std::runtime_error("Injected integration failure.");
+        }
+    }
+
+    void save(HighFive::File&) const override
+    {
+
+    }
+
+    const std::string& getTypeName() const override
+    {
+        return metrics::Metric::type_name;
+    }
+
+    const size_t fail_update;
+};
+
+
+/// @brief Fills an image with a wavy surface which changes with the frame number.
+void fillImage(DepthImage& image, const int& f)
+{
+    for (Eigen::Index r = 0; r < image.rows(); ++r)
+    {
+        for (Eigen::Index c = 0; c < image.cols(); ++c)
+        {
+            image(r, c) = 0.8f + 0.1f * std::sin(0.2f * static_cast<float>(c + 3 * f)) *
+                                        std::cos(0.3f * static_cast<float>(r - f));
+        }
+    }
+}
+
+
+/// @brief Ingests the same frames with the given number of threads.
+/// @return Each channel's data, as doubles, after every frame is integrated.
+std::vector<std::vector<double>> ingest(const size_t& n_threads)
+{
+    auto manager = Manager::create(Grid::Properties::createConst(0.02f, GridSize(60, 60, 60)));
+    manager->reconstructionAddChannel(utilities::ArgParser("--name tsdf --type TSDF"));
+    manager->reconstructionAddChannel(utilities::ArgParser("--name probability --type Probability"));
+
+    const auto intr = sensor::Intrinsics::create(64, 48, 0.1f, 3.0f, 60.0f, 45.0f);
+    manager->ingestStart(intr, utilities::ArgParser("--queue-capacity 8 --n-ingest-threads " + std::to_string(n_threads)));
+
+    // Each frame sees a different wavy surface from a slightly different pose, so the order of
+    // integration changes the result.
+    DepthImage image(intr->height, intr->width);
+    for (int f = 0; f < 24; ++f)
+    {
+        fillImage(image, f);
+        Extrinsic extr = Extrinsic::Identity();
+        extr.translation() = Point(0.6f + 0.01f * static_cast<float>(f % 5), 0.6f - 0.01f * static_cast<float>(f % 3), -0.1f);
+        manager->ingestFrame(image, extr);
+    }
+    const Manager::IngestStats stats = manager->ingestStop();
+    FS_TEST_CHECK(stats.integrated == 24);
+
+    std::vector<std::vector<double>> data;
+    const auto snapshot = manager->reconstructionGetSnapshot();
+    for (const std::string name : {"tsdf", "probability"})
+    {
+        std::vector<double>& values = data.emplace_back();
+        std::visit([&values](const auto& vector)
+        {
+            for (size_t i = 0; i < vector.size(); ++i)
+            {
+                values.push_back(static_cast<double>(vector[i]));
+            }
+        }, snapshot->getChannel(name)->getData());
+    }
+    return data;
+}
+
+
+/// @brief Ingests frames with the given number of threads while one integration fails, and keeps
+///        giving frames after it did.
+/// @note  This hangs, rather than fails, if a thread waiting for its turn is never released.
+void ingestFailure(const size_t& n_threads)
+{
+    auto manager = Manager::create(Grid::Properties::createConst(0.02f, GridSize(40, 40, 40)));
+    manager->reconstructionAddChannel(utilities::ArgParser("--name tsdf --type TSDF"));
+    manager->metricAdd(std::make_shared<FailingMetric>(manager->reconstruction, 3));
+
+    const auto intr = sensor::Intrinsics::create(32, 24, 0.1f, 3.0f, 60.0f, 45.0f);
+    manager->ingestStart(intr, utilities::ArgParser("--queue-capacity 4 --n-ingest-threads " + std::to_string(n_threads)));
+
+    DepthImage image(intr->height, intr->width);
+    for (int f = 0; f < 32; ++f)
+    {
+        fillImage(image, f);
+        Extrinsic extr = Extrinsic::Identity();
+        extr.translation() = Point(0.4f, 0.4f, -0.1f);
+        try
+        {
+            manager->ingestFrame(image, extr);
+        }
+        catch (const std::runtime_error&)
+        {
+            // Every frame given after the failure is refused with it.
+        }
+    }
+
+    bool stop_threw = false;
+    try
+    {
+        manager->ingestStop();
+    }
+    catch (const std::runtime_error&)
+    {
+        stop_threw = true;
+    }
+    FS_TEST_CHECK(stop_threw);
+    FS_TEST_CHECK(!manager->isIngesting());
+    FS_TEST_CHECK(manager->ingestGetStats().integrated <= 3);
+
+    // The failure is reported until ingestStop has joined the threads, then cleared.
+    bool stop_threw_again = false;
+    try
+    {
+        manager->ingestStop();
+    }
+    catch (const std::runtime_error&)
+    {
+        stop_threw_again = true;
+    }
+    FS_TEST_CHECK(!stop_threw_again);
+}
+
+
+int main()
+{
+    for (const size_t n_threads : {1, 2, 4})
+    {
+        for (int repeat = 0; repeat < 3; ++repeat)
+        {
+            ingestFailure(n_threads);
+        }
+    }
+
+    const auto expected = ingest(1);
+    for (const size_t n_threads : {2, 4})
+    {
+        for (int repeat = 0; repeat < 3; ++repeat)
+        {
+            FS_TEST_CHECK(ingest(n_threads) == expected);
+        }
+    }
+    return FS_TEST_RESULT();
+}
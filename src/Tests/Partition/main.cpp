@@ -0,0 +1,65 @@
+#include <random>
+
+#include "ForgeScan/Common/TraceBatch.hpp"
+#include "ForgeScan/Data/Partition.hpp"
+
+#include "Test.hpp"
+
+
+/// @brief Tests that `Partition::route` sends a view to every rank whose planes its rays are traced
+///        through, and that it leaves out ranks the view does not reach.
+
+
+using namespace forge_scan;
+
+
+/// @brief Traces views through each Partition and compares the ranks with voxels to the routed ranks.
+void testRoute()
+{
+    const Grid::Properties properties(0.05f, GridSize(30, 20, 61));
+    const size_t n_ranks = 4, halo = 1;
+
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> spread(0.0f, 0.05f);
+
+    size_t n_pruned = 0;
+    for (int v = 0; v < 60; ++v)
+    {
+        // A small patch of sensed points, seen from an origin above, below or beside the Grid.
+        const Point centre = Point(unit(gen), unit(gen), unit(gen)).cwiseProduct(properties.dimensions);
+        const Point origin = centre + 2.0f * Point(unit(gen) - 0.5f, unit(gen) - 0.5f, v % 3 == 0 ? 0.0f : unit(gen) - 0.5f);
+        PointMatrix sensed_points(3, 200);
+        for (auto col : sensed_points.colwise())
+        {
+            col = centre + Point(spread(gen), spread(gen), spread(gen));
+        }
+
+        const float dist_min = -0.1f, dist_max = v % 2 == 0 ? 0.1f : INFINITY;
+        const std::vector<size_t> ranks = data::Partition::route(properties, n_ranks, halo, sensed_points,
+                                                                 origin, dist_min, dist_max);
+        n_pruned += ranks.size() < n_ranks;
+
+        for (size_t rank = 0; rank < n_ranks; ++rank)
+        {
+            const auto partition = data::Partition::create(properties, rank, n_ranks, halo);
+            const bool routed = std::find(ranks.begin(), ranks.end(), rank) != ranks.end();
+            FS_TEST_CHECK(routed == partition->receives(sensed_points, origin, dist_min, dist_max));
+
+            // Points in the frame of the Partition, as the Manager of a Partition moves them.
+            const Point shift(0, 0, partition->getWindowOffset().z() * properties.resolution);
+            auto batch = std::make_shared<TraceBatch>();
+            get_ray_trace_batch(batch, sensed_points.colwise() - shift, origin - shift, partition->getProperties(),
+                                dist_min, dist_max, 0, sensed_points.cols());
+            FS_TEST_CHECK(batch->numVoxels() == 0 || routed);
+        }
+    }
+    FS_TEST_CHECK(n_pruned > 0);
+}
+
+
+int main()
+{
+    testRoute();
+    return FS_TEST_RESULT();
+}
@@ -0,0 +1,79 @@
+"""Smoke test of the forge_scan Python module.
+
+Builds a small Reconstruction, integrates one view, and checks that the channel data comes back as
+read-only (nz, ny, nx) NumPy arrays which survive a save and load.
+"""
+
+import os
+import tempfile
+import unittest
+
+import numpy as np
+
+import forge_scan
+
+
+GRID_ARGS = "--nx 30 --ny 20 --nz 10 --resolution 0.05"
+
+
+def make_points(properties, n_points=500, seed=0):
+    """Sensed points on a small patch near the center of the Grid, as a 3 x N float32 array."""
+    rng = np.random.default_rng(seed)
+    center = 0.5 * np.asarray(properties.dimensions, dtype=np.float32).ravel()
+    points = center[:, None] + rng.normal(0.0, 0.05, size=(3, n_points)).astype(np.float32)
+    return np.ascontiguousarray(points, dtype=np.float32)
+
+
+class TestModule(unittest.TestCase):
+
+    def setUp(self):
+        self.manager = forge_scan.Manager(GRID_ARGS)
+        self.manager.add_channel("--name tsdf   --type TSDF")
+        self.manager.add_channel("--name binary --type Binary")
+        self.properties = self.manager.grid_properties
+
+        # The sensor is above the Grid, looking down on the points. Points are given relative to it.
+        dimensions = np.asarray(self.properties.dimensions, dtype=np.float32).ravel()
+        position = np.array([0.5 * dimensions[0], 0.5 * dimensions[1], dimensions[2] + 1.0], dtype=np.float32)
+        pose = np.eye(4, dtype=np.float32)
+        pose[:3, 3] = position
+        points = make_points(self.properties) - position[:, None]
+        self.manager.update(np.ascontiguousarray(points), pose)
+
+    def test_properties(self):
+        self.assertEqual(list(self.properties.size), [30, 20, 10])
+        self.assertEqual(list(self.properties.shape), [10, 20, 30])
+        self.assertAlmostEqual(self.properties.resolution, 0.05, places=6)
+
+    def test_update_and_data(self):
+        self.assertEqual(self.manager.n_updates, 1)
+        for name in ("tsdf", "binary"):
+            data = self.manager.data(name)
+            self.assertEqual(data.shape, (10, 20, 30))
+        self.assertTrue(np.any(self.manager.data("tsdf") != self.manager.data("tsdf").flat[0]))
+
+    def test_views_are_read_only(self):
+        data = self.manager.data("tsdf")
+        self.assertFalse(data.flags.writeable)
+        with self.assertRaises(ValueError):
+            data[0, 0, 0] = 1
+
+    def test_snapshot_matches(self):
+        snapshot = self.manager.snapshot()
+        self.assertEqual(sorted(snapshot.channels), ["binary", "tsdf"])
+        np.testing.assert_array_equal(snapshot.data("tsdf"), self.manager.data("tsdf"))
+        self.assertEqual(snapshot.seen().shape, (10, 20, 30))
+
+    def test_save_and_load(self):
+        expected = np.array(self.manager.data("tsdf"))
+        with tempfile.TemporaryDirectory() as directory:
+            fpath = self.manager.save(os.path.join(directory, "smoke.h5"))
+            self.assertTrue(os.path.isfile(fpath))
+
+            loaded = forge_scan.Manager(GRID_ARGS)
+            loaded.load(fpath)
+            np.testing.assert_array_equal(loaded.data("tsdf"), expected)
+
+
+if __name__ == "__main__":
+    unittest.main()
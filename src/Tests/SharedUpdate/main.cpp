@@ -0,0 +1,162 @@
+#include <random>
+
+#include "ForgeScan/Data/Reconstruction.hpp"
+
+#include "Test.hpp"
+
+
+/// @brief Tests that the shared update of several Reconstructions, with channels of different
+///        distance ranges and with different endpoint merging, gives each Reconstruction the same
+///        data as updating it alone. Also tests that a single Reconstruction updated with more than
+///        one thread gives the same data, for every channel type, as the serial update.
+
+
+using namespace forge_scan;
+
+
+/// @brief Creates one Reconstruction of each configuration in the test.
+std::vector<std::shared_ptr<data::Reconstruction>> createReconstructions(const std::shared_ptr<const Grid::Properties>& properties)
+{
+    const std::vector<std::string> channels = {
+        "--name tsdf --type TSDF",
+        "--name views --type CountViews",
+        "--name updates --type CountUpdates",
+        "--name probability --type Probability --d-min -0.05 --d-max 0.1",
+        "--name merged --type TSDF",
+    };
+    std::vector<std::shared_ptr<data::Reconstruction>> reconstructions;
+    for (const auto& channel : channels)
+    {
+        reconstructions.push_back(data::Reconstruction::create(properties));
+        reconstructions.back()->addChannel(utilities::ArgParser(channel));
+    }
+    reconstructions.back()->setEndpointMerge(data::Reconstruction::EndpointMerge::CENTROID);
+    return reconstructions;
+}
+
+
+/// @brief Copies a channel's data to doubles, so channels of any type may be compared.
+std::vector<double> getData(const data::Reconstruction& reconstruction, const std::string& name)
+{
+    std::vector<double> out;
+    std::visit([&out](const auto& vector)
+    {
+        out.reserve(vector.size());
+        for (size_t i = 0; i < vector.size(); ++i)
+        {
+            out.push_back(static_cast<double>(vector[i]));
+        }
+    }, reconstruction.getChannelView(name)->getData());
+    return out;
+}
+
+
+/// @brief Creates a Reconstruction with one channel of each type, updated with the given threads.
+std::shared_ptr<data::Reconstruction> createThreaded(const std::shared_ptr<const Grid::Properties>& properties,
+                                                     const size_t& n_threads,
+                                                     const data::Reconstruction::EndpointMerge& merge)
+{
+    auto reconstruction = data::Reconstruction::create(properties);
+    for (const auto& channel : {"--name binary --type Binary",
+                                "--name binary_tsdf --type BinaryTSDF",
+                                "--name tsdf --type TSDF",
+                                "--name probability --type Probability --d-min -0.05 --d-max 0.1",
+                                "--name updates --type CountUpdates",
+                                "--name views --type CountViews"})
+    {
+        reconstruction->addChannel(utilities::ArgParser(channel));
+    }
+    reconstruction->setNumThreads(n_threads);
+    reconstruction->setEndpointMerge(merge);
+    return reconstruction;
+}
+
+
+/// @brief Checks that a Reconstruction updated with several threads matches the serial update.
+void checkThreadedUpdate(const std::shared_ptr<const Grid::Properties>& properties,
+                         const std::vector<PointMatrix>& views, const std::vector<Point>& origins)
+{
+    const std::vector<std::string> names = {"binary", "binary_tsdf", "tsdf", "probability", "updates", "views"};
+    for (const auto merge : {data::Reconstruction::EndpointMerge::NONE, data::Reconstruction::EndpointMerge::CENTROID})
+    {
+        const auto serial   = createThreaded(properties, 1, merge);
+        const auto threaded = createThreaded(properties, 4, merge);
+        for (size_t v = 0; v < views.size(); ++v)
+        {
+            serial->update(views[v], origins[v]);
+            threaded->update(views[v], origins[v]);
+        }
+
+        for (const auto& name : names)
+        {
+            FS_TEST_CHECK(getData(*threaded, name) == getData(*serial, name));
+        }
+        const auto seen_serial   = serial->getSeenData();
+        const auto seen_threaded = threaded->getSeenData();
+        bool same_seen = true;
+        for (size_t i = 0; i < properties->getNumVoxels(); ++i)
+        {
+            same_seen &= seen_threaded->test(i) == seen_serial->test(i);
+        }
+        FS_TEST_CHECK(same_seen);
+        FS_TEST_CHECK(seen_serial->count() > 0);
+    }
+}
+
+
+int main()
+{
+    const auto properties = Grid::Properties::createConst(0.02f, GridSize(60, 60, 60));
+    const std::vector<std::string> names = {"tsdf", "views", "updates", "probability", "merged"};
+
+    // Rays from outside the Grid to points on a sphere inside it, many of which share a voxel.
+    std::mt19937 gen(0);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    const Point center(0.6f, 0.6f, 0.6f);
+    std::vector<Point> origins = {Point(0.6f, 0.6f, -0.4f), Point(1.5f, 0.2f, 1.4f), Point(-0.3f, 1.1f, 0.5f)};
+    std::vector<PointMatrix> views;
+    for (size_t v = 0; v < origins.size(); ++v)
+    {
+        PointMatrix sensed_points(3, 3000);
+        for (int c = 0; c < sensed_points.cols(); ++c)
+        {
+            const Point direction = Point(normal(gen), normal(gen), normal(gen)).normalized();
+            sensed_points.col(c) = center + 0.3f * direction;
+        }
+        views.push_back(sensed_points);
+    }
+
+    for (const size_t n_threads : {1, 3})
+    {
+        const auto shared = createReconstructions(properties);
+        const auto alone  = createReconstructions(properties);
+        for (size_t v = 0; v < views.size(); ++v)
+        {
+            data::Reconstruction::update(shared, views[v], origins[v], n_threads);
+            for (const auto& reconstruction : alone)
+            {
+                reconstruction->update(views[v], origins[v]);
+            }
+        }
+
+        for (size_t r = 0; r < names.size(); ++r)
+        {
+            const std::vector<double> expected = getData(*alone[r], names[r]);
+            FS_TEST_CHECK(getData(*shared[r], names[r]) == expected);
+
+            const auto seen_shared = shared[r]->getSeenData();
+            const auto seen_alone  = alone[r]->getSeenData();
+            bool same_seen = true;
+            for (size_t i = 0; i < properties->getNumVoxels(); ++i)
+            {
+                same_seen &= seen_shared->test(i) == seen_alone->test(i);
+            }
+            FS_TEST_CHECK(same_seen);
+            FS_TEST_CHECK(seen_alone->count() > 0);
+        }
+    }
+
+    checkThreadedUpdate(properties, views, origins);
+
+    return FS_TEST_RESULT();
+}
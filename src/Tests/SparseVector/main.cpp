@@ -0,0 +1,96 @@
+#include <random>
+
+#include "ForgeScan/Common/Grid.hpp"
+#include "ForgeScan/Common/SparseVector.hpp"
+#include "ForgeScan/Data/Reconstruction.hpp"
+
+#include "Test.hpp"
+
+
+/// @brief Tests that a SparseVector follows the vector indices of a bricked Grid layout and that
+///        it keeps its blocks compact, so a bricked layout allocates no more memory than the linear one.
+
+
+using namespace forge_scan;
+
+
+/// @brief Writes voxels through the vector index of each layout and compares with a dense vector.
+void testLayout()
+{
+    const GridSize size(37, 29, 23);
+    for (const size_t brick_size : {1, 2, 4, 8, 16})
+    {
+        const auto properties = Grid::Properties::createConst(0.1f, size, true, brick_size);
+
+        SparseVector<int> sparse(size, -1, properties->brick_size);
+        std::vector<int>  dense(properties->getNumVoxels(), -1);
+
+        std::mt19937 gen(brick_size);
+        std::uniform_int_distribution<size_t> voxel(0, properties->getNumVoxels() - 1);
+        for (int n = 0; n < 2000; ++n)
+        {
+            const size_t i = voxel(gen);
+            sparse[i] = n;
+            dense[i]  = n;
+        }
+
+        FS_TEST_CHECK(sparse.toDense() == dense);
+
+        const SparseVector<int>& const_sparse = sparse;
+        bool same = true;
+        for (size_t i = 0; i < dense.size(); ++i)
+        {
+            same &= const_sparse[i] == dense[i];
+        }
+        FS_TEST_CHECK(same);
+
+        size_t n_visited = 0;
+        sparse.forEachValue([&n_visited](int&, const size_t& count) { n_visited += count; });
+        FS_TEST_CHECK(n_visited == properties->getNumVoxels());
+    }
+}
+
+
+/// @brief Number of SparseVector blocks a TSDF channel allocates for the same rays in a Grid with
+///        the given brick size.
+size_t countBlocks(const size_t& brick_size)
+{
+    const auto properties = Grid::Properties::createConst(0.01f, GridSize(200, 200, 200), true, brick_size);
+    auto reconstruction = data::Reconstruction::create(properties);
+    reconstruction->addChannel(utilities::ArgParser("--name tsdf --type TSDF"));
+
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<float> dist(0.4f, 1.6f);
+    const Point origin(1.0f, 1.0f, -0.5f);
+    PointMatrix sensed_points(3, 2000);
+    for (int c = 0; c < sensed_points.cols(); ++c)
+    {
+        sensed_points.col(c) = Point(dist(gen), dist(gen), dist(gen));
+    }
+    reconstruction->update(sensed_points, origin);
+
+    const auto& data = reconstruction->getChannelView("tsdf")->getData();
+    return std::get<SparseVector<float>>(data).numBlocks();
+}
+
+
+/// @brief Checks that bricked layouts allocate about as many blocks as the linear layout.
+void testBrickMemory()
+{
+    const size_t linear = countBlocks(1);
+    for (const size_t brick_size : {4, 8, 16})
+    {
+        const size_t bricked = countBlocks(brick_size);
+        std::cout << "Brick size " << brick_size << ": " << bricked << " blocks, linear layout: " << linear << std::endl;
+        FS_TEST_CHECK(bricked <= 2 * linear);
+    }
+    FS_TEST_CHECK(countBlocks(8) <= linear + linear / 10);
+}
+
+
+int main()
+{
+    testLayout();
+    testBrickMemory();
+    return FS_TEST_RESULT();
+}
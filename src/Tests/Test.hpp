@@ -0,0 +1,28 @@
+#ifndef FORGE_SCAN_TESTS_TEST_HPP
+#define FORGE_SCAN_TESTS_TEST_HPP
+
+#include <cstdlib>
+#include <iostream>
+
+
+/// @brief Number of failed checks in the running test.
+inline int forge_scan_test_failures = 0;
+
+
+/// @brief Records a failure, with its location, if the condition is false.
+#define FS_TEST_CHECK(condition)                                                                  \
+    do                                                                                            \
+    {                                                                                             \
+        if (!(condition))                                                                         \
+        {                                                                                         \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+            ++forge_scan_test_failures;                                                           \
+        }                                                                                         \
+    } while (false)
+
+
+/// @brief Exit code for the test, nonzero if any check failed.
+#define FS_TEST_RESULT() (forge_scan_test_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE)
+
+
+#endif // FORGE_SCAN_TESTS_TEST_HPP
@@ -0,0 +1,99 @@
+#include <random>
+
+#include "ForgeScan/Common/RayTrace.hpp"
+#include "ForgeScan/Common/TraceBatch.hpp"
+
+#include "Test.hpp"
+
+
+/// @brief Tests that the packet traversal of `get_ray_trace_batch` traces the same voxels, at the
+///        same distances, as tracing each ray alone with `get_ray_trace`.
+
+
+using namespace forge_scan;
+
+
+/// @brief Generates sensed points around the Grid, some outside of it.
+/// @param properties Grid Properties to generate the points around.
+/// @param origin Origin of the rays.
+/// @param kind Zero for points anywhere, one for rays along an axis, and two for points on voxel boundaries.
+/// @param n_rays Number of points.
+/// @param gen Random generator.
+PointMatrix makePoints(const std::shared_ptr<const Grid::Properties>& properties, const Point& origin,
+                       const int& kind, const size_t& n_rays, std::mt19937& gen)
+{
+    std::uniform_real_distribution<float> dist(-0.3f, 1.3f);
+    PointMatrix sensed_points(3, n_rays);
+    for (size_t c = 0; c < n_rays; ++c)
+    {
+        Point sensed = Point(dist(gen), dist(gen), dist(gen)).cwiseProduct(properties->dimensions);
+        if (kind == 1)
+        {
+            sensed = origin;
+            sensed[c % 3] += (c % 2 == 0 ? 1 : -1) * dist(gen);
+        }
+        else if (kind == 2)
+        {
+            sensed = (sensed / properties->resolution).array().round() * properties->resolution;
+        }
+        sensed_points.col(c) = sensed;
+    }
+    return sensed_points;
+}
+
+
+/// @brief Compares each ray of a batch with `get_ray_trace` of the same ray.
+void testSameAsTrace()
+{
+    std::mt19937 gen(3);
+    for (const size_t n : {5, 17, 64})
+    {
+        const auto properties = Grid::Properties::createConst(0.02f, GridSize(n, n + 3, n + 1));
+        for (int kind = 0; kind < 3; ++kind)
+        {
+            std::uniform_real_distribution<float> dist(-0.3f, 1.3f);
+            const Point origin = Point(dist(gen), dist(gen), dist(gen)).cwiseProduct(properties->dimensions);
+            const PointMatrix sensed_points = makePoints(properties, origin, kind, 5003, gen);
+
+            for (const float dist_max : {0.1f, INFINITY})
+            {
+                auto batch = std::make_shared<TraceBatch>();
+                const size_t n_valid = get_ray_trace_batch(batch, sensed_points, origin, properties, -0.1f, dist_max,
+                                                           0, sensed_points.cols());
+                FS_TEST_CHECK(n_valid == batch->numRays());
+
+                auto trace = std::make_shared<Trace>();
+                size_t r = 0;
+                bool same = true;
+                for (Eigen::Index c = 0; c < sensed_points.cols(); ++c)
+                {
+                    if (!get_ray_trace(trace, sensed_points.col(c), origin, properties, -0.1f, dist_max))
+                    {
+                        continue;
+                    }
+                    if (r == batch->numRays())
+                    {
+                        same = false;
+                        break;
+                    }
+                    const TraceBatch::Ray ray = batch->ray(r++);
+                    same &= ray.size() == trace->size() && ray.hasSensed() == trace->hasSensed();
+                    auto iter = ray.begin();
+                    for (size_t v = 0; same && v < trace->size(); ++v, ++iter)
+                    {
+                        same &= iter->i == (*trace)[v].i && iter->d == (*trace)[v].d;
+                    }
+                }
+                FS_TEST_CHECK(same);
+                FS_TEST_CHECK(r == batch->numRays());
+            }
+        }
+    }
+}
+
+
+int main()
+{
+    testSameAsTrace();
+    return FS_TEST_RESULT();
+}